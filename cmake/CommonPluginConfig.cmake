@@ -147,6 +147,7 @@ set(PLUGIN_INTERNAL_DEPS
     PluginCore
     ${Boost_LIBRARIES}
     ${FBLIB_LIBRARIES}
+    ${ZLIB_LIBRARIES}
     )
 
 file (GLOB GENERATED
@@ -130,9 +130,15 @@ endmacro()
 
 macro (add_firebreath_library project_name)
 
+    set (_SKIP_LIB 0)
+    if (FB_NO_HTTPSERVICE AND "${project_name}" STREQUAL "HttpService")
+        # feature flag; see src/config/fb_features.h
+        message(STATUS "FB_NO_HTTPSERVICE is set; skipping FireBreath library HttpService")
+        set (_SKIP_LIB 1)
+    endif()
     set (_FOUND_LIB 0)
     foreach(_LIB_DIR ${FBLIB_DIRS})
-        if (NOT _FOUND_LIB AND EXISTS ${_LIB_DIR}/${project_name}/CMakeLists.txt)
+        if (NOT _SKIP_LIB AND NOT _FOUND_LIB AND EXISTS ${_LIB_DIR}/${project_name}/CMakeLists.txt)
             get_target_property(library_target_exists log4cplus TYPE)
             if (library_target_exists)
                 set (_CUR_BINDIR ${CMAKE_CURRENT_BINARY_DIR}/fblibs/${PLUGIN_NAME}/${project_name})
@@ -147,7 +153,7 @@ macro (add_firebreath_library project_name)
             set (_FOUND_LIB 1)
         endif()
     endforeach()
-    if (NOT _FOUND_LIB)
+    if (NOT _FOUND_LIB AND NOT _SKIP_LIB)
         message(FATAL "Could not find FireBreath Library ${project_name}")
     endif()
     set (_LIB_KEY ${PLUGIN_NAME}_${project_name})
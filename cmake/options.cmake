@@ -10,3 +10,31 @@ endif()
 option(BUILD_EXAMPLES "Build example projects" OFF)
 option(WITH_DYNAMIC_MSVC_RUNTIME "Build with dynamic MSVC runtime (/MD)" OFF)
 option(WITH_SYSTEM_BOOST "Build with system Boost" OFF)
+
+# Feature flags to strip unused subsystems from the plugin binary; see
+# src/config/fb_features.h for what each one removes and its constraints
+option(FB_NO_DOM "Compile out the DOM Element/Document convenience layer" OFF)
+option(FB_NO_WSTRING_API "Compile out the wide-string scripting API overloads" OFF)
+option(FB_NO_HTTPSERVICE "Never build or link the embedded HTTP service" OFF)
+# The HttpService-based benchmarks pull the embedded HTTP service into the
+# default build, and that library does not compile on every platform the
+# core does; only people actually benchmarking it should opt in
+option(FB_HTTPSERVICE_BENCHES "Build the benchmarks that link the embedded HTTP service" OFF)
+if (FB_NO_DOM)
+    add_definitions(-DFB_NO_DOM)
+endif()
+if (FB_NO_WSTRING_API)
+    add_definitions(-DFB_NO_WSTRING_API)
+endif()
+
+# The streaming response decompression stage (FB::StreamInflater) inflates
+# Content-Encoding: gzip/deflate bodies with zlib; when zlib isn't available the
+# stage compiles out and compressed responses are delivered as received
+# (see FB_NO_STREAM_INFLATE in src/config/fb_features.h)
+find_package(ZLIB)
+if (ZLIB_FOUND)
+    include_directories(${ZLIB_INCLUDE_DIR})
+else()
+    message(STATUS "zlib not found; compiling out the response decompression stage")
+    add_definitions(-DFB_NO_STREAM_INFLATE)
+endif()
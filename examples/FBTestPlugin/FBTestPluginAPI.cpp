@@ -20,6 +20,7 @@ Copyright 2009 PacketPass Inc, Georg Fritzsche,
 #include "FBTestPlugin.h"
 #include "SimpleMathAPI.h"
 #include "ThreadRunnerAPI.h"
+#include "PerfScenariosAPI.h"
 #include "SimpleStreams.h"
 #include "SystemHelpers.h"
 #include <boost/make_shared.hpp>
@@ -47,6 +48,7 @@ FBTestPluginAPI::FBTestPluginAPI(const FBTestPluginPtr& plugin, const FB::Browse
     registerMethod("getTagAttribute", make_method(this, &FBTestPluginAPI::getTagAttribute));
     registerMethod("getPageLocation", make_method(this, &FBTestPluginAPI::getPageLocation));
     registerMethod("createThreadRunner", make_method(this, &FBTestPluginAPI::createThreadRunner));
+    registerMethod("createPerfScenarios", make_method(this, &FBTestPluginAPI::createPerfScenarios));
     registerMethod("optionalTest", make_method(this, &FBTestPluginAPI::optionalTest));
     registerMethod("getURL", make_method(this, &FBTestPluginAPI::getURL));
     registerMethod("postURL", make_method(this, &FBTestPluginAPI::postURL));
@@ -329,6 +331,11 @@ ThreadRunnerAPIPtr FBTestPluginAPI::createThreadRunner()
     return boost::make_shared<ThreadRunnerAPI>(m_host, m_pluginWeak);
 }
 
+PerfScenariosAPIPtr FBTestPluginAPI::createPerfScenarios()
+{
+    return boost::make_shared<PerfScenariosAPI>(m_host);
+}
+
 void FBTestPluginAPI::getURL(const std::string& url, const FB::JSObjectPtr& callback)
 {
     FB::SimpleStreamHelper::AsyncGet(m_host, FB::URI::fromString(url),
@@ -25,6 +25,7 @@ Copyright 2009 PacketPass Inc, Georg Fritzsche,
 
 FB_FORWARD_PTR(ThreadRunnerAPI);
 FB_FORWARD_PTR(SimpleMathAPI);
+FB_FORWARD_PTR(PerfScenariosAPI);
 FB_FORWARD_PTR(FBTestPlugin);
 
 class FBTestPluginAPI : public FB::JSAPIAuto
@@ -39,6 +40,8 @@ public:
     
     ThreadRunnerAPIPtr createThreadRunner();
 
+    PerfScenariosAPIPtr createPerfScenarios();
+
     std::wstring say(const std::wstring& val);
     // Read/Write property testString
     std::string get_testString();
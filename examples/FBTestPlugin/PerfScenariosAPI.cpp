@@ -0,0 +1,212 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include "JSObject.h"
+#include "variant_list.h"
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "PerfScenariosAPI.h"
+
+using boost::posix_time::ptime;
+using boost::posix_time::microsec_clock;
+
+struct PerfScenariosAPI::FloodState
+{
+    boost::mutex mutex;
+    long total;
+    long remaining;
+    long failed;
+    boost::uint64_t bytes;
+    ptime start;
+    ptime setupDone;
+
+    FloodState(long count)
+        : total(count), remaining(count), failed(0), bytes(0),
+          start(microsec_clock::universal_time()) {}
+};
+
+PerfScenariosAPI::PerfScenariosAPI(const FB::BrowserHostPtr& host) : m_host(host)
+{
+    registerMethod("echoN", make_method(this, &PerfScenariosAPI::echoN));
+    registerMethod("echoBurst", make_method(this, &PerfScenariosAPI::echoBurst));
+    registerMethod("arrayMarshal", make_method(this, &PerfScenariosAPI::arrayMarshal));
+    registerMethod("eventStorm", make_method(this, &PerfScenariosAPI::eventStorm));
+    registerMethod("streamFlood", make_method(this, &PerfScenariosAPI::streamFlood));
+    registerMethod("timerFlood", make_method(this, &PerfScenariosAPI::timerFlood));
+}
+
+PerfScenariosAPI::~PerfScenariosAPI()
+{
+}
+
+FB::VariantList PerfScenariosAPI::echoN(const FB::VariantList& args)
+{
+    return args;
+}
+
+FB::VariantMap PerfScenariosAPI::echoBurst(long calls, long argCount)
+{
+    if (calls < 1 || argCount < 0)
+        throw FB::invalid_arguments();
+
+    FB::VariantList args;
+    for (long i = 0; i < argCount; ++i)
+        args.push_back(i);
+    FB::VariantList wrapped(FB::variant_list_of(args));
+
+    const ptime start(microsec_clock::universal_time());
+    for (long i = 0; i < calls; ++i)
+        Invoke("echoN", wrapped);
+    const double totalUs =
+        (microsec_clock::universal_time() - start).total_microseconds();
+
+    FB::VariantMap result;
+    result["calls"] = calls;
+    result["argCount"] = argCount;
+    result["totalMs"] = totalUs / 1000.0;
+    result["avgUs"] = totalUs / calls;
+    result["callsPerSec"] = calls / (totalUs / 1000000.0);
+    return result;
+}
+
+FB::VariantMap PerfScenariosAPI::arrayMarshal(long elements, const FB::JSObjectPtr& callback)
+{
+    if (elements < 1 || !callback)
+        throw FB::invalid_arguments();
+
+    const ptime buildStart(microsec_clock::universal_time());
+    FB::VariantList arr;
+    arr.reserve(elements);
+    for (long i = 0; i < elements; ++i) {
+        switch (i % 3) {
+            case 0:  arr.push_back(i); break;
+            case 1:  arr.push_back(i * 0.5); break;
+            default: arr.push_back("element"); break;
+        }
+    }
+    const ptime marshalStart(microsec_clock::universal_time());
+    callback->Invoke("", FB::variant_list_of(arr));
+    const ptime done(microsec_clock::universal_time());
+
+    FB::VariantMap result;
+    result["elements"] = elements;
+    result["buildMs"] = (marshalStart - buildStart).total_microseconds() / 1000.0;
+    result["marshalMs"] = (done - marshalStart).total_microseconds() / 1000.0;
+    return result;
+}
+
+FB::VariantMap PerfScenariosAPI::eventStorm(long count, long payloadBytes)
+{
+    if (count < 1 || payloadBytes < 0)
+        throw FB::invalid_arguments();
+
+    const std::string payload(static_cast<size_t>(payloadBytes), 'e');
+    const ptime start(microsec_clock::universal_time());
+    for (long i = 0; i < count; ++i)
+        fire_perftick(i, payload);
+    const double totalUs =
+        (microsec_clock::universal_time() - start).total_microseconds();
+
+    FB::VariantMap result;
+    result["count"] = count;
+    result["payloadBytes"] = payloadBytes;
+    result["totalMs"] = totalUs / 1000.0;
+    result["eventsPerSec"] = count / (totalUs / 1000000.0);
+    return result;
+}
+
+void PerfScenariosAPI::streamFlood(long streams, const std::string& url,
+    const FB::JSObjectPtr& callback)
+{
+    if (streams < 1 || !callback)
+        throw FB::invalid_arguments();
+
+    boost::shared_ptr<FloodState> state(boost::make_shared<FloodState>(streams));
+    for (long i = 0; i < streams; ++i) {
+        FB::SimpleStreamHelper::AsyncGet(m_host, FB::URI::fromString(url),
+            boost::bind(&PerfScenariosAPI::streamDone, this, state, callback,
+                        _1, _2, _3, _4));
+    }
+}
+
+void PerfScenariosAPI::streamDone(const boost::shared_ptr<FloodState>& state,
+    const FB::JSObjectPtr& callback, bool success, const FB::HeaderMap& headers,
+    const boost::shared_array<uint8_t>& data, const size_t size)
+{
+    FB::VariantMap result;
+    {
+        boost::mutex::scoped_lock lock(state->mutex);
+        if (success)
+            state->bytes += size;
+        else
+            ++state->failed;
+        if (--state->remaining > 0)
+            return;
+        const double totalUs = (microsec_clock::universal_time() - state->start)
+            .total_microseconds();
+        result["streams"] = state->total;
+        result["failed"] = state->failed;
+        result["bytes"] = state->bytes;
+        result["totalMs"] = totalUs / 1000.0;
+        result["streamsPerSec"] = state->total / (totalUs / 1000000.0);
+    }
+    try {
+        callback->InvokeAsync("", FB::variant_list_of(result));
+    } catch (const std::runtime_error&) {
+        // page went away mid-run; nothing left to report to
+    }
+}
+
+void PerfScenariosAPI::timerFlood(long count, long intervalMs,
+    const FB::JSObjectPtr& callback)
+{
+    if (count < 1 || intervalMs < 0 || !callback)
+        throw FB::invalid_arguments();
+
+    m_timers.clear();    // drop timers from any previous flood
+    boost::shared_ptr<FloodState> state(boost::make_shared<FloodState>(count));
+    for (long i = 0; i < count; ++i) {
+        m_timers.push_back(FB::Timer::getTimer(intervalMs, false,
+            boost::bind(&PerfScenariosAPI::timerFired, this, state, callback)));
+    }
+    // setup covers creating the timers; drain starts when they are armed
+    state->setupDone = microsec_clock::universal_time();
+    for (size_t i = 0; i < m_timers.size(); ++i)
+        m_timers[i]->start();
+}
+
+void PerfScenariosAPI::timerFired(const boost::shared_ptr<FloodState>& state,
+    const FB::JSObjectPtr& callback)
+{
+    FB::VariantMap result;
+    {
+        boost::mutex::scoped_lock lock(state->mutex);
+        if (--state->remaining > 0)
+            return;
+        const ptime now(microsec_clock::universal_time());
+        result["timers"] = state->total;
+        result["setupMs"] = (state->setupDone - state->start)
+            .total_microseconds() / 1000.0;
+        result["drainMs"] = (now - state->setupDone).total_microseconds() / 1000.0;
+    }
+    try {
+        callback->InvokeAsync("", FB::variant_list_of(result));
+    } catch (const std::runtime_error&) {
+        // page went away mid-run; nothing left to report to
+    }
+}
+
@@ -0,0 +1,82 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <string>
+#include <vector>
+#include "Timer.h"
+#include "JSAPIAuto.h"
+#include "BrowserHost.h"
+#include <boost/shared_array.hpp>
+#include "SimpleStreamHelper.h"
+
+#pragma once
+#ifndef H_PERFSCENARIOSAPI
+#define H_PERFSCENARIOSAPI
+
+// Standardized performance scenarios for in-browser measurement.  Each method
+// exercises one framework hot path -- scripting dispatch, large-array marshal,
+// event firing, concurrent streams, timer scheduling -- measures itself with a
+// microsecond clock and reports the numbers back to the page, so the same
+// check can be run against any browser/OS combination a customer actually has.
+// Get an instance from plugin().createPerfScenarios().
+
+FB_FORWARD_PTR(PerfScenariosAPI);
+
+class PerfScenariosAPI : public FB::JSAPIAuto
+{
+public:
+    PerfScenariosAPI(const FB::BrowserHostPtr& host);
+    virtual ~PerfScenariosAPI();
+
+    FB_JSAPI_EVENT(perftick, 2, (const long, const std::string));
+
+    // echoes its argument array back; call this at high rate from the page to
+    // measure the full bridge round trip, or let echoBurst drive it in-plugin
+    FB::VariantList echoN(const FB::VariantList& args);
+
+    // drives echoN through the JSAPI dispatch layer `calls` times with
+    // `argCount` arguments each; measures dispatch + conversion cost
+    FB::VariantMap echoBurst(long calls, long argCount);
+
+    // builds an array of `elements` mixed values, then hands it to the page
+    // callback in one call; reports build time and marshal time separately
+    FB::VariantMap arrayMarshal(long elements, const FB::JSObjectPtr& callback);
+
+    // fires the perftick event `count` times with a payload string
+    FB::VariantMap eventStorm(long count, long payloadBytes);
+
+    // starts `streams` concurrent downloads of url; calls callback with the
+    // totals once they have all completed
+    void streamFlood(long streams, const std::string& url,
+                     const FB::JSObjectPtr& callback);
+
+    // schedules `count` one-shot timers at intervalMs; calls callback with
+    // setup and drain times once the last one has fired
+    void timerFlood(long count, long intervalMs, const FB::JSObjectPtr& callback);
+
+private:
+    struct FloodState;
+    void streamDone(const boost::shared_ptr<FloodState>& state,
+                    const FB::JSObjectPtr& callback, bool success,
+                    const FB::HeaderMap& headers,
+                    const boost::shared_array<uint8_t>& data, const size_t size);
+    void timerFired(const boost::shared_ptr<FloodState>& state,
+                    const FB::JSObjectPtr& callback);
+
+    FB::BrowserHostPtr m_host;
+    std::vector<FB::TimerPtr> m_timers;
+};
+
+#endif
+
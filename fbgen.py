@@ -85,6 +85,14 @@ def Main():
     parser.add_option("-c", "--company-name", dest="companyName")
     parser.add_option("-d", "--company-domain", dest="companyDomain")
     parser.add_option("-g", "--disable-gui", dest="disableGUI")
+    parser.add_option("-s", "--static-members", dest="staticMembers",
+                      help="true to register the API members through a static"
+                      " FB::StaticMemberTable instead of per-instance"
+                      " registerMethod calls")
+    parser.add_option("-t", "--timing-hooks", dest="timingHooks",
+                      help="true to enable per-method timing in the generated"
+                      " API, readable from javascript via the memberStats"
+                      " property")
     options, args = parser.parse_args()
 
     if (options.pluginName and options.pluginIdent and options.companyName
@@ -100,7 +108,9 @@ def Main():
 
     # Instantiate the appropriate classes
     plugin = Plugin(name=options.pluginName, ident=options.pluginIdent,
-                    disable_gui=options.disableGUI)
+                    disable_gui=options.disableGUI,
+                    static_members=options.staticMembers,
+                    timing_hooks=options.timingHooks)
     plugin.readCfg(cfgFile)
     company = Company(name=options.companyName)
     company.readCfg(cfgFile)
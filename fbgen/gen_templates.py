@@ -52,8 +52,71 @@ class Template(string.Template):
             else:
                 retdict.update(PLUGIN_disable_gui='#set (FB_GUI_DISABLED')
                 retdict.update(PLUGIN_disable_gui_mac='1')
+        if isinstance(obj, Plugin):
+            retdict.update(self.generateMemberBlocks(obj))
         return retdict
 
+    def generateMemberBlocks(self, plugin):
+        """
+        Computes the API-class code blocks that depend on the static_members
+        and timing_hooks options: member registration in the constructor, the
+        optional FB::StaticMemberTable accessor and the matching include.
+        """
+        ident = plugin.ident
+        blocks = AttrDictSimple()
+        if plugin.static_members == "true":
+            blocks.PLUGIN_member_include = '#include "StaticMemberTable.h"\n'
+            blocks.PLUGIN_member_init = (
+                '        // Members are declared once per class in memberTable() below and\n'
+                '        // only bound to the instance here; add new ones to the table\n'
+                '        memberTable().apply(this);\n')
+            blocks.PLUGIN_member_table = (
+                '    ////////////////////////////////////////////////////////////////////////////\n'
+                '    /// @fn {0}API::memberTable()\n'
+                '    ///\n'
+                '    /// @brief  Static member table: the type-erased method and property\n'
+                '    ///         wrappers are built once per class instead of once per\n'
+                '    ///         instance created.  Register new members here.\n'
+                '    ////////////////////////////////////////////////////////////////////////////\n'
+                '    static const FB::StaticMemberTable<{0}API>& memberTable()\n'
+                '    {{\n'
+                '        static const FB::StaticMemberTable<{0}API> table =\n'
+                '            FB::StaticMemberTable<{0}API>()\n'
+                '                .method("echo",      &{0}API::echo)\n'
+                '                .method("testEvent", &{0}API::testEvent)\n'
+                '                .property("testString", &{0}API::get_testString,\n'
+                '                                        &{0}API::set_testString)\n'
+                '                .property("version",    &{0}API::get_version);\n'
+                '        return table;\n'
+                '    }}\n'
+                '\n').format(ident)
+        else:
+            blocks.PLUGIN_member_include = ''
+            blocks.PLUGIN_member_init = (
+                '        registerMethod("echo",      make_method(this, &{0}API::echo));\n'
+                '        registerMethod("testEvent", make_method(this, &{0}API::testEvent));\n'
+                '        \n'
+                '        // Read-write property\n'
+                '        registerProperty("testString",\n'
+                '                         make_property(this,\n'
+                '                                       &{0}API::get_testString,\n'
+                '                                       &{0}API::set_testString));\n'
+                '        \n'
+                '        // Read-only property\n'
+                '        registerProperty("version",\n'
+                '                         make_property(this,\n'
+                '                                       &{0}API::get_version));\n').format(ident)
+            blocks.PLUGIN_member_table = ''
+        if plugin.timing_hooks == "true":
+            blocks.PLUGIN_timing_init = (
+                '\n'
+                '        // Per-method invocation timing; read the collected numbers from\n'
+                '        // javascript through the reserved "memberStats" property\n'
+                '        setMemberStatsEnabled(true);\n')
+        else:
+            blocks.PLUGIN_timing_init = ''
+        return blocks
+
 SENTENCE_SYMBOLS_RE = re.compile(r"^[()\w .:,;!?-]+$")
 SENTENCE_SYMBOLS_WARNING = 'must be at least one character long and may only' \
                            ' and may only contain letters, digits, spaces, ' \
@@ -91,6 +154,12 @@ class Base(object):
                       " format: application/x-firebreath"),
             disable_gui=("has no UI", re.compile(r"^true$|false$"),
                          "Please enter valid input: true or false"),
+            static_members=("uses a static member table",
+                            re.compile(r"^true$|false$"),
+                            "Please enter valid input: true or false"),
+            timing_hooks=("enables per-method timing hooks",
+                          re.compile(r"^true$|false$"),
+                          "Please enter valid input: true or false"),
         )
 
     def getValue(self, key, default):
@@ -208,6 +277,8 @@ class Plugin(Base):
     desc = None
     mimetype = None
     disable_gui = None
+    static_members = None
+    timing_hooks = None
 
     def makeDefaultPrefix(self, startName, delim=" "):
         MIN_LEN_PREFIX = 3
@@ -258,6 +329,11 @@ class Plugin(Base):
         self.desc = self.getValue("desc", self.desc)
         self.disable_gui = self.getValue("disable_gui", self.disable_gui or
                                          "false").lower()
+        self.static_members = self.getValue("static_members",
+                                            self.static_members or
+                                            "false").lower()
+        self.timing_hooks = self.getValue("timing_hooks", self.timing_hooks or
+                                          "false").lower()
 
     def readCfg(self, cfg):
         if not cfg.has_section("plugin"):
@@ -270,6 +346,12 @@ class Plugin(Base):
 
         if self.disable_gui is None:
             self.disable_gui = cfg.get("plugin", "disable_gui") or False
+        if self.static_members is None and cfg.has_option("plugin",
+                                                          "static_members"):
+            self.static_members = cfg.get("plugin", "static_members")
+        if self.timing_hooks is None and cfg.has_option("plugin",
+                                                        "timing_hooks"):
+            self.timing_hooks = cfg.get("plugin", "timing_hooks")
 
     def updateCfg(self, cfg):
         if not cfg.has_section("plugin"):
@@ -280,6 +362,8 @@ class Plugin(Base):
         cfg.set("plugin", "mimetype", self.mimetype)
         cfg.set("plugin", "description", self.desc)
         cfg.set("plugin", "disable_gui", self.disable_gui)
+        cfg.set("plugin", "static_members", self.static_members or "false")
+        cfg.set("plugin", "timing_hooks", self.timing_hooks or "false")
 
     def __str__(self):
         return '\nPlugin Details:\n--------------\nName:        {0}' \
@@ -10,7 +10,7 @@
 #include "JSAPIAuto.h"
 #include "BrowserHost.h"
 #include "@{PLUGIN_ident}.h"
-
+@{PLUGIN_member_include}
 #ifndef H_@{PLUGIN_ident}API
 #define H_@{PLUGIN_ident}API
 
@@ -31,20 +31,7 @@ public:
     @{PLUGIN_ident}API(const @{PLUGIN_ident}Ptr& plugin, const FB::BrowserHostPtr& host) :
         m_plugin(plugin), m_host(host)
     {
-        registerMethod("echo",      make_method(this, &@{PLUGIN_ident}API::echo));
-        registerMethod("testEvent", make_method(this, &@{PLUGIN_ident}API::testEvent));
-        
-        // Read-write property
-        registerProperty("testString",
-                         make_property(this,
-                                       &@{PLUGIN_ident}API::get_testString,
-                                       &@{PLUGIN_ident}API::set_testString));
-        
-        // Read-only property
-        registerProperty("version",
-                         make_property(this,
-                                       &@{PLUGIN_ident}API::get_version));
-    }
+@{PLUGIN_member_init}@{PLUGIN_timing_init}    }
 
     ///////////////////////////////////////////////////////////////////////////////
     /// @@fn @{PLUGIN_ident}API::~@{PLUGIN_ident}API()
@@ -75,7 +62,7 @@ public:
     void testEvent();
 
 private:
-    @{PLUGIN_ident}WeakPtr m_plugin;
+@{PLUGIN_member_table}    @{PLUGIN_ident}WeakPtr m_plugin;
     FB::BrowserHostPtr m_host;
 
     std::string m_testString;
@@ -23,6 +23,8 @@ Element::Element(const FB::JSObjectPtr& element, IWebBrowser *web)
 {
     if (!m_axDisp)
         throw std::bad_cast();
+    m_axElem = m_axDisp;
+    m_axElem2 = m_axDisp;
 }
 
 Element::~Element()
@@ -31,7 +33,7 @@ Element::~Element()
 
 std::vector<FB::DOM::ElementPtr> Element::getElementsByTagName(const std::string& tagName) const
 {
-    CComQIPtr<IHTMLElement2> elem(m_axDisp);
+    CComQIPtr<IHTMLElement2> elem(m_axElem2);
     CComQIPtr<IHTMLDocument3> doc(m_axDisp);
     CComPtr<IHTMLElementCollection> list;
     std::vector<FB::DOM::ElementPtr> tagList;
@@ -58,12 +60,10 @@ std::vector<FB::DOM::ElementPtr> Element::getElementsByTagName(const std::string
 
 std::string FB::ActiveX::AXDOM::Element::getStringAttribute( const std::string& attr ) const
 {
-    CComQIPtr<IHTMLElement> elem(m_axDisp);
-    CComQIPtr<IHTMLDocument5> doc(m_axDisp);
     CComVariant var;
     HRESULT hr = S_OK;
-    if (elem) {
-        hr = elem->getAttribute(CComBSTR(FB::utf8_to_wstring(attr).c_str()), 0, &var);
+    if (m_axElem) {
+        hr = m_axElem->getAttribute(CComBSTR(FB::utf8_to_wstring(attr).c_str()), 0, &var);
         return FB::ptr_cast<ActiveXBrowserHost>(getJSObject()->getHost())->getVariant(&var).convert_cast<std::string>();
     } else {
         return getProperty<std::string>(attr);
@@ -73,8 +73,7 @@ std::string FB::ActiveX::AXDOM::Element::getStringAttribute( const std::string&
 std::string FB::ActiveX::AXDOM::Element::getInnerHTML() const
 {
     CComBSTR htmlStr;
-    CComQIPtr<IHTMLElement> elem(m_axDisp);
-    HRESULT hr = elem->get_innerHTML(&htmlStr);
+    HRESULT hr = m_axElem->get_innerHTML(&htmlStr);
     if (SUCCEEDED(hr)) {
         CComVariant var(htmlStr);
         return FB::ptr_cast<ActiveXBrowserHost>(getJSObject()->getHost())->getVariant(&var).convert_cast<std::string>();
@@ -86,10 +85,118 @@ std::string FB::ActiveX::AXDOM::Element::getInnerHTML() const
 void FB::ActiveX::AXDOM::Element::setInnerHTML( const std::string& html ) const
 {
     CComBSTR newHtml(html.c_str());
-    CComQIPtr<IHTMLElement> elem(m_axDisp);
-    HRESULT hr = elem->put_innerHTML(newHtml);
+    HRESULT hr = m_axElem->put_innerHTML(newHtml);
     if (!SUCCEEDED(hr)) {
         throw FB::script_error("Could not set innerHtml");
     }
 }
 
+int FB::ActiveX::AXDOM::Element::getWidth() const
+{
+    // width is an attribute, not a vtable member, but the native getAttribute still
+    // skips the scriptable wrapper's name lookup + Invoke round trip
+    if (m_axElem) {
+        CComVariant var;
+        if (SUCCEEDED(m_axElem->getAttribute(CComBSTR(L"width"), 0, &var))) {
+            return FB::ptr_cast<ActiveXBrowserHost>(getJSObject()->getHost())->getVariant(&var).convert_cast<int>();
+        }
+    }
+    return FB::DOM::Element::getWidth();
+}
+
+void FB::ActiveX::AXDOM::Element::setWidth( const int width ) const
+{
+    if (m_axElem && SUCCEEDED(m_axElem->setAttribute(CComBSTR(L"width"), CComVariant(width), 0)))
+        return;
+    FB::DOM::Element::setWidth(width);
+}
+
+int FB::ActiveX::AXDOM::Element::getScrollWidth() const
+{
+    long width(0);
+    if (m_axElem2 && SUCCEEDED(m_axElem2->get_scrollWidth(&width)))
+        return width;
+    return FB::DOM::Element::getScrollWidth();
+}
+
+int FB::ActiveX::AXDOM::Element::getHeight() const
+{
+    if (m_axElem) {
+        CComVariant var;
+        if (SUCCEEDED(m_axElem->getAttribute(CComBSTR(L"height"), 0, &var))) {
+            return FB::ptr_cast<ActiveXBrowserHost>(getJSObject()->getHost())->getVariant(&var).convert_cast<int>();
+        }
+    }
+    return FB::DOM::Element::getHeight();
+}
+
+void FB::ActiveX::AXDOM::Element::setHeight( const int height ) const
+{
+    if (m_axElem && SUCCEEDED(m_axElem->setAttribute(CComBSTR(L"height"), CComVariant(height), 0)))
+        return;
+    FB::DOM::Element::setHeight(height);
+}
+
+int FB::ActiveX::AXDOM::Element::getScrollHeight() const
+{
+    long height(0);
+    if (m_axElem2 && SUCCEEDED(m_axElem2->get_scrollHeight(&height)))
+        return height;
+    return FB::DOM::Element::getScrollHeight();
+}
+
+int FB::ActiveX::AXDOM::Element::getChildNodeCount() const
+{
+    if (m_axNode) {
+        CComPtr<IDispatch> childDisp;
+        if (SUCCEEDED(m_axNode->get_childNodes(&childDisp))) {
+            CComQIPtr<IHTMLDOMChildrenCollection> children(childDisp);
+            long length(0);
+            if (children && SUCCEEDED(children->get_length(&length)))
+                return length;
+        }
+    }
+    return FB::DOM::Element::getChildNodeCount();
+}
+
+FB::DOM::ElementPtr FB::ActiveX::AXDOM::Element::getParentNode() const
+{
+    if (m_axNode) {
+        CComPtr<IHTMLDOMNode> parent;
+        if (SUCCEEDED(m_axNode->get_parentNode(&parent)) && parent) {
+            CComQIPtr<IDispatch> disp(parent);
+            FB::JSObjectPtr obj(IDispatchAPI::create(disp, FB::ptr_cast<ActiveXBrowserHost>(getJSObject()->getHost())));
+            return FB::DOM::Element::create(obj);
+        }
+    }
+    return FB::DOM::Element::getParentNode();
+}
+
+std::string FB::ActiveX::AXDOM::Element::getStyleProperty( const std::string& name ) const
+{
+    if (m_axElem) {
+        CComPtr<IHTMLStyle> style;
+        if (SUCCEEDED(m_axElem->get_style(&style)) && style) {
+            CComVariant var;
+            if (SUCCEEDED(style->getAttribute(CComBSTR(FB::utf8_to_wstring(name).c_str()), 0, &var))) {
+                return FB::ptr_cast<ActiveXBrowserHost>(getJSObject()->getHost())->getVariant(&var).convert_cast<std::string>();
+            }
+        }
+    }
+    // Fall back to element.style[name] through the scriptable wrapper
+    return getElement("style")->getProperty<std::string>(name);
+}
+
+void FB::ActiveX::AXDOM::Element::setStyleProperty( const std::string& name, const std::string& value ) const
+{
+    if (m_axElem) {
+        CComPtr<IHTMLStyle> style;
+        if (SUCCEEDED(m_axElem->get_style(&style)) && style) {
+            CComVariant var(FB::utf8_to_wstring(value).c_str());
+            if (SUCCEEDED(style->setAttribute(CComBSTR(FB::utf8_to_wstring(name).c_str()), var, 0)))
+                return;
+        }
+    }
+    getElement("style")->setProperty(name, value);
+}
+
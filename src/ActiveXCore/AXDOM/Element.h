@@ -44,9 +44,50 @@ namespace FB { namespace ActiveX {
             virtual std::string getInnerHTML() const;
             virtual void setInnerHTML(const std::string& html) const;
 
+            // Typed fast paths; these call the native mshtml vtable interfaces directly
+            // instead of going through name lookup + Invoke on the generic IDispatch
+            // wrapper.  Each falls back to the generic DOM implementation if the wrapped
+            // object doesn't support the needed interface.
+            virtual int getWidth() const;
+            virtual void setWidth(const int width) const;
+            virtual int getScrollWidth() const;
+            virtual int getHeight() const;
+            virtual void setHeight(const int height) const;
+            virtual int getScrollHeight() const;
+            virtual int getChildNodeCount() const;
+            virtual FB::DOM::ElementPtr getParentNode() const;
+
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            /// @fn std::string getStyleProperty(const std::string& name) const
+            ///
+            /// @brief  Reads an inline style property through IHTMLStyle
+            ///
+            /// Equivalent to element.style[name], but goes straight to the native style
+            /// object instead of fetching a scriptable style wrapper and dispatching the
+            /// property by name through it.
+            ///
+            /// @since 1.7
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            std::string getStyleProperty(const std::string& name) const;
+
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            /// @fn void setStyleProperty(const std::string& name, const std::string& value) const
+            ///
+            /// @brief  Sets an inline style property through IHTMLStyle
+            ///
+            /// @since 1.7
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            void setStyleProperty(const std::string& name, const std::string& value) const;
+
         public:
             CComQIPtr<IDispatch> m_axDisp;
             CComPtr<IWebBrowser> m_webBrowser;
+
+        protected:
+            // QIed once at construction so the hot accessors don't pay a QueryInterface
+            // per call; NULL when the wrapped object isn't an element (e.g. Document)
+            CComQIPtr<IHTMLElement> m_axElem;
+            CComQIPtr<IHTMLElement2> m_axElem2;
         };
 
     };
@@ -20,7 +20,7 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include "DOM/Document.h"
 #include "DOM/Window.h"
 #include "AsyncFunctionCall.h"
-#include "Win/WinMessageWindow.h"
+#include "Win/WinAsyncDispatchWindow.h"
 #include "AXDOM/Window.h"
 #include "AXDOM/Document.h"
 #include "AXDOM/Element.h"
@@ -36,8 +36,9 @@ using namespace FB;
 using namespace FB::ActiveX;
 
 ActiveXBrowserHost::ActiveXBrowserHost(IWebBrowser2 *doc, IOleClientSite* site)
-    : m_messageWin(new FB::WinMessageWindow())
+    : m_asyncSinkRegistered(true)
 {
+    FB::WinAsyncDispatchWindow::getInstance().registerSink(this);
     resume(doc, site);
 }
 
@@ -50,10 +51,10 @@ ActiveXBrowserHost::~ActiveXBrowserHost(void)
 bool ActiveXBrowserHost::_scheduleAsyncCall(void (*func)(void *), void *userData) const
 {
     boost::shared_lock<boost::shared_mutex> _l(m_xtmutex);
-    if (!isShutDown() && m_messageWin) {
+    if (!isShutDown() && m_asyncSinkRegistered) {
         FBLOG_TRACE("ActiveXHost", "Scheduling async call for main thread");
-        return ::PostMessage(m_messageWin->getHWND(), WM_ASYNCTHREADINVOKE, NULL, 
-            (LPARAM)new FB::AsyncFunctionCall(func, userData)) ? true : false;
+        return FB::WinAsyncDispatchWindow::getInstance().scheduleAsyncCall(
+            const_cast<ActiveXBrowserHost*>(this), func, userData);
     } else {
         return false;
     }
@@ -109,11 +110,14 @@ FB::DOM::WindowPtr ActiveXBrowserHost::getDOMWindow()
 
 FB::DOM::ElementPtr ActiveXBrowserHost::getDOMElement()
 {
-    CComQIPtr<IOleControlSite> site(m_spClientSite);
-    CComPtr<IDispatch> dispatch;
-    site->GetExtendedControl(&dispatch);
-    CComQIPtr<IHTMLElement2> htmlElement(dispatch);
-    return DOM::Document::create(IDispatchAPI::create(htmlElement, ptr_cast<ActiveXBrowserHost>(shared_from_this())));
+    if (!m_element) {
+        CComQIPtr<IOleControlSite> site(m_spClientSite);
+        CComPtr<IDispatch> dispatch;
+        site->GetExtendedControl(&dispatch);
+        CComQIPtr<IHTMLElement2> htmlElement(dispatch);
+        m_element = DOM::Document::create(IDispatchAPI::create(htmlElement, ptr_cast<ActiveXBrowserHost>(shared_from_this())));
+    }
+    return m_element;
 }
 
 void ActiveXBrowserHost::evaluateJavaScript(const std::string &script)
@@ -139,8 +143,10 @@ void ActiveXBrowserHost::shutdown()
     {
         // First, make sure that no async calls are made while we're shutting down
         boost::upgrade_lock<boost::shared_mutex> _l(m_xtmutex);
-        // Next, kill the message window so that none that have been made go through
-        m_messageWin.reset();
+        // Next, unregister from the shared dispatch window so that none that have
+        // been made go through; this also discards anything still queued for us
+        FB::WinAsyncDispatchWindow::getInstance().unregisterSink(this);
+        m_asyncSinkRegistered = false;
     }
     ReleaseAllHeldObjects();
 
@@ -165,6 +171,7 @@ void ActiveXBrowserHost::suspend()
     // These are created on demand, don't need to be restored
     m_window.reset();
     m_document.reset();
+    m_element.reset();
 
     DoDeferredRelease();
 }
@@ -256,16 +263,13 @@ void ActiveXBrowserHost::getComVariant(VARIANT *dest, const FB::variant &var)
     CComVariant outVar;
     ::VariantInit(dest);
 
-    const ComVariantBuilderMap& builderMap = getComVariantBuilderMap();
-    const std::type_info& type = var.get_type();
-    ComVariantBuilderMap::const_iterator it = builderMap.find(&type);
-    
-    if (it == builderMap.end()) {
+    ComVariantBuilder builder = getComVariantBuilder(var.get_type());
+    if (!builder) {
         // unhandled type :(
         return;
     }
-    
-    outVar = (it->second)(FB::ptr_cast<ActiveXBrowserHost>(shared_from_this()), var);
+
+    outVar = builder(FB::ptr_cast<ActiveXBrowserHost>(shared_from_this()), var);
 
     outVar.Detach(dest);
 }
@@ -301,11 +305,24 @@ bool isExpired(std::pair<void*, FB::WeakIDispatchExRef> cur) {
     return cur.second.expired();
 }
 
-void ActiveXBrowserHost::DoDeferredRelease() const
+namespace {
+    // Upper bound on how many deferred objects get released per batch; under
+    // heavy object churn this keeps any one pass from stalling the main thread
+    const size_t DeferredReleaseBatchLimit = 256;
+}
+
+bool ActiveXBrowserHost::drainDeferredObjects( const size_t limit ) const
 {
     assertMainThread();
-    IDispatchWRef deferred;
-    while (m_deferredObjects.try_pop(deferred)) {
+    // Swap the pending objects out wholesale so the queue lock is taken once
+    // per batch instead of once per object
+    if (m_drainingObjects.empty()) {
+        m_deferredObjects.try_pop_all(m_drainingObjects);
+    }
+    size_t count(0);
+    while (!m_drainingObjects.empty() && count++ < limit) {
+        IDispatchWRef deferred(m_drainingObjects.front());
+        m_drainingObjects.pop();
         if (deferred.expired())
             continue;
         IDispatchSRef ptr(deferred.lock());
@@ -318,6 +335,16 @@ void ActiveXBrowserHost::DoDeferredRelease() const
             } else ++it;
         }
         ptr->getPtr()->Release();
+        // Flag any wrapper still holding this reference strongly that the COM
+        // object behind it is gone (see ShareableReference::isValid)
+        ptr->invalidate();
+    }
+    return !m_drainingObjects.empty() || !m_deferredObjects.empty();
+}
+
+void ActiveXBrowserHost::DoDeferredRelease() const
+{
+    while (drainDeferredObjects(DeferredReleaseBatchLimit)) {
     }
     // Also remove any expired cached IDispatch WeakReferences
     IDispatchExRefMap::iterator iter = m_cachedIDispatch.begin();
@@ -335,7 +362,9 @@ void FB::ActiveX::ActiveXBrowserHost::deferred_release( const IDispatchWRef& obj
 {
     m_deferredObjects.push(obj);
     if (isMainThread()) {
-        DoDeferredRelease();
+        // Release a bounded batch; anything left over is picked up the next
+        // time we come through here or by the next full DoDeferredRelease
+        drainDeferredObjects(DeferredReleaseBatchLimit);
     }
 }
 
@@ -367,7 +396,7 @@ IDispatchEx* FB::ActiveX::ActiveXBrowserHost::getJSAPIWrapper( const FB::JSAPIWe
     return ret;
 }
 
-FB::ActiveX::IDispatchWRef FB::ActiveX::ActiveXBrowserHost::getIDispatchRef( IDispatch* obj )
+FB::ActiveX::IDispatchSRef FB::ActiveX::ActiveXBrowserHost::getIDispatchRef( IDispatch* obj )
 {
     IDispatchSRef ref(boost::make_shared<FB::ShareableReference<IDispatch> >(obj));
     obj->AddRef();
@@ -379,6 +408,7 @@ void FB::ActiveX::ActiveXBrowserHost::ReleaseAllHeldObjects()
 {
     for (IDispatchRefList::iterator it(m_heldIDispatch.begin()); it != m_heldIDispatch.end(); ++it) {
         (*it)->getPtr()->Release();
+        (*it)->invalidate();
     }
     m_heldIDispatch.clear();
 }
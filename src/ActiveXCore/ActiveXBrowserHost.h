@@ -29,6 +29,7 @@ Copyright 2009 Richard Bateman, Firebreath development team
 
 namespace FB {
     class WinMessageWindow;
+    class WinAsyncDispatchWindow;
     class BrowserStreamRequest;
     namespace ActiveX {
         FB_FORWARD_PTR(ActiveXBrowserHost);
@@ -55,7 +56,10 @@ namespace FB {
             virtual FB::BrowserStreamPtr _createUnsolicitedStream(const BrowserStreamRequest& req) const { return FB::BrowserStreamPtr(); }
 
             IDispatchEx* getJSAPIWrapper(const FB::JSAPIWeakPtr& api, bool autoRelease = false);
-            IDispatchWRef getIDispatchRef(IDispatch* obj);
+            // Returns the strong reference so callers that poll validity with a plain
+            // load (see ShareableReference::isValid) can hold it without a promotion;
+            // it converts implicitly where only a weak ref is wanted
+            IDispatchSRef getIDispatchRef(IDispatch* obj);
 
         public:
             FB::DOM::DocumentPtr getDOMDocument();
@@ -85,11 +89,14 @@ namespace FB {
             CComPtr<IWebBrowser2> m_webBrowser;
             mutable FB::DOM::WindowPtr m_window;
             mutable FB::DOM::DocumentPtr m_document;
-            boost::scoped_ptr<FB::WinMessageWindow> m_messageWin;
+            mutable FB::DOM::ElementPtr m_element;
+            // Registered with the shared WinAsyncDispatchWindow while async calls are allowed
+            bool m_asyncSinkRegistered;
 
         private:
             mutable boost::shared_mutex m_xtmutex;
             mutable FB::SafeQueue<IDispatchWRef> m_deferredObjects;
+            mutable std::queue<IDispatchWRef> m_drainingObjects; // only touched on the main thread
             typedef std::map<void*, FB::WeakIDispatchExRef> IDispatchExRefMap;
             typedef std::list<IDispatchSRef> IDispatchRefList;
             mutable IDispatchExRefMap m_cachedIDispatch;
@@ -100,6 +107,9 @@ namespace FB {
             void getComVariant(VARIANT *dest, const FB::variant &var);
             void deferred_release( const IDispatchWRef& obj ) const;
             void DoDeferredRelease() const;
+        protected:
+            bool drainDeferredObjects(const size_t limit) const;
+        public:
             void ReleaseAllHeldObjects();
         };
     }
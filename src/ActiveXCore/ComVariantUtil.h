@@ -17,7 +17,8 @@
 #ifndef FB_H_CComVariantUTIL
 #define FB_H_CComVariantUTIL
 
-#include <map>
+#include <algorithm>
+#include <vector>
 #include <string>
 #include <typeinfo>
 
@@ -49,23 +50,45 @@ namespace FB { namespace ActiveX
     };
     
     typedef CComVariant (*ComVariantBuilder)(const ActiveXBrowserHostPtr&, const FB::variant&);    
-    typedef std::map<std::type_info const*, ComVariantBuilder, type_info_less> ComVariantBuilderMap;
+
+    // Builders live in a flat array sorted with type_info_less; getComVariantBuilder does a
+    // binary search over the contiguous entries, which beats chasing std::map nodes on a
+    // lookup that happens for every argument and return value crossing the bridge
+    struct ComVariantBuilderEntry {
+        const std::type_info* type;
+        ComVariantBuilder builder;
+    };
+    typedef std::vector<ComVariantBuilderEntry> ComVariantBuilderTable;
 
     namespace {
-        ComVariantBuilderMap comVariantBuilderMap;
+        ComVariantBuilderTable comVariantBuilderTable;
         boost::once_flag init_flag = BOOST_ONCE_INIT;
+
+        inline bool builderEntryLess(const ComVariantBuilderEntry& lhs, const ComVariantBuilderEntry& rhs)
+        {
+            return type_info_less()(lhs.type, rhs.type);
+        }
     }
 
     //  GJS  ---
-    //  I would probably put the ComVariantBuilderMap code into ComVariantUtil.cpp?
+    //  I would probably put the ComVariantBuilderTable code into ComVariantUtil.cpp?
     template<class T>
-    inline ComVariantBuilderMap::value_type makeBuilderEntry()
+    inline ComVariantBuilderEntry makeBuilderEntry()
     {
-        return ComVariantBuilderMap::value_type(&typeid(T), select_ccomvariant_builder::select<T>());
+        ComVariantBuilderEntry entry = { &typeid(T), select_ccomvariant_builder::select<T>() };
+        return entry;
     }
-    
-    inline void makeComVariantBuilderMap(ComVariantBuilderMap& tdm)
+
+    struct ComVariantTableInserter {
+        ComVariantBuilderTable& table;
+        ComVariantTableInserter(ComVariantBuilderTable& table) : table(table) {}
+        void insert(const ComVariantBuilderEntry& entry) { table.push_back(entry); }
+    };
+
+    inline void makeComVariantBuilderTable(ComVariantBuilderTable& table)
     {
+        table.reserve(24);
+        ComVariantTableInserter tdm(table);
         tdm.insert(makeBuilderEntry<bool>());
         tdm.insert(makeBuilderEntry<char>());
         tdm.insert(makeBuilderEntry<unsigned char>());
@@ -95,15 +118,28 @@ namespace FB { namespace ActiveX
 
         tdm.insert(makeBuilderEntry<FB::FBVoid>());
         tdm.insert(makeBuilderEntry<FB::FBNull>());
+
+        std::sort(table.begin(), table.end(), &builderEntryLess);
     }
     
-    inline const ComVariantBuilderMap& getComVariantBuilderMap()
+    inline const ComVariantBuilderTable& getComVariantBuilderTable()
     {
         // Thread safety is required because IE10+ can run
         // plug-ins in multiple threads within a single process.
-        boost::call_once(init_flag, boost::bind(&makeComVariantBuilderMap, boost::ref(comVariantBuilderMap)));
+        boost::call_once(init_flag, boost::bind(&makeComVariantBuilderTable, boost::ref(comVariantBuilderTable)));
 
-        return comVariantBuilderMap;
+        return comVariantBuilderTable;
+    }
+
+    inline ComVariantBuilder getComVariantBuilder(const std::type_info& type)
+    {
+        const ComVariantBuilderTable& table = getComVariantBuilderTable();
+        ComVariantBuilderEntry key = { &type, NULL };
+        ComVariantBuilderTable::const_iterator it =
+            std::lower_bound(table.begin(), table.end(), key, &builderEntryLess);
+        if (it != table.end() && !type.before(*it->type))
+            return it->builder;
+        return NULL;
     }
     //  GJS  ---
     
@@ -148,20 +184,26 @@ namespace FB { namespace ActiveX
         return out;
     }
 
+    // Attaches the BSTR directly instead of going CComBSTR -> CComVariant, which
+    // would SysAllocString the same characters a second time just to copy it
+    inline CComVariant makeBSTRComVariant(const std::wstring& wstr)
+    {
+        CComVariant out;
+        out.vt = VT_BSTR;
+        out.bstrVal = ::SysAllocStringLen(wstr.data(), static_cast<UINT>(wstr.size()));
+        return out;
+    }
+
     template<> inline
     CComVariant makeComVariant<std::string>(const ActiveXBrowserHostPtr& host, const FB::variant& var)
     {
-        std::wstring wstr = var.convert_cast<std::wstring>();
-        CComBSTR bStr(wstr.c_str());
-        return bStr;
+        return makeBSTRComVariant(var.convert_cast<std::wstring>());
     }
 
     template<> inline
     CComVariant makeComVariant<std::wstring>(const ActiveXBrowserHostPtr& host, const FB::variant& var)
     {
-        std::wstring wstr = var.convert_cast<std::wstring>();
-        CComBSTR bStr(wstr.c_str());
-        return bStr;
+        return makeBSTRComVariant(var.convert_cast<std::wstring>());
     }
     
     template<> inline
@@ -186,15 +228,12 @@ namespace FB { namespace ActiveX
         {
             CComSafeArray<VARIANT> sa;
 			sa.Create();
-            const ComVariantBuilderMap& builderMap = getComVariantBuilderMap();
             for (FB::VariantList::iterator itr = inArr.begin(); itr != inArr.end(); ++itr) {
-                const std::type_info& type = itr->get_type();
-                ComVariantBuilderMap::const_iterator found = builderMap.find(&type);
-
-                if (found == builderMap.end())
+                ComVariantBuilder builder = getComVariantBuilder(itr->get_type());
+                if (!builder)
                     continue;
 
-                CComVariant var = (found->second)(host, *itr);
+                CComVariant var = builder(host, *itr);
                 sa.Add(var);
             }
 
@@ -225,16 +264,14 @@ namespace FB { namespace ActiveX
         {
             CComSafeArray<VARIANT> sa;
 			sa.Create();
-            const ComVariantBuilderMap& builderMap = getComVariantBuilderMap();
             for (FB::VariantMap::iterator itr = inMap.begin(); itr != inMap.end(); ++itr) {
-                const std::type_info& valType = itr->second.get_type();
-                ComVariantBuilderMap::const_iterator valTypeFound = builderMap.find(&valType);
-                if (valTypeFound == builderMap.end())
+                ComVariantBuilder builder = getComVariantBuilder(itr->second.get_type());
+                if (!builder)
                     continue;
 
                 CComSafeArray<VARIANT> sa2;
                 CComVariant key = makeComVariant<std::string>(host, itr->first);
-                CComVariant val = (valTypeFound->second)(host, itr->second);
+                CComVariant val = builder(host, itr->second);
                 sa2.Add(key);
                 sa2.Add(val);
                 sa.Add(sa2.Detach());
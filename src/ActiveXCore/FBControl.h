@@ -23,6 +23,7 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include <ShlGuid.h>
 #include <mshtml.h>
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
 #include <boost/cast.hpp>
 #include <boost/scoped_array.hpp>
 #include "DOM/Window.h"
@@ -93,6 +94,7 @@ namespace FB {
 
             ActiveXBrowserHostPtr m_host;
             bool m_setReadyDone;
+            bool m_siteInterfacesAcquired;
 #ifdef FBWIN_ASYNCSURFACE
 			CComPtr<IViewObjectPresentSite> m_viewObjectPresentSite;
 #endif
@@ -104,7 +106,8 @@ namespace FB {
             // rough order that they will be called in.
             CFBControl() : JSAPI_IDispatchEx<CFBControlX, ICurObjInterface, piid>(pMT), FB::BrowserPlugin(pMT),
                 m_mimetype(pMT),
-                m_setReadyDone(false)
+                m_setReadyDone(false),
+                m_siteInterfacesAcquired(false)
             {
                 setFSPath(g_dllPath);
             }
@@ -118,6 +121,16 @@ namespace FB {
             virtual void setReady();
             virtual void setWindow(HWND);
             virtual void clientSiteSet();
+
+            // Runs the part of site setup that first paint doesn't need: the
+            // SID_SWebBrowserApp QueryService walk, property-notify wiring and the
+            // host's DOM document/window acquisition.  Idempotent; normally runs
+            // from a posted message after activation has returned to the container
+            virtual void acquireSiteInterfaces();
+
+            // Posted-message completion of setReady(): acquires the site interfaces
+            // and then delivers setReady to the plugin
+            void finishDeferredActivation();
             virtual DWORD getSupportedObjectSafety();
 
             STDMETHOD(GetInterfaceSafetyOptions)(REFIID riid, DWORD *pdwSupportedOptions,
@@ -288,6 +301,9 @@ namespace FB {
             if (m_webBrowser) {
                 m_propNotify = m_spClientSite;
             }
+            // No activation storm to dodge on the windowless path; everything is
+            // acquired by the time the host is built
+            m_siteInterfacesAcquired = true;
 
             // There will be no window this time!
             clientSiteSet();
@@ -307,18 +323,45 @@ namespace FB {
 #ifdef FBWIN_ASYNCSURFACE
             pClientSite->QueryInterface(__uuidof(IViewObjectPresentSite), (void **) &m_viewObjectPresentSite);
 #endif
-            m_serviceProvider = pClientSite;
-            if (!m_serviceProvider)
-                return E_FAIL;
-            m_serviceProvider->QueryService(SID_SWebBrowserApp, IID_IWebBrowser2, reinterpret_cast<void**>(&m_webBrowser));
-            m_serviceProvider.Release();
+            // Only the browser host is needed before first paint.  The QueryService
+            // walk for IWebBrowser2 and the DOM document/window acquisition serialize
+            // badly when a page activates several controls, so they run from a posted
+            // message once this activation has returned to the container
+            clientSiteSet();
+
+            boost::shared_ptr<FB::ShareableReference<CFBControlX> > ref(boost::make_shared<FB::ShareableReference<CFBControlX> >(this));
+            m_host->ScheduleOnMainThread(ref, boost::bind(&CFBControlX::acquireSiteInterfaces, this));
+            return S_OK;
+        }
+
+        template <const GUID* pFbCLSID, const char* pMT, class ICurObjInterface, const IID* piid, const GUID* plibid>
+        void CFBControl<pFbCLSID, pMT,ICurObjInterface,piid,plibid>::acquireSiteInterfaces()
+        {
+            if (m_siteInterfacesAcquired || !m_spClientSite || !pluginMain)
+                return;
+            m_siteInterfacesAcquired = true;
+
+            m_serviceProvider = m_spClientSite;
+            if (m_serviceProvider) {
+                m_serviceProvider->QueryService(SID_SWebBrowserApp, IID_IWebBrowser2, reinterpret_cast<void**>(&m_webBrowser));
+                m_serviceProvider.Release();
+            }
 
             if (m_webBrowser) {
                 m_propNotify = m_spClientSite;
             }
 
-            clientSiteSet();
-            return S_OK;
+            if (m_host)
+                m_host->resume(m_webBrowser, m_spClientSite);
+        }
+
+        template <const GUID* pFbCLSID, const char* pMT, class ICurObjInterface, const IID* piid, const GUID* plibid>
+        void CFBControl<pFbCLSID, pMT,ICurObjInterface,piid,plibid>::finishDeferredActivation()
+        {
+            if (!pluginMain || !m_host)
+                return;
+            acquireSiteInterfaces();
+            pluginMain->setReady();
         }
 
         template <const GUID* pFbCLSID, const char* pMT, class ICurObjInterface, const IID* piid, const GUID* plibid>
@@ -485,9 +528,19 @@ namespace FB {
             // (eg: if the object is reparented in the dom); only act on the first one.
             if (!m_setReadyDone) {
                 m_setReadyDone = true;
-                this->setAPI(pluginMain->getRootJSAPI(), m_host);
+                // defer JSAPI construction until the page first scripts against us;
+                // the root API is still owned by pluginMain once it exists
+                this->setAPIProvider(boost::bind(&FB::PluginCore::getRootJSAPI, pluginMain.get()), m_host);
                 setReadyState(READYSTATE_COMPLETE);
-                pluginMain->setReady();
+                if (m_siteInterfacesAcquired || !m_host) {
+                    pluginMain->setReady();
+                } else {
+                    // Activation fast path: return to the container now and run the
+                    // plugin's ready handler (which frequently touches the DOM) from
+                    // a posted message once the activation storm has unwound
+                    boost::shared_ptr<FB::ShareableReference<CFBControlX> > ref(boost::make_shared<FB::ShareableReference<CFBControlX> >(this));
+                    m_host->ScheduleOnMainThread(ref, boost::bind(&CFBControlX::finishDeferredActivation, this));
+                }
             }
         }
 
@@ -31,7 +31,8 @@ boost::shared_ptr<FB::ActiveX::IDispatchAPI> IDispatchAPI::create(IDispatch * ob
 }
 
 FB::ActiveX::IDispatchAPI::IDispatchAPI(IDispatch * obj, const ActiveXBrowserHostPtr& host) :
-    FB::JSObject(host), m_browser(host), m_obj(host->getIDispatchRef(obj)), is_JSAPI(false)
+    FB::JSObject(host), m_browser(host), m_obj(host->getIDispatchRef(obj)), is_JSAPI(false),
+    m_dispExFor(NULL), m_dispExSupported(false), m_dispIdGeneration(0)
 {
     FB::JSAPIPtr ptr(getJSAPI());
     
@@ -45,14 +46,45 @@ FB::ActiveX::IDispatchAPI::IDispatchAPI(IDispatch * obj, const ActiveXBrowserHos
 
 IDispatchAPI::~IDispatchAPI(void)
 {
-    if (!m_browser.expired())
+    if (!m_browser.expired()) {
         getHost()->deferred_release(m_obj);
+        if (m_dispEx && m_dispEx->isValid())
+            getHost()->deferred_release(m_dispEx);
+    }
     m_obj.reset();
+    m_dispEx.reset();
+}
+
+IDispatchEx* IDispatchAPI::getIDispatchEx() const
+{
+    // Like getIDForName this only ever runs on the main thread, so the cache needs
+    // no lock.  The QueryInterface used to be repeated on every call into the page;
+    // resolve it once per wrapped object and hand back the held pointer after that.
+    IDispatch* cur(getIDispatch());
+    if (m_dispExFor == cur) {
+        if (m_dispEx && m_dispEx->isValid())
+            return static_cast<IDispatchEx*>(m_dispEx->getPtr());
+        if (!m_dispExSupported)
+            return NULL;
+        // the held reference went away (host released it); fall through and re-resolve
+    }
+
+    if (m_dispEx && m_dispEx->isValid())
+        getHost()->deferred_release(m_dispEx);
+    m_dispEx.reset();
+
+    CComQIPtr<IDispatchEx> dispEx(cur);
+    m_dispExFor = cur;
+    m_dispExSupported = (dispEx != NULL);
+    if (!dispEx)
+        return NULL;
+    m_dispEx = getHost()->getIDispatchRef(dispEx.p);
+    return dispEx.p; // kept referenced by the host's held object list
 }
 
 void IDispatchAPI::getMemberNames(std::vector<std::string> &nameVector) const
 {
-    if (m_browser.expired() || m_obj.expired())
+    if (m_browser.expired() || !refValid())
         return;
 
     ActiveXBrowserHostPtr browser(getHost());
@@ -69,7 +101,7 @@ void IDispatchAPI::getMemberNames(std::vector<std::string> &nameVector) const
     }
 
     try {
-        CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+        CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
         if (!dispatchEx) {
             throw FB::script_error("Cannot enumerate members; IDispatchEx not supported");
         }
@@ -90,7 +122,7 @@ void IDispatchAPI::getMemberNames(std::vector<std::string> &nameVector) const
 
 size_t IDispatchAPI::getMemberCount() const
 {
-    if (m_browser.expired() || m_obj.expired())
+    if (m_browser.expired() || !refValid())
         return 0;
 
     ActiveXBrowserHostPtr browser(getHost());
@@ -109,7 +141,7 @@ size_t IDispatchAPI::getMemberCount() const
 
     size_t count = 0;
     try {
-        CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+        CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
         if (!dispatchEx) {
             return -1;
         }
@@ -127,36 +159,55 @@ size_t IDispatchAPI::getMemberCount() const
 
 DISPID IDispatchAPI::getIDForName(const std::wstring& name) const
 {
-    if (m_browser.expired() || m_obj.expired())
+    return getIDForName(FB::wstring_to_utf8(name));
+}
+
+DISPID IDispatchAPI::getIDForName(const std::string& name) const
+{
+    if (m_browser.expired() || !refValid())
         return DISPID_UNKNOWN;
 
     ActiveXBrowserHostPtr browser(getHost());
     if (!browser->isMainThread()) {
-        return browser->CallOnMainThread(boost::bind(&IDispatchAPI::getIDForName, this, name));
+        return browser->CallOnMainThread(boost::bind(
+            static_cast<DISPID (IDispatchAPI::*)(const std::string&) const>(&IDispatchAPI::getIDForName), this, name));
     }
 
     if (name.empty()) {
         return DISPID_VALUE;
     }
 
+    // Repeated Invoke/GetProperty on the same member would otherwise pay the
+    // GetDispID/GetIDsOfNames round-trip every time; a hit also skips the
+    // UTF-8 -> wide conversion and the BSTR allocated for GetDispID
+    DispIdCacheMap::iterator fnd = m_dispIdCache.find(name);
+    if (fnd != m_dispIdCache.end()) {
+        if (fnd->second.generation == m_dispIdGeneration)
+            return fnd->second.dispId;
+        m_dispIdCache.erase(fnd);
+    }
+
+    const std::wstring wName(FB::utf8_to_wstring(name));
     HRESULT hr = E_NOTIMPL;
     DISPID dispId = DISPID_UNKNOWN;
     try {
-        CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+        CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
         if (dispatchEx) {
-            hr = dispatchEx->GetDispID(CComBSTR(name.c_str()),
+            hr = dispatchEx->GetDispID(CComBSTR(wName.c_str()),
                 fdexNameEnsure | fdexNameCaseSensitive | 0x10000000, &dispId);
         } else {
-            const wchar_t* p = name.c_str();
+            const wchar_t* p = wName.c_str();
             hr = getIDispatch()->GetIDsOfNames(IID_NULL, const_cast<LPOLESTR*>(&p), 1, LOCALE_SYSTEM_DEFAULT, &dispId);
         }
 
         if (FAILED(hr)) {
             if (hr == E_NOTIMPL) {
-                return AxIdMap.getIdForValue(name); // Makes events possible
+                return AxIdMap.getIdForValue(wName); // Makes events possible
             }
             return DISPID_UNKNOWN;
         }
+        CachedDispId entry = { dispId, m_dispIdGeneration };
+        m_dispIdCache[name] = entry;
     } catch (...) {}
     return dispId;
 }
@@ -170,7 +221,7 @@ bool IDispatchAPI::HasMethod(const std::wstring& methodName) const
 
 bool IDispatchAPI::HasMethod(const std::string& methodName) const
 {
-    if (m_browser.expired() || m_obj.expired())
+    if (m_browser.expired() || !refValid())
         return false;
 
     ActiveXBrowserHostPtr browser(getHost());
@@ -189,7 +240,7 @@ bool IDispatchAPI::HasMethod(const std::string& methodName) const
 
     // This will actually just return true if the specified member exists; IDispatch doesn't really
     // differentiate further than that
-    return getIDForName(FB::utf8_to_wstring(methodName)) != -1 && !HasProperty(methodName);
+    return getIDForName(methodName) != -1 && !HasProperty(methodName);
 }
 
 bool IDispatchAPI::HasProperty(const std::wstring& propertyName) const
@@ -199,7 +250,7 @@ bool IDispatchAPI::HasProperty(const std::wstring& propertyName) const
 
 bool IDispatchAPI::HasProperty(const std::string& propertyName) const
 {
-    if (m_browser.expired() || m_obj.expired())
+    if (m_browser.expired() || !refValid())
         return false;
 
     ActiveXBrowserHostPtr browser(getHost());
@@ -216,7 +267,7 @@ bool IDispatchAPI::HasProperty(const std::string& propertyName) const
         return tmp->HasProperty(propertyName);
     }
 
-    DISPID dispId = getIDForName(FB::utf8_to_wstring(propertyName));
+    DISPID dispId = getIDForName(propertyName);
     if (dispId == DISPID_UNKNOWN && propertyName != "toString") {
         return false;
     }
@@ -230,7 +281,7 @@ bool IDispatchAPI::HasProperty(const std::string& propertyName) const
     CComVariant result;
     CComExcepInfo exceptionInfo;
     try {
-        CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+        CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
         if (dispatchEx) {
             hr = dispatchEx->InvokeEx(dispId, LOCALE_USER_DEFAULT, 
                 DISPATCH_PROPERTYGET, &params, &result, &exceptionInfo, NULL);
@@ -251,7 +302,7 @@ bool IDispatchAPI::HasProperty(int idx) const
 // Methods to manage properties on the API
 FB::variant IDispatchAPI::GetProperty(const std::string& propertyName)
 {
-    if (m_browser.expired() || m_obj.expired())
+    if (m_browser.expired() || !refValid())
         return FB::FBVoid();
 
     ActiveXBrowserHostPtr browser(getHost());
@@ -267,7 +318,7 @@ FB::variant IDispatchAPI::GetProperty(const std::string& propertyName)
         return tmp->GetProperty(propertyName);
     }
 
-    DISPID dispId = getIDForName(FB::utf8_to_wstring(propertyName));
+    DISPID dispId = getIDForName(propertyName);
     if (dispId == DISPID_UNKNOWN && propertyName != "toString") {
         throw FB::script_error("Could not get property");
     }
@@ -282,7 +333,7 @@ FB::variant IDispatchAPI::GetProperty(const std::string& propertyName)
     CComVariant result;
     CComExcepInfo exceptionInfo;
     try {
-        CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+        CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
         if (dispatchEx) {
             hr = dispatchEx->InvokeEx(dispId, LOCALE_USER_DEFAULT, DISPATCH_PROPERTYGET, &params,
                 &result, &exceptionInfo, NULL);
@@ -303,7 +354,7 @@ FB::variant IDispatchAPI::GetProperty(const std::string& propertyName)
 
 void IDispatchAPI::SetProperty(const std::string& propertyName, const FB::variant& value)
 {
-    if (m_browser.expired() || m_obj.expired())
+    if (m_browser.expired() || !refValid())
         return;
 
     ActiveXBrowserHostPtr browser(getHost());
@@ -319,7 +370,7 @@ void IDispatchAPI::SetProperty(const std::string& propertyName, const FB::varian
         return;
     }
 
-    DISPID dispId = getIDForName(FB::utf8_to_wstring(propertyName));
+    DISPID dispId = getIDForName(propertyName);
     if (dispId == DISPID_UNKNOWN) {
         throw FB::script_error("Could not set property");
     }
@@ -340,7 +391,7 @@ void IDispatchAPI::SetProperty(const std::string& propertyName, const FB::varian
     HRESULT hr;
     CComVariant result;
     CComExcepInfo exceptionInfo;
-    CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+    CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
     if (dispatchEx) {
         hr = dispatchEx->InvokeEx(dispId, LOCALE_USER_DEFAULT, DISPATCH_PROPERTYPUTREF, &params,
             &result, &exceptionInfo, NULL);
@@ -376,13 +427,13 @@ void IDispatchAPI::RemoveProperty(const std::string& propertyName)
         return;
     }
 
-    DISPID dispId = getIDForName(FB::utf8_to_wstring(propertyName));
+    DISPID dispId = getIDForName(propertyName);
     if (dispId == DISPID_UNKNOWN) {
         return;
     }
 
     HRESULT hr;
-    CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+    CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
     if (dispatchEx) {
         hr = dispatchEx->DeleteMemberByDispID(dispId);
     } else {
@@ -393,6 +444,8 @@ void IDispatchAPI::RemoveProperty(const std::string& propertyName)
     if (FAILED(hr)) {
         return;
     } else {
+        // The member layout changed; drop every cached DISPID for this object
+        invalidateMemberIds();
         // todo: we should probably remove the name from the afxmap, but this is a bit hairy as described at
         //        http://msdn.microsoft.com/en-us/library/sky96ah7(v=vs.94).aspx . So we'll ignore it for now.
     }
@@ -433,7 +486,7 @@ void IDispatchAPI::SetProperty(int idx, const FB::variant& value)
 // Methods to manage methods on the API
 FB::variant IDispatchAPI::Invoke(const std::string& methodName, const std::vector<FB::variant>& args)
 {
-    if (m_browser.expired() || m_obj.expired())
+    if (m_browser.expired() || !refValid())
         return FB::FBVoid();
 
     ActiveXBrowserHostPtr browser(getHost());
@@ -441,7 +494,7 @@ FB::variant IDispatchAPI::Invoke(const std::string& methodName, const std::vecto
         return browser->CallOnMainThread(boost::bind((FB::InvokeType)&IDispatchAPI::Invoke, this, methodName, args));
     }
 
-    DISPID dispId = getIDForName(FB::utf8_to_wstring(methodName));
+    DISPID dispId = getIDForName(methodName);
     if (dispId == DISPID_UNKNOWN) {
          throw FB::script_error("Method invoke failed");
     }
@@ -466,7 +519,7 @@ FB::variant IDispatchAPI::Invoke(const std::string& methodName, const std::vecto
 
     CComVariant result;
     CComExcepInfo exceptionInfo;
-    CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+    CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
     HRESULT hr;
     if (!dispatchEx) {
         hr = getIDispatch()->Invoke(dispId, IID_NULL, LOCALE_USER_DEFAULT,
@@ -521,7 +574,7 @@ void IDispatchAPI::callMultipleFunctions( const std::string& name, const FB::Var
         if (dispId == DISPID_UNKNOWN) {
              continue;
         }
-        CComQIPtr<IDispatchEx> dispatchEx(ptr->getIDispatch());
+        CComPtr<IDispatchEx> dispatchEx(ptr->getIDispatchEx());
         HRESULT hr;
         if (!dispatchEx) {
             hr = getIDispatch()->Invoke(dispId, IID_NULL, LOCALE_USER_DEFAULT,
@@ -535,11 +588,11 @@ void IDispatchAPI::callMultipleFunctions( const std::string& name, const FB::Var
     endit = ifaces.end();
     for (it; it != endit; ++it) {
         IDispatchAPIPtr ptr(boost::static_pointer_cast<IDispatchAPI>(*it));
-        DISPID dispId = getIDForName(FB::utf8_to_wstring(name));
+        DISPID dispId = getIDForName(name);
         if (dispId == DISPID_UNKNOWN) {
              continue;
         }
-        CComQIPtr<IDispatchEx> dispatchEx(ptr->getIDispatch());
+        CComPtr<IDispatchEx> dispatchEx(ptr->getIDispatchEx());
         HRESULT hr;
         if (!dispatchEx) {
             hr = getIDispatch()->Invoke(dispId, IID_NULL, LOCALE_USER_DEFAULT,
@@ -562,7 +615,7 @@ FB::variant IDispatchAPI::Construct(const std::vector<FB::variant>& args)
 
     }
 
-    DISPID dispId = getIDForName(FB::utf8_to_wstring(""));
+    DISPID dispId = getIDForName(std::string());
     if (dispId == DISPID_UNKNOWN) {
          throw FB::script_error("Constructor invoke failed");
     }
@@ -587,7 +640,7 @@ FB::variant IDispatchAPI::Construct(const std::vector<FB::variant>& args)
 
     CComVariant result;
     CComExcepInfo exceptionInfo;
-    CComQIPtr<IDispatchEx> dispatchEx(getIDispatch());
+    CComPtr<IDispatchEx> dispatchEx(getIDispatchEx());
     HRESULT hr;
     if (!dispatchEx) {
         hr = getIDispatch()->Invoke(dispId, IID_NULL, LOCALE_USER_DEFAULT,
@@ -605,7 +658,7 @@ FB::variant IDispatchAPI::Construct(const std::vector<FB::variant>& args)
 
 FB::JSAPIPtr IDispatchAPI::getJSAPI() const
 {
-    if (m_browser.expired() || m_obj.expired()) {
+    if (m_browser.expired() || !refValid()) {
         return FB::JSAPIPtr();
     }
     JSAPI_IDispatchExBase* p(NULL);
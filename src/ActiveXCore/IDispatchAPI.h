@@ -21,6 +21,7 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include "JSObject.h"
 #include "ActiveXBrowserHost.h"
 #include <atlctl.h>
+#include <map>
 #include <vector>
 #include <string>
 
@@ -39,8 +40,7 @@ namespace FB { namespace ActiveX {
 
         void *getEventId() const
         {
-            IDispatchSRef sref(m_obj.lock());
-            if (sref) return (void*)sref->getPtr();
+            if (refValid()) return (void*)m_obj->getPtr();
             else return NULL;
         }
         void *getEventContext() const {
@@ -48,10 +48,10 @@ namespace FB { namespace ActiveX {
             else return getHost()->getContextID();
         };
         IDispatch* getIDispatch() const {
-            IDispatchSRef sref(m_obj);
-            return sref->getPtr();
+            return m_obj ? m_obj->getPtr() : NULL;
         }
-        bool isValid() { return !m_obj.expired() && !m_browser.expired(); }
+        IDispatchEx* getIDispatchEx() const;
+        bool isValid() { return refValid() && !m_browser.expired(); }
         virtual bool supportsOptimizedCalls() const { return true; }
         virtual void callMultipleFunctions(const std::string& name, const FB::VariantList& args,
                                            const std::vector<JSObjectPtr>& direct,
@@ -70,13 +70,53 @@ namespace FB { namespace ActiveX {
             }
             return ptr;
         }
+        // The wrapped IDispatch is held through a strong ShareableReference: every
+        // scripting call used to promote a weak_ptr just to check the object was still
+        // alive.  The host's deferred-release machinery marks the reference invalid
+        // when it releases the COM object, so liveness is now a plain load of the
+        // reference's validity flag (see refValid)
         ActiveXBrowserHostWeakPtr m_browser;
-        IDispatchWRef m_obj;
+        IDispatchSRef m_obj;
         bool is_JSAPI;
         FB::JSAPIWeakPtr inner;
 
+        bool refValid() const { return m_obj && m_obj->isValid(); }
+
+        // Cached result of the IDispatchEx QueryInterface on m_obj; every scripting
+        // call used to redo that QI.  Resolved lazily on the main thread by
+        // getIDispatchEx, held alive through the host so the Release happens there too
+        mutable IDispatchSRef m_dispEx;
+        mutable IDispatch* m_dispExFor;
+        mutable bool m_dispExSupported;
+
     protected:
         DISPID getIDForName(const std::wstring& name) const;
+        DISPID getIDForName(const std::string& name) const;
+
+        // name -> DISPID resolutions cached per object; getIDForName always runs on the
+        // main thread, so the cache needs no lock.  Entries are tagged with the
+        // generation current when they were resolved; invalidateMemberIds bumps the
+        // generation, discarding every cached id in O(1).  Keyed by the UTF-8 name the
+        // scripting layer already has in hand, so a cache hit involves no wide-string
+        // conversion or BSTR allocation at all; the conversion only happens on a miss
+        struct CachedDispId {
+            DISPID dispId;
+            unsigned generation;
+        };
+        typedef std::map<std::string, CachedDispId> DispIdCacheMap;
+        mutable DispIdCacheMap m_dispIdCache;
+        mutable unsigned m_dispIdGeneration;
+
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void invalidateMemberIds() const
+        ///
+        /// @brief  Drops all cached name to DISPID resolutions for this object; call after an
+        ///         operation that may have changed the object's member layout
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void invalidateMemberIds() const {
+            ++m_dispIdGeneration;
+        }
 
     public:
         bool HasMethod(const std::string& methodName) const;
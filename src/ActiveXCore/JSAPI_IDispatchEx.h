@@ -16,6 +16,7 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #ifndef H_JSAPI_IDISPATCHEX
 #define H_JSAPI_IDISPATCHEX
 
+#include <boost/function.hpp>
 #include "ActiveXBrowserHost.h"
 #include "APITypes.h"
 #include "JSAPI.h"
@@ -25,9 +26,11 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include "axutil.h"
 
 #include "IDispatchAPI.h"
+#include "Util/ArgumentPool.h"
 #include "dispex.h"
 #include <map>
 #include "logging.h"
+#include "TraceEvents.h"
 #include <mshtmdid.h>
 
 MIDL_INTERFACE("a7f89004-620a-56e0-aeea-ec0e8da18fb3")
@@ -115,9 +118,29 @@ namespace FB { namespace ActiveX {
             m_host = host;
         }
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setAPIProvider(const boost::function<FB::JSAPIPtr()>& provider, const ActiveXBrowserHostPtr& host)
+        ///
+        /// @brief  Like setAPI, but defers creating the JSAPI until the page first touches it
+        ///
+        /// The provider (typically PluginCore::getRootJSAPI) runs on the first getAPI() call,
+        /// so instances the page never scripts against skip JSAPI construction entirely.
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setAPIProvider(const boost::function<FB::JSAPIPtr()>& provider, const ActiveXBrowserHostPtr& host)
+        {
+            m_apiProvider = provider;
+            m_host = host;
+        }
+
         FB::JSAPIPtr getAPI()
         {
             FB::JSAPIPtr api(m_api.lock());
+            if (!api && m_apiProvider) {
+                // deferred construction: first scripting touch builds the root JSAPI
+                api = m_apiProvider();
+                m_api = api;
+            }
             if (!api)
                 throw std::bad_cast();
             return api;
@@ -131,6 +154,7 @@ namespace FB { namespace ActiveX {
 
     protected:
         FB::JSAPIWeakPtr m_api;
+        boost::function<FB::JSAPIPtr()> m_apiProvider;
         IDisp_AttachEventPtr m_attachFunc;
         IDisp_DetachEventPtr m_detachFunc;
         IDisp_GetLastExceptionPtr m_getLastExceptionFunc;
@@ -150,7 +174,8 @@ namespace FB { namespace ActiveX {
         typedef std::map<DWORD, IDispatchAPIPtr> ConnectionPointMap;
 
     public:
-        JSAPI_IDispatchEx(const std::string& mimetype) : m_mimetype(mimetype), m_readyState(READYSTATE_LOADING) { };
+        JSAPI_IDispatchEx(const std::string& mimetype)
+            : m_mimetype(mimetype), m_readyState(READYSTATE_LOADING), m_dispIdCacheCount(0) { };
         virtual ~JSAPI_IDispatchEx(void) { };
         void setReadyState(READYSTATE newState)
         {
@@ -171,6 +196,57 @@ namespace FB { namespace ActiveX {
         bool m_valid;
         std::vector<std::wstring> m_memberList;
 
+        // What a DISPID resolved to the last time we looked it up on the API
+        enum MemberKind { MemberKind_Unknown = 0, MemberKind_Method, MemberKind_Property };
+        struct ResolvedMember {
+            std::wstring name;
+            MemberKind kind;
+        };
+        typedef std::map<DISPID, ResolvedMember> DispIdCache;
+
+        // IE resolves DISPIDs far more often than it invokes them, and every InvokeEx used to
+        // re-fetch the name from AxIdMap (variant conversion and all) and re-ask the JSAPI
+        // HasMethod/HasProperty.  This per-object cache makes the steady state a single map
+        // lookup; it is dropped whenever the member count changes, the same staleness check
+        // GetNextDispID uses for its enumeration list.  COM calls us on one apartment thread,
+        // so no locking is needed (m_memberList relies on the same guarantee).
+        DispIdCache m_dispIdCache;
+        size_t m_dispIdCacheCount;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool resolveDispId(const FB::JSAPIPtr& api, DISPID id, ResolvedMember& out)
+        ///
+        /// @brief  Resolves a DISPID to its member name and kind, caching the answer
+        ///
+        /// Returns false if the id was never assigned.  MemberKind_Unknown means the name is
+        /// assigned but the API currently has no such member.
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool resolveDispId(const FB::JSAPIPtr& api, DISPID id, ResolvedMember& out)
+        {
+            size_t count = api->getMemberCount();
+            if (count != m_dispIdCacheCount) {
+                m_dispIdCache.clear();
+                m_dispIdCacheCount = count;
+            }
+            typename DispIdCache::const_iterator fnd = m_dispIdCache.find(id);
+            if (fnd != m_dispIdCache.end()) {
+                out = fnd->second;
+                return true;
+            }
+            if (!AxIdMap.idExists(id))
+                return false;
+            out.name = AxIdMap.getValueForId<std::wstring>(id);
+            if (api->HasMethod(out.name))
+                out.kind = MemberKind_Method;
+            else if (api->HasProperty(out.name))
+                out.kind = MemberKind_Property;
+            else
+                out.kind = MemberKind_Unknown;
+            m_dispIdCache[id] = out;
+            return true;
+        }
+
         virtual bool callSetEventListener(const std::vector<FB::variant> &args, bool add);
 
     public:
@@ -361,11 +437,25 @@ namespace FB { namespace ActiveX {
             FB::JSAPIPtr api(getAPI());
             if ((wsName == L"attachEvent") || (wsName == L"detachEvent") || (wsName == L"getLastException")) {
                 *pid = AxIdMap.getIdForValue(wsName);
-            } else if (api->HasProperty(wsName) || api->HasMethod(wsName)) {
-                *pid = AxIdMap.getIdForValue(wsName);
             } else {
-                *pid = -1;
-                return DISP_E_UNKNOWNNAME;
+                ResolvedMember member;
+                member.name = wsName;
+                if (api->HasMethod(wsName))
+                    member.kind = MemberKind_Method;
+                else if (api->HasProperty(wsName))
+                    member.kind = MemberKind_Property;
+                else {
+                    *pid = -1;
+                    return DISP_E_UNKNOWNNAME;
+                }
+                *pid = AxIdMap.getIdForValue(wsName);
+                // seed the cache so the InvokeEx that follows is a single lookup
+                size_t count = api->getMemberCount();
+                if (count != m_dispIdCacheCount) {
+                    m_dispIdCache.clear();
+                    m_dispIdCacheCount = count;
+                }
+                m_dispIdCache[*pid] = member;
             }
             return S_OK;
         } catch (const std::exception &e) {
@@ -404,21 +494,22 @@ namespace FB { namespace ActiveX {
                                                  EXCEPINFO *pei, 
                                                  IServiceProvider *pspCaller)
     {
+        FBTRACE_SCOPE("ActiveXCore", "JSAPI_IDispatchEx::InvokeEx");
         FB::JSAPIPtr api;
         try {
             api = getAPI();
         } catch (...) {
             return DISP_E_MEMBERNOTFOUND;
         }
-        if (!AxIdMap.idExists(id)) {
+        ResolvedMember member;
+        if (!resolveDispId(api, id, member)) {
             return DISP_E_MEMBERNOTFOUND;
         }
 
-        std::wstring wsName;
+        std::wstring wsName(member.name);
 
-        try 
+        try
         {
-            wsName = AxIdMap.getValueForId<std::wstring>(id);
             ActiveXBrowserHostPtr host(getHost());
 
             if (wFlags & DISPATCH_PROPERTYGET) {
@@ -451,15 +542,15 @@ namespace FB { namespace ActiveX {
 				}
 			} else if (wsName == L"attachEvent" || wsName == L"detachEvent") {
                 if (wFlags & DISPATCH_METHOD) {
-                    std::vector<FB::variant> params;
+                    FB::detail::PooledArgumentList params;
                     for (int i = pdp->cArgs - 1; i >= 0; i--) {
-                        params.push_back(host->getVariant(&pdp->rgvarg[i]));
+                        params->push_back(host->getVariant(&pdp->rgvarg[i]));
                     }
 
                     if (wsName[0] == L'a') {
-                        m_attachFunc->exec(params);
+                        m_attachFunc->exec(*params);
                     } else {
-                        m_detachFunc->exec(params);
+                        m_detachFunc->exec(*params);
                     }
                 } else if (wFlags & DISPATCH_PROPERTYGET) {
                     FB::variant rVal;
@@ -471,48 +562,48 @@ namespace FB { namespace ActiveX {
                     host->getComVariant(pvarRes, rVal);
                 }
 
-            } else if (wFlags & DISPATCH_METHOD && (api->HasMethod(wsName) || !id) ) {
+            } else if (wFlags & DISPATCH_METHOD && (member.kind == MemberKind_Method || !id) ) {
 
-                std::vector<FB::variant> params;
+                FB::detail::PooledArgumentList params;
                 if (pdp->cNamedArgs > 0 && pdp->rgdispidNamedArgs[0] == DISPID_THIS) {
                     if (id == 0)
                         wsName = L"";
                     for (int i = pdp->cArgs - 1; i >= 1; i--) {
-                        params.push_back(host->getVariant(&pdp->rgvarg[i]));
+                        params->push_back(host->getVariant(&pdp->rgvarg[i]));
                     }
                 } else {
                     for (int i = pdp->cArgs - 1; i >= 0; i--) {
-                        params.push_back(host->getVariant(&pdp->rgvarg[i]));
+                        params->push_back(host->getVariant(&pdp->rgvarg[i]));
                     }
                 }
                 FB::variant rVal;
-                rVal = api->Invoke(wsName, params);
+                rVal = api->Invoke(wsName, *params);
                 
                 if(pvarRes)
                     host->getComVariant(pvarRes, rVal);
 
             } else if (wFlags & DISPATCH_CONSTRUCT) {
 
-                std::vector<FB::variant> params;
+                FB::detail::PooledArgumentList params;
                 if (pdp->cNamedArgs > 0 && pdp->rgdispidNamedArgs[0] == DISPID_THIS) {
                     if (id == 0)
                         wsName = L"";
                     for (int i = pdp->cArgs - 1; i >= 1; i--) {
-                        params.push_back(host->getVariant(&pdp->rgvarg[i]));
+                        params->push_back(host->getVariant(&pdp->rgvarg[i]));
                     }
                 } else {
                     for (int i = pdp->cArgs - 1; i >= 0; i--) {
-                        params.push_back(host->getVariant(&pdp->rgvarg[i]));
+                        params->push_back(host->getVariant(&pdp->rgvarg[i]));
                     }
                 }
                 FB::variant rVal;
-                rVal = api->Construct(params);
+                rVal = api->Construct(*params);
                 
                 if(pvarRes)
                     host->getComVariant(pvarRes, rVal);
 
 
-            } else if (wFlags & DISPATCH_PROPERTYGET && api->HasMethod(wsName)) {
+            } else if (wFlags & DISPATCH_PROPERTYGET && member.kind == MemberKind_Method) {
 
                 FB::variant rVal;
                 if (api->HasMethodObject(wsName))
@@ -521,7 +612,7 @@ namespace FB { namespace ActiveX {
                     rVal = true;
                 host->getComVariant(pvarRes, rVal);
 
-            } else if (wFlags & DISPATCH_PROPERTYGET && api->HasProperty(wsName)) {
+            } else if (wFlags & DISPATCH_PROPERTYGET && member.kind == MemberKind_Property) {
 
                 if(!pvarRes)
                     return E_INVALIDARG;
@@ -530,7 +621,7 @@ namespace FB { namespace ActiveX {
 
                 host->getComVariant(pvarRes, rVal);
 
-            } else if ((wFlags & DISPATCH_PROPERTYPUT || wFlags & DISPATCH_PROPERTYPUTREF) && api->HasProperty(wsName)) {
+            } else if ((wFlags & DISPATCH_PROPERTYPUT || wFlags & DISPATCH_PROPERTYPUTREF) && member.kind == MemberKind_Property) {
 
                 FB::variant newVal = host->getVariant(&pdp->rgvarg[0]);
                 api->SetProperty(wsName, newVal);
@@ -100,11 +100,43 @@ size_t ActiveXStream::signalDataArrived(void* buffer, size_t len, size_t offset)
         {
             StreamDataArrivedEvent ev(this, buffer, effectiveLen, offset, progress);
             SendEvent( &ev );
+            accountDelivered( effectiveLen );
         }
     }
     return effectiveLen;
 }
 
+size_t ActiveXStream::signalDataArrived(const FB::StreamDataSlice& slice, size_t offset)
+{
+    // The caller already owns the block; the event carries the slice so handlers can
+    // retain the data without anything being copied
+    size_t effectiveLen = slice.size();
+    if ( effectiveLen )
+    {
+        float progress = 0;
+        if ( getLength() )
+        {
+            progress = float( offset + effectiveLen ) / float( getLength() ) * 100.f;
+        }
+        if ( isOpen() || (getCacheFilename() != L"") )
+        {
+            StreamDataArrivedEvent ev(this, slice, offset, progress);
+            SendEvent( &ev );
+            accountDelivered( effectiveLen );
+        }
+    }
+    return effectiveLen;
+}
+
+void ActiveXStream::suspendProducer(bool suspend)
+{
+    // urlmon can pause the download itself; forward the stall to every active binding
+    for ( std::set<ActiveXStreamRequestPtr>::const_iterator it = requests.begin(); it != requests.end(); ++it )
+    {
+        (*it)->suspend( suspend );
+    }
+}
+
 void ActiveXStream::signalOpened()
 {
     setOpen( true );
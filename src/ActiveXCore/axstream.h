@@ -20,6 +20,10 @@ Copyright 2010 Richard Bateman, Firebreath development team
 #include <set>
 #include "boost/shared_ptr.hpp"
 
+namespace FB {
+    class StreamDataSlice;
+}
+
 namespace FB { namespace ActiveX {
     class ActiveXBindStatusCallback;
     class ActiveXStreamRequest;
@@ -43,6 +47,8 @@ namespace FB { namespace ActiveX {
         virtual bool    addRequest( const ActiveXStreamRequest& request );
 
         virtual size_t  signalDataArrived(void* buffer, size_t len, size_t offset);
+        virtual size_t  signalDataArrived(const FB::StreamDataSlice& slice, size_t offset);
+        virtual void    suspendProducer(bool suspend);
         virtual void    signalOpened();
         virtual void    signalFailedOpen();
         virtual void    signalCompleted(bool success);
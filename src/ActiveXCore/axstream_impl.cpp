@@ -18,6 +18,8 @@ Copyright 2010 Richard Bateman, Firebreath development team
 
 #include "axstream_impl.h"
 #include "axstream.h"
+#include "PluginEvents/StreamEvents.h"
+#include "StreamChunkPool.h"
 #include <tchar.h>
 #include <sstream>
 #include "wininet.h"
@@ -40,7 +42,7 @@ using namespace FB::ActiveX;
 // ---------------------------------------------------------------------------
 ActiveXBindStatusCallback::ActiveXBindStatusCallback() :
     m_pbinding(0), m_pstm(0), m_cRef(1), m_cbOld(0), m_dwAction( BINDVERB_GET ), m_fRedirect( FALSE ), m_transactionStarted( false ),
-    m_hDataToPost(NULL), m_cbDataToPost(0) 
+    m_hDataToPost(NULL), m_cbDataToPost(0), m_rangeOffset(0), m_rangeChecked(false)
 {
 }
 
@@ -173,6 +175,8 @@ ActiveXBindStatusCallback::OnStartBinding(DWORD dwReserved, IBinding* pbinding)
 
     // Cache the URLMON-provided IBinding interface so that we can control the download
     m_pbinding = pbinding;
+    m_rangeOffset = 0;
+    m_rangeChecked = false;
 
     if (m_pbinding != NULL)
     {
@@ -364,33 +368,53 @@ ActiveXBindStatusCallback::OnDataAvailable(DWORD grfBSCF, DWORD dwSize, FORMATET
         DWORD dwRead = dwSize - m_cbOld;    // Minimum amount available that hasn't been read
         DWORD dwActuallyRead = 0;           // Placeholder for amount read during this pull
 
-        DWORD offset = 0;
-        std::string data;
-        if ( GetInfo( HTTP_QUERY_CONTENT_RANGE, data ) )        // data look like bytes 0-3/4234
+        // The Content-Range header can't change within a binding, so parse it once per
+        // transfer instead of querying wininet on every OnDataAvailable
+        if ( !m_rangeChecked )
         {
-            size_t endPos = data.find( "-" );
-            if ( endPos != std::string::npos )
+            m_rangeChecked = true;
+            std::string data;
+            if ( GetInfo( HTTP_QUERY_CONTENT_RANGE, data ) )        // data look like bytes 0-3/4234
             {
-                size_t startPos = 6;        // "bytes "
-                offset = atol( data.substr(startPos, endPos - startPos).c_str() );
+                size_t endPos = data.find( "-" );
+                if ( endPos != std::string::npos )
+                {
+                    size_t startPos = 6;        // "bytes "
+                    m_rangeOffset = atol( data.substr(startPos, endPos - startPos).c_str() );
+                }
             }
         }
+        DWORD offset = m_rangeOffset;
 
         if (dwRead > 0)
-        do
         {
-            boost::shared_array<char> cur(new char[dwRead]);
-
-            hr = m_pstm->Read( cur.get(), dwRead, &dwActuallyRead);
-
-            // If we really read something then lets add it to the Edit box
-            if (dwActuallyRead > 0)
+            // One scatter block per notification instead of one heap block per Read call;
+            // each pull fills the next part of the block and is published as a refcounted
+            // slice of it, so handlers that retain data share the block instead of copying
+            const DWORD MinScatterSize = 256 * 1024;
+            DWORD blockSize = dwRead > MinScatterSize ? dwRead : MinScatterSize;
+            boost::shared_array<char> block(FB::StreamChunkPool::allocate(blockSize));
+            DWORD used = 0;
+            do
             {
-                if ( m_request->stream ) m_request->stream->signalDataArrived( cur.get(), dwActuallyRead, offset + m_cbOld );
-                m_cbOld += dwActuallyRead;
-            }
-
-        } while (!(hr == E_PENDING || hr == S_FALSE) && SUCCEEDED(hr));
+                if ( used == blockSize )
+                {
+                    // Ran past the available estimate; start a fresh block
+                    block = FB::StreamChunkPool::allocate(blockSize);
+                    used = 0;
+                }
+
+                hr = m_pstm->Read( block.get() + used, blockSize - used, &dwActuallyRead);
+
+                if (dwActuallyRead > 0)
+                {
+                    if ( m_request->stream ) m_request->stream->signalDataArrived( FB::StreamDataSlice( block, used, dwActuallyRead ), offset + m_cbOld );
+                    used += dwActuallyRead;
+                    m_cbOld += dwActuallyRead;
+                }
+
+            } while (!(hr == E_PENDING || hr == S_FALSE) && SUCCEEDED(hr));
+        }
     }
 
     // Clean up
@@ -542,6 +566,13 @@ bool ActiveXBindStatusCallback::close()
     return (!FAILED( hr )) || ( hr == S_FALSE ) || ( hr == INET_E_RESULT_DISPATCHED );
 }
 
+void ActiveXBindStatusCallback::suspendBinding( bool suspend )
+{
+    if ( !m_pbinding ) return;
+    if ( suspend ) m_pbinding->Suspend();
+    else m_pbinding->Resume();
+}
+
 
 ActiveXStreamRequest::ActiveXStreamRequest( ActiveXStreamPtr Stream ) : stream(Stream)
 {
@@ -576,3 +607,8 @@ bool ActiveXStreamRequest::stop()
     return retVal;
 }
 
+void ActiveXStreamRequest::suspend( bool suspend )
+{
+    if ( bindStatusCallback ) bindStatusCallback->suspendBinding( suspend );
+}
+
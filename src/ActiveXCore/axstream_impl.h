@@ -39,6 +39,7 @@ namespace FB { namespace ActiveX {
 
         bool start();
         bool stop();
+        void suspend( bool suspend );
 
     public:
         ActiveXStreamPtr      stream;
@@ -92,6 +93,7 @@ namespace FB { namespace ActiveX {
         HRESULT InitPostData(const char* szData);
 
         bool close();
+        void suspendBinding( bool suspend );
 
         bool GetInfo(DWORD which, std::string& result);
 
@@ -106,6 +108,8 @@ namespace FB { namespace ActiveX {
         DWORD           m_cbDataToPost;
         ActiveXStreamRequestPtr m_request;
         bool            m_transactionStarted;
+        DWORD           m_rangeOffset;      // start offset of this binding's Content-Range
+        bool            m_rangeChecked;     // Content-Range parsed for this binding
     };
 } }
 
@@ -0,0 +1,318 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "NpapiHostBench.h"
+
+using namespace FB::Npapi;
+using boost::posix_time::ptime;
+using boost::posix_time::microsec_clock;
+
+NpapiHostBench::Options::Options()
+    : instances(1), threads(1), durationMs(5000), targetCallsPerSec(0)
+    , invokeWeight(4), propertyWeight(4), eventWeight(1), streamWeight(1)
+    , mimeType("application/x-firebreath")
+    , method("echo"), property("version")
+    , streamBytes(64 * 1024), streamChunkBytes(16 * 1024)
+{
+}
+
+namespace {
+
+    enum OpType { Op_Invoke = 0, Op_Property, Op_Event, Op_Stream, Op_Count };
+
+    struct Instance {
+        NPP_t npp;
+        NPObject* root;
+    };
+
+    // Everything the workers share; set up once per run
+    struct BenchState {
+        const NpapiHostBench::Options* opts;
+        NPPluginFuncs* pluginFuncs;
+        std::vector<Instance>* instances;
+        NPIdentifier methodId;
+        NPIdentifier propertyId;
+        ptime deadline;
+        const char* streamData;
+    };
+
+    // Per-worker tallies and latency samples, merged after the join
+    struct WorkerResult {
+        boost::uint64_t attempts[Op_Count];
+        boost::uint64_t failures[Op_Count];
+        std::vector<boost::uint32_t> samples;
+
+        WorkerResult() {
+            for (int i = 0; i < Op_Count; ++i)
+                attempts[i] = failures[i] = 0;
+        }
+    };
+
+    // xorshift32; cheap, per-worker, and deterministic for a given seed
+    inline boost::uint32_t nextRand(boost::uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    bool doInvoke(const BenchState& st, const Instance& inst) {
+        NPVariant result;
+        VOID_TO_NPVARIANT(result);
+        bool ok = NpapiHost::NH_Invoke(const_cast<NPP>(&inst.npp), inst.root,
+                                       st.methodId, NULL, 0, &result);
+        if (ok)
+            NpapiHost::NH_ReleaseVariantValue(&result);
+        return ok;
+    }
+
+    bool doProperty(const BenchState& st, const Instance& inst) {
+        NPVariant result;
+        VOID_TO_NPVARIANT(result);
+        bool ok = NpapiHost::NH_GetProperty(const_cast<NPP>(&inst.npp), inst.root,
+                                            st.propertyId, &result);
+        if (ok)
+            NpapiHost::NH_ReleaseVariantValue(&result);
+        return ok;
+    }
+
+    bool doEvent(const BenchState& st, const Instance& inst) {
+        if (!st.pluginFuncs->event)
+            return false;
+        // A zeroed platform event; plugins ignore event types they don't know, which
+        // still exercises the whole entry-point and event-map dispatch path
+        char evt[256];
+        memset(evt, 0, sizeof(evt));
+        return st.pluginFuncs->event(const_cast<NPP>(&inst.npp), evt) != 0;
+    }
+
+    bool doStream(const BenchState& st, const Instance& inst) {
+        NPP npp = const_cast<NPP>(&inst.npp);
+        NPStream stream;
+        memset(&stream, 0, sizeof(stream));
+        stream.url = "bench://payload";
+        stream.end = static_cast<uint32_t>(st.opts->streamBytes);
+
+        uint16_t stype = NP_NORMAL;
+        if (st.pluginFuncs->newstream(npp, const_cast<char*>(st.opts->mimeType.c_str()),
+                                      &stream, false, &stype) != NPERR_NO_ERROR)
+            return false;
+
+        bool ok = true;
+        size_t offset = 0;
+        while (offset < st.opts->streamBytes) {
+            int32_t ready = st.pluginFuncs->writeready
+                ? st.pluginFuncs->writeready(npp, &stream)
+                : static_cast<int32_t>(st.opts->streamChunkBytes);
+            if (ready <= 0)     // a stalled producer never drains in this harness
+                break;
+            size_t len = std::min<size_t>(std::min<size_t>(ready, st.opts->streamChunkBytes),
+                                          st.opts->streamBytes - offset);
+            int32_t written = st.pluginFuncs->write(npp, &stream,
+                static_cast<int32_t>(offset), static_cast<int32_t>(len),
+                const_cast<char*>(st.streamData));
+            if (written < 0) {
+                ok = false;
+                break;
+            }
+            offset += written;
+        }
+        st.pluginFuncs->destroystream(npp, &stream, NPRES_DONE);
+        return ok;
+    }
+
+    void workerMain(const BenchState* st, int workerIndex, WorkerResult* out)
+    {
+        const NpapiHostBench::Options& opts = *st->opts;
+        const std::vector<Instance>& instances = *st->instances;
+
+        int weights[Op_Count] = {
+            opts.invokeWeight, opts.propertyWeight, opts.eventWeight, opts.streamWeight
+        };
+        int totalWeight = 0;
+        for (int i = 0; i < Op_Count; ++i)
+            totalWeight += weights[i];
+        if (!totalWeight)
+            return;
+
+        // Per-worker pacing: this worker owes its share of the total target rate
+        const long intervalUs = opts.targetCallsPerSec
+            ? (1000000L * opts.threads) / opts.targetCallsPerSec : 0;
+
+        boost::uint32_t rng = 0x9e3779b9u + workerIndex;
+        boost::uint64_t issued = 0;
+        const ptime start(microsec_clock::universal_time());
+
+        for (;;) {
+            ptime now(microsec_clock::universal_time());
+            if (now >= st->deadline)
+                break;
+            if (intervalUs) {
+                ptime due = start + boost::posix_time::microseconds(issued * intervalUs);
+                if (now < due) {
+                    boost::this_thread::sleep(due - now);
+                    now = due;
+                }
+            }
+
+            int pick = static_cast<int>(nextRand(rng) % totalWeight);
+            int op = 0;
+            while (pick >= weights[op]) {
+                pick -= weights[op];
+                ++op;
+            }
+            const Instance& inst = instances[nextRand(rng) % instances.size()];
+
+            const ptime before(microsec_clock::universal_time());
+            bool ok;
+            switch (op) {
+                case Op_Invoke:   ok = doInvoke(*st, inst); break;
+                case Op_Property: ok = doProperty(*st, inst); break;
+                case Op_Event:    ok = doEvent(*st, inst); break;
+                default:          ok = doStream(*st, inst); break;
+            }
+            const ptime after(microsec_clock::universal_time());
+
+            ++out->attempts[op];
+            if (!ok)
+                ++out->failures[op];
+            out->samples.push_back(static_cast<boost::uint32_t>(
+                (after - before).total_microseconds()));
+            ++issued;
+        }
+    }
+
+    boost::uint32_t percentile(const std::vector<boost::uint32_t>& sorted, int pct)
+    {
+        if (sorted.empty())
+            return 0;
+        return sorted[(sorted.size() - 1) * pct / 100];
+    }
+}
+
+NpapiHostBench::NpapiHostBench(NPInitFuncPtr initPtr, NPShutdownFuncPtr shutdownPtr,
+                               NPGetEntryPointsFuncPtr getepPtr)
+    : m_host(initPtr, shutdownPtr, getepPtr)
+    , init(initPtr), shutdown(shutdownPtr), getEntryPoints(getepPtr)
+{
+}
+
+NpapiHostBench::Results NpapiHostBench::run(const Options& opts)
+{
+    Results results;
+    memset(&results, 0, sizeof(results));
+
+    NPPluginFuncs pluginFuncs;
+    memset(&pluginFuncs, 0, sizeof(pluginFuncs));
+    pluginFuncs.size = sizeof(NPPluginFuncs);
+#ifdef LINUX
+    // On unix NP_Initialize hands over both tables at once
+    if (init(m_host.getBrowserFuncs(), &pluginFuncs) != NPERR_NO_ERROR)
+        return results;
+#else
+    if (init(m_host.getBrowserFuncs()) != NPERR_NO_ERROR)
+        return results;
+    if (getEntryPoints(&pluginFuncs) != NPERR_NO_ERROR)
+        return results;
+#endif
+
+    std::vector<Instance> instances(opts.instances > 0 ? opts.instances : 1);
+    for (size_t i = 0; i < instances.size(); ++i) {
+        memset(&instances[i].npp, 0, sizeof(NPP_t));
+        instances[i].root = NULL;
+        pluginFuncs.newp(const_cast<char*>(opts.mimeType.c_str()), &instances[i].npp,
+                         NP_EMBED, 0, NULL, NULL, NULL);
+        pluginFuncs.getvalue(&instances[i].npp, NPPVpluginScriptableNPObject,
+                             &instances[i].root);
+    }
+
+    std::vector<char> streamData(opts.streamChunkBytes, 'x');
+
+    BenchState st;
+    st.opts = &opts;
+    st.pluginFuncs = &pluginFuncs;
+    st.instances = &instances;
+    st.methodId = NpapiHost::NH_GetStringIdentifier(opts.method.c_str());
+    st.propertyId = NpapiHost::NH_GetStringIdentifier(opts.property.c_str());
+    st.streamData = streamData.empty() ? "" : &streamData[0];
+
+    const int threadCount = opts.threads > 0 ? opts.threads : 1;
+    std::vector<WorkerResult> workerResults(threadCount);
+
+    const ptime start(microsec_clock::universal_time());
+    st.deadline = start + boost::posix_time::milliseconds(opts.durationMs);
+
+    boost::thread_group workers;
+    for (int i = 0; i < threadCount; ++i)
+        workers.create_thread(boost::bind(&workerMain, &st, i, &workerResults[i]));
+    workers.join_all();
+
+    const ptime end(microsec_clock::universal_time());
+    results.seconds = (end - start).total_microseconds() / 1000000.0;
+
+    std::vector<boost::uint32_t> samples;
+    OpCounts* byOp[Op_Count] = { &results.invoke, &results.property,
+                                 &results.event, &results.stream };
+    for (int w = 0; w < threadCount; ++w) {
+        for (int op = 0; op < Op_Count; ++op) {
+            byOp[op]->attempts += workerResults[w].attempts[op];
+            byOp[op]->failures += workerResults[w].failures[op];
+        }
+        samples.insert(samples.end(), workerResults[w].samples.begin(),
+                       workerResults[w].samples.end());
+    }
+    for (int op = 0; op < Op_Count; ++op) {
+        results.calls += byOp[op]->attempts;
+        results.failures += byOp[op]->failures;
+    }
+    results.callsPerSec = results.seconds > 0 ? results.calls / results.seconds : 0;
+
+    std::sort(samples.begin(), samples.end());
+    results.p50us = percentile(samples, 50);
+    results.p90us = percentile(samples, 90);
+    results.p99us = percentile(samples, 99);
+    results.maxUs = samples.empty() ? 0 : samples.back();
+
+    // Teardown mirrors browser shutdown order: scriptable objects first, then instances
+    for (size_t i = 0; i < instances.size(); ++i) {
+        if (instances[i].root)
+            NpapiHost::NH_ReleaseObject(instances[i].root);
+        NPSavedData* saved = NULL;
+        pluginFuncs.destroy(&instances[i].npp, &saved);
+    }
+    shutdown();
+
+    return results;
+}
+
+void NpapiHostBench::printReport(const Results& r, std::ostream& out)
+{
+    out << "ran " << r.seconds << "s: " << r.calls << " calls ("
+        << r.failures << " failed), " << r.callsPerSec << " calls/sec\n"
+        << "latency us: p50=" << r.p50us << " p90=" << r.p90us
+        << " p99=" << r.p99us << " max=" << r.maxUs << "\n"
+        << "mix: invoke " << r.invoke.attempts << "/" << r.invoke.failures
+        << " property " << r.property.attempts << "/" << r.property.failures
+        << " event " << r.event.attempts << "/" << r.event.failures
+        << " stream " << r.stream.attempts << "/" << r.stream.failures
+        << " (attempts/failures)" << std::endl;
+}
+
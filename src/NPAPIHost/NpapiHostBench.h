@@ -0,0 +1,139 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_NPAPIHOSTBENCH
+#define H_NPAPIHOSTBENCH
+
+#include <iosfwd>
+#include <string>
+#include <boost/cstdint.hpp>
+#include "NpapiHost.h"
+
+namespace FB { namespace Npapi {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  NpapiHostBench
+    ///
+    /// @brief  Load-test driver built on the in-process NPAPI host
+    ///
+    /// Where NpapiHost fakes just enough browser for a unit test to poke one instance, this
+    /// drives a plugin the way a busy page would: it instantiates N plugin instances through the
+    /// regular NPP_ entry points, then replays a weighted mix of bridge operations (method
+    /// invokes, property reads, platform events, synthetic streams) from several threads at an
+    /// optional target rate, timing every call.  The report gives throughput and latency
+    /// percentiles per run, which is how we characterize bridge scaling limits without a real
+    /// browser in the loop.
+    ///
+    /// Note that worker threads hit the NPAPI entry points directly; FireBreath plugins tolerate
+    /// this because the wrappers marshal to the main thread themselves, and the host runs
+    /// NPN_PluginThreadAsyncCall callbacks inline so nothing needs a message pump.
+    ///
+    /// @since 1.7
+    /// @see NpapiHost
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class NpapiHostBench
+    {
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct Options
+        ///
+        /// @brief  What to run: instance/thread counts, duration, target rate and the call mix
+        ///
+        /// The mix weights are relative; an operation with weight 0 is never issued.  A
+        /// targetCallsPerSec of 0 means run unthrottled.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct Options {
+            int instances;              ///< plugin instances to create (default 1)
+            int threads;                ///< worker threads issuing calls (default 1)
+            int durationMs;             ///< how long to run (default 5000)
+            int targetCallsPerSec;      ///< total target rate across all threads; 0 = unthrottled
+
+            int invokeWeight;           ///< weight of method invokes in the mix (default 4)
+            int propertyWeight;         ///< weight of property reads (default 4)
+            int eventWeight;            ///< weight of NPP_HandleEvent deliveries (default 1)
+            int streamWeight;           ///< weight of synthetic stream replays (default 1)
+
+            std::string mimeType;       ///< mimetype passed to NPP_New
+            std::string method;         ///< method name to invoke on the root object
+            std::string property;       ///< property name to read on the root object
+            size_t streamBytes;         ///< payload size of each synthetic stream
+            size_t streamChunkBytes;    ///< bytes per NPP_Write (capped by NPP_WriteReady)
+
+            Options();
+        };
+
+        /// Attempt/failure counts for one operation type
+        struct OpCounts {
+            boost::uint64_t attempts;
+            boost::uint64_t failures;
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct Results
+        ///
+        /// @brief  Throughput and latency summary of one run; latencies are in microseconds
+        ///         over every timed call
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct Results {
+            double seconds;             ///< measured wall time of the run
+            boost::uint64_t calls;      ///< total operations issued
+            boost::uint64_t failures;   ///< operations the plugin rejected or that errored
+            double callsPerSec;
+
+            boost::uint32_t p50us;
+            boost::uint32_t p90us;
+            boost::uint32_t p99us;
+            boost::uint32_t maxUs;
+
+            OpCounts invoke;
+            OpCounts property;
+            OpCounts event;
+            OpCounts stream;
+        };
+
+        NpapiHostBench(NPInitFuncPtr initPtr, NPShutdownFuncPtr shutdownPtr, NPGetEntryPointsFuncPtr getepPtr);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn Results run(const Options& opts)
+        ///
+        /// @brief  Initializes the plugin, creates the instances, replays the call mix for the
+        ///         configured duration and tears everything back down
+        ///
+        /// Each call initializes and shuts the plugin module down, so runs are independent.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        Results run(const Options& opts);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn static void printReport(const Results& results, std::ostream& out)
+        ///
+        /// @brief  Writes a human-readable summary of one run
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static void printReport(const Results& results, std::ostream& out);
+
+    private:
+        NpapiHost m_host;
+        NPInitFuncPtr init;
+        NPShutdownFuncPtr shutdown;
+        NPGetEntryPointsFuncPtr getEntryPoints;
+    };
+
+}; };
+
+#endif
+
@@ -14,6 +14,9 @@ Copyright 2009 Richard Bateman, Firebreath development team
 
 #include <typeinfo>
 #include "JSObject.h"
+#include "Util/ArgumentPool.h"
+
+#include "TraceEvents.h"
 
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 #include "NPJavascriptObject.h"
@@ -79,20 +82,26 @@ void NPJavascriptObject::Invalidate()
 
 bool NPJavascriptObject::HasMethod(NPIdentifier name)
 {
-    if (!isValid()) return false;
+    NpapiBrowserHostPtr browser;
+    FB::JSAPIPtr api;
+    if (!getLive(browser, api)) return false;
     try {
-        std::string mName = getHost()->StringFromIdentifier(name);
-        if (mName == "toString") return true;
-        return !getAPI()->HasMethodObject(mName) && getAPI()->HasMethod(mName);
+        return hasMethodCore(browser, api, name);
     } catch (const std::bad_cast&) {
         return false; // invalid object
     } catch (const script_error& e) {
-        if (!m_browser.expired())
-            getHost()->SetException(this, e.what());
+        browser->SetException(this, e.what());
 		m_getLastExceptionFunc->setMessage(e.what());
         return false;
     }
 }
+
+bool NPJavascriptObject::hasMethodCore(const NpapiBrowserHostPtr& browser, const FB::JSAPIPtr& api, NPIdentifier name)
+{
+    std::string mName = browser->StringFromIdentifier(name);
+    if (mName == "toString") return true;
+    return !api->HasMethodObject(mName) && api->HasMethod(mName);
+}
 FB::variant FB::Npapi::NPJavascriptObject::NPO_addEventListener::exec( const std::vector<variant>& args )
 {
     if (obj->isValid() && args.size() > 1 && args.size() < 4) {
@@ -129,28 +138,29 @@ FB::variant FB::Npapi::NPJavascriptObject::NPO_getLastException::m_msg;
 
 bool NPJavascriptObject::Invoke(NPIdentifier name, const NPVariant *args, uint32_t argCount, NPVariant *result)
 {
+    FBTRACE_SCOPE("NpapiCore", "NPJavascriptObject::Invoke");
     VOID_TO_NPVARIANT(*result);
-    if (!isValid()) return false;
+    NpapiBrowserHostPtr browser;
+    FB::JSAPIPtr api;
+    if (!getLive(browser, api)) return false;
     try {
         std::string mName;
-        NpapiBrowserHostPtr browser(getHost());
         if (name != NULL) {
             mName = browser->StringFromIdentifier(name);
         }
-        std::vector<FB::variant> vArgs;
+        FB::detail::PooledArgumentList vArgs;
         for (unsigned int i = 0; i < argCount; i++) {
-            vArgs.push_back(browser->getVariant(&args[i]));
+            vArgs->push_back(browser->getVariant(&args[i]));
         }
 
         // Default method call
-        FB::variant ret = getAPI()->Invoke(mName, vArgs);
+        FB::variant ret = api->Invoke(mName, *vArgs);
         browser->getNPVariant(result, ret);
         return true;
     } catch (const std::bad_cast&) {
         return false; // invalid object
     } catch (const script_error& e) {
-        if (!m_browser.expired()) 
-            getHost()->SetException(this, e.what());
+        browser->SetException(this, e.what());
 		m_getLastExceptionFunc->setMessage(e.what());
         return false;
     }
@@ -163,13 +173,14 @@ bool NPJavascriptObject::InvokeDefault(const NPVariant *args, uint32_t argCount,
 
 bool NPJavascriptObject::HasProperty(NPIdentifier name)
 {
-    if (!isValid()) return false;
+    NpapiBrowserHostPtr browser;
+    FB::JSAPIPtr api;
+    if (!getLive(browser, api)) return false;
     try {
-        NpapiBrowserHostPtr browser(getHost());
         // Handle numeric identifiers
         if(!browser->IdentifierIsString(name)) {
             int32_t sIdx = browser->IntFromIdentifier(name);
-            return getAPI()->HasProperty(sIdx);
+            return api->HasProperty(sIdx);
         }
 
         std::string sName(browser->StringFromIdentifier(name));
@@ -178,15 +189,14 @@ bool NPJavascriptObject::HasProperty(NPIdentifier name)
 
         if (sName == "addEventListener" || sName == "removeEventListener" || sName == "getLastException") {
             return true;
-        } else if (sName != "toString" && getAPI()->HasMethodObject(sName))
+        } else if (sName != "toString" && api->HasMethodObject(sName))
             return true;
         else
-            return !HasMethod(name) && getAPI()->HasProperty(sName);
+            return !hasMethodCore(browser, api, name) && api->HasProperty(sName);
     } catch (const std::bad_cast&) {
         return false; // invalid object
     } catch (const script_error& e) {
-        if (!m_browser.expired()) 
-            getHost()->SetException(this, e.what());
+        browser->SetException(this, e.what());
 		m_getLastExceptionFunc->setMessage(e.what());
         return false;
     }
@@ -194,9 +204,11 @@ bool NPJavascriptObject::HasProperty(NPIdentifier name)
 
 bool NPJavascriptObject::GetProperty(NPIdentifier name, NPVariant *result)
 {
-    if (!isValid()) return false;
+    FBTRACE_SCOPE("NpapiCore", "NPJavascriptObject::GetProperty");
+    NpapiBrowserHostPtr browser;
+    FB::JSAPIPtr api;
+    if (!getLive(browser, api)) return false;
     try {
-        NpapiBrowserHostPtr browser(getHost());
         FB::variant res;
         if (browser->IdentifierIsString(name)) {
             std::string sName(browser->StringFromIdentifier(name));
@@ -206,13 +218,13 @@ bool NPJavascriptObject::GetProperty(NPIdentifier name, NPVariant *result)
                 res = m_removeEventFunc;
 			} else if (sName == "getLastException") {
 				res = m_getLastExceptionFunc;
-            } else if (getAPI()->HasMethodObject(sName)) {
-                res = getAPI()->GetMethodObject(sName);
+            } else if (api->HasMethodObject(sName)) {
+                res = api->GetMethodObject(sName);
             } else {
-                res = getAPI()->GetProperty(sName);
+                res = api->GetProperty(sName);
             }
         } else {
-            res = getAPI()->GetProperty(browser->IntFromIdentifier(name));
+            res = api->GetProperty(browser->IntFromIdentifier(name));
         }
 
         browser->getNPVariant(result, res);
@@ -220,8 +232,7 @@ bool NPJavascriptObject::GetProperty(NPIdentifier name, NPVariant *result)
     } catch (const std::bad_cast&) {
         return false; // invalid object
     } catch (const script_error& e) {
-        if (!m_browser.expired())
-            getHost()->SetException(this, e.what());
+        browser->SetException(this, e.what());
 		m_getLastExceptionFunc->setMessage(e.what());
         return false;
     }
@@ -229,26 +240,26 @@ bool NPJavascriptObject::GetProperty(NPIdentifier name, NPVariant *result)
 
 bool NPJavascriptObject::SetProperty(NPIdentifier name, const NPVariant *value)
 {
-    if (!isValid()) return false;
+    NpapiBrowserHostPtr browser;
+    FB::JSAPIPtr api;
+    if (!getLive(browser, api)) return false;
     try {
-        NpapiBrowserHostPtr browser(getHost());
         FB::variant arg = browser->getVariant(value);
         if (browser->IdentifierIsString(name)) {
             std::string sName(browser->StringFromIdentifier(name));
-            if (getAPI()->HasMethodObject(sName)) {
+            if (api->HasMethodObject(sName)) {
                 throw FB::script_error("This property cannot be changed");
             } else {
-                getAPI()->SetProperty(sName, arg);
+                api->SetProperty(sName, arg);
             }
         } else {
-            getAPI()->SetProperty(browser->IntFromIdentifier(name), arg);
+            api->SetProperty(browser->IntFromIdentifier(name), arg);
         }
         return true;
     } catch (const std::bad_cast&) {
         return false; // invalid object
     } catch(const script_error& e) {
-        if (!m_browser.expired())
-            getHost()->SetException(this, e.what());
+        browser->SetException(this, e.what());
 		m_getLastExceptionFunc->setMessage(e.what());
         return false;
     }
@@ -256,21 +267,21 @@ bool NPJavascriptObject::SetProperty(NPIdentifier name, const NPVariant *value)
 
 bool NPJavascriptObject::RemoveProperty(NPIdentifier name)
 {
-    if (!isValid()) return false;
+    NpapiBrowserHostPtr browser;
+    FB::JSAPIPtr api;
+    if (!getLive(browser, api)) return false;
     try {
-        NpapiBrowserHostPtr browser(getHost());
         if (browser->IdentifierIsString(name)) {
             std::string sName(browser->StringFromIdentifier(name));
-            getAPI()->RemoveProperty(sName);
+            api->RemoveProperty(sName);
         } else {
-            getAPI()->RemoveProperty(browser->IntFromIdentifier(name));
+            api->RemoveProperty(browser->IntFromIdentifier(name));
         }
         return true;
     } catch (const std::bad_cast&) {
         return false; // invalid object
     } catch(const script_error& e) {
-        if (!m_browser.expired())
-            getHost()->SetException(this, e.what());
+        browser->SetException(this, e.what());
 		m_getLastExceptionFunc->setMessage(e.what());
         return false;
     }
@@ -278,15 +289,16 @@ bool NPJavascriptObject::RemoveProperty(NPIdentifier name)
 
 bool NPJavascriptObject::Enumeration(NPIdentifier **value, uint32_t *count)
 {
-    if (!isValid()) return false;
+    NpapiBrowserHostPtr browser;
+    FB::JSAPIPtr api;
+    if (!getLive(browser, api)) return false;
     try {
         typedef std::vector<std::string> StringArray;
         StringArray memberList;
-        getAPI()->getMemberNames(memberList);
+        api->getMemberNames(memberList);
         *count = memberList.size() + 3;
         NPIdentifier *outList(NULL);
 
-        NpapiBrowserHostPtr browser(getHost());
         outList = (NPIdentifier*)browser->MemAlloc((uint32_t)(sizeof(NPIdentifier) * *count));
         
         for (uint32_t i = 0; i < memberList.size(); i++) {
@@ -302,8 +314,7 @@ bool NPJavascriptObject::Enumeration(NPIdentifier **value, uint32_t *count)
         return false; // invalid object
     } catch (const script_error& e) {
         *count = 0;
-        if (!m_browser.expired())
-            getHost()->SetException(this, e.what());
+        browser->SetException(this, e.what());
 		m_getLastExceptionFunc->setMessage(e.what());
         return false;
     }
@@ -312,23 +323,22 @@ bool NPJavascriptObject::Enumeration(NPIdentifier **value, uint32_t *count)
 bool NPJavascriptObject::Construct(const NPVariant *args, uint32_t argCount, NPVariant *result)
 {
     VOID_TO_NPVARIANT(*result);
-    if (!isValid()) return false;
+    NpapiBrowserHostPtr browser;
+    FB::JSAPIPtr api;
+    if (!getLive(browser, api)) return false;
     try {
-        NpapiBrowserHostPtr browser(getHost());
-
-        std::vector<FB::variant> vArgs;
+        FB::detail::PooledArgumentList vArgs;
         for (unsigned int i = 0; i < argCount; i++) {
-            vArgs.push_back(browser->getVariant(&args[i]));
+            vArgs->push_back(browser->getVariant(&args[i]));
         }
         // Default method call
-        FB::variant ret = getAPI()->Construct(vArgs);
+        FB::variant ret = api->Construct(*vArgs);
         browser->getNPVariant(result, ret);
         return true;
     } catch (const std::bad_cast&) {
         return false; // invalid object
     } catch (const script_error& e) {
-        if (!m_browser.expired())
-            getHost()->SetException(this, e.what());
+        browser->SetException(this, e.what());
 		m_getLastExceptionFunc->setMessage(e.what());
         return false;
     }
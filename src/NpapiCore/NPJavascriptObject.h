@@ -38,6 +38,27 @@ namespace FB { namespace Npapi {
             }
             return ptr;
         }
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool NPJavascriptObject::getLive(NpapiBrowserHostPtr& browser, FB::JSAPIPtr& api)
+        ///
+        /// @brief  Promotes both weak pointers exactly once for a browser callback
+        ///
+        /// The NPClass callbacks used to call getAPI()/getHost() several times per entry, each of
+        /// which is a weak_ptr promotion hitting the shared control block.  The hot callbacks now
+        /// resolve both pointers up front through this helper and pass the strong pointers around,
+        /// so one browser call costs exactly two promotions.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool getLive(NpapiBrowserHostPtr& browser, FB::JSAPIPtr& api)
+        {
+            if (!m_valid)
+                return false;
+            browser = m_browser.lock();
+            api = m_api.lock();
+            return browser && api;
+        }
+        bool hasMethodCore(const NpapiBrowserHostPtr& browser, const FB::JSAPIPtr& api, NPIdentifier name);
         static NPClass NPJavascriptObjectClass;
         FB::JSAPIWeakPtr m_api;
         NpapiBrowserHostWeakPtr m_browser;
@@ -26,7 +26,8 @@ using namespace FB::Npapi;
 using boost::static_pointer_cast;
 
 NPObjectAPI::NPObjectAPI(NPObject *o, const NpapiBrowserHostPtr& h)
-    : JSObject(h), m_browser(h), obj(o), is_JSAPI(false)
+    : JSObject(h), m_browser(h), obj(o), is_JSAPI(false), m_cacheProps(false),
+      m_memberNamesGeneration(0), m_enumGeneration(1)
 {
     assert(!m_browser.expired());
     if (o != NULL) {
@@ -54,26 +55,8 @@ void NPObjectAPI::getMemberNames(std::vector<std::string> &nameVector) const
     if (m_browser.expired())
         return;
 
-    NpapiBrowserHostPtr browser(getHost());
-    if (!browser->isMainThread()) {
-        typedef void (FB::JSAPI::*getMemberNamesType)(std::vector<std::string> *nameVector) const;
-        browser->CallOnMainThread(boost::bind((getMemberNamesType)&FB::JSAPI::getMemberNames, this, &nameVector));
-        return;
-    }
-    if (is_JSAPI) {
-        FB::JSAPIPtr tmp = inner.lock();
-        if (tmp)
-            tmp->getMemberNames(nameVector);
-        return;
-    }
-    NPIdentifier *idArray(NULL);
-    uint32_t count;
-
-    browser->Enumerate(obj, &idArray, &count);
-    for (uint32_t i = 0; i < count; i++) {
-        nameVector.push_back(browser->StringFromIdentifier(idArray[i]));
-    }
-    browser->MemFree(idArray);
+    MemberNameList names(getCachedMemberNames());
+    nameVector.assign(names->begin(), names->end());
 }
 
 size_t NPObjectAPI::getMemberCount() const
@@ -81,22 +64,63 @@ size_t NPObjectAPI::getMemberCount() const
     if (m_browser.expired())
         return 0;
 
+    return getCachedMemberNames()->size();
+}
+
+NPObjectAPI::MemberNameList NPObjectAPI::getCachedMemberNames() const
+{
+    static const MemberNameList emptyList(new std::vector<std::string>());
+    if (m_browser.expired())
+        return emptyList;
+
+    // Serve a valid snapshot from any thread without touching the browser
+    {
+        boost::mutex::scoped_lock lock(m_cacheLock);
+        if (m_memberNames && m_memberNamesGeneration == m_enumGeneration)
+            return m_memberNames;
+    }
+
     NpapiBrowserHostPtr browser(getHost());
     if (!browser->isMainThread()) {
-        return browser->CallOnMainThread(boost::bind(&NPObjectAPI::getMemberCount, this));
+        return browser->CallOnMainThread(boost::bind(&NPObjectAPI::getCachedMemberNames, this));
     }
+
+    // Note the generation before enumerating so that an invalidation racing with
+    // the enumeration leaves the snapshot marked stale rather than publishing it
+    unsigned int gen;
+    {
+        boost::mutex::scoped_lock lock(m_cacheLock);
+        gen = m_enumGeneration;
+    }
+
+    boost::shared_ptr<std::vector<std::string> > fresh(new std::vector<std::string>());
     if (is_JSAPI) {
         FB::JSAPIPtr tmp = inner.lock();
         if (tmp)
-            return tmp->getMemberCount();
-        else 
-            return 0;
+            tmp->getMemberNames(*fresh);
+    } else {
+        NPIdentifier *idArray(NULL);
+        uint32_t count;
+
+        browser->Enumerate(obj, &idArray, &count);
+        fresh->reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            fresh->push_back(browser->StringFromIdentifier(idArray[i]));
+        }
+        browser->MemFree(idArray);
     }
-    NPIdentifier *idArray(NULL);
-    uint32_t count;
-    browser->Enumerate(obj, &idArray, &count);
-    browser->MemFree(idArray);
-    return (size_t)count;
+
+    boost::mutex::scoped_lock lock(m_cacheLock);
+    m_memberNames = fresh;
+    m_memberNamesGeneration = gen;
+    return m_memberNames;
+}
+
+void NPObjectAPI::invalidateMemberCache()
+{
+    boost::mutex::scoped_lock lock(m_cacheLock);
+    ++m_enumGeneration;
+    m_memberNames.reset();
 }
 
 bool NPObjectAPI::HasMethod(const std::string& methodName) const
@@ -155,12 +179,35 @@ bool NPObjectAPI::HasProperty(int idx) const
     return browser->HasProperty(obj, browser->GetIntIdentifier(idx));
 }
 
+void NPObjectAPI::setPropertyCaching(bool enable)
+{
+    boost::mutex::scoped_lock lock(m_cacheLock);
+    m_cacheProps = enable;
+    if (!enable)
+        m_propCache.clear();
+}
+
+void NPObjectAPI::clearPropertyCache()
+{
+    boost::mutex::scoped_lock lock(m_cacheLock);
+    m_propCache.clear();
+}
+
 // Methods to manage properties on the API
 FB::variant NPObjectAPI::GetProperty(const std::string& propertyName)
 {
     if (m_browser.expired())
         return FB::FBVoid();
 
+    // A cache hit is answered on the calling thread; everything else still
+    // goes through the browser on the main thread
+    if (m_cacheProps) {
+        boost::mutex::scoped_lock lock(m_cacheLock);
+        std::map<std::string, FB::variant>::const_iterator it = m_propCache.find(propertyName);
+        if (it != m_propCache.end())
+            return it->second;
+    }
+
     NpapiBrowserHostPtr browser(getHost());
     if (!browser->isMainThread()) {
         return browser->CallOnMainThread(boost::bind((FB::GetPropertyType)&JSAPI::GetProperty, this, propertyName));
@@ -179,6 +226,11 @@ FB::variant NPObjectAPI::GetProperty(const std::string& propertyName)
     } else {
         FB::variant ret = browser->getVariant(&retVal);
         browser->ReleaseVariantValue(&retVal);
+        if (m_cacheProps) {
+            boost::mutex::scoped_lock lock(m_cacheLock);
+            if (m_cacheProps)
+                m_propCache[propertyName] = ret;
+        }
         return ret;
     }
 }
@@ -188,6 +240,16 @@ void NPObjectAPI::SetProperty(const std::string& propertyName, const FB::variant
     if (m_browser.expired())
         return;
 
+    // Keep the caches coherent with writes made through this object; a set may
+    // introduce a new member, so the enumeration snapshot goes stale too
+    {
+        boost::mutex::scoped_lock lock(m_cacheLock);
+        if (m_cacheProps)
+            m_propCache.erase(propertyName);
+        ++m_enumGeneration;
+        m_memberNames.reset();
+    }
+
     NpapiBrowserHostPtr browser(getHost());
     if (!browser->isMainThread()) {
         browser->CallOnMainThread(boost::bind((FB::SetPropertyType)&JSAPI::SetProperty, this, propertyName, value));
@@ -213,6 +275,14 @@ void NPObjectAPI::RemoveProperty(const std::string& propertyName)
     if (m_browser.expired())
         return;
 
+    {
+        boost::mutex::scoped_lock lock(m_cacheLock);
+        if (m_cacheProps)
+            m_propCache.erase(propertyName);
+        ++m_enumGeneration;
+        m_memberNames.reset();
+    }
+
     NpapiBrowserHostPtr browser(getHost());
     if (!browser->isMainThread()) {
         return browser->CallOnMainThread(boost::bind((FB::RemovePropertyType)&JSAPI::RemoveProperty, this, propertyName));
@@ -16,6 +16,8 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #ifndef H_NPOBJECTAPI
 #define H_NPOBJECTAPI
 
+#include <map>
+#include <boost/thread/mutex.hpp>
 #include "NpapiTypes.h"
 #include "npruntime.h"
 #include "JSAPI.h"
@@ -45,17 +47,72 @@ namespace FB { namespace Npapi {
         };
         NPObject *getNPObject() const { return obj; }
 
+        typedef boost::shared_ptr<const std::vector<std::string> > MemberNameList;
+
         void getMemberNames(std::vector<std::string> &nameVector) const;
         size_t getMemberCount() const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn MemberNameList getCachedMemberNames() const
+        ///
+        /// @brief  Returns a shared immutable snapshot of the object's member names
+        ///
+        /// The first call runs NPN_Enumerate on the main thread and converts each identifier;
+        /// subsequent calls return the same vector without touching the browser or allocating,
+        /// until invalidateMemberCache() is called or a SetProperty/RemoveProperty through this
+        /// object changes the member set.  Changes made directly from page script are invisible
+        /// until the cache is invalidated.
+        ///
+        /// @see invalidateMemberCache
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        MemberNameList getCachedMemberNames() const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void invalidateMemberCache()
+        ///
+        /// @brief  Drops the cached member-name snapshot; the next enumeration goes back through
+        ///         NPN_Enumerate
+        ///
+        /// @see getCachedMemberNames
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void invalidateMemberCache();
     public:
         virtual JSAPIPtr getJSAPI() const;
-        void invalidate() { inner.reset(); }
+        void invalidate() { inner.reset(); clearPropertyCache(); invalidateMemberCache(); }
         bool isValid() { return !m_browser.expired(); }
         virtual bool supportsOptimizedCalls() const { return true; }
         virtual void callMultipleFunctions(const std::string& name, const FB::VariantList& args,
                                            const std::vector<JSObjectPtr>& direct,
                                            const std::vector<JSObjectPtr>& ifaces);
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setPropertyCaching(bool enable)
+        ///
+        /// @brief  Enables or disables caching of named property reads on this object
+        ///
+        /// Off by default: every GetProperty is a NPN_GetProperty serialized onto the main thread.
+        /// Enable this only for host objects known to be stable (window, document, a namespace
+        /// object the page never reassigns); repeated reads -- including reads from other threads --
+        /// are then served from a local map until clearPropertyCache() is called.  Writes and
+        /// removals through this object drop the affected entry; changes made directly from page
+        /// script are invisible until the cache is cleared.  Disabling also clears the cache.
+        ///
+        /// @see clearPropertyCache
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setPropertyCaching(bool enable);
+        bool getPropertyCaching() const { return m_cacheProps; }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void clearPropertyCache()
+        ///
+        /// @brief  Drops all cached property values; the next read of each property goes back
+        ///         through the browser
+        ///
+        /// @see setPropertyCaching
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void clearPropertyCache();
+
     protected:
         NpapiBrowserHostPtr getHost() const {
             NpapiBrowserHostPtr ptr(m_browser.lock());
@@ -68,6 +125,14 @@ namespace FB { namespace Npapi {
         NPObject *obj;
         bool is_JSAPI;
         FB::JSAPIWeakPtr inner;
+        bool m_cacheProps;
+        mutable boost::mutex m_cacheLock;
+        std::map<std::string, FB::variant> m_propCache; // guarded by m_cacheLock
+        // Member enumeration cache; all three guarded by m_cacheLock.  The snapshot is only
+        // valid while its generation matches; invalidation just bumps the generation
+        mutable MemberNameList m_memberNames;
+        mutable unsigned int m_memberNamesGeneration;
+        unsigned int m_enumGeneration;
 
     public:
         bool HasMethod(const std::string& methodName) const;
@@ -16,7 +16,8 @@
 #ifndef FB_H_NPVARIANTUTIL
 #define FB_H_NPVARIANTUTIL
 
-#include <map>
+#include <algorithm>
+#include <vector>
 #include <string>
 #include <typeinfo>
 
@@ -48,7 +49,15 @@ namespace FB { namespace Npapi
     };
 
     typedef NPVariant (*NPVariantBuilder)(const NpapiBrowserHostPtr&, const FB::variant&);
-    typedef std::map<std::type_info const*, NPVariantBuilder, type_info_less> NPVariantBuilderMap;
+
+    // Builders live in a flat array sorted with type_info_less; getNPVariantBuilder does a
+    // binary search over the contiguous entries, which beats chasing std::map nodes on a
+    // lookup that happens for every argument and return value crossing the bridge
+    struct NPVariantBuilderEntry {
+        const std::type_info* type;
+        NPVariantBuilder builder;
+    };
+    typedef std::vector<NPVariantBuilderEntry> NPVariantBuilderTable;
 
     template<class T>
     NPVariant makeNPVariant(const NpapiBrowserHostPtr& host, const FB::variant& var)
@@ -142,8 +151,17 @@ namespace FB { namespace Npapi
         FB::JSObjectPtr outArr = host->getDOMWindow()->createArray();
         FB::VariantList inArr = var.cast<FB::VariantList>();
 
-        for (FB::VariantList::iterator it = inArr.begin(); it != inArr.end(); ++it) {
-            outArr->Invoke("push", FB::variant_list_of(*it));
+        // push is variadic, so the whole list can cross the browser boundary in one
+        // Invoke instead of one round trip per element; chunked to stay well clear
+        // of engine argument-count limits on huge lists
+        const size_t chunkSize = 1024;
+        FB::VariantList::iterator it = inArr.begin();
+        while (it != inArr.end()) {
+            FB::VariantList chunk;
+            for (size_t n = 0; n < chunkSize && it != inArr.end(); ++n, ++it) {
+                chunk.push_back(*it);
+            }
+            outArr->Invoke("push", chunk);
         }
 
         if (NPObjectAPIPtr api = FB::ptr_cast<NPObjectAPI>(outArr)) {
@@ -50,14 +50,28 @@ namespace
     };
 
     template<class T>
-    NPVariantBuilderMap::value_type makeBuilderEntry()
+    NPVariantBuilderEntry makeBuilderEntry()
     {
-        return NPVariantBuilderMap::value_type(&typeid(T), select_npvariant_builder::select<T>());
+        NPVariantBuilderEntry entry = { &typeid(T), select_npvariant_builder::select<T>() };
+        return entry;
     }
 
-    NPVariantBuilderMap makeNPVariantBuilderMap()
+    bool builderEntryLess(const NPVariantBuilderEntry& lhs, const NPVariantBuilderEntry& rhs)
     {
-        NPVariantBuilderMap tdm;
+        return type_info_less()(lhs.type, rhs.type);
+    }
+
+    struct BuilderTableInserter {
+        NPVariantBuilderTable& table;
+        BuilderTableInserter(NPVariantBuilderTable& table) : table(table) {}
+        void insert(const NPVariantBuilderEntry& entry) { table.push_back(entry); }
+    };
+
+    NPVariantBuilderTable makeNPVariantBuilderTable()
+    {
+        NPVariantBuilderTable table;
+        table.reserve(24);
+        BuilderTableInserter tdm(table);
         tdm.insert(makeBuilderEntry<bool>());
         tdm.insert(makeBuilderEntry<char>());
         tdm.insert(makeBuilderEntry<unsigned char>());
@@ -88,13 +102,25 @@ namespace
         tdm.insert(makeBuilderEntry<FB::JSAPIWeakPtr>());
         tdm.insert(makeBuilderEntry<FB::JSObjectPtr>());
 
-        return tdm;
+        std::sort(table.begin(), table.end(), &builderEntryLess);
+        return table;
     }
 
-    const NPVariantBuilderMap& getNPVariantBuilderMap()
+    const NPVariantBuilderTable& getNPVariantBuilderTable()
     {
-        static const NPVariantBuilderMap tdm = makeNPVariantBuilderMap();
-        return tdm;
+        static const NPVariantBuilderTable table = makeNPVariantBuilderTable();
+        return table;
+    }
+
+    NPVariantBuilder getNPVariantBuilder(const std::type_info& type)
+    {
+        const NPVariantBuilderTable& table = getNPVariantBuilderTable();
+        NPVariantBuilderEntry key = { &type, NULL };
+        NPVariantBuilderTable::const_iterator it =
+            std::lower_bound(table.begin(), table.end(), key, &builderEntryLess);
+        if (it != table.end() && !type.before(*it->type))
+            return it->builder;
+        return NULL;
     }
 }
 
@@ -115,6 +141,11 @@ void NpapiBrowserHost::shutdown() {
     FB::BrowserHost::shutdown();
 
     // Release these now as the BrowserHost will be expired when the they go out of scope in the destructor.
+    m_domWindow.reset();
+#ifndef FB_NO_DOM
+    m_domElement.reset();
+    m_domDocument.reset();
+#endif
     m_htmlWin.reset();
     m_htmlElement.reset();
     m_htmlDoc.reset();
@@ -151,37 +182,61 @@ void NpapiBrowserHost::setBrowserFuncs(NPNetscapeFuncs *pFuncs)
     if (m_htmlWin) {
         m_htmlDoc = ptr_cast<NPObjectAPI>(m_htmlWin->GetProperty("document").cast<FB::JSObjectPtr>());
     }
+    // The underlying NPObjects changed; drop any wrappers built over the old ones
+    m_domWindow.reset();
+#ifndef FB_NO_DOM
+    m_domElement.reset();
+    m_domDocument.reset();
+#endif
 }
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
 FB::DOM::DocumentPtr NpapiBrowserHost::getDOMDocument()
 {
     if (!m_htmlDoc)
         throw std::runtime_error("Cannot find HTML document");
 
-    return FB::DOM::Document::create(m_htmlDoc);
+    if (!m_domDocument)
+        m_domDocument = FB::DOM::Document::create(m_htmlDoc);
+    return m_domDocument;
 }
+#endif
 
 FB::DOM::WindowPtr NpapiBrowserHost::getDOMWindow()
 {
     if (!m_htmlWin)
         throw std::runtime_error("Cannot find HTML window");
 
-    return FB::DOM::Window::create(m_htmlWin);
+    if (!m_domWindow)
+        m_domWindow = FB::DOM::Window::create(m_htmlWin);
+    return m_domWindow;
 }
 
+#ifndef FB_NO_DOM
 FB::DOM::ElementPtr FB::Npapi::NpapiBrowserHost::getDOMElement()
 {
     if (!m_htmlElement)
         throw std::runtime_error("Cannot find HTML window");
 
-    return FB::DOM::Element::create(m_htmlElement);
+    if (!m_domElement)
+        m_domElement = FB::DOM::Element::create(m_htmlElement);
+    return m_domElement;
+}
+#endif
+
+namespace {
+    // Upper bound on how many deferred objects get released per batch; under
+    // heavy object churn this keeps any one pass from stalling the main thread
+    const size_t DeferredReleaseBatchLimit = 256;
 }
 
 void FB::Npapi::NpapiBrowserHost::deferred_release( NPObject* obj )
 {
     m_deferredObjects.push(obj);
     if (isMainThread()) {
-        DoDeferredRelease();
+        // Release a bounded batch; anything left over is picked up the next
+        // time we come through here or by the next full DoDeferredRelease
+        drainDeferredObjects(DeferredReleaseBatchLimit);
     }
 }
 
@@ -189,12 +244,25 @@ bool isExpired(std::pair<void*, FB::Npapi::NPObjectWeakRef> cur) {
     return cur.second.expired();
 }
 
-void FB::Npapi::NpapiBrowserHost::DoDeferredRelease() const
+bool FB::Npapi::NpapiBrowserHost::drainDeferredObjects( const size_t limit ) const
 {
     assertMainThread();
-    NPObject* cur(NULL);
-    while (m_deferredObjects.try_pop(cur)) {
-        ReleaseObject(cur);
+    // Swap the pending objects out wholesale so the queue lock is taken once
+    // per batch instead of once per object
+    if (m_drainingObjects.empty()) {
+        m_deferredObjects.try_pop_all(m_drainingObjects);
+    }
+    size_t count(0);
+    while (!m_drainingObjects.empty() && count++ < limit) {
+        ReleaseObject(m_drainingObjects.front());
+        m_drainingObjects.pop();
+    }
+    return !m_drainingObjects.empty() || !m_deferredObjects.empty();
+}
+
+void FB::Npapi::NpapiBrowserHost::DoDeferredRelease() const
+{
+    while (drainDeferredObjects(DeferredReleaseBatchLimit)) {
     }
     // Also remove any expired IDispatch WeakReferences
     NPObjectRefMap::iterator iter = m_cachedNPObject.begin();
@@ -293,16 +361,13 @@ void NpapiBrowserHost::getNPVariant(NPVariant *dst, const FB::variant &var)
 {
     assertMainThread();
 
-    const NPVariantBuilderMap& builderMap = getNPVariantBuilderMap();
-    const std::type_info& type = var.get_type();
-    NPVariantBuilderMap::const_iterator it = builderMap.find(&type);
-
-    if (it == builderMap.end()) {
+    NPVariantBuilder builder = getNPVariantBuilder(var.get_type());
+    if (!builder) {
         // unhandled type :(
         return;
     }
 
-    *dst = (it->second)(FB::ptr_cast<NpapiBrowserHost>(shared_from_this()), var);
+    *dst = builder(FB::ptr_cast<NpapiBrowserHost>(shared_from_this()), var);
 }
 
 NPError NpapiBrowserHost::GetURLNotify(const char* url, const char* target, void* notifyData) const
@@ -419,12 +484,27 @@ void NpapiBrowserHost::ReleaseVariantValue(NPVariant *variant) const
 NPIdentifier NpapiBrowserHost::GetStringIdentifier(const NPUTF8 *name) const
 {
     assertMainThread();
-    return module->GetStringIdentifier(name);
+    // NPN_GetStringIdentifier crosses into the browser and hashes the string every
+    // time; property polling loops resolve the same few names thousands of times a
+    // second, so intern them per host.  The browser guarantees a stable identifier
+    // for a given string, so entries never go stale
+    std::string key(name);
+    IdentifierCacheMap::const_iterator fnd = m_identCache.find(key);
+    if (fnd != m_identCache.end())
+        return fnd->second;
+    NPIdentifier identifier = module->GetStringIdentifier(name);
+    m_identCache[key] = identifier;
+    m_identNameCache[identifier] = key;
+    return identifier;
 }
 void NpapiBrowserHost::GetStringIdentifiers(const NPUTF8 **names, int32_t nameCount, NPIdentifier *identifiers) const
 {
     assertMainThread();
-    return module->GetStringIdentifiers(names, nameCount, identifiers);
+    // Serve each name through the interning cache; only cache misses cross into
+    // the browser
+    for (int32_t i = 0; i < nameCount; ++i) {
+        identifiers[i] = GetStringIdentifier(names[i]);
+    }
 }
 NPIdentifier NpapiBrowserHost::GetIntIdentifier(int32_t intid) const
 {
@@ -444,7 +524,15 @@ NPUTF8 *NpapiBrowserHost::UTF8FromIdentifier(NPIdentifier identifier) const
 std::string NpapiBrowserHost::StringFromIdentifier(NPIdentifier identifier) const
 {
     assertMainThread();
-    return module->StringFromIdentifier(identifier);
+    IdentifierNameMap::const_iterator fnd = m_identNameCache.find(identifier);
+    if (fnd != m_identNameCache.end())
+        return fnd->second;
+    std::string name = module->StringFromIdentifier(identifier);
+    if (!name.empty() && module->IdentifierIsString(identifier)) {
+        m_identNameCache[identifier] = name;
+        m_identCache[name] = identifier;
+    }
+    return name;
 }
 int32_t NpapiBrowserHost::IntFromIdentifier(NPIdentifier identifier) const
 {
@@ -735,12 +823,17 @@ FB::BrowserStreamPtr FB::Npapi::NpapiBrowserHost::_createStream( const BrowserSt
         std::string postdata = req.getPostData();
         std::string postheaders = req.getPostHeaders();
         if (!postheaders.empty()) {
-            postOutput << postheaders << "\n\n";
+            postOutput << postheaders << "\n";
         } else {
             postOutput << "Content-type: application/x-www-form-urlencoded\n";
-            postOutput << "Content-Length: " << postdata.length() << "\n\n";
+            postOutput << "Content-Length: " << postdata.length() << "\n";
+        }
+        if (req.acceptCompressed) {
+            // Advertise compression support; the decode stage in SimpleStreamHelper
+            // inflates the response if the server takes us up on it
+            postOutput << "Accept-Encoding: gzip, deflate\n";
         }
-        postOutput << postdata;
+        postOutput << "\n" << postdata;
         std::string out = postOutput.str();
         err = PostURLNotify( url.c_str(), 0, out.length(), out.c_str(), false, stream.get() );
     }
@@ -57,12 +57,19 @@ namespace FB {
         virtual void *getContextID() const { return (void *)m_npp; }
         virtual void deferred_release(NPObject* obj);
         virtual void DoDeferredRelease() const;
+    protected:
+        bool drainDeferredObjects(const size_t limit) const;
+    public:
         NPJavascriptObject* getJSAPIWrapper( const FB::JSAPIWeakPtr& api, bool autoRelease = false );
 
     public:
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
         FB::DOM::DocumentPtr getDOMDocument();
+#endif
         FB::DOM::WindowPtr getDOMWindow();
+#ifndef FB_NO_DOM
         FB::DOM::ElementPtr getDOMElement();
+#endif
         void Navigate(const std::string& url, const std::string& target);
         void evaluateJavaScript(const std::string &script);
         bool isSafari() const;
@@ -86,7 +93,23 @@ namespace FB {
         NPObjectAPIPtr m_htmlDoc;
         NPObjectAPIPtr m_htmlWin;
         NPObjectAPIPtr m_htmlElement;
+        // Cached DOM wrapper handles built over the objects above; reused for the life
+        // of the page instead of constructing a fresh wrapper graph on every call
+#ifndef FB_NO_DOM
+        FB::DOM::DocumentPtr m_domDocument;
+#endif
+        FB::DOM::WindowPtr m_domWindow;
+#ifndef FB_NO_DOM
+        FB::DOM::ElementPtr m_domElement;
+#endif
         mutable FB::SafeQueue<NPObject*> m_deferredObjects;
+        mutable std::queue<NPObject*> m_drainingObjects; // only touched on the main thread
+        // Interned identifier lookups; identifier calls are main-thread only (asserted in
+        // the wrappers), so these need no locking
+        typedef std::map<std::string, NPIdentifier> IdentifierCacheMap;
+        typedef std::map<NPIdentifier, std::string> IdentifierNameMap;
+        mutable IdentifierCacheMap m_identCache;
+        mutable IdentifierNameMap m_identNameCache;
         typedef std::map<void*, NPObjectWeakRef> NPObjectRefMap;
         mutable NPObjectRefMap m_cachedNPObject;
 
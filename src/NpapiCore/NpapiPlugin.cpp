@@ -157,7 +157,12 @@ int32_t NpapiPlugin::WriteReady(NPStream* stream)
     // check for streams we did not request or create
     if ( !s ) return -1;
 
-    return s->getInternalBufferSize();
+    // Flow control: while the consumer is behind the configured watermark, report that we
+    // can't take any data; the browser stops delivering and polls again later
+    if ( s->isSuspended() ) return 0;
+
+    // Adapts per delivery based on how fast the handler has been consuming data
+    return s->getWriteReadySize();
 }
 
 /*
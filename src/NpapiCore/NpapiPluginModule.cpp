@@ -23,6 +23,7 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
 #include "NpapiPluginModule.h"
+#include "StartupTimer.h"
 using namespace FB::Npapi;
 
 volatile uint32_t NpapiPluginModule::PluginModuleInitialized(0);
@@ -30,8 +31,11 @@ NpapiPluginModule::Modules NpapiPluginModule::m_modules;
 
 NpapiPluginModule* NpapiPluginModule::GetModule(const void* key) {
     if (!NpapiPluginModule::PluginModuleInitialized) {
+        FB::StartupTimer::mark("module load");
         FB::Log::initLogging();
+        FB::StartupTimer::mark("logging initialized");
         getFactoryInstance()->globalPluginInitialize();
+        FB::StartupTimer::mark("globalPluginInitialize done");
     }
     NpapiPluginModule* rval = NULL;
     Modules::iterator module = m_modules.find(key);
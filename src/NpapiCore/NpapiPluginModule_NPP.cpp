@@ -26,6 +26,7 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include "PluginInfo.h"
 #include "SafeQueue.h"
 #include "NpapiPluginModule.h"
+#include "StartupTimer.h"
 
 #if FB_WIN
 #  include "Win/NpapiBrowserHostAsyncWin.h"
@@ -88,23 +89,32 @@ namespace
     class NpapiPDataHolder
     {
     private:
+        // Validation tag checked before pdata is trusted; see validInstance.  The
+        // destructor scrambles it so a dangling pdata from a double NPP_Destroy or a
+        // confused browser fails validation instead of being dereferenced further.
+        static const uint32_t ValidTag = 0xFB4DA7A1;
+        uint32_t m_tag;
         NpapiBrowserHostPtr m_host;
         boost::shared_ptr<NpapiPlugin> m_plugin;
 
     public:
         NpapiPDataHolder(NpapiBrowserHostPtr host, boost::shared_ptr<NpapiPlugin> plugin)
-          : m_host(host), m_plugin(plugin)
+          : m_tag(ValidTag), m_host(host), m_plugin(plugin)
         {
 #ifdef FB_MACOSX
             FB::OneShotManager::getInstance().npp_register(m_host->getContextID());
 #endif
         }
         ~NpapiPDataHolder() {
+            m_tag = ~ValidTag;
 #ifdef FB_MACOSX
             FB::OneShotManager::getInstance().npp_unregister(m_host->getContextID());
 #endif
         }
 
+        bool isValid() const {
+            return m_tag == ValidTag;
+        }
         NpapiBrowserHostPtr getHost() const {
             return m_host;
         }
@@ -113,9 +123,12 @@ namespace
         }
     };
 
+    // Instance dispatch is lock-free by design: pdata holds the holder directly, so
+    // resolving NPP to the plugin is a couple of loads plus the tag check
     bool validInstance(NPP instance)
     {
-        return instance != NULL && instance->pdata != NULL;
+        return instance != NULL && instance->pdata != NULL
+            && static_cast<NpapiPDataHolder*>(instance->pdata)->isValid();
     }
 
     NpapiPDataHolder* getHolder(NPP instance)
@@ -148,6 +161,7 @@ NPError NpapiPluginModule::NPP_New(NPMIMEType pluginType, NPP instance, uint16_t
                                    char* argn[], char* argv[], NPSavedData* saved)
 {
     FBLOG_INFO("NPAPI", "NPP_New: " << (void*) instance);
+    FB::StartupTimer::mark("first NPP_New");
     if (instance == NULL) {
         return NPERR_INVALID_INSTANCE_ERROR;
     }
@@ -14,16 +14,27 @@ Copyright 2010 Richard Bateman, Firebreath development team
 
 #include "NpapiPlugin.h"
 #include "NpapiStream.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 #undef min
 
 using namespace FB::Npapi;
 
-NpapiStream::NpapiStream( const std::string& url, bool cache, bool seekable, size_t internalBufferSize, const NpapiBrowserHostConstPtr& Host ) 
+namespace {
+    // Bounds for the adaptive NPP_WriteReady advertisement; the handler latency budget keeps
+    // a single delivery from monopolizing the browser's event loop
+    const size_t MinAdvertiseSize = 4 * 1024;
+    const size_t MaxAdvertiseSize = 1024 * 1024;
+    const size_t AdvertiseGrowthStep = 16 * 1024;
+    const long HandlerBudgetMicros = 5000;
+}
+
+NpapiStream::NpapiStream( const std::string& url, bool cache, bool seekable, size_t internalBufferSize, const NpapiBrowserHostConstPtr& Host )
   : FB::BrowserStream( url, cache, seekable, internalBufferSize )
   /*, internalBuffer( internalBufferSize ) */
   , stream(0), host(Host), m_streamDestroyed(false), m_streamNotified(false)
 {
+    m_advertiseSize = std::min( std::max( internalBufferSize, MinAdvertiseSize ), MaxAdvertiseSize );
 }
 
 NpapiStream::~NpapiStream()
@@ -55,6 +66,26 @@ bool NpapiStream::write(const char* data, size_t dataLength, size_t& written)
     return written == dataLength;
 }
 
+bool NpapiStream::writev(const std::vector<WriteSegment>& segments, size_t& written)
+{
+    // NPN_Write takes one buffer, but the browser consumes the bytes as a byte
+    // stream -- so each segment goes straight to the host and the stream checks
+    // happen once per call instead of once per segment
+    written = 0;
+    if ( !getStream() || !isOpen() ) return false;
+    for ( std::vector<WriteSegment>::const_iterator it = segments.begin(); it != segments.end(); ++it )
+    {
+        if ( !it->size )
+            continue;
+        int32_t segmentWritten = getHost()->Write( getStream(), it->size, const_cast<char*>(it->data) );
+        if ( segmentWritten > 0 )
+            written += segmentWritten;
+        if ( segmentWritten < 0 || static_cast<size_t>(segmentWritten) != it->size )
+            return false;
+    }
+    return true;
+}
+
 bool NpapiStream::close()
 {
     if ( !getStream() ) return false;
@@ -71,25 +102,44 @@ bool NpapiStream::close()
 
 int32_t NpapiStream::signalDataArrived(void* buffer, int32_t len, int32_t offset)
 {
-    size_t effectiveLen = std::min( getInternalBufferSize(), static_cast<size_t>(len) );
-    if ( effectiveLen ) 
+    size_t effectiveLen = std::min( m_advertiseSize, static_cast<size_t>(len) );
+    if ( effectiveLen )
     {
         //memcpy( &internalBuffer[0], buffer, effectiveLen );
-        
+
         float progress = 0;
         if ( getLength() )
         {
             progress = float( offset + len ) / float( getLength() ) * 100.f;
         }
-        if ( isOpen() ) 
+        if ( isOpen() )
         {
             StreamDataArrivedEvent ev(this, buffer, effectiveLen, offset, progress);
+            boost::posix_time::ptime start( boost::posix_time::microsec_clock::universal_time() );
             SendEvent( &ev );
+            long handlerMicros = static_cast<long>(
+                ( boost::posix_time::microsec_clock::universal_time() - start ).total_microseconds() );
+            accountDelivered( effectiveLen );
+            adjustAdvertiseSize( handlerMicros );
         }
     }
     return effectiveLen;
 }
 
+void NpapiStream::adjustAdvertiseSize(long handlerMicros)
+{
+    if ( handlerMicros > HandlerBudgetMicros )
+    {
+        // The handler is falling behind; back off quickly so the event loop stays responsive
+        m_advertiseSize = std::max( m_advertiseSize / 2, MinAdvertiseSize );
+    }
+    else if ( handlerMicros < HandlerBudgetMicros / 2 )
+    {
+        // Plenty of headroom; creep back up toward the cap
+        m_advertiseSize = std::min( m_advertiseSize + AdvertiseGrowthStep, MaxAdvertiseSize );
+    }
+}
+
 void NpapiStream::signalOpened()
 {
     setOpen( true );
@@ -34,11 +34,22 @@ namespace FB { namespace Npapi {
         //virtual bool is_open();
         virtual bool    readRanges( const std::vector<Range>& ranges );
         virtual bool    write(const char* data, size_t dataLength, size_t& written);
+        virtual bool    writev(const std::vector<WriteSegment>& segments, size_t& written);
         virtual bool    close();
         virtual void    setCreated();
         virtual void    setDestroyed();
         virtual void    setNotified();
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn int32_t getWriteReadySize() const
+        ///
+        /// @brief  Number of bytes currently advertised through NPP_WriteReady.  Starts at the
+        ///         internal buffer size and adapts per delivery: it grows toward a cap while the
+        ///         data handler stays fast and halves when handler latency would starve the
+        ///         event loop.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        int32_t getWriteReadySize() const { return m_advertiseSize; }
+
     protected:
         virtual int32_t     signalDataArrived(void* buffer, int32_t len, int32_t offset);
         virtual void        signalOpened();
@@ -49,7 +60,9 @@ namespace FB { namespace Npapi {
         virtual void        setStream(NPStream* stream);
         virtual NPStream*   getStream() const;
         virtual NpapiBrowserHostConstPtr   getHost() const;
+        void                adjustAdvertiseSize(long handlerMicros);
     private:
+        size_t                  m_advertiseSize;
         NPStream*               stream;
         NpapiBrowserHostWeakConstPtr       host;
         NpapiStreamPtr m_selfReference;
@@ -17,26 +17,26 @@ Copyright 2010 Georg Fritzsche, Firebreath development team
 #include "win_common.h"
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 #include "AsyncFunctionCall.h"
-#include "Win/WinMessageWindow.h"
+#include "Win/WinAsyncDispatchWindow.h"
 
 #include "NpapiBrowserHostAsyncWin.h"
 using namespace FB::Npapi;
 
 NpapiBrowserHostAsyncWin::NpapiBrowserHostAsyncWin(NpapiPluginModule* module, NPP npp)
   : NpapiBrowserHost(module, npp)
-  , m_messageWin(new FB::WinMessageWindow())
 {
-
+    FB::WinAsyncDispatchWindow::getInstance().registerSink(this);
 }
 
 NpapiBrowserHostAsyncWin::~NpapiBrowserHostAsyncWin()
 {
-
+    // Discards anything still queued for this host
+    FB::WinAsyncDispatchWindow::getInstance().unregisterSink(this);
 }
 
 bool NpapiBrowserHostAsyncWin::_scheduleAsyncCall(void (*func)(void*), void* userData) const
 {
-    return ::PostMessage(m_messageWin->getHWND(), WM_ASYNCTHREADINVOKE, NULL, 
-                  (LPARAM)new FB::AsyncFunctionCall(func, userData)) ? true : false;
+    return FB::WinAsyncDispatchWindow::getInstance().scheduleAsyncCall(
+        const_cast<NpapiBrowserHostAsyncWin*>(this), func, userData);
 }
 
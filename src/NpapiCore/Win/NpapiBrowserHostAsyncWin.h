@@ -18,10 +18,9 @@ Copyright 2010 Georg Fritzsche, Firebreath development team
 #define H_NPAPIBROWSERHOSTASYNCWIN
 
 #include "NpapiBrowserHost.h"
-#include <boost/scoped_ptr.hpp>
 
-namespace FB { 
-    class WinMessageWindow;
+namespace FB {
+    class WinAsyncDispatchWindow;
     namespace Npapi {
         class NpapiBrowserHostAsyncWin : public NpapiBrowserHost
         {
@@ -30,9 +29,6 @@ namespace FB {
             virtual ~NpapiBrowserHostAsyncWin();
 
             virtual bool _scheduleAsyncCall(void (*func)(void*), void* userData) const;
-
-        private:
-            boost::scoped_ptr<FB::WinMessageWindow> m_messageWin;
         };
     }
 }
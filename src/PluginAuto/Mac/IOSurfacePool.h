@@ -0,0 +1,103 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#ifndef H_IOSURFACEPOOL
+#define H_IOSURFACEPOOL
+
+#include <QuartzCore/QuartzCore.h>
+#include <IOSurface/IOSurface.h>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "APITypes.h"
+
+namespace FB
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  IOSurfacePool
+    ///
+    /// @brief  Rotating pool of IOSurface-backed buffers for the CoreAnimation drawing models
+    ///
+    /// The plain CA path recommits full layer contents on every frame, which shows up as layer
+    /// commit time in the window server.  This pool keeps two or three IOSurfaces and rotates
+    /// them: the plugin locks one for rendering while the compositor reads another, and
+    /// commit() attaches the newest finished surface as the layer's contents.  Because an
+    /// IOSurface is shared memory with the window server, a commit uploads nothing -- and when
+    /// only part of the frame changed, the dirty rect recorded at unlock time is passed to the
+    /// layer so just that tile is recomposited.
+    ///
+    /// Lock/unlock may be called from any thread; commit() must run on the main thread like
+    /// all other CALayer work.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class IOSurfacePool : boost::noncopyable
+    {
+    public:
+        explicit IOSurfacePool(std::size_t count = 3);
+        ~IOSurfacePool();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void resize(uint32_t width, uint32_t height)
+        ///
+        /// @brief  Drops the current surfaces; new ones are created lazily at the new size
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void resize(uint32_t width, uint32_t height);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn IOSurfaceRef lockRenderSurface(void** baseAddress, std::size_t* bytesPerRow)
+        ///
+        /// @brief  Locks the current back surface for CPU rendering (premultiplied BGRA)
+        ///
+        /// @return the locked surface, or NULL if the pool has no size yet
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        IOSurfaceRef lockRenderSurface(void** baseAddress, std::size_t* bytesPerRow);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void unlockRenderSurface(const FB::Rect& dirty)
+        ///
+        /// @brief  Unlocks the back surface and queues it for the next commit
+        ///
+        /// @param  dirty   the area actually drawn this frame; successive frames' rects are
+        ///                 merged until the next commit picks them up
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void unlockRenderSurface(const FB::Rect& dirty);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool commit(CALayer* layer)
+        ///
+        /// @brief  Attaches the newest finished surface to the layer; main thread only
+        ///
+        /// @return true if a new frame was committed, false if nothing was pending
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool commit(CALayer* layer);
+
+    private:
+        IOSurfaceRef createSurface() const;
+        void destroySurfaces();
+
+        std::vector<IOSurfaceRef> m_surfaces;
+        std::size_t m_back, m_pending, m_front;
+        bool m_hasPending;
+        FB::Rect m_dirty;
+        bool m_dirtyValid;
+        uint32_t m_width, m_height;
+        boost::mutex m_mut;
+    };
+
+    typedef boost::shared_ptr<IOSurfacePool> IOSurfacePoolPtr;
+}
+
+#endif // H_IOSURFACEPOOL
@@ -0,0 +1,141 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include "IOSurfacePool.h"
+
+using namespace FB;
+
+IOSurfacePool::IOSurfacePool(std::size_t count)
+    : m_surfaces(count < 2 ? 2 : (count > 3 ? 3 : count), (IOSurfaceRef) NULL)
+    , m_back(0), m_pending(1), m_front(m_surfaces.size() - 1)
+    , m_hasPending(false), m_dirtyValid(false)
+    , m_width(0), m_height(0)
+{
+}
+
+IOSurfacePool::~IOSurfacePool()
+{
+    destroySurfaces();
+}
+
+void IOSurfacePool::destroySurfaces()
+{
+    for (std::size_t i = 0; i < m_surfaces.size(); ++i) {
+        if (m_surfaces[i]) {
+            CFRelease(m_surfaces[i]);
+            m_surfaces[i] = NULL;
+        }
+    }
+}
+
+IOSurfaceRef IOSurfacePool::createSurface() const
+{
+    NSDictionary* props = [NSDictionary dictionaryWithObjectsAndKeys:
+        [NSNumber numberWithUnsignedInt:m_width], (id) kIOSurfaceWidth,
+        [NSNumber numberWithUnsignedInt:m_height], (id) kIOSurfaceHeight,
+        [NSNumber numberWithUnsignedInt:4], (id) kIOSurfaceBytesPerElement,
+        [NSNumber numberWithUnsignedInt:'BGRA'], (id) kIOSurfacePixelFormat,
+        nil];
+    return IOSurfaceCreate((CFDictionaryRef) props);
+}
+
+void IOSurfacePool::resize(uint32_t width, uint32_t height)
+{
+    boost::mutex::scoped_lock lock(m_mut);
+    if (width == m_width && height == m_height)
+        return;
+    destroySurfaces();
+    m_width = width;
+    m_height = height;
+    m_back = 0;
+    m_pending = 1;
+    m_front = m_surfaces.size() - 1;
+    m_hasPending = false;
+    m_dirtyValid = false;
+}
+
+IOSurfaceRef IOSurfacePool::lockRenderSurface(void** baseAddress, std::size_t* bytesPerRow)
+{
+    boost::mutex::scoped_lock lock(m_mut);
+    if (!m_width || !m_height)
+        return NULL;
+    if (!m_surfaces[m_back])
+        m_surfaces[m_back] = createSurface();
+    IOSurfaceRef surf = m_surfaces[m_back];
+    if (!surf)
+        return NULL;
+    IOSurfaceLock(surf, 0, NULL);
+    if (baseAddress)
+        *baseAddress = IOSurfaceGetBaseAddress(surf);
+    if (bytesPerRow)
+        *bytesPerRow = IOSurfaceGetBytesPerRow(surf);
+    return surf;
+}
+
+void IOSurfacePool::unlockRenderSurface(const FB::Rect& dirty)
+{
+    boost::mutex::scoped_lock lock(m_mut);
+    IOSurfaceRef surf = m_surfaces[m_back];
+    if (!surf)
+        return;
+    IOSurfaceUnlock(surf, 0, NULL);
+
+    if (m_dirtyValid) {
+        if (dirty.top < m_dirty.top) m_dirty.top = dirty.top;
+        if (dirty.left < m_dirty.left) m_dirty.left = dirty.left;
+        if (dirty.bottom > m_dirty.bottom) m_dirty.bottom = dirty.bottom;
+        if (dirty.right > m_dirty.right) m_dirty.right = dirty.right;
+    } else {
+        m_dirty = dirty;
+        m_dirtyValid = true;
+    }
+
+    // hand the finished surface over; the renderer moves on to another one so it
+    // never scribbles on what the compositor is reading
+    std::swap(m_back, m_pending);
+    m_hasPending = true;
+}
+
+bool IOSurfacePool::commit(CALayer* layer)
+{
+    IOSurfaceRef surf;
+    FB::Rect dirty;
+    bool partial;
+    {
+        boost::mutex::scoped_lock lock(m_mut);
+        if (!m_hasPending)
+            return false;
+        std::swap(m_front, m_pending);
+        m_hasPending = false;
+        surf = m_surfaces[m_front];
+        dirty = m_dirty;
+        partial = m_dirtyValid
+            && !(dirty.top <= 0 && dirty.left <= 0
+                 && dirty.bottom >= (int32_t) m_height && dirty.right >= (int32_t) m_width);
+        m_dirtyValid = false;
+    }
+    if (!surf)
+        return false;
+
+    // The surface is shared with the window server, so this attaches it by
+    // reference; nothing is copied.  When only a tile changed, tell CA so it
+    // recomposites just that area.
+    layer.contents = (id) surf;
+    if (partial) {
+        CGRect tile = CGRectMake(dirty.left, dirty.top,
+                                 dirty.right - dirty.left, dirty.bottom - dirty.top);
+        [layer setNeedsDisplayInRect:tile];
+    }
+    return true;
+}
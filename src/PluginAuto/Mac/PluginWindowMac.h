@@ -49,6 +49,23 @@ namespace FB {
         virtual void StopAutoInvalidate();
         virtual void InvalidateWindow() const;
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn     void PluginWindowMac::reportDrawingActivity()
+        ///
+        /// @brief  Tells the auto-invalidate loop the plugin is actively producing frames
+        ///
+        /// The auto-invalidate timer throttles itself to a slow tick once the plugin is
+        /// clipped out of view or has gone long enough without reported activity; call
+        /// this (on the main thread) whenever new content is rendered to restore the
+        /// full rate immediately.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void reportDrawingActivity();
+
+        // Internal: invoked by the auto-invalidate NSTimer
+        void autoInvalidateFired();
+
         virtual NPError SetWindow(NPWindow* window);
         virtual int16_t GetValue(NPPVariable variable, void *value) { return NPERR_NO_ERROR; }
 
@@ -90,6 +107,13 @@ namespace FB {
         virtual void handleTimerEvent();
 
     protected:
+        bool isClippedOut() const;
+        void rescheduleAutoInvalidate(double rate);
+
+        // Auto-invalidate fires without reported activity before dropping to the
+        // slow tick; at the default 30fps this is about four seconds
+        static const unsigned int kIdleTicksBeforeThrottle = 120;
+
         Npapi::NpapiBrowserHostPtr m_npHost;
         PluginEventMacWeakPtr m_PluginEvent;
 
@@ -106,6 +130,9 @@ namespace FB {
         void* m_timer;
         void* m_helper;
         bool m_drawLabel;
+        double m_invalidateRate;      // full rate requested by StartAutoInvalidate
+        bool m_invalidateThrottled;   // currently on the slow tick
+        unsigned int m_idleTicks;     // fires since the last reported activity
     };
 };
 
@@ -54,7 +54,7 @@ using namespace FB;
 }
 
 - (void)fired:(NSTimer*)timer {
-    m_ica->InvalidateWindow();
+    m_ica->autoInvalidateFired();
 }
 
 @end
@@ -213,6 +213,7 @@ PluginWindowMac::PluginWindowMac()
     , m_x(0), m_y(0), m_width(0), m_height(0)
     , m_clipTop(0), m_clipLeft(0), m_clipBottom(0), m_clipRight(0)
     , m_timer(NULL), m_helper(NULL), m_drawLabel(false)
+    , m_invalidateRate(0.0), m_invalidateThrottled(false), m_idleTicks(0)
 {
     PluginWindowMac_helper *mhelper = [PluginWindowMac_helper new];
     [mhelper setIca:this];
@@ -251,9 +252,14 @@ NPError PluginWindowMac::SetWindow(NPWindow* window) {
         m_clipLeft = window->clipRect.left;
         m_clipBottom = window->clipRect.bottom;
         m_clipRight = window->clipRect.right;
-        
+
         ClipChangedEvent evt;
         SendEvent(&evt);
+
+        // Coming back into view counts as activity: restore the full invalidate
+        // rate right away instead of waiting for the next slow tick
+        if (! isClippedOut())
+            reportDrawingActivity();
     }
     return NPERR_NO_ERROR;
 }
@@ -296,14 +302,63 @@ void PluginWindowMac::handleTimerEvent() {
     SendEvent(&ev);
 }
 
+namespace {
+    const double kIdleInvalidateInterval = 1.0; // one refresh per second while idle or invisible
+}
+
 void PluginWindowMac::StartAutoInvalidate(double rate) {
     StopAutoInvalidate();
-    
+
     FBLOG_INFO("PluginCore", "AutoInvalidate STARTED " << 1/rate << "fps");
+    m_invalidateRate = rate;
+    m_invalidateThrottled = false;
+    m_idleTicks = 0;
     PluginWindowMac_helper *mhelper = (PluginWindowMac_helper*) m_helper;
     m_timer = [[NSTimer scheduledTimerWithTimeInterval:rate target:mhelper selector:@selector(fired:) userInfo:NULL repeats:YES] retain];
 }
 
+void PluginWindowMac::rescheduleAutoInvalidate(double rate) {
+    NSTimer *mtimer = (NSTimer*) m_timer;
+    if (mtimer) {
+        [mtimer invalidate];
+        [mtimer release];
+        m_timer = NULL;
+    }
+    PluginWindowMac_helper *mhelper = (PluginWindowMac_helper*) m_helper;
+    m_timer = [[NSTimer scheduledTimerWithTimeInterval:rate target:mhelper selector:@selector(fired:) userInfo:NULL repeats:YES] retain];
+}
+
+bool PluginWindowMac::isClippedOut() const {
+    return (m_clipBottom <= m_clipTop) || (m_clipRight <= m_clipLeft);
+}
+
+void PluginWindowMac::autoInvalidateFired() {
+    // Drop to the slow tick once the plugin is clipped out of view (hidden tab,
+    // scrolled away) or has gone long enough without reported drawing activity;
+    // restore the full rate as soon as neither holds
+    bool wantThrottle = isClippedOut() || m_idleTicks >= kIdleTicksBeforeThrottle;
+    if (wantThrottle != m_invalidateThrottled) {
+        m_invalidateThrottled = wantThrottle;
+        FBLOG_INFO("PluginCore", "AutoInvalidate " << (wantThrottle ? "throttled to idle rate" : "restored to full rate"));
+        rescheduleAutoInvalidate(wantThrottle ? kIdleInvalidateInterval : m_invalidateRate);
+    }
+    if (m_idleTicks < kIdleTicksBeforeThrottle) // saturate; only activity resets it
+        ++m_idleTicks;
+    // An invisible plugin skips the invalidate entirely; a merely idle one still
+    // refreshes at the slow tick so stale content never sticks around for long
+    if (! isClippedOut())
+        InvalidateWindow();
+}
+
+void PluginWindowMac::reportDrawingActivity() {
+    m_idleTicks = 0;
+    if (m_invalidateThrottled && m_timer && ! isClippedOut()) {
+        m_invalidateThrottled = false;
+        FBLOG_INFO("PluginCore", "AutoInvalidate restored to full rate");
+        rescheduleAutoInvalidate(m_invalidateRate);
+    }
+}
+
 void PluginWindowMac::StopAutoInvalidate() {
     FBLOG_INFO("PluginCore", "AutoInvalidate STOPPED");
     NSTimer *mtimer = (NSTimer*) m_timer;
@@ -17,6 +17,7 @@ Copyright 2010 Anson MacKeracher, Firebreath development team
 
 #include <QuartzCore/QuartzCore.h>
 #include "PluginWindowMac.h"
+#include "IOSurfacePool.h"
 
 namespace FB
 {
@@ -33,9 +34,23 @@ namespace FB
         void* getDrawingPrimitive() const { return m_layer; }
         WindowRef getWindowRef() const { return NULL; }
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setIOSurfacePool(const IOSurfacePoolPtr& pool)
+        ///
+        /// @brief  Attaches a rotating IOSurface pool the plugin renders into
+        ///
+        /// The pool is resized with the window, and on the invalidating-CA path an
+        /// invalidation commits the newest finished surface to the layer instead of
+        /// redisplaying its full contents.  Pass an empty pointer to detach.
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setIOSurfacePool(const IOSurfacePoolPtr& pool) { m_surfacePool = pool; }
+        IOSurfacePoolPtr getIOSurfacePool() const { return m_surfacePool; }
+
     protected:
         void* m_layer;
         void* m_txtlayer;
+        IOSurfacePoolPtr m_surfacePool;
     };
 };
 #endif // H_PLUGINWINDOWMACCA
@@ -106,6 +106,8 @@ NPError PluginWindowMacCA::SetWindow(NPWindow* window)
     FBLOG_INFO("PluginCore", "  layer(" << mlayer.bounds.origin.x << "," << mlayer.bounds.origin.y << ")(" << mlayer.bounds.origin.x + mlayer.bounds.size.width << "," << mlayer.bounds.origin.y + mlayer.bounds.size.height << ")");
 
     NPError rval = PluginWindowMac::SetWindow(window);
+    if (m_surfacePool)
+        m_surfacePool->resize(window->width, window->height);
     txtlayer.hidden = !m_drawLabel;
     [txtlayer removeFromSuperlayer];
     [mlayer addSublayer:txtlayer];
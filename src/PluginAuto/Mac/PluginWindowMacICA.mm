@@ -29,6 +29,15 @@ PluginWindowMacICA::PluginWindowMacICA()
 }
 
 void PluginWindowMacICA::InvalidateWindow() const {
+    if (m_surfacePool) {
+        // pooled IOSurface path: attach the newest finished surface by reference
+        // instead of recommitting the layer's full contents
+        CALayer *mlayer = (CALayer*) m_layer;
+        if (m_surfacePool->commit(mlayer)) {
+            PluginWindowMac::InvalidateWindow();
+            return;
+        }
+    }
     if (m_displayOnInvalidate) {
         CALayer *mlayer = (CALayer*) m_layer;
 #if 1
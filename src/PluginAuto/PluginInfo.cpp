@@ -44,6 +44,11 @@ namespace {
     }
 };
 
+void FB::preloadPluginMetadata()
+{
+    initPluginMetadata();
+}
+
 std::string FB::getPluginName(const std::string& mimetype)
 {
     return FBSTRING_PluginName; // NPAPI only really allows one name per mimetype
@@ -195,6 +195,13 @@ bool PluginWindowWin::WinProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam
         }
         case WM_MOUSEMOVE:
         {
+            if (getEventCoalescing()) {
+                // A newer position is already queued for this window; let it supersede
+                // this one so a drag delivers one MouseMoveEvent per pump iteration
+                MSG pending;
+                if (PeekMessage(&pending, hWnd, WM_MOUSEMOVE, WM_MOUSEMOVE, PM_NOREMOVE))
+                    return true;
+            }
             MouseMoveEvent ev(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam));
             if(SendEvent(&ev))
                 return true;
@@ -241,6 +248,11 @@ bool PluginWindowWin::WinProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam
             bounds.top = 0;
             bounds.right -= bounds.left;
             bounds.left = 0;
+            // repaint just the region accumulated by invalidateRect(), if that's
+            // what got us here; otherwise the whole window
+            FB::Rect dirty;
+            if (fetchDirtyRect(dirty))
+                bounds = dirty;
             RefreshEvent ev(bounds);
             if (!SendEvent(&ev)) {
                 HDC hdc;
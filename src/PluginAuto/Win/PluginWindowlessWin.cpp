@@ -125,6 +125,30 @@ bool PluginWindowlessWin::HandleDraw(HDC dc, FB::Rect bounds) {
         setHDC(dc);
     }
 
+    if (m_renderService) {
+        // frame-handoff mode: the plugin renders on its own thread; here we only
+        // blit the newest completed frame, so browser paint jitter never reaches it
+        if (const ThreadedRenderService::Frame* frame = m_renderService->beginPresent()) {
+            BITMAPINFO bmi;
+            memset(&bmi, 0, sizeof(bmi));
+            bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+            bmi.bmiHeader.biWidth = frame->width;
+            bmi.bmiHeader.biHeight = -static_cast<LONG>(frame->height);  // top-down
+            bmi.bmiHeader.biPlanes = 1;
+            bmi.bmiHeader.biBitCount = 32;
+            bmi.bmiHeader.biCompression = BI_RGB;
+            ::SetDIBitsToDevice(dc, m_x, m_y, frame->width, frame->height,
+                0, 0, 0, frame->height, &frame->pixels[0], &bmi, DIB_RGB_COLORS);
+            m_renderService->endPresent();
+        }
+        return true;
+    }
+
+    // repaint just the region accumulated by invalidateRect(), if that's
+    // what got us here; otherwise the bounds the browser handed us
+    FB::Rect dirty;
+    if (fetchDirtyRect(dirty))
+        bounds = dirty;
     RefreshEvent ev(bounds);
     if (!SendEvent(&ev)) {
         FB::Rect pos = getWindowPosition();
@@ -156,6 +180,8 @@ void PluginWindowlessWin::setWindowPosition(int32_t x, int32_t y, uint32_t width
     if (changed) {
         if (m_asyncDraw)
             m_asyncDraw->resized(width, height);
+        if (m_renderService)
+            m_renderService->resized(width, height);
         ResizedEvent ev;
         SendEvent(&ev);  //notify the plugin the window has changed position/size
     }
@@ -23,6 +23,7 @@ Copyright 2010 Anson MacKeracher, Firebreath development team
 
 #include "Win/KeyCodesWin.h"
 #include "Win/WindowContextWin.h"
+#include "ThreadedRenderService.h"
 
 namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +83,19 @@ namespace FB {
 
             AsyncDrawServicePtr getAsyncDrawService() const;
 
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            /// @fn void setThreadedRenderService(const ThreadedRenderServicePtr& svc)
+            ///
+            /// @brief  Switches HandleDraw into frame-handoff mode
+            ///
+            /// With a ThreadedRenderService attached the plugin renders on its own thread and
+            /// the browser's paint callback only blits the newest completed frame; RefreshEvent
+            /// is no longer fired.  Pass an empty pointer to go back to synchronous painting.
+            /// @since 1.7
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            void setThreadedRenderService(const ThreadedRenderServicePtr& svc) { m_renderService = svc; }
+            ThreadedRenderServicePtr getThreadedRenderService() const { return m_renderService; }
+
         protected:
             HDC m_hdc;
             HWND m_browserHwnd;
@@ -90,6 +104,7 @@ namespace FB {
             int32_t m_clipTop, m_clipLeft, m_clipBottom, m_clipRight;
             InvalidateWindowFunc m_invalidateWindow;
             AsyncDrawServicePtr m_asyncDraw;
+            ThreadedRenderServicePtr m_renderService;
     };    
 };
 
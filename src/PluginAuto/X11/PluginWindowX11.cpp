@@ -46,6 +46,7 @@ PluginWindowX11::PluginWindowX11(const WindowContextX11& ctx)
     m_window(ctx.window),
     m_browserWindow(0),
     m_focus(false),
+    m_refreshPending(false),
 #endif
     m_x(0), m_y(0), m_width(0), m_height(0), m_clipLeft(0), m_clipRight(0),
     m_clipTop(0), m_clipBottom(0), m_handler_id(0)
@@ -115,6 +116,12 @@ void PluginWindowX11::setWindowPosition(int32_t x, int32_t y, uint32_t w, uint32
         m_y = y;
         m_width = w;
         m_height = h;
+        if (m_renderService)
+            m_renderService->resized(w, h);
+#if FB_GUI_DISABLED != 1
+        if (m_backbuffer)
+            m_backbuffer->resize(w, h);
+#endif
         ResizedEvent evt;
         SendEvent(&evt);
     }
@@ -191,12 +198,56 @@ gboolean PluginWindowX11::EventCallback(GtkWidget *widget, GdkEvent *event)
     {
     case GDK_EXPOSE:
         {
+            if (m_backbuffer) {
+                // the frame lives in the shm backbuffer; just re-upload the exposed area
+                GdkEventExpose * exposeEvent = reinterpret_cast<GdkEventExpose *>(event);
+                FB::Rect rect;
+                rect.left = exposeEvent->area.x;
+                rect.top = exposeEvent->area.y;
+                rect.right = exposeEvent->area.x + exposeEvent->area.width;
+                rect.bottom = exposeEvent->area.y + exposeEvent->area.height;
+                m_backbuffer->blit(rect);
+                return 1;
+            }
+            if (m_renderService) {
+                // frame-handoff mode: the plugin renders on its own thread; here we
+                // only blit the newest completed frame
+                if (const ThreadedRenderService::Frame* frame = m_renderService->beginPresent()) {
+                    cairo_t* cr = gdk_cairo_create(widget->window);
+                    cairo_surface_t* surf = cairo_image_surface_create_for_data(
+                        const_cast<unsigned char*>(&frame->pixels[0]), CAIRO_FORMAT_ARGB32,
+                        frame->width, frame->height, frame->stride);
+                    cairo_set_source_surface(cr, surf, 0, 0);
+                    cairo_paint(cr);
+                    cairo_surface_destroy(surf);
+                    cairo_destroy(cr);
+                    m_renderService->endPresent();
+                }
+                return 1;
+            }
             GdkEventExpose * exposeEvent = reinterpret_cast<GdkEventExpose *>(event);
             FB::Rect rect;
             rect.left = exposeEvent->area.x;
             rect.top = exposeEvent->area.y;
             rect.right = exposeEvent->area.x + exposeEvent->area.width;
             rect.bottom = exposeEvent->area.y + exposeEvent->area.height;
+            if (getEventCoalescing()) {
+                // X delivers damage as a run of expose events with count saying how many
+                // more follow; merge the rects and repaint once at the end of the run
+                if (m_refreshPending) {
+                    if (rect.left < m_refreshRect.left) m_refreshRect.left = rect.left;
+                    if (rect.top < m_refreshRect.top) m_refreshRect.top = rect.top;
+                    if (rect.right > m_refreshRect.right) m_refreshRect.right = rect.right;
+                    if (rect.bottom > m_refreshRect.bottom) m_refreshRect.bottom = rect.bottom;
+                } else {
+                    m_refreshRect = rect;
+                    m_refreshPending = true;
+                }
+                if (exposeEvent->count > 0)
+                    return 1;
+                rect = m_refreshRect;
+                m_refreshPending = false;
+            }
             RefreshEvent evt(rect);
             return SendEvent(&evt) ? 1 : 0;
         }
@@ -261,6 +312,18 @@ gboolean PluginWindowX11::EventCallback(GtkWidget *widget, GdkEvent *event)
 
         case GDK_MOTION_NOTIFY: {
             GdkEventMotion *motion = (GdkEventMotion *)event;
+            if (getEventCoalescing()) {
+                // A newer position is already queued; drop this one so a drag delivers
+                // one MouseMoveEvent per pump iteration
+                GdkEvent *next = gdk_event_peek();
+                if (next) {
+                    bool superseded = (next->type == GDK_MOTION_NOTIFY &&
+                        ((GdkEventMotion *)next)->window == motion->window);
+                    gdk_event_free(next);
+                    if (superseded)
+                        return 1;
+                }
+            }
             MouseMoveEvent evt(motion->x, motion->y);
             return SendEvent(&evt) ? 1 : 0;
         } break;
@@ -339,6 +402,18 @@ GdkWindow* PluginWindowX11::getWidgetWindow() const
 
 #endif
 
+#if FB_GUI_DISABLED != 1
+X11ShmBackbuffer* PluginWindowX11::getShmBackbuffer()
+{
+    if (!m_backbuffer) {
+        m_backbuffer.reset(new X11ShmBackbuffer());
+        m_backbuffer->attach(getWidgetWindow());
+        m_backbuffer->resize(m_width, m_height);
+    }
+    return m_backbuffer.get();
+}
+#endif // FB_GUI_DISABLED != 1
+
 void PluginWindowX11::InvalidateWindow() const {
 #if FB_GUI_DISABLED != 1
   g_idle_add(idleInvalidate, const_cast<PluginWindowX11 *>(this));
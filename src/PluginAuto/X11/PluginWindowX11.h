@@ -25,6 +25,10 @@ Copyright 2009 Richard Bateman, Firebreath development team
 
 #include "PluginWindow.h"
 #include "WindowContextX11.h"
+#include "ThreadedRenderService.h"
+#include "X11ShmBackbuffer.h"
+
+#include <boost/scoped_ptr.hpp>
 
 #include <map>
 
@@ -52,6 +56,19 @@ namespace FB {
         uint32_t getWindowWidth() const { return m_width; }
         uint32_t getWindowHeight() const { return m_height; }
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setThreadedRenderService(const ThreadedRenderServicePtr& svc)
+        ///
+        /// @brief  Switches expose handling into frame-handoff mode
+        ///
+        /// With a ThreadedRenderService attached the plugin renders on its own thread and the
+        /// expose handler only blits the newest completed frame; RefreshEvent is no longer
+        /// fired.  Pass an empty pointer to go back to synchronous painting.
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setThreadedRenderService(const ThreadedRenderServicePtr& svc) { m_renderService = svc; }
+        ThreadedRenderServicePtr getThreadedRenderService() const { return m_renderService; }
+
 #if FB_GUI_DISABLED != 1
     public:
         bool hasKeyboardFocus() const { return m_focus; }
@@ -64,6 +81,18 @@ namespace FB {
 
         // You probably won't ever want to call this yourself.  Call getWindow instead.
         GdkNativeWindow getTopLevelWindow() { return m_window; }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn X11ShmBackbuffer* getShmBackbuffer()
+        ///
+        /// @brief  Returns the shared-memory drawing buffer, creating it on first use
+        ///
+        /// Draw into its cairo surface, markDirty() what you touched and flush(); only the
+        /// damage region crosses the X socket.  While a backbuffer exists the window answers
+        /// expose events by re-uploading from it instead of firing RefreshEvent.
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        X11ShmBackbuffer* getShmBackbuffer();
     protected:
         gboolean EventCallback(GtkWidget *widget, GdkEvent *event);
 
@@ -72,10 +101,16 @@ namespace FB {
         GtkWidget *m_container;
         GtkWidget *m_canvas;
         bool m_focus;
+        bool m_refreshPending;      // an expose run is being merged (coalescing mode)
+        FB::Rect m_refreshRect;     // union of the rects merged so far
 
         static gboolean idleInvalidate(gpointer win);
+
+        boost::scoped_ptr<X11ShmBackbuffer> m_backbuffer;
 #endif
 
+        ThreadedRenderServicePtr m_renderService;
+
         int32_t m_x;
         int32_t m_y;
         uint32_t m_width;
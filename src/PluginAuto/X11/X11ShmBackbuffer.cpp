@@ -0,0 +1,170 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include "logging.h"
+#include "X11ShmBackbuffer.h"
+
+#if FB_GUI_DISABLED != 1
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+using namespace FB;
+
+X11ShmBackbuffer::X11ShmBackbuffer()
+    : m_display(NULL), m_drawable(0), m_gc(NULL), m_depth(0), m_shm(false)
+    , m_image(NULL), m_surface(NULL), m_width(0), m_height(0), m_dirtyValid(false)
+{
+    m_shminfo.shmaddr = (char*) -1;
+    m_shminfo.shmid = -1;
+}
+
+X11ShmBackbuffer::~X11ShmBackbuffer()
+{
+    destroyImage();
+    if (m_gc)
+        XFreeGC(m_display, m_gc);
+}
+
+bool X11ShmBackbuffer::attach(GdkWindow* window)
+{
+    if (!window)
+        return false;
+    m_display = GDK_WINDOW_XDISPLAY(window);
+    m_drawable = GDK_WINDOW_XID(window);
+    m_depth = gdk_drawable_get_depth(GDK_DRAWABLE(window));
+    m_gc = XCreateGC(m_display, m_drawable, 0, NULL);
+    m_shm = XShmQueryExtension(m_display) ? true : false;
+    if (!m_shm)
+        FBLOG_INFO("FB.X11ShmBackbuffer", "MIT-SHM not available; using plain XImage damage uploads");
+    return true;
+}
+
+void X11ShmBackbuffer::destroyImage()
+{
+    if (m_surface) {
+        cairo_surface_destroy(m_surface);
+        m_surface = NULL;
+    }
+    if (m_image) {
+        if (m_shm && m_shminfo.shmaddr != (char*) -1) {
+            XShmDetach(m_display, &m_shminfo);
+            XSync(m_display, False);
+            shmdt(m_shminfo.shmaddr);
+            m_shminfo.shmaddr = (char*) -1;
+            m_image->data = NULL;   // the segment owned the pixels
+        }
+        XDestroyImage(m_image);
+        m_image = NULL;
+    }
+    m_dirtyValid = false;
+}
+
+void X11ShmBackbuffer::resize(uint32_t width, uint32_t height)
+{
+    if (!m_display || (width == m_width && height == m_height && m_image))
+        return;
+    destroyImage();
+    m_width = width;
+    m_height = height;
+    if (!width || !height)
+        return;
+
+    Visual* visual = DefaultVisual(m_display, DefaultScreen(m_display));
+    if (m_shm) {
+        m_image = XShmCreateImage(m_display, visual, m_depth, ZPixmap, NULL,
+                                  &m_shminfo, width, height);
+        if (m_image) {
+            m_shminfo.shmid = shmget(IPC_PRIVATE,
+                                     m_image->bytes_per_line * m_image->height,
+                                     IPC_CREAT | 0600);
+            if (m_shminfo.shmid >= 0) {
+                m_shminfo.shmaddr = m_image->data = (char*) shmat(m_shminfo.shmid, NULL, 0);
+                m_shminfo.readOnly = False;
+                XShmAttach(m_display, &m_shminfo);
+                XSync(m_display, False);
+                // mark for deletion now; the segment lives until both sides detach
+                shmctl(m_shminfo.shmid, IPC_RMID, NULL);
+            }
+            if (m_shminfo.shmaddr == (char*) -1) {
+                FBLOG_WARN("FB.X11ShmBackbuffer", "shm segment allocation failed; falling back to XImage");
+                XDestroyImage(m_image);
+                m_image = NULL;
+                m_shm = false;
+            }
+        } else {
+            m_shm = false;
+        }
+    }
+    if (!m_image) {
+        char* data = (char*) malloc(width * height * 4);
+        m_image = XCreateImage(m_display, visual, m_depth, ZPixmap, 0, data,
+                               width, height, 32, width * 4);
+    }
+    if (!m_image)
+        return;
+
+    m_surface = cairo_image_surface_create_for_data(
+        (unsigned char*) m_image->data, CAIRO_FORMAT_ARGB32,
+        width, height, m_image->bytes_per_line);
+}
+
+void X11ShmBackbuffer::markDirty(const FB::Rect& rect)
+{
+    if (m_dirtyValid) {
+        if (rect.top < m_dirty.top) m_dirty.top = rect.top;
+        if (rect.left < m_dirty.left) m_dirty.left = rect.left;
+        if (rect.bottom > m_dirty.bottom) m_dirty.bottom = rect.bottom;
+        if (rect.right > m_dirty.right) m_dirty.right = rect.right;
+    } else {
+        m_dirty = rect;
+        m_dirtyValid = true;
+    }
+}
+
+void X11ShmBackbuffer::flush()
+{
+    if (!m_dirtyValid)
+        return;
+    FB::Rect dirty = m_dirty;
+    m_dirtyValid = false;
+    blit(dirty);
+}
+
+void X11ShmBackbuffer::blit(const FB::Rect& rect)
+{
+    if (!m_image || !m_display)
+        return;
+    if (m_surface)
+        cairo_surface_flush(m_surface);
+
+    // clamp to the buffer; expose events can reference stale geometry mid-resize
+    int x = rect.left < 0 ? 0 : rect.left;
+    int y = rect.top < 0 ? 0 : rect.top;
+    int r = rect.right > (int32_t) m_width ? (int32_t) m_width : rect.right;
+    int b = rect.bottom > (int32_t) m_height ? (int32_t) m_height : rect.bottom;
+    if (r <= x || b <= y)
+        return;
+
+    if (m_shm) {
+        XShmPutImage(m_display, m_drawable, m_gc, m_image,
+                     x, y, x, y, r - x, b - y, False);
+    } else {
+        XPutImage(m_display, m_drawable, m_gc, m_image,
+                  x, y, x, y, r - x, b - y);
+    }
+    XFlush(m_display);
+}
+
+#endif // FB_GUI_DISABLED != 1
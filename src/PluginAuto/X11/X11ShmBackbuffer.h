@@ -0,0 +1,108 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#ifndef H_X11SHMBACKBUFFER
+#define H_X11SHMBACKBUFFER
+
+#include "global/config.h"
+
+#if FB_GUI_DISABLED != 1
+
+#include <gtk/gtk.h>
+#include <gdk/gdkx.h>
+#include <cairo.h>
+#include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
+#include <boost/noncopyable.hpp>
+#include "APITypes.h"
+
+namespace FB {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  X11ShmBackbuffer
+    ///
+    /// @brief  MIT-SHM backed drawing buffer for PluginWindowX11
+    ///
+    /// Plugins drawing through unshared GDK surfaces push full pixmaps over the X socket on
+    /// every update, which is hopeless over remote X.  This buffer keeps the frame in a shared
+    /// memory segment the X server maps directly (XShm), exposed to the plugin as a cairo
+    /// image surface; flush() then pushes only the merged damage region with XShmPutImage --
+    /// no pixel data crosses the socket at all.  When the display doesn't support MIT-SHM
+    /// (a genuinely remote server), it degrades to a plain XImage and XPutImage of the same
+    /// damage region, which still uploads only what changed.
+    ///
+    /// Obtain one through PluginWindowX11::getShmBackbuffer(); everything here must run on
+    /// the GTK main thread.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class X11ShmBackbuffer : boost::noncopyable
+    {
+    public:
+        X11ShmBackbuffer();
+        ~X11ShmBackbuffer();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool attach(GdkWindow* window)
+        ///
+        /// @brief  Binds the buffer to a mapped window; returns false if the window has no display
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool attach(GdkWindow* window);
+
+        /// @brief  (Re)allocates the buffer; drops the old pixels
+        void resize(uint32_t width, uint32_t height);
+
+        /// @brief  Cairo image surface over the shared pixels; valid until the next resize
+        cairo_surface_t* surface() const { return m_surface; }
+
+        /// @brief  True when the pixels live in a segment the X server maps directly
+        bool usingShm() const { return m_shm; }
+
+        /// @brief  Widens the damage region the next flush() will upload
+        void markDirty(const FB::Rect& rect);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void flush()
+        ///
+        /// @brief  Pushes the merged damage region to the window and clears it
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void flush();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void blit(const FB::Rect& rect)
+        ///
+        /// @brief  Re-uploads a region from the buffer, e.g. to satisfy an expose event
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void blit(const FB::Rect& rect);
+
+    private:
+        void destroyImage();
+
+        Display* m_display;
+        ::Window m_drawable;
+        GC m_gc;
+        int m_depth;
+        bool m_shm;
+        XImage* m_image;
+        XShmSegmentInfo m_shminfo;
+        cairo_surface_t* m_surface;
+        uint32_t m_width, m_height;
+        FB::Rect m_dirty;
+        bool m_dirtyValid;
+    };
+}
+
+#endif // FB_GUI_DISABLED != 1
+
+#endif // H_X11SHMBACKBUFFER
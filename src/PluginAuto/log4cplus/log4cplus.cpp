@@ -13,10 +13,16 @@ Copyright 2010 Facebook, Inc
 \**********************************************************/
 
 #include <string>
+#include <vector>
 #include <boost/scoped_ptr.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 #include "FactoryBase.h"
 #include "logging.h"
+#include "BinaryLog.h"
 #include "utf8_tools.h"
 
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
@@ -34,9 +40,182 @@ Copyright 2010 Facebook, Inc
 namespace 
 {
     bool logging_started = false;
+    // Threshold consulted by FB::Log::enabled; a plain int so the hot-path check is a
+    // single load and compare.  Everything passes until initLogging picks the real level.
+    volatile int logging_threshold = FB::Log::LogLevel_Trace;
+
+    // Logger::getInstance resolves the name through the hierarchy map on every call;
+    // with per-chunk logging that lookup cost every single record.  One process-lifetime
+    // handle makes an enabled statement cost only the formatted write.  The handle stays
+    // valid across stopLogging/initLogging, which merely swap the appenders behind it.
+    log4cplus::Logger& fb_logger()
+    {
+        static log4cplus::Logger logger = log4cplus::Logger::getInstance(L"FireBreath");
+        return logger;
+    }
 }
 
 static log4cplus::LogLevel translate_logLevel(FB::Log::LogLevel ll);
+static void write_direct(FB::Log::LogLevel level, const std::string& msg,
+    const char *file, int line, const char *fn);
+
+namespace
+{
+    // One formatted-and-written log record; file/fn point at string literals
+    // (__FILE__ / the function-name macro) so they are safe to keep by pointer
+    struct LogRecord
+    {
+        FB::Log::LogLevel level;
+        std::string msg;
+        const char *file;
+        int line;
+        const char *fn;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  AsyncLogWriter
+    ///
+    /// @brief  Fixed-capacity ring of pending log records with a dedicated drain thread
+    ///
+    /// Producers copy their record into the ring under a briefly-held lock and return; the drain
+    /// thread formats and hands records to the appenders, which is where the disk/console I/O
+    /// happens.  A full ring drops its oldest record and counts the loss instead of ever making
+    /// a producer wait.  Destruction drains whatever is queued before joining the thread.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class AsyncLogWriter
+    {
+    public:
+        AsyncLogWriter(std::size_t capacity)
+            : m_buf(capacity), m_head(0), m_size(0), m_dropped(0), m_stop(false)
+        {
+            m_thread = boost::thread(boost::bind(&AsyncLogWriter::run, this));
+        }
+
+        ~AsyncLogWriter()
+        {
+            {
+                boost::mutex::scoped_lock lock(m_mutex);
+                m_stop = true;
+                m_cond.notify_one();
+            }
+            m_thread.join();
+        }
+
+        void push(FB::Log::LogLevel level, const std::string& msg,
+            const char *file, int line, const char *fn)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            if (m_size == m_buf.size()) {
+                // overflow: drop the oldest record rather than ever blocking the producer
+                m_head = (m_head + 1) % m_buf.size();
+                --m_size;
+                ++m_dropped;
+            }
+            LogRecord& slot = m_buf[(m_head + m_size) % m_buf.size()];
+            slot.level = level;
+            slot.msg = msg;
+            slot.file = file;
+            slot.line = line;
+            slot.fn = fn;
+            ++m_size;
+            m_cond.notify_one();
+        }
+
+    private:
+        void run()
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            for (;;) {
+                while (!m_size && !m_stop)
+                    m_cond.wait(lock);
+                if (!m_size && m_stop)
+                    return;
+                LogRecord rec(m_buf[m_head]);
+                m_head = (m_head + 1) % m_buf.size();
+                --m_size;
+                unsigned long dropped(m_dropped);
+                m_dropped = 0;
+                lock.unlock();
+                if (dropped) {
+                    std::ostringstream os;
+                    os << "dropped " << dropped << " log records (async ring full)";
+                    write_direct(FB::Log::LogLevel_Warn, os.str(), __FILE__, __LINE__, "AsyncLogWriter::run");
+                }
+                write_direct(rec.level, rec.msg, rec.file, rec.line, rec.fn);
+                lock.lock();
+            }
+        }
+
+        std::vector<LogRecord> m_buf;
+        std::size_t m_head;
+        std::size_t m_size;
+        unsigned long m_dropped;
+        bool m_stop;
+        boost::mutex m_mutex;
+        boost::condition_variable m_cond;
+        boost::thread m_thread;
+    };
+
+    AsyncLogWriter* async_writer = NULL;
+    boost::mutex async_mutex;
+
+    // Hands a record to the async ring when enabled, otherwise writes it in place
+    void deliver(FB::Log::LogLevel level, const std::string& msg,
+        const char *file, int line, const char *fn)
+    {
+        {
+            boost::mutex::scoped_lock lock(async_mutex);
+            if (async_writer) {
+                async_writer->push(level, msg, file, line, fn);
+                return;
+            }
+        }
+        write_direct(level, msg, file, line, fn);
+    }
+
+    // Duplicate collapser: a run of identical consecutive records (same callsite,
+    // same text) emits the first one and then a single "last message repeated N
+    // times" when the run breaks, syslog style.  State guarded by dup_mutex.
+    boost::mutex dup_mutex;
+    std::string dup_msg;
+    const char* dup_file = NULL;
+    int dup_line = 0;
+    const char* dup_fn = NULL;
+    FB::Log::LogLevel dup_level = FB::Log::LogLevel_Trace;
+    unsigned long dup_repeats = 0;
+
+    // Emits the pending "repeated N times" summary, if any; call with dup_mutex held
+    void flush_repeats_locked()
+    {
+        if (!dup_repeats)
+            return;
+        std::ostringstream os;
+        os << "last message repeated " << dup_repeats << " times";
+        dup_repeats = 0;
+        deliver(dup_level, os.str(), dup_file, dup_line, dup_fn);
+    }
+
+    void dispatch(FB::Log::LogLevel level, const std::string& msg,
+        const char *file, int line, const char *fn)
+    {
+        {
+            boost::mutex::scoped_lock lock(dup_mutex);
+            if (dup_repeats != 0 || !dup_msg.empty()) {
+                if (level == dup_level && line == dup_line && file == dup_file && msg == dup_msg) {
+                    ++dup_repeats;  // swallow the duplicate; summarized when the run breaks
+                    return;
+                }
+                flush_repeats_locked();
+            }
+            dup_msg = msg;
+            dup_file = file;
+            dup_line = line;
+            dup_fn = fn;
+            dup_level = level;
+        }
+        deliver(level, msg, file, line, fn);
+    }
+}
 
 void FB::Log::initLogging()
 {
@@ -45,10 +224,22 @@ void FB::Log::initLogging()
 
     bool addedAppender = false;
 
-    log4cplus::Logger logger = log4cplus::Logger::getInstance(L"FireBreath");
+    log4cplus::Logger& logger = fb_logger();
 
     FB::Log::LogLevel ll = getFactoryInstance()->getLogLevel();
     logger.setLogLevel(translate_logLevel(ll));
+    logging_threshold = ll;
+
+    unsigned int ratePerSecond(0), rateBurst(0);
+    getFactoryInstance()->getLogRateLimit(ratePerSecond, rateBurst);
+    FB::Log::setLogRateLimit(ratePerSecond, rateBurst);
+
+    FB::Log::LogSourceLevelMap sourceLevels;
+    getFactoryInstance()->getLogSourceLevels(sourceLevels);
+    for (FB::Log::LogSourceLevelMap::const_iterator lvlIt = sourceLevels.begin();
+            lvlIt != sourceLevels.end(); ++lvlIt) {
+        FB::Log::setLogSourceLevel(lvlIt->first, lvlIt->second);
+    }
 
     FB::Log::LogMethodList mlist;
     getFactoryInstance()->getLoggingMethods(mlist);
@@ -76,7 +267,11 @@ void FB::Log::initLogging()
             fileAppender->setLayout(layout);
             logger.addAppender(fileAppender);
             addedAppender = true;
-          }
+          } break;
+        case FB::Log::LogMethod_Binary:
+            // separate stream, not a log4cplus appender; see BinaryLog.h
+            FB::Log::initBinaryLog(it->second);
+            break;
         }
     }
 
@@ -93,11 +288,38 @@ void FB::Log::initLogging()
 
 void FB::Log::stopLogging()
 {
-    log4cplus::Logger logger = log4cplus::Logger::getInstance(L"FireBreath");
-    logger.shutdown();
+    // Summarize any still-collapsing run, then stop async delivery so queued
+    // records land before the logger goes away
+    {
+        boost::mutex::scoped_lock lock(dup_mutex);
+        flush_repeats_locked();
+        dup_msg.clear();
+    }
+    disableAsyncLogging();
+    stopBinaryLog();
+    fb_logger().shutdown();
     logging_started = false;
 }
 
+void FB::Log::enableAsyncLogging(std::size_t capacity)
+{
+    boost::mutex::scoped_lock lock(async_mutex);
+    if (async_writer)
+        return;
+    async_writer = new AsyncLogWriter(capacity ? capacity : 1024);
+}
+
+void FB::Log::disableAsyncLogging()
+{
+    AsyncLogWriter* writer;
+    {
+        boost::mutex::scoped_lock lock(async_mutex);
+        writer = async_writer;
+        async_writer = NULL;
+    }
+    delete writer;  // drains the remaining records, then joins the drain thread
+}
+
 static log4cplus::LogLevel translate_logLevel(FB::Log::LogLevel ll){
     
     switch(ll) {
@@ -116,34 +338,57 @@ static log4cplus::LogLevel translate_logLevel(FB::Log::LogLevel ll){
     }
 }
 
+bool FB::Log::enabled(FB::Log::LogLevel level)
+{
+    return static_cast<int>(level) >= logging_threshold;
+}
+
+static void write_direct(FB::Log::LogLevel level, const std::string& msg,
+    const char *file, int line, const char *fn)
+{
+    log4cplus::Logger& logger = fb_logger();
+    switch (level) {
+        case FB::Log::LogLevel_Trace:
+            LOG4CPLUS_TRACE(logger, file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+            break;
+        case FB::Log::LogLevel_Debug:
+            LOG4CPLUS_DEBUG(logger, file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+            break;
+        case FB::Log::LogLevel_Info:
+            LOG4CPLUS_INFO(logger, file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+            break;
+        case FB::Log::LogLevel_Warn:
+            LOG4CPLUS_WARN(logger, file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+            break;
+        default:
+            LOG4CPLUS_ERROR(logger, file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+            break;
+    }
+}
+
 void FB::Log::trace(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
-    LOG4CPLUS_TRACE(log4cplus::Logger::getInstance(L"FireBreath"), 
-                    file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+    dispatch(LogLevel_Trace, msg, file, line, fn);
 }
 void FB::Log::debug(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
-    LOG4CPLUS_DEBUG(log4cplus::Logger::getInstance(L"FireBreath"), 
-                    file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+    dispatch(LogLevel_Debug, msg, file, line, fn);
 }
 void FB::Log::info(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
-    LOG4CPLUS_INFO(log4cplus::Logger::getInstance(L"FireBreath"), 
-                   file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+    dispatch(LogLevel_Info, msg, file, line, fn);
 }
 void FB::Log::warn(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
-    LOG4CPLUS_WARN(log4cplus::Logger::getInstance(L"FireBreath"), 
-                   file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+    dispatch(LogLevel_Warn, msg, file, line, fn);
 }
 void FB::Log::error(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
-    LOG4CPLUS_ERROR(log4cplus::Logger::getInstance(L"FireBreath"), 
-                    file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+    dispatch(LogLevel_Error, msg, file, line, fn);
 }
 void FB::Log::fatal(const std::string& src, const std::string& msg, const char *file, int line, const char *fn)
 {
-    LOG4CPLUS_ERROR(log4cplus::Logger::getInstance(L"FireBreath"), 
-                    file << ":" << line << " - " << fn << " - " << FB::utf8_to_wstring(msg));
+    // log4cplus has no fatal level in the set we use; keep the historical mapping to error
+    dispatch(LogLevel_Error, msg, file, line, fn);
 }
 
@@ -16,9 +16,14 @@ Copyright 2010 Facebook, Inc
 #include "logging.h"
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
+bool FB::Log::enabled(FB::Log::LogLevel) { return false; }
+
 void FB::Log::initLogging() {};
 void FB::Log::stopLogging() {};
 
+void FB::Log::enableAsyncLogging(std::size_t) {}
+void FB::Log::disableAsyncLogging() {}
+
 void FB::Log::trace(const std::string&, const std::string&, const char *file, int line, const char*) {}
 void FB::Log::debug(const std::string&, const std::string&, const char *file, int line, const char*) {}
 void FB::Log::info(const std::string&, const std::string&, const char *file, int line, const char*) {}
@@ -0,0 +1,175 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_ASYNCDRAWBUFFERPOOL
+#define H_FB_ASYNCDRAWBUFFERPOOL
+
+#include <cstddef>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace FB {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  AsyncDrawBufferPool
+    ///
+    /// @brief  Double/triple-buffered surface pool for AsyncDrawService render loops
+    ///
+    /// Owns two or three surfaces (any default-constructible handle type -- a texture pointer,
+    /// a shared-section handle, a CGImageRef wrapper) and rotates them so a render thread can
+    /// draw into one while the compositor presents another, with no copies.  Handing a frame
+    /// over is an index swap under a briefly-held mutex, so neither side ever waits on the
+    /// other; with latest-wins semantics a slow presenter just skips frames (see
+    /// droppedFrames()) rather than stalling the renderer.
+    ///
+    /// The render thread loops renderBuffer() / draw / publish(); the presenter calls
+    /// beginPresent(), which returns the newest published surface (or NULL when nothing new
+    /// arrived), and endPresent() when the compositor is done with it.  Fill the slots up
+    /// front via buffer(i) and drop them with reset() on resize.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template <class SurfaceT>
+    class AsyncDrawBufferPool : boost::noncopyable
+    {
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn AsyncDrawBufferPool::AsyncDrawBufferPool(std::size_t count = 3)
+        ///
+        /// @brief  Builds a pool of default-constructed surfaces; count must be 2 or 3
+        ///
+        /// With three buffers publishing never drops a finished frame; with two, a frame
+        /// finished while the presenter holds the other surface is overwritten by the next one.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        explicit AsyncDrawBufferPool(std::size_t count = 3)
+            : m_slots(count < 2 ? 2 : (count > 3 ? 3 : count)),
+              m_back(0), m_pending(1), m_front(m_slots.size() - 1),
+              m_hasPending(false), m_presenting(false), m_dropped(0)
+        {
+        }
+
+        /// @brief  Number of surfaces in the pool
+        std::size_t size() const { return m_slots.size(); }
+
+        /// @brief  Direct slot access, for allocating the underlying surfaces after construction
+        SurfaceT& buffer(std::size_t i) { return m_slots[i]; }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn SurfaceT& AsyncDrawBufferPool::renderBuffer()
+        ///
+        /// @brief  Returns the surface the render thread may draw into right now
+        ///
+        /// Only the render thread may call this, and only between publish() calls; the slot it
+        /// names changes on every publish().
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        SurfaceT& renderBuffer()
+        {
+            boost::mutex::scoped_lock lock(m_mut);
+            return m_slots[m_back];
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void AsyncDrawBufferPool::publish()
+        ///
+        /// @brief  Hands the just-drawn frame to the presenter and picks a new render slot
+        ///
+        /// Never blocks.  In two-buffer mode a publish while the presenter is mid-present keeps
+        /// the frame on the render side (it will be drawn over) and bumps droppedFrames().
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void publish()
+        {
+            boost::mutex::scoped_lock lock(m_mut);
+            if (m_slots.size() == 2) {
+                if (m_presenting) {
+                    ++m_dropped;
+                    return;
+                }
+                std::swap(m_back, m_front);
+                m_hasPending = true;    // two-buffer mode: the pending frame *is* m_front
+            } else {
+                if (m_hasPending)
+                    ++m_dropped;        // presenter never picked the last one up
+                std::swap(m_back, m_pending);
+                m_hasPending = true;
+            }
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn SurfaceT* AsyncDrawBufferPool::beginPresent()
+        ///
+        /// @brief  Returns the newest published surface, or NULL when no new frame has arrived
+        ///
+        /// The returned surface stays untouched by the render thread until endPresent().
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        SurfaceT* beginPresent()
+        {
+            boost::mutex::scoped_lock lock(m_mut);
+            if (!m_hasPending)
+                return NULL;
+            if (m_slots.size() != 2)
+                std::swap(m_front, m_pending);
+            m_hasPending = false;
+            m_presenting = true;
+            return &m_slots[m_front];
+        }
+
+        /// @brief  Releases the surface returned by beginPresent()
+        void endPresent()
+        {
+            boost::mutex::scoped_lock lock(m_mut);
+            m_presenting = false;
+        }
+
+        /// @brief  Frames published but never presented because the presenter fell behind
+        std::size_t droppedFrames() const
+        {
+            boost::mutex::scoped_lock lock(m_mut);
+            return m_dropped;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void AsyncDrawBufferPool::reset()
+        ///
+        /// @brief  Default-constructs every slot and forgets any pending frame
+        ///
+        /// Call on resize, after both threads have stopped touching the pool, then reallocate
+        /// the surfaces via buffer(i).
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void reset()
+        {
+            boost::mutex::scoped_lock lock(m_mut);
+            for (std::size_t i = 0; i < m_slots.size(); ++i)
+                m_slots[i] = SurfaceT();
+            m_back = 0;
+            m_pending = 1;
+            m_front = m_slots.size() - 1;
+            m_hasPending = false;
+            m_presenting = false;
+        }
+
+    private:
+        std::vector<SurfaceT> m_slots;
+        std::size_t m_back;     // render thread draws here
+        std::size_t m_pending;  // newest finished frame (three-buffer mode only)
+        std::size_t m_front;    // presenter reads here
+        bool m_hasPending;
+        bool m_presenting;
+        std::size_t m_dropped;
+        mutable boost::mutex m_mut;
+    };
+}
+
+#endif
@@ -12,11 +12,34 @@ License:    Dual license model; choose one of two:
 Copyright 2010 PacketPass, Inc and the Firebreath development team
 \**********************************************************/
 
+#include <cmath>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include "BrowserStream.h"
+#include "MemoryBudget.h"
+#include "utf8_tools.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
 using namespace FB;
 
+namespace {
+    boost::posix_time::ptime stats_now()
+    {
+        return boost::posix_time::microsec_clock::universal_time();
+    }
+    double seconds_between(const boost::posix_time::ptime& from, const boost::posix_time::ptime& to)
+    {
+        return (to - from).total_microseconds() / 1e6;
+    }
+}
+
 // browser stream
 BrowserStream::BrowserStream(const std::string& Url, bool Cache, bool SeekableRequested, size_t InternalBufferSize) 
   : url(Url)
@@ -27,20 +50,64 @@ BrowserStream::BrowserStream(const std::string& Url, bool Cache, bool SeekableRe
   , length(0)
   , completed(false)
   , opened(false)
+  , consumeWatermark(0)
+  , deliveredBytes(0)
+  , consumedBytes(0)
+  , suspended(false)
+  , createdTime(stats_now())
+  , avgChunkGap(0)
+  , chunkJitter(0)
+  , chunkCount(0)
+  , stallCount(0)
+  , stalledSeconds(0)
 {
+    for ( size_t i = 0; i < kRateBuckets; ++i )
+    {
+        rateBucketBytes[i] = 0;
+        rateBucketStamp[i] = -1;
+    }
 }
 
 BrowserStream::~BrowserStream()
 {
+    if ( m_memBudget )
+        m_memBudget->release( MemoryBudget::Category_StreamBuffers, getUnconsumedBytes() );
     StreamDestroyedEvent ev(this);
     SendEvent( &ev );
 }
 
+void BrowserStream::attachMemoryBudget(const MemoryBudgetPtr& budget)
+{
+    if ( m_memBudget )
+        m_memBudget->release( MemoryBudget::Category_StreamBuffers, getUnconsumedBytes() );
+    m_memBudget = budget;
+    if ( m_memBudget )
+        m_memBudget->charge( MemoryBudget::Category_StreamBuffers, getUnconsumedBytes() );
+}
+
 bool BrowserStream::readRange( size_t start, size_t end )
 {
     return readRanges( std::vector<Range>( 1, Range(start, end) ) );
 }
 
+bool BrowserStream::writev( const std::vector<WriteSegment>& segments, size_t& written )
+{
+    // Write the segments back to back; no staging buffer, so composing
+    // header + payload + trailer costs no concatenation copy
+    written = 0;
+    for ( std::vector<WriteSegment>::const_iterator it = segments.begin(); it != segments.end(); ++it )
+    {
+        if ( !it->size )
+            continue;
+        size_t segmentWritten( 0 );
+        bool ok = write( it->data, it->size, segmentWritten );
+        written += segmentWritten;
+        if ( !ok || segmentWritten != it->size )
+            return false;
+    }
+    return true;
+}
+
 std::string BrowserStream::getUrl() const
 {
     return url;
@@ -86,6 +153,68 @@ std::wstring BrowserStream::getCacheFilename() const
     return cacheFilename;
 }
 
+MappedFileViewPtr BrowserStream::getCacheMappedView() const
+{
+    if ( !isCompleted() || getCacheFilename().empty() )
+        return MappedFileViewPtr();
+
+    MappedFileViewPtr view( new MappedFileView() );
+#ifdef _WIN32
+    HANDLE file = ::CreateFileW( getCacheFilename().c_str(), GENERIC_READ, FILE_SHARE_READ,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if ( file == INVALID_HANDLE_VALUE )
+        return MappedFileViewPtr();
+    LARGE_INTEGER fileSize;
+    if ( !::GetFileSizeEx( file, &fileSize ) || !fileSize.QuadPart )
+    {
+        ::CloseHandle( file );
+        return MappedFileViewPtr();
+    }
+    HANDLE mapping = ::CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+    if ( !mapping )
+    {
+        ::CloseHandle( file );
+        return MappedFileViewPtr();
+    }
+    const void* ptr = ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    // The view holds its own references to the mapping and the file, so both handles
+    // can be closed right away
+    ::CloseHandle( mapping );
+    ::CloseHandle( file );
+    if ( !ptr )
+        return MappedFileViewPtr();
+    view->m_data = static_cast<const char*>( ptr );
+    view->m_size = static_cast<size_t>( fileSize.QuadPart );
+#else
+    int fd = ::open( FB::wstring_to_utf8( getCacheFilename() ).c_str(), O_RDONLY );
+    if ( fd < 0 )
+        return MappedFileViewPtr();
+    struct stat st;
+    if ( ::fstat( fd, &st ) < 0 || !st.st_size )
+    {
+        ::close( fd );
+        return MappedFileViewPtr();
+    }
+    void* ptr = ::mmap( NULL, static_cast<size_t>( st.st_size ), PROT_READ, MAP_SHARED, fd, 0 );
+    ::close( fd );      // the mapping keeps the file alive
+    if ( ptr == MAP_FAILED )
+        return MappedFileViewPtr();
+    view->m_data = static_cast<const char*>( ptr );
+    view->m_size = static_cast<size_t>( st.st_size );
+#endif
+    return view;
+}
+
+MappedFileView::~MappedFileView()
+{
+    if ( !m_data ) return;
+#ifdef _WIN32
+    ::UnmapViewOfFile( m_data );
+#else
+    ::munmap( const_cast<char*>( m_data ), m_size );
+#endif
+}
+
 std::string BrowserStream::getHeaders() const
 {
     return headers;
@@ -101,6 +230,150 @@ size_t BrowserStream::getInternalBufferSize() const
     return internalBufferSize;
 }
 
+void BrowserStream::setConsumeWatermark(size_t bytes)
+{
+    consumeWatermark = bytes;
+    if ( suspended && (!consumeWatermark || getUnconsumedBytes() <= consumeWatermark / 2) )
+    {
+        suspended = false;
+        statsStallEnded();
+        suspendProducer( false );
+    }
+}
+
+size_t BrowserStream::getConsumeWatermark() const
+{
+    return consumeWatermark;
+}
+
+size_t BrowserStream::getUnconsumedBytes() const
+{
+    return deliveredBytes - consumedBytes;
+}
+
+bool BrowserStream::isSuspended() const
+{
+    return suspended;
+}
+
+void BrowserStream::reportConsumed(size_t bytes)
+{
+    const size_t before = consumedBytes;
+    consumedBytes += bytes;
+    if ( consumedBytes > deliveredBytes )
+        consumedBytes = deliveredBytes;
+    if ( m_memBudget )
+        m_memBudget->release( MemoryBudget::Category_StreamBuffers, consumedBytes - before );
+    // Resume with hysteresis: wait until the backlog has drained to half the watermark so
+    // we don't flap between stalled and running on every chunk
+    if ( suspended && getUnconsumedBytes() <= consumeWatermark / 2 )
+    {
+        suspended = false;
+        statsStallEnded();
+        suspendProducer( false );
+    }
+}
+
+void BrowserStream::accountDelivered(size_t bytes)
+{
+    deliveredBytes += bytes;
+    statsRecordChunk( bytes );
+    if ( m_memBudget )
+        m_memBudget->charge( MemoryBudget::Category_StreamBuffers, bytes );
+    if ( consumeWatermark && !suspended && getUnconsumedBytes() > consumeWatermark )
+    {
+        suspended = true;
+        statsStallBegan();
+        suspendProducer( true );
+    }
+}
+
+void BrowserStream::statsRecordChunk(size_t bytes)
+{
+    const boost::posix_time::ptime now( stats_now() );
+    ++chunkCount;
+    if ( firstByteTime.is_not_a_date_time() )
+    {
+        firstByteTime = now;
+    }
+    else
+    {
+        // Smooth the inter-chunk gap and its absolute deviation; an eighth per
+        // sample reacts in a couple of seconds without jumping on one late chunk
+        const double gap = seconds_between( lastChunkTime, now );
+        if ( chunkCount == 2 )
+            avgChunkGap = gap;
+        else
+        {
+            avgChunkGap += ( gap - avgChunkGap ) / 8;
+            chunkJitter += ( std::fabs( gap - avgChunkGap ) - chunkJitter ) / 8;
+        }
+    }
+    lastChunkTime = now;
+
+    const boost::int64_t bucket =
+        (boost::int64_t)( seconds_between( createdTime, now ) * 1000 ) / kRateBucketMs;
+    const size_t slot = (size_t)( bucket % kRateBuckets );
+    if ( rateBucketStamp[slot] != bucket )
+    {
+        rateBucketStamp[slot] = bucket;
+        rateBucketBytes[slot] = 0;
+    }
+    rateBucketBytes[slot] += bytes;
+}
+
+void BrowserStream::statsStallBegan()
+{
+    ++stallCount;
+    stallStartTime = stats_now();
+}
+
+void BrowserStream::statsStallEnded()
+{
+    if ( !stallStartTime.is_not_a_date_time() )
+    {
+        stalledSeconds += seconds_between( stallStartTime, stats_now() );
+        stallStartTime = boost::posix_time::ptime();
+    }
+}
+
+BrowserStream::Statistics BrowserStream::getStatistics() const
+{
+    const boost::posix_time::ptime now( stats_now() );
+    Statistics stats;
+    stats.bytesReceived = deliveredBytes;
+    stats.chunkCount = chunkCount;
+    stats.chunkJitter = chunkJitter;
+    stats.stallCount = stallCount;
+    stats.stalledSeconds = stalledSeconds;
+    if ( suspended && !stallStartTime.is_not_a_date_time() )
+        stats.stalledSeconds += seconds_between( stallStartTime, now );
+    if ( !firstByteTime.is_not_a_date_time() )
+        stats.timeToFirstByte = seconds_between( createdTime, firstByteTime );
+
+    // Sum only the buckets still inside the window ending now
+    const boost::int64_t bucket =
+        (boost::int64_t)( seconds_between( createdTime, now ) * 1000 ) / kRateBucketMs;
+    size_t windowBytes = 0;
+    for ( size_t i = 0; i < kRateBuckets; ++i )
+    {
+        if ( rateBucketStamp[i] >= 0 && bucket - rateBucketStamp[i] < (boost::int64_t)kRateBuckets )
+            windowBytes += rateBucketBytes[i];
+    }
+    double window = ( kRateBuckets * kRateBucketMs ) / 1000.0;
+    const double elapsed = seconds_between( createdTime, now );
+    if ( elapsed < window )
+        window = ( elapsed > 0.05 ) ? elapsed : 0.05;
+    stats.bytesPerSecond = windowBytes / window;
+    return stats;
+}
+
+void BrowserStream::suspendProducer(bool suspend)
+{
+    // Default: nothing to do.  NPAPI streams stall implicitly by reporting 0 from
+    // NPP_WriteReady while isSuspended(); hosts with an explicit pause control override this.
+}
+
 
 
 void BrowserStream::setSeekableByServer(bool SeekableByServer)
@@ -17,13 +17,55 @@ Copyright 2010 PacketPass, Inc and the Firebreath development team
 #define H_FB_BROWSERSTREAM
 
 #include <string>
+#include <boost/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/ptime.hpp>
 #include "APITypes.h"
 #include "PluginEventSource.h"
 #include "PluginEventSink.h"
+#include "ObjectCensus.h"
 #include "PluginEvents/StreamEvents.h"
 
 namespace FB {
     FB_FORWARD_PTR(BrowserStream);
+    FB_FORWARD_PTR(MappedFileView);
+    FB_FORWARD_PTR(MemoryBudget);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  MappedFileView
+    ///
+    /// @brief  Read-only memory-mapped view of a cached stream's file.
+    ///
+    /// Returned by BrowserStream::getCacheMappedView().  The whole file is mapped into the
+    /// process with mmap / MapViewOfFile, so consumers read the cached content directly from
+    /// the page cache instead of pulling it through buffered file I/O.  The mapping stays
+    /// valid as long as this object is alive and is released by the destructor.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class MappedFileView : boost::noncopyable
+    {
+    public:
+        ~MappedFileView();
+
+        /// read-only pointer to the first byte of the file
+        const char* data() const
+        {
+            return m_data;
+        }
+
+        /// size of the file in bytes
+        size_t size() const
+        {
+            return m_size;
+        }
+
+    protected:
+        friend class BrowserStream;
+        MappedFileView() : m_data(NULL), m_size(0)
+        {}
+
+        const char* m_data;
+        size_t m_size;
+    };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @class  BrowserStream
@@ -38,9 +80,12 @@ namespace FB {
     /// 
     /// @author Matthias
     ////////////////////////////////////////////////////////////////////////////////////////////////////
-    class BrowserStream : public PluginEventSource
+    class BrowserStream : public PluginEventSource, public census_counted<BrowserStream>
     {
     public:
+        /// Label this type reports live-instance counts under in FB::ObjectCensus::snapshot()
+        static const char* censusName() { return "BrowserStream"; }
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @class  Range
         ///
@@ -55,6 +100,25 @@ namespace FB {
             size_t start, end;
         };
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct WriteSegment
+        ///
+        /// @brief  One piece of a scatter-gather write; see BrowserStream::writev
+        ///
+        /// The segment does not own the memory it points at; the bytes must stay valid for the
+        /// duration of the writev call.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct WriteSegment
+        {
+            WriteSegment() : data(NULL), size(0) {}
+            WriteSegment( const char* data, size_t size ) : data(data), size(size) {}
+
+            const char* data;
+            size_t size;
+        };
+
     public:
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn BrowserStream::BrowserStream( const std::string& url, bool cache, bool seekable, size_t internalBufferSize)
@@ -117,6 +181,26 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual bool    write(const char* data, size_t dataLength, size_t& written) = 0;
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual bool BrowserStream::writev(const std::vector<WriteSegment>& segments, size_t& written)
+        ///
+        /// @brief  Writes a sequence of buffer segments to the stream as if they were one
+        ///         contiguous buffer.
+        ///
+        /// Use this when a frame is composed of pieces living in different buffers (header,
+        /// payload, trailer); it saves concatenating them into a staging buffer just to call
+        /// write.  The default implementation writes the segments back to back through write();
+        /// hosts with a cheaper path may override it.
+        ///
+        /// @param[in] segments the pieces to write, in order; empty segments are skipped
+        /// @param[out] written the total number of bytes written across all segments
+        ///
+        /// @return false on error or short write, else true
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual bool    writev(const std::vector<WriteSegment>& segments, size_t& written);
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual bool BrowserStream::close() = 0;
         ///
@@ -216,6 +300,18 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual std::wstring getCacheFilename() const;
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual MappedFileViewPtr BrowserStream::getCacheMappedView() const;
+        ///
+        /// @brief  Maps the cache file of a completed cached stream into memory and returns a
+        ///         read-only view of it, so the content can be consumed without copying it
+        ///         through buffered reads.
+        ///
+        /// Only works once the stream has completed and a cache filename is known; returns an
+        /// empty pointer otherwise, or if the file cannot be opened or mapped.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual MappedFileViewPtr getCacheMappedView() const;
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual std::string BrowserStream::getHeaders() const;
         ///
@@ -243,6 +339,119 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual size_t getLength() const;
 
+    public:
+        // flow control
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void BrowserStream::setConsumeWatermark(size_t bytes);
+        ///
+        /// @brief  Sets the high watermark for flow control, in bytes; 0 (the default) disables it.
+        ///
+        /// Once more than this many delivered bytes have not yet been acknowledged through
+        /// reportConsumed(), the stream stalls the producer (NPAPI streams report 0 from
+        /// NPP_WriteReady, ActiveX streams suspend the binding).  Delivery resumes when the
+        /// consumer catches up to half the watermark.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void setConsumeWatermark(size_t bytes);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual size_t BrowserStream::getConsumeWatermark() const;
+        ///
+        /// @brief  Returns the configured high watermark in bytes; 0 means flow control is disabled.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual size_t getConsumeWatermark() const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void BrowserStream::reportConsumed(size_t bytes);
+        ///
+        /// @brief  Tells the stream that the consumer has finished processing the given number of
+        ///         delivered bytes.  Call from the main thread (marshal with
+        ///         BrowserHost::ScheduleOnMainThread if the data is processed elsewhere).
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void reportConsumed(size_t bytes);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual size_t BrowserStream::getUnconsumedBytes() const;
+        ///
+        /// @brief  Returns how many delivered bytes have not yet been reported consumed.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual size_t getUnconsumedBytes() const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual bool BrowserStream::isSuspended() const;
+        ///
+        /// @brief  Returns true while the producer is stalled because the consumer is behind.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual bool isSuspended() const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void BrowserStream::attachMemoryBudget(const MemoryBudgetPtr& budget)
+        ///
+        /// @brief  Charges this stream's unconsumed backlog against the given instance budget
+        ///
+        /// Call after creating the stream, typically with the owning instance's
+        /// PluginCore::getMemoryBudget().  From then on delivered-but-unconsumed bytes are
+        /// charged to MemoryBudget::Category_StreamBuffers and released as the plugin reports
+        /// them consumed (or when the stream dies).
+        ///
+        /// @since 1.7
+        /// @see FB::PluginCore::getMemoryBudget
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void attachMemoryBudget(const MemoryBudgetPtr& budget);
+
+    public:
+        // statistics
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @class  Statistics
+        ///
+        /// @brief  Snapshot of a stream's built-in transfer counters; see getStatistics()
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct Statistics
+        {
+            size_t bytesReceived;   ///< total bytes delivered to the handlers so far
+            size_t chunkCount;      ///< number of data chunks delivered
+            double bytesPerSecond;  ///< throughput over roughly the last two seconds
+            double timeToFirstByte; ///< seconds from stream creation to the first chunk; -1 before that
+            double chunkJitter;     ///< smoothed absolute deviation of inter-chunk gaps, in seconds
+            size_t stallCount;      ///< times flow control had to stall the producer
+            double stalledSeconds;  ///< total time the producer has spent stalled
+
+            Statistics()
+                : bytesReceived(0), chunkCount(0), bytesPerSecond(0),
+                  timeToFirstByte(-1), chunkJitter(0), stallCount(0), stalledSeconds(0)
+            {}
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual Statistics BrowserStream::getStatistics() const;
+        ///
+        /// @brief  Returns a snapshot of the per-stream transfer statistics
+        ///
+        /// The counters are maintained by the host stream implementations as chunks are
+        /// delivered, so every stream has them without an instrumented build.  Taken together
+        /// they separate network slowness from consumer-side backpressure: a slow network shows
+        /// a low rate with high jitter and no stalls, while a slow consumer shows stalls piling
+        /// up with normal arrival timing.  Like the flow control state the counters are only
+        /// touched on the main thread; call this from there.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual Statistics getStatistics() const;
+
+    protected:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void BrowserStream::suspendProducer(bool suspend);
+        ///
+        /// @brief  Called when flow control stalls (true) or resumes (false) the stream; host
+        ///         stream implementations override this to act on the underlying transport.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void suspendProducer(bool suspend);
+
+        /// Called by host stream implementations after delivering bytes to the handlers;
+        /// trips the watermark check
+        virtual void accountDelivered(size_t bytes);
+
     protected:
         // property setters
         virtual void setUrl(const std::string& url);
@@ -269,6 +478,33 @@ namespace FB {
         bool            completed;
         bool            opened;
         std::string     headers;
+
+        // flow control state; only touched on the main thread
+        size_t          consumeWatermark;
+        size_t          deliveredBytes;
+        size_t          consumedBytes;
+        bool            suspended;
+
+        // statistics; updated from accountDelivered on the main thread
+        void statsRecordChunk(size_t bytes);
+        void statsStallBegan();
+        void statsStallEnded();
+
+        enum { kRateBuckets = 8, kRateBucketMs = 250 };  // two-second rolling window
+        boost::posix_time::ptime createdTime;
+        boost::posix_time::ptime firstByteTime;  // not_a_date_time until the first chunk
+        boost::posix_time::ptime lastChunkTime;
+        boost::posix_time::ptime stallStartTime;
+        double          avgChunkGap;    // smoothed inter-chunk gap, seconds
+        double          chunkJitter;    // smoothed |gap - avgChunkGap|, seconds
+        size_t          chunkCount;
+        size_t          stallCount;
+        double          stalledSeconds;
+        size_t          rateBucketBytes[kRateBuckets];
+        boost::int64_t  rateBucketStamp[kRateBuckets];  // absolute bucket number, -1 = unused
+
+        // instance budget the backlog is charged to, if any; see attachMemoryBudget()
+        MemoryBudgetPtr m_memBudget;
     };
 };
 
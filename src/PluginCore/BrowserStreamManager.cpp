@@ -23,35 +23,67 @@ Copyright 2011 Richard Bateman,
 
 #include "BrowserStreamManager.h"
 
-FB::BrowserStreamManager::BrowserStreamManager()
+FB::BrowserStreamManager::BrowserStreamManager() : m_defaultWatermark(0)
 {
 
 }
 
 FB::BrowserStreamManager::~BrowserStreamManager()
 {
-    boost::recursive_mutex::scoped_lock _l(m_xtmutex);
     using namespace boost::lambda;
 
     // Force close all of the streams so that they get a callback
-    std::for_each(m_retainedStreams.begin(), m_retainedStreams.end(), 
-        boost::lambda::bind(&BrowserStream::close, 
-            boost::lambda::bind(&BrowserStreamPtr::get, boost::lambda::_1)));
-    m_retainedStreams.clear();
+    for (size_t i = 0; i < StreamShardCount; ++i) {
+        boost::recursive_mutex::scoped_lock _l(m_shards[i].mutex);
+        std::for_each(m_shards[i].streams.begin(), m_shards[i].streams.end(),
+            boost::lambda::bind(&BrowserStream::close,
+                boost::lambda::bind(&BrowserStreamPtr::get, boost::lambda::_1)));
+        m_shards[i].streams.clear();
+    }
+}
+
+FB::BrowserStreamManager::StreamShard& FB::BrowserStreamManager::shardFor( const BrowserStream* stream ) const
+{
+    // Drop the low bits that are constant due to allocator alignment before bucketing
+    return m_shards[(reinterpret_cast<size_t>(stream) >> 4) % StreamShardCount];
 }
 
 void FB::BrowserStreamManager::retainStream( const BrowserStreamPtr& stream )
 {
-    boost::recursive_mutex::scoped_lock _l(m_xtmutex);
     stream->AttachObserver(shared_from_this());
-    m_retainedStreams.insert(stream);
+    size_t watermark;
+    {
+        boost::recursive_mutex::scoped_lock _l(m_xtmutex);
+        watermark = m_defaultWatermark;
+    }
+    if (watermark)
+        stream->setConsumeWatermark(watermark);
+    StreamShard& shard(shardFor(stream.get()));
+    boost::recursive_mutex::scoped_lock _l(shard.mutex);
+    shard.streams.insert(stream);
+}
+
+void FB::BrowserStreamManager::setDefaultConsumeWatermark( size_t bytes )
+{
+    {
+        boost::recursive_mutex::scoped_lock _l(m_xtmutex);
+        m_defaultWatermark = bytes;
+    }
+    for (size_t i = 0; i < StreamShardCount; ++i) {
+        boost::recursive_mutex::scoped_lock _l(m_shards[i].mutex);
+        for (std::set<BrowserStreamPtr>::const_iterator it = m_shards[i].streams.begin();
+             it != m_shards[i].streams.end(); ++it) {
+            (*it)->setConsumeWatermark(bytes);
+        }
+    }
 }
 
 void FB::BrowserStreamManager::releaseStream( const BrowserStreamPtr& stream )
 {
-    boost::recursive_mutex::scoped_lock _l(m_xtmutex);
     stream->DetachObserver(shared_from_this());
-    m_retainedStreams.erase(stream);
+    StreamShard& shard(shardFor(stream.get()));
+    boost::recursive_mutex::scoped_lock _l(shard.mutex);
+    shard.streams.erase(stream);
 }
 
 bool FB::BrowserStreamManager::onStreamCompleted( FB::StreamCompletedEvent *evt, FB::BrowserStream *stream )
@@ -36,13 +36,32 @@ namespace FB {
         void retainStream(const BrowserStreamPtr& stream);
         void releaseStream(const BrowserStreamPtr& stream);
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setDefaultConsumeWatermark(size_t bytes)
+        ///
+        /// @brief  Sets the flow-control watermark (see BrowserStream::setConsumeWatermark) that
+        ///         is applied to every stream retained by this manager; 0 (the default) leaves
+        ///         flow control off.  Already retained streams are updated as well.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setDefaultConsumeWatermark(size_t bytes);
+
         BEGIN_PLUGIN_EVENT_MAP()
             EVENTTYPE_CASE(FB::StreamCompletedEvent, onStreamCompleted, FB::BrowserStream)
         END_PLUGIN_EVENT_MAP()
         virtual bool onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *stream);
     private:
-        std::set<BrowserStreamPtr> m_retainedStreams;
-        mutable boost::recursive_mutex m_xtmutex;
+        // The retained set is sharded by stream pointer so concurrent retain/release pairs
+        // from many small requests don't serialize on one lock
+        static const size_t StreamShardCount = 8;
+        struct StreamShard {
+            std::set<BrowserStreamPtr> streams;
+            boost::recursive_mutex mutex;
+        };
+        StreamShard& shardFor(const BrowserStream* stream) const;
+
+        mutable StreamShard m_shards[StreamShardCount];
+        size_t m_defaultWatermark;
+        mutable boost::recursive_mutex m_xtmutex;   // guards m_defaultWatermark only
     };
 
 };
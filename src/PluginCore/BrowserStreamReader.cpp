@@ -0,0 +1,114 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 29, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <boost/bind.hpp>
+#include "PluginEvents/StreamEvents.h"
+
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+#include "BrowserStreamReader.h"
+
+using namespace FB;
+
+BrowserStreamReader::BrowserStreamReader(const BrowserHostPtr& host, size_t windowBytes)
+    : m_host(host), m_windowBytes(windowBytes), m_finished(false)
+{
+    m_buffer.reset(new StreamReadBuffer(this));
+    m_istream.reset(new std::istream(m_buffer.get()));
+}
+
+BrowserStreamReader::~BrowserStreamReader()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_finished = true;
+    m_dataAvailable.notify_all();
+}
+
+bool BrowserStreamReader::onStreamAttached(FB::AttachedEvent *evt, FB::BrowserStream * Stream)
+{
+    DefaultBrowserStreamHandler::onStreamAttached(evt, Stream);
+    // The watermark is what turns the queue into a bounded read-ahead window: the
+    // producer stalls once this many delivered bytes are unacknowledged and resumes
+    // as acknowledgeConsumed catches up
+    Stream->setConsumeWatermark(m_windowBytes);
+    return false;
+}
+
+bool BrowserStreamReader::onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_finished)
+        return false;
+    // getSlice shares the sender's block when it can, so queueing is refcount-only
+    // on hosts that deliver slices
+    m_chunks.push_back(evt->getSlice());
+    m_dataAvailable.notify_one();
+    return false;
+}
+
+bool BrowserStreamReader::onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_finished = true;
+    m_dataAvailable.notify_all();
+    return false;
+}
+
+bool BrowserStreamReader::onStreamFailedOpen(FB::StreamFailedOpenEvent *evt, FB::BrowserStream *)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_finished = true;
+    m_dataAvailable.notify_all();
+    return false;
+}
+
+void BrowserStreamReader::acknowledgeConsumed(size_t bytes)
+{
+    BrowserHostPtr host(m_host.lock());
+    BrowserStreamPtr ptr(getStream());
+    if (!host || !ptr)
+        return;
+    try {
+        host->ScheduleOnMainThread(ptr, boost::bind(&BrowserStream::reportConsumed, ptr, bytes));
+    } catch (const FB::script_error&) {
+        // browser is shutting down; nothing left to resume
+    }
+}
+
+std::streambuf::int_type BrowserStreamReader::StreamReadBuffer::underflow()
+{
+    // Runs on the reader thread.  The finished slice is acknowledged before blocking
+    // so a producer stalled on the watermark can refill while we wait.
+    if (m_owner->m_current.size()) {
+        m_owner->acknowledgeConsumed(m_owner->m_current.size());
+        m_owner->m_current = StreamDataSlice();
+    }
+
+    boost::mutex::scoped_lock lock(m_owner->m_mutex);
+    for (;;) {
+        while (m_owner->m_chunks.empty() && !m_owner->m_finished) {
+            m_owner->m_dataAvailable.wait(lock);
+        }
+        if (m_owner->m_chunks.empty()) {
+            return traits_type::eof();
+        }
+        m_owner->m_current = m_owner->m_chunks.front();
+        m_owner->m_chunks.pop_front();
+        if (m_owner->m_current.size())
+            break; // skip any empty slices
+    }
+
+    char* begin = const_cast<char*>(m_owner->m_current.data());
+    setg(begin, begin, begin + m_owner->m_current.size());
+    return traits_type::to_int_type(*begin);
+}
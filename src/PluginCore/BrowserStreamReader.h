@@ -0,0 +1,115 @@
+#pragma once
+#ifndef BrowserStreamReader_h__
+#define BrowserStreamReader_h__
+
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 29, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <deque>
+#include <istream>
+#include <streambuf>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include "BrowserHost.h"
+#include "DefaultBrowserStreamHandler.h"
+
+namespace FB {
+    FB_FORWARD_PTR(BrowserStreamReader);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  BrowserStreamReader
+    ///
+    /// @brief  Exposes a sequential BrowserStream as a blocking std::istream with a
+    ///         background-filled read-ahead window
+    ///
+    /// Attach an instance to a stream with AttachObserver and hand getIStream() to a parser
+    /// running on a worker thread.  Arrived data is queued as refcounted slices (no copy) on
+    /// the main thread; reads on the worker thread block until data is available and hit EOF
+    /// when the stream completes or fails.  The read-ahead window is enforced through the
+    /// stream's consume watermark: the browser keeps filling until it is windowBytes ahead of
+    /// the reader, then stalls until the reader catches up, so a sequential consumer overlaps
+    /// parsing with the download instead of alternating between the two.
+    ///
+    /// Consumed bytes are acknowledged back to the stream on the main thread through the host;
+    /// pass the host the stream was created from.  Only sequential (non-range) streams are
+    /// supported; the stream buffer does not implement seeking.
+    ///
+    /// Destroying the reader wakes any blocked read with EOF, but the worker thread must not
+    /// touch the istream afterwards; join it first.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class BrowserStreamReader : public DefaultBrowserStreamHandler
+    {
+    public:
+        BrowserStreamReader(const BrowserHostPtr& host, size_t windowBytes = 256 * 1024);
+        virtual ~BrowserStreamReader();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn std::istream& getIStream()
+        ///
+        /// @brief  Returns the blocking istream over the stream contents; read it from a
+        ///         worker thread, never from the main thread
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        std::istream& getIStream() { return *m_istream; }
+
+        /// Returns the configured read-ahead window in bytes; 0 means unbounded buffering
+        size_t getWindowBytes() const { return m_windowBytes; }
+
+        virtual bool onStreamAttached(FB::AttachedEvent *evt, FB::BrowserStream * Stream);
+        virtual bool onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamFailedOpen(FB::StreamFailedOpenEvent *evt, FB::BrowserStream *);
+
+    protected:
+        /// Called from the worker thread when a slice has been fully read; bounces
+        /// reportConsumed to the main thread so the producer can be resumed
+        void acknowledgeConsumed(size_t bytes);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @class  StreamReadBuffer
+        ///
+        /// @brief  streambuf over the queued slices; underflow blocks until the main thread
+        ///         queues more data or the stream ends
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        class StreamReadBuffer : public std::streambuf
+        {
+        public:
+            StreamReadBuffer(BrowserStreamReader* owner) : m_owner(owner) {}
+        protected:
+            virtual int_type underflow();
+        private:
+            BrowserStreamReader* m_owner;
+        };
+        friend class StreamReadBuffer;
+
+    private:
+        BrowserHostWeakPtr m_host;
+        size_t m_windowBytes;
+
+        // Queue state; guarded by m_mutex, signalled through m_dataAvailable
+        std::deque<StreamDataSlice> m_chunks;
+        bool m_finished;        // completed, failed or reader shut down; no more data coming
+        boost::mutex m_mutex;
+        boost::condition_variable m_dataAvailable;
+
+        // Only touched by the reader thread: the slice the get area currently points into
+        StreamDataSlice m_current;
+
+        boost::scoped_ptr<StreamReadBuffer> m_buffer;
+        boost::scoped_ptr<std::istream> m_istream;
+    };
+}
+#endif // BrowserStreamReader_h__
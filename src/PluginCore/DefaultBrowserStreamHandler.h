@@ -180,6 +180,50 @@ namespace FB {
 
         BrowserStreamPtr stream;  ///< stream instance, don't use yourself
     };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  BrowserStreamHandlerT
+    ///
+    /// @brief  CRTP stream handler that delivers data chunks through a direct, inlinable call
+    ///
+    /// DefaultBrowserStreamHandler routes every chunk through the event map and a virtual
+    /// onStreamDataArrived; at local-service streaming rates that per-chunk dispatch stops being
+    /// noise.  Derive as
+    /// @code
+    ///     class MyHandler : public FB::BrowserStreamHandlerT<MyHandler> {
+    ///     public:
+    ///         bool onStreamData(FB::StreamDataArrivedEvent* evt, FB::BrowserStream* stream);
+    ///     };
+    /// @endcode
+    /// and the data event is recognized with one type-id check and handed to onStreamData as a
+    /// compile-time-resolved call the compiler can inline.  onStreamData is deliberately a new,
+    /// non-virtual name: overriding the virtual onStreamDataArrived would just reintroduce the
+    /// dynamic dispatch this exists to avoid.  All other stream events (open, complete, failure)
+    /// are rare and still take the ordinary event map, so the remaining onStream* overrides work
+    /// exactly as they do on DefaultBrowserStreamHandler.  A Derived without onStreamData falls
+    /// back to onStreamDataArrived unchanged.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template <class Derived>
+    class BrowserStreamHandlerT : public DefaultBrowserStreamHandler
+    {
+    public:
+        virtual bool HandleEvent(FB::PluginEvent *evt, FB::PluginEventSource *src)
+        {
+            if (evt->validType<FB::StreamDataArrivedEvent>() && src->validType<FB::BrowserStream>()) {
+                return static_cast<Derived*>(this)->onStreamData(
+                    evt->get<FB::StreamDataArrivedEvent>(), src->get_as<FB::BrowserStream>());
+            }
+            return DefaultBrowserStreamHandler::HandleEvent(evt, src);
+        }
+
+        /// Fallback used when Derived doesn't provide its own onStreamData
+        bool onStreamData(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *Stream)
+        {
+            return onStreamDataArrived(evt, Stream);
+        }
+    };
 }
 #endif // DefaultBrowserStreamHandler_h__
 
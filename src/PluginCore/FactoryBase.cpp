@@ -24,6 +24,7 @@
 #endif
 
 #include "PluginInfo.h"
+#include "WorkerPool.h"
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
 FB::FactoryBase::FactoryBase()
@@ -83,6 +84,21 @@ FB::Log::LogLevel FB::FactoryBase::getLogLevel()
     return FB::Log::LogLevel_Info;
 }
 
+void FB::FactoryBase::getLogSourceLevels( FB::Log::LogSourceLevelMap& outLevels )
+{
+}
+
+void FB::FactoryBase::getLogRateLimit( unsigned int& messagesPerSecond, unsigned int& burst )
+{
+    messagesPerSecond = 0;  // unlimited
+    burst = 0;
+}
+
+FB::WorkerPoolPtr FB::FactoryBase::getWorkerPool()
+{
+    return FB::WorkerPool::instance();
+}
+
 
 #ifdef FB_WIN
 FB::PluginWindowWin* FB::FactoryBase::createPluginWindowWin(const WindowContextWin& ctx)
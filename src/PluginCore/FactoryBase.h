@@ -39,6 +39,7 @@ namespace FB
     FB_FORWARD_PTR(PluginCore);
     FB_FORWARD_PTR(BrowserHost);
     FB_FORWARD_PTR(JSAPI);
+    FB_FORWARD_PTR(WorkerPool);
     /// @brief  Defines an alias representing a boost::shared_ptr<FactoryBase>
     typedef boost::shared_ptr<FactoryBase> FactoryBasePtr;
 
@@ -215,6 +216,48 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual FB::Log::LogLevel getLogLevel();
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void getLogSourceLevels(FB::Log::LogSourceLevelMap& outLevels)
+        ///
+        /// @brief  Called by the logger to discover per-source log level overrides
+        ///
+        /// Sources named here (the first argument of the FBLOG_* macros, e.g. "NpapiStream") use
+        /// the given level instead of getLogLevel()'s global one, so a single subsystem can be
+        /// traced without paying logging cost everywhere.  The default provides no overrides.
+        ///
+        /// @param  outLevels    a LogSourceLevelMap instance to hold the result
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void getLogSourceLevels(FB::Log::LogSourceLevelMap& outLevels);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void getLogRateLimit(unsigned int& messagesPerSecond, unsigned int& burst)
+        ///
+        /// @brief  Called by the logger to discover the per-callsite rate limit
+        ///
+        /// messagesPerSecond caps how fast any single FBLOG_* callsite may emit; burst is how many
+        /// messages a quiet callsite may get out at once before the cap applies (0 picks
+        /// messagesPerSecond).  Keeps worst-case logging cost bounded when something misbehaves in
+        /// a loop.  The default leaves limiting off.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void getLogRateLimit(unsigned int& messagesPerSecond, unsigned int& burst);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual FB::WorkerPoolPtr getWorkerPool()
+        ///
+        /// @brief  Returns the process-wide work-stealing thread pool
+        ///
+        /// The default returns WorkerPool::instance(), one pool sized to hardware concurrency
+        /// and shared by the framework and every plugin in the module.  Hold the returned
+        /// pointer for as long as the pool is needed; the workers join when the last reference
+        /// drops.  Override to substitute a differently sized pool.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual FB::WorkerPoolPtr getWorkerPool();
+
 #ifdef FB_WIN
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual PluginWindowWin* FactoryBase::createPluginWindowWin(const WindowContextWin& ctx)
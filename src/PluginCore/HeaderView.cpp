@@ -0,0 +1,132 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <cctype>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "HeaderView.h"
+
+using FB::HeaderView;
+
+namespace {
+    bool is_lws(char c) { return c == ' ' || c == '\t'; }
+
+    // Case-insensitive span/string compare without allocating
+    bool span_iequals(const char* data, size_t len, const std::string& name) {
+        if (len != name.size()) return false;
+        for (size_t i = 0; i < len; ++i) {
+            if (std::tolower(static_cast<unsigned char>(data[i]))
+                != std::tolower(static_cast<unsigned char>(name[i]))) return false;
+        }
+        return true;
+    }
+}
+
+HeaderView::HeaderView(const std::string& raw) : m_raw(raw)
+{
+    const char* base = m_raw.data();
+    size_t len = m_raw.size();
+    size_t pos = 0;
+    while (pos < len) {
+        size_t eol = pos;
+        while (eol < len && base[eol] != '\r' && base[eol] != '\n') ++eol;
+
+        // Trim the line, locate the colon, trim name and value -- all as offsets
+        size_t b = pos, e = eol;
+        while (b < e && is_lws(base[b])) ++b;
+        while (e > b && is_lws(base[e - 1])) --e;
+        if (b < e) {
+            size_t colon = b;
+            while (colon < e && base[colon] != ':') ++colon;
+            if (colon < e) { // lines without a colon are bad headers; skip them
+                size_t ne = colon;
+                while (ne > b && is_lws(base[ne - 1])) --ne;
+                size_t vb = colon + 1;
+                while (vb < e && is_lws(base[vb])) ++vb;
+                Span s;
+                s.nameOff = static_cast<uint32_t>(b);
+                s.nameLen = static_cast<uint32_t>(ne - b);
+                s.valueOff = static_cast<uint32_t>(vb);
+                s.valueLen = static_cast<uint32_t>(e - vb);
+                m_index.push_back(s);
+            }
+        }
+        pos = eol;
+        while (pos < len && (base[pos] == '\r' || base[pos] == '\n')) ++pos;
+    }
+}
+
+bool HeaderView::nameMatches(const Span& s, const std::string& name) const
+{
+    return span_iequals(m_raw.data() + s.nameOff, s.nameLen, name);
+}
+
+bool HeaderView::contains(const std::string& name) const
+{
+    const char* value;
+    size_t len;
+    return findRef(name, value, len);
+}
+
+bool HeaderView::findRef(const std::string& name, const char*& value, size_t& len) const
+{
+    for (std::vector<Span>::const_iterator it = m_index.begin(); it != m_index.end(); ++it) {
+        if (nameMatches(*it, name)) {
+            value = m_raw.data() + it->valueOff;
+            len = it->valueLen;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string HeaderView::get(const std::string& name) const
+{
+    const char* value;
+    size_t len;
+    if (findRef(name, value, len)) return std::string(value, len);
+    return std::string();
+}
+
+std::vector<std::string> HeaderView::getAll(const std::string& name) const
+{
+    std::vector<std::string> res;
+    for (std::vector<Span>::const_iterator it = m_index.begin(); it != m_index.end(); ++it) {
+        if (nameMatches(*it, name))
+            res.push_back(std::string(m_raw.data() + it->valueOff, it->valueLen));
+    }
+    return res;
+}
+
+std::string HeaderView::nameAt(size_t i) const
+{
+    const Span& s = m_index[i];
+    return std::string(m_raw.data() + s.nameOff, s.nameLen);
+}
+
+std::string HeaderView::valueAt(size_t i) const
+{
+    const Span& s = m_index[i];
+    return std::string(m_raw.data() + s.valueOff, s.valueLen);
+}
+
+FB::HeaderMap HeaderView::toMap() const
+{
+    FB::HeaderMap res;
+    for (std::vector<Span>::const_iterator it = m_index.begin(); it != m_index.end(); ++it) {
+        res.insert(std::make_pair(std::string(m_raw.data() + it->nameOff, it->nameLen),
+            std::string(m_raw.data() + it->valueOff, it->valueLen)));
+    }
+    return res;
+}
@@ -0,0 +1,79 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_HEADERVIEW
+#define H_FB_HEADERVIEW
+
+#include <string>
+#include <vector>
+#include <map>
+#include "APITypes.h"
+
+namespace FB {
+
+    typedef std::multimap<std::string, std::string> HeaderMap;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  HeaderView
+    ///
+    /// @brief  Non-allocating view over a raw HTTP header block
+    ///
+    /// Holds the raw block in a single string and indexes it in one pass as name/value spans;
+    /// nothing is split or trimmed into per-header strings up front.  Lookups are
+    /// case-insensitive and values are materialized only for the headers that are actually
+    /// read -- a CDN response carrying 40+ headers nobody looks at costs one allocation, not
+    /// eighty.  toMap() materializes everything for code that needs the classic HeaderMap.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class HeaderView {
+    public:
+        HeaderView() { }
+        /// Indexes the given raw header block (lines of "Name: value")
+        explicit HeaderView(const std::string& raw);
+
+        size_t size() const { return m_index.size(); }
+        bool empty() const { return m_index.empty(); }
+
+        /// True if a header with this name is present (case-insensitive)
+        bool contains(const std::string& name) const;
+        /// Value of the first header matching name; empty string if absent
+        std::string get(const std::string& name) const;
+        /// All values for name, in block order
+        std::vector<std::string> getAll(const std::string& name) const;
+        /// Zero-copy lookup: on a hit, value/len point into the raw block and
+        /// stay valid as long as this view does
+        bool findRef(const std::string& name, const char*& value, size_t& len) const;
+
+        /// Name/value of the i'th header, materialized on demand
+        std::string nameAt(size_t i) const;
+        std::string valueAt(size_t i) const;
+
+        /// Materializes every header into a HeaderMap
+        HeaderMap toMap() const;
+
+    private:
+        struct Span {
+            uint32_t nameOff, nameLen;
+            uint32_t valueOff, valueLen;
+        };
+        bool nameMatches(const Span& s, const std::string& name) const;
+
+        std::string m_raw;
+        std::vector<Span> m_index;
+    };
+};
+
+#endif // H_FB_HEADERVIEW
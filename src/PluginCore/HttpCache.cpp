@@ -0,0 +1,327 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <boost/algorithm/string.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "HttpCache.h"
+
+using FB::HttpCache;
+
+namespace {
+    const char* const kIndexMagic = "# fbhttpcache 1";
+
+    uint64_t fnv1a64(const uint8_t* data, size_t len)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < len; ++i) {
+            hash ^= data[i];
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // Index fields are whitespace-separated; escape whitespace and '%' so any
+    // URL or validator survives the round trip.  Empty fields are written as "-".
+    std::string escapeField(const std::string& s)
+    {
+        if (s.empty())
+            return "-";
+        std::ostringstream out;
+        for (size_t i = 0; i < s.size(); ++i) {
+            unsigned char c = s[i];
+            if (c <= 0x20 || c == '%' || c >= 0x7f || (c == '-' && s.size() == 1)) {
+                char buf[4];
+                std::sprintf(buf, "%%%02X", c);
+                out << buf;
+            } else {
+                out << s[i];
+            }
+        }
+        return out.str();
+    }
+
+    std::string unescapeField(const std::string& s)
+    {
+        if (s == "-")
+            return std::string();
+        std::string out;
+        out.reserve(s.size());
+        for (size_t i = 0; i < s.size(); ++i) {
+            if (s[i] == '%' && i + 2 < s.size()) {
+                out += static_cast<char>(std::strtol(s.substr(i + 1, 2).c_str(), NULL, 16));
+                i += 2;
+            } else {
+                out += s[i];
+            }
+        }
+        return out;
+    }
+
+    // Pull a single header value out of the multimap, case-insensitively
+    std::string findHeader(const FB::HeaderMap& headers, const std::string& name)
+    {
+        for (FB::HeaderMap::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+            if (boost::iequals(it->first, name))
+                return it->second;
+        }
+        return std::string();
+    }
+
+    // Returns false if the response forbids caching; otherwise sets ttlOut from
+    // Cache-Control max-age when present (defaultTtl otherwise)
+    bool cacheLifetime(const FB::HeaderMap& headers, long defaultTtl, long& ttlOut)
+    {
+        ttlOut = defaultTtl;
+        std::string cc = findHeader(headers, "Cache-Control");
+        if (cc.empty())
+            return true;
+        std::vector<std::string> parts;
+        boost::split(parts, cc, boost::is_any_of(","));
+        for (size_t i = 0; i < parts.size(); ++i) {
+            std::string p = boost::trim_copy(parts[i]);
+            if (boost::iequals(p, "no-store") || boost::iequals(p, "no-cache"))
+                return false;
+            if (boost::istarts_with(p, "max-age=")) {
+                long age = std::atol(p.c_str() + 8);
+                if (age <= 0)
+                    return false;
+                ttlOut = age;
+            }
+        }
+        return true;
+    }
+}
+
+HttpCache& HttpCache::get()
+{
+    static HttpCache cache;
+    return cache;
+}
+
+bool HttpCache::enable(const std::string& cacheDir, long defaultTtlSeconds /*= 3600*/)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_dir = cacheDir;
+    m_defaultTtl = defaultTtlSeconds > 0 ? defaultTtlSeconds : 3600;
+    m_entries.clear();
+    m_enabled = loadIndex();
+    if (!m_enabled)
+        m_dir.clear();
+    return m_enabled;
+}
+
+void HttpCache::disable()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_enabled = false;
+    m_dir.clear();
+    m_entries.clear();
+}
+
+bool HttpCache::isEnabled() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_enabled;
+}
+
+void HttpCache::purge()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!m_enabled)
+        return;
+    for (EntryMap::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+        std::remove(bodyPath(it->second.hash).c_str());
+    m_entries.clear();
+    std::ofstream out(indexPath().c_str(), std::ios::trunc);
+    if (out)
+        out << kIndexMagic << "\n";
+}
+
+void HttpCache::sweepExpired()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!m_enabled)
+        return;
+    std::time_t now = std::time(NULL);
+    EntryMap::iterator it = m_entries.begin();
+    while (it != m_entries.end()) {
+        if (it->second.expires <= now)
+            m_entries.erase(it++);
+        else
+            ++it;
+    }
+}
+
+size_t HttpCache::entryCount() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_entries.size();
+}
+
+std::string HttpCache::bodyPath(uint64_t hash) const
+{
+    char buf[24];
+    std::sprintf(buf, "%016llx", static_cast<unsigned long long>(hash));
+    return m_dir + "/" + buf + ".body";
+}
+
+std::string HttpCache::indexPath() const
+{
+    return m_dir + "/index.fbcache";
+}
+
+bool HttpCache::loadIndex()
+{
+    // No index yet is fine -- probe that the directory is writable by creating it
+    std::ifstream in(indexPath().c_str());
+    if (!in) {
+        std::ofstream probe(indexPath().c_str());
+        if (!probe)
+            return false;
+        probe << kIndexMagic << "\n";
+        return probe.good();
+    }
+    std::string line;
+    if (!std::getline(in, line) || line.substr(0, std::strlen(kIndexMagic)) != kIndexMagic)
+        return false;
+    std::time_t now = std::time(NULL);
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        Entry e;
+        long long expires = 0;
+        unsigned long long size = 0, hash = 0;
+        std::string url, etag, lastmod, ctype;
+        if (!(fields >> expires >> size >> std::hex >> hash >> std::dec
+                     >> url >> etag >> lastmod >> ctype))
+            continue;   // ignore torn/garbled lines (e.g. from a crash mid-append)
+        if (expires <= now)
+            continue;
+        e.expires = static_cast<std::time_t>(expires);
+        e.size = static_cast<size_t>(size);
+        e.hash = hash;
+        e.etag = unescapeField(etag);
+        e.lastModified = unescapeField(lastmod);
+        e.contentType = unescapeField(ctype);
+        // Later lines win so re-fetches of the same URL shadow older entries
+        m_entries[unescapeField(url)] = e;
+    }
+    return true;
+}
+
+void HttpCache::appendIndex(const std::string& url, const Entry& e)
+{
+    std::ofstream out(indexPath().c_str(), std::ios::app);
+    if (!out)
+        return;
+    char hashBuf[24];
+    std::sprintf(hashBuf, "%016llx", static_cast<unsigned long long>(e.hash));
+    out << static_cast<long long>(e.expires) << " " << e.size << " " << hashBuf << " "
+        << escapeField(url) << " " << escapeField(e.etag) << " "
+        << escapeField(e.lastModified) << " " << escapeField(e.contentType) << "\n";
+}
+
+bool HttpCache::fetch(const std::string& url, FB::HeaderMap& headers,
+    boost::shared_array<uint8_t>& data, size_t& size)
+{
+    Entry e;
+    std::string path;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (!m_enabled)
+            return false;
+        EntryMap::iterator it = m_entries.find(url);
+        if (it == m_entries.end())
+            return false;
+        if (it->second.expires <= std::time(NULL)) {
+            m_entries.erase(it);    // lazily evict; the body file may be shared
+            return false;
+        }
+        e = it->second;
+        path = bodyPath(e.hash);
+    }
+
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in)
+        return false;
+    boost::shared_array<uint8_t> buf(new uint8_t[e.size ? e.size : 1]);
+    in.read(reinterpret_cast<char*>(buf.get()), e.size);
+    if (static_cast<size_t>(in.gcount()) != e.size)
+        return false;
+
+    // The cache keeps the headers a consumer can act on, not the full response
+    headers.clear();
+    if (!e.contentType.empty())
+        headers.insert(std::make_pair("Content-Type", e.contentType));
+    if (!e.etag.empty())
+        headers.insert(std::make_pair("ETag", e.etag));
+    if (!e.lastModified.empty())
+        headers.insert(std::make_pair("Last-Modified", e.lastModified));
+    std::ostringstream len;
+    len << e.size;
+    headers.insert(std::make_pair("Content-Length", len.str()));
+    headers.insert(std::make_pair("X-FB-Cache", "HIT"));
+    data = buf;
+    size = e.size;
+    return true;
+}
+
+void HttpCache::store(const std::string& url, const FB::HeaderMap& headers,
+    const boost::shared_array<uint8_t>& data, size_t size)
+{
+    long ttl = 0;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (!m_enabled)
+            return;
+        if (!cacheLifetime(headers, m_defaultTtl, ttl))
+            return;
+    }
+    if (!data && size)
+        return;
+
+    Entry e;
+    e.hash = fnv1a64(data.get(), size);
+    e.size = size;
+    e.expires = std::time(NULL) + ttl;
+    e.etag = findHeader(headers, "ETag");
+    e.lastModified = findHeader(headers, "Last-Modified");
+    e.contentType = findHeader(headers, "Content-Type");
+
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (!m_enabled)
+        return;
+    std::string path = bodyPath(e.hash);
+    std::ifstream probe(path.c_str(), std::ios::binary);
+    if (!probe) {
+        // Content-addressed: only write the body if this content is new.  Write
+        // through a temp name and rename so a torn write never shadows a hash.
+        std::string tmp = path + ".tmp";
+        std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+        if (!out)
+            return;
+        out.write(reinterpret_cast<const char*>(data.get()), size);
+        out.close();
+        if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    m_entries[url] = e;
+    appendIndex(url, e);
+}
@@ -0,0 +1,124 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_HTTPCACHE
+#define H_FB_HTTPCACHE
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <boost/shared_array.hpp>
+#include <boost/thread/mutex.hpp>
+#include "APITypes.h"
+
+namespace FB {
+
+    typedef std::multimap<std::string, std::string> HeaderMap;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  HttpCache
+    ///
+    /// @brief  Opt-in plugin-side disk cache for responses fetched through SimpleStreamHelper
+    ///
+    /// Some deployments sit behind CDNs whose cache-busting headers defeat the browser cache, so
+    /// every AsyncGet refetches resources that are byte-identical across sessions.  When enabled
+    /// with a writable directory, SimpleStreamHelper consults this cache before creating a
+    /// BrowserStreamRequest for a cacheable GET and serves a fresh entry without touching the
+    /// network; successful responses are stored on the way out.
+    ///
+    /// Bodies are content-addressed (FNV-1a of the content), so identical payloads fetched from
+    /// different URLs share one file on disk.  The index maps URL to content hash, size, expiry
+    /// time and the response validators (ETag / Last-Modified); it is loaded once at enable()
+    /// and appended to on every store, so a crash loses at most the in-flight line.  Entry
+    /// lifetime honours Cache-Control max-age (no-store is never cached) and falls back to the
+    /// default TTL passed to enable(); expired entries are evicted lazily on lookup.
+    ///
+    /// The cache is process-wide and disabled by default; nothing changes for plugins that never
+    /// call enable().
+    ///
+    /// @see FB::SimpleStreamHelper
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class HttpCache
+    {
+    public:
+        /// @brief  Returns the process-wide cache instance
+        static HttpCache& get();
+
+        /// @brief  Turn the cache on, backed by the given (existing, writable) directory.
+        ///
+        /// Loads the index from previous sessions, dropping entries that have expired.
+        /// Responses without usable freshness headers live for defaultTtlSeconds.
+        /// Returns false (and stays disabled) if the directory is not usable.
+        bool enable(const std::string& cacheDir, long defaultTtlSeconds = 3600);
+
+        /// @brief  Turn the cache off; files on disk are kept for the next enable()
+        void disable();
+
+        /// @brief  True between enable() and disable()
+        bool isEnabled() const;
+
+        /// @brief  Look up a fresh cached response for url.
+        ///
+        /// On a hit fills headers/data/size from disk and returns true; expired or
+        /// missing entries return false.  Safe to call from any thread.
+        bool fetch(const std::string& url, FB::HeaderMap& headers,
+            boost::shared_array<uint8_t>& data, size_t& size);
+
+        /// @brief  Store a successful response; no-op when disabled or the response
+        ///         forbids caching (Cache-Control: no-store / no-cache)
+        void store(const std::string& url, const FB::HeaderMap& headers,
+            const boost::shared_array<uint8_t>& data, size_t size);
+
+        /// @brief  Remove every entry, its body files and the index contents from disk
+        void purge();
+
+        /// @brief  Drop expired entries from the index without waiting for a lookup to
+        ///         stumble over them.  Body files stay (they may be shared between
+        ///         entries), matching the lazy eviction on fetch.  Run by the
+        ///         IdleScheduler during quiet periods; safe to call from any thread.
+        void sweepExpired();
+
+        /// @brief  Number of (possibly stale) entries currently indexed; mostly for tests
+        size_t entryCount() const;
+
+    private:
+        HttpCache() : m_enabled(false), m_defaultTtl(3600) {}
+
+        struct Entry {
+            Entry() : expires(0), size(0), hash(0) {}
+            std::time_t expires;
+            size_t size;
+            uint64_t hash;          // content hash; names the body file
+            std::string etag;       // validators, kept for diagnostics/revalidation
+            std::string lastModified;
+            std::string contentType;
+        };
+        typedef std::map<std::string, Entry> EntryMap;
+
+        std::string bodyPath(uint64_t hash) const;
+        std::string indexPath() const;
+        bool loadIndex();
+        void appendIndex(const std::string& url, const Entry& e);
+
+        mutable boost::mutex m_mutex;
+        bool m_enabled;
+        std::string m_dir;
+        long m_defaultTtl;
+        EntryMap m_entries;
+    };
+};
+
+#endif // H_FB_HTTPCACHE
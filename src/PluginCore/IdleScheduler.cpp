@@ -0,0 +1,156 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <boost/bind.hpp>
+#include "logging.h"
+#include "StreamChunkPool.h"
+#include "HttpCache.h"
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "IdleScheduler.h"
+
+using namespace FB;
+
+IdleSchedulerWeakPtr IdleScheduler::inst;
+boost::mutex IdleScheduler::instance_mutex;
+
+namespace {
+    // Cadence of the idle check; the slack lets the TimerService batch it with
+    // other housekeeping wakeups instead of adding one of its own
+    const long kTickPeriodMs = 5000;
+    const long kTickSlackMs = 1000;
+    // How long since the last reported activity before trim work may run
+    const long kIdleThresholdVisibleSec = 10;
+    // With every instance hidden there is nobody to disturb; trim sooner
+    const long kIdleThresholdHiddenSec = 2;
+}
+
+IdleSchedulerPtr IdleScheduler::instance()
+{
+    boost::mutex::scoped_lock lock(instance_mutex);
+    IdleSchedulerPtr ptr(inst.lock());
+    if (!ptr) {
+        ptr = IdleSchedulerPtr(new IdleScheduler());
+        inst = ptr;
+        // two-phase because scheduling the first tick needs shared_from_this
+        ptr->start();
+    }
+    return ptr;
+}
+
+IdleScheduler::IdleScheduler()
+    : m_nextTask(0), m_nextToken(1), m_visibleCount(0), m_lastActivity(std::time(NULL)),
+      m_ns(0)
+{
+    // Framework-owned pools and caches get trimmed out of the box; subsystems
+    // owned by a plugin register their own tasks through addTask
+    addTask("StreamChunkPool", &StreamChunkPool::trim);
+    addTask("HttpCache", boost::bind(&HttpCache::sweepExpired, &HttpCache::get()));
+}
+
+IdleScheduler::~IdleScheduler()
+{
+    if (m_timerService)
+        m_timerService->destroyNamespace(m_ns);
+}
+
+void IdleScheduler::start()
+{
+    m_timerService = TimerService::instance();
+    m_ns = m_timerService->createNamespace();
+    scheduleTick();
+}
+
+void IdleScheduler::scheduleTick()
+{
+    // The tick holds only a weak self-reference so a pending timeout never keeps
+    // a torn-down scheduler alive (or calls into one)
+    m_timerService->scheduleTimeout(kTickPeriodMs,
+        boost::bind(&IdleScheduler::tickTrampoline, IdleSchedulerWeakPtr(shared_from_this())),
+        kTickSlackMs, m_ns);
+}
+
+/*static*/ void IdleScheduler::tickTrampoline(IdleSchedulerWeakPtr self)
+{
+    IdleSchedulerPtr ptr(self.lock());
+    if (ptr)
+        ptr->onTick();
+}
+
+void IdleScheduler::onTick()
+{
+    std::time_t now = std::time(NULL);
+    TrimFunc func;
+    std::string name;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        const long threshold = (m_visibleCount > 0)
+            ? kIdleThresholdVisibleSec : kIdleThresholdHiddenSec;
+        if (!m_tasks.empty() && now - m_lastActivity >= threshold) {
+            Task& task = m_tasks[m_nextTask++ % m_tasks.size()];
+            func = task.func;
+            name = task.name;
+        }
+    }
+    // One task per tick keeps any single quiet-period pass short; the rotation
+    // reaches every registered task over successive ticks
+    if (func) {
+        try {
+            func();
+        } catch (const std::exception& e) {
+            FBLOG_WARN("IdleScheduler", "Trim task " << name << " threw: " << e.what());
+        }
+    }
+    scheduleTick();
+}
+
+boost::uint64_t IdleScheduler::addTask(const std::string& name, const TrimFunc& func)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    Task task;
+    task.token = m_nextToken++;
+    task.name = name;
+    task.func = func;
+    m_tasks.push_back(task);
+    return task.token;
+}
+
+bool IdleScheduler::removeTask(boost::uint64_t token)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (std::vector<Task>::iterator it = m_tasks.begin(); it != m_tasks.end(); ++it) {
+        if (it->token == token) {
+            m_tasks.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+void IdleScheduler::notifyActivity()
+{
+    // Racy by design: a torn or slightly stale timestamp only shifts the idle
+    // boundary by a tick, and this must stay cheap enough for interaction paths
+    m_lastActivity = std::time(NULL);
+}
+
+void IdleScheduler::noteVisible(bool visible)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_visibleCount += visible ? 1 : -1;
+    if (m_visibleCount < 0)
+        m_visibleCount = 0;
+    // A visibility change is user-driven; don't start trimming right on top of it
+    m_lastActivity = std::time(NULL);
+}
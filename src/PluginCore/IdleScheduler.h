@@ -0,0 +1,132 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_IDLESCHEDULER
+#define H_FB_IDLESCHEDULER
+
+#include <ctime>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "FBPointers.h"
+#include "TimerService.h"
+
+namespace FB {
+
+    FB_FORWARD_PTR(IdleScheduler);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  IdleScheduler
+    ///
+    /// @brief  Runs pool and cache trim work during quiet periods instead of during user
+    ///         interaction
+    ///
+    /// The framework's pools and caches (stream chunk slabs, the HTTP cache, ...) accumulate
+    /// memory during bursts and each used to pick its own moment to let go of it -- usually
+    /// the worst one, right in the middle of the next burst.  This scheduler centralizes the
+    /// policy: a low-priority TimerService tick checks how long it has been since the last
+    /// reported activity, and once the process has been quiet long enough it runs one
+    /// registered trim task per tick, rotating through them so every task gets its turn
+    /// without any single pass stalling for long.
+    ///
+    /// Visibility feeds the policy through noteVisible(): PluginCore reports instances as
+    /// they become visible, suspended and destroyed.  While at least one instance is visible
+    /// the idle threshold is conservative; with everything hidden there is nobody to disturb
+    /// and trimming starts sooner.
+    ///
+    /// Framework-owned caches are registered automatically; plugin subsystems add their own
+    /// trim callbacks with addTask.  Tasks run on the timer thread and must be safe to call
+    /// there -- work that has to happen on the main thread should trampoline through its
+    /// BrowserHost from inside the task.
+    ///
+    /// The scheduler is shared by every plugin instance in the process and lives as long as
+    /// anyone holds the pointer returned by instance().
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class IdleScheduler : public boost::enable_shared_from_this<IdleScheduler>
+    {
+    public:
+        typedef boost::function<void (void)> TrimFunc;
+
+        /// @brief  Returns the process-wide scheduler, creating it on first use
+        static IdleSchedulerPtr instance();
+        ~IdleScheduler();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn boost::uint64_t addTask(const std::string& name, const TrimFunc& func)
+        ///
+        /// @brief  Registers a trim task to run during quiet periods
+        ///
+        /// Tasks should trim toward a watermark rather than empty their pool: the point is to
+        /// give back burst growth, not to defeat the pooling.  Each invocation should also be
+        /// brief; a task that has a lot to do can do part of it and catch up on later turns.
+        ///
+        /// @param  name    label used in log messages when the task throws
+        /// @param  func    callback invoked on the timer thread
+        /// @return token to pass to removeTask; never 0
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        boost::uint64_t addTask(const std::string& name, const TrimFunc& func);
+
+        /// @brief  Unregisters a task; returns false if the token is unknown
+        bool removeTask(boost::uint64_t token);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void notifyActivity()
+        ///
+        /// @brief  Marks the process as active, postponing trim work
+        ///
+        /// Cheap enough to call from interaction paths: a timestamp store, no lock taken.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void notifyActivity();
+
+        /// @brief  Adjusts the count of visible plugin instances (see class comment);
+        ///         also counts as activity
+        void noteVisible(bool visible);
+
+    protected:
+        static IdleSchedulerWeakPtr inst;
+        static boost::mutex instance_mutex;
+        IdleScheduler();
+        void start();
+
+    private:
+        static void tickTrampoline(IdleSchedulerWeakPtr self);
+        void onTick();
+        void scheduleTick();
+
+        struct Task {
+            boost::uint64_t token;
+            std::string name;
+            TrimFunc func;
+        };
+
+        boost::mutex m_mutex;
+        std::vector<Task> m_tasks;
+        std::size_t m_nextTask;             // rotation cursor; one task runs per idle tick
+        boost::uint64_t m_nextToken;
+        int m_visibleCount;
+        volatile std::time_t m_lastActivity;
+        TimerServicePtr m_timerService;
+        TimerService::TimerNamespace m_ns;  // groups our ticks for cancellation at teardown
+    };
+
+};
+
+#endif // H_FB_IDLESCHEDULER
@@ -42,7 +42,7 @@ FB::SystemProxyDetector* FB::SystemProxyDetector::get()
     return _inst.get();
 }
 
-bool FB::SystemProxyDetectorMac::detectProxy( map<string, string>& proxyMap, const string& URL )
+bool FB::SystemProxyDetectorMac::detectProxySystem( map<string, string>& proxyMap, const string& URL )
 {
     CFDictionaryRef proxySettings(SCDynamicStoreCopyProxies(NULL));
     if (! proxySettings) {
@@ -13,7 +13,9 @@ namespace FB {
         ~SystemProxyDetectorMac() {}
         SystemProxyDetector* get();
         
-        virtual bool detectProxy(std::map<std::string, std::string>& proxyMap, const std::string& URL);
+    protected:
+        virtual bool detectProxySystem(std::map<std::string, std::string>& proxyMap, const std::string& URL);
+    public:
         friend class SystemProxyDetector;
     };
     
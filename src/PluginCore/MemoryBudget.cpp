@@ -0,0 +1,110 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include "MemoryBudget.h"
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+using FB::MemoryBudget;
+
+MemoryBudget::MemoryBudget()
+    : m_total(0), m_softBudget(0), m_pressureSignaled(false)
+{
+    for (int i = 0; i < Category_Count; ++i)
+        m_used[i] = 0;
+}
+
+void MemoryBudget::charge(Category cat, size_t bytes)
+{
+    PressureCallback fire;
+    size_t used, budget;
+    {
+        boost::mutex::scoped_lock _l(m_mutex);
+        m_used[cat] += bytes;
+        m_total += bytes;
+        fire = checkPressure();
+        used = m_total;
+        budget = m_softBudget;
+    }
+    if (fire)
+        fire(used, budget);
+}
+
+void MemoryBudget::release(Category cat, size_t bytes)
+{
+    boost::mutex::scoped_lock _l(m_mutex);
+    // Clamp rather than underflow; a mismatched release is a bug upstream but
+    // shouldn't turn the ledger into garbage
+    if (bytes > m_used[cat])
+        bytes = m_used[cat];
+    m_used[cat] -= bytes;
+    m_total -= bytes;
+    if (m_pressureSignaled && (!m_softBudget || m_total <= m_softBudget - m_softBudget / 4))
+        m_pressureSignaled = false;
+}
+
+size_t MemoryBudget::bytesUsed() const
+{
+    boost::mutex::scoped_lock _l(m_mutex);
+    return m_total;
+}
+
+size_t MemoryBudget::bytesUsed(Category cat) const
+{
+    boost::mutex::scoped_lock _l(m_mutex);
+    return m_used[cat];
+}
+
+void MemoryBudget::setSoftBudget(size_t bytes)
+{
+    PressureCallback fire;
+    size_t used, budget;
+    {
+        boost::mutex::scoped_lock _l(m_mutex);
+        m_softBudget = bytes;
+        m_pressureSignaled = false;
+        fire = checkPressure();
+        used = m_total;
+        budget = m_softBudget;
+    }
+    if (fire)
+        fire(used, budget);
+}
+
+size_t MemoryBudget::getSoftBudget() const
+{
+    boost::mutex::scoped_lock _l(m_mutex);
+    return m_softBudget;
+}
+
+bool MemoryBudget::isOverBudget() const
+{
+    boost::mutex::scoped_lock _l(m_mutex);
+    return m_softBudget && m_total > m_softBudget;
+}
+
+void MemoryBudget::setPressureCallback(const PressureCallback& cb)
+{
+    boost::mutex::scoped_lock _l(m_mutex);
+    m_callback = cb;
+}
+
+MemoryBudget::PressureCallback MemoryBudget::checkPressure()
+{
+    // m_mutex held by the caller
+    if (!m_softBudget || m_total <= m_softBudget || m_pressureSignaled)
+        return PressureCallback();
+    m_pressureSignaled = true;
+    return m_callback;
+}
+
@@ -0,0 +1,138 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_MEMORYBUDGET
+#define H_FB_MEMORYBUDGET
+
+#include <cstddef>
+#include <boost/function.hpp>
+#include <boost/thread/mutex.hpp>
+#include "APITypes.h"
+
+namespace FB {
+
+    FB_FORWARD_PTR(MemoryBudget);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  MemoryBudget
+    ///
+    /// @brief  Per-plugin-instance ledger of framework-managed memory with a soft budget
+    ///
+    /// Each PluginCore instance owns one of these (see PluginCore::getMemoryBudget()).  Framework
+    /// sites and the plugin itself charge() bytes against a category when they take memory on the
+    /// instance's behalf and release() them when done; streams created for the instance can be
+    /// pointed at the budget with BrowserStream::attachMemoryBudget() so their unconsumed backlog
+    /// is charged automatically.  When the total crosses the configured soft budget the pressure
+    /// callback fires (once, re-armed after usage drains back down), giving the plugin a chance
+    /// to shed caches -- typically the same work its suspend() handler does -- before the browser
+    /// resorts to killing the process.  The budget is soft: charge() never fails or blocks.
+    ///
+    /// @since 1.7
+    /// @see FB::PluginCore::getMemoryBudget
+    /// @see FB::PluginCore::onMemoryPressure
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class MemoryBudget
+    {
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @enum   Category
+        ///
+        /// @brief  What kind of memory a charge is for; purely informational, the budget applies
+        ///         to the total
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        enum Category {
+            Category_StreamBuffers = 0, ///< stream backlog and internal stream buffers
+            Category_Caches,            ///< plugin-managed caches (images, parsed data, ...)
+            Category_AsyncQueue,        ///< queued cross-thread work charged by the embedder
+            Category_Other,             ///< anything else the plugin wants counted
+            Category_Count
+        };
+
+        /// Called with (bytes in use, soft budget) when usage first exceeds the budget
+        typedef boost::function<void (size_t, size_t)> PressureCallback;
+
+        MemoryBudget();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void charge(Category cat, size_t bytes)
+        ///
+        /// @brief  Adds bytes to the ledger; fires the pressure callback if this charge pushes
+        ///         the total over the soft budget
+        ///
+        /// The callback runs synchronously on the charging thread, outside the ledger lock.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void charge(Category cat, size_t bytes);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void release(Category cat, size_t bytes)
+        ///
+        /// @brief  Removes bytes from the ledger; must pair with an earlier charge()
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void release(Category cat, size_t bytes);
+
+        /// Total bytes currently charged across all categories
+        size_t bytesUsed() const;
+        /// Bytes currently charged to one category
+        size_t bytesUsed(Category cat) const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setSoftBudget(size_t bytes)
+        ///
+        /// @brief  Sets the soft budget in bytes; 0 (the default) means unlimited
+        ///
+        /// If usage is already over the new budget the pressure callback fires from here.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setSoftBudget(size_t bytes);
+        size_t getSoftBudget() const;
+
+        /// True while usage exceeds a nonzero soft budget
+        bool isOverBudget() const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setPressureCallback(const PressureCallback& cb)
+        ///
+        /// @brief  Sets the callback fired when usage crosses the soft budget
+        ///
+        /// PluginCore installs one that forwards to PluginCore::onMemoryPressure(); replace it
+        /// only if the budget is used outside a PluginCore instance.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setPressureCallback(const PressureCallback& cb);
+
+    private:
+        // Returns the callback to invoke (empty if the threshold wasn't crossed); the
+        // caller fires it after dropping the lock
+        PressureCallback checkPressure();
+
+        mutable boost::mutex m_mutex;
+        size_t m_used[Category_Count];
+        size_t m_total;
+        size_t m_softBudget;
+        // One warning per excursion over the budget; re-armed once usage drains to
+        // three quarters of the budget so we don't fire on every charge at the boundary
+        bool m_pressureSignaled;
+        PressureCallback m_callback;
+    };
+}
+
+#endif // H_FB_MEMORYBUDGET
+
@@ -12,13 +12,23 @@ License:    Dual license model; choose one of two:
 Copyright 2009 PacketPass, Inc and the Firebreath development team
 \**********************************************************/
 
+#include <boost/thread/once.hpp>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
 #include "PluginWindow.h"
+#include "MemoryBudget.h"
 #include "JSAPI.h"
+#include "PluginInfo.h"
 #include "variant_list.h"
 #include "FactoryBase.h"
 #include "BrowserHost.h"
 #include "DOM/Window.h"
 #include "logging.h"
+#include "StartupTimer.h"
+#include "SystemProxyDetector.h"
+#include "Timer.h"
+#include "TimerService.h"
+#include "IdleScheduler.h"
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
 #include "PluginCore.h"
@@ -44,10 +54,31 @@ void PluginCore::setPlatform(const std::string& opsys, const std::string& browse
      Regular Class Stuff
 \***************************/
 
+namespace {
+    boost::once_flag process_init_flag = BOOST_ONCE_INIT;
+
+    // Once-per-process, immutable setup: logging and the plugin metadata parsed
+    // from the mimetype string.  Pages embedding many instances of the plugin
+    // pay for this exactly once; everything else in the constructor is trivial.
+    void initProcessWide()
+    {
+        FB::Log::initLogging();
+        FB::preloadPluginMetadata();
+    }
+}
+
 PluginCore::PluginCore() : m_paramsSet(false), m_Window(NULL),
-    m_windowLessParam(boost::indeterminate), m_scriptingOnly(false)
+    m_windowLessParam(boost::indeterminate), m_scriptingOnly(false),
+    m_suspended(false), m_timerNamespace(0)
 {
-    FB::Log::initLogging();
+    boost::call_once(&initProcessWide, process_init_flag);
+    FB::StartupTimer::mark("first PluginCore constructed");
+    m_memBudget = boost::make_shared<MemoryBudget>();
+    m_memBudget->setPressureCallback(boost::bind(&PluginCore::onMemoryPressure, this, _1, _2));
+    // Instances count as visible until suspend() parks them; the scheduler uses
+    // this to decide how aggressively quiet-period trimming may run
+    m_idleScheduler = IdleScheduler::instance();
+    m_idleScheduler->noteVisible(true);
     // This class is only created on the main UI thread,
     // so there is no need for mutexes here
     ++PluginCore::ActivePluginCount;
@@ -60,6 +91,19 @@ PluginCore::~PluginCore()
         m_host->shutdown();
     }
 
+    // Streams may keep the budget alive past this destructor; make sure it can
+    // no longer call back into the dying instance
+    m_memBudget->setPressureCallback(MemoryBudget::PressureCallback());
+
+    // The TimerService is shared by every instance in the process; sweep out
+    // whatever this instance still has pending in it
+    if (m_timerService)
+        m_timerService->destroyNamespace(m_timerNamespace);
+
+    // A suspended instance already reported itself hidden
+    if (!m_suspended)
+        m_idleScheduler->noteVisible(false);
+
     // This class is only destroyed on the main UI thread,
     // so there is no need for mutexes here
     --PluginCore::ActivePluginCount;
@@ -112,6 +156,7 @@ bool PluginCore::setReady()
 {
     bool rval = false;
     FBLOG_TRACE("PluginCore", "Plugin Ready");
+    FB::StartupTimer::mark("first setReady");
     try {
         FB::VariantMap::iterator fnd = m_params.find("onload");
         if (fnd != m_params.end()) {
@@ -126,6 +171,13 @@ bool PluginCore::setReady()
     } catch(...) {
         // Usually this would be if it isn't a JSObjectPtr or the object can't be called
     }
+    try {
+        // Warm the per-origin proxy-decision cache in the background so the first
+        // real request never waits on PAC evaluation
+        FB::SystemProxyDetector::get()->warmup(m_host->getDOMWindow()->getLocation());
+    } catch(...) {
+        // No DOM window (or no location) yet; the cache just warms on first use
+    }
     onPluginReady();
     return rval;
 }
@@ -150,22 +202,94 @@ bool PluginCore::isWindowless()
 void FB::PluginCore::SetWindow( PluginWindow *win )
 {
     FBLOG_TRACE("PluginCore", "Window Set");
+    FB::StartupTimer::mark("first SetWindow");
     if (m_Window && m_Window != win) {
         ClearWindow();
     }
     m_Window = win;
     win->AttachObserver(this);
+    resume();
 }
 
 void FB::PluginCore::ClearWindow()
 {
     FBLOG_TRACE("PluginCore", "Window Cleared");
     if (m_Window) {
+        suspend();
         m_Window->DetachObserver(this);
         m_Window = NULL;
     }
 }
 
+void FB::PluginCore::suspend()
+{
+    if (m_suspended)
+        return;
+    m_suspended = true;
+    FBLOG_TRACE("PluginCore", "Plugin suspended");
+    for (std::list<TimerWeakPtr>::iterator it = m_pausableTimers.begin(); it != m_pausableTimers.end();) {
+        TimerPtr timer(it->lock());
+        if (!timer) {
+            it = m_pausableTimers.erase(it);
+            continue;
+        }
+        timer->pause();
+        ++it;
+    }
+    m_idleScheduler->noteVisible(false);
+    onSuspend();
+}
+
+void FB::PluginCore::resume()
+{
+    if (!m_suspended)
+        return;
+    m_suspended = false;
+    FBLOG_TRACE("PluginCore", "Plugin resumed");
+    for (std::list<TimerWeakPtr>::iterator it = m_pausableTimers.begin(); it != m_pausableTimers.end();) {
+        TimerPtr timer(it->lock());
+        if (!timer) {
+            it = m_pausableTimers.erase(it);
+            continue;
+        }
+        timer->resume();
+        ++it;
+    }
+    m_idleScheduler->noteVisible(true);
+    onResume();
+}
+
+boost::uint64_t FB::PluginCore::getTimerNamespace()
+{
+    if (!m_timerNamespace) {
+        m_timerService = TimerService::instance();
+        m_timerNamespace = m_timerService->createNamespace();
+    }
+    return m_timerNamespace;
+}
+
+FB::TimerPtr FB::PluginCore::scheduleTimer(long duration_ms, bool recursive, const boost::function<void (void)>& cb, bool pausable /*= true*/)
+{
+    TimerPtr timer(Timer::getTimer(duration_ms, recursive, cb));
+    timer->setTimerNamespace(getTimerNamespace());
+    timer->start();
+    if (pausable) {
+        m_pausableTimers.push_back(timer);
+        if (m_suspended)
+            timer->pause();     // parked until the instance resumes
+    }
+    return timer;
+}
+
+void FB::PluginCore::registerPausableTimer(const TimerPtr& timer)
+{
+    // adopt the timer into this instance's namespace; takes effect on its next start
+    timer->setTimerNamespace(getTimerNamespace());
+    m_pausableTimers.push_back(timer);
+    if (m_suspended)
+        timer->pause();
+}
+
 std::string FB::PluginCore::negotiateDrawingModel()
 {
     return "";
@@ -22,8 +22,11 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 #include "APITypes.h"
 #include <string>
 #include <set>
+#include <list>
 #include <boost/assign.hpp>
+#include <boost/function.hpp>
 #include <boost/logic/tribool.hpp>
+#include <boost/cstdint.hpp>
 
 using boost::assign::list_of;
 
@@ -35,6 +38,10 @@ namespace FB {
     FB_FORWARD_PTR(PluginCore);
     FB_FORWARD_PTR(JSAPI);
     FB_FORWARD_PTR(BrowserHost);
+    FB_FORWARD_PTR(Timer);
+    FB_FORWARD_PTR(TimerService);
+    FB_FORWARD_PTR(MemoryBudget);
+    FB_FORWARD_PTR(IdleScheduler);
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @class  PluginCore
@@ -221,7 +228,138 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual void shutdown() {};
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void PluginCore::suspend()
+        ///
+        /// @brief  Parks the instance while it is not visible
+        ///
+        /// Called automatically from ClearWindow() when the browser takes the window away (hidden
+        /// or backgrounded tab); plugins that learn about visibility some other way (for example
+        /// from a FocusChangedEvent on a windowless instance) may also call it directly.  All
+        /// timers registered through scheduleTimer()/registerPausableTimer() are paused, then
+        /// onSuspend() is called so the plugin can drop caches, shrink stream buffers and defer
+        /// any non-urgent background work of its own.  Calling it on a suspended instance is a
+        /// no-op.
+        ///
+        /// @since 1.7
+        /// @see resume
+        /// @see scheduleTimer
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void suspend();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void PluginCore::resume()
+        ///
+        /// @brief  Brings a suspended instance back; restarts paused timers and calls onResume()
+        ///
+        /// Called automatically from SetWindow() when the browser hands the window back.
+        ///
+        /// @since 1.7
+        /// @see suspend
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void resume();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool PluginCore::isSuspended() const
+        ///
+        /// @brief  Returns true while the instance is suspended
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool isSuspended() const { return m_suspended; }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn TimerPtr PluginCore::scheduleTimer(long duration_ms, bool recursive, const boost::function<void (void)>& cb, bool pausable = true)
+        ///
+        /// @brief  Creates and starts a Timer owned by this plugin instance
+        ///
+        /// Pausable timers (the default) stop firing while the instance is suspended and restart
+        /// when it resumes; pass pausable = false for work that must keep running in a hidden
+        /// tab.  The returned TimerPtr must be held by the caller; the instance only keeps a
+        /// weak reference.
+        ///
+        /// @since 1.7
+        /// @see suspend
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        TimerPtr scheduleTimer(long duration_ms, bool recursive, const boost::function<void (void)>& cb, bool pausable = true);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void PluginCore::registerPausableTimer(const TimerPtr& timer)
+        ///
+        /// @brief  Adds an externally created Timer to the set paused on suspend()
+        ///
+        /// The timer is also adopted into this instance's TimerService namespace so
+        /// it is swept out with the rest when the instance is destroyed.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void registerPausableTimer(const TimerPtr& timer);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn boost::uint64_t PluginCore::getTimerNamespace()
+        ///
+        /// @brief  This instance's namespace in the process-wide TimerService
+        ///
+        /// All instances share one TimerService -- one wheel, one wakeup stream --
+        /// so per-instance cleanup goes through namespaces: anything scheduled under
+        /// this tag is cancelled in one sweep when the instance is destroyed.
+        /// Allocated lazily on first use.  Plugins scheduling raw timeouts directly
+        /// against the service should pass this tag.
+        ///
+        /// @since 1.7
+        /// @see TimerService::destroyNamespace
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        boost::uint64_t getTimerNamespace();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn MemoryBudgetPtr PluginCore::getMemoryBudget() const
+        ///
+        /// @brief  Returns this instance's memory ledger
+        ///
+        /// Set a soft budget on it and charge framework-managed memory (stream backlog via
+        /// BrowserStream::attachMemoryBudget(), plugin caches by hand) against it; when usage
+        /// crosses the budget onMemoryPressure() is called so the plugin can shed caches
+        /// before the browser kills the process.
+        ///
+        /// @since 1.7
+        /// @see FB::MemoryBudget
+        /// @see onMemoryPressure
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        MemoryBudgetPtr getMemoryBudget() const { return m_memBudget; }
+
     protected:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void PluginCore::onMemoryPressure(size_t bytesUsed, size_t softBudget)
+        ///
+        /// @brief  Called when the instance's memory use crosses its soft budget; override to
+        ///         drop caches and shrink buffers
+        ///
+        /// Fires once per excursion over the budget, on whichever thread made the charge that
+        /// crossed it.  The parking work in onSuspend() is usually a good starting point for
+        /// what to shed here.
+        ///
+        /// @since 1.7
+        /// @see getMemoryBudget
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void onMemoryPressure(size_t bytesUsed, size_t softBudget) {};
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void PluginCore::onSuspend()
+        ///
+        /// @brief  Called after the instance has been suspended; override to park plugin resources
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void onSuspend() {};
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void PluginCore::onResume()
+        ///
+        /// @brief  Called after the instance has been resumed; override to restore plugin resources
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void onResume() {};
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual JSAPIPtr PluginCore::createJSAPI() = 0
@@ -366,6 +504,23 @@ namespace FB {
         JSAPIPtr m_api;
         boost::tribool m_windowLessParam;
         bool m_scriptingOnly;
+        /// True while the instance is parked; see suspend().  Like the rest of the
+        /// lifecycle this is only ever touched on the main thread
+        bool m_suspended;
+        /// Weak refs to the timers paused on suspend(); expired entries are pruned as found
+        std::list<TimerWeakPtr> m_pausableTimers;
+        /// The process-wide TimerService, pinned once this instance owns timers in it
+        TimerServicePtr m_timerService;
+        /// This instance's namespace in the shared TimerService; everything still
+        /// pending under it is cancelled in one sweep by the destructor.  0 until
+        /// the first timer is handed out
+        boost::uint64_t m_timerNamespace;
+        /// Per-instance memory ledger; see getMemoryBudget().  Streams may hold references
+        /// past our destructor, so the destructor detaches the pressure callback
+        MemoryBudgetPtr m_memBudget;
+        /// The process-wide idle trim scheduler, pinned for this instance's lifetime; we
+        /// feed it visibility so framework caches get trimmed during quiet periods
+        IdleSchedulerPtr m_idleScheduler;
     };
 };
 
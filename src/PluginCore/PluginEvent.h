@@ -21,13 +21,33 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 #include <stdexcept>
 #include <boost/cast.hpp>
 #include "APITypes.h"
+#include "AllocTracker.h"
 
 namespace FB {
 
+    class PluginEvent;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @struct PluginEventIdTraits
+    ///
+    /// @brief  Marks event types that report their type through PluginEvent::isEventId
+    ///
+    /// Event types registered with PLUGINEVENT_TYPEID / PLUGINEVENT_TYPEID_TRAIT answer
+    /// validType() with a couple of pointer comparisons instead of a dynamic_cast; with
+    /// an event map tried against every event (think mouse move volume) the failed
+    /// dynamic_casts dominate.  Unregistered (e.g. third party) event types keep the
+    /// original dynamic_cast behavior, so nothing changes for them.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<class T>
+    struct PluginEventIdTraits
+    {
+        enum { isRegistered = 0 };
+    };
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @class  PluginEvent
     ///
-    /// @brief  Plugin event base class. 
+    /// @brief  Plugin event base class.
     ///
     /// This is the base class for all system (non-js) events that are used in the plugin.  Most of
     /// these come from the PluginWindow, but BrowserStream uses these as well, and in the future other
@@ -35,10 +55,37 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class PluginEvent
     {
+    public:
+        /// Cheap per-type event id; the same type always yields the same id and no two
+        /// event types share one
+        typedef const void* EventId;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn template<class T> static EventId PluginEvent::eventId()
+        ///
+        /// @brief  Returns the type id for event type T without consulting RTTI
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        template<class T>
+        static EventId eventId()
+        {
+            static const char tag = 0;
+            return &tag;
+        }
+
     public:
         PluginEvent() { };
         virtual ~PluginEvent() { };
 
+        // All events allocate through here so tracking builds can tally them per subsystem
+        static void* operator new(std::size_t size) {
+            FB::AllocTracker::recordAlloc(FB::AllocTracker::Subsystem_PluginEvent, size);
+            return ::operator new(size);
+        }
+        static void operator delete(void* ptr, std::size_t size) {
+            FB::AllocTracker::recordFree(FB::AllocTracker::Subsystem_PluginEvent, size);
+            ::operator delete(ptr);
+        }
+
     public:
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -46,19 +93,21 @@ namespace FB {
         ///
         /// @brief  Dynamic cast the pluginEvent to the specified type and throw an exception if it is not
         ///         a subtype of the specified type
-        ///         
+        ///
         /// @code
         ///      AttachedEvent *atevt = evt->get<AttachedEvent>();
         /// @endcode
         ///
-        /// @exception  std::bad_cast   Thrown when invalid argument. 
+        /// @exception  std::bad_cast   Thrown when invalid argument.
         ///
-        /// @return T* 
+        /// @return T*
         /// @since 1.4
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         template<class T>
         T* get()
         {
+            if (PluginEventIdTraits<T>::isRegistered && isEventId(eventId<T>()))
+                return static_cast<T*>(this);
             return boost::polymorphic_cast<T*>(this);
         }
 
@@ -67,16 +116,63 @@ namespace FB {
         ///
         /// @brief  Returns true if the object can be cast to the specified type
         ///
-        /// @return true if the type is valid, false if not 
+        /// For types registered with PLUGINEVENT_TYPEID this is a virtual call and a few
+        /// pointer comparisons; other types fall back to dynamic_cast as before.
+        ///
+        /// @return true if the type is valid, false if not
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         template<class T>
         bool validType()
         {
+            if (PluginEventIdTraits<T>::isRegistered)
+                return isEventId(eventId<T>());
             T* out(dynamic_cast<T*>(this));
             return out != NULL;
         }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual bool PluginEvent::isEventId(EventId id) const
+        ///
+        /// @brief  Returns true if id names this event's type or one of its bases
+        ///
+        /// Each event class overrides this with PLUGINEVENT_TYPEID, which chains to the
+        /// base class so the whole ancestry answers.  A subclass that does not override
+        /// it still reports every registered ancestor correctly; queries for its own
+        /// (unregistered) type go through the dynamic_cast path in validType().
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual bool isEventId(EventId id) const
+        {
+            return id == eventId<PluginEvent>();
+        }
     };
+
+    template<> struct PluginEventIdTraits<PluginEvent> { enum { isRegistered = 1 }; };
 };
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @def    PLUGINEVENT_TYPEID(eventType, baseType)
+///
+/// @brief  Declares the type id chain for an event class; place it at the top of the class body
+///         and pair it with PLUGINEVENT_TYPEID_TRAIT at namespace scope
+///
+/// @see PLUGINEVENT_TYPEID_TRAIT
+/// @see FB::PluginEvent::validType
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#define PLUGINEVENT_TYPEID(eventType, baseType) \
+    public: \
+        virtual bool isEventId(FB::PluginEvent::EventId id) const \
+        { return id == FB::PluginEvent::eventId< eventType >() || baseType::isEventId(id); }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @def    PLUGINEVENT_TYPEID_TRAIT(eventType)
+///
+/// @brief  Lets FB::PluginEvent::validType answer for eventType by id comparison instead of
+///         dynamic_cast; must appear inside namespace FB after the class definition
+///
+/// @see PLUGINEVENT_TYPEID
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#define PLUGINEVENT_TYPEID_TRAIT(eventType) \
+    template<> struct PluginEventIdTraits< eventType > { enum { isRegistered = 1 }; };
+
 #endif
 
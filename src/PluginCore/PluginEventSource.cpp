@@ -13,6 +13,7 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 \**********************************************************/
 
 #include <algorithm>
+#include <boost/make_shared.hpp>
 #include "PluginEvent.h"
 #include "PluginEventSink.h"
 #include "PluginEventSource.h"
@@ -22,6 +23,7 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 using namespace FB;
 
 PluginEventSource::PluginEventSource()
+    : m_observers(boost::make_shared<ObserverList>())
 {
 }
 
@@ -37,7 +39,9 @@ void PluginEventSource::AttachObserver(FB::PluginEventSink *sink)
 void PluginEventSource::AttachObserver( PluginEventSinkPtr sink )
 {
     boost::recursive_mutex::scoped_lock _l(m_observerLock);
-    m_observers.push_back(sink);
+    ObserverListPtr observers(boost::make_shared<ObserverList>(*m_observers));
+    observers->push_back(sink);
+    publishObservers(observers);
     AttachedEvent newEvent;
     sink->HandleEvent(&newEvent, this);
 }
@@ -49,46 +53,47 @@ void PluginEventSource::DetachObserver(FB::PluginEventSink *sink)
 
 void PluginEventSource::DetachObserver( PluginEventSinkPtr sink )
 {
-    boost::recursive_mutex::scoped_lock _l(m_observerLock);
-	
-	std::list<PluginEventSinkPtr> detachedList;
-	{
-		std::list<PluginEventSinkWeakPtr>::iterator end = m_observers.end();
-		for (std::list<PluginEventSinkWeakPtr>::iterator it = m_observers.begin(); it != end; ) {
-			PluginEventSinkPtr ptr(it->lock());
-			if (!ptr || sink == ptr) {
-				it = m_observers.erase(it);
-				if (ptr)
-					detachedList.push_back(ptr);
-			} else {
-				++it;
-			}
-		}
-	}
-	
-	std::list<PluginEventSinkPtr>::iterator end = detachedList.end();
-	DetachedEvent evt;
-	for (std::list<PluginEventSinkPtr>::iterator it = detachedList.begin(); it != end; ++it) {
-		(*it)->HandleEvent(&evt, this);
-	}
+    std::vector<PluginEventSinkPtr> detachedList;
+    {
+        boost::recursive_mutex::scoped_lock _l(m_observerLock);
+        ObserverListPtr observers(boost::make_shared<ObserverList>());
+        observers->reserve(m_observers->size());
+        ObserverList::const_iterator end = m_observers->end();
+        for (ObserverList::const_iterator it = m_observers->begin(); it != end; ++it) {
+            PluginEventSinkPtr ptr(it->lock());
+            if (!ptr || sink == ptr) {
+                if (ptr)
+                    detachedList.push_back(ptr);
+            } else {
+                observers->push_back(*it);
+            }
+        }
+        publishObservers(observers);
+    }
+
+    std::vector<PluginEventSinkPtr>::iterator end = detachedList.end();
+    DetachedEvent evt;
+    for (std::vector<PluginEventSinkPtr>::iterator it = detachedList.begin(); it != end; ++it) {
+        (*it)->HandleEvent(&evt, this);
+    }
 }
 
 bool PluginEventSource::SendEvent(PluginEvent* evt)
 {
-    boost::recursive_mutex::scoped_lock _l(m_observerLock);
-
-    // Sometimes the events cause an observer to be removed; we make a copy so that 
-    // it doesn't mess with our iterator.  Remember that removing an observer will only take
-    // affect on the next SendEvent call
-    ObserverMap copy(m_observers);
-    ObserverMap::iterator it = copy.begin();
+    // Events can cause an observer to attach or detach; the snapshot keeps our
+    // iteration stable without taking any lock or copying anything.  As always, a
+    // removal only takes effect on the next SendEvent call.  High-frequency events
+    // (mouse move, refresh) come through here for every message, so this path must
+    // not touch the heap or serialize against attach/detach
+    ObserverListConstPtr observers(observerSnapshot());
 
-    while (it != copy.end()) {
+    ObserverList::const_iterator it = observers->begin();
+    ObserverList::const_iterator end = observers->end();
+    for (; it != end; ++it) {
         PluginEventSinkPtr tmp = it->lock();
         if (tmp && tmp->HandleEvent(evt, this)) {
             return true;    // Tell the caller that the event was handled
         }
-        ++it;
     }
     return false;
 }
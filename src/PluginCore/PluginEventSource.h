@@ -16,10 +16,11 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 #ifndef H_FB_PLUGINEVENTSOURCE
 #define H_FB_PLUGINEVENTSOURCE
 
-#include <list>
+#include <vector>
 #include <typeinfo>
 #include "APITypes.h"
 #include <boost/enable_shared_from_this.hpp>
+#include <boost/shared_ptr.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/noncopyable.hpp>
 
@@ -115,13 +116,41 @@ namespace FB {
     protected:
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
-        /// @typedef    std::vector<PluginEventSink*> ObserverMap
+        /// @typedef    std::vector<PluginEventSinkWeakPtr> ObserverList
         ///
-        /// @brief  Defines an alias representing the observer .
+        /// @brief  Defines an alias representing the observer list.
         ////////////////////////////////////////////////////////////////////////////////////////////////////
-        typedef std::list<PluginEventSinkWeakPtr> ObserverMap; 
-        ObserverMap m_observers; /// List of attached observers
-        boost::recursive_mutex m_observerLock;
+        typedef std::vector<PluginEventSinkWeakPtr> ObserverList;
+        typedef boost::shared_ptr<const ObserverList> ObserverListConstPtr;
+        typedef boost::shared_ptr<ObserverList> ObserverListPtr;
+
+        // Returns the current observer snapshot without taking m_observerLock; hold the
+        // returned pointer while iterating, it stays valid even if the list changes
+        ObserverListConstPtr observerSnapshot() const
+        {
+#ifndef BOOST_SP_NO_ATOMIC_ACCESS
+            return boost::atomic_load(&m_observers);
+#else
+            boost::recursive_mutex::scoped_lock _l(m_observerLock);
+            return m_observers;
+#endif
+        }
+
+        // Atomically publishes a new observer list; call under m_observerLock
+        void publishObservers(const ObserverListPtr& observers)
+        {
+#ifndef BOOST_SP_NO_ATOMIC_ACCESS
+            boost::atomic_store(&m_observers, ObserverListConstPtr(observers));
+#else
+            m_observers = observers;
+#endif
+        }
+
+        // Immutable snapshot of the attached observers, swapped atomically by
+        // Attach/DetachObserver so SendEvent iterates with no locking or copying.
+        // As before, a detach takes effect on the next SendEvent call
+        ObserverListConstPtr m_observers;
+        mutable boost::recursive_mutex m_observerLock;  // serializes attach/detach
     };
 };
 
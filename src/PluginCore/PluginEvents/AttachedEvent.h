@@ -28,6 +28,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class AttachedEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(AttachedEvent, PluginEvent)
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -38,6 +39,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class DetachedEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(DetachedEvent, PluginEvent)
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -49,7 +51,12 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class ChangedEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(ChangedEvent, PluginEvent)
     };
+
+    PLUGINEVENT_TYPEID_TRAIT(AttachedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(DetachedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(ChangedEvent)
 };
 
 #endif
@@ -35,6 +35,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class ResizedEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(ResizedEvent, PluginEvent)
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -44,6 +45,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class ClipChangedEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(ClipChangedEvent, PluginEvent)
     };
 
     ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -54,6 +56,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class RefreshEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(RefreshEvent, PluginEvent)
 	public:
         RefreshEvent() { }
 
@@ -71,6 +74,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class QuickDrawDraw : public RefreshEvent
     {
+        PLUGINEVENT_TYPEID(QuickDrawDraw, RefreshEvent)
     public:
         QuickDrawDraw(CGrafPtr port, const FB::Rect& bounds, const FB::Rect& clip) 
             : RefreshEvent(bounds), port(port), clip(clip) {}
@@ -87,6 +91,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class CoreGraphicsDraw : public RefreshEvent
     {
+        PLUGINEVENT_TYPEID(CoreGraphicsDraw, RefreshEvent)
     public:
         CoreGraphicsDraw(CGContextRef context, const FB::Rect& bounds, const FB::Rect& clip) 
             : RefreshEvent(bounds), context(context), clip(clip) {}
@@ -102,6 +107,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class FocusChangedEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(FocusChangedEvent, PluginEvent)
         public:
             FocusChangedEvent(bool hasFocus) : m_hasFocus(hasFocus) { }
             virtual ~FocusChangedEvent() { }
@@ -119,6 +125,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class ContentsScaleFactorChangedEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(ContentsScaleFactorChangedEvent, PluginEvent)
         public:
             ContentsScaleFactorChangedEvent(double contentsScaleFactor)
                 : m_contentsScaleFactor(contentsScaleFactor) {}
@@ -129,6 +136,13 @@ namespace FB {
             double m_contentsScaleFactor;
     };
 
+    PLUGINEVENT_TYPEID_TRAIT(ResizedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(ClipChangedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(RefreshEvent)
+    PLUGINEVENT_TYPEID_TRAIT(QuickDrawDraw)
+    PLUGINEVENT_TYPEID_TRAIT(CoreGraphicsDraw)
+    PLUGINEVENT_TYPEID_TRAIT(FocusChangedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(ContentsScaleFactorChangedEvent)
 };
 
 #endif // H_FB_PLUGINEVENTS_DRAWINGEVENTS
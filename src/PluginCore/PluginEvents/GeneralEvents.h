@@ -28,6 +28,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class TimerEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(TimerEvent, PluginEvent)
     public:
         TimerEvent(uint32_t timer_id, void *opaquePointer)
             : timerId(timer_id), opaquePointer(opaquePointer)
@@ -37,6 +38,8 @@ namespace FB {
         uint32_t timerId;   // The ID of the timer
         void *opaquePointer;    // The opaque pointer associated with the timer
     };
+
+    PLUGINEVENT_TYPEID_TRAIT(TimerEvent)
 };
 
 #endif
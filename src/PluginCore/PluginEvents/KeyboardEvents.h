@@ -28,6 +28,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class KeyEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(KeyEvent, PluginEvent)
     public:
         KeyEvent(FBKeyCode fb_key, uint32_t os_key, uint32_t modifiers = 0)
             :
@@ -47,6 +48,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class KeyUpEvent : public KeyEvent
     {
+        PLUGINEVENT_TYPEID(KeyUpEvent, KeyEvent)
     public:
         KeyUpEvent(FBKeyCode fb_key, uint32_t os_key, uint32_t modifiers = 0)
             : KeyEvent(fb_key, os_key, modifiers) {}
@@ -59,6 +61,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class KeyDownEvent : public KeyEvent
     {
+        PLUGINEVENT_TYPEID(KeyDownEvent, KeyEvent)
     public:
         KeyDownEvent(FBKeyCode fb_key, uint32_t os_key, uint32_t modifiers = 0)
             : KeyEvent(fb_key, os_key, modifiers) {}
@@ -71,14 +74,18 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class TextEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(TextEvent, PluginEvent)
     public:
         TextEvent(const std::string& text) : text(text) {}
         
     public:
         std::string text;
     };
-    
-    
+
+    PLUGINEVENT_TYPEID_TRAIT(KeyEvent)
+    PLUGINEVENT_TYPEID_TRAIT(KeyUpEvent)
+    PLUGINEVENT_TYPEID_TRAIT(KeyDownEvent)
+    PLUGINEVENT_TYPEID_TRAIT(TextEvent)
 };
 
 #endif // H_FB_PLUGINEVENTS_KEYBOARDEVENTS
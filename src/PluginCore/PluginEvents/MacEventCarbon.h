@@ -36,6 +36,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MacEventCarbon : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(MacEventCarbon, PluginEvent)
     public:
         MacEventCarbon(EventRecord *src)
         {
@@ -46,6 +47,8 @@ namespace FB {
         EventRecord msg;
         NPCocoaEvent msgCocoa;
     };
+
+    PLUGINEVENT_TYPEID_TRAIT(MacEventCarbon)
 };
 
 #endif
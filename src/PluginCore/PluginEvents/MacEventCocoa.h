@@ -36,6 +36,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MacEventCocoa : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(MacEventCocoa, PluginEvent)
     public:
         MacEventCocoa(NPCocoaEvent* src)
         {
@@ -46,6 +47,7 @@ namespace FB {
         NPCocoaEvent msg;
     };
 
+    PLUGINEVENT_TYPEID_TRAIT(MacEventCocoa)
 };
 
 #endif
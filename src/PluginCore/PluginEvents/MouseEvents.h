@@ -27,6 +27,7 @@ namespace FB {
 	////////////////////////////////////////////////////////////////////////////////////////////////////
 	class MouseEvent : public PluginEvent
 	{
+		PLUGINEVENT_TYPEID(MouseEvent, PluginEvent)
 	public:
 		enum ModifierState {
 			ModifierState_None    = 0x0,
@@ -49,6 +50,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MouseMoveEvent : public MouseEvent
     {
+        PLUGINEVENT_TYPEID(MouseMoveEvent, MouseEvent)
     public:
         MouseMoveEvent(int x, int y, uint32_t state = ModifierState_None) : MouseEvent(x, y, state) { }
 
@@ -62,6 +64,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MouseButtonEvent : public MouseEvent
     {
+        PLUGINEVENT_TYPEID(MouseButtonEvent, MouseEvent)
     public:
         enum MouseButton {
             MouseButton_Left,
@@ -82,6 +85,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MouseDownEvent : public MouseButtonEvent
     {
+        PLUGINEVENT_TYPEID(MouseDownEvent, MouseButtonEvent)
     public:
         MouseDownEvent(MouseButton btn, int x, int y, uint32_t state = ModifierState_None) : MouseButtonEvent(btn, x, y, state) { }
     };
@@ -93,6 +97,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MouseDoubleClickEvent : public MouseButtonEvent
     {
+        PLUGINEVENT_TYPEID(MouseDoubleClickEvent, MouseButtonEvent)
     public:
         MouseDoubleClickEvent(MouseButton btn, int x, int y, uint32_t state = ModifierState_None) : MouseButtonEvent(btn, x, y, state) { }
     };
@@ -104,6 +109,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MouseUpEvent : public MouseButtonEvent
     {
+        PLUGINEVENT_TYPEID(MouseUpEvent, MouseButtonEvent)
     public:
         MouseUpEvent(MouseButton btn, int x, int y, uint32_t state = ModifierState_None) : MouseButtonEvent(btn, x, y, state) { }
     };
@@ -115,6 +121,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MouseScrollEvent : public MouseEvent
     {
+        PLUGINEVENT_TYPEID(MouseScrollEvent, MouseEvent)
     public:
         MouseScrollEvent(int x, int y, double dx, double dy, uint32_t state = ModifierState_None) : MouseEvent(x, y, state), m_dx(dx), m_dy(dy) { }
 
@@ -130,6 +137,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MouseEnteredEvent : public MouseMoveEvent
     {
+        PLUGINEVENT_TYPEID(MouseEnteredEvent, MouseMoveEvent)
     public:
         MouseEnteredEvent(int x, int y) : MouseMoveEvent(x,y) { }
     };
@@ -141,9 +149,20 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class MouseExitedEvent : public MouseMoveEvent
     {
+        PLUGINEVENT_TYPEID(MouseExitedEvent, MouseMoveEvent)
     public:
         MouseExitedEvent(int x, int y) : MouseMoveEvent(x,y) { }
     };
+
+    PLUGINEVENT_TYPEID_TRAIT(MouseEvent)
+    PLUGINEVENT_TYPEID_TRAIT(MouseMoveEvent)
+    PLUGINEVENT_TYPEID_TRAIT(MouseButtonEvent)
+    PLUGINEVENT_TYPEID_TRAIT(MouseDownEvent)
+    PLUGINEVENT_TYPEID_TRAIT(MouseDoubleClickEvent)
+    PLUGINEVENT_TYPEID_TRAIT(MouseUpEvent)
+    PLUGINEVENT_TYPEID_TRAIT(MouseScrollEvent)
+    PLUGINEVENT_TYPEID_TRAIT(MouseEnteredEvent)
+    PLUGINEVENT_TYPEID_TRAIT(MouseExitedEvent)
 };
 
 #endif // H_FB_PLUGINEVENTS_MOUSEEVENTS
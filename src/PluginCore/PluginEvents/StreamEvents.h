@@ -17,10 +17,55 @@ Copyright 2010 Richard Bateman, Firebreath development team
 #define H_FB_PLUGINEVENTS_STREAMEVENTS
 
 #include "../PluginEvent.h"
+#include "../StreamChunkPool.h"
+#include <boost/shared_array.hpp>
+#include <cstring>
 
 namespace FB {
     class BrowserStream;
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  StreamDataSlice
+    ///
+    /// @brief  Refcounted view of a block of stream data
+    ///
+    /// Wraps a shared heap block together with the offset and length of the valid bytes inside it.
+    /// Copying a slice only bumps the refcount, so an event handler can keep arrived data alive
+    /// after StreamDataArrivedEvent returns without the framework copying the bytes first.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class StreamDataSlice
+    {
+    public:
+        StreamDataSlice() : offset(0), length(0)
+        {}
+        StreamDataSlice( const boost::shared_array<char>& Buffer, const size_t Offset, const size_t Length )
+            : buffer(Buffer), offset(Offset), length(Length)
+        {}
+
+        /// read-only pointer to the first valid byte
+        const char* data() const
+        {
+            return buffer.get() + offset;
+        }
+
+        /// number of valid bytes
+        size_t size() const
+        {
+            return length;
+        }
+
+        /// true if the slice references no block
+        bool empty() const
+        {
+            return !buffer;
+        }
+
+    protected:
+        boost::shared_array<char> buffer;   // shared ownership of the underlying block
+        size_t offset;                      // offset of the first valid byte within the block
+        size_t length;                      // number of valid bytes
+    };
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @class  StreamEvent
     ///
@@ -30,6 +75,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class StreamEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(StreamEvent, PluginEvent)
     public:
         StreamEvent(BrowserStream* Stream) : stream(Stream)
         {}
@@ -47,6 +93,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class StreamCreatedEvent : public StreamEvent
     {
+        PLUGINEVENT_TYPEID(StreamCreatedEvent, StreamEvent)
     public:
         StreamCreatedEvent(BrowserStream* stream) : StreamEvent(stream)
         {}
@@ -61,6 +108,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class StreamDestroyedEvent : public StreamEvent
     {
+        PLUGINEVENT_TYPEID(StreamDestroyedEvent, StreamEvent)
     public:
         StreamDestroyedEvent(BrowserStream* stream) : StreamEvent(stream)
         {}
@@ -75,10 +123,14 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class StreamDataArrivedEvent : public StreamEvent
     {
+        PLUGINEVENT_TYPEID(StreamDataArrivedEvent, StreamEvent)
     public:
         StreamDataArrivedEvent( BrowserStream* stream, const void* Data, const size_t Length, const size_t DataPosition, const float Progress ) : StreamEvent(stream), data(Data), length(Length), dataPosition(DataPosition), progress(Progress)
         {}
 
+        StreamDataArrivedEvent( BrowserStream* stream, const StreamDataSlice& Slice, const size_t DataPosition, const float Progress ) : StreamEvent(stream), slice(Slice), data(Slice.data()), length(Slice.size()), dataPosition(DataPosition), progress(Progress)
+        {}
+
         /// read-only pointer to the data
         const void* getData() const
         {
@@ -102,7 +154,22 @@ namespace FB {
         {
             return progress;
         }
+
+        /// Refcounted slice of the arrived data; copying it keeps the bytes alive after the
+        /// handler returns.  When the sender handed over a block it already owned this costs
+        /// nothing; when the event points into a transient browser buffer the bytes are
+        /// copied here, once, on the first call.
+        const StreamDataSlice& getSlice() const
+        {
+            if (slice.empty() && length) {
+                boost::shared_array<char> copy(StreamChunkPool::allocate(length));
+                memcpy(copy.get(), data, length);
+                slice = StreamDataSlice(copy, 0, length);
+            }
+            return slice;
+        }
     protected:
+        mutable StreamDataSlice slice;  // set when the sender owns the block; filled lazily otherwise
         const void*     data;           // the data
         const size_t    length;         // length of the data in bytes
         const size_t    dataPosition;   // the position in the stream where the data starts (e.g. 0 if the data starts at the beginning)
@@ -119,6 +186,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class StreamFailedOpenEvent : public StreamEvent
     {
+        PLUGINEVENT_TYPEID(StreamFailedOpenEvent, StreamEvent)
     public:
         StreamFailedOpenEvent(BrowserStream* stream) : StreamEvent(stream)
         {}
@@ -133,6 +201,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class StreamOpenedEvent : public StreamEvent
     {
+        PLUGINEVENT_TYPEID(StreamOpenedEvent, StreamEvent)
     public:
         StreamOpenedEvent(BrowserStream* stream) : StreamEvent(stream)
         {}
@@ -147,6 +216,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class StreamCompletedEvent : public StreamEvent
     {
+        PLUGINEVENT_TYPEID(StreamCompletedEvent, StreamEvent)
     public:
         StreamCompletedEvent(BrowserStream* stream, bool Success) : StreamEvent(stream), success(Success)
         {}
@@ -154,6 +224,14 @@ namespace FB {
     public:
         bool success;
     };
+
+    PLUGINEVENT_TYPEID_TRAIT(StreamEvent)
+    PLUGINEVENT_TYPEID_TRAIT(StreamCreatedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(StreamDestroyedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(StreamDataArrivedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(StreamFailedOpenEvent)
+    PLUGINEVENT_TYPEID_TRAIT(StreamOpenedEvent)
+    PLUGINEVENT_TYPEID_TRAIT(StreamCompletedEvent)
 };
 
 #endif // H_FB_PLUGINEVENTS_STREAMEVENTS
@@ -35,6 +35,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class WindowsEvent : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(WindowsEvent, PluginEvent)
     public:
         WindowsEvent(HWND hWnd, uint32_t msg, uint32_t wparam, long lparam, LRESULT & lres)
             : hWnd(hWnd), uMsg(msg), wParam(wparam), lParam(lparam), lRes(lres)
@@ -47,6 +48,8 @@ namespace FB {
         long lParam;
         LRESULT & lRes;
     };
+
+    PLUGINEVENT_TYPEID_TRAIT(WindowsEvent)
 };
 
 #endif
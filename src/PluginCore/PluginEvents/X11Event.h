@@ -31,6 +31,7 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class X11Event : public PluginEvent
     {
+        PLUGINEVENT_TYPEID(X11Event, PluginEvent)
     public:
         X11Event(GtkWidget *widget, GdkEvent *event) : m_widget(widget), m_event(event)
         {
@@ -40,6 +41,8 @@ namespace FB {
         GtkWidget *m_widget;
         GdkEvent *m_event;
     };
+
+    PLUGINEVENT_TYPEID_TRAIT(X11Event)
 };
 
 #endif
@@ -23,6 +23,16 @@ namespace FB
     std::string getPluginName(const std::string& mimetype);
     std::string getPluginDescription(const std::string& mimetype);
     bool pluginGuiEnabled();
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn void preloadPluginMetadata()
+    ///
+    /// @brief  Parses the mimetype/description tables up front so later lookups are plain map reads
+    ///
+    /// Called once per process from the first PluginCore constructor; safe to call repeatedly.
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    void preloadPluginMetadata();
 }
 
 #endif
@@ -0,0 +1,109 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "TimerService.h"
+#include "PluginWindow.h"
+
+using namespace FB;
+
+PluginWindow::PluginWindow()
+    : m_eventCoalescing(false), m_invalidateIntervalMs(16), m_dirtyValid(false)
+    , m_flushToken(0), m_lastInvalidate(boost::posix_time::min_date_time)  // so the first invalidation is never throttled
+{
+}
+
+PluginWindow::~PluginWindow()
+{
+    boost::uint64_t token;
+    {
+        boost::mutex::scoped_lock lock(m_dirtyMutex);
+        token = m_flushToken;
+        m_flushToken = 0;
+    }
+    if (token && m_timerService)
+        m_timerService->cancelTimeout(token);
+}
+
+void PluginWindow::setInvalidationInterval(long ms)
+{
+    boost::mutex::scoped_lock lock(m_dirtyMutex);
+    m_invalidateIntervalMs = ms < 0 ? 0 : ms;
+}
+
+long PluginWindow::getInvalidationInterval() const
+{
+    boost::mutex::scoped_lock lock(m_dirtyMutex);
+    return m_invalidateIntervalMs;
+}
+
+void PluginWindow::invalidateRect(const FB::Rect& rect)
+{
+    boost::system_time due;
+    {
+        boost::mutex::scoped_lock lock(m_dirtyMutex);
+        if (m_dirtyValid) {
+            m_dirtyRect.top = std::min(m_dirtyRect.top, rect.top);
+            m_dirtyRect.left = std::min(m_dirtyRect.left, rect.left);
+            m_dirtyRect.bottom = std::max(m_dirtyRect.bottom, rect.bottom);
+            m_dirtyRect.right = std::max(m_dirtyRect.right, rect.right);
+        } else {
+            m_dirtyRect = rect;
+            m_dirtyValid = true;
+        }
+
+        if (m_flushToken)
+            return;     // a flush is already on its way; this rect rides along
+
+        due = m_lastInvalidate + boost::posix_time::milliseconds(m_invalidateIntervalMs);
+        boost::system_time now = boost::get_system_time();
+        if (due > now) {
+            // too soon since the last invalidation; flush once the interval is up
+            long waitMs = static_cast<long>((due - now).total_milliseconds()) + 1;
+            if (!m_timerService)
+                m_timerService = TimerService::instance();
+            m_flushToken = m_timerService->scheduleTimeout(waitMs,
+                boost::bind(&PluginWindow::flushInvalidations, this));
+            return;
+        }
+        m_lastInvalidate = now;
+    }
+    InvalidateWindow();
+}
+
+void PluginWindow::flushInvalidations()
+{
+    {
+        boost::mutex::scoped_lock lock(m_dirtyMutex);
+        m_flushToken = 0;
+        if (!m_dirtyValid)
+            return;
+        m_lastInvalidate = boost::get_system_time();
+    }
+    InvalidateWindow();
+}
+
+bool PluginWindow::fetchDirtyRect(FB::Rect& outRect)
+{
+    boost::mutex::scoped_lock lock(m_dirtyMutex);
+    if (!m_dirtyValid)
+        return false;
+    outRect = m_dirtyRect;
+    m_dirtyValid = false;
+    return true;
+}
+
@@ -17,10 +17,15 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 #define H_FB_PLUGINWINDOW
 
 #include <string>
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
 #include "PluginEventSource.h"
 
 namespace FB {
 
+    FB_FORWARD_PTR(TimerService);
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @class  PluginWindow
     ///
@@ -33,8 +38,22 @@ namespace FB {
     class PluginWindow : public PluginEventSource
     {
     public:
-        PluginWindow() { };
-        virtual ~PluginWindow() { };
+        PluginWindow();
+        virtual ~PluginWindow();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void setEventCoalescing(bool enable)
+        ///
+        /// @brief  Enables or disables coalescing of high-frequency positional events
+        ///
+        /// When enabled, the platform window collapses runs of mouse-move events into the
+        /// latest position per message-pump iteration and merges overlapping invalidation
+        /// rects into one RefreshEvent.  Off by default; turn it on if your plugin only
+        /// cares about the current pointer position (e.g. canvas-style drawing during
+        /// drags) rather than every intermediate point.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void setEventCoalescing(bool enable) { m_eventCoalescing = enable; }
+        virtual bool getEventCoalescing() const { return m_eventCoalescing; }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void InvalidateWindow() const = 0
@@ -43,6 +62,44 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual void InvalidateWindow() const = 0;
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void invalidateRect(const FB::Rect& rect)
+        ///
+        /// @brief  Marks part of the window dirty and coalesces the resulting invalidations
+        ///
+        /// Rects accumulated between flushes are merged into one bounding region and turned
+        /// into a single InvalidateWindow() call at most once per invalidation interval
+        /// (default 16ms), so a plugin updating many small areas per frame doesn't spam the
+        /// OS with per-change invalidations.  The platform paint handler picks the merged
+        /// region up via fetchDirtyRect() and passes it through RefreshEvent, letting
+        /// handlers repaint only what changed.
+        ///
+        /// @param  rect    the dirty area, in window coordinates
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void invalidateRect(const FB::Rect& rect);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setInvalidationInterval(long ms)
+        ///
+        /// @brief  Sets the minimum interval between OS invalidations issued by invalidateRect
+        ///
+        /// 0 makes every invalidateRect flush immediately.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setInvalidationInterval(long ms);
+        long getInvalidationInterval() const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool fetchDirtyRect(FB::Rect& outRect)
+        ///
+        /// @brief  Returns and clears the merged dirty region accumulated by invalidateRect
+        ///
+        /// Called by the platform window when the OS paint arrives; returns false if nothing
+        /// was marked dirty (e.g. the OS invalidated the window on its own), in which case the
+        /// caller should fall back to the full paint bounds.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool fetchDirtyRect(FB::Rect& outRect);
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual FB::Rect getWindowPosition() const
         ///
@@ -78,6 +135,20 @@ namespace FB {
         /// @return The clipping rect of the window
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual FB::Rect getWindowClipping() const = 0;
+
+    protected:
+        void flushInvalidations();
+
+        bool m_eventCoalescing;
+
+    private:
+        long m_invalidateIntervalMs;
+        FB::Rect m_dirtyRect;
+        bool m_dirtyValid;
+        boost::uint64_t m_flushToken;       // pending TimerService timeout, 0 if none
+        TimerServicePtr m_timerService;     // held so the weak singleton stays alive
+        boost::system_time m_lastInvalidate;
+        mutable boost::mutex m_dirtyMutex;
     };
 };
 
@@ -0,0 +1,216 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include "BrowserHost.h"
+#include <algorithm>
+#include <boost/bind.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "BrowserStreamRequest.h"
+#include "StreamChunkPool.h"
+#include "SegmentedStreamHelper.h"
+
+FB::SegmentedStreamHelperPtr FB::SegmentedStreamHelper::AsyncSegmentedGet( const FB::BrowserHostPtr& host,
+    const FB::URI& uri, const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted,
+    size_t connections /*= 4*/, size_t segmentSize /*= k_DEFAULT_SEGMENT_SIZE*/ )
+{
+    if (!onData || !onCompleted) {
+        throw std::runtime_error("Invalid callback");
+    }
+    if (!host->isMainThread()) {
+        // This must be run from the main thread
+        return host->CallOnMainThread(boost::bind(&AsyncSegmentedGet, host, uri, onData, onCompleted,
+            connections, segmentSize));
+    }
+    // Open a seekable probe stream first; once it is open we know whether the server
+    // actually supports byte ranges and how long the resource is
+    BrowserStreamRequest req(uri, "GET");
+    req.setSeekable(true);
+    FB::BrowserStreamPtr stream(host->createStream(req, false));
+    FB::SegmentedStreamHelperPtr ptr(boost::make_shared<FB::SegmentedStreamHelper>(host, uri,
+        onData, onCompleted, connections, segmentSize));
+    ptr->keepReference(ptr);
+    ptr->m_streams.push_back(stream);
+    stream->AttachObserver(ptr);
+    return ptr;
+}
+
+FB::SegmentedStreamHelper::SegmentedStreamHelper( const FB::BrowserHostConstPtr& host, const FB::URI& uri,
+    const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted,
+    size_t connections, size_t segmentSize )
+    : m_host(host), m_uri(uri), chunkCallback(onData), completedCallback(onCompleted),
+      m_connections(connections ? connections : 1), m_segmentSize(segmentSize ? segmentSize : k_DEFAULT_SEGMENT_SIZE),
+      m_fileLength(0), m_nextOffset(0), m_deliverPos(0), m_probing(true), m_finished(false)
+{
+}
+
+void FB::SegmentedStreamHelper::keepReference( const SegmentedStreamHelperPtr& ptr )
+{
+    self = ptr;
+}
+
+bool FB::SegmentedStreamHelper::onStreamOpened( FB::StreamOpenedEvent *evt, FB::BrowserStream *stream )
+{
+    if (m_finished) return false;
+    if (m_probing) {
+        m_probing = false;
+        m_headers = SimpleStreamHelper::parse_http_headers(stream->getHeaders());
+        m_fileLength = stream->getLength();
+        if (!stream->isSeekableByServer() || !m_fileLength) {
+            // No range support (or unknown length); drop to an ordinary streaming download
+            fallback();
+            return false;
+        }
+        assignNextSegment(stream);
+        startWorkers();
+    } else {
+        assignNextSegment(stream);
+    }
+    return false;
+}
+
+void FB::SegmentedStreamHelper::startWorkers()
+{
+    FB::BrowserHostConstPtr host(m_host.lock());
+    if (!host) {
+        finish(false);
+        return;
+    }
+    // The probe stream is worker 0; open the remaining connections while there are
+    // segments left for them to claim
+    while (m_streams.size() < m_connections && m_nextOffset < m_fileLength) {
+        BrowserStreamRequest req(m_uri, "GET");
+        req.setSeekable(true);
+        FB::BrowserStreamPtr stream(host->createStream(req, false));
+        if (!stream) break;
+        m_streams.push_back(stream);
+        stream->AttachObserver(FB::ptr_cast<SegmentedStreamHelper>(shared_from_this()));
+        // It claims its first segment from onStreamOpened
+    }
+}
+
+void FB::SegmentedStreamHelper::fallback()
+{
+    FB::BrowserHostConstPtr host(m_host.lock());
+    HttpChunkCallback onData(chunkCallback);
+    HttpCompletedCallback onCompleted(completedCallback);
+
+    // Hand the callbacks over to a plain streaming request before letting go of them;
+    // finish(false) below must not fire the completed callback a second time
+    chunkCallback.clear();
+    completedCallback.clear();
+    if (host) {
+        BrowserStreamRequest req(m_uri, "GET");
+        SimpleStreamHelper::AsyncStreamingRequest(host, req, onData, onCompleted);
+    } else if (onCompleted) {
+        onCompleted(false, m_headers);
+    }
+    finish(false);
+}
+
+bool FB::SegmentedStreamHelper::assignNextSegment( FB::BrowserStream* stream )
+{
+    if (m_finished || m_nextOffset >= m_fileLength) {
+        m_workers.erase(stream);
+        return false;
+    }
+    Worker w;
+    w.expected = m_nextOffset;
+    w.segEnd = std::min(m_nextOffset + m_segmentSize, m_fileLength);
+    m_nextOffset = w.segEnd;
+    m_workers[stream] = w;
+    stream->readRange(w.expected, w.segEnd);
+    return true;
+}
+
+bool FB::SegmentedStreamHelper::onStreamDataArrived( FB::StreamDataArrivedEvent *evt, FB::BrowserStream *stream )
+{
+    if (m_finished) return false;
+    deliver(reinterpret_cast<const uint8_t*>(evt->getData()), evt->getLength(), evt->getDataPosition());
+
+    WorkerMap::iterator it = m_workers.find(stream);
+    if (it != m_workers.end()) {
+        size_t end = evt->getDataPosition() + evt->getLength();
+        if (end > it->second.expected)
+            it->second.expected = end;
+        if (it->second.expected >= it->second.segEnd) {
+            // This connection finished its segment; give it the next one
+            assignNextSegment(stream);
+        }
+    }
+    return false;
+}
+
+void FB::SegmentedStreamHelper::deliver( const uint8_t* data, size_t len, size_t offset )
+{
+    if (m_finished || !len) return;
+    if (offset == m_deliverPos) {
+        // In order: hand the browser's buffer straight through
+        if (chunkCallback)
+            chunkCallback(data, len, offset);
+        m_deliverPos += len;
+        // Flush anything that arrived ahead of us and is now contiguous
+        ChunkMap::iterator it = m_reorderBuffer.begin();
+        while (it != m_reorderBuffer.end() && it->first == m_deliverPos) {
+            if (chunkCallback)
+                chunkCallback(it->second.first.get(), it->second.second, it->first);
+            m_deliverPos += it->second.second;
+            m_reorderBuffer.erase(it);
+            it = m_reorderBuffer.begin();
+        }
+    } else if (offset > m_deliverPos) {
+        // Ahead of the delivery position; park a copy until the gap fills
+        boost::shared_array<uint8_t> copy(FB::StreamChunkPool::allocateBytes(len));
+        std::copy(data, data + len, copy.get());
+        m_reorderBuffer[offset] = std::make_pair(copy, len);
+    }
+    // Anything below m_deliverPos was already delivered; drop it
+
+    if (m_deliverPos >= m_fileLength && m_fileLength)
+        finish(true);
+}
+
+bool FB::SegmentedStreamHelper::onStreamFailedOpen( FB::StreamFailedOpenEvent *evt, FB::BrowserStream *stream )
+{
+    // Whether the probe or a worker failed, the logical stream can't be finished correctly
+    finish(false);
+    return false;
+}
+
+bool FB::SegmentedStreamHelper::onStreamCompleted( FB::StreamCompletedEvent *evt, FB::BrowserStream *stream )
+{
+    if (m_finished) return false;
+    // Seekable streams report completion when they close; that is only an error if the
+    // download hasn't finished delivering
+    if (!evt->success)
+        finish(false);
+    return false;
+}
+
+void FB::SegmentedStreamHelper::finish( bool success )
+{
+    if (m_finished) return;
+    m_finished = true;
+    m_workers.clear();
+    m_reorderBuffer.clear();
+    for (std::vector<FB::BrowserStreamPtr>::const_iterator it = m_streams.begin(); it != m_streams.end(); ++it) {
+        (*it)->close();
+    }
+    m_streams.clear();
+    if (completedCallback)
+        completedCallback(success, m_headers);
+    chunkCallback.clear();
+    completedCallback.clear();
+    self.reset();
+}
@@ -0,0 +1,117 @@
+#pragma once
+#ifndef SegmentedStreamHelper_h__
+#define SegmentedStreamHelper_h__
+
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <map>
+#include <vector>
+#include <boost/shared_array.hpp>
+#include "SimpleStreamHelper.h"
+
+#define k_DEFAULT_SEGMENT_SIZE 1024 * 1024
+
+namespace FB {
+    FB_FORWARD_PTR(SegmentedStreamHelper);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  SegmentedStreamHelper
+    ///
+    /// @brief  Downloads one resource over several parallel range-request streams and delivers
+    ///         the bytes as a single ordered logical stream.
+    ///
+    /// A single browser stream rarely fills a high-latency link.  This helper opens a seekable
+    /// probe stream first; if the server supports byte ranges (isSeekableByServer) and reports a
+    /// content length, it opens up to the requested number of connections, hands each one a
+    /// segment at a time, and re-orders the arriving chunks so the onData callback always sees
+    /// contiguous, in-order data just like a single stream.  If the server turns out not to
+    /// support ranges the download transparently falls back to a plain streaming request via
+    /// SimpleStreamHelper.
+    ///
+    /// Uses the same callback types as SimpleStreamHelper::AsyncStreamingGet: onData receives
+    /// each contiguous chunk, onCompleted fires once with the overall result and headers.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class SegmentedStreamHelper : public FB::PluginEventSink
+    {
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn static SegmentedStreamHelperPtr AsyncSegmentedGet(const FB::BrowserHostPtr& host, const FB::URI& uri, const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted, size_t connections = 4, size_t segmentSize = k_DEFAULT_SEGMENT_SIZE)
+        ///
+        /// @brief  Starts a segmented GET of the given URI using up to the given number of
+        ///         parallel connections, delivering ordered chunks to onData and the final
+        ///         result to onCompleted.  Safe to call from any thread.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static SegmentedStreamHelperPtr AsyncSegmentedGet(const FB::BrowserHostPtr& host, const FB::URI& uri,
+            const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted,
+            size_t connections = 4, size_t segmentSize = k_DEFAULT_SEGMENT_SIZE);
+
+        SegmentedStreamHelper(const FB::BrowserHostConstPtr& host, const FB::URI& uri,
+            const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted,
+            size_t connections, size_t segmentSize);
+
+    public:
+        BEGIN_PLUGIN_EVENT_MAP()
+            EVENTTYPE_CASE(FB::StreamOpenedEvent, onStreamOpened, FB::BrowserStream)
+            EVENTTYPE_CASE(FB::StreamDataArrivedEvent, onStreamDataArrived, FB::BrowserStream)
+            EVENTTYPE_CASE(FB::StreamFailedOpenEvent, onStreamFailedOpen, FB::BrowserStream)
+            EVENTTYPE_CASE(FB::StreamCompletedEvent, onStreamCompleted, FB::BrowserStream)
+        END_PLUGIN_EVENT_MAP()
+
+        virtual bool onStreamOpened(FB::StreamOpenedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamFailedOpen(FB::StreamFailedOpenEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *);
+
+    protected:
+        void keepReference(const SegmentedStreamHelperPtr& ptr);
+        // All of the below run on the main thread only
+        void startWorkers();
+        void fallback();
+        bool assignNextSegment(FB::BrowserStream* stream);
+        void deliver(const uint8_t* data, size_t len, size_t offset);
+        void finish(bool success);
+
+        // Per-connection bookkeeping: the next byte we expect from it and the end of its segment
+        struct Worker {
+            size_t expected;
+            size_t segEnd;
+        };
+        typedef std::map<FB::BrowserStream*, Worker> WorkerMap;
+        // Chunks that arrived ahead of the delivery position, keyed by absolute offset
+        typedef std::map<size_t, std::pair<boost::shared_array<uint8_t>, size_t> > ChunkMap;
+
+        boost::weak_ptr<const FB::BrowserHost> m_host;
+        FB::URI m_uri;
+        HttpChunkCallback chunkCallback;
+        HttpCompletedCallback completedCallback;
+        size_t m_connections;
+        size_t m_segmentSize;
+
+        std::vector<FB::BrowserStreamPtr> m_streams;
+        WorkerMap m_workers;
+        ChunkMap m_reorderBuffer;
+        FB::HeaderMap m_headers;
+        size_t m_fileLength;
+        size_t m_nextOffset;        // start of the next unassigned segment
+        size_t m_deliverPos;        // everything below this offset has been delivered in order
+        bool m_probing;
+        bool m_finished;
+
+    private:
+        SegmentedStreamHelperPtr self;
+    };
+};
+
+#endif // SegmentedStreamHelper_h__
@@ -0,0 +1,152 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+#include "PluginEvents/StreamEvents.h"
+#include "SequentialStreamHandler.h"
+
+using namespace FB;
+
+SequentialStreamHandler::SequentialStreamHandler()
+    : m_pendingN(0), m_chunk(NULL), m_chunkLen(0), m_chunkPos(0), m_consumed(0), m_finished(false)
+{
+}
+
+SequentialStreamHandler::~SequentialStreamHandler()
+{
+}
+
+void SequentialStreamHandler::await(size_t n, const ReadContinuation& k)
+{
+    assert(!m_pending);     // one outstanding await at a time
+    m_pending = k;
+    m_pendingN = n;
+}
+
+void SequentialStreamHandler::awaitSome(const ReadContinuation& k)
+{
+    assert(!m_pending);
+    m_pending = k;
+    m_pendingN = 0;
+}
+
+void SequentialStreamHandler::onFinished(bool)
+{
+}
+
+bool SequentialStreamHandler::onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *)
+{
+    if (!m_finished)
+        feed(static_cast<const char*>(evt->getData()), evt->getLength());
+    return false;
+}
+
+bool SequentialStreamHandler::onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *)
+{
+    if (!m_finished && m_pending) {
+        // the stream ended short of the request; resume with whatever remains so the
+        // continuation can deal with the truncated tail
+        std::vector<char> tail;
+        tail.swap(m_partial);
+        ReadContinuation k;
+        k.swap(m_pending);
+        m_consumed += tail.size();
+        k(tail.empty() ? NULL : &tail[0], tail.size());
+    }
+    finish(evt->success);
+    return false;
+}
+
+bool SequentialStreamHandler::onStreamFailedOpen(FB::StreamFailedOpenEvent *evt, FB::BrowserStream *)
+{
+    finish(false);
+    return false;
+}
+
+void SequentialStreamHandler::feed(const char* data, size_t len)
+{
+    m_chunk = data;
+    m_chunkLen = len;
+    m_chunkPos = 0;
+    pump();
+    // bytes nobody asked for yet; keep them for the next await
+    if (m_chunkPos < m_chunkLen)
+        m_partial.insert(m_partial.end(), m_chunk + m_chunkPos, m_chunk + m_chunkLen);
+    m_chunk = NULL;
+    m_chunkLen = m_chunkPos = 0;
+}
+
+void SequentialStreamHandler::pump()
+{
+    // Each pass hands one satisfied request to its continuation; the continuation
+    // usually awaits again, so the loop keeps going until the data runs out and the
+    // chain suspends
+    while (m_pending && !m_finished) {
+        size_t inChunk = m_chunkLen - m_chunkPos;
+        const char* out;
+        size_t outLen;
+        std::vector<char> assembled;
+        if (m_pendingN == 0) {
+            // awaitSome: spanning leftovers first, then the rest of this chunk as-is
+            if (!m_partial.empty()) {
+                assembled.swap(m_partial);
+                out = &assembled[0];
+                outLen = assembled.size();
+            } else if (inChunk) {
+                out = m_chunk + m_chunkPos;
+                outLen = inChunk;
+                m_chunkPos = m_chunkLen;
+            } else {
+                break;
+            }
+        } else {
+            if (m_partial.size() + inChunk < m_pendingN) {
+                // not enough yet; stash the head and suspend until the next chunk
+                if (inChunk) {
+                    m_partial.insert(m_partial.end(), m_chunk + m_chunkPos, m_chunk + m_chunkLen);
+                    m_chunkPos = m_chunkLen;
+                }
+                break;
+            }
+            if (m_partial.empty()) {
+                // fast path: the whole request sits in the browser's buffer
+                out = m_chunk + m_chunkPos;
+                outLen = m_pendingN;
+                m_chunkPos += m_pendingN;
+            } else {
+                size_t need = m_pendingN - m_partial.size();
+                assembled.swap(m_partial);
+                assembled.insert(assembled.end(), m_chunk + m_chunkPos, m_chunk + m_chunkPos + need);
+                m_chunkPos += need;
+                out = &assembled[0];
+                outLen = m_pendingN;
+            }
+        }
+        ReadContinuation k;
+        k.swap(m_pending);
+        m_pendingN = 0;
+        m_consumed += outLen;
+        k(out, outLen);     // may await() again, re-arming m_pending
+    }
+}
+
+void SequentialStreamHandler::finish(bool success)
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+    m_pending.clear();
+    m_partial.clear();
+    onFinished(success);
+}
@@ -0,0 +1,129 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_SEQUENTIALSTREAMHANDLER
+#define H_FB_SEQUENTIALSTREAMHANDLER
+
+#include <vector>
+#include <boost/function.hpp>
+#include "DefaultBrowserStreamHandler.h"
+
+namespace FB {
+
+    FB_FORWARD_PTR(SequentialStreamHandler);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  SequentialStreamHandler
+    ///
+    /// @brief  Sequential, coroutine-style stream consumption without the state machine
+    ///
+    /// Parsing a download through onStreamDataArrived forces the parser inside out: every
+    /// callback has to work out where it left off.  This handler turns that around.  Code
+    /// reads sequentially by calling await(n, k) -- "when the next n bytes are here, call k
+    /// with them" -- and the continuation k typically ends by awaiting the next piece, so a
+    /// parser is written as a chain of resume points instead of a switch over saved state.
+    /// It is a stackless coroutine in continuation-passing form: the framework suspends by
+    /// returning to the browser and resumes the chain as chunks arrive.
+    ///
+    /// There is no intermediate buffering on the fast path.  A request satisfied entirely by
+    /// the chunk being delivered gets a pointer straight into the browser's buffer; only a
+    /// request spanning a chunk boundary has its head copied aside until the tail arrives.
+    ///
+    /// @code
+    ///      // read a 4-byte length prefix, then the payload, then repeat
+    ///      void MyParser::start() {
+    ///          await(4, boost::bind(&MyParser::onHeader, this, _1, _2));
+    ///      }
+    ///      void MyParser::onHeader(const char* p, size_t) {
+    ///          await(readLength(p), boost::bind(&MyParser::onBody, this, _1, _2));
+    ///      }
+    ///      void MyParser::onBody(const char* p, size_t n) {
+    ///          handle(p, n);
+    ///          await(4, boost::bind(&MyParser::onHeader, this, _1, _2));
+    ///      }
+    /// @endcode
+    ///
+    /// Everything runs on the stream's delivery thread; no locking is needed inside the
+    /// continuations.  Compare BrowserStreamReader, which offers the same sequential style as
+    /// a blocking istream for code that owns a worker thread; this class is for parsers that
+    /// must stay on the event thread and run incrementally at chunk granularity.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class SequentialStreamHandler : public DefaultBrowserStreamHandler
+    {
+    public:
+        /// Resume point: receives a pointer to the requested bytes, valid only for the call
+        typedef boost::function<void (const char* data, size_t len)> ReadContinuation;
+
+        SequentialStreamHandler();
+        virtual ~SequentialStreamHandler();
+
+        virtual bool onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamFailedOpen(FB::StreamFailedOpenEvent *evt, FB::BrowserStream *);
+
+    protected:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void await(size_t n, const ReadContinuation& k)
+        ///
+        /// @brief  Calls k with exactly the next n bytes of the stream, once they have arrived
+        ///
+        /// Call from a continuation (or from onStreamOpened to start the chain).  Only one
+        /// await may be outstanding at a time.  If the stream ends short, k receives whatever
+        /// remains (possibly zero bytes) before onFinished(true) runs, so parsers can handle
+        /// truncated tails.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void await(size_t n, const ReadContinuation& k);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void awaitSome(const ReadContinuation& k)
+        ///
+        /// @brief  Calls k with the next piece of data, whatever its size; always zero-copy
+        ///
+        /// For consumers that don't need framing -- hashing, transcoding -- this hands over
+        /// each arriving chunk as-is.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void awaitSome(const ReadContinuation& k);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void onFinished(bool success)
+        ///
+        /// @brief  Called once when the stream completes or fails; success mirrors the stream's fate
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void onFinished(bool success);
+
+        /// @brief  Total bytes handed to continuations so far
+        size_t bytesConsumed() const { return m_consumed; }
+
+    private:
+        // Feeds one arrived chunk through the pending continuation chain
+        void feed(const char* data, size_t len);
+        // Runs continuations while their requests can be satisfied; stops when suspended
+        void pump();
+        void finish(bool success);
+
+        ReadContinuation m_pending;     // the suspended resume point; empty when none
+        size_t m_pendingN;              // bytes it asked for; 0 means awaitSome
+        std::vector<char> m_partial;    // head of a request that spans chunk boundaries
+        const char* m_chunk;            // chunk currently being fed, only valid inside feed()
+        size_t m_chunkLen;
+        size_t m_chunkPos;
+        size_t m_consumed;
+        bool m_finished;
+    };
+}
+
+#endif
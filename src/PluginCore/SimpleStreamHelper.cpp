@@ -19,10 +19,30 @@ Copyright 2011 Richard Bateman,
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
 #include "BrowserStreamRequest.h"
+#include "StreamChunkPool.h"
+#include "HeaderView.h"
+#include "HttpCache.h"
+#include "StreamInflater.h"
 #include "SimpleStreamHelper.h"
 
 static const int MEGABYTE = 1024 * 1024;
 
+namespace {
+    // Once a body has been inflated, Content-Encoding and Content-Length no longer
+    // describe the bytes the consumer receives, so they are dropped
+    void strip_encoding_headers(FB::HeaderMap& headers)
+    {
+        for (FB::HeaderMap::iterator it = headers.begin(); it != headers.end(); ) {
+            if (boost::algorithm::iequals(it->first, "Content-Encoding")
+                || boost::algorithm::iequals(it->first, "Content-Length")) {
+                headers.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
 FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncGet( const FB::BrowserHostPtr& host, const FB::URI& uri,
     const HttpCallback& callback, bool cache /*= true*/, size_t bufferSize /*= 256*1024*/ )
 {
@@ -48,6 +68,35 @@ FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncPost(const FB::BrowserHos
     return AsyncRequest(host, req);
 }
 
+FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncStreamingGet( const FB::BrowserHostPtr& host, const FB::URI& uri,
+    const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted,
+    bool cache /*= true*/, size_t bufferSize /*= 128*1024*/ )
+{
+    BrowserStreamRequest req(uri, "GET");
+    req.setBufferSize(bufferSize);
+    req.setCacheable(cache);
+    return AsyncStreamingRequest(host, req, onData, onCompleted);
+}
+
+FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncStreamingRequest( const FB::BrowserHostConstPtr& host,
+    const BrowserStreamRequest& req,
+    const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted )
+{
+    if (!onData || !onCompleted) {
+        throw std::runtime_error("Invalid callback");
+    }
+    if (!host->isMainThread()) {
+        // This must be run from the main thread
+        return host->CallOnMainThread(boost::bind(&AsyncStreamingRequest, host, req, onData, onCompleted));
+    }
+    FB::BrowserStreamPtr stream(host->createStream(req, false));
+    FB::SimpleStreamHelperPtr ptr(boost::make_shared<FB::SimpleStreamHelper>(onData, onCompleted, req.internalBufferSize));
+    ptr->setDecodeCompressed(req.acceptCompressed);
+    ptr->keepReference(ptr);
+    stream->AttachObserver(ptr);
+    return ptr;
+}
+
 FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncRequest( const FB::BrowserHostConstPtr& host,
                                                                 const BrowserStreamRequest& req ) {
     if (!req.getCallback()) {
@@ -57,6 +106,20 @@ FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncRequest( const FB::Browse
         // This must be run from the main thread
         return host->CallOnMainThread(boost::bind(&AsyncRequest, host, req));
     }
+    if (req.method == "GET" && req.cache && HttpCache::get().isEnabled()) {
+        // Consult the plugin-side disk cache before going to the network; a fresh
+        // entry is delivered asynchronously so the callback contract is unchanged
+        FB::HeaderMap headers;
+        boost::shared_array<uint8_t> data;
+        size_t size(0);
+        if (HttpCache::get().fetch(req.uri.toString(), headers, data, size)) {
+            FB::SimpleStreamHelperPtr ptr(boost::make_shared<FB::SimpleStreamHelper>(req.getCallback(), req.internalBufferSize));
+            ptr->keepReference(ptr);
+            host->ScheduleOnMainThread(ptr, boost::bind(&SimpleStreamHelper::deliverCachedResponse,
+                ptr, headers, data, size));
+            return ptr;
+        }
+    }
     FB::BrowserStreamPtr stream(host->createStream(req, false));
     return AsyncRequest(host, stream, req);
 }
@@ -69,6 +132,7 @@ FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncRequest( const FB::Browse
         return host->CallOnMainThread(boost::bind(&AsyncRequest, host, stream, req));
     }
     FB::SimpleStreamHelperPtr ptr(boost::make_shared<FB::SimpleStreamHelper>(req.getCallback(), req.internalBufferSize));
+    ptr->setDecodeCompressed(req.acceptCompressed);
     // This is kinda a weird trick; it's responsible for freeing itself, unless something decides
     // to hold a reference to it.
     ptr->keepReference(ptr);
@@ -147,14 +211,47 @@ FB::HttpStreamResponsePtr FB::SimpleStreamHelper::SynchronousPost( const FB::Bro
 }
 
 FB::SimpleStreamHelper::SimpleStreamHelper( const HttpCallback& callback, const size_t blockSize )
-    : blockSize(blockSize), received(0), callback(callback)
+    : blockSize(blockSize), received(0), callback(callback),
+      decodeCompressed(false), encodingChecked(false), inflateFailed(false), decodedOffset(0)
+{
+
+}
+
+FB::SimpleStreamHelper::SimpleStreamHelper( const HttpChunkCallback& onData,
+    const HttpCompletedCallback& onCompleted, const size_t blockSize )
+    : blockSize(blockSize), received(0), chunkCallback(onData), completedCallback(onCompleted),
+      decodeCompressed(false), encodingChecked(false), inflateFailed(false), decodedOffset(0)
+{
+
+}
+
+FB::SimpleStreamHelper::~SimpleStreamHelper()
 {
 
 }
 
 bool FB::SimpleStreamHelper::onStreamCompleted( FB::StreamCompletedEvent *evt, FB::BrowserStream *stream )
 {
-    if (!evt->success) {
+    // A decoded body that failed to inflate, or whose compressed stream was cut
+    // short, is a failed request even when the transfer itself succeeded
+    bool success = (evt->success ? true : false)
+        && !inflateFailed && (!inflater || inflater->done());
+    if (completedCallback) {
+        // Chunked mode: the body already went out block by block, so only the
+        // outcome and headers are left to deliver
+        FB::HeaderMap headers;
+        if (success && stream) {
+            headers = parse_http_headers(stream->getHeaders());
+            if (inflater)
+                strip_encoding_headers(headers);
+        }
+        completedCallback(success, headers);
+        completedCallback.clear();
+        chunkCallback.clear();
+        self.reset();
+        return false;
+    }
+    if (!success) {
         if (callback)
             callback(false, FB::HeaderMap(), boost::shared_array<uint8_t>(), received);
         callback.clear();
@@ -180,6 +277,12 @@ bool FB::SimpleStreamHelper::onStreamCompleted( FB::StreamCompletedEvent *evt, F
     if (callback && stream) {
         std::multimap<std::string, std::string> headers;
         headers = parse_http_headers(stream->getHeaders());
+        if (inflater)
+            strip_encoding_headers(headers);
+        if (stream->isCached() && HttpCache::get().isEnabled()) {
+            // Only requests that opted into caching (req.setCacheable) land here
+            HttpCache::get().store(stream->getUrl(), headers, data, received);
+        }
         callback(true, headers, data, received);
     }
     callback.clear();
@@ -187,25 +290,82 @@ bool FB::SimpleStreamHelper::onStreamCompleted( FB::StreamCompletedEvent *evt, F
     return false; // Always return false to make sure the browserhost knows to let go of the object
 }
 
+void FB::SimpleStreamHelper::deliverCachedResponse( const FB::HeaderMap& headers,
+    const boost::shared_array<uint8_t>& data, const size_t size )
+{
+    if (callback)
+        callback(true, headers, data, size);
+    callback.clear();
+    self.reset();
+}
+
 bool FB::SimpleStreamHelper::onStreamOpened( FB::StreamOpenedEvent *evt, FB::BrowserStream * )
 {
     // We can't reliably find the actual length, so we won't try
     return false;
 }
 
-bool FB::SimpleStreamHelper::onStreamDataArrived( FB::StreamDataArrivedEvent *evt, FB::BrowserStream * )
+bool FB::SimpleStreamHelper::onStreamDataArrived( FB::StreamDataArrivedEvent *evt, FB::BrowserStream *stream )
 {
+    if (decodeCompressed && !encodingChecked) {
+        // Decide once, off the response headers, whether an inflate stage is needed
+        encodingChecked = true;
+        if (stream) {
+            FB::HeaderMap headers(parse_http_headers(stream->getHeaders()));
+            for (FB::HeaderMap::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+                if (boost::algorithm::iequals(it->first, "Content-Encoding")
+                    && StreamInflater::canDecode(it->second)) {
+                    inflater.reset(new StreamInflater);
+                    break;
+                }
+            }
+        }
+    }
+    if (inflater) {
+        if (inflateFailed)
+            return false;
+        std::vector<uint8_t> decoded;
+        if (!inflater->feed(reinterpret_cast<const uint8_t*>(evt->getData()),
+                evt->getLength(), decoded)) {
+            // Corrupt compressed data; reported as a failed request at completion
+            // so the callback contract is unchanged
+            inflateFailed = true;
+            return false;
+        }
+        if (!decoded.empty()) {
+            if (chunkCallback)
+                chunkCallback(&decoded[0], decoded.size(), decodedOffset);
+            else
+                accumulate(&decoded[0], decoded.size(), decodedOffset);
+            decodedOffset += decoded.size();
+            received += decoded.size();
+        }
+        return false;
+    }
     received += evt->getLength();
-    const uint8_t* buf = reinterpret_cast<const uint8_t*>(evt->getData());
-    const uint8_t* endbuf = buf + evt->getLength();
+    if (chunkCallback) {
+        // Chunked mode: hand the block straight to the consumer; nothing is
+        // buffered, so multi-hundred-MB bodies never build up in memory
+        chunkCallback(reinterpret_cast<const uint8_t*>(evt->getData()),
+            evt->getLength(), evt->getDataPosition());
+        return false;
+    }
+    accumulate(reinterpret_cast<const uint8_t*>(evt->getData()),
+        evt->getLength(), evt->getDataPosition());
+    return false;
+}
+
+void FB::SimpleStreamHelper::accumulate( const uint8_t* buf, size_t srclen, size_t srcoffset )
+{
+    const uint8_t* endbuf = buf + srclen;
 
-    int len = evt->getLength();
-    int offset = evt->getDataPosition();
+    int len = srclen;
+    int offset = srcoffset;
     while (buf < endbuf) {
         size_t n = offset / blockSize;
         size_t pos = offset % blockSize;
         if (blocks.size() < n+1) {
-            blocks.push_back(boost::shared_array<uint8_t>(new uint8_t[blockSize]));
+            blocks.push_back(FB::StreamChunkPool::allocateBytes(blockSize));
         }
         uint8_t *destBuf = blocks.back().get();
         //if (pos + len > )
@@ -221,26 +381,14 @@ bool FB::SimpleStreamHelper::onStreamDataArrived( FB::StreamDataArrivedEvent *ev
         offset += curLen;
         len -= curLen;
     }
-    return false;
 }
 
 FB::HeaderMap FB::SimpleStreamHelper::parse_http_headers(const std::string& headers )
 {
-    FB::HeaderMap res;
-    std::vector<std::string> lines;
-    boost::split(lines, headers, boost::is_any_of("\r\n"));
-    for (std::vector<std::string>::const_iterator it = lines.begin(); it != lines.end(); ++it) {
-        std::string line = boost::trim_copy(*it);
-        if (line.empty()) continue;
-        size_t loc = line.find(':');
-        if (loc == std::string::npos) {
-            // Weird; bad header
-            continue;
-        }
-        res.insert(std::make_pair(boost::trim_copy(line.substr(0, loc)),
-            boost::trim_copy(line.substr(loc + 1))));
-    }
-    return res;
+    // HeaderView indexes the block in place in one pass; only the map
+    // materialization at the end allocates.  Callers that just probe a couple
+    // of headers can use FB::HeaderView directly and skip even that.
+    return FB::HeaderView(headers).toMap();
 }
 
 void FB::SimpleStreamHelper::keepReference( const SimpleStreamHelperPtr& ptr )
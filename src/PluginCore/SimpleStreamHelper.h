@@ -22,6 +22,7 @@ Copyright 2011 Richard Bateman,
 #include "BrowserStream.h"
 #include "URI.h"
 #include <boost/shared_array.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <string>
 #include <list>
@@ -30,9 +31,17 @@ Copyright 2011 Richard Bateman,
 namespace FB {
     FB_FORWARD_PTR(BrowserHost);
     FB_FORWARD_PTR(SimpleStreamHelper);
+    class StreamInflater;
 
     typedef std::multimap<std::string, std::string> HeaderMap;
     typedef boost::function<void (bool, const FB::HeaderMap&, const boost::shared_array<uint8_t>&, const size_t)> HttpCallback;
+    // Chunked delivery: called on the main thread for each arriving block as
+    // (data, size, offset).  The pointer is only valid for the duration of the call;
+    // the block is handed over without any copy or accumulation
+    typedef boost::function<void (const uint8_t*, const size_t, const size_t)> HttpChunkCallback;
+    // Completion notification for chunked delivery; the body was already handed out
+    // block by block, so only success and the response headers remain
+    typedef boost::function<void (bool, const FB::HeaderMap&)> HttpCompletedCallback;
     
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @class  HttpStreamResponse
@@ -149,6 +158,54 @@ namespace FB {
         static FB::SimpleStreamHelperPtr AsyncGet(const FB::BrowserHostPtr& host, const FB::URI& uri, const HttpCallback& callback,
             bool cache = true, size_t bufferSize = 128*1024);
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn public static FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncStreamingGet(const FB::BrowserHostPtr& host, const FB::URI& uri, const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted, const bool cache = true, const size_t bufferSize = 128*1024)
+        ///
+        /// @brief  Starts an asynchronous HTTP get request with chunked delivery
+        ///
+        /// Unlike AsyncGet this never accumulates the body: each block is handed to onData
+        /// as (data, size, offset) the moment it arrives, with no copies, and onCompleted
+        /// fires at the end with the success flag and response headers.  Use this for large
+        /// downloads where buffering the whole body would double peak memory; keep AsyncGet
+        /// for small requests where a contiguous body is more convenient.
+        ///
+        /// Both callbacks are invoked on the main thread, and the data pointer passed to
+        /// onData is only valid for the duration of that call.
+        ///
+        /// @param  host        const FB::BrowserHostPtr&     BrowserHostPtr to use to create the stream
+        /// @param  uri         const FB::URI&                URI to request
+        /// @param  onData      const HttpChunkCallback&      Called for every arriving block
+        /// @param  onCompleted const HttpCompletedCallback&  Called once when the stream finishes
+        /// @param  cache       const bool                    true if cache can be used
+        /// @param  bufferSize  const size_t                  Specifies the size of the buffer to use internally
+        /// @returns FB::SimpleStreamHelperPtr
+        /// @since 1.7
+        /// @see AsyncGet
+        /// @see AsyncStreamingRequest
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static FB::SimpleStreamHelperPtr AsyncStreamingGet(const FB::BrowserHostPtr& host, const FB::URI& uri,
+            const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted,
+            bool cache = true, size_t bufferSize = 128*1024);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn  static  FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncStreamingRequest(const BrowserHostConstPtr& host, const BrowserStreamRequest& req, const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted);
+        ///
+        /// @brief  Creates an asynchronous chunked-delivery HTTP request from a BrowserStreamRequest
+        ///
+        /// The callback on the request object (if any) is ignored; blocks go to onData and the
+        /// final notification to onCompleted as described on AsyncStreamingGet.
+        ///
+        /// @param host         const BrowserHostConstPtr &
+        /// @param req          const BrowserStreamRequest &
+        /// @param  onData      const HttpChunkCallback&      Called for every arriving block
+        /// @param  onCompleted const HttpCompletedCallback&  Called once when the stream finishes
+        /// @since 1.7
+        /// @see AsyncStreamingGet
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static FB::SimpleStreamHelperPtr AsyncStreamingRequest(const BrowserHostConstPtr& host,
+            const BrowserStreamRequest& req,
+            const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted);
+
         
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn public static FB::SimpleStreamHelperPtr FB::SimpleStreamHelper::AsyncPost(const FB::BrowserHostPtr& host, const FB::URI& uri, const std::string& postdata, const HttpCallback& callback, const bool cache = true, const size_t bufferSize = 128*1024)
@@ -281,19 +338,63 @@ namespace FB {
 
     public:
         SimpleStreamHelper( const HttpCallback& callback, const size_t blockSize = 128*1024 );
+        SimpleStreamHelper( const HttpChunkCallback& onData, const HttpCompletedCallback& onCompleted,
+            const size_t blockSize = 128*1024 );
+        // Out of line so the scoped_ptr members only need complete types in the .cpp
+        virtual ~SimpleStreamHelper();
 
         virtual bool onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *);
         virtual bool onStreamOpened(FB::StreamOpenedEvent *evt, FB::BrowserStream *);
         virtual bool onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *);
         static FB::HeaderMap parse_http_headers(const std::string& headers );
 
+        // Delivers a response served from the plugin-side FB::HttpCache; scheduled on
+        // the main thread in place of a network request when the cache holds a fresh
+        // entry for the URL
+        void deliverCachedResponse(const FB::HeaderMap& headers,
+            const boost::shared_array<uint8_t>& data, const size_t size);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn   void FB::SimpleStreamHelper::setDecodeCompressed(bool v);
+        ///
+        /// @brief  Enables the streaming decompression stage for this request
+        ///
+        /// When enabled and the response declares Content-Encoding: gzip or deflate, each
+        /// arriving block is inflated as it arrives (see FB::StreamInflater) and the callbacks
+        /// see the decoded body; Content-Encoding and Content-Length are dropped from the
+        /// header map since they no longer describe the delivered bytes.  Set automatically
+        /// by the AsyncRequest factories from BrowserStreamRequest::setAcceptCompressed.
+        ///
+        /// @param v  bool true to decode compressed responses
+        ///
+        /// @since 1.7
+        /// @see FB::BrowserStreamRequest::setAcceptCompressed
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setDecodeCompressed(bool v) { decodeCompressed = v; }
+
     protected:
+        // Places one run of body bytes at the given offset in the accumulation blocks
+        void accumulate(const uint8_t* buf, size_t len, size_t offset);
         typedef std::list<boost::shared_array<uint8_t> > BlockList;
         BlockList blocks;
         boost::shared_array<uint8_t> data;
         const size_t blockSize;
         size_t received;
         HttpCallback callback;
+        // Chunked delivery mode; when chunkCallback is set, blocks bypass the
+        // accumulation path entirely
+        HttpChunkCallback chunkCallback;
+        HttpCompletedCallback completedCallback;
+
+        // Streaming decompression stage (see setDecodeCompressed): the inflater is
+        // created on the first arriving block when the response headers declare a
+        // supported Content-Encoding, and from then on received/offsets count
+        // decoded bytes
+        bool decodeCompressed;
+        bool encodingChecked;
+        bool inflateFailed;
+        size_t decodedOffset;
+        boost::scoped_ptr<StreamInflater> inflater;
 
     private:
         void keepReference(const SimpleStreamHelperPtr& ptr);
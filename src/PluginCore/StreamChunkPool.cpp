@@ -0,0 +1,142 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include "AllocTracker.h"
+#include "StreamChunkPool.h"
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+using FB::StreamChunkPool;
+
+namespace {
+    // The classes bracket the block sizes the stream paths actually use: the NPAPI
+    // advertise window ranges 16-256KB, the ActiveX scatter block floor is 256KB and
+    // SimpleStreamHelper accumulates in 128KB blocks.  Requests above the largest class
+    // are rare enough that plain new[] is fine for them.
+    const std::size_t ClassSizes[] = { 16*1024, 64*1024, 256*1024, 1024*1024 };
+    const std::size_t ClassCount = sizeof(ClassSizes) / sizeof(ClassSizes[0]);
+
+    // Per class, at most this many bytes sit idle in the pool; beyond that freed blocks
+    // go back to the heap so a burst of parallel downloads doesn't pin memory forever
+    const std::size_t MaxCachedBytesPerClass = 4 * 1024 * 1024;
+
+    // Quiet-period watermark: trim() releases idle blocks beyond this, so burst
+    // growth up to MaxCachedBytesPerClass is given back once nothing needs it
+    const std::size_t IdleCachedBytesPerClass = 1 * 1024 * 1024;
+
+    struct SizeClass {
+        boost::mutex mutex;
+        std::vector<char*> freeBlocks;
+    };
+    SizeClass g_classes[ClassCount];
+
+    // Index of the smallest class that fits, or ClassCount if none does
+    inline std::size_t classFor(std::size_t size) {
+        std::size_t cls = 0;
+        while (cls < ClassCount && ClassSizes[cls] < size)
+            ++cls;
+        return cls;
+    }
+
+    char* obtain(std::size_t cls) {
+        FB::AllocTracker::recordAlloc(FB::AllocTracker::Subsystem_StreamChunk, ClassSizes[cls]);
+        {
+            SizeClass& sc = g_classes[cls];
+            boost::mutex::scoped_lock lock(sc.mutex);
+            if (!sc.freeBlocks.empty()) {
+                char* block = sc.freeBlocks.back();
+                sc.freeBlocks.pop_back();
+                return block;
+            }
+        }
+        return new char[ClassSizes[cls]];
+    }
+
+    void recycle(char* block, std::size_t cls) {
+        FB::AllocTracker::recordFree(FB::AllocTracker::Subsystem_StreamChunk, ClassSizes[cls]);
+        {
+            SizeClass& sc = g_classes[cls];
+            boost::mutex::scoped_lock lock(sc.mutex);
+            if ((sc.freeBlocks.size() + 1) * ClassSizes[cls] <= MaxCachedBytesPerClass) {
+                sc.freeBlocks.push_back(block);
+                return;
+            }
+        }
+        delete [] block;
+    }
+
+    // shared_array deleters; these outlive the pool call, so they carry the class index
+    struct chunk_deleter {
+        std::size_t cls;
+        explicit chunk_deleter(std::size_t c) : cls(c) {}
+        void operator()(char* block) const { recycle(block, cls); }
+    };
+    struct byte_chunk_deleter {
+        std::size_t cls;
+        explicit byte_chunk_deleter(std::size_t c) : cls(c) {}
+        void operator()(unsigned char* block) const { recycle(reinterpret_cast<char*>(block), cls); }
+    };
+
+    // Oversize blocks bypass the size classes, but their bytes still count
+    template<typename T>
+    struct big_chunk_deleter {
+        std::size_t size;
+        explicit big_chunk_deleter(std::size_t s) : size(s) {}
+        void operator()(T* block) const {
+            FB::AllocTracker::recordFree(FB::AllocTracker::Subsystem_StreamChunk, size);
+            delete [] block;
+        }
+    };
+}
+
+boost::shared_array<char> StreamChunkPool::allocate(std::size_t size)
+{
+    const std::size_t cls = classFor(size);
+    if (cls == ClassCount) {
+        FB::AllocTracker::recordAlloc(FB::AllocTracker::Subsystem_StreamChunk, size);
+        return boost::shared_array<char>(new char[size], big_chunk_deleter<char>(size));
+    }
+    return boost::shared_array<char>(obtain(cls), chunk_deleter(cls));
+}
+
+boost::shared_array<unsigned char> StreamChunkPool::allocateBytes(std::size_t size)
+{
+    const std::size_t cls = classFor(size);
+    if (cls == ClassCount) {
+        FB::AllocTracker::recordAlloc(FB::AllocTracker::Subsystem_StreamChunk, size);
+        return boost::shared_array<unsigned char>(new unsigned char[size], big_chunk_deleter<unsigned char>(size));
+    }
+    return boost::shared_array<unsigned char>(
+        reinterpret_cast<unsigned char*>(obtain(cls)), byte_chunk_deleter(cls));
+}
+
+/*static*/ void StreamChunkPool::trim()
+{
+    for (std::size_t cls = 0; cls < ClassCount; ++cls) {
+        std::vector<char*> doomed;
+        {
+            SizeClass& sc = g_classes[cls];
+            boost::mutex::scoped_lock lock(sc.mutex);
+            while (sc.freeBlocks.size() * ClassSizes[cls] > IdleCachedBytesPerClass) {
+                doomed.push_back(sc.freeBlocks.back());
+                sc.freeBlocks.pop_back();
+            }
+        }
+        // actual frees happen outside the lock; an allocation racing with the
+        // trim never waits on the heap
+        for (std::size_t i = 0; i < doomed.size(); ++i)
+            delete [] doomed[i];
+    }
+}
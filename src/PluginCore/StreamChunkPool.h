@@ -0,0 +1,81 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_STREAMCHUNKPOOL
+#define H_FB_STREAMCHUNKPOOL
+
+#include <cstddef>
+#include <boost/shared_array.hpp>
+
+namespace FB {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  StreamChunkPool
+    ///
+    /// @brief  Process-wide recycling pool for stream chunk buffers
+    ///
+    /// Every download path allocates mid-sized blocks at a steady clip -- the ActiveXStream
+    /// scatter blocks, the SimpleStreamHelper accumulation blocks, reorder copies in
+    /// SegmentedStreamHelper, the lazy copy behind StreamDataArrivedEvent::getSlice() -- and
+    /// with many streams active at once that churn fragments the heap badly.  This pool hands
+    /// the blocks out as shared_arrays whose deleter returns them to a size-classed free list,
+    /// so a block is recycled automatically the moment the last handler drops its slice, and
+    /// the same few blocks cycle through all active streams instead of each transfer chewing
+    /// through fresh heap.
+    ///
+    /// Requests are rounded up to the next size class; anything larger than the biggest class
+    /// falls through to a plain new[] with the default deleter.  The cached bytes per class are
+    /// capped, so an idle process gives surplus blocks back to the heap.  Small cross-thread
+    /// call records are a different problem with a different fix (see detail::ThreadCachedPool
+    /// in ScriptingCore); this pool only covers the multi-KB data blocks.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class StreamChunkPool
+    {
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn static boost::shared_array<char> StreamChunkPool::allocate(std::size_t size)
+        ///
+        /// @brief  Returns a block of at least size bytes; recycled into the pool when the last
+        ///         reference drops
+        ///
+        /// @param  size    Minimum usable size of the block in bytes
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static boost::shared_array<char> allocate(std::size_t size);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn static boost::shared_array<unsigned char> StreamChunkPool::allocateBytes(std::size_t size)
+        ///
+        /// @brief  Same pool, byte-typed; for the helpers that traffic in uint8_t blocks
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static boost::shared_array<unsigned char> allocateBytes(std::size_t size);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn static void StreamChunkPool::trim()
+        ///
+        /// @brief  Releases idle pooled blocks down to a per-class watermark
+        ///
+        /// The steady-state cap on the pool tolerates burst growth; this gives the excess back
+        /// to the heap once the process has gone quiet.  Run by the IdleScheduler; safe to call
+        /// from any thread.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static void trim();
+    };
+}
+
+#endif
@@ -0,0 +1,173 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include "BrowserHost.h"
+#include "utf8_tools.h"
+#include <boost/bind.hpp>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "BrowserStreamRequest.h"
+#include "StreamFileSink.h"
+
+using namespace FB;
+
+namespace {
+    int seekTo(FILE* file, size_t offset)
+    {
+#ifdef _WIN32
+        return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET);
+#else
+        return fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+    }
+
+    int extendTo(FILE* file, size_t size)
+    {
+#ifdef _WIN32
+        return _chsize_s(_fileno(file), static_cast<__int64>(size));
+#else
+        return ftruncate(fileno(file), static_cast<off_t>(size));
+#endif
+    }
+}
+
+StreamFileSinkPtr StreamFileSink::DownloadToFile( const FB::BrowserHostConstPtr& host,
+    const BrowserStreamRequest& req, const std::wstring& path, size_t queueCapacity /*= 64*/ )
+{
+    if (!host->isMainThread()) {
+        // Stream creation must happen on the main thread
+        return host->CallOnMainThread(boost::bind(&DownloadToFile, host, req, path, queueCapacity));
+    }
+    StreamFileSinkPtr ptr(boost::make_shared<StreamFileSink>(path, queueCapacity));
+    if (!ptr->good())
+        return StreamFileSinkPtr();
+    BrowserStreamRequest sinkReq(req);
+    sinkReq.setEventSink(ptr);
+    host->createStream(sinkReq, false);
+    return ptr;
+}
+
+StreamFileSink::StreamFileSink( const std::wstring& path, size_t queueCapacity /*= 64*/ )
+    : m_file(NULL), m_fileOk(false), m_queue(queueCapacity),
+      m_finished(false), m_failed(false), m_succeeded(false)
+{
+#ifdef _WIN32
+    m_file = _wfopen(path.c_str(), L"wb");
+#else
+    m_file = fopen(FB::wstring_to_utf8(path).c_str(), "wb");
+#endif
+    m_fileOk = (m_file != NULL);
+    if (m_fileOk) {
+        m_thread = boost::thread(boost::bind(&StreamFileSink::writerLoop, this));
+    }
+}
+
+StreamFileSink::~StreamFileSink()
+{
+    if (m_thread.joinable()) {
+        if (!m_finished)
+            sendSentinel(false);
+        m_thread.join();
+    }
+    if (m_file) {
+        fclose(m_file);
+    }
+}
+
+bool StreamFileSink::waitForCompletion()
+{
+    if (m_thread.joinable())
+        m_thread.join();
+    return m_succeeded && !m_failed;
+}
+
+bool StreamFileSink::onStreamOpened( FB::StreamOpenedEvent *evt, FB::BrowserStream *stream )
+{
+    if (m_fileOk && !m_finished && stream->getLength()) {
+        // Let the writer extend the file to its final size before any data lands, so the
+        // seeks below always write into already-allocated extents
+        WriteJob job;
+        job.preallocSize = stream->getLength();
+        m_queue.push(job);
+    }
+    return false;
+}
+
+bool StreamFileSink::onStreamDataArrived( FB::StreamDataArrivedEvent *evt, FB::BrowserStream *stream )
+{
+    if (!m_fileOk || m_finished)
+        return false;
+    WriteJob job;
+    // Shares ownership of the sender's block where possible; only NPAPI's transient
+    // browser buffers are copied here
+    job.slice = evt->getSlice();
+    job.offset = evt->getDataPosition();
+    // push() waits when the ring is full, which is the backpressure that keeps a slow disk
+    // from buffering the whole download in memory
+    m_queue.push(job);
+    return false;
+}
+
+bool StreamFileSink::onStreamCompleted( FB::StreamCompletedEvent *evt, FB::BrowserStream *stream )
+{
+    if (m_fileOk && !m_finished)
+        sendSentinel(evt->success);
+    return DefaultBrowserStreamHandler::onStreamCompleted(evt, stream);
+}
+
+bool StreamFileSink::onStreamFailedOpen( FB::StreamFailedOpenEvent *evt, FB::BrowserStream *stream )
+{
+    if (m_fileOk && !m_finished)
+        sendSentinel(false);
+    return DefaultBrowserStreamHandler::onStreamFailedOpen(evt, stream);
+}
+
+void StreamFileSink::sendSentinel( bool success )
+{
+    WriteJob job;
+    job.last = true;
+    job.success = success;
+    m_queue.push(job);
+    m_finished = true;
+}
+
+void StreamFileSink::writerLoop()
+{
+    for (;;) {
+        WriteJob job;
+        m_queue.wait_and_pop(job);
+        if (job.last) {
+            m_succeeded = job.success;
+            break;
+        }
+        if (job.preallocSize) {
+            // Preallocation is an optimization; if it fails the writes below still extend the file
+            extendTo(m_file, job.preallocSize);
+            continue;
+        }
+        if (!job.slice.size())
+            continue;
+        if (seekTo(m_file, job.offset) != 0
+            || fwrite(job.slice.data(), 1, job.slice.size(), m_file) != job.slice.size()) {
+            m_failed = true;
+        }
+    }
+    fclose(m_file);
+    m_file = NULL;
+}
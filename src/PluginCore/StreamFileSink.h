@@ -0,0 +1,105 @@
+#pragma once
+#ifndef StreamFileSink_h__
+#define StreamFileSink_h__
+
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <cstdio>
+#include <string>
+#include <boost/thread.hpp>
+#include "DefaultBrowserStreamHandler.h"
+#include "BoundedSafeQueue.h"
+
+namespace FB {
+    FB_FORWARD_PTR(StreamFileSink);
+    FB_FORWARD_PTR(BrowserHost);
+    class BrowserStreamRequest;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  StreamFileSink
+    ///
+    /// @brief  Stream handler that writes a download to a file from a background thread.
+    ///
+    /// Writing to disk from inside StreamDataArrivedEvent stalls the browser's event pump for
+    /// the duration of the write.  This sink instead hands each arriving chunk (as a refcounted
+    /// StreamDataSlice, so nothing is copied when the host already owns the block) to a writer
+    /// thread over a bounded lock-free queue; the writer seeks and writes, so out-of-order
+    /// range data lands in the right place.  When the stream length is known up front the file
+    /// is extended to its final size before the first write, so the writer appends into
+    /// preallocated extents instead of growing the file chunk by chunk.
+    ///
+    /// Attach an instance to a stream with BrowserStreamRequest::setEventSink, or use
+    /// DownloadToFile which does that and creates the stream in one call.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class StreamFileSink : public DefaultBrowserStreamHandler
+    {
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn static StreamFileSinkPtr DownloadToFile(const FB::BrowserHostConstPtr& host, const BrowserStreamRequest& req, const std::wstring& path, size_t queueCapacity = 64)
+        ///
+        /// @brief  Creates the sink, sets it as the request's event sink, and creates the stream.
+        ///         Returns an empty pointer if the target file could not be opened.  Safe to call
+        ///         from any thread.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static StreamFileSinkPtr DownloadToFile(const FB::BrowserHostConstPtr& host,
+            const BrowserStreamRequest& req, const std::wstring& path, size_t queueCapacity = 64);
+
+        StreamFileSink(const std::wstring& path, size_t queueCapacity = 64);
+        virtual ~StreamFileSink();
+
+        /// true if the target file was opened successfully
+        bool good() const { return m_fileOk; }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool waitForCompletion()
+        ///
+        /// @brief  Blocks until the writer thread has drained the queue and closed the file;
+        ///         returns true if the stream completed successfully and every write succeeded.
+        ///         Don't call this from the main thread before the stream has completed.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool waitForCompletion();
+
+    public:
+        virtual bool onStreamOpened(FB::StreamOpenedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamFailedOpen(FB::StreamFailedOpenEvent *evt, FB::BrowserStream *);
+
+    protected:
+        // One unit of work for the writer thread; plain flags instead of a class hierarchy so
+        // it can travel through the queue by value
+        struct WriteJob {
+            StreamDataSlice slice;
+            size_t offset;
+            size_t preallocSize;    // when non-zero, extend the file to this size
+            bool last;              // sentinel; success below is the stream result
+            bool success;
+            WriteJob() : offset(0), preallocSize(0), last(false), success(false) {}
+        };
+
+        void writerLoop();
+        void sendSentinel(bool success);
+
+        FILE* m_file;               // owned by the writer thread once it starts
+        bool m_fileOk;
+        BoundedSafeQueue<WriteJob, BlockWaitStrategy> m_queue;
+        boost::thread m_thread;
+        bool m_finished;            // main thread: sentinel already queued
+        bool m_failed;              // writer thread: a write went wrong
+        bool m_succeeded;           // writer thread: final result
+    };
+};
+
+#endif // StreamFileSink_h__
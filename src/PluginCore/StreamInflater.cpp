@@ -0,0 +1,133 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <cstring>
+#include <boost/algorithm/string.hpp>
+#include "fb_features.h"
+#ifndef FB_NO_STREAM_INFLATE
+#include <zlib.h>
+#endif
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "StreamInflater.h"
+
+namespace {
+    // Decoded output is drained into a stack buffer this big per inflate call;
+    // arriving network blocks are a few hundred KB at most, so even highly
+    // compressible data only loops a handful of times
+    const size_t k_INFLATE_CHUNK = 16 * 1024;
+}
+
+struct FB::StreamInflater::Impl {
+#ifndef FB_NO_STREAM_INFLATE
+    z_stream zs;
+    bool first;     // no output yet; a raw-deflate retry is still possible
+    bool done;
+    bool failed;
+#endif
+};
+
+#ifndef FB_NO_STREAM_INFLATE
+
+FB::StreamInflater::StreamInflater() : impl(new Impl)
+{
+    memset(&impl->zs, 0, sizeof(impl->zs));
+    // 15+32 makes zlib detect the gzip or zlib wrapper from the stream itself
+    impl->failed = (inflateInit2(&impl->zs, 15 + 32) != Z_OK);
+    impl->first = true;
+    impl->done = false;
+}
+
+FB::StreamInflater::~StreamInflater()
+{
+    inflateEnd(&impl->zs);
+    delete impl;
+}
+
+bool FB::StreamInflater::canDecode(const std::string& contentEncoding)
+{
+    std::string enc(contentEncoding);
+    boost::algorithm::trim(enc);
+    return boost::algorithm::iequals(enc, "gzip")
+        || boost::algorithm::iequals(enc, "x-gzip")
+        || boost::algorithm::iequals(enc, "deflate");
+}
+
+bool FB::StreamInflater::feed(const uint8_t* data, size_t len, std::vector<uint8_t>& out)
+{
+    if (impl->failed)
+        return false;
+    if (impl->done || !len)
+        return true;
+
+    impl->zs.next_in = (Bytef*)const_cast<uint8_t*>(data);
+    impl->zs.avail_in = len;
+    char buf[k_INFLATE_CHUNK];
+    while (impl->zs.avail_in && !impl->done) {
+        impl->zs.next_out = (Bytef*)buf;
+        impl->zs.avail_out = sizeof(buf);
+        int rc = inflate(&impl->zs, Z_NO_FLUSH);
+        if (rc == Z_DATA_ERROR && impl->first) {
+            // Some servers send a raw deflate stream under Content-Encoding:
+            // deflate; nothing has been decoded yet, so retry the whole block
+            // without expecting a wrapper
+            inflateEnd(&impl->zs);
+            memset(&impl->zs, 0, sizeof(impl->zs));
+            if (inflateInit2(&impl->zs, -15) != Z_OK) {
+                impl->failed = true;
+                return false;
+            }
+            impl->first = false;
+            impl->zs.next_in = (Bytef*)const_cast<uint8_t*>(data);
+            impl->zs.avail_in = len;
+            continue;
+        }
+        if (rc != Z_OK && rc != Z_STREAM_END) {
+            impl->failed = true;
+            return false;
+        }
+        impl->first = false;
+        size_t produced = sizeof(buf) - impl->zs.avail_out;
+        if (produced)
+            out.insert(out.end(), (uint8_t*)buf, (uint8_t*)buf + produced);
+        if (rc == Z_STREAM_END)
+            impl->done = true;
+    }
+    return true;
+}
+
+bool FB::StreamInflater::done() const
+{
+    return impl->done;
+}
+
+bool FB::StreamInflater::failed() const
+{
+    return impl->failed;
+}
+
+#else // FB_NO_STREAM_INFLATE
+
+// Built without zlib: canDecode() vetoes everything, so the other methods are
+// only stubs to keep the link happy
+
+FB::StreamInflater::StreamInflater() : impl(NULL) { }
+FB::StreamInflater::~StreamInflater() { }
+
+bool FB::StreamInflater::canDecode(const std::string&) { return false; }
+bool FB::StreamInflater::feed(const uint8_t*, size_t, std::vector<uint8_t>&) { return false; }
+bool FB::StreamInflater::done() const { return false; }
+bool FB::StreamInflater::failed() const { return true; }
+
+#endif // FB_NO_STREAM_INFLATE
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef StreamInflater_h__
+#define StreamInflater_h__
+
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include "fb_stdint.h"
+
+namespace FB {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  StreamInflater
+    ///
+    /// @brief  Streaming zlib inflate stage for Content-Encoding: gzip/deflate bodies
+    ///
+    /// Feed each arriving block in order; decoded output comes back a chunk at a time, so a
+    /// compressed body is never accumulated before decoding.  The gzip and zlib wrappers are
+    /// auto-detected, and servers that (incorrectly but commonly) send a raw deflate stream
+    /// under Content-Encoding: deflate are handled by retrying the first block without a
+    /// wrapper.
+    ///
+    /// When FireBreath is built without zlib (see FB_NO_STREAM_INFLATE in fb_features.h)
+    /// canDecode() always returns false, so no caller ever constructs the stage.
+    ///
+    /// @see FB::SimpleStreamHelper
+    /// @see FB::BrowserStreamRequest::setAcceptCompressed
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class StreamInflater : boost::noncopyable
+    {
+    public:
+        StreamInflater();
+        ~StreamInflater();
+
+        /// True for encodings this stage can decode: "gzip", "x-gzip" and "deflate"
+        static bool canDecode(const std::string& contentEncoding);
+
+        /// Decodes one arriving block, appending the decoded bytes to out (out is not
+        /// cleared first).  Returns false when the compressed data is corrupt; the
+        /// inflater is dead from then on
+        bool feed(const uint8_t* data, size_t len, std::vector<uint8_t>& out);
+
+        /// True once the end of the compressed stream has been seen
+        bool done() const;
+        /// True after a feed() has failed
+        bool failed() const;
+
+    private:
+        struct Impl;
+        Impl* impl;
+    };
+};
+
+#endif // StreamInflater_h__
@@ -0,0 +1,197 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+#include <algorithm>
+#include "StreamRangeScheduler.h"
+
+using namespace FB;
+
+StreamRangeScheduler::StreamRangeScheduler(size_t maxOutstanding)
+    : m_maxOutstanding(maxOutstanding ? maxOutstanding : 1), m_playhead(0)
+{
+}
+
+StreamRangeScheduler::~StreamRangeScheduler()
+{
+}
+
+bool StreamRangeScheduler::requestRange(size_t start, size_t end)
+{
+    if ( end <= start ) return false;
+
+    boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+    BrowserStreamPtr stream(getStream());
+    if ( stream && !stream->isSeekable() ) return false;
+
+    enqueueRange( Range(start, end) );
+    pump();
+    return true;
+}
+
+void StreamRangeScheduler::setPlayhead(size_t pos)
+{
+    boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+    m_playhead = pos;
+}
+
+void StreamRangeScheduler::setMaxOutstanding(size_t count)
+{
+    boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+    m_maxOutstanding = count ? count : 1;
+    pump();
+}
+
+void StreamRangeScheduler::cancelPending()
+{
+    boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+    m_pending.clear();
+}
+
+size_t StreamRangeScheduler::getPendingCount() const
+{
+    boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+    return m_pending.size();
+}
+
+size_t StreamRangeScheduler::getOutstandingCount() const
+{
+    boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+    return m_outstanding.size();
+}
+
+void StreamRangeScheduler::enqueueRange(const Range& range)
+{
+    // Keep m_pending sorted by start offset, then merge the new range with every pending
+    // range it overlaps or touches so the host never sees redundant requests
+    std::vector<Range>::iterator it = m_pending.begin();
+    while ( it != m_pending.end() && it->start < range.start ) ++it;
+    it = m_pending.insert( it, range );
+
+    if ( it != m_pending.begin() ) --it;
+    while ( (it + 1) != m_pending.end() )
+    {
+        std::vector<Range>::iterator next = it + 1;
+        if ( it->end >= next->start )
+        {
+            it->end = std::max( it->end, next->end );
+            m_pending.erase( next );
+        }
+        else if ( next->start > range.end )
+        {
+            break;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+size_t StreamRangeScheduler::distanceToPlayhead(const Range& range) const
+{
+    if ( m_playhead >= range.start && m_playhead < range.end ) return 0;
+    if ( range.start > m_playhead ) return range.start - m_playhead;
+    return m_playhead - range.end;
+}
+
+void StreamRangeScheduler::pump()
+{
+    BrowserStreamPtr stream(getStream());
+    if ( !stream || !stream->isOpen() || !stream->isSeekable() ) return;
+
+    while ( m_outstanding.size() < m_maxOutstanding && !m_pending.empty() )
+    {
+        // Issue the pending range nearest the playhead first
+        size_t best = 0;
+        size_t bestDist = distanceToPlayhead( m_pending[0] );
+        for ( size_t i = 1; i < m_pending.size(); ++i )
+        {
+            size_t dist = distanceToPlayhead( m_pending[i] );
+            if ( dist < bestDist )
+            {
+                best = i;
+                bestDist = dist;
+            }
+        }
+
+        Range next = m_pending[best];
+        m_pending.erase( m_pending.begin() + best );
+        m_outstanding.push_back( next );
+        if ( !stream->readRanges( std::vector<Range>( 1, next ) ) )
+        {
+            // Host refused the request; requeue the range and stop pumping for now
+            m_outstanding.pop_back();
+            enqueueRange( next );
+            break;
+        }
+    }
+}
+
+bool StreamRangeScheduler::onStreamOpened(FB::StreamOpenedEvent *evt, FB::BrowserStream *)
+{
+    boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+    pump();
+    return false;
+}
+
+bool StreamRangeScheduler::onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *)
+{
+    boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+
+    // Retire the arrived bytes from whichever in-flight range they belong to; the host
+    // delivers each request front to back, so advancing the range start is enough
+    const size_t offset = evt->getDataPosition();
+    const size_t end = offset + evt->getLength();
+    bool retired = false;
+    std::vector<Range>::iterator it = m_outstanding.begin();
+    while ( it != m_outstanding.end() )
+    {
+        if ( offset <= it->start && end > it->start )
+        {
+            it->start = std::min( it->end, end );
+        }
+        if ( it->start >= it->end )
+        {
+            it = m_outstanding.erase( it );
+            retired = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    if ( retired ) pump();
+    return false;
+}
+
+bool StreamRangeScheduler::onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *stream)
+{
+    {
+        boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+        m_pending.clear();
+        m_outstanding.clear();
+    }
+    return DefaultBrowserStreamHandler::onStreamCompleted(evt, stream);
+}
+
+bool StreamRangeScheduler::onStreamFailedOpen(FB::StreamFailedOpenEvent *evt, FB::BrowserStream *stream)
+{
+    {
+        boost::recursive_mutex::scoped_lock lock(m_xtmutex);
+        m_pending.clear();
+        m_outstanding.clear();
+    }
+    return DefaultBrowserStreamHandler::onStreamFailedOpen(evt, stream);
+}
@@ -0,0 +1,105 @@
+#pragma once
+#ifndef StreamRangeScheduler_h__
+#define StreamRangeScheduler_h__
+
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <vector>
+#include <boost/thread/recursive_mutex.hpp>
+#include "DefaultBrowserStreamHandler.h"
+
+namespace FB {
+    FB_FORWARD_PTR(StreamRangeScheduler);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  StreamRangeScheduler
+    ///
+    /// @brief  Scheduling layer on top of BrowserStream::readRanges for seekable streams.
+    ///
+    /// Plugins that stream seekable media tend to issue many small, overlapping range requests
+    /// and then throttle them by hand.  This handler centralizes that: requested ranges are
+    /// queued and coalesced (overlapping and adjacent ranges are merged), at most
+    /// setMaxOutstanding() requests are in flight against the host at any time, and when a slot
+    /// frees up the pending range closest to the playhead (see setPlayhead) is issued next.
+    ///
+    /// Attach an instance to a seekable BrowserStream with AttachObserver and call
+    /// requestRange() instead of BrowserStream::readRange; the requested data is delivered
+    /// through the usual StreamDataArrivedEvent.  Derive from this class and override
+    /// onStreamDataArrived to consume it (call the base implementation so the scheduler can
+    /// retire in-flight ranges and issue new ones).
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class StreamRangeScheduler : public DefaultBrowserStreamHandler
+    {
+    public:
+        StreamRangeScheduler(size_t maxOutstanding = 4);
+        virtual ~StreamRangeScheduler();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool requestRange(size_t start, size_t end)
+        ///
+        /// @brief  Queues the range [start, end) for download, merging it with any pending range
+        ///         it overlaps or touches, and issues requests while in-flight slots are free.
+        ///
+        /// @return false if the range is empty or no seekable stream is attached, else true
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool requestRange(size_t start, size_t end);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setPlayhead(size_t pos)
+        ///
+        /// @brief  Tells the scheduler where playback currently is; pending ranges closest to
+        ///         this position are issued first
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setPlayhead(size_t pos);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setMaxOutstanding(size_t count)
+        ///
+        /// @brief  Limits how many range requests may be in flight at once (minimum 1); raising
+        ///         the limit issues queued ranges immediately
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setMaxOutstanding(size_t count);
+
+        /// Drops all queued (not yet issued) ranges; in-flight requests are unaffected
+        void cancelPending();
+
+        /// Number of coalesced ranges waiting to be issued
+        size_t getPendingCount() const;
+        /// Number of range requests currently in flight
+        size_t getOutstandingCount() const;
+
+    public:
+        virtual bool onStreamOpened(FB::StreamOpenedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamFailedOpen(FB::StreamFailedOpenEvent *evt, FB::BrowserStream *);
+
+    protected:
+        typedef BrowserStream::Range Range;
+
+        // Must be called with m_xtmutex held
+        void enqueueRange(const Range& range);
+        void pump();
+        size_t distanceToPlayhead(const Range& range) const;
+
+        std::vector<Range> m_pending;       // coalesced, sorted by start offset
+        std::vector<Range> m_outstanding;   // issued to the host, not yet fully arrived
+        size_t m_maxOutstanding;
+        size_t m_playhead;
+        mutable boost::recursive_mutex m_xtmutex;
+    };
+};
+
+#endif // StreamRangeScheduler_h__
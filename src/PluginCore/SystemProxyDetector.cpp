@@ -0,0 +1,82 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include "URI.h"
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "SystemProxyDetector.h"
+
+using namespace FB;
+
+std::string SystemProxyDetector::origin_of(const std::string& URL) const
+{
+    FB::URI uri(FB::URI::fromString(URL));
+    std::ostringstream os;
+    os << uri.protocol << "://" << uri.domain << ":" << uri.port;
+    return os.str();
+}
+
+bool SystemProxyDetector::detectProxy(std::map<std::string, std::string>& proxyMap, const std::string& URL)
+{
+    std::string origin(origin_of(URL));
+    time_t now = std::time(NULL);
+    {
+        boost::mutex::scoped_lock lock(m_cacheMutex);
+        std::map<std::string, CachedDecision>::const_iterator fnd = m_cache.find(origin);
+        if (fnd != m_cache.end() && now < fnd->second.expires) {
+            proxyMap = fnd->second.proxyMap;
+            return fnd->second.hasProxy;
+        }
+    }
+
+    // Miss or expired: run the platform query outside the lock, since PAC
+    // evaluation may block.  Two threads racing here just do the work twice.
+    std::map<std::string, std::string> fresh;
+    bool hasProxy = detectProxySystem(fresh, URL);
+    {
+        boost::mutex::scoped_lock lock(m_cacheMutex);
+        CachedDecision& dec = m_cache[origin];
+        dec.hasProxy = hasProxy;
+        dec.proxyMap = fresh;
+        dec.expires = now + kCacheTtlSec;
+    }
+    proxyMap = fresh;
+    return hasProxy;
+}
+
+void SystemProxyDetector::invalidateCache()
+{
+    boost::mutex::scoped_lock lock(m_cacheMutex);
+    m_cache.clear();
+}
+
+namespace {
+    void warmup_thread(SystemProxyDetector* detector, std::string URL)
+    {
+        std::map<std::string, std::string> ignored;
+        try {
+            detector->detectProxy(ignored, URL);
+        } catch (...) { }
+    }
+}
+
+void SystemProxyDetector::warmup(const std::string& URL)
+{
+    if (URL.empty()) return;
+    // Detached; the detector is a process-lifetime singleton so the thread can
+    // safely outlive the caller
+    boost::thread t(boost::bind(&warmup_thread, this, URL));
+}
@@ -1,9 +1,11 @@
 #ifndef SystemProxyDetector_h__
 #define SystemProxyDetector_h__
 
+#include <ctime>
 #include <map>
 #include <string>
 #include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace FB {
 
@@ -11,11 +13,39 @@ namespace FB {
     protected:
         SystemProxyDetector() {}
 
+        // Platform query (registry/PAC/environment); potentially slow -- PAC
+        // evaluation can block for hundreds of milliseconds -- so it is only
+        // called on a cache miss
+        virtual bool detectProxySystem(std::map<std::string, std::string>& proxyMap, const std::string& URL) = 0;
+
     public:
         virtual ~SystemProxyDetector() {}
         static SystemProxyDetector* get();
 
-        virtual bool detectProxy(std::map<std::string, std::string>& proxyMap, const std::string& URL) = 0;
+        // Proxy decision for the URL, cached per origin with a TTL so request
+        // paths don't re-run system proxy discovery every time
+        bool detectProxy(std::map<std::string, std::string>& proxyMap, const std::string& URL);
+
+        // Drops every cached decision; call from a platform proxy-settings
+        // change notification (or whenever stale decisions are suspected)
+        void invalidateCache();
+
+        // Runs proxy detection for the URL's origin on a background thread so
+        // the first real request finds the decision already cached
+        void warmup(const std::string& URL);
+
+    private:
+        struct CachedDecision {
+            bool hasProxy;
+            std::map<std::string, std::string> proxyMap;
+            time_t expires;
+        };
+        static const unsigned int kCacheTtlSec = 300;
+
+        std::string origin_of(const std::string& URL) const;
+
+        boost::mutex m_cacheMutex;
+        std::map<std::string, CachedDecision> m_cache;
     };
 
 };
@@ -0,0 +1,109 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <boost/bind.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "PluginWindow.h"
+#include "ThreadedRenderService.h"
+
+using namespace FB;
+
+ThreadedRenderService::ThreadedRenderService(PluginWindow* window, const RenderCallback& cb, long targetFps)
+    : m_window(window), m_cb(cb)
+    , m_frameIntervalMs(targetFps > 0 ? 1000 / targetFps : 16)
+    , m_width(0), m_height(0), m_running(false)
+{
+    if (m_frameIntervalMs < 1)
+        m_frameIntervalMs = 1;
+}
+
+ThreadedRenderService::~ThreadedRenderService()
+{
+    stop();
+}
+
+void ThreadedRenderService::start()
+{
+    boost::mutex::scoped_lock lock(m_mut);
+    if (m_running)
+        return;
+    m_running = true;
+    m_thread.reset(new boost::thread(boost::bind(&ThreadedRenderService::run, this)));
+}
+
+void ThreadedRenderService::stop()
+{
+    {
+        boost::mutex::scoped_lock lock(m_mut);
+        if (!m_running)
+            return;
+        m_running = false;
+    }
+    m_thread->join();
+    m_thread.reset();
+}
+
+void ThreadedRenderService::resized(uint32_t width, uint32_t height)
+{
+    boost::mutex::scoped_lock lock(m_mut);
+    m_width = width;
+    m_height = height;
+}
+
+const ThreadedRenderService::Frame* ThreadedRenderService::beginPresent()
+{
+    return m_pool.beginPresent();
+}
+
+void ThreadedRenderService::endPresent()
+{
+    m_pool.endPresent();
+}
+
+void ThreadedRenderService::run()
+{
+    while (true) {
+        boost::system_time frameStart = boost::get_system_time();
+        uint32_t w, h;
+        {
+            boost::mutex::scoped_lock lock(m_mut);
+            if (!m_running)
+                return;
+            w = m_width;
+            h = m_height;
+        }
+
+        if (w && h) {
+            // (re)size the slot we're about to draw into; the others are fixed up
+            // when their turn comes, so a resize never touches a presenting frame
+            Frame& frame = m_pool.renderBuffer();
+            if (frame.width != w || frame.height != h) {
+                frame.width = w;
+                frame.height = h;
+                frame.stride = w * 4;
+                frame.pixels.assign(frame.stride * h, 0);
+            }
+            if (m_cb(frame)) {
+                m_pool.publish();
+                FB::Rect full = { 0, 0,
+                    static_cast<int32_t>(h), static_cast<int32_t>(w) };
+                m_window->invalidateRect(full);
+            }
+        }
+
+        boost::system_time next = frameStart + boost::posix_time::milliseconds(m_frameIntervalMs);
+        boost::this_thread::sleep(next);
+    }
+}
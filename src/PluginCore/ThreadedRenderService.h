@@ -0,0 +1,114 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_THREADEDRENDERSERVICE
+#define H_FB_THREADEDRENDERSERVICE
+
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include "APITypes.h"
+#include "AsyncDrawBufferPool.h"
+
+namespace FB {
+
+    FB_FORWARD_PTR(ThreadedRenderService);
+    class PluginWindow;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  ThreadedRenderService
+    ///
+    /// @brief  Renders windowless plugin frames on a dedicated thread
+    ///
+    /// Windowless plugins normally paint synchronously inside the browser's paint callback,
+    /// so a slow frame stalls the browser and browser paint jitter stalls the plugin.  This
+    /// service runs the plugin's render callback on its own thread at a target frame rate,
+    /// drawing into software frames (premultiplied BGRA) rotated through an
+    /// AsyncDrawBufferPool, and asks the window to invalidate after each completed frame.
+    /// The paint callback then only blits the newest finished frame via
+    /// beginPresent()/endPresent() -- see PluginWindowlessWin::HandleDraw.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class ThreadedRenderService : boost::noncopyable
+    {
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct Frame
+        ///
+        /// @brief  One software frame: premultiplied BGRA pixels, top-down, stride = width * 4
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct Frame {
+            Frame() : width(0), height(0), stride(0) {}
+            std::vector<unsigned char> pixels;
+            uint32_t width;
+            uint32_t height;
+            uint32_t stride;
+        };
+
+        /// @brief  Draws one frame; return false to skip publishing (nothing changed)
+        typedef boost::function<bool (Frame&)> RenderCallback;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn ThreadedRenderService::ThreadedRenderService(PluginWindow* window, const RenderCallback& cb, long targetFps = 60)
+        ///
+        /// @brief  Binds the service to a window and render callback; call start() to begin
+        ///
+        /// The window must outlive the service (in practice the window owns it).
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        ThreadedRenderService(PluginWindow* window, const RenderCallback& cb, long targetFps = 60);
+        ~ThreadedRenderService();
+
+        /// @brief  Starts the render thread; no-op if already running
+        void start();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void ThreadedRenderService::stop()
+        ///
+        /// @brief  Stops and joins the render thread; the callback will not run after this returns
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void stop();
+
+        /// @brief  Tells the render thread the window changed size; takes effect on the next frame
+        void resized(uint32_t width, uint32_t height);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn const Frame* ThreadedRenderService::beginPresent()
+        ///
+        /// @brief  Returns the newest completed frame for the paint callback to blit, or NULL
+        ///
+        /// The frame stays valid until endPresent(); the render thread keeps drawing into the
+        /// other pool surfaces meanwhile.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        const Frame* beginPresent();
+        void endPresent();
+
+    private:
+        void run();
+
+        PluginWindow* m_window;
+        RenderCallback m_cb;
+        long m_frameIntervalMs;
+        AsyncDrawBufferPool<Frame> m_pool;
+
+        boost::mutex m_mut;
+        uint32_t m_width, m_height;
+        bool m_running;
+        boost::scoped_ptr<boost::thread> m_thread;
+    };
+}
+
+#endif
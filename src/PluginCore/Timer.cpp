@@ -12,7 +12,7 @@ License:    Dual license model; choose one of two:
 \**********************************************************/
 
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
-#include <boost/asio.hpp>
+#include <boost/bind.hpp>
 #include "Timer.h"
 #include "TimerService.h"
 
@@ -21,23 +21,26 @@ using namespace FB;
 namespace FB {
     class TimerPimpl {
     public:
-        TimerPimpl() : timerService(TimerService::instance()), timer(*timerService->getIOService()) {
+        TimerPimpl() : timerService(TimerService::instance()), token(0), ns(0) {
         }
 
         TimerServicePtr timerService;
-		boost::asio::deadline_timer timer;
+        boost::uint64_t token;      // pending timeout in the service's timer wheel; 0 when idle
+        boost::uint64_t ns;         // namespace future timeouts are filed under; 0 = shared
     };
 };
 
-TimerPtr Timer::getTimer(long _duration, bool _recursive, TimerCallbackFunc _callback)
+TimerPtr Timer::getTimer(long _duration, bool _recursive, TimerCallbackFunc _callback, long _slack)
 {
-	return boost::shared_ptr<FB::Timer>(new Timer(_duration, _recursive, _callback));
+	return boost::shared_ptr<FB::Timer>(new Timer(_duration, _recursive, _callback, _slack));
 }
 
-Timer::Timer(long _duration, bool _recursive, TimerCallbackFunc _callback)
+Timer::Timer(long _duration, bool _recursive, TimerCallbackFunc _callback, long _slack)
 	: duration(_duration),
 	recursive(_recursive),
-	cb(_callback), pimpl(new TimerPimpl)
+	slack(_slack),
+	cb(_callback), pimpl(new TimerPimpl),
+	paused(false), wasRunning(false)
 {
 }
 
@@ -47,19 +50,12 @@ Timer::~Timer()
 }
 
 
-void Timer::callback(const boost::system::error_code& error)
+void Timer::onTimeout()
 {
-	if (error)
-	{
-		if (error == boost::asio::error::operation_aborted)
-		{
-			return;
-		}
-		// TODO: prompt timer Error.
-		return;
-	}
-
-	if (this->recursive)
+	pimpl->token = 0;
+	// checking paused here keeps a recursive timer from rescheduling itself
+	// from the timer thread after pause() already cancelled it
+	if (this->recursive && !this->paused)
 	{
 		this->start();
 	}
@@ -68,12 +64,46 @@ void Timer::callback(const boost::system::error_code& error)
 
 void Timer::start()
 {
-	pimpl->timer.expires_from_now(boost::posix_time::milliseconds(duration));
-	pimpl->timer.async_wait(boost::bind(&Timer::callback, this, boost::asio::placeholders::error));
+	paused = false;
+	if (pimpl->token)
+		pimpl->timerService->cancelTimeout(pimpl->token);
+	pimpl->token = pimpl->timerService->scheduleTimeout(duration,
+		boost::bind(&Timer::onTimeout, this), slack, pimpl->ns);
+}
+
+void Timer::setTimerNamespace(boost::uint64_t ns)
+{
+	pimpl->ns = ns;
 }
 bool Timer::stop()
 {
-	pimpl->timer.cancel();
+	if (pimpl->token)
+	{
+		pimpl->timerService->cancelTimeout(pimpl->token);
+		pimpl->token = 0;
+	}
 	return false;
 }
 
+void Timer::pause()
+{
+	if (paused)
+		return;
+	wasRunning = (pimpl->token != 0);
+	paused = true;
+	if (pimpl->token)
+	{
+		pimpl->timerService->cancelTimeout(pimpl->token);
+		pimpl->token = 0;
+	}
+}
+
+void Timer::resume()
+{
+	if (!paused)
+		return;
+	paused = false;
+	if (wasRunning)
+		this->start();
+}
+
@@ -18,7 +18,7 @@ License:    Dual license model; choose one of two:
 #include <boost/function.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
-#include <boost/system/error_code.hpp>
+#include <boost/cstdint.hpp>
 
 #include "FBPointers.h"
 
@@ -43,11 +43,14 @@ namespace FB {
 	private:
 		const long duration;
 		const bool recursive;
+		const long slack;
 		TimerCallbackFunc cb;
         boost::scoped_ptr<TimerPimpl> pimpl;
+		volatile bool paused;
+		bool wasRunning;
 
-		Timer(long _duration, bool _recursive, TimerCallbackFunc _callback);
-		void callback(const boost::system::error_code& error);
+		Timer(long _duration, bool _recursive, TimerCallbackFunc _callback, long _slack);
+		void onTimeout();
 
 	public:
         ~Timer();
@@ -55,7 +58,55 @@ namespace FB {
 		void start();
 		bool stop();
 
-		static TimerPtr getTimer(long _duration, bool _recursive, TimerCallbackFunc _callback);
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		/// @fn void pause()
+		///
+		/// @brief  Stops the timer but remembers whether it was running
+		///
+		/// Used by PluginCore to park pausable timers while the plugin instance is
+		/// suspended (hidden tab).  A paused one-shot timer restarts with its full
+		/// duration when resume() is called.
+		///
+		/// @since 1.7
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		void pause();
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		/// @fn void setTimerNamespace(boost::uint64_t ns)
+		///
+		/// @brief  Files future timeouts under the given TimerService namespace
+		///
+		/// PluginCore tags every timer it hands out with the instance's namespace so
+		/// that whatever is still pending when the instance goes away is cancelled in
+		/// one sweep.  Only affects timeouts scheduled after the call.
+		///
+		/// @since 1.7
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		void setTimerNamespace(boost::uint64_t ns);
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		/// @fn void resume()
+		///
+		/// @brief  Restarts the timer if it was running when pause() was called
+		///
+		/// @since 1.7
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		void resume();
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		/// @fn static TimerPtr getTimer(long _duration, bool _recursive, TimerCallbackFunc _callback, long _slack = 0)
+		///
+		/// @brief  Creates a timer; call start() to arm it
+		///
+		/// A non-zero _slack (in ms) tells the service the callback may run up to
+		/// that much late; timers sharing a slack value are coalesced into one
+		/// wakeup and fired in a single batched pass.  Use it for periodic
+		/// housekeeping that doesn't care about exact phase -- with many such
+		/// timers the saved wakeups are very visible in browser CPU.
+		///
+		/// @since 1.7 (_slack parameter)
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		static TimerPtr getTimer(long _duration, bool _recursive, TimerCallbackFunc _callback, long _slack = 0);
     };
 };
 
@@ -1,4 +1,4 @@
-/**********************************************************\ 
+/**********************************************************\
 Original Author: Mital Vora <mital.d.vora@gmail.com>
 
 Created:    Mar 26, 2011
@@ -15,28 +15,290 @@ License:    Dual license model; choose one of two:
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 #include "TimerService.h"
 #include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <list>
 
 using namespace FB;
 
 namespace FB {
     class TimerServicePimpl {
     public:
+        // Hierarchical timer wheel: one fine wheel at tick granularity plus three
+        // coarser overflow wheels that cascade into it.  Insert and cancel are O(1),
+        // and each wakeup hands every entry in the due slots to the timer thread as
+        // one batch, so thousands of outstanding timeouts cost no more per wakeup
+        // than a handful.  A single deadline_timer drives the wheel; it sleeps
+        // straight through empty slots to the next one that needs attention (and is
+        // pulled in again when a new timeout lands ahead of the pending wakeup), and
+        // stops when the wheel drains, so an idle service doesn't wake up at all.
+        // Timeouts scheduled with slack have their expiry aligned to a shared
+        // boundary, so everything inside one slack window shares a slot and fires in
+        // a single pass.
+        enum {
+            kTickMs     = 10,
+            kWheel0Bits = 8,
+            kWheel0Size = 1 << kWheel0Bits,             // one-tick slots: ~2.5s reach
+            kWheelBits  = 6,
+            kWheelSize  = 1 << kWheelBits,
+            kMaxBits    = kWheel0Bits + 3 * kWheelBits  // horizon in ticks (~7.7 days)
+        };
+
+        struct Entry {
+            boost::uint64_t id;
+            boost::uint64_t expiry;     // absolute tick number
+            boost::uint64_t ns;         // namespace tag; 0 = shared default
+            boost::function<void (void)> cb;
+        };
+        typedef std::list<Entry> Slot;
+        struct EntryRef {
+            Slot* slot;
+            Slot::iterator it;
+        };
+        typedef boost::unordered_map<boost::uint64_t, EntryRef> EntryMap;
+        typedef boost::unordered_map<boost::uint64_t, boost::unordered_set<boost::uint64_t> > NamespaceMap;
+
         TimerServicePimpl() :
             io_service(new boost::asio::io_service()),
             io_idlework(new boost::asio::io_service::work(*io_service)),
-            io_thread(NULL) {}
+            io_thread(NULL),
+            tick_timer(new boost::asio::deadline_timer(*io_service)),
+            current_tick(0),
+            wake_target(0),
+            next_id(1),
+            next_ns(1),
+            pending_count(0),
+            ticking(false) {}
 
         ~TimerServicePimpl() {
             io_service->stop();
             io_thread->join();
             io_idlework.reset();
             io_thread.reset();
+            tick_timer.reset();
             io_service.reset();
         }
 
+        boost::uint64_t schedule(long duration_ms, const boost::function<void (void)>& cb,
+                                 long slack_ms, boost::uint64_t ns) {
+            bool arm;
+            boost::uint64_t id;
+            {
+                boost::mutex::scoped_lock lock(wheel_mutex);
+                boost::uint64_t ticks = duration_ms <= 0 ? 1
+                    : (static_cast<boost::uint64_t>(duration_ms) + kTickMs - 1) / kTickMs;
+                Entry e;
+                id = e.id = next_id++;
+                e.expiry = current_tick + ticks;
+                boost::uint64_t slack_ticks = slack_ms > 0
+                    ? static_cast<boost::uint64_t>(slack_ms) / kTickMs : 0;
+                if (slack_ticks > 1) {
+                    // Round the expiry up to a multiple of the slack so every timeout
+                    // with the same slack lands in the same slot: one wakeup, one
+                    // batched pass.  Never fires early, at most slack_ms late.
+                    e.expiry = ((e.expiry + slack_ticks - 1) / slack_ticks) * slack_ticks;
+                }
+                e.ns = ns;
+                e.cb = cb;
+                place(e);
+                if (ns)
+                    namespaces[ns].insert(id);
+                ++pending_count;
+                // (re)arm if the wheel was idle, or if this landed ahead of the
+                // pending wakeup and the wait needs pulling in
+                arm = !ticking || e.expiry < wake_target;
+                ticking = true;
+            }
+            // the tick driver is only ever touched from the io thread
+            if (arm)
+                io_service->post(boost::bind(&TimerServicePimpl::startTick, this));
+            return id;
+        }
+
+        bool cancel(boost::uint64_t id) {
+            boost::mutex::scoped_lock lock(wheel_mutex);
+            EntryMap::iterator it = entries.find(id);
+            if (it == entries.end())
+                return false;
+            dropMember(it->second.it->ns, id);
+            it->second.slot->erase(it->second.it);
+            entries.erase(it);
+            --pending_count;
+            return true;
+        }
+
+        boost::uint64_t createNamespace() {
+            boost::mutex::scoped_lock lock(wheel_mutex);
+            return next_ns++;
+        }
+
+        std::size_t destroyNamespace(boost::uint64_t ns) {
+            if (!ns)
+                return 0;
+            boost::mutex::scoped_lock lock(wheel_mutex);
+            NamespaceMap::iterator nit = namespaces.find(ns);
+            if (nit == namespaces.end())
+                return 0;
+            std::size_t count = 0;
+            for (boost::unordered_set<boost::uint64_t>::iterator it = nit->second.begin();
+                 it != nit->second.end(); ++it) {
+                EntryMap::iterator eit = entries.find(*it);
+                if (eit == entries.end())
+                    continue;
+                eit->second.slot->erase(eit->second.it);
+                entries.erase(eit);
+                --pending_count;
+                ++count;
+            }
+            namespaces.erase(nit);
+            // an armed wait over a now-empty wheel just finds nothing due and parks
+            return count;
+        }
+
+    private:
+        // Unlinks id from its namespace's member set.  wheel_mutex must be held.
+        void dropMember(boost::uint64_t ns, boost::uint64_t id) {
+            if (!ns)
+                return;
+            NamespaceMap::iterator nit = namespaces.find(ns);
+            if (nit != namespaces.end())
+                nit->second.erase(id);
+        }
+
+        // Files e into the wheel whose granularity covers its delay and records
+        // where it went so cancel() can unlink it.  wheel_mutex must be held.
+        void place(const Entry& e) {
+            boost::uint64_t pe = e.expiry;
+            if (pe - current_tick >= (static_cast<boost::uint64_t>(1) << kMaxBits)) {
+                // beyond the horizon; park it in the furthest slot and let the
+                // cascade re-file it until the real expiry is within reach
+                pe = current_tick + (static_cast<boost::uint64_t>(1) << kMaxBits) - 1;
+            }
+            boost::uint64_t delta = pe - current_tick;
+            Slot* slot;
+            if (delta < static_cast<boost::uint64_t>(kWheel0Size))
+                slot = &wheel0[pe & (kWheel0Size - 1)];
+            else if (delta < (static_cast<boost::uint64_t>(1) << (kWheel0Bits + kWheelBits)))
+                slot = &wheel1[(pe >> kWheel0Bits) & (kWheelSize - 1)];
+            else if (delta < (static_cast<boost::uint64_t>(1) << (kWheel0Bits + 2 * kWheelBits)))
+                slot = &wheel2[(pe >> (kWheel0Bits + kWheelBits)) & (kWheelSize - 1)];
+            else
+                slot = &wheel3[(pe >> (kWheel0Bits + 2 * kWheelBits)) & (kWheelSize - 1)];
+            slot->push_back(e);
+            EntryRef ref = { slot, --slot->end() };
+            entries[e.id] = ref;
+        }
+
+        // Re-files everything in slot one wheel closer to expiry.  wheel_mutex held.
+        void cascadeSlot(Slot& slot) {
+            Slot tmp;
+            tmp.swap(slot);
+            for (Slot::iterator it = tmp.begin(); it != tmp.end(); ++it) {
+                entries.erase(it->id);
+                place(*it);
+            }
+        }
+
+        // Called when the fine wheel wraps; pulls the next slot of each coarser
+        // wheel down, outermost first.  wheel_mutex held.
+        void cascade() {
+            int idx1 = static_cast<int>((current_tick >> kWheel0Bits) & (kWheelSize - 1));
+            if (idx1 == 0) {
+                int idx2 = static_cast<int>((current_tick >> (kWheel0Bits + kWheelBits)) & (kWheelSize - 1));
+                if (idx2 == 0)
+                    cascadeSlot(wheel3[(current_tick >> (kWheel0Bits + 2 * kWheelBits)) & (kWheelSize - 1)]);
+                cascadeSlot(wheel2[idx2]);
+            }
+            cascadeSlot(wheel1[idx1]);
+        }
+
+        // Ticks until the next fine-wheel slot that needs attention: the first
+        // occupied one, or the wrap point where the coarser wheels cascade in.
+        // wheel_mutex must be held.
+        long nextSpan() const {
+            long span = 1;
+            for (;;) {
+                int idx = static_cast<int>((current_tick + span) & (kWheel0Size - 1));
+                if (idx == 0 || !wheel0[idx].empty())
+                    return span;
+                ++span;
+            }
+        }
+
+        void startTick() {
+            long span;
+            {
+                boost::mutex::scoped_lock lock(wheel_mutex);
+                if (!ticking)
+                    return;
+                span = nextSpan();
+                wake_target = current_tick + span;
+            }
+            // expires_from_now cancels a wait already in flight, so this doubles as
+            // the re-arm path when a new timeout lands ahead of the pending wakeup
+            tick_timer->expires_from_now(boost::posix_time::milliseconds(span * static_cast<long>(kTickMs)));
+            tick_timer->async_wait(boost::bind(&TimerServicePimpl::onTick, this,
+                                               boost::asio::placeholders::error));
+        }
+
+        void onTick(const boost::system::error_code& error) {
+            if (error)
+                return;     // superseded by a re-arm, or shutting down
+            Slot due;
+            bool more;
+            {
+                boost::mutex::scoped_lock lock(wheel_mutex);
+                // Walk every tick slept through.  The intermediate slots were empty
+                // when the wait was armed, but a timeout scheduled since may have
+                // landed in one of them; it joins this batch instead of being missed.
+                while (current_tick != wake_target) {
+                    ++current_tick;
+                    int idx0 = static_cast<int>(current_tick & (kWheel0Size - 1));
+                    if (idx0 == 0)
+                        cascade();
+                    Slot& slot = wheel0[idx0];
+                    for (Slot::iterator it = slot.begin(); it != slot.end(); ++it) {
+                        entries.erase(it->id);
+                        dropMember(it->ns, it->id);
+                    }
+                    pending_count -= slot.size();
+                    due.splice(due.end(), slot);
+                }
+                more = pending_count != 0;
+                ticking = more;
+            }
+            // deliver the whole batch outside the lock; a callback that schedules a
+            // new timeout finds ticking false on an emptied wheel and kicks us again
+            for (Slot::iterator it = due.begin(); it != due.end(); ++it) {
+                if (it->cb)
+                    it->cb();
+            }
+            if (more)
+                startTick();
+        }
+
+    public:
         boost::scoped_ptr<boost::asio::io_service> io_service;
         boost::scoped_ptr<boost::asio::io_service::work> io_idlework;
         boost::scoped_ptr<boost::thread> io_thread;
+
+    private:
+        boost::scoped_ptr<boost::asio::deadline_timer> tick_timer;
+
+        boost::mutex wheel_mutex;
+        Slot wheel0[kWheel0Size];
+        Slot wheel1[kWheelSize];
+        Slot wheel2[kWheelSize];
+        Slot wheel3[kWheelSize];
+        EntryMap entries;
+        NamespaceMap namespaces;
+        boost::uint64_t current_tick;
+        boost::uint64_t wake_target;    // absolute tick the pending wait advances to
+        boost::uint64_t next_id;
+        boost::uint64_t next_ns;
+        std::size_t pending_count;
+        bool ticking;
     };
 };
 
@@ -69,3 +331,24 @@ boost::asio::io_service* TimerService::getIOService()
 {
 	return pimpl->io_service.get();
 }
+
+boost::uint64_t TimerService::scheduleTimeout(long duration_ms, const TimeoutFunc& func, long slack_ms,
+	TimerNamespace ns)
+{
+	return pimpl->schedule(duration_ms, func, slack_ms, ns);
+}
+
+bool TimerService::cancelTimeout(boost::uint64_t token)
+{
+	return pimpl->cancel(token);
+}
+
+TimerService::TimerNamespace TimerService::createNamespace()
+{
+	return pimpl->createNamespace();
+}
+
+std::size_t TimerService::destroyNamespace(TimerNamespace ns)
+{
+	return pimpl->destroyNamespace(ns);
+}
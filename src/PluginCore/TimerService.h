@@ -17,11 +17,14 @@ License:    Dual license model; choose one of two:
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/cstdint.hpp>
+// io_service can't be forward-declared: newer boost makes it a typedef
+// for io_context
+#include <boost/asio/io_service.hpp>
 
 #include "FBPointers.h"
 
-namespace boost { namespace asio { class io_service; } }
-
 namespace FB {
 
     class TimerServicePimpl;
@@ -38,10 +41,76 @@ namespace FB {
 	class TimerService
 	{
 	public:
+		typedef boost::function<void (void)> TimeoutFunc;
+
+		/// Groups timeouts for bulk cancellation; see createNamespace.  0 is the
+		/// shared default namespace, which can never be destroyed.
+		typedef boost::uint64_t TimerNamespace;
+
 		static TimerServicePtr instance();
 		~TimerService();
 
 		boost::asio::io_service* getIOService();
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		/// @fn TimerNamespace createNamespace()
+		///
+		/// @brief  Allocates a namespace tag for a group of related timeouts
+		///
+		/// The service is shared by every plugin instance in the process, so a dying
+		/// instance can't just drop its reference and take its timers with it; it
+		/// schedules everything under its own namespace and tears the whole group
+		/// down with one destroyNamespace call.
+		///
+		/// @return token to pass to scheduleTimeout and destroyNamespace; never 0
+		///
+		/// @since 1.7
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		TimerNamespace createNamespace();
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		/// @fn std::size_t destroyNamespace(TimerNamespace ns)
+		///
+		/// @brief  Cancels every timeout still pending in the given namespace
+		///
+		/// @return how many pending timeouts were cancelled
+		///
+		/// @since 1.7
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		std::size_t destroyNamespace(TimerNamespace ns);
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		/// @fn boost::uint64_t scheduleTimeout(long duration_ms, const TimeoutFunc& func, long slack_ms = 0)
+		///
+		/// @brief  Schedules func to run once after duration_ms on the timer thread
+		///
+		/// Timeouts live in a hierarchical timer wheel, so scheduling and cancelling
+		/// are O(1) no matter how many are outstanding and everything due on the same
+		/// ~10ms tick is delivered in one batch.  The service only wakes up for
+		/// occupied ticks, not on a fixed beat.
+		///
+		/// A non-zero slack_ms permits the timeout to fire up to that much late:
+		/// expiries are aligned so that every timeout carrying the same slack fires
+		/// in the same wakeup.  With many timers of similar period this collapses
+		/// the wakeup storm into one batched pass per slack window.
+		///
+		/// A non-zero ns files the timeout under that namespace so destroyNamespace
+		/// can cancel it along with the rest of its group.
+		///
+		/// @return token to pass to cancelTimeout; never 0
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		boost::uint64_t scheduleTimeout(long duration_ms, const TimeoutFunc& func, long slack_ms = 0,
+			TimerNamespace ns = 0);
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		/// @fn bool cancelTimeout(boost::uint64_t token)
+		///
+		/// @brief  Cancels a pending timeout
+		///
+		/// @return true if the timeout was still pending, false if it already fired
+		///         (or was cancelled before)
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+		bool cancelTimeout(boost::uint64_t token);
 	protected:
 		static TimerServiceWeakPtr inst;
 		static boost::mutex instance_mutex;
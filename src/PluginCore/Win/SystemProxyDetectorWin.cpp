@@ -45,7 +45,7 @@ namespace {
 
 }
 
-bool FB::SystemProxyDetectorWin::detectProxy( map<string, string>& proxyMap, const string& URL )
+bool FB::SystemProxyDetectorWin::detectProxySystem( map<string, string>& proxyMap, const string& URL )
 {
     proxyMap.clear();
     try {
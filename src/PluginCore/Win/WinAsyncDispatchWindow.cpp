@@ -0,0 +1,114 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 29, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include "win_targetver.h"
+#include "win_common.h"
+#include <boost/bind.hpp>
+#include "AsyncFunctionCall.h"
+#include "logging.h"
+#include "../precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "WinMessageWindow.h"
+#include "WinAsyncDispatchWindow.h"
+
+FB::WinAsyncDispatchWindow::WinAsyncDispatchWindow()
+    : m_queued(0), m_messageWin(new FB::WinMessageWindow())
+{
+    m_messageWin->setWinProc(boost::bind(&FB::WinAsyncDispatchWindow::onWindowsEvent,
+                                         this, _1, _2, _3, _4, _5));
+}
+
+FB::WinAsyncDispatchWindow::~WinAsyncDispatchWindow()
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (Sinks::iterator sink = m_sinks.begin(); sink != m_sinks.end(); ++sink) {
+        delete sink->second;
+    }
+    m_sinks.clear();
+}
+
+void FB::WinAsyncDispatchWindow::registerSink(void* sink)
+{
+    // If there isn't a deque for the sink, create it
+    boost::mutex::scoped_lock lock(m_mutex);
+    Sinks::iterator fnd = m_sinks.find(sink);
+    if (m_sinks.end() == fnd)
+        m_sinks[sink] = new CallQueue();
+}
+
+void FB::WinAsyncDispatchWindow::unregisterSink(void* sink)
+{
+    // If there is a deque for the sink, destroy it and all queued calls
+    boost::mutex::scoped_lock lock(m_mutex);
+    Sinks::iterator fnd = m_sinks.find(sink);
+    if (m_sinks.end() != fnd) {
+        m_queued -= (uint32_t)fnd->second->size();
+        delete fnd->second;
+        m_sinks.erase(fnd);
+    }
+}
+
+bool FB::WinAsyncDispatchWindow::scheduleAsyncCall(void* sink, AsyncCallback func, void* userData)
+{
+    bool needPost(false);
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        Sinks::iterator fnd = m_sinks.find(sink);
+        if (m_sinks.end() == fnd)
+            return false;
+        fnd->second->push_back(std::make_pair(userData, func));
+        needPost = (0 == m_queued);
+        m_queued++;
+    }
+    if (needPost) {
+        ::PostMessage(m_messageWin->getHWND(), WM_ASYNCTHREADINVOKE, NULL, 0);
+    }
+    return true;
+}
+
+bool FB::WinAsyncDispatchWindow::nextCall(CallPair& call)
+{
+    // Return the next queued call, if any.  Pulled one at a time under the lock
+    // because a call may unregister sinks (even its own) while we drain
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (Sinks::iterator sink = m_sinks.begin(); sink != m_sinks.end(); ++sink) {
+        if (!sink->second->empty()) {
+            call = sink->second->front();
+            sink->second->pop_front();
+            m_queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FB::WinAsyncDispatchWindow::onWindowsEvent(HWND, UINT uMsg, WPARAM, LPARAM, LRESULT& lRes)
+{
+    if (uMsg == WM_ASYNCTHREADINVOKE) {
+        FBLOG_TRACE("PluginWindow", "Draining async function calls");
+        CallPair call;
+        while (nextCall(call))
+            call.second(call.first);
+        lRes = S_OK;
+        return true;
+    }
+    return false;
+}
+
+FB::WinAsyncDispatchWindow& FB::WinAsyncDispatchWindow::getInstance()
+{
+    static WinAsyncDispatchWindow window;
+    return window;
+}
+
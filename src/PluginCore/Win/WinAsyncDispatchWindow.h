@@ -0,0 +1,81 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 29, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+#pragma once
+#ifndef WinAsyncDispatchWindow_h__
+#define WinAsyncDispatchWindow_h__
+
+#include <deque>
+#include <map>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace FB {
+    class WinMessageWindow;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  WinAsyncDispatchWindow
+    ///
+    /// @brief  Process-wide hidden message window shared by all browser hosts for async
+    ///         call delivery
+    ///
+    /// Every host used to create its own hidden window and post one WM_ASYNCTHREADINVOKE
+    /// per scheduled call, so N instances generating M calls meant N windows and M posted
+    /// messages competing with the browser's own pump.  Hosts now register themselves as
+    /// sinks on the shared window; scheduled calls are queued per sink and at most one
+    /// window message is outstanding at a time — each message drains everything queued,
+    /// so message volume is bounded by pump iterations rather than by calls.
+    ///
+    /// Unregistering a sink discards its pending calls, which preserves the old semantics
+    /// of destroying the per-host window.  This is the Windows counterpart of what
+    /// OneShotManager does on Mac.  First use must be on the browser main thread, since
+    /// the window is created lazily on the calling thread and messages are delivered there.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class WinAsyncDispatchWindow : boost::noncopyable
+    {
+    public:
+        typedef void (*AsyncCallback)(void*);
+
+        ~WinAsyncDispatchWindow();
+
+        void registerSink(void* sink);
+        // Discards any calls still queued for the sink
+        void unregisterSink(void* sink);
+
+        // Queues the call for the sink and wakes the main thread if no wakeup is
+        // pending; returns false if the sink is not registered
+        bool scheduleAsyncCall(void* sink, AsyncCallback func, void* userData);
+
+        static WinAsyncDispatchWindow& getInstance();
+
+    private:
+        WinAsyncDispatchWindow();
+
+        typedef std::pair<void*, AsyncCallback> CallPair;
+        typedef std::deque<CallPair> CallQueue;
+        typedef std::map<void*, CallQueue*> Sinks;
+
+        bool nextCall(CallPair& call);
+        bool onWindowsEvent(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam, LRESULT& lRes);
+
+        mutable boost::mutex m_mutex;
+        Sinks m_sinks;
+        uint32_t m_queued;      // queued call count; a message is posted only on 0 -> 1
+        boost::scoped_ptr<WinMessageWindow> m_messageWin;
+    };
+}
+#endif // WinAsyncDispatchWindow_h__
+
@@ -0,0 +1,272 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+#include "WorkerPool.h"
+#include "TraceEvents.h"
+#include <deque>
+#include <vector>
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/tss.hpp>
+
+using namespace FB;
+
+namespace FB {
+    class WorkerPoolPimpl {
+    public:
+        typedef WorkerPool::Task Task;
+        typedef WorkerPool::RangeFunc RangeFunc;
+
+        // One deque per worker; the owner pushes and pops at the back, thieves take
+        // from the front, so a worker's freshest (cache-hot) work stays its own and
+        // the oldest work migrates to whoever is idle
+        struct Worker {
+            boost::mutex mutex;
+            std::deque<Task> queue;
+        };
+
+        explicit WorkerPoolPimpl(std::size_t count)
+            : workers(count), shutdown(false), sleepers(0), signal(0), next_queue(0)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                workers[i] = new Worker;
+            for (std::size_t i = 0; i < count; ++i)
+                threads.create_thread(boost::bind(&WorkerPoolPimpl::run, this, i));
+        }
+
+        ~WorkerPoolPimpl() {
+            {
+                boost::mutex::scoped_lock lock(idle_mutex);
+                shutdown = true;
+            }
+            idle_cv.notify_all();
+            threads.join_all();
+            // anything still queued is dropped; the last pool reference going away is
+            // the module shutting down
+            for (std::size_t i = 0; i < workers.size(); ++i)
+                delete workers[i];
+        }
+
+        void post(const Task& task) {
+            std::size_t idx;
+            int* self = self_index.get();
+            if (self) {
+                // posted from a worker: keep it local, thieves will balance
+                idx = static_cast<std::size_t>(*self);
+            } else {
+                boost::mutex::scoped_lock lock(rr_mutex);
+                idx = next_queue++ % workers.size();
+            }
+            {
+                boost::mutex::scoped_lock lock(workers[idx]->mutex);
+                workers[idx]->queue.push_back(task);
+            }
+            wake();
+        }
+
+        void runThen(const Task& task, const Task& continuation) {
+            task();
+            post(continuation);
+        }
+
+        // Shared claim state for one parallelFor call; chunks are claimed under the
+        // mutex and run outside it, by workers and the calling thread alike
+        struct ForState {
+            boost::mutex mutex;
+            boost::condition_variable cv;
+            std::size_t next;
+            std::size_t end;
+            std::size_t grain;
+            std::size_t remaining;  // chunks not yet finished
+            RangeFunc body;
+        };
+
+        static void runChunks(const boost::shared_ptr<ForState>& st) {
+            for (;;) {
+                std::size_t b, e;
+                {
+                    boost::mutex::scoped_lock lock(st->mutex);
+                    if (st->next >= st->end)
+                        return;
+                    b = st->next;
+                    e = b + st->grain < st->end ? b + st->grain : st->end;
+                    st->next = e;
+                }
+                st->body(b, e);
+                {
+                    boost::mutex::scoped_lock lock(st->mutex);
+                    if (--st->remaining == 0)
+                        st->cv.notify_all();
+                }
+            }
+        }
+
+        void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const RangeFunc& body) {
+            if (end <= begin)
+                return;
+            if (!grain)
+                grain = 1;
+            boost::shared_ptr<ForState> st(boost::make_shared<ForState>());
+            st->next = begin;
+            st->end = end;
+            st->grain = grain;
+            st->remaining = (end - begin + grain - 1) / grain;
+            st->body = body;
+            // one helper per worker at most; a helper that arrives after the range is
+            // drained just returns
+            std::size_t helpers = workers.size() < st->remaining ? workers.size() : st->remaining;
+            for (std::size_t i = 1; i < helpers; ++i)
+                post(boost::bind(&WorkerPoolPimpl::runChunks, st));
+            runChunks(st);  // the caller claims chunks too, so this can't deadlock
+            boost::mutex::scoped_lock lock(st->mutex);
+            while (st->remaining)
+                st->cv.wait(lock);
+        }
+
+        std::size_t workerCount() const {
+            return workers.size();
+        }
+
+    private:
+        void run(std::size_t index) {
+            self_index.reset(new int(static_cast<int>(index)));
+            for (;;) {
+                Task task;
+                if (tryGet(index, task)) {
+                    FBTRACE_SCOPE("PluginCore", "WorkerPool::task");
+                    task();
+                    continue;
+                }
+                // Nothing anywhere; re-check against the post signal so a task pushed
+                // between our scan and the wait can't be missed
+                boost::mutex::scoped_lock lock(idle_mutex);
+                if (shutdown)
+                    return;
+                boost::uint64_t seen = signal;
+                lock.unlock();
+                if (tryGet(index, task)) {
+                    FBTRACE_SCOPE("PluginCore", "WorkerPool::task");
+                    task();
+                    continue;
+                }
+                lock.lock();
+                if (shutdown)
+                    return;
+                if (signal == seen) {
+                    ++sleepers;
+                    idle_cv.wait(lock);
+                    --sleepers;
+                }
+            }
+        }
+
+        bool tryGet(std::size_t self, Task& task) {
+            {
+                // own queue first, newest entry
+                Worker& w = *workers[self];
+                boost::mutex::scoped_lock lock(w.mutex);
+                if (!w.queue.empty()) {
+                    task = w.queue.back();
+                    w.queue.pop_back();
+                    return true;
+                }
+            }
+            // steal the oldest entry from someone else
+            for (std::size_t n = 1; n < workers.size(); ++n) {
+                Worker& w = *workers[(self + n) % workers.size()];
+                boost::mutex::scoped_lock lock(w.mutex);
+                if (!w.queue.empty()) {
+                    task = w.queue.front();
+                    w.queue.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void wake() {
+            {
+                boost::mutex::scoped_lock lock(idle_mutex);
+                ++signal;
+                if (!sleepers)
+                    return;
+            }
+            idle_cv.notify_one();
+        }
+
+        std::vector<Worker*> workers;
+        boost::thread_group threads;
+        boost::thread_specific_ptr<int> self_index;
+
+        boost::mutex idle_mutex;
+        boost::condition_variable idle_cv;
+        bool shutdown;
+        std::size_t sleepers;
+        boost::uint64_t signal;     // bumped on every post; guards against lost wakeups
+
+        boost::mutex rr_mutex;
+        std::size_t next_queue;     // round-robin target for external posts
+    };
+};
+
+WorkerPoolWeakPtr WorkerPool::inst;
+boost::mutex WorkerPool::instance_mutex;
+
+WorkerPoolPtr WorkerPool::instance()
+{
+    boost::mutex::scoped_lock lock(instance_mutex);
+    WorkerPoolPtr pool(inst.lock());
+    if (!pool)
+    {
+        pool = WorkerPoolPtr(new WorkerPool());
+        inst = pool;
+    }
+    return pool;
+}
+
+WorkerPool::WorkerPool()
+{
+    std::size_t count = boost::thread::hardware_concurrency();
+    if (count < 2)
+        count = 2;
+    pimpl.reset(new WorkerPoolPimpl(count));
+}
+
+WorkerPool::~WorkerPool()
+{
+}
+
+void WorkerPool::post(const Task& task)
+{
+    pimpl->post(task);
+}
+
+void WorkerPool::post(const Task& task, const Task& continuation)
+{
+    pimpl->post(boost::bind(&WorkerPoolPimpl::runThen, pimpl.get(), task, continuation));
+}
+
+void WorkerPool::parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const RangeFunc& body)
+{
+    pimpl->parallelFor(begin, end, grain, body);
+}
+
+std::size_t WorkerPool::workerCount() const
+{
+    return pimpl->workerCount();
+}
@@ -0,0 +1,104 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_WORKERPOOL
+#define H_FB_WORKERPOOL
+
+#include <cstddef>
+#include <boost/thread/mutex.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/function.hpp>
+
+#include "FBPointers.h"
+
+namespace FB {
+
+    class WorkerPoolPimpl;
+    FB_FORWARD_PTR(WorkerPool);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  WorkerPool
+    ///
+    /// @brief  Process-wide work-stealing thread pool
+    ///
+    /// One shared pool, sized to hardware concurrency, for everything that doesn't need a
+    /// dedicated thread: background hashing and parsing, blocking file IO, fan-out work.  Each
+    /// worker owns a deque and steals from the others when its own runs dry, so tasks posted
+    /// from a worker stay hot on that worker's queue while idle workers drain whoever is
+    /// backed up.  A plugin that spawns a boost::thread per job can usually post the job here
+    /// instead and drop the thread entirely.
+    ///
+    /// Like TimerService, the pool exists while someone holds the instance() pointer (the
+    /// usual way in is FactoryBase::getWorkerPool()); the threads start with the first
+    /// instance and join when the last reference drops.
+    ///
+    /// Tasks must not block indefinitely on other pool tasks -- that can deadlock a fully
+    /// loaded pool.  parallelFor is safe to call from a worker because the caller claims
+    /// chunks itself rather than waiting for a free thread.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class WorkerPool
+    {
+    public:
+        typedef boost::function<void (void)> Task;
+        typedef boost::function<void (std::size_t, std::size_t)> RangeFunc;
+
+        static WorkerPoolPtr instance();
+        ~WorkerPool();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void post(const Task& task)
+        ///
+        /// @brief  Queues task to run on some pool worker; returns immediately
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void post(const Task& task);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void post(const Task& task, const Task& continuation)
+        ///
+        /// @brief  Queues task, then queues continuation once task has finished
+        ///
+        /// The continuation runs on the pool as well (not necessarily on the same worker).
+        /// Chains compose: the continuation may itself post with a continuation.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void post(const Task& task, const Task& continuation);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const RangeFunc& body)
+        ///
+        /// @brief  Runs body over [begin, end) split into chunks of at most grain, in parallel;
+        ///         blocks until every chunk has finished
+        ///
+        /// body is called as body(chunkBegin, chunkEnd) and must be safe to run concurrently
+        /// with itself on disjoint chunks.  The calling thread participates, so this makes
+        /// progress even when every worker is busy elsewhere.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void parallelFor(std::size_t begin, std::size_t end, std::size_t grain, const RangeFunc& body);
+
+        /// @brief  Number of worker threads in the pool
+        std::size_t workerCount() const;
+
+    protected:
+        static WorkerPoolWeakPtr inst;
+        static boost::mutex instance_mutex;
+        WorkerPool();
+
+    private:
+        boost::scoped_ptr<WorkerPoolPimpl> pimpl;
+    };
+};
+
+#endif
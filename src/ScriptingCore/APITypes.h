@@ -24,7 +24,9 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include <boost/shared_ptr.hpp>
 #include <boost/variant/variant_fwd.hpp>
 #include "fb_stdint.h"
+#include "fb_features.h"
 #include "FBPointers.h"
+#include "Delegate.h"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// @namespace  FB
@@ -283,7 +285,9 @@ namespace FB
     };
 
     /// @brief  Defines an alias representing a method functor used by FB::JSAPIAuto, created by FB::make_method().
-    typedef boost::function<variant (const std::vector<variant>&)> CallMethodFunctor;
+    /// A small-buffer delegate rather than a boost::function so that registering a member
+    /// doesn't heap-allocate for the bound method pointer; see Delegate.h
+    typedef FB::delegate<variant (const std::vector<variant>&)> CallMethodFunctor;
     struct MethodFunctors
     {
         CallMethodFunctor call;
@@ -304,9 +308,9 @@ namespace FB
     // new style JSAPI properties
 
     /// @brief  Defines an alias representing a property getter functor used by FB::JSAPIAuto
-    typedef boost::function<FB::variant ()> GetPropFunctor;
+    typedef FB::delegate<FB::variant ()> GetPropFunctor;
     /// @brief  Defines an alias representing a property setter functor used by FB::JSAPIAuto
-    typedef boost::function<void (const FB::variant&)> SetPropFunctor;
+    typedef FB::delegate<void (const FB::variant&)> SetPropFunctor;
     /// @brief  used by FB::JSAPIAuto to store property implementation details, created by FB::make_property().
     struct PropertyFunctors
     {
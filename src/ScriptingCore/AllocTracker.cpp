@@ -0,0 +1,64 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <boost/thread/mutex.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "AllocTracker.h"
+
+namespace {
+    // A tracking build takes this lock on every tagged allocation; acceptable for a
+    // diagnostics configuration, free in normal builds where the hooks are empty inlines
+    boost::mutex g_tallyMutex;
+    FB::AllocTracker::Tally g_tallies[FB::AllocTracker::Subsystem_Count];    // zero-initialized
+
+    const char* g_names[FB::AllocTracker::Subsystem_Count] = {
+        "variant",
+        "call records",
+        "stream chunks",
+        "plugin events"
+    };
+}
+
+FB::AllocTracker::Tally FB::AllocTracker::getTally(Subsystem subsystem)
+{
+    boost::mutex::scoped_lock _l(g_tallyMutex);
+    return g_tallies[subsystem];
+}
+
+const char* FB::AllocTracker::subsystemName(Subsystem subsystem)
+{
+    return g_names[subsystem];
+}
+
+#ifdef FB_TRACK_ALLOCATIONS
+
+void FB::AllocTracker::recordAlloc(Subsystem subsystem, std::size_t bytes)
+{
+    boost::mutex::scoped_lock _l(g_tallyMutex);
+    Tally& t = g_tallies[subsystem];
+    ++t.allocs;
+    t.bytesAllocated += bytes;
+}
+
+void FB::AllocTracker::recordFree(Subsystem subsystem, std::size_t bytes)
+{
+    boost::mutex::scoped_lock _l(g_tallyMutex);
+    Tally& t = g_tallies[subsystem];
+    ++t.frees;
+    t.bytesFreed += bytes;
+}
+
+#endif // FB_TRACK_ALLOCATIONS
+
@@ -0,0 +1,92 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_ALLOCTRACKER
+#define H_FB_ALLOCTRACKER
+
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Per-subsystem allocation tallies for chasing memory bloat.
+///
+/// The major framework allocation sites (variant heap storage, cross-thread call records,
+/// stream chunks, plugin event objects) call recordAlloc()/recordFree() with their subsystem
+/// tag.  By default the hooks compile to empty inlines and cost nothing; build with
+/// FB_TRACK_ALLOCATIONS defined to get live byte/count tallies queryable through getTally().
+/// This keeps plugin allocations visible without heap-profiling the whole browser process.
+///
+/// @since 1.7
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace FB { namespace AllocTracker {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @enum   Subsystem
+    ///
+    /// @brief  Tag identifying which framework site an allocation came from
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    enum Subsystem {
+        Subsystem_Variant = 0,      ///< variant heap storage (values too big for the inline buffer)
+        Subsystem_CallRecord,       ///< cross-thread call records (ThreadCachedPool)
+        Subsystem_StreamChunk,      ///< stream data chunks (StreamChunkPool)
+        Subsystem_PluginEvent,      ///< PluginEvent-derived event objects
+        Subsystem_Count
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @struct Tally
+    ///
+    /// @brief  Running totals for one subsystem; live count/bytes are the difference of the
+    ///         alloc and free totals
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct Tally {
+        boost::uint64_t allocs;
+        boost::uint64_t frees;
+        boost::uint64_t bytesAllocated;
+        boost::uint64_t bytesFreed;
+
+        boost::uint64_t liveCount() const { return allocs - frees; }
+        boost::uint64_t liveBytes() const { return bytesAllocated - bytesFreed; }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn Tally getTally(Subsystem subsystem)
+    ///
+    /// @brief  Returns the running tally for one subsystem.  Always available; all zeros unless
+    ///         the tree was built with FB_TRACK_ALLOCATIONS.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    Tally getTally(Subsystem subsystem);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn const char* subsystemName(Subsystem subsystem)
+    ///
+    /// @brief  Human-readable name for a subsystem tag, for logs and reports
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    const char* subsystemName(Subsystem subsystem);
+
+#ifdef FB_TRACK_ALLOCATIONS
+    void recordAlloc(Subsystem subsystem, std::size_t bytes);
+    void recordFree(Subsystem subsystem, std::size_t bytes);
+#else
+    // Tracking not compiled in; the hooks vanish entirely
+    inline void recordAlloc(Subsystem, std::size_t) { }
+    inline void recordFree(Subsystem, std::size_t) { }
+#endif
+
+} }
+
+#endif // H_FB_ALLOCTRACKER
+
@@ -0,0 +1,195 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <fstream>
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "BinaryLog.h"
+
+using namespace FB::Log;
+
+namespace
+{
+    const boost::uint32_t kBinaryLogMagic = 0x4c424246;  // "FBBL", little-endian
+    const boost::uint32_t kBinaryLogVersion = 1;
+    // Records buffered before each disk write; one write per ~24kb keeps the
+    // per-record cost to a memcpy
+    const std::size_t kFlushRecords = 512;
+
+    struct BinaryLogHeader
+    {
+        boost::uint32_t magic;
+        boost::uint32_t version;
+        boost::uint32_t recordSize;
+        boost::uint32_t reserved;
+    };
+
+    boost::uint64_t timestamp_us()
+    {
+        static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+        return (boost::posix_time::microsec_clock::universal_time() - epoch).total_microseconds();
+    }
+
+    class BinaryLogWriter
+    {
+    public:
+        BinaryLogWriter(const std::string& path)
+            : m_out(path.c_str(), std::ios::binary | std::ios::trunc)
+        {
+            m_buf.reserve(kFlushRecords);
+            BinaryLogHeader header;
+            header.magic = kBinaryLogMagic;
+            header.version = kBinaryLogVersion;
+            header.recordSize = sizeof(BinaryLogRecord);
+            header.reserved = 0;
+            m_out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        ~BinaryLogWriter()
+        {
+            flush();
+        }
+
+        bool isOpen() const { return m_out.is_open(); }
+
+        void append(const BinaryLogRecord& rec)
+        {
+            m_buf.push_back(rec);
+            if (m_buf.size() >= kFlushRecords)
+                flush();
+        }
+
+        void flush()
+        {
+            if (m_buf.empty())
+                return;
+            m_out.write(reinterpret_cast<const char*>(&m_buf[0]),
+                static_cast<std::streamsize>(m_buf.size() * sizeof(BinaryLogRecord)));
+            m_buf.clear();
+        }
+
+    private:
+        std::ofstream m_out;
+        std::vector<BinaryLogRecord> m_buf;
+    };
+
+    BinaryLogWriter* binary_writer(NULL);
+    boost::mutex binary_mutex;  // guards the pointer and all writer access
+
+    void record(boost::uint32_t eventId, const boost::int64_t* args, boost::uint32_t argCount)
+    {
+        boost::mutex::scoped_lock lock(binary_mutex);
+        if (!binary_writer)
+            return;
+        BinaryLogRecord rec;
+        rec.timestampUs = timestamp_us();
+        rec.eventId = eventId;
+        rec.argCount = argCount;
+        for (boost::uint32_t i = 0; i < 4; ++i)
+            rec.args[i] = i < argCount ? args[i] : 0;
+        binary_writer->append(rec);
+    }
+}
+
+void FB::Log::initBinaryLog(const std::string& path)
+{
+    boost::mutex::scoped_lock lock(binary_mutex);
+    if (binary_writer)
+        return;
+    BinaryLogWriter* writer = new BinaryLogWriter(path);
+    if (!writer->isOpen()) {
+        delete writer;
+        return;
+    }
+    binary_writer = writer;
+}
+
+void FB::Log::stopBinaryLog()
+{
+    boost::mutex::scoped_lock lock(binary_mutex);
+    delete binary_writer;
+    binary_writer = NULL;
+}
+
+bool FB::Log::binaryLogEnabled()
+{
+    boost::mutex::scoped_lock lock(binary_mutex);
+    return binary_writer != NULL;
+}
+
+void FB::Log::logBinary(boost::uint32_t eventId)
+{
+    record(eventId, NULL, 0);
+}
+
+void FB::Log::logBinary(boost::uint32_t eventId, boost::int64_t a0)
+{
+    record(eventId, &a0, 1);
+}
+
+void FB::Log::logBinary(boost::uint32_t eventId, boost::int64_t a0, boost::int64_t a1)
+{
+    boost::int64_t args[2] = { a0, a1 };
+    record(eventId, args, 2);
+}
+
+void FB::Log::logBinary(boost::uint32_t eventId, boost::int64_t a0, boost::int64_t a1,
+    boost::int64_t a2)
+{
+    boost::int64_t args[3] = { a0, a1, a2 };
+    record(eventId, args, 3);
+}
+
+void FB::Log::logBinary(boost::uint32_t eventId, boost::int64_t a0, boost::int64_t a1,
+    boost::int64_t a2, boost::int64_t a3)
+{
+    boost::int64_t args[4] = { a0, a1, a2, a3 };
+    record(eventId, args, 4);
+}
+
+bool FB::Log::formatBinaryLog(const std::string& binaryPath, const std::string& textPath,
+    const BinaryEventNameMap& names)
+{
+    std::ifstream in(binaryPath.c_str(), std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    BinaryLogHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || header.magic != kBinaryLogMagic || header.version != kBinaryLogVersion
+        || header.recordSize != sizeof(BinaryLogRecord))
+        return false;
+
+    std::ofstream out(textPath.c_str(), std::ios::trunc);
+    if (!out.is_open())
+        return false;
+
+    BinaryLogRecord rec;
+    while (in.read(reinterpret_cast<char*>(&rec), sizeof(rec))) {
+        out << rec.timestampUs << " ";
+        BinaryEventNameMap::const_iterator it = names.find(rec.eventId);
+        if (it != names.end())
+            out << it->second;
+        else
+            out << "event#" << rec.eventId;
+        out << "(" << rec.eventId << "):";
+        for (boost::uint32_t i = 0; i < rec.argCount && i < 4; ++i)
+            out << " " << rec.args[i];
+        out << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_BINARYLOG
+#define H_FB_BINARYLOG
+
+#include <string>
+#include <map>
+#include <boost/cstdint.hpp>
+
+namespace FB { namespace Log {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @struct BinaryLogRecord
+    ///
+    /// @brief  One fixed-size entry in a binary log stream
+    ///
+    /// Producers record an event id and up to four raw integer arguments -- no ostringstream,
+    /// no text formatting -- so tracing stays affordable in hot paths where the FBLOG macros
+    /// are too expensive to leave on.  Records are decoded to text offline or at idle time with
+    /// formatBinaryLog().
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct BinaryLogRecord
+    {
+        boost::uint64_t timestampUs;    // microseconds since the unix epoch
+        boost::uint32_t eventId;
+        boost::uint32_t argCount;
+        boost::int64_t args[4];
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Opens a binary log stream at the given path
+    ///
+    /// Called automatically by initLogging when the factory's
+    /// getLoggingMethods list contains LogMethod_Binary; can also be called
+    /// directly.  Records are buffered in memory and written to disk in
+    /// block-sized batches.
+    //////////////////////////////////////////////////////////////////////////
+    void initBinaryLog(const std::string& path);
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Flushes and closes the binary log stream; logBinary calls
+    ///        become no-ops again
+    //////////////////////////////////////////////////////////////////////////
+    void stopBinaryLog();
+
+    /// @brief Returns true while a binary log stream is open
+    bool binaryLogEnabled();
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Appends one record to the binary log stream
+    ///
+    /// Cheap enough for always-on tracing: when no stream is open this is a
+    /// lock, a pointer test, and a return.  Arguments are recorded raw;
+    /// anything convertible to a 64-bit integer (sizes, enums, pointers cast
+    /// through intptr_t) can be captured.
+    //////////////////////////////////////////////////////////////////////////
+    void logBinary(boost::uint32_t eventId);
+    /// @overload
+    void logBinary(boost::uint32_t eventId, boost::int64_t a0);
+    /// @overload
+    void logBinary(boost::uint32_t eventId, boost::int64_t a0, boost::int64_t a1);
+    /// @overload
+    void logBinary(boost::uint32_t eventId, boost::int64_t a0, boost::int64_t a1,
+        boost::int64_t a2);
+    /// @overload
+    void logBinary(boost::uint32_t eventId, boost::int64_t a0, boost::int64_t a1,
+        boost::int64_t a2, boost::int64_t a3);
+
+    /// @brief Maps event ids to the names used when a binary log is formatted
+    typedef std::map<boost::uint32_t, std::string> BinaryEventNameMap;
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Decodes a binary log stream into readable text
+    ///
+    /// The deferred half of binary logging: run offline or at idle time, it
+    /// reads the records written by logBinary and writes one line per record
+    /// ("timestamp name(id): args...") to textPath.  Ids missing from names
+    /// are rendered as event#<id>.
+    ///
+    /// @return false if binaryPath can't be opened or isn't a binary log
+    //////////////////////////////////////////////////////////////////////////
+    bool formatBinaryLog(const std::string& binaryPath, const std::string& textPath,
+        const BinaryEventNameMap& names);
+
+}; };
+
+#endif // H_FB_BINARYLOG
@@ -0,0 +1,273 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_BOUNDEDSAFEQUEUE
+#define H_FB_BOUNDEDSAFEQUEUE
+
+#include <boost/cstdint.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace FB {
+
+    namespace detail
+    {
+        // Minimal 32-bit atomic shim; full-barrier semantics on every operation.  This is
+        // deliberately tiny - just enough for BoundedSafeQueue - since the boost versions
+        // this tree targets predate Boost.Atomic.
+        typedef boost::int32_t atomic32_t;
+
+#if defined(_MSC_VER)
+        inline atomic32_t atomic32_cas(volatile atomic32_t* ptr, atomic32_t oldval, atomic32_t newval) {
+            return static_cast<atomic32_t>(_InterlockedCompareExchange(
+                reinterpret_cast<volatile long*>(ptr), static_cast<long>(newval), static_cast<long>(oldval)));
+        }
+        inline atomic32_t atomic32_load(const volatile atomic32_t* ptr) {
+            atomic32_t val = *ptr;
+            _ReadWriteBarrier();
+            return val;
+        }
+        inline void atomic32_store(volatile atomic32_t* ptr, atomic32_t val) {
+            _InterlockedExchange(reinterpret_cast<volatile long*>(ptr), static_cast<long>(val));
+        }
+#else
+        inline atomic32_t atomic32_cas(volatile atomic32_t* ptr, atomic32_t oldval, atomic32_t newval) {
+            return __sync_val_compare_and_swap(ptr, oldval, newval);
+        }
+        inline atomic32_t atomic32_load(const volatile atomic32_t* ptr) {
+            atomic32_t val = *ptr;
+            __sync_synchronize();
+            return val;
+        }
+        inline void atomic32_store(volatile atomic32_t* ptr, atomic32_t val) {
+            __sync_synchronize();
+            *ptr = val;
+            __sync_synchronize();
+        }
+#endif
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @struct SpinWaitStrategy
+    ///
+    /// @brief  Busy-spins; lowest latency, burns a core while waiting.  For pipelines where the
+    ///         other side is always just about to catch up.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct SpinWaitStrategy {
+        static void wait(unsigned /*spinCount*/) {}
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @struct YieldWaitStrategy
+    ///
+    /// @brief  Spins briefly, then yields the timeslice.  A good default for high-rate pipelines.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct YieldWaitStrategy {
+        static void wait(unsigned spinCount) {
+            if (spinCount > 64)
+                boost::this_thread::yield();
+        }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @struct BlockWaitStrategy
+    ///
+    /// @brief  Spins, yields, then sleeps in 1ms steps.  Cheapest when the queue can sit idle;
+    ///         note the queue itself stays lock-free, so "blocking" is a short sleep rather than
+    ///         a condition-variable wait and wakeup latency is up to about a millisecond.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct BlockWaitStrategy {
+        static void wait(unsigned spinCount) {
+            if (spinCount > 256)
+                boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            else if (spinCount > 64)
+                boost::this_thread::yield();
+        }
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  BoundedSafeQueue
+    ///
+    /// @brief  Bounded lock-free MPMC queue with the same interface shape as FB::SafeQueue
+    ///
+    /// Fixed-capacity ring with per-cell sequence numbers (Vyukov's bounded MPMC design):
+    /// producers and consumers claim slots with a single CAS each and never take a mutex, so
+    /// hot pipelines (stream chunks, log records) stop contending the way they do on
+    /// SafeQueue's mutex+condition pair.  The cost is a fixed capacity - push() waits (per the
+    /// wait strategy) when the ring is full, and try_push() refuses - and relaxed blocking:
+    /// waits are spin/yield/sleep loops, not condition-variable waits.
+    ///
+    /// Use SafeQueue when the queue is mostly idle or must be unbounded; use this when
+    /// throughput is the problem.  Capacity is rounded up to a power of two.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename Data, typename WaitStrategy = YieldWaitStrategy>
+    class BoundedSafeQueue
+    {
+    private:
+        struct Cell {
+            volatile detail::atomic32_t seq;
+            Data data;
+        };
+
+        boost::scoped_array<Cell> m_cells;
+        detail::atomic32_t m_mask;
+        volatile detail::atomic32_t m_pushPos;
+        volatile detail::atomic32_t m_popPos;
+
+        BoundedSafeQueue(const BoundedSafeQueue&);
+        BoundedSafeQueue& operator=(const BoundedSafeQueue&);
+
+    public:
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn explicit BoundedSafeQueue::BoundedSafeQueue(size_t capacity)
+        ///
+        /// @brief  Builds a queue holding at least capacity entries (rounded up to a power of two)
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        explicit BoundedSafeQueue(size_t capacity)
+            : m_pushPos(0), m_popPos(0)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+            m_mask = static_cast<detail::atomic32_t>(size - 1);
+            m_cells.reset(new Cell[size]);
+            for (size_t i = 0; i < size; ++i)
+                m_cells[i].seq = static_cast<detail::atomic32_t>(i);
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool BoundedSafeQueue::try_push(Data const& data)
+        ///
+        /// @brief  Pushes an object onto the end of the queue unless the queue is full
+        ///
+        /// @return true if the object was queued, false if the queue is full
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool try_push(Data const& data)
+        {
+            Cell* cell;
+            detail::atomic32_t pos = detail::atomic32_load(&m_pushPos);
+            for (;;) {
+                cell = &m_cells[pos & m_mask];
+                detail::atomic32_t seq = detail::atomic32_load(&cell->seq);
+                detail::atomic32_t dif = seq - pos;
+                if (dif == 0) {
+                    if (detail::atomic32_cas(&m_pushPos, pos, pos + 1) == pos)
+                        break;
+                    pos = detail::atomic32_load(&m_pushPos);
+                } else if (dif < 0) {
+                    return false;
+                } else {
+                    pos = detail::atomic32_load(&m_pushPos);
+                }
+            }
+            cell->data = data;
+            detail::atomic32_store(&cell->seq, pos + 1);
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void BoundedSafeQueue::push(Data const& data)
+        ///
+        /// @brief  Pushes an object onto the end of the queue, waiting per the wait strategy if full
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void push(Data const& data)
+        {
+            unsigned spinCount = 0;
+            while (!try_push(data))
+                WaitStrategy::wait(++spinCount);
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool BoundedSafeQueue::empty() const
+        ///
+        /// @brief  Queries if the queue is empty; in the presence of other threads the answer is
+        ///         naturally only a snapshot
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool empty() const
+        {
+            return detail::atomic32_load(&m_popPos) == detail::atomic32_load(&m_pushPos);
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool BoundedSafeQueue::try_pop(Data& popped_value)
+        ///
+        /// @brief  Try to pop a value off the front of the queue; if the queue is empty returns false
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool try_pop(Data& popped_value)
+        {
+            Cell* cell;
+            detail::atomic32_t pos = detail::atomic32_load(&m_popPos);
+            for (;;) {
+                cell = &m_cells[pos & m_mask];
+                detail::atomic32_t seq = detail::atomic32_load(&cell->seq);
+                detail::atomic32_t dif = seq - (pos + 1);
+                if (dif == 0) {
+                    if (detail::atomic32_cas(&m_popPos, pos, pos + 1) == pos)
+                        break;
+                    pos = detail::atomic32_load(&m_popPos);
+                } else if (dif < 0) {
+                    return false;
+                } else {
+                    pos = detail::atomic32_load(&m_popPos);
+                }
+            }
+            popped_value = cell->data;
+            cell->data = Data();
+            detail::atomic32_store(&cell->seq, pos + m_mask + 1);
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool BoundedSafeQueue::timed_wait_and_pop(Data& popped_value, const boost::posix_time::time_duration& duration)
+        ///
+        /// @brief  Tries to pop a value, waiting per the wait strategy up to roughly duration if the
+        ///         queue is empty
+        ///
+        /// @return true if a value is returned, false on timeout
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool timed_wait_and_pop(Data& popped_value, const boost::posix_time::time_duration& duration)
+        {
+            const boost::system_time deadline = boost::get_system_time() + duration;
+            unsigned spinCount = 0;
+            while (!try_pop(popped_value)) {
+                if (boost::get_system_time() >= deadline)
+                    return false;
+                WaitStrategy::wait(++spinCount);
+            }
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void BoundedSafeQueue::wait_and_pop(Data& popped_value)
+        ///
+        /// @brief  Pops a value off the front of the queue, waiting per the wait strategy until one
+        ///         is available
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void wait_and_pop(Data& popped_value)
+        {
+            unsigned spinCount = 0;
+            while (!try_pop(popped_value))
+                WaitStrategy::wait(++spinCount);
+        }
+    };
+};
+
+#endif //H_FB_BOUNDEDSAFEQUEUE
+
@@ -16,6 +16,8 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include <cstdio>
 #include <cassert>
 #include <algorithm>
+#include <deque>
+#include <sstream>
 #include <boost/lambda/lambda.hpp>
 #include <boost/lambda/bind.hpp>
 #include <boost/lambda/construct.hpp>
@@ -31,6 +33,7 @@ Copyright 2009 Richard Bateman, Firebreath development team
 
 #include "BrowserHost.h"
 #include "BrowserStreamRequest.h"
+#include "TraceEvents.h"
 #include "SystemProxyDetector.h"
 #include "SimpleStreamHelper.h"
 
@@ -41,32 +44,59 @@ Copyright 2009 Richard Bateman, Firebreath development team
 
 namespace FB {
     struct _asyncCallData : boost::noncopyable {
-        _asyncCallData(void (*func)(void*), void* userData, int id, AsyncCallManagerPtr mgr)
-            : func(func), userData(userData), uniqId(id), called(false), mgr(mgr)
+        _asyncCallData(void (*func)(void*), void* userData, int id, AsyncCallPriority priority, AsyncCallManagerPtr mgr)
+            : func(func), userData(userData), uniqId(id), called(false), priority(priority), mgr(mgr)
         {}
         void call();
         void (*func)(void *);
         void *userData;
         int uniqId;
         bool called;
+        AsyncCallPriority priority;
         AsyncCallManagerWeakPtr mgr;
+        boost::posix_time::ptime enqueued;  // set when the call enters a lane
     };
 
     class AsyncCallManager : public boost::enable_shared_from_this<AsyncCallManager>, boost::noncopyable {
     public:
         int lastId;
-        AsyncCallManager() : lastId(1) {}
+        AsyncCallManager() : lastId(1), m_batchScheduled(false), m_enqueued(0), m_drained(0), m_highWater(0) {}
         ~AsyncCallManager();
 
         boost::recursive_mutex m_mutex;
         void shutdown();
 
-        _asyncCallData* makeCallback(void (*func)(void *), void * userData );
+        _asyncCallData* makeCallback(void (*func)(void *), void * userData, AsyncCallPriority priority );
         void call( _asyncCallData* data );
         void remove( _asyncCallData* data );
 
+        // Pending calls wait in one of three priority lanes; the main thread always
+        // serves the urgent lane first, FIFO within each lane
+        void enqueue( _asyncCallData* data );
+        _asyncCallData* popNext();
+        void removeQueued( _asyncCallData* data );
+
+        // Batched submission: callers enqueue, the main thread drains the whole
+        // batch on a single wakeup (see BrowserHost::setAsyncCallBatching)
+        bool enqueueBatched( _asyncCallData* data );
+        void cancelBatchWakeup( _asyncCallData* data );
+        void drainBatch();
+
+        AsyncQueueStats getStats();
+
+        static const size_t LaneCount = AsyncPriority_Bulk + 1;
+
         std::set<_asyncCallData*> DataList;
         std::set<_asyncCallData*> canceledDataList;
+        std::deque<_asyncCallData*> m_lanes[LaneCount];
+        bool m_batchScheduled;
+        // queue gauges; depth is derived from the lanes, these only accumulate
+        boost::uint64_t m_enqueued;
+        boost::uint64_t m_drained;
+        size_t m_highWater;
+
+    private:
+        void noteEnqueued( _asyncCallData* data );   // callers hold m_mutex
     };
 }
 
@@ -74,7 +104,8 @@ volatile int FB::BrowserHost::InstanceCount(0);
 
 FB::BrowserHost::BrowserHost()
     : _asyncManager(boost::make_shared<AsyncCallManager>()), m_threadId(boost::this_thread::get_id()),
-      m_isShutDown(false), m_streamMgr(boost::make_shared<FB::BrowserStreamManager>()), m_htmlLogEnabled(true)
+      m_isShutDown(false), m_streamMgr(boost::make_shared<FB::BrowserStreamManager>()), m_htmlLogEnabled(true),
+      m_htmlLogScheduled(false), m_htmlLogDropped(0), m_asyncCallBatching(false)
 {
     ++InstanceCount;
 }
@@ -95,17 +126,43 @@ void FB::BrowserHost::shutdown()
     m_isShutDown = true;
     _asyncManager->shutdown();
     m_streamMgr.reset();
+    m_compiledSnippets.clear();
+}
+
+namespace {
+    // Lines pending page delivery beyond this are dropped (and counted) rather than
+    // queued; an unresponsive page must not grow the buffer without bound
+    const size_t kMaxPendingHtmlLogLines = 256;
 }
 
 void FB::BrowserHost::htmlLog(const std::string& str)
 {
     FBLOG_INFO("BrowserHost", "Logging to HTML: " << str);
-    if (m_htmlLogEnabled) {
+    if (!m_htmlLogEnabled)
+        return;
+    bool needSchedule(false);
+    {
+        boost::mutex::scoped_lock _l(m_htmlLogMutex);
+        if (m_htmlLogPending.size() >= kMaxPendingHtmlLogLines) {
+            ++m_htmlLogDropped;
+            return;
+        }
+        m_htmlLogPending.push_back(str);
+        if (!m_htmlLogScheduled) {
+            // One scheduled delivery drains everything queued by the time it runs, so a
+            // burst of log lines costs one main-thread call instead of one per line
+            m_htmlLogScheduled = true;
+            needSchedule = true;
+        }
+    }
+    if (needSchedule) {
         try {
             this->ScheduleAsyncCall(&FB::BrowserHost::AsyncHtmlLog,
-                new FB::AsyncLogRequest(shared_from_this(), str));
+                new FB::AsyncLogRequest(shared_from_this()), AsyncPriority_Bulk);
         } catch (const std::exception&) {
             // This fails during shutdown; ignore it
+            boost::mutex::scoped_lock _l(m_htmlLogMutex);
+            m_htmlLogScheduled = false;
         }
     }
 }
@@ -113,22 +170,40 @@ void FB::BrowserHost::htmlLog(const std::string& str)
 void FB::BrowserHost::AsyncHtmlLog(void *logReq)
 {
     FB::AsyncLogRequest *req = (FB::AsyncLogRequest*)logReq;
+    req->m_host->deliverPendingHtmlLog();
+    delete req;
+}
+
+void FB::BrowserHost::deliverPendingHtmlLog()
+{
+    std::vector<std::string> lines;
+    uint32_t dropped(0);
+    {
+        boost::mutex::scoped_lock _l(m_htmlLogMutex);
+        lines.swap(m_htmlLogPending);
+        dropped = m_htmlLogDropped;
+        m_htmlLogDropped = 0;
+        m_htmlLogScheduled = false;
+    }
     try {
-        FB::DOM::WindowPtr window = req->m_host->getDOMWindow();
+        FB::DOM::WindowPtr window = getDOMWindow();
 
         if (window && window->getJSObject()->HasProperty("console")) {
             FB::JSObjectPtr obj = window->getProperty<FB::JSObjectPtr>("console");
-            printf("Logging: %s\n", req->m_msg.c_str());
-            if (obj)
-                obj->Invoke("log", FB::variant_list_of(req->m_msg));
+            if (obj) {
+                for (std::vector<std::string>::const_iterator it = lines.begin(); it != lines.end(); ++it)
+                    obj->Invoke("log", FB::variant_list_of(*it));
+                if (dropped) {
+                    std::ostringstream note;
+                    note << "htmlLog: " << dropped << " line(s) dropped";
+                    obj->Invoke("log", FB::variant_list_of(note.str()));
+                }
+            }
         }
     } catch (const std::exception &) {
-        // printf("Exception: %s\n", e.what());
         // Fail silently; logging should not require success.
         FBLOG_TRACE("BrowserHost", "Logging to browser console failed");
-        return;
     }
-    delete req;
 }
 
 void FB::BrowserHost::evaluateJavaScript(const std::wstring &script)
@@ -198,11 +273,52 @@ FB::JSObjectPtr FB::BrowserHost::getDelayedInvokeDelegate() {
     return FB::JSObjectPtr();
 }
 
+FB::JSObjectPtr FB::BrowserHost::getCompiledJSFunction(const std::string& fnSrc)
+{
+    assertMainThread();
+    std::map<std::string, FB::JSObjectPtr>::const_iterator fnd = m_compiledSnippets.find(fnSrc);
+    if (fnd != m_compiledSnippets.end())
+        return fnd->second;
+
+    FB::DOM::WindowPtr win(getDOMWindow());
+    if (!win)
+        return FB::JSObjectPtr();
+
+    FB::JSObjectPtr fn;
+    try {
+        FB::JSObjectPtr ctor = win->getProperty<FB::JSObjectPtr>("Function");
+        if (!ctor)
+            return FB::JSObjectPtr();
+        // new Function("return (src);") wraps the snippet; calling the wrapper once
+        // evaluates the function expression and yields the handle we keep
+        FB::JSObjectPtr wrapper =
+            ctor->Construct(FB::variant_list_of("return (" + fnSrc + ");")).convert_cast<FB::JSObjectPtr>();
+        if (wrapper)
+            fn = wrapper->Invoke("", FB::VariantList()).convert_cast<FB::JSObjectPtr>();
+    } catch (const FB::script_error&) {
+        return FB::JSObjectPtr();
+    } catch (const FB::bad_variant_cast&) {
+        return FB::JSObjectPtr();
+    }
+    if (fn)
+        m_compiledSnippets[fnSrc] = fn;
+    return fn;
+}
+
+FB::variant FB::BrowserHost::callJSFunction(const std::string& fnSrc, const FB::VariantList& args)
+{
+    FB::JSObjectPtr fn(getCompiledJSFunction(fnSrc));
+    if (!fn)
+        throw FB::script_error("Could not compile javascript snippet");
+    return fn->Invoke("", args);
+}
+
 FB::DOM::WindowPtr FB::BrowserHost::_createWindow(const FB::JSObjectPtr& obj) const
 {
     return FB::DOM::WindowPtr(new FB::DOM::Window(obj));
 }
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
 FB::DOM::DocumentPtr FB::BrowserHost::_createDocument(const FB::JSObjectPtr& obj) const
 {
     return FB::DOM::DocumentPtr(new FB::DOM::Document(obj));
@@ -212,6 +328,7 @@ FB::DOM::ElementPtr FB::BrowserHost::_createElement(const FB::JSObjectPtr& obj)
 {
     return FB::DOM::ElementPtr(new FB::DOM::Element(obj));
 }
+#endif
 
 FB::DOM::NodePtr FB::BrowserHost::_createNode(const FB::JSObjectPtr& obj) const
 {
@@ -285,25 +402,111 @@ void FB::AsyncCallManager::call( _asyncCallData* data )
             data = NULL;
     }
     if (data) {
+        FBTRACE_SCOPE("ScriptingCore", "AsyncCallManager::call");
         data->call();
         delete data;
     }
 }
 
-FB::_asyncCallData* FB::AsyncCallManager::makeCallback(void (*func)(void *), void * userData)
+FB::_asyncCallData* FB::AsyncCallManager::makeCallback(void (*func)(void *), void * userData, AsyncCallPriority priority)
 {
     boost::recursive_mutex::scoped_lock _l(m_mutex);
-    _asyncCallData *data = new _asyncCallData(func, userData, ++lastId, shared_from_this());
+    _asyncCallData *data = new _asyncCallData(func, userData, ++lastId, priority, shared_from_this());
     DataList.insert(data);
     return data;
 }
 
+void FB::AsyncCallManager::noteEnqueued( _asyncCallData* data )
+{
+    data->enqueued = boost::posix_time::microsec_clock::universal_time();
+    ++m_enqueued;
+    size_t depth = 0;
+    for (size_t lane = 0; lane < LaneCount; ++lane)
+        depth += m_lanes[lane].size();
+    if (depth > m_highWater)
+        m_highWater = depth;
+}
+
+void FB::AsyncCallManager::enqueue( _asyncCallData* data )
+{
+    boost::recursive_mutex::scoped_lock _l(m_mutex);
+    m_lanes[data->priority].push_back(data);
+    noteEnqueued(data);
+}
+
+FB::_asyncCallData* FB::AsyncCallManager::popNext()
+{
+    boost::recursive_mutex::scoped_lock _l(m_mutex);
+    for (size_t lane = 0; lane < LaneCount; ++lane) {
+        if (!m_lanes[lane].empty()) {
+            _asyncCallData* data = m_lanes[lane].front();
+            m_lanes[lane].pop_front();
+            ++m_drained;
+            return data;
+        }
+    }
+    return NULL;
+}
+
+void FB::AsyncCallManager::removeQueued( _asyncCallData* data )
+{
+    boost::recursive_mutex::scoped_lock _l(m_mutex);
+    std::deque<_asyncCallData*>& lane(m_lanes[data->priority]);
+    std::deque<_asyncCallData*>::iterator fnd = std::find(lane.begin(), lane.end(), data);
+    if (fnd != lane.end()) {
+        lane.erase(fnd);
+        ++m_drained;
+    }
+}
+
 void FB::AsyncCallManager::remove(_asyncCallData* data)
 {
     boost::recursive_mutex::scoped_lock _l(m_mutex);
     DataList.erase(data);
 }
 
+bool FB::AsyncCallManager::enqueueBatched( _asyncCallData* data )
+{
+    boost::recursive_mutex::scoped_lock _l(m_mutex);
+    m_lanes[data->priority].push_back(data);
+    noteEnqueued(data);
+    if (!m_batchScheduled) {
+        // first entry since the last drain; the caller must post the wakeup
+        m_batchScheduled = true;
+        return true;
+    }
+    return false;
+}
+
+void FB::AsyncCallManager::cancelBatchWakeup( _asyncCallData* data )
+{
+    // The wakeup could not be posted; drop the entry and let the next enqueue retry
+    removeQueued(data);
+    boost::recursive_mutex::scoped_lock _l(m_mutex);
+    m_batchScheduled = false;
+}
+
+void FB::AsyncCallManager::drainBatch()
+{
+    FBTRACE_SCOPE("ScriptingCore", "AsyncCallManager::drainBatch");
+    std::deque<_asyncCallData*> batch[LaneCount];
+    {
+        boost::recursive_mutex::scoped_lock _l(m_mutex);
+        for (size_t lane = 0; lane < LaneCount; ++lane) {
+            batch[lane].swap(m_lanes[lane]);
+            m_drained += batch[lane].size();
+        }
+        m_batchScheduled = false;
+    }
+    // call() re-checks each entry against DataList, so entries already executed
+    // by shutdown() are skipped safely.  Urgent lane first.
+    for (size_t lane = 0; lane < LaneCount; ++lane) {
+        for (std::deque<_asyncCallData*>::const_iterator it = batch[lane].begin(); it != batch[lane].end(); ++it) {
+            call(*it);
+        }
+    }
+}
+
 void FB::AsyncCallManager::shutdown()
 {
     boost::recursive_mutex::scoped_lock _l(m_mutex);
@@ -313,6 +516,34 @@ void FB::AsyncCallManager::shutdown()
 
     std::for_each(DataList.begin(), DataList.end(), boost::lambda::bind(&_asyncCallData::call, boost::lambda::_1));
     DataList.clear();
+    // Anything still queued in the lanes was just executed above; drop the stale pointers
+    for (size_t lane = 0; lane < LaneCount; ++lane) {
+        m_drained += m_lanes[lane].size();
+        m_lanes[lane].clear();
+    }
+}
+
+FB::AsyncQueueStats FB::AsyncCallManager::getStats()
+{
+    boost::recursive_mutex::scoped_lock _l(m_mutex);
+    AsyncQueueStats s;
+    s.enqueued = m_enqueued;
+    s.drained = m_drained;
+    s.depth = 0;
+    s.highWater = m_highWater;
+    s.oldestAgeMs = 0;
+    // the front of each lane is the oldest entry in that lane; the oldest overall
+    // is the earliest of the three fronts
+    boost::posix_time::ptime now(boost::posix_time::microsec_clock::universal_time());
+    for (size_t lane = 0; lane < LaneCount; ++lane) {
+        s.depth += m_lanes[lane].size();
+        if (!m_lanes[lane].empty()) {
+            long age = static_cast<long>((now - m_lanes[lane].front()->enqueued).total_milliseconds());
+            if (age > s.oldestAgeMs)
+                s.oldestAgeMs = age;
+        }
+    }
+    return s;
 }
 
 FB::AsyncCallManager::~AsyncCallManager()
@@ -323,26 +554,68 @@ FB::AsyncCallManager::~AsyncCallManager()
 
 void asyncCallWrapper(void *userData)
 {
-    // Verify AsyncCallManager still exists. If not, the _asyncCallData has already been dealt with.
-    FB::_asyncCallData* data(static_cast<FB::_asyncCallData*>(userData));
-    FB::AsyncCallManagerPtr ptr(data->mgr.lock());
+    // One wakeup serves one pending call, but always the most urgent one still
+    // queued; the weak reference is owned by this wakeup
+    FB::AsyncCallManagerWeakPtr* mgrRef(static_cast<FB::AsyncCallManagerWeakPtr*>(userData));
+    FB::AsyncCallManagerPtr ptr(mgrRef->lock());
+    delete mgrRef;
     if (ptr) {
-        ptr->call(data);
+        FB::_asyncCallData* data = ptr->popNext();
+        if (data) {
+            ptr->call(data);
+        }
     }
 }
 
-bool FB::BrowserHost::ScheduleAsyncCall( void (*func)(void *), void *userData ) const
+void asyncBatchCallWrapper(void *userData)
 {
+    // Verify AsyncCallManager still exists; the weak reference is owned by this wakeup
+    FB::AsyncCallManagerWeakPtr* mgrRef(static_cast<FB::AsyncCallManagerWeakPtr*>(userData));
+    FB::AsyncCallManagerPtr ptr(mgrRef->lock());
+    delete mgrRef;
+    if (ptr) {
+        ptr->drainBatch();
+    }
+}
+
+bool FB::BrowserHost::ScheduleAsyncCall( void (*func)(void *), void *userData,
+    AsyncCallPriority priority /*= AsyncPriority_Normal*/ ) const
+{
+    FBTRACE_INSTANT("ScriptingCore", "BrowserHost::ScheduleAsyncCall");
     if (isShutDown()) {
         return false;
-    } else {
-        _asyncCallData* data = _asyncManager->makeCallback(func, userData);
-        bool result = _scheduleAsyncCall(&asyncCallWrapper, data);
+    }
+    _asyncCallData* data = _asyncManager->makeCallback(func, userData, priority);
+    if (m_asyncCallBatching) {
+        if (!_asyncManager->enqueueBatched(data)) {
+            // a drain wakeup is already pending; it will pick this call up
+            return true;
+        }
+        AsyncCallManagerWeakPtr* mgrRef = new AsyncCallManagerWeakPtr(_asyncManager);
+        bool result = _scheduleAsyncCall(&asyncBatchCallWrapper, mgrRef);
         if (!result) {
+            delete mgrRef;
+            _asyncManager->cancelBatchWakeup(data);
             _asyncManager->remove(data);
         }
         return result;
     }
+    // One wakeup per call, but the wakeup serves whatever pending call is most
+    // urgent, so an urgent entry can jump ahead of queued bulk work
+    _asyncManager->enqueue(data);
+    AsyncCallManagerWeakPtr* mgrRef = new AsyncCallManagerWeakPtr(_asyncManager);
+    bool result = _scheduleAsyncCall(&asyncCallWrapper, mgrRef);
+    if (!result) {
+        delete mgrRef;
+        _asyncManager->removeQueued(data);
+        _asyncManager->remove(data);
+    }
+    return result;
+}
+
+FB::AsyncQueueStats FB::BrowserHost::getAsyncQueueStats() const
+{
+    return _asyncManager->getStats();
 }
 
 FB::BrowserStreamPtr FB::BrowserHost::createStream( const std::string& url,
@@ -17,11 +17,13 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #define H_FB_BROWSERHOSTWRAPPER
 
 #include "APITypes.h"
+#include <boost/cstdint.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/future.hpp>
 
 namespace FB
 {
@@ -42,18 +44,52 @@ namespace FB
     /// @struct AsyncLogRequest
     ///
     /// @brief  This class is used by BrowserHost for the BrowserHost::AsyncHtmlLog method
+    ///
+    /// It only carries the host; the log lines themselves sit in the host's pending buffer
+    /// until the scheduled delivery drains them in one batch
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     struct AsyncLogRequest
     {
-        AsyncLogRequest(const BrowserHostPtr& host, const std::string& message) : m_host(host), m_msg(message) { }
+        AsyncLogRequest(const BrowserHostPtr& host) : m_host(host) { }
 
         const boost::shared_ptr<BrowserHost> m_host;
-        std::string m_msg;
     };
 
     FB_FORWARD_PTR(AsyncCallManager);
     FB_FORWARD_PTR(BrowserStreamManager);
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @enum  AsyncCallPriority
+    ///
+    /// @brief  Priority lane for calls scheduled through BrowserHost::ScheduleAsyncCall
+    ///
+    /// Pending async calls are served urgent first, then normal, then bulk; calls within one
+    /// lane keep FIFO order.  Use AsyncPriority_Urgent for latency-critical callbacks (UI
+    /// events, JSCallback invocations) and AsyncPriority_Bulk for high-volume work such as
+    /// stream data delivery so it cannot starve the urgent lane.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    enum AsyncCallPriority {
+        AsyncPriority_Urgent = 0,
+        AsyncPriority_Normal = 1,
+        AsyncPriority_Bulk = 2
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @struct AsyncQueueStats
+    ///
+    /// @brief  Snapshot of the ScheduleAsyncCall pending-call gauges; see
+    ///         BrowserHost::getAsyncQueueStats()
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct AsyncQueueStats {
+        boost::uint64_t enqueued;   ///< total calls ever scheduled
+        boost::uint64_t drained;    ///< total calls ever taken off the queue
+        std::size_t depth;          ///< calls currently pending, all priority lanes combined
+        std::size_t highWater;      ///< deepest the pending queue has ever been
+        long oldestAgeMs;           ///< age of the oldest pending call in ms; 0 when empty
+    };
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @class  BrowserHost
     ///
@@ -101,15 +137,57 @@ namespace FB
         ///
         /// NOTE: This is a low level call; it is almost always better to use ScheduleOnMainThread
         ///
+        /// Pending calls are drained urgent lane first (see FB::AsyncCallPriority); within a
+        /// lane the order stays FIFO.  The default priority leaves the historical ordering
+        /// unchanged.
+        ///
         /// @param  func     The function to call.
         /// @param  userData The userData to pass to the function.
+        /// @param  priority The lane to schedule the call in; defaults to AsyncPriority_Normal
         ///
         /// @returns bool true if the call was scheduled, false if it could not be
         ///
         /// @see ScheduleOnMainThread
         /// @see CallOnMainThread
         ////////////////////////////////////////////////////////////////////////////////////////////////////
-        bool ScheduleAsyncCall(void (*func)(void *), void *userData) const;
+        bool ScheduleAsyncCall(void (*func)(void *), void *userData,
+            AsyncCallPriority priority = AsyncPriority_Normal) const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setAsyncCallBatching(bool enabled)
+        ///
+        /// @brief  Enables batched submission of async calls
+        ///
+        /// With batching enabled ScheduleAsyncCall() enqueues the call and posts at most one
+        /// browser wakeup (NPN_PluginThreadAsyncCall / window message) for the whole pending
+        /// batch; the next pump iteration drains every queued functor in priority order
+        /// (urgent, then normal, then bulk; FIFO within each lane).  This
+        /// amortizes the per-call wakeup cost when many small callbacks are scheduled per
+        /// second.  Off by default: execution order is unchanged, but all pending calls run
+        /// in a single pump iteration instead of one per iteration, so turn it on only if
+        /// your callbacks are cheap enough not to stall the message pump.
+        ///
+        /// @param  enabled  true to batch async calls, false for one wakeup per call
+        ///
+        /// @see ScheduleAsyncCall
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setAsyncCallBatching(bool enabled) { m_asyncCallBatching = enabled; }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn AsyncQueueStats getAsyncQueueStats() const
+        ///
+        /// @brief  Returns a snapshot of the pending async call gauges
+        ///
+        /// When a page feels sluggish this tells you whether the main-thread queue is backed
+        /// up: a growing depth or a large oldestAgeMs means the browser is not servicing
+        /// wakeups as fast as calls are scheduled.  Cheap enough to poll from a timer.
+        ///
+        /// @return counters and depth/age gauges for the ScheduleAsyncCall queue
+        ///
+        /// @see ScheduleAsyncCall
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        AsyncQueueStats getAsyncQueueStats() const;
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn template<class Functor> typename Functor::result_type CallOnMainThread(Functor func) const
@@ -128,15 +206,44 @@ namespace FB
         ///
         /// This is a synchronous cross-thread call, and as such may have a performance penalty.
         ///
-        /// @param  func    The functor to execute on the main thread created with boost::bind
+        /// @param  func        The functor to execute on the main thread created with boost::bind
+        /// @param  timeout_ms  If non-negative, the longest to wait for the main thread; on
+        ///                     expiry FB::sync_call_timeout is thrown and the call is abandoned
+        ///                     safely (since 1.7)
         ///
         /// @return The return value from the call
         /// @throws FB::script_error
+        /// @throws FB::sync_call_timeout
         /// @see ScheduleOnMainThread
         /// @since 1.3.0
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         template<class Functor>
-        typename Functor::result_type CallOnMainThread(Functor func) const;
+        typename Functor::result_type CallOnMainThread(Functor func, long timeout_ms = -1) const;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn template<class Functor> boost::shared_future<typename Functor::result_type> CallOnMainThreadAsync(Functor func) const
+        ///
+        /// @brief  Schedule a call on the main thread and get a future for the result.
+        ///
+        /// Unlike CallOnMainThread this does not block; the worker thread can issue several
+        /// calls back to back and wait on the futures only when it needs the results:
+        /// @code
+        /// boost::shared_future<int> a = host->CallOnMainThreadAsync(boost::bind(&Obj::m1, obj));
+        /// boost::shared_future<int> b = host->CallOnMainThreadAsync(boost::bind(&Obj::m2, obj));
+        /// int sum = a.get() + b.get(); // one stall instead of two round-trips
+        /// @endcode
+        ///
+        /// future::get() rethrows any FB::script_error raised by the call on the main thread.
+        ///
+        /// @param  func    The functor to execute on the main thread created with boost::bind
+        ///
+        /// @return A future for the return value of the call
+        /// @throws FB::script_error if the call could not be scheduled
+        /// @see CallOnMainThread
+        /// @see ScheduleOnMainThread
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        template<class Functor>
+        boost::shared_future<typename Functor::result_type> CallOnMainThreadAsync(Functor func) const;
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn template<class C, class Functor> void ScheduleOnMainThread(const boost::shared_ptr<C>& obj, Functor func) const
@@ -292,6 +399,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         bool isMainThread() const;
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual DOM::DocumentPtr getDOMDocument() = 0
         ///
@@ -301,6 +409,7 @@ namespace FB
         /// @see DOM::Document
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual DOM::DocumentPtr getDOMDocument() = 0;
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual DOM::WindowPtr getDOMWindow() = 0
@@ -312,6 +421,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual DOM::WindowPtr getDOMWindow() = 0;
 
+#ifndef FB_NO_DOM
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual DOM::ElementPtr getDOMElement() = 0
         ///
@@ -321,6 +431,7 @@ namespace FB
         /// @see DOM::Element
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual DOM::ElementPtr getDOMElement() = 0;
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void Navigate(const std::string& url, const std::string& target)
@@ -371,11 +482,58 @@ namespace FB
         FB::JSObjectPtr getDelayedInvokeDelegate();
         virtual void initJS(const void* inst);
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn FB::JSObjectPtr getCompiledJSFunction(const std::string& fnSrc)
+        ///
+        /// @brief  Compiles a javascript function expression in the page once and returns the
+        ///         function handle, caching it for subsequent calls with the same source
+        ///
+        /// evaluateJavaScript re-parses its script on every call; plugins that run the same few
+        /// helper snippets repeatedly with different data pay that parse/compile cost each time.
+        /// This compiles the snippet through the page's Function constructor the first time it is
+        /// seen and hands back the resulting function object; invoke it with Invoke("", args).
+        /// The cache lives until shutdown, so handles never outlive the page they were compiled in.
+        ///
+        /// Must be called on the main thread.  Returns an empty pointer if the DOM window is not
+        /// available or the snippet does not compile.
+        ///
+        /// @param  fnSrc   Source of a javascript function expression,
+        ///                 e.g. "function(a, b) { return a + b; }"
+        /// @return The compiled function handle
+        ///
+        /// @see callJSFunction
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        FB::JSObjectPtr getCompiledJSFunction(const std::string& fnSrc);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn FB::variant callJSFunction(const std::string& fnSrc, const FB::VariantList& args)
+        ///
+        /// @brief  Invokes a javascript function expression with the given arguments, compiling it
+        ///         on first use and reusing the compiled handle thereafter
+        ///
+        /// Convenience wrapper around getCompiledJSFunction; unlike evaluateJavaScript this
+        /// returns the result of the call.  Throws FB::script_error if the snippet cannot be
+        /// compiled.  Must be called on the main thread.
+        ///
+        /// @param  fnSrc   Source of a javascript function expression
+        /// @param  args    Arguments to pass to the function
+        /// @return The value returned by the function
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        FB::variant callJSFunction(const std::string& fnSrc, const FB::VariantList& args);
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void htmlLog(const std::string& str)
         ///
         /// @brief  Sends a log message to the containing web page using Console.log (firebug)
         ///
+        /// Lines are buffered and delivered to the page in one scheduled batch rather than one
+        /// main-thread call apiece, so diagnostic-heavy logging doesn't flood the main thread.
+        /// If lines arrive faster than the page drains them the buffer caps out and further
+        /// lines are dropped; the next delivered batch notes how many were lost.
+        ///
         /// @param  str The log message to send to the browser.
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual void htmlLog(const std::string& str);
@@ -473,8 +631,10 @@ namespace FB
 
     public:
         virtual FB::DOM::WindowPtr _createWindow(const FB::JSObjectPtr& obj) const;
+#ifndef FB_NO_DOM
         virtual FB::DOM::DocumentPtr _createDocument(const FB::JSObjectPtr& obj) const;
         virtual FB::DOM::ElementPtr _createElement(const FB::JSObjectPtr& obj) const;
+#endif
         virtual FB::DOM::NodePtr _createNode(const FB::JSObjectPtr& obj) const;
 
     private:
@@ -496,6 +656,9 @@ namespace FB
         static int getInstanceCount() { return InstanceCount; }
 
     private:
+        // Drains the pending htmlLog lines into the page console; runs on the main thread
+        void deliverPendingHtmlLog();
+
         // Stores the thread_id for the thread the plugin was started on
         boost::thread::id m_threadId;
         // if true then the plugin this belongs to has shut down (or is shutting down)
@@ -511,9 +674,19 @@ namespace FB
 
         // Indicates if html logging should be enabled (default true)
         bool m_htmlLogEnabled;
+        // htmlLog batching: pending lines accumulate here and one AsyncHtmlLog per batch
+        // drains them; lines past the cap are counted instead of queued
+        mutable boost::mutex m_htmlLogMutex;
+        std::vector<std::string> m_htmlLogPending;
+        bool m_htmlLogScheduled;
+        uint32_t m_htmlLogDropped;
+        // Indicates if async calls should share one wakeup per pump iteration (default false)
+        bool m_asyncCallBatching;
 
         std::string unique_key;
         std::string call_delegate;
+        // Compiled snippet handles keyed by source; cleared on shutdown with the page
+        std::map<std::string, FB::JSObjectPtr> m_compiledSnippets;
     };
 
 
@@ -0,0 +1,251 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <boost/thread/mutex.hpp>
+#include "JSObject.h"
+#include "variant_list.h"
+
+#include "CallRecorder.h"
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+// Trace file format, one call per line after a "# fbcallrec 1" header:
+//
+//   <offset_us> <duration_us> I <member> <argc> <token>...
+//   <offset_us> <duration_us> G <member>
+//   <offset_us> <duration_us> S <member> <token>
+//
+// Member names and string payloads are %XX-escaped so every field is a single
+// whitespace-free word; see encodeArg for the token grammar.
+
+volatile int FB::CallRecorder::recordingActive = 0;
+
+namespace
+{
+    boost::mutex g_recMutex;
+    std::ofstream* g_recStream = NULL;
+    boost::posix_time::ptime g_recEpoch;
+
+    // Escapes whitespace, '%' and non-printable bytes so a field stays one word
+    std::string escapeField(const std::string& in)
+    {
+        std::string out;
+        out.reserve(in.size());
+        for (std::string::size_type i = 0; i < in.size(); ++i) {
+            const unsigned char c = static_cast<unsigned char>(in[i]);
+            if (c <= 0x20 || c == '%' || c >= 0x7f) {
+                char buf[4];
+                std::sprintf(buf, "%%%02X", c);
+                out += buf;
+            } else {
+                out += in[i];
+            }
+        }
+        return out;
+    }
+
+    std::string unescapeField(const std::string& in)
+    {
+        std::string out;
+        out.reserve(in.size());
+        for (std::string::size_type i = 0; i < in.size(); ++i) {
+            if (in[i] == '%' && i + 2 < in.size()) {
+                const std::string hex(in.substr(i + 1, 2));
+                out += static_cast<char>(std::strtol(hex.c_str(), NULL, 16));
+                i += 2;
+            } else {
+                out += in[i];
+            }
+        }
+        return out;
+    }
+
+    // Appends one line; caller holds g_recMutex and has checked g_recStream
+    void writeLine(const std::string& line)
+    {
+        const long tUs = static_cast<long>((
+            boost::posix_time::microsec_clock::universal_time() - g_recEpoch)
+            .total_microseconds());
+        // flush per line so a trace from a session that crashes is still usable
+        (*g_recStream) << tUs << ' ' << line << std::endl;
+    }
+}
+
+bool FB::CallRecorder::start(const std::string& path)
+{
+    boost::mutex::scoped_lock lock(g_recMutex);
+    if (g_recStream)
+        return false;
+    std::ofstream* stream = new std::ofstream(path.c_str(),
+        std::ios::out | std::ios::trunc);
+    if (!stream->is_open()) {
+        delete stream;
+        return false;
+    }
+    (*stream) << "# fbcallrec 1" << std::endl;
+    g_recStream = stream;
+    g_recEpoch = boost::posix_time::microsec_clock::universal_time();
+    recordingActive = 1;
+    return true;
+}
+
+void FB::CallRecorder::stop()
+{
+    boost::mutex::scoped_lock lock(g_recMutex);
+    recordingActive = 0;
+    if (g_recStream) {
+        g_recStream->close();
+        delete g_recStream;
+        g_recStream = NULL;
+    }
+}
+
+void FB::CallRecorder::recordInvoke(const std::string& member,
+    const FB::VariantList& args, long durationUs)
+{
+    boost::mutex::scoped_lock lock(g_recMutex);
+    if (!g_recStream)
+        return;
+    std::ostringstream line;
+    line << durationUs << " I " << escapeField(member) << ' ' << args.size();
+    for (FB::VariantList::const_iterator it = args.begin(); it != args.end(); ++it)
+        line << ' ' << encodeArg(*it);
+    writeLine(line.str());
+}
+
+void FB::CallRecorder::recordGetProperty(const std::string& member, long durationUs)
+{
+    boost::mutex::scoped_lock lock(g_recMutex);
+    if (!g_recStream)
+        return;
+    std::ostringstream line;
+    line << durationUs << " G " << escapeField(member);
+    writeLine(line.str());
+}
+
+void FB::CallRecorder::recordSetProperty(const std::string& member,
+    const FB::variant& value, long durationUs)
+{
+    boost::mutex::scoped_lock lock(g_recMutex);
+    if (!g_recStream)
+        return;
+    std::ostringstream line;
+    line << durationUs << " S " << escapeField(member) << ' ' << encodeArg(value);
+    writeLine(line.str());
+}
+
+std::string FB::CallRecorder::encodeArg(const FB::variant& value)
+{
+    using namespace FB::variant_detail;
+    std::ostringstream token;
+    switch (value.get_type_tag()) {
+        case tag_empty:
+            return "v";
+        case tag_bool:
+            return value.cast<bool>() ? "b:1" : "b:0";
+        case tag_char: case tag_uchar: case tag_short: case tag_ushort:
+        case tag_int: case tag_uint: case tag_long: case tag_ulong:
+        case tag_longlong: case tag_ulonglong:
+            token << "i:" << value.convert_cast<long long>();
+            return token.str();
+        case tag_float: case tag_double:
+            token << "d:" << value.convert_cast<double>();
+            return token.str();
+        case tag_string: {
+            const std::string& s = value.cast<std::string>();
+            token << "s:" << s.size();
+            if (s.size() <= 64)
+                token << ':' << escapeField(s);
+            return token.str();
+        }
+        case tag_wstring: {
+            const std::wstring& s = value.cast<std::wstring>();
+            token << "w:" << s.size();
+            return token.str();
+        }
+        case tag_other:
+        default:
+            break;
+    }
+    if (value.is_null())
+        return "n";
+    if (value.is_of_type<FB::VariantList>()) {
+        token << "l:" << value.cast<FB::VariantList>().size();
+        return token.str();
+    }
+    if (value.is_of_type<FB::VariantMap>()) {
+        token << "m:" << value.cast<FB::VariantMap>().size();
+        return token.str();
+    }
+    if (value.is_of_type<FB::JSObjectPtr>() || value.is_of_type<FB::JSAPIPtr>()
+        || value.is_of_type<FB::JSAPIWeakPtr>())
+        return "o";
+    token << "u:" << escapeField(value.get_type().name());
+    return token.str();
+}
+
+FB::variant FB::CallRecorder::decodeArg(const std::string& token)
+{
+    if (token.empty() || token == "v")
+        return FB::variant();
+    if (token == "n")
+        return FB::FBNull();
+    if (token == "o")
+        return FB::JSObjectPtr();
+
+    const char kind = token[0];
+    const std::string body = token.size() > 2 ? token.substr(2) : std::string();
+    switch (kind) {
+        case 'b':
+            return body == "1";
+        case 'i':
+            return static_cast<long long>(std::strtoll(body.c_str(), NULL, 10));
+        case 'd':
+            return std::strtod(body.c_str(), NULL);
+        case 's': {
+            const std::string::size_type colon = body.find(':');
+            const size_t len = static_cast<size_t>(
+                std::strtoul(body.substr(0, colon).c_str(), NULL, 10));
+            if (colon != std::string::npos) {
+                const std::string content(unescapeField(body.substr(colon + 1)));
+                if (content.size() == len)
+                    return content;
+            }
+            // long string recorded by size only; synthesize an equivalent payload
+            return std::string(len, 'x');
+        }
+        case 'w':
+            return std::wstring(static_cast<size_t>(
+                std::strtoul(body.c_str(), NULL, 10)), L'x');
+        case 'l':
+            return FB::VariantList(static_cast<size_t>(
+                std::strtoul(body.c_str(), NULL, 10)), FB::variant(0));
+        case 'm': {
+            FB::VariantMap map;
+            const size_t n = static_cast<size_t>(std::strtoul(body.c_str(), NULL, 10));
+            for (size_t i = 0; i < n; ++i) {
+                std::ostringstream key;
+                key << "k" << i;
+                map[key.str()] = 0;
+            }
+            return map;
+        }
+        default:
+            return FB::FBNull();
+    }
+}
+
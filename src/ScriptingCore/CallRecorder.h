@@ -0,0 +1,137 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_CALLRECORDER
+#define H_FB_CALLRECORDER
+
+#include <string>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "APITypes.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Record-and-replay capture of the page's calls into the plugin.
+///
+/// While recording is active, every JSAPIAuto invoke / property get / property set is appended
+/// to a plain-text trace file with its time offset, duration and argument payloads, no matter
+/// which browser bridge (NPAPI or ActiveX) delivered it.  The mock host's CallReplayer can then
+/// re-execute the trace against a fresh JSAPI at original or accelerated pacing, which turns a
+/// customer performance incident into a benchmark we can run on a desk.
+///
+/// Arguments are stored as compact tokens: scalars and short strings keep their value, long
+/// strings and containers keep their size (the replayer synthesizes equivalent payloads), and
+/// browser objects are recorded as opaque (replayed as null).  When recording is off the hooks
+/// cost a single flag test.
+///
+/// @since 1.7
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace FB { namespace CallRecorder {
+
+    /// Nonzero while a trace file is open; read directly by the hooks
+    extern volatile int recordingActive;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn bool start(const std::string& path)
+    ///
+    /// @brief  Opens path and starts recording; returns false if the file can't be created
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    bool start(const std::string& path);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn void stop()
+    ///
+    /// @brief  Stops recording and closes the trace file; harmless if not recording
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    void stop();
+
+    inline bool isRecording() { return recordingActive != 0; }
+
+    void recordInvoke(const std::string& member, const FB::VariantList& args, long durationUs);
+    void recordGetProperty(const std::string& member, long durationUs);
+    void recordSetProperty(const std::string& member, const FB::variant& value, long durationUs);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn std::string encodeArg(const FB::variant& value)
+    ///
+    /// @brief  Encodes one variant as a whitespace-free trace token
+    ///
+    /// Scalars and strings up to 64 characters round-trip exactly; longer strings and
+    /// containers keep only their size, browser objects only their kind.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::string encodeArg(const FB::variant& value);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn FB::variant decodeArg(const std::string& token)
+    ///
+    /// @brief  Rebuilds a variant from a trace token; size-only tokens get synthetic payloads
+    ///         of the recorded size
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    FB::variant decodeArg(const std::string& token);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  ScopedRecord
+    ///
+    /// @brief  Times one bridge call and appends it to the trace when it ends
+    ///
+    /// Placed at the top of the JSAPIAuto dispatch functions; arms itself only if recording
+    /// was active on entry and records from the destructor, so calls that throw are captured
+    /// too (the replayer reproduces the failing call).  The referenced args/value must outlive
+    /// the scope, which they do as dispatch parameters.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class ScopedRecord
+    {
+    public:
+        ScopedRecord(char kind, const std::string& member,
+                     const FB::VariantList* args = NULL, const FB::variant* value = NULL)
+            : m_armed(recordingActive != 0), m_kind(kind), m_member(member)
+            , m_args(args), m_value(value)
+        {
+            if (m_armed)
+                m_start = boost::posix_time::microsec_clock::universal_time();
+        }
+        ~ScopedRecord() {
+            if (!m_armed)
+                return;
+            try {
+                const long durUs = static_cast<long>((
+                    boost::posix_time::microsec_clock::universal_time() - m_start)
+                    .total_microseconds());
+                if (m_kind == 'I')
+                    recordInvoke(m_member, m_args ? *m_args : FB::VariantList(), durUs);
+                else if (m_kind == 'S')
+                    recordSetProperty(m_member, m_value ? *m_value : FB::variant(), durUs);
+                else
+                    recordGetProperty(m_member, durUs);
+            } catch (...) {
+                // never let trace I/O turn into a crash in the recorded plugin
+            }
+        }
+    private:
+        bool m_armed;
+        char m_kind;
+        const std::string& m_member;
+        const FB::VariantList* m_args;
+        const FB::variant* m_value;
+        boost::posix_time::ptime m_start;
+    };
+
+} }
+
+#endif // H_FB_CALLRECORDER
+
@@ -17,6 +17,52 @@ Copyright 2010 Richard Bateman, Firebreath development team
 
 using namespace FB;
 
+namespace {
+    // Process-wide stall accounting; one entry per completed (or abandoned) sync wait.
+    // Sync calls are heavyweight to begin with, so a mutex here costs nothing measurable.
+    boost::mutex g_statsMutex;
+    CrossThreadCall::SyncCallStats g_stats;     // zero-initialized static
+    long g_stallThresholdMs = 1000;
+}
+
+void CrossThreadCall::recordSyncWait(long waitMs, const char* origin, bool timedOut)
+{
+    bool stall;
+    {
+        boost::lock_guard<boost::mutex> lock(g_statsMutex);
+        ++g_stats.calls;
+        int bucket = 0;
+        for (long v = waitMs; v > 0 && bucket < SyncCallStats::kHistBuckets - 1; v >>= 1)
+            ++bucket;
+        ++g_stats.histogram[bucket];
+        if (timedOut)
+            ++g_stats.timeouts;
+        stall = waitMs >= g_stallThresholdMs;
+        if (stall)
+            ++g_stats.stalls;
+        if (waitMs > g_stats.maxWaitMs) {
+            g_stats.maxWaitMs = waitMs;
+            g_stats.maxWaitOrigin = origin ? origin : "";
+        }
+    }
+    if (stall) {
+        FBLOG_WARN("CrossThreadCall", "syncCall waited " << waitMs << "ms for the main thread"
+            << (timedOut ? " (timed out)" : "") << "; functor: " << (origin ? origin : "?"));
+    }
+}
+
+CrossThreadCall::SyncCallStats CrossThreadCall::getSyncCallStats()
+{
+    boost::lock_guard<boost::mutex> lock(g_statsMutex);
+    return g_stats;
+}
+
+void CrossThreadCall::setSyncCallStallThreshold(long ms)
+{
+    boost::lock_guard<boost::mutex> lock(g_statsMutex);
+    g_stallThresholdMs = ms;
+}
+
 void CrossThreadCall::syncCallbackFunctor(void *userData)
 {
     std::auto_ptr<CrossThreadCallWeakPtr> callWeak(static_cast<CrossThreadCallWeakPtr*>(userData));
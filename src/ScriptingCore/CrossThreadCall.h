@@ -19,13 +19,18 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include <string>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/future.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/cstdint.hpp>
 #include "APITypes.h"
 #include "JSObject.h"
 #include "BrowserHost.h"
 #include <boost/weak_ptr.hpp>
 #include <boost/make_shared.hpp>
+#include "ThreadCachedPool.h"
 #include <boost/scoped_ptr.hpp>
 #include "logging.h"
+#include "TraceEvents.h"
 
 namespace FB {
 
@@ -77,28 +82,156 @@ namespace FB {
         boost::shared_ptr<C> reference;
     };
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  FutureFunctorCall
+    ///
+    /// @brief  FunctorCall that fulfills a promise with the functor result (or exception)
+    ///
+    /// Used by CrossThreadCall::asyncCallWithResult; the caller keeps the future, the main
+    /// thread runs call().  Exceptions thrown by the functor are captured and rethrown from
+    /// future::get() on the calling thread.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<class Functor, class RT = typename Functor::result_type>
+    class FutureFunctorCall : public FunctorCall
+    {
+    public:
+        FutureFunctorCall(const Functor &func) : func(func) {}
+        ~FutureFunctorCall() {
+            FBLOG_TRACE("FunctorCall", "Destroying FutureFunctorCall object (non-void)");
+        }
+        void call() {
+            try {
+                promise.set_value(func());
+            } catch (const FB::script_error& e) {
+                promise.set_exception(boost::copy_exception(e));
+            } catch (...) {
+                promise.set_exception(boost::current_exception());
+            }
+        }
+        boost::shared_future<RT> getFuture() {
+            boost::unique_future<RT> f = promise.get_future();
+            return f.share();
+        }
+
+    protected:
+        Functor func;
+        boost::promise<RT> promise;
+    };
+
+    template<class Functor>
+    class FutureFunctorCall<Functor, void> : public FunctorCall
+    {
+    public:
+        FutureFunctorCall(const Functor &func) : func(func) {}
+        ~FutureFunctorCall() {
+            FBLOG_TRACE("FunctorCall", "Destroying FutureFunctorCall object (void)");
+        }
+        void call() {
+            try {
+                func();
+                promise.set_value();
+            } catch (const FB::script_error& e) {
+                promise.set_exception(boost::copy_exception(e));
+            } catch (...) {
+                promise.set_exception(boost::current_exception());
+            }
+        }
+        boost::shared_future<void> getFuture() {
+            boost::unique_future<void> f = promise.get_future();
+            return f.share();
+        }
+
+    protected:
+        Functor func;
+        boost::promise<void> promise;
+    };
+
     FB_FORWARD_PTR(CrossThreadCall);
 
     class CrossThreadCall
     {
     public:
         virtual ~CrossThreadCall() { }
+
+        // Call records are allocated on the calling thread and freed on the main thread;
+        // recycle them through the thread-cached pool instead of the global allocator
+        static void* operator new(std::size_t size) { return detail::ThreadCachedPool::allocate(size); }
+        static void operator delete(void* ptr, std::size_t size) { detail::ThreadCachedPool::deallocate(ptr, size); }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn template<class Functor> static typename Functor::result_type syncCall(const FB::BrowserHostConstPtr &host, Functor func, long timeout_ms = -1)
+        ///
+        /// @brief  Runs func on the main thread and blocks for the result
+        ///
+        /// A non-negative timeout_ms bounds the wait: if the main thread hasn't serviced the
+        /// call by then, FB::sync_call_timeout is thrown and the abandoned call is skipped if
+        /// the queue ever drains it.  Every wait is recorded in the stall accounting (see
+        /// getSyncCallStats), so main-thread congestion is visible in the field.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
         template<class Functor>
-        static typename Functor::result_type syncCall(const FB::BrowserHostConstPtr &host, Functor func);
+        static typename Functor::result_type syncCall(const FB::BrowserHostConstPtr &host, Functor func, long timeout_ms = -1);
 
         template<class Functor>
-        static typename Functor::result_type syncCallHelper(const FB::BrowserHostConstPtr &host, Functor func, boost::true_type /* is void */);
+        static typename Functor::result_type syncCallHelper(const FB::BrowserHostConstPtr &host, Functor func, long timeout_ms, boost::true_type /* is void */);
         template<class Functor>
-        static typename Functor::result_type syncCallHelper(const FB::BrowserHostConstPtr &host, Functor func, boost::false_type /* is void */);
+        static typename Functor::result_type syncCallHelper(const FB::BrowserHostConstPtr &host, Functor func, long timeout_ms, boost::false_type /* is void */);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct SyncCallStats
+        ///
+        /// @brief  Snapshot of the process-wide sync-call stall accounting
+        ///
+        /// Every syncCall wait lands in a power-of-two histogram bucket (bucket 0 is under
+        /// 1ms, bucket n covers [2^(n-1), 2^n) ms), waits at or over the stall threshold bump
+        /// the stall counter and are logged with the functor's type name, and the longest wait
+        /// seen keeps its origin so the worst offender can be identified from a field report.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct SyncCallStats {
+            enum { kHistBuckets = 16 };
+            boost::uint64_t histogram[kHistBuckets];
+            boost::uint64_t calls;          ///< sync waits recorded (main-thread inline calls don't wait)
+            boost::uint64_t stalls;         ///< waits at or over the stall threshold
+            boost::uint64_t timeouts;       ///< waits abandoned through the timeout_ms parameter
+            long maxWaitMs;                 ///< longest wait observed
+            std::string maxWaitOrigin;      ///< typeid name of the functor behind the longest wait
+        };
+
+        /// @brief  Returns a copy of the current stall accounting
+        /// @since 1.7
+        static SyncCallStats getSyncCallStats();
+
+        /// @brief  Waits at or over this many ms count as stalls and are logged; default 1000
+        /// @since 1.7
+        static void setSyncCallStallThreshold(long ms);
 
         template<class C, class Functor>
         static void asyncCall(const FB::BrowserHostConstPtr &host, const boost::shared_ptr<C>& obj, Functor func);
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn template<class Functor> static boost::shared_future<typename Functor::result_type> asyncCallWithResult(const FB::BrowserHostConstPtr &host, Functor func)
+        ///
+        /// @brief  Schedules func on the main thread and returns a future for its result
+        ///
+        /// Unlike syncCall this returns immediately, so a worker can pipeline several bridge
+        /// operations and block only once when it finally needs the results.  future::get()
+        /// rethrows any FB::script_error the functor raised on the main thread; if the host
+        /// shuts down before the functor runs, get() throws broken_promise instead.  Throws
+        /// FB::script_error immediately if the call cannot be scheduled at all.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        template<class Functor>
+        static boost::shared_future<typename Functor::result_type>
+        asyncCallWithResult(const FB::BrowserHostConstPtr &host, Functor func);
+
     protected:
         CrossThreadCall(const boost::shared_ptr<FunctorCall>& funct) : funct(funct), m_returned(false) { }
 
         static void asyncCallbackFunctor(void *userData);
         static void syncCallbackFunctor(void *userData);
+        // Feeds one completed (or abandoned) wait into the stall accounting; origin is the
+        // functor's typeid name
+        static void recordSyncWait(long waitMs, const char* origin, bool timedOut);
 
         boost::shared_ptr<FunctorCall> funct;
         variant m_result;
@@ -111,7 +244,8 @@ namespace FB {
     template<class C, class Functor>
     void CrossThreadCall::asyncCall(const FB::BrowserHostConstPtr &host, const boost::shared_ptr<C>& obj, Functor func)
     {
-        boost::shared_ptr<FunctorCall> funct = boost::make_shared<FunctorCallImpl<Functor, C> >(obj, func);
+        boost::shared_ptr<FunctorCall> funct =
+            boost::allocate_shared<FunctorCallImpl<Functor, C> >(detail::call_pool_allocator<void>(), obj, func);
         CrossThreadCall *call = new CrossThreadCall(funct);
         if (!host->ScheduleAsyncCall(&CrossThreadCall::asyncCallbackFunctor, call)) {
             // Host is likely shut down; at any rate, this didn't work. Since it's asynchronous, fail silently
@@ -121,20 +255,49 @@ namespace FB {
     }
 
     template<class Functor>
-    typename Functor::result_type CrossThreadCall::syncCall(const FB::BrowserHostConstPtr &host, Functor func)
+    boost::shared_future<typename Functor::result_type>
+    CrossThreadCall::asyncCallWithResult(const FB::BrowserHostConstPtr &host, Functor func)
     {
+        typedef typename Functor::result_type RT;
+        boost::shared_ptr<FutureFunctorCall<Functor> > funct =
+            boost::allocate_shared<FutureFunctorCall<Functor> >(detail::call_pool_allocator<void>(), func);
+        boost::shared_future<RT> future(funct->getFuture());
+        if (host->isMainThread()) {
+            funct->call();
+        } else {
+            // asyncCallbackFunctor owns and deletes the CrossThreadCall; the promise is
+            // fulfilled (or broken on shutdown) from the main thread
+            CrossThreadCall *call = new CrossThreadCall(funct);
+            if (!host->ScheduleAsyncCall(&CrossThreadCall::asyncCallbackFunctor, call)) {
+                delete call;
+                throw FB::script_error("Could not marshal to main thread");
+            }
+        }
+        return future;
+    }
+
+    template<class Functor>
+    typename Functor::result_type CrossThreadCall::syncCall(const FB::BrowserHostConstPtr &host, Functor func, long timeout_ms)
+    {
+        if (host->isMainThread()) {
+            // Already on the main thread; run the functor inline instead of paying for
+            // the wrapper allocation and mutex/condition setup just to detect this later
+            return func();
+        }
         typedef boost::is_same<void, typename Functor::result_type> is_void;
-        return syncCallHelper(host, func, is_void());
+        FBTRACE_SCOPE("ScriptingCore", "CrossThreadCall::syncCall");
+        return syncCallHelper(host, func, timeout_ms, is_void());
     }
 
     template <class Functor>
-    typename Functor::result_type CrossThreadCall::syncCallHelper(const FB::BrowserHostConstPtr &host, Functor func, boost::true_type /* return void */)
+    typename Functor::result_type CrossThreadCall::syncCallHelper(const FB::BrowserHostConstPtr &host, Functor func, long timeout_ms, boost::true_type /* return void */)
     {
         FB::variant varResult;
 
         // We make this shared so that if this is something that needs to be passed into the other thread,
         // it still goes away when everything is done with it
-        boost::shared_ptr<FunctorCallImpl<Functor, bool> > funct = boost::make_shared<FunctorCallImpl<Functor, bool> >(func);
+        boost::shared_ptr<FunctorCallImpl<Functor, bool> > funct =
+            boost::allocate_shared<FunctorCallImpl<Functor, bool> >(detail::call_pool_allocator<void>(), func);
         if (!host->isMainThread())
         {
             // Synchronous call means that we want call to go away when this scope ends
@@ -148,10 +311,24 @@ namespace FB {
                     throw FB::script_error("Could not marshal to main thread");
                 }
 
+                boost::posix_time::ptime waitStart(boost::posix_time::microsec_clock::universal_time());
+                bool timedOut = false;
                 while (!call->m_returned && !host->isShutDown()) {
                     boost::posix_time::time_duration wait_duration = boost::posix_time::milliseconds(10);
                     call->m_cond.timed_wait(lock, wait_duration);
+                    if (timeout_ms >= 0 && !call->m_returned && !host->isShutDown()
+                        && (boost::posix_time::microsec_clock::universal_time() - waitStart).total_milliseconds() >= timeout_ms) {
+                        timedOut = true;
+                        break;
+                    }
                 }
+                long waitedMs = static_cast<long>(
+                    (boost::posix_time::microsec_clock::universal_time() - waitStart).total_milliseconds());
+                recordSyncWait(waitedMs, typeid(Functor).name(), timedOut);
+                if (timedOut)
+                    // the weak-ptr handoff means the abandoned call is skipped if the
+                    // main thread ever drains it
+                    throw FB::sync_call_timeout();
                 if (host->isShutDown())
                     throw FB::script_error("Shutting down");
                 varResult = call->m_result;
@@ -159,7 +336,7 @@ namespace FB {
         } else {
             funct->call();
         }
-        
+
         if (varResult.get_type() == typeid(FB::script_error*)) {
             FB::script_error* tmp(varResult.cast<FB::script_error*>());
             std::string msg = tmp->what();
@@ -169,14 +346,15 @@ namespace FB {
     }
 
     template <class Functor>
-    typename Functor::result_type CrossThreadCall::syncCallHelper(const FB::BrowserHostConstPtr &host, Functor func, boost::false_type /* return not void */)
+    typename Functor::result_type CrossThreadCall::syncCallHelper(const FB::BrowserHostConstPtr &host, Functor func, long timeout_ms, boost::false_type /* return not void */)
     {
         typename Functor::result_type result;
         FB::variant varResult;
 
         // We make this shared so that if this is something that needs to be passed into the other thread,
         // it still goes away when everything is done with it
-        boost::shared_ptr<FunctorCallImpl<Functor, bool> > funct = boost::make_shared<FunctorCallImpl<Functor, bool> >(func);
+        boost::shared_ptr<FunctorCallImpl<Functor, bool> > funct =
+            boost::allocate_shared<FunctorCallImpl<Functor, bool> >(detail::call_pool_allocator<void>(), func);
         if (!host->isMainThread())
         {
             // Synchronous call means that we want call to go away when this scope ends
@@ -190,10 +368,24 @@ namespace FB {
                     throw FB::script_error("Could not marshal to main thread");
                 }
 
+                boost::posix_time::ptime waitStart(boost::posix_time::microsec_clock::universal_time());
+                bool timedOut = false;
                 while (!call->m_returned && !host->isShutDown()) {
                     boost::posix_time::time_duration wait_duration = boost::posix_time::milliseconds(10);
                     call->m_cond.timed_wait(lock, wait_duration);
+                    if (timeout_ms >= 0 && !call->m_returned && !host->isShutDown()
+                        && (boost::posix_time::microsec_clock::universal_time() - waitStart).total_milliseconds() >= timeout_ms) {
+                        timedOut = true;
+                        break;
+                    }
                 }
+                long waitedMs = static_cast<long>(
+                    (boost::posix_time::microsec_clock::universal_time() - waitStart).total_milliseconds());
+                recordSyncWait(waitedMs, typeid(Functor).name(), timedOut);
+                if (timedOut)
+                    // the weak-ptr handoff means the abandoned call is skipped if the
+                    // main thread ever drains it
+                    throw FB::sync_call_timeout();
                 if (host->isShutDown())
                     throw FB::script_error("Shutting down");
                 result = funct->getResult();
@@ -214,12 +406,19 @@ namespace FB {
 
     
     template <class Functor>
-    typename Functor::result_type BrowserHost::CallOnMainThread(Functor func) const
+    typename Functor::result_type BrowserHost::CallOnMainThread(Functor func, long timeout_ms) const
     {
         boost::shared_lock<boost::shared_mutex> _l(m_xtmutex);
-        return CrossThreadCall::syncCall(shared_from_this(), func);
+        return CrossThreadCall::syncCall(shared_from_this(), func, timeout_ms);
     }
     
+    template <class Functor>
+    boost::shared_future<typename Functor::result_type> BrowserHost::CallOnMainThreadAsync(Functor func) const
+    {
+        boost::shared_lock<boost::shared_mutex> _l(m_xtmutex);
+        return CrossThreadCall::asyncCallWithResult(shared_from_this(), func);
+    }
+
     template <class C, class Functor>
     void BrowserHost::ScheduleOnMainThread(const boost::shared_ptr<C>& obj, Functor func) const
     {
@@ -69,6 +69,7 @@ namespace FB {
 #include "DOM/Element.h"
 #include "DOM/Document.h"
 #include "DOM/Window.h"
+#include "DOM/MutationBatch.h"
 
 #endif // H_FB_DOM
 
@@ -12,8 +12,14 @@ License:    Dual license model; choose one of two:
 Copyright 2009 PacketPass, Inc and the Firebreath development team
 \**********************************************************/
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
 #include "variant.h"
 #include "variant_list.h"
+#include "JSCallback.h"
+#include "BrowserHost.h"
 #include "Window.h"
 #include "../precompiled_headers.h" // On windows, everything above this line in PCH
 
@@ -21,6 +27,41 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 
 using namespace FB::DOM;
 
+namespace {
+    // Bridges the page's one-shot notification back to the C++ functor, then drops
+    // the reference that kept the callback object alive across the wait
+    struct ElementWaitState {
+        ElementWaitState() {}
+
+        Document::ElementCallback callback;
+        FB::BrowserHostWeakPtr host;
+        FB::JSAPIWeakPtr self;
+
+        FB::variant fire(const std::vector<FB::variant>& args) {
+            ElementPtr el;
+            if (!args.empty()) {
+                try {
+                    FB::JSObjectPtr obj(args[0].convert_cast<FB::JSObjectPtr>());
+                    if (obj) {
+                        // the host can be gone if the page tore down mid-wait
+                        el = obj->m_host.lock() ? Element::create(obj)
+                                                : ElementPtr(new Element(obj));
+                    }
+                } catch (const std::bad_cast&) {}
+            }
+            Document::ElementCallback cb;
+            cb.swap(callback);  // fire at most once
+            if (cb)
+                cb(el);
+            FB::BrowserHostPtr h(host.lock());
+            FB::JSAPIPtr s(self.lock());
+            if (h && s)
+                h->releaseJSAPIPtr(s);
+            return FB::variant();
+        }
+    };
+}
+
 Document::Document(const FB::JSObjectPtr& element) : Node(element), Element(element)
 {
 }
@@ -52,3 +93,88 @@ FB::DOM::ElementPtr Document::createElement(const std::string &name) const
 	JSObjectPtr api = callMethod<FB::JSObjectPtr>("createElement", FB::variant_list_of(name));
 	return Element::create(api);
 }
+
+FB::VariantList Document::querySelectorData(const std::string& selector,
+    const std::vector<std::string>& attrs) const
+{
+    // Compile the collector with the page's own Function constructor and run it once;
+    // the whole scan happens in page context and only the finished payload crosses back
+    static const char* fnBody =
+        "var out = [];"
+        "var list = doc.querySelectorAll(sel);"
+        "for (var i = 0; i < list.length; i++) {"
+        "    var el = list[i], rec = {};"
+        "    for (var j = 0; j < attrs.length; j++) {"
+        "        var a = attrs[j];"
+        "        rec[a] = (a in el) ? el[a] : el.getAttribute(a);"
+        "    }"
+        "    out.push(rec);"
+        "}"
+        "return out;";
+
+    JSObjectPtr view = getProperty<FB::JSObjectPtr>("defaultView");
+    JSObjectPtr fnCtor = view->GetProperty("Function").convert_cast<FB::JSObjectPtr>();
+    JSObjectPtr fn = fnCtor->Construct(
+        FB::variant_list_of("doc")("sel")("attrs")(fnBody)).convert_cast<FB::JSObjectPtr>();
+
+    FB::VariantList attrList(attrs.begin(), attrs.end());
+    FB::variant result = fn->Invoke("", FB::variant_list_of(m_element)(selector)(attrList));
+
+    // Flatten each per-match record into a plain VariantMap so no live handles remain
+    FB::VariantList records = result.convert_cast<FB::VariantList>();
+    FB::VariantList out;
+    for (FB::VariantList::iterator it = records.begin(); it != records.end(); ++it)
+        out.push_back(it->convert_cast<FB::VariantMap>());
+    return out;
+}
+
+void Document::waitForElement(const std::string& id, const ElementCallback& callback) const
+{
+    // The whole wait runs in page context: present-now answers synchronously through
+    // the same callback, otherwise a MutationObserver (or the best available fallback)
+    // fires it exactly once when the node appears.  No polling from our side either way.
+    static const char* fnBody =
+        "var el = doc.getElementById(id);"
+        "if (el) { cb(el); return; }"
+        "var done = false;"
+        "var obs = null;"
+        "var finish = function (found) {"
+        "    if (done) return;"
+        "    done = true;"
+        "    if (obs) obs.disconnect();"
+        "    cb(found);"
+        "};"
+        "var recheck = function () {"
+        "    var found = doc.getElementById(id);"
+        "    if (found) finish(found);"
+        "};"
+        "if (typeof MutationObserver !== 'undefined') {"
+        "    obs = new MutationObserver(recheck);"
+        "    obs.observe(doc.documentElement || doc, { childList: true, subtree: true });"
+        "} else if (doc.addEventListener) {"
+        "    doc.addEventListener('DOMNodeInserted', recheck, false);"
+        "} else {"
+        "    doc.attachEvent('onreadystatechange', recheck);"
+        "    if (window.attachEvent) window.attachEvent('onload', recheck);"
+        "}";
+
+    FB::BrowserHostPtr host(m_element->m_host.lock());
+
+    boost::shared_ptr<ElementWaitState> state(boost::make_shared<ElementWaitState>());
+    state->callback = callback;
+    state->host = host;
+    FB::JSAPIPtr cb(new FB::JSCallback(boost::bind(&ElementWaitState::fire, state, _1)));
+    state->self = cb;
+    // Keep the callback object alive until the page fires it; fire() releases it again
+    if (host)
+        host->retainJSAPIPtr(cb);
+
+    JSObjectPtr view = getProperty<FB::JSObjectPtr>("defaultView");
+    JSObjectPtr fnCtor = view->GetProperty("Function").convert_cast<FB::JSObjectPtr>();
+    JSObjectPtr fn = fnCtor->Construct(
+        FB::variant_list_of("doc")("id")("cb")(fnBody)).convert_cast<FB::JSObjectPtr>();
+
+    fn->Invoke("", FB::variant_list_of(m_element)(id)(cb));
+}
+
+#endif // FB_NO_DOM
@@ -16,7 +16,11 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 #ifndef H_FB_DOM_DOCUMENT
 #define H_FB_DOM_DOCUMENT
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
+
 #include <string>
+#include <vector>
+#include <boost/function.hpp>
 #include "JSObject.h"
 #include "Element.h"
 
@@ -103,10 +107,60 @@ namespace FB { namespace DOM {
         /// @return DOM::ElementPtr wrapping the newly created element
         ////////////////////////////////////////////////////////////////////////////////////////////////////
 		virtual ElementPtr createElement(const std::string &name) const;
-	
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual FB::VariantList Document::querySelectorData(const std::string& selector,
+        ///         const std::vector<std::string>& attrs) const
+        ///
+        /// @brief  Evaluates a CSS selector in the page and returns the requested attributes of every
+        ///         match in one materialized payload
+        ///
+        /// The scan runs entirely in page context; only the finished result crosses the bridge.  Each
+        /// entry of the returned list is a FB::VariantMap of attribute name to plain value -- no live
+        /// handles -- so walking a large result set is one round-trip instead of one bridge call per
+        /// element per attribute.  Names are looked up as element properties first, falling back to
+        /// getAttribute for anything the element doesn't expose directly.
+        ///
+        /// @param  selector    CSS selector understood by document.querySelectorAll
+        /// @param  attrs       names of the properties/attributes to capture for each match
+        ///
+        /// @return FB::VariantList with one FB::VariantMap per matched element, in document order
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual FB::VariantList querySelectorData(const std::string& selector,
+            const std::vector<std::string>& attrs) const;
+
+        /// Receives the element once it exists; see waitForElement
+        typedef boost::function<void (const ElementPtr&)> ElementCallback;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void Document::waitForElement(const std::string& id,
+        ///         const ElementCallback& callback) const
+        ///
+        /// @brief  Invokes the callback once the element with the given id exists in the page,
+        ///         without polling
+        ///
+        /// A single page-side hook is installed: if the element already exists the callback fires
+        /// right away (from inside this call); otherwise a MutationObserver -- falling back to
+        /// DOMNodeInserted and finally to load/readystate events on old engines -- watches the
+        /// document and fires the callback exactly once when the node appears.  This replaces the
+        /// common Timer + getElementById loop, where every poll is a synchronous bridge call.
+        ///
+        /// The callback runs on the main thread with a wrapped handle to the found element.  If
+        /// the element never appears the callback is never invoked; the hook lives until the page
+        /// is torn down.
+        ///
+        /// @param  id          value of the element's id attribute to wait for
+        /// @param  callback    invoked once with the element when it exists
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void waitForElement(const std::string& id, const ElementCallback& callback) const;
+
 	};
 
 }; };
 
+#endif // FB_NO_DOM
+
 #endif // H_FB_DOM_DOCUMENT
 
@@ -12,6 +12,8 @@ License:    Dual license model; choose one of two:
 Copyright 2009 PacketPass, Inc and the Firebreath development team
 \**********************************************************/
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
+
 #include "variant_list.h"
 #include "../precompiled_headers.h" // On windows, everything above this line in PCH
 #include "Element.h"
@@ -109,3 +111,5 @@ std::string FB::DOM::Element::getStringAttribute( const std::string& attr ) cons
     return callMethod<std::string>("getAttribute", FB::variant_list_of(attr));
 }
 
+
+#endif // FB_NO_DOM
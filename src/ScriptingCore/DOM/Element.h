@@ -16,6 +16,8 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 #ifndef H_FB_DOM_ELEMENT
 #define H_FB_DOM_ELEMENT
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
+
 #include <string>
 #include "JSObject.h"
 #include "Node.h"
@@ -248,5 +250,7 @@ namespace FB { namespace DOM {
 
 }; };
 
+#endif // FB_NO_DOM
+
 #endif // H_FB_DOM_ELEMENT
 
@@ -0,0 +1,104 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
+
+#include "variant_list.h"
+#include "BrowserHost.h"
+#include "CrossThreadCall.h"
+#include <boost/bind.hpp>
+#include "../precompiled_headers.h" // On windows, everything above this line in PCH
+#include "MutationBatch.h"
+
+using namespace FB::DOM;
+
+void MutationBatch::setProperty(const NodePtr& node, const std::string& name, const FB::variant& value)
+{
+    Op op;
+    op.type = Op_SetProperty;
+    op.obj = node->getJSObject();
+    op.name = name;
+    op.value = value;
+    m_ops.push_back(op);
+}
+
+void MutationBatch::callMethod(const NodePtr& node, const std::string& name, const FB::VariantList& args)
+{
+    Op op;
+    op.type = Op_CallMethod;
+    op.obj = node->getJSObject();
+    op.name = name;
+    op.args = args;
+    m_ops.push_back(op);
+}
+
+void MutationBatch::setInnerHTML(const ElementPtr& el, const std::string& html)
+{
+    setProperty(el, "innerHTML", html);
+}
+
+void MutationBatch::setWidth(const ElementPtr& el, int width)
+{
+    setProperty(el, "width", width);
+}
+
+void MutationBatch::setHeight(const ElementPtr& el, int height)
+{
+    setProperty(el, "height", height);
+}
+
+void MutationBatch::setAttribute(const ElementPtr& el, const std::string& attr, const FB::variant& value)
+{
+    callMethod(el, "setAttribute", FB::variant_list_of(attr)(value));
+}
+
+void MutationBatch::flush()
+{
+    if (m_ops.empty())
+        return;
+
+    FB::BrowserHostPtr host;
+    try {
+        host = m_ops.front().obj->getHost();
+    } catch (const boost::bad_weak_ptr&) {
+        // no live host (shutting down, or a harness object); apply in place below
+    }
+
+    try {
+        if (host && !host->isMainThread())
+            host->CallOnMainThread(boost::bind(&MutationBatch::apply, this));
+        else
+            apply();
+    } catch (...) {
+        m_ops.clear();
+        throw;
+    }
+    m_ops.clear();
+}
+
+void MutationBatch::apply() const
+{
+    for (std::vector<Op>::const_iterator it = m_ops.begin(); it != m_ops.end(); ++it) {
+        switch (it->type) {
+            case Op_SetProperty:
+                it->obj->SetProperty(it->name, it->value);
+                break;
+            case Op_CallMethod:
+                it->obj->Invoke(it->name, it->args);
+                break;
+        }
+    }
+}
+
+#endif // FB_NO_DOM
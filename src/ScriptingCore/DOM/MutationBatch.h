@@ -0,0 +1,111 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_DOM_MUTATIONBATCH
+#define H_FB_DOM_MUTATIONBATCH
+
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
+
+#include <string>
+#include <vector>
+#include "JSObject.h"
+#include "Node.h"
+#include "Element.h"
+
+namespace FB { namespace DOM {
+
+    class MutationBatch;
+    typedef boost::shared_ptr<MutationBatch> MutationBatchPtr;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  MutationBatch
+    ///
+    /// @brief  Records a sequence of DOM mutations and applies them in one main-thread trip
+    ///
+    /// Each individual Element/Node mutator (setInnerHTML, setProperty, callMethod, ...) is a
+    /// bridge round-trip, and from a worker thread each one is a full CrossThreadCall.  A
+    /// MutationBatch records the operations instead and flush() marshals to the main thread
+    /// once, applying them all in order while it's there, so updating (say) a 50-row status
+    /// table costs one crossing instead of one per cell.
+    ///
+    /// @code
+    ///     FB::DOM::MutationBatch batch;
+    ///     for (size_t i = 0; i < rows.size(); ++i)
+    ///         batch.setInnerHTML(rows[i], rowText[i]);
+    ///     batch.flush();  // one main-thread trip for the whole update
+    /// @endcode
+    ///
+    /// The operations run in the order they were recorded.  If one of them throws, the ones
+    /// before it have been applied and the ones after it have not; the batch is cleared
+    /// either way.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class MutationBatch
+    {
+    public:
+        MutationBatch() { }
+
+        /// Records node.name = value
+        void setProperty(const NodePtr& node, const std::string& name, const variant& value);
+        /// Records node.name(args...), discarding the return value
+        void callMethod(const NodePtr& node, const std::string& name, const VariantList& args);
+
+        /// Records setting the element's inner html
+        void setInnerHTML(const ElementPtr& el, const std::string& html);
+        /// Records setting the width property of the element
+        void setWidth(const ElementPtr& el, int width);
+        /// Records setting the height property of the element
+        void setHeight(const ElementPtr& el, int height);
+        /// Records el.setAttribute(attr, value)
+        void setAttribute(const ElementPtr& el, const std::string& attr, const variant& value);
+
+        /// Number of operations recorded and not yet flushed
+        size_t size() const { return m_ops.size(); }
+        /// Discards the recorded operations without applying them
+        void clear() { m_ops.clear(); }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void flush()
+        ///
+        /// @brief  Applies all recorded operations in one main-thread trip and clears the batch
+        ///
+        /// Called on the main thread (or when no live BrowserHost is reachable) the operations
+        /// are applied in place.  A no-op on an empty batch.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void flush();
+
+    private:
+        enum OpType {
+            Op_SetProperty,
+            Op_CallMethod
+        };
+        struct Op {
+            OpType type;
+            JSObjectPtr obj;
+            std::string name;
+            variant value;      // Op_SetProperty
+            VariantList args;   // Op_CallMethod
+        };
+
+        // Runs the recorded operations in order; called on the main thread by flush()
+        void apply() const;
+
+        std::vector<Op> m_ops;
+    };
+
+}; };
+
+#endif // FB_NO_DOM
+
+#endif // H_FB_DOM_MUTATIONBATCH
@@ -41,6 +41,9 @@ void FB::DOM::Node::setProperty(const std::wstring& name, const FB::variant& val
 void FB::DOM::Node::setProperty(const std::string& name, const FB::variant& val) const
 {
     m_element->SetProperty(name, val);
+    // don't guess what the browser stored; the next read refetches it
+    if (m_cacheProperties)
+        m_propCache.erase(name);
 }
 
 void FB::DOM::Node::setProperty(const int idx, const FB::variant& val) const
@@ -48,6 +51,29 @@ void FB::DOM::Node::setProperty(const int idx, const FB::variant& val) const
     m_element->SetProperty(idx, val);
 }
 
+FB::variant FB::DOM::Node::getPropertyVariant(const std::string& name) const
+{
+    if (!m_cacheProperties)
+        return m_element->GetProperty(name);
+
+    PropertyCache::const_iterator it = m_propCache.find(name);
+    if (it != m_propCache.end() && it->second.first == m_cacheGeneration)
+        return it->second.second;
+
+    FB::variant value = m_element->GetProperty(name);
+    m_propCache[name] = std::make_pair(m_cacheGeneration, value);
+    return value;
+}
+
+void FB::DOM::Node::invalidate() const
+{
+    ++m_cacheGeneration;
+    if (m_cacheGeneration == 0) {
+        // generation counter wrapped; sweep so ancient entries can't false-hit
+        m_propCache.clear();
+    }
+}
+
 FB::DOM::NodePtr FB::DOM::Node::appendChild(FB::DOM::NodePtr node)
 {
 	FB::JSObjectPtr result = callMethod<FB::JSObjectPtr>("appendChild", FB::variant_list_of(node->getJSObject()));
@@ -17,6 +17,9 @@ Copyright 2009 PacketPass, Inc and the Firebreath development team
 #define H_FB_DOM_NODE
 
 #include <string>
+#include <map>
+#include <utility>
+#include <boost/cstdint.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include "JSObject.h"
 
@@ -39,7 +42,7 @@ namespace FB { namespace DOM {
     class Node : public boost::enable_shared_from_this<Node>
     {
     public:
-        Node(const JSObjectPtr& element) : m_element(element) { }
+        Node(const JSObjectPtr& element) : m_element(element), m_cacheProperties(false), m_cacheGeneration(0) { }
         virtual ~Node() { }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -144,10 +147,37 @@ namespace FB { namespace DOM {
         template <class T>
         T getProperty(const std::string& name) const
         {
-            FB::variant tmp = m_element->GetProperty(name);
+            FB::variant tmp = getPropertyVariant(name);
             return tmp.convert_cast<T>();
         }
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setPropertyCaching(bool enable)
+        ///
+        /// @brief  Enables or disables caching of named property reads on this node
+        ///
+        /// Off by default: every getProperty goes to the browser.  When enabled, repeated
+        /// reads of the same property (a layout loop polling width/height each frame) are
+        /// served from local memory until invalidate() is called.  The cache knows nothing
+        /// about the DOM, so anything that may have changed the node -- including changes
+        /// made from script -- requires an invalidate() before the next read.  Indexed
+        /// reads (getProperty(int)) are never cached.
+        ///
+        /// @see invalidate
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setPropertyCaching(bool enable) { m_cacheProperties = enable; }
+        bool getPropertyCaching() const { return m_cacheProperties; }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void invalidate()
+        ///
+        /// @brief  Drops all cached property values; the next read of each property fetches it
+        ///         from the browser again
+        ///
+        /// @see setPropertyCaching
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void invalidate() const;
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn template <class T> T getProperty(int idx) const
         ///
@@ -209,7 +239,18 @@ namespace FB { namespace DOM {
 		virtual NodePtr appendChild(NodePtr node);
 
     protected:
+        // Consults the property cache when enabled; otherwise a straight browser read
+        variant getPropertyVariant(const std::string& name) const;
+
         JSObjectPtr m_element; // The JSObject that this object wraps
+
+    private:
+        // Values are tagged with the generation they were read at; invalidate() just
+        // bumps the generation so stale entries miss without a sweep of the map
+        typedef std::map<std::string, std::pair<boost::uint32_t, variant> > PropertyCache;
+        bool m_cacheProperties;
+        mutable boost::uint32_t m_cacheGeneration;
+        mutable PropertyCache m_propCache;
     };
 
 }; };
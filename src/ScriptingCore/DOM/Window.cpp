@@ -30,11 +30,13 @@ Window::~Window()
 {
 }
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
 DocumentPtr Window::getDocument() const
 {
     JSObjectPtr api = getProperty<JSObjectPtr>("document");
     return Document::create(api);
 }
+#endif
 
 void Window::alert(const std::wstring& str) const
 {
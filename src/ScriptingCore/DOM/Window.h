@@ -99,14 +99,16 @@ namespace FB {
 
     public:
 
+#ifndef FB_NO_DOM // feature flag; see fb_features.h
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual DocumentPtr Window::getDocument() const
         ///
         /// @brief  Gets the DOM Document contained in this window
         ///
-        /// @return The document. 
+        /// @return The document.
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual DocumentPtr getDocument() const;
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void Window::alert(const std::string& str) const
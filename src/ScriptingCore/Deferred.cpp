@@ -0,0 +1,91 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include "precompiled_headers.h"
+
+#include "JSObject.h"
+#include "Deferred.h"
+
+FB::Deferred::Deferred()
+  : m_state(Pending)
+{
+    registerMethod("then", make_method(this, &Deferred::then));
+}
+
+FB::JSAPIPtr FB::Deferred::then(const FB::JSObjectPtr& onFulfilled,
+                                const boost::optional<FB::JSObjectPtr>& onRejected)
+{
+    State state;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        state = m_state;
+        if (m_state == Pending) {
+            if (onFulfilled)
+                m_onFulfilled.push_back(onFulfilled);
+            if (onRejected && *onRejected)
+                m_onRejected.push_back(*onRejected);
+        }
+    }
+    // already settled: fire the matching handler now (still asynchronously, so the
+    // page never sees a then() callback re-enter it)
+    if (state == Resolved && onFulfilled)
+        fire(onFulfilled, m_value);
+    else if (state == Rejected && onRejected && *onRejected)
+        fire(*onRejected, m_value);
+    return shared_from_this();
+}
+
+void FB::Deferred::resolve(const FB::variant& value)
+{
+    settle(Resolved, value);
+}
+
+void FB::Deferred::reject(const FB::variant& error)
+{
+    settle(Rejected, error);
+}
+
+bool FB::Deferred::settled() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_state != Pending;
+}
+
+void FB::Deferred::settle(State state, const FB::variant& value)
+{
+    std::vector<FB::JSObjectPtr> handlers;
+    {
+        boost::mutex::scoped_lock lock(m_mutex);
+        if (m_state != Pending)
+            return;
+        m_state = state;
+        m_value = value;
+        handlers.swap(state == Resolved ? m_onFulfilled : m_onRejected);
+        std::vector<FB::JSObjectPtr>().swap(m_onFulfilled);
+        std::vector<FB::JSObjectPtr>().swap(m_onRejected);
+    }
+    for (std::vector<FB::JSObjectPtr>::const_iterator it = handlers.begin(); it != handlers.end(); ++it)
+        fire(*it, value);
+}
+
+void FB::Deferred::fire(const FB::JSObjectPtr& handler, const FB::variant& value)
+{
+    FB::VariantList args;
+    args.push_back(value);
+    try {
+        handler->InvokeAsync("", args);
+    } catch (const std::runtime_error&) {
+        // the page (and its BrowserHost) is already gone; nobody is listening
+    }
+}
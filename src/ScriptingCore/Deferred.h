@@ -0,0 +1,85 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_DEFERRED
+#define H_FB_DEFERRED
+
+#include <vector>
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+#include "JSAPIAuto.h"
+
+namespace FB
+{
+    FB_FORWARD_PTR(Deferred);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  Deferred
+    ///
+    /// @brief  Thenable return value for methods that complete on a worker thread
+    ///
+    /// A method registered with make_method can declare FB::DeferredPtr as its return type;
+    /// the object crosses the bridge like any other JSAPI pointer, so the call returns to the
+    /// page immediately and the browser main thread never blocks on the real work:
+    ///
+    /// @code
+    /// FB::DeferredPtr MyAPI::fetchData(const std::string& uri) {
+    ///     FB::DeferredPtr dfd(boost::make_shared<FB::Deferred>());
+    ///     boost::thread(boost::bind(&MyAPI::fetchWorker, this, uri, dfd));
+    ///     return dfd;
+    /// }
+    /// // worker thread, later:  dfd->resolve(result);   or   dfd->reject(error);
+    /// @endcode
+    ///
+    /// The page attaches handlers with then(onFulfilled[, onRejected]).  resolve() and
+    /// reject() may be called from any thread; handlers always fire asynchronously on the
+    /// main thread through the InvokeAsync / ScheduleAsyncCall path, including handlers
+    /// attached after the Deferred has already settled.  Settling is one-shot: the first
+    /// resolve or reject wins and later calls are ignored.
+    ///
+    /// @since 1.7
+    /// @see JSObject::InvokeAsync
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class Deferred : public JSAPIAuto
+    {
+    public:
+        Deferred();
+
+        /// @brief  Attaches page callbacks; returns the same Deferred so calls can be chained
+        FB::JSAPIPtr then(const FB::JSObjectPtr& onFulfilled,
+                          const boost::optional<FB::JSObjectPtr>& onRejected);
+
+        /// @brief  Settles the Deferred successfully; safe from any thread, no-op if settled
+        void resolve(const FB::variant& value);
+        /// @brief  Settles the Deferred with an error; safe from any thread, no-op if settled
+        void reject(const FB::variant& error);
+
+        bool settled() const;
+
+    private:
+        enum State { Pending, Resolved, Rejected };
+
+        void settle(State state, const FB::variant& value);
+        static void fire(const FB::JSObjectPtr& handler, const FB::variant& value);
+
+        mutable boost::mutex m_mutex;
+        State m_state;
+        FB::variant m_value;
+        std::vector<FB::JSObjectPtr> m_onFulfilled;
+        std::vector<FB::JSObjectPtr> m_onRejected;
+    };
+}
+
+#endif // H_FB_DEFERRED
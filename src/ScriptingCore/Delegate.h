@@ -0,0 +1,218 @@
+/**********************************************************\
+Created:    2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2012 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef FB_DELEGATE_H
+#define FB_DELEGATE_H
+
+#include <new>
+#include <boost/config.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/throw_exception.hpp>
+#include <boost/function/function_base.hpp>  // for boost::bad_function_call
+
+namespace FB
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @class  delegate_base
+        ///
+        /// @brief  Storage and lifetime management shared by the FB::delegate specializations
+        ///
+        /// Works like the boost::function it replaces, but keeps the common payload — a bound
+        /// member function pointer plus an object pointer, which is what make_method() and
+        /// make_property() produce — in an inline buffer instead of on the heap.  A page that
+        /// registers thousands of members otherwise pays one small allocation per registered
+        /// member plus an extra indirection on every invoke.  Callables that do not fit the
+        /// buffer fall back to heap storage, so anything a boost::function could hold still
+        /// works.  The same inline-vs-heap policy split is used by variant_storage.h.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        class delegate_base
+        {
+        protected:
+            // Inline payload; sized for the bind expression make_method() builds around a
+            // member function pointer (itself two pointers on the common ABIs) and the
+            // instance pointer, with a little headroom for user functors
+            union data_t {
+                double align_double;    // force useful alignment for the inline buffer
+                void* heap;             // heap policy keeps its pointer here
+                char buf[6 * sizeof(void*)];
+            };
+
+            struct vtable {
+                void (*destroy)(data_t&);
+                void (*clone)(const data_t&, data_t&);  // dest must be unconstructed
+                const void* (*get)(const data_t&);
+            };
+
+            // Policy for callables that fit (size and alignment) in the inline buffer
+            template <typename F>
+            struct small_policy {
+                static void construct(data_t& d, const F& f) { new (d.buf) F(f); }
+                static void destroy(data_t& d) { reinterpret_cast<F*>(d.buf)->~F(); }
+                static void clone(const data_t& src, data_t& dest) {
+                    new (dest.buf) F(*reinterpret_cast<const F*>(src.buf));
+                }
+                static const void* get(const data_t& d) { return d.buf; }
+            };
+
+            // Policy for callables that don't fit; matches what boost::function always did
+            template <typename F>
+            struct heap_policy {
+                static void construct(data_t& d, const F& f) { d.heap = new F(f); }
+                static void destroy(data_t& d) { delete static_cast<F*>(d.heap); }
+                static void clone(const data_t& src, data_t& dest) {
+                    dest.heap = new F(*static_cast<const F*>(src.heap));
+                }
+                static const void* get(const data_t& d) { return d.heap; }
+            };
+
+            template <typename F>
+            struct select_policy {
+                typedef typename boost::mpl::if_c<
+                    sizeof(F) <= sizeof(data_t)
+                        && boost::alignment_of<F>::value <= boost::alignment_of<data_t>::value,
+                    small_policy<F>,
+                    heap_policy<F> >::type type;
+            };
+
+            delegate_base() : m_table(NULL) {}
+            delegate_base(const delegate_base& rhs) : m_table(rhs.m_table) {
+                if (m_table)
+                    m_table->clone(rhs.m_data, m_data);
+            }
+            ~delegate_base() {
+                if (m_table)
+                    m_table->destroy(m_data);
+            }
+
+            template <typename F>
+            void construct(const F& f) {
+                typedef typename select_policy<F>::type policy;
+                static const vtable table = { &policy::destroy, &policy::clone, &policy::get };
+                policy::construct(m_data, f);
+                m_table = &table;
+            }
+
+            void assign(const delegate_base& rhs) {
+                if (this == &rhs)
+                    return;
+                if (m_table)
+                    m_table->destroy(m_data);
+                m_table = rhs.m_table;
+                if (m_table)
+                    m_table->clone(rhs.m_data, m_data);
+            }
+
+            // Address of the held callable; recomputed per call since copies of a
+            // small delegate hold their payload at a different address
+            const void* get() const { return m_table->get(m_data); }
+
+            const vtable* m_table;
+            data_t m_data;
+
+        private:
+            delegate_base& operator=(const delegate_base&);  // use assign()
+        };
+    } // namespace detail
+
+    template<typename Signature>
+    class delegate;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  delegate
+    ///
+    /// @brief  Small-buffer-optimized replacement for boost::function in the registration API
+    ///
+    /// Drop-in for the CallMethodFunctor / GetPropFunctor / SetPropFunctor typedefs: construct
+    /// it from anything callable with the right signature, copy it around, invoke it through
+    /// operator().  Invoking an empty delegate throws boost::bad_function_call, as before.
+    /// operator() is const but invokes the held callable non-const, exactly as boost::function
+    /// does.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename R>
+    class delegate<R ()> : private detail::delegate_base
+    {
+    public:
+        typedef R result_type;
+
+        delegate() : m_invoke(NULL) {}
+        delegate(const delegate& rhs) : delegate_base(rhs), m_invoke(rhs.m_invoke) {}
+        template<typename F>
+        delegate(const F& f) : m_invoke(&invoke_stub<F>::call) { construct(f); }
+
+        delegate& operator=(const delegate& rhs) {
+            assign(rhs);
+            m_invoke = rhs.m_invoke;
+            return *this;
+        }
+
+        R operator()() const {
+            if (!m_invoke)
+                boost::throw_exception(boost::bad_function_call());
+            return m_invoke(get());
+        }
+
+        bool empty() const { return !m_invoke; }
+
+    private:
+        template<typename F>
+        struct invoke_stub {
+            static R call(const void* f) {
+                return (*const_cast<F*>(static_cast<const F*>(f)))();
+            }
+        };
+
+        R (*m_invoke)(const void*);
+    };
+
+    template<typename R, typename A1>
+    class delegate<R (A1)> : private detail::delegate_base
+    {
+    public:
+        typedef R result_type;
+
+        delegate() : m_invoke(NULL) {}
+        delegate(const delegate& rhs) : delegate_base(rhs), m_invoke(rhs.m_invoke) {}
+        template<typename F>
+        delegate(const F& f) : m_invoke(&invoke_stub<F>::call) { construct(f); }
+
+        delegate& operator=(const delegate& rhs) {
+            assign(rhs);
+            m_invoke = rhs.m_invoke;
+            return *this;
+        }
+
+        R operator()(A1 a1) const {
+            if (!m_invoke)
+                boost::throw_exception(boost::bad_function_call());
+            return m_invoke(get(), a1);
+        }
+
+        bool empty() const { return !m_invoke; }
+
+    private:
+        template<typename F>
+        struct invoke_stub {
+            static R call(const void* f, A1 a1) {
+                return (*const_cast<F*>(static_cast<const F*>(f)))(a1);
+            }
+        };
+
+        R (*m_invoke)(const void*, A1);
+    };
+
+} // namespace FB
+
+#endif // FB_DELEGATE_H
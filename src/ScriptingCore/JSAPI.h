@@ -184,6 +184,7 @@ namespace FB
             // TODO: add support for this in IDispatchAPI and NPObjectAPI
             throw FB::script_error("Not implemented");
         }
+#ifndef FB_NO_WSTRING_API // feature flag; see fb_features.h
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual void registerEventMethod(const std::wstring& name, JSObjectPtr& event)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -191,6 +192,7 @@ namespace FB
         {
             registerEventMethod(wstring_to_utf8(name), event);
         }
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void unregisterEventMethod(const std::string& name, JSObjectPtr& event)
@@ -205,6 +207,7 @@ namespace FB
             // TODO: add support for this in IDispatchAPI and NPObjectAPI
             throw FB::script_error("Not implemented");
         }
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual void unregisterEventMethod(const std::wstring& name, JSObjectPtr& event)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -212,6 +215,7 @@ namespace FB
         {
             unregisterEventMethod(wstring_to_utf8(name), event);
         }
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void registerEventInterface(const JSObjectPtr& event)
@@ -240,6 +244,7 @@ namespace FB
             throw FB::script_error("Not implemented");
         }
 
+#ifndef FB_NO_WSTRING_API
         virtual void getMemberNames(std::vector<std::wstring> &nameVector) const
         {
             nameVector.clear();
@@ -256,6 +261,7 @@ namespace FB
         {
             getMemberNames(*nameVector);
         }
+#endif
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void getMemberNames(std::vector<std::string> &nameVector) const = 0
         ///
@@ -281,6 +287,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual size_t getMemberCount() const = 0;
 
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual bool HasMethod(const std::wstring& methodName) const
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -288,6 +295,7 @@ namespace FB
         {
             return HasMethod(wstring_to_utf8(methodName));
         }
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual bool HasMethod(const std::string& methodName) const = 0
@@ -300,6 +308,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual bool HasMethod(const std::string& methodName) const = 0;
 
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual bool HasMethodObject(const std::wstring& methodObjName) const
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -307,6 +316,7 @@ namespace FB
         {
             return HasMethodObject(wstring_to_utf8(methodObjName));
         }
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual bool HasMethodObject(const std::string& methodObjName) const
@@ -322,6 +332,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual bool HasMethodObject(const std::string& methodObjName) const { return false; }
 
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual bool HasProperty(const std::wstring& propertyName) const
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -329,6 +340,7 @@ namespace FB
         {
             return HasProperty(wstring_to_utf8(propertyName));
         }
+#endif
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual bool HasProperty(const std::string& propertyName) const
         ///
@@ -356,6 +368,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual bool HasProperty(int idx) const = 0;
 
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual JSAPIPtr GetMethodObject(const std::wstring& methodObjName)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -363,6 +376,7 @@ namespace FB
         {
             return GetMethodObject(FB::wstring_to_utf8(methodObjName));
         }
+#endif
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual variant GetMethodObject(const std::string& methodObjName) = 0
         ///
@@ -380,6 +394,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual JSAPIPtr GetMethodObject(const std::string& methodObjName) { return FB::JSAPIPtr(); }
 
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual variant GetProperty(const std::wstring& propertyName)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -387,6 +402,7 @@ namespace FB
         {
             return GetProperty(wstring_to_utf8(propertyName));
         }
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual variant GetProperty(const std::string& propertyName) = 0
@@ -399,6 +415,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual variant GetProperty(const std::string& propertyName) = 0;
 
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual void SetProperty(const std::wstring& propertyName, const variant& value)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -406,6 +423,7 @@ namespace FB
         {
             SetProperty(wstring_to_utf8(propertyName), value);
         }
+#endif
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void SetProperty(const std::string& propertyName, const variant& value) = 0
         ///
@@ -449,6 +467,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual void SetProperty(int idx, const variant& value) = 0;
 
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual variant RemoveProperty(const std::wstring& propertyName)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -456,6 +475,7 @@ namespace FB
         {
             return RemoveProperty(wstring_to_utf8(propertyName));
         }
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual variant RemoveProperty(const std::string& propertyName) = 0
@@ -483,6 +503,7 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual void RemoveProperty(int idx) = 0;
 
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual variant Invoke(const std::wstring& methodName, const std::vector<variant>& args)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -490,6 +511,7 @@ namespace FB
         {
             return Invoke(wstring_to_utf8(methodName), args);
         }
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual variant Invoke(const std::string& methodName,
@@ -18,10 +18,18 @@ Copyright 2009 Georg Fritzsche, Firebreath development team
 #include "JSFunction.h"
 #include "JSEvent.h"
 #include <cassert>
+#include <set>
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
+#include "StartupTimer.h"
+#include "TraceEvents.h"
+#include "CallRecorder.h"
 #include "JSAPIAuto.h"
 
+// Out-of-line definition for the in-class constant; needed whenever it is
+// ODR-used (e.g. bound to a const reference)
+const FB::MemberId FB::MemberTable::no_member;
+
 bool FB::JSAPIAuto::s_allowDynamicAttributes = true;
 bool FB::JSAPIAuto::s_allowRemoveProperties = false;
 bool FB::JSAPIAuto::s_allowMethodObjects = true;
@@ -29,9 +37,11 @@ bool FB::JSAPIAuto::s_allowMethodObjects = true;
 FB::JSAPIAuto::JSAPIAuto(const std::string& description)
   : FB::JSAPIImpl(SecurityScope_Public),
     m_description(description),
+    m_memberBatchDepth(0),
     m_allowDynamicAttributes(FB::JSAPIAuto::s_allowDynamicAttributes),
     m_allowRemoveProperties(FB::JSAPIAuto::s_allowRemoveProperties),
-    m_allowMethodObjects(FB::JSAPIAuto::s_allowMethodObjects)
+    m_allowMethodObjects(FB::JSAPIAuto::s_allowMethodObjects),
+    m_collectMemberStats(false)
 {
     init();
 }
@@ -39,23 +49,29 @@ FB::JSAPIAuto::JSAPIAuto(const std::string& description)
 FB::JSAPIAuto::JSAPIAuto( const SecurityZone& securityLevel, const std::string& description /*= "<JSAPI-Auto Secure Javascript Object>"*/ )
   : FB::JSAPIImpl(securityLevel),
     m_description(description),
+    m_memberBatchDepth(0),
     m_allowDynamicAttributes(FB::JSAPIAuto::s_allowDynamicAttributes),
     m_allowRemoveProperties(FB::JSAPIAuto::s_allowRemoveProperties),
-    m_allowMethodObjects(FB::JSAPIAuto::s_allowMethodObjects)
+    m_allowMethodObjects(FB::JSAPIAuto::s_allowMethodObjects),
+    m_collectMemberStats(false)
 {
     init();
 }
 
 void FB::JSAPIAuto::init( )
 {
+    publishMemberSnapshot(MemberSnapshotPtr(new MemberSnapshot));
     {
         scoped_zonelock _l(this, SecurityScope_Public);
+        scoped_member_batch _b(this);
         registerMethod("toString",  make_method(this, &JSAPIAuto::ToString));
         registerMethod("getAttribute",  make_method(this, &JSAPIAuto::getAttribute));
         registerMethod("setAttribute",  make_method(this, &JSAPIAuto::setAttribute));
 
         registerProperty("value", make_property(this, &JSAPIAuto::ToString));
         registerProperty("valid", make_property(this, &JSAPIAuto::get_valid));
+        registerProperty("startupTimings", make_property(this, &JSAPIAuto::get_startupTimings));
+        registerProperty("memberStats", make_property(this, &JSAPIAuto::get_memberStats));
     }
 
     setReserved("offsetWidth");
@@ -80,19 +96,48 @@ FB::JSAPIAuto::~JSAPIAuto()
 
 }
 
+void FB::JSAPIAuto::beginMemberUpdateBatch()
+{
+    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
+    ++m_memberBatchDepth;
+}
+
+void FB::JSAPIAuto::endMemberUpdateBatch()
+{
+    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
+    if (--m_memberBatchDepth == 0 && m_pendingSnapshot) {
+        publishMemberSnapshot(m_pendingSnapshot);
+        m_pendingSnapshot.reset();
+    }
+}
+
 void FB::JSAPIAuto::registerMethod(const std::string& name, const CallMethodFunctor& func)
 {
     boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     m_methodFunctorMap[name] = func;
     m_zoneMap[name] = getZone();
+    MemberSnapshotPtr snap(updateMemberSnapshot());
+    MemberEntry& entry = getMemberEntry(*snap, name);
+    entry.method = func;
+    entry.hasMethod = true;
+    entry.zone = getZone();
+    entry.hasZone = true;
+    commitMemberSnapshot(snap);
 }
 
 void FB::JSAPIAuto::unregisterMethod( const std::string& name )
 {
+    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     FB::MethodFunctorMap::iterator fnd = m_methodFunctorMap.find(name);
     if (fnd != m_methodFunctorMap.end()) {
         m_methodFunctorMap.erase(name);
         m_zoneMap.erase(name);
+        MemberSnapshotPtr snap(updateMemberSnapshot());
+        MemberEntry& entry = getMemberEntry(*snap, name);
+        entry.method = MethodFunctors();
+        entry.hasMethod = false;
+        entry.hasZone = false;
+        commitMemberSnapshot(snap);
     }
 }
 
@@ -106,6 +151,13 @@ void FB::JSAPIAuto::registerProperty(const std::string& name, const PropertyFunc
     boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     m_propertyFunctorsMap[name] = propFuncs;
     m_zoneMap[name] = getZone();
+    MemberSnapshotPtr snap(updateMemberSnapshot());
+    MemberEntry& entry = getMemberEntry(*snap, name);
+    entry.props = propFuncs;
+    entry.hasProps = true;
+    entry.zone = getZone();
+    entry.hasZone = true;
+    commitMemberSnapshot(snap);
 }
 
 void FB::JSAPIAuto::unregisterProperty( const std::wstring& name )
@@ -115,41 +167,70 @@ void FB::JSAPIAuto::unregisterProperty( const std::wstring& name )
 
 void FB::JSAPIAuto::unregisterProperty( const std::string& name )
 {
+    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     FB::PropertyFunctorsMap::iterator fnd = m_propertyFunctorsMap.find(name);
     if (fnd != m_propertyFunctorsMap.end()) {
         m_propertyFunctorsMap.erase(name);
         m_zoneMap.erase(name);
+        MemberSnapshotPtr snap(updateMemberSnapshot());
+        MemberEntry& entry = getMemberEntry(*snap, name);
+        entry.props = PropertyFunctors();
+        entry.hasProps = false;
+        entry.hasZone = false;
+        commitMemberSnapshot(snap);
     }
 }
 
-void FB::JSAPIAuto::getMemberNames(std::vector<std::string> &nameVector) const
+void FB::JSAPIAuto::buildZoneTables( MemberSnapshot& snapshot )
 {
-    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
-    nameVector.clear();
-    for (ZoneMap::const_iterator it = m_zoneMap.begin(); it != m_zoneMap.end(); ++it) {
-        if (getZone() >= it->second)
-            nameVector.push_back(it->first);
+    snapshot.zones.clear();
+    // Distinct registration zones, ascending; nearly always just the default zone
+    std::set<SecurityZone> zones;
+    for (size_t id = 0; id < snapshot.entries.size(); ++id) {
+        if (snapshot.entries[id].hasZone)
+            zones.insert(snapshot.entries[id].zone);
+    }
+    for (std::set<SecurityZone>::const_iterator zn = zones.begin(); zn != zones.end(); ++zn) {
+        snapshot.zones.push_back(ZoneTable());
+        ZoneTable& table = snapshot.zones.back();
+        table.zone = *zn;
+        table.accessible.assign(snapshot.entries.size(), false);
+        for (size_t id = 0; id < snapshot.entries.size(); ++id) {
+            const MemberEntry& entry = snapshot.entries[id];
+            if (entry.hasZone && entry.zone <= *zn) {
+                table.accessible[id] = true;
+                table.names.push_back(snapshot.names.nameOf(id));
+            }
+        }
     }
 }
 
+void FB::JSAPIAuto::getMemberNames(std::vector<std::string> &nameVector) const
+{
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    const ZoneTable* table = findZoneTable(*snap, getZone());
+    if (table)
+        nameVector = table->names;
+    else
+        nameVector.clear();
+}
+
 size_t FB::JSAPIAuto::getMemberCount() const
 {
-    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
-    size_t count = 0;
-    for (ZoneMap::const_iterator it = m_zoneMap.begin(); it != m_zoneMap.end(); ++it) {
-        if (getZone() >= it->second)
-            ++count;
-    }
-    return count;
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    const ZoneTable* table = findZoneTable(*snap, getZone());
+    return table ? table->names.size() : 0;
 }
 
 bool FB::JSAPIAuto::HasMethod(const std::string& methodName) const
 {
-    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     if(!m_valid)
         return false;
 
-    return (m_methodFunctorMap.find(methodName) != m_methodFunctorMap.end()) && memberAccessible(m_zoneMap.find(methodName));
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    FB::MemberId id = snap->names.find(methodName);
+    const MemberEntry* entry = findMember(*snap, id);
+    return entry && entry->hasMethod && memberAccessible(*snap, id);
 }
 
 bool FB::JSAPIAuto::HasMethodObject( const std::string& methodObjName ) const
@@ -161,18 +242,20 @@ bool FB::JSAPIAuto::HasMethodObject( const std::string& methodObjName ) const
 
 bool FB::JSAPIAuto::HasProperty(const std::string& propertyName) const
 {
-    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     if(!m_valid)
         return false;
 
     // To be able to set dynamic properties, we have to respond true always
-    if (m_allowDynamicAttributes && !HasMethod(propertyName) && !isReserved(propertyName))
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    FB::MemberId id = snap->names.find(propertyName);
+    const MemberEntry* entry = findMember(*snap, id);
+    bool hasMethod = entry && entry->hasMethod && memberAccessible(*snap, id);
+    if (m_allowDynamicAttributes && !hasMethod && !isReserved(propertyName))
         return true;
-    else if (m_allowMethodObjects && HasMethod(propertyName) && memberAccessible(m_zoneMap.find(propertyName)))
+    else if (m_allowMethodObjects && hasMethod)
         return true;
 
-    return m_propertyFunctorsMap.find(propertyName) != m_propertyFunctorsMap.end()
-        || m_attributes.find(propertyName) != m_attributes.end();
+    return (entry && (entry->hasProps || entry->hasAttr));
 }
 
 bool FB::JSAPIAuto::HasProperty(int idx) const
@@ -190,21 +273,23 @@ bool FB::JSAPIAuto::HasProperty(int idx) const
 
 FB::variant FB::JSAPIAuto::GetProperty(const std::string& propertyName)
 {
-    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
+    FBTRACE_SCOPE("ScriptingCore", "JSAPIAuto::GetProperty");
+    FB::CallRecorder::ScopedRecord _rec('G', propertyName);
     if(!m_valid)
         throw object_invalidated();
 
-    ZoneMap::const_iterator zoneName = m_zoneMap.find(propertyName);
-    PropertyFunctorsMap::const_iterator it = m_propertyFunctorsMap.find(propertyName);
-    if(it != m_propertyFunctorsMap.end() && memberAccessible(zoneName)) {
-        return it->second.get();
-    } else if (memberAccessible(zoneName)) {
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    FB::MemberId id = snap->names.find(propertyName);
+    const MemberEntry* entry = findMember(*snap, id);
+    bool accessible = memberAccessible(*snap, id);
+    if(entry && entry->hasProps && accessible) {
+        return entry->props.get();
+    } else if (accessible) {
         if (HasMethodObject(propertyName))
             return GetMethodObject(propertyName);
 
-        AttributeMap::iterator fnd = m_attributes.find(propertyName);
-        if (fnd != m_attributes.end())
-            return fnd->second.value;
+        if (entry->hasAttr)
+            return entry->attr.value;
         else if (m_allowDynamicAttributes) {
             return FB::FBVoid(); // If we allow dynamic attributes then we need to
                                  // return void if the property doesn't exist;
@@ -223,17 +308,20 @@ FB::variant FB::JSAPIAuto::GetProperty(const std::string& propertyName)
 
 void FB::JSAPIAuto::SetProperty(const std::string& propertyName, const variant& value)
 {
+    FB::CallRecorder::ScopedRecord _rec('S', propertyName, NULL, &value);
     boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     if(!m_valid)
         throw object_invalidated();
 
-    PropertyFunctorsMap::iterator it = m_propertyFunctorsMap.find(propertyName);
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    FB::MemberId id = snap->names.find(propertyName);
+    const MemberEntry* entry = findMember(*snap, id);
     // Note that if an explicit property exists but is not accessible in the current security context,
     // we throw an exception.
-    if(it != m_propertyFunctorsMap.end()) {
-        if (memberAccessible(m_zoneMap.find(propertyName))) {
+    if(entry && entry->hasProps) {
+        if (memberAccessible(*snap, id)) {
             try {
-                it->second.set(value);
+                entry->props.set(value);
             } catch (const FB::bad_variant_cast& ex) {
                 std::string errorMsg("Could not convert from ");
                 errorMsg += ex.from;
@@ -244,7 +332,7 @@ void FB::JSAPIAuto::SetProperty(const std::string& propertyName, const variant&
         } else {
             throw invalid_member(propertyName);
         }
-    } else if (m_allowDynamicAttributes || (m_attributes.find(propertyName) != m_attributes.end() && !m_attributes[propertyName].readonly)) {
+    } else if (m_allowDynamicAttributes || (entry && entry->hasAttr && !entry->attr.readonly)) {
         registerAttribute(propertyName, value);
     } else {
         throw invalid_member(propertyName);
@@ -259,13 +347,15 @@ void FB::JSAPIAuto::RemoveProperty(const std::string& propertyName)
 
     // If there is nothing with this name available in the current security context,
     // we throw an exception -- whether or not a real property exists
-    if (!memberAccessible(m_zoneMap.find(propertyName)))
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    FB::MemberId id = snap->names.find(propertyName);
+    const MemberEntry* entry = findMember(*snap, id);
+    if (!memberAccessible(*snap, id))
         throw invalid_member(propertyName);
 
-    if(m_allowRemoveProperties && m_propertyFunctorsMap.find(propertyName) != m_propertyFunctorsMap.end()) {
+    if(m_allowRemoveProperties && entry->hasProps) {
         unregisterProperty(propertyName);
-    } else if (m_allowDynamicAttributes && m_attributes.find(propertyName) != m_attributes.end()
-               && !m_attributes[propertyName].readonly) {
+    } else if (m_allowDynamicAttributes && entry->hasAttr && !entry->attr.readonly) {
         unregisterAttribute(propertyName);
     }
 
@@ -328,17 +418,25 @@ void FB::JSAPIAuto::RemoveProperty(int idx)
 
 FB::variant FB::JSAPIAuto::Invoke(const std::string& methodName, const std::vector<variant> &args)
 {
-    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
+    FBTRACE_SCOPE("ScriptingCore", "JSAPIAuto::Invoke");
+    FB::CallRecorder::ScopedRecord _rec('I', methodName, &args);
     if(!m_valid)
         throw object_invalidated();
 
-    if (memberAccessible(m_zoneMap.find(methodName))) {
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    FB::MemberId id = snap->names.find(methodName);
+    const MemberEntry* entry = findMember(*snap, id);
+    if (memberAccessible(*snap, id)) {
         try {
-            MethodFunctorMap::iterator it = m_methodFunctorMap.find(methodName);
-            if(it == m_methodFunctorMap.end())
+            if(!entry->hasMethod)
                 throw invalid_member(methodName);
 
-            return it->second.call(args);
+            if (!m_collectMemberStats)
+                return entry->method.call(args);
+            boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+            FB::variant ret(entry->method.call(args));
+            recordMethodCall(methodName, start);
+            return ret;
         } catch (const FB::bad_variant_cast& ex) {
             std::string errorMsg("Could not convert from ");
             errorMsg += ex.from;
@@ -366,7 +464,8 @@ FB::JSAPIPtr FB::JSAPIAuto::GetMethodObject( const std::string& methodObjName )
     if(!m_valid)
         throw object_invalidated();
 
-    if (memberAccessible(m_zoneMap.find(methodObjName)) && HasMethod(methodObjName)) {
+    MemberSnapshotConstPtr snap(memberSnapshot());
+    if (memberAccessible(*snap, snap->names.find(methodObjName)) && HasMethod(methodObjName)) {
         MethodObjectMap::const_iterator fnd = m_methodObjectMap.find(boost::make_tuple(methodObjName, getZone()));
         if (fnd != m_methodObjectMap.end()) {
             return fnd->second;
@@ -386,10 +485,18 @@ void FB::JSAPIAuto::registerAttribute( const std::string &name, const FB::varian
     Attribute attr = {value, readonly};
     m_attributes[name] = attr;
     m_zoneMap[name] = getZone();
+    MemberSnapshotPtr snap(updateMemberSnapshot());
+    MemberEntry& entry = getMemberEntry(*snap, name);
+    entry.attr = attr;
+    entry.hasAttr = true;
+    entry.zone = getZone();
+    entry.hasZone = true;
+    commitMemberSnapshot(snap);
 }
 
 void FB::JSAPIAuto::unregisterAttribute( const std::string& name )
 {
+    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     AttributeMap::iterator fnd = m_attributes.find(name);
     if ( fnd != m_attributes.end() ) {
         if (fnd->second.readonly ) {
@@ -397,6 +504,12 @@ void FB::JSAPIAuto::unregisterAttribute( const std::string& name )
         } else {
             m_attributes.erase(fnd);
             m_zoneMap.erase(name);
+            MemberSnapshotPtr snap(updateMemberSnapshot());
+            MemberEntry& entry = getMemberEntry(*snap, name);
+            entry.attr = Attribute();
+            entry.hasAttr = false;
+            entry.hasZone = false;
+            commitMemberSnapshot(snap);
         }
     } else {
         return; // No attribute of that name? success!
@@ -413,11 +526,19 @@ FB::variant FB::JSAPIAuto::getAttribute( const std::string& name )
 
 void FB::JSAPIAuto::setAttribute( const std::string& name, const FB::variant& value )
 {
+    boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
     AttributeMap::iterator fnd = m_attributes.find(name);
     if (fnd == m_attributes.end() || !fnd->second.readonly) {
         Attribute attr = {value, false};
         m_attributes[name] = attr;
         m_zoneMap[name] = getZone();
+        MemberSnapshotPtr snap(updateMemberSnapshot());
+        MemberEntry& entry = getMemberEntry(*snap, name);
+        entry.attr = attr;
+        entry.hasAttr = true;
+        entry.zone = getZone();
+        entry.hasZone = true;
+        commitMemberSnapshot(snap);
     } else {
         throw FB::script_error("Cannot set read-only property " + name);
     }
@@ -453,3 +574,43 @@ void FB::JSAPIAuto::fireAsyncEvent( const std::string& eventName, const std::vec
         }
     }
 }
+
+FB::VariantList FB::JSAPIAuto::get_startupTimings()
+{
+    return FB::StartupTimer::getMarks();
+}
+
+void FB::JSAPIAuto::setMemberStatsEnabled(bool enabled)
+{
+    m_collectMemberStats = enabled;
+}
+
+void FB::JSAPIAuto::recordMethodCall(const std::string& methodName, const boost::posix_time::ptime& start)
+{
+    boost::uint64_t us = static_cast<boost::uint64_t>(
+        (boost::posix_time::microsec_clock::universal_time() - start).total_microseconds());
+    boost::mutex::scoped_lock lock(m_statsMutex);
+    MethodStats& s = m_methodStats[methodName];
+    ++s.calls;
+    s.totalUs += us;
+    if (us > s.maxUs)
+        s.maxUs = us;
+}
+
+FB::VariantList FB::JSAPIAuto::get_memberStats()
+{
+    FB::VariantList list;
+    boost::mutex::scoped_lock lock(m_statsMutex);
+    for (std::map<std::string, MethodStats>::const_iterator it = m_methodStats.begin();
+         it != m_methodStats.end(); ++it) {
+        const MethodStats& s = it->second;
+        FB::VariantMap entry;
+        entry["name"] = it->first;
+        entry["calls"] = static_cast<double>(s.calls);
+        entry["totalMs"] = static_cast<double>(s.totalUs) / 1000.0;
+        entry["avgMs"] = s.calls ? static_cast<double>(s.totalUs) / (1000.0 * s.calls) : 0.0;
+        entry["maxMs"] = static_cast<double>(s.maxUs) / 1000.0;
+        list.push_back(entry);
+    }
+    return list;
+}
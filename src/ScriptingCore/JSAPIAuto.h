@@ -19,10 +19,14 @@ Copyright 2009 Georg Fritzsche, Firebreath development team
 #include <deque>
 #include <vector>
 #include <string>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/tuple/tuple.hpp>
-#include <boost/tuple/tuple_comparison.hpp> 
+#include <boost/tuple/tuple_comparison.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include "JSAPIImpl.h"
+#include "MemberTable.h"
 #include "MethodConverter.h"
 #include "PropertyConverter.h"
 #include "Util/typesafe_event.h"
@@ -93,6 +97,8 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     class JSAPIAuto : public JSAPIImpl
     {
+        // JSFunction caches its bound-method lookup against the member snapshot
+        friend class JSFunction;
     protected:
         struct Attribute {
             bool operator<(const Attribute& rh) const
@@ -106,12 +112,93 @@ namespace FB {
         typedef std::map<std::string, FB::SecurityZone> ZoneMap;
         typedef std::map<std::string, Attribute> AttributeMap;
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct MemberEntry
+        ///
+        /// @brief  Flat per-member record indexed by the interned FB::MemberId
+        ///
+        /// Each record owns copies of the method/property functors and the attribute so a whole
+        /// vector of them can be published as an immutable snapshot; the hot call paths resolve a
+        /// member with one name lookup in the intern table and then plain array accesses instead
+        /// of several string map lookups.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct MemberEntry {
+            MemberEntry()
+                : method(), props(), attr(), hasMethod(false), hasProps(false),
+                  hasAttr(false), zone(SecurityScope_Public), hasZone(false) {}
+            MethodFunctors method;
+            PropertyFunctors props;
+            Attribute attr;
+            bool hasMethod;
+            bool hasProps;
+            bool hasAttr;
+            FB::SecurityZone zone;
+            bool hasZone;
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct ZoneTable
+        ///
+        /// @brief  Precomputed member visibility for one SecurityZone
+        ///
+        /// Since zones are assigned at registration time, the set of members visible in any given
+        /// zone is fixed once a snapshot is published.  buildZoneTables() computes one of these
+        /// per distinct registration zone; the call paths select the right table once per call
+        /// with getZone() and then check accessibility with a plain indexed load, and the
+        /// enumeration paths return the precomputed name list instead of rescanning the entries.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct ZoneTable {
+            SecurityZone zone;
+            std::vector<bool> accessible;       // indexed by FB::MemberId
+            std::vector<std::string> names;     // accessible members, in registration order
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct MemberSnapshot
+        ///
+        /// @brief  Immutable copy-on-write snapshot of all registered members
+        ///
+        /// Writers (register/unregister and attribute updates) build a fresh snapshot under
+        /// m_zoneMutex and publish it with an atomic shared_ptr store; readers grab the current
+        /// snapshot without taking the mutex, so concurrent script threads no longer serialize on
+        /// member lookup.  Note that the security zone itself is still read through getZone(),
+        /// which honors the zone lock held across scoped_zonelock.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct MemberSnapshot {
+            MemberTable names;
+            std::vector<MemberEntry> entries;
+            std::vector<ZoneTable> zones;       // ascending by zone; see buildZoneTables()
+        };
+        typedef boost::shared_ptr<const MemberSnapshot> MemberSnapshotConstPtr;
+        typedef boost::shared_ptr<MemberSnapshot> MemberSnapshotPtr;
+
     public:
         /// @brief Description is used by ToString().
         JSAPIAuto(const std::string& description = "<JSAPI-Auto Javascript Object>");
         JSAPIAuto(const SecurityZone& securityLevel, const std::string& description = "<JSAPI-Auto Secure Javascript Object>");
         typedef std::deque<SecurityZone> ZoneStack;
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @class  scoped_member_batch
+        ///
+        /// @brief  Coalesces a run of register/unregister calls into one snapshot publish
+        ///
+        /// Each register/unregister call normally deep-copies and republishes the member
+        /// snapshot, which is wasteful when a constructor registers a whole API at once.
+        /// While a guard is alive the writers accumulate their changes in a single pending
+        /// snapshot that is published when the last guard goes out of scope.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        class scoped_member_batch
+        {
+        public:
+            scoped_member_batch(JSAPIAuto* api) : m_api(api) { m_api->beginMemberUpdateBatch(); }
+            ~scoped_member_batch() { m_api->endMemberUpdateBatch(); }
+        private:
+            scoped_member_batch(const scoped_member_batch&);
+            scoped_member_batch& operator=(const scoped_member_batch&);
+            JSAPIAuto* m_api;
+        };
+
         void init();
 
         virtual ~JSAPIAuto();
@@ -308,6 +395,47 @@ namespace FB {
             return true;
         }
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual FB::VariantList JSAPIAuto::get_startupTimings()
+        ///
+        /// @brief  Property exposed by default to javascript listing the framework startup stages
+        ///         recorded by FB::StartupTimer, for decomposing first-instance load time
+        ///
+        /// @return list of {stage, ms, delta} maps in stage order
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual FB::VariantList get_startupTimings();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual void JSAPIAuto::setMemberStatsEnabled(bool enabled)
+        ///
+        /// @brief  Turns per-method invocation statistics on or off for this object
+        ///
+        /// Off by default; when off the Invoke path pays only a single bool test.  When on,
+        /// every successful method call is timed and accumulated per method name; read the
+        /// results from javascript through the reserved "memberStats" property.  Accumulated
+        /// numbers are kept when collection is turned back off.
+        ///
+        /// @param  enabled  true to collect statistics
+        ///
+        /// @see get_memberStats
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual void setMemberStatsEnabled(bool enabled);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn virtual FB::VariantList JSAPIAuto::get_memberStats()
+        ///
+        /// @brief  Property exposed by default to javascript listing per-method invocation
+        ///         statistics: call count plus total/average/max duration in milliseconds.
+        ///         Empty until collection is enabled with setMemberStatsEnabled().
+        ///
+        /// @return list of {name, calls, totalMs, avgMs, maxMs} maps
+        /// @see setMemberStatsEnabled
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        virtual FB::VariantList get_memberStats();
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn public virtual FB::variant getAttribute(const std::string& name)
         ///
@@ -357,6 +485,106 @@ namespace FB {
             return (it != m_zoneMap.end()) && getZone() >= it->second;
         }
 
+        // Checks the member against the precomputed table for the current zone; one
+        // getZone() call, then an indexed load
+        bool memberAccessible( const MemberSnapshot& snapshot, FB::MemberId id ) const
+        {
+            if (id == MemberTable::no_member)
+                return false;
+            const ZoneTable* table = findZoneTable(snapshot, getZone());
+            return table && table->accessible[id];
+        }
+
+        // Returns the visibility table for zone: the one built for the highest
+        // registration zone not above it.  NULL when nothing is visible in that zone
+        static const ZoneTable* findZoneTable( const MemberSnapshot& snapshot, SecurityZone zone )
+        {
+            // snapshot.zones is ascending and almost always has a single entry
+            for (std::vector<ZoneTable>::const_reverse_iterator it = snapshot.zones.rbegin();
+                    it != snapshot.zones.rend(); ++it) {
+                if (it->zone <= zone)
+                    return &*it;
+            }
+            return NULL;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn MemberSnapshotConstPtr JSAPIAuto::memberSnapshot() const
+        ///
+        /// @brief  Returns the current member snapshot without taking m_zoneMutex
+        ///
+        /// Hold the returned pointer for as long as any MemberEntry pointers obtained from it are
+        /// in use; the snapshot stays alive even if a writer publishes a newer one meanwhile.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        MemberSnapshotConstPtr memberSnapshot() const
+        {
+#ifndef BOOST_SP_NO_ATOMIC_ACCESS
+            return boost::atomic_load(&m_memberSnapshot);
+#else
+            boost::recursive_mutex::scoped_lock lock(m_zoneMutex);
+            return m_memberSnapshot;
+#endif
+        }
+
+        // Looks up the member record for id in a snapshot; NULL if never registered
+        static const MemberEntry* findMember( const MemberSnapshot& snapshot, FB::MemberId id )
+        {
+            return (id != MemberTable::no_member) ? &snapshot.entries[id] : NULL;
+        }
+
+        // Deep-copies the current snapshot for modification; call under m_zoneMutex
+        MemberSnapshotPtr copyMemberSnapshot() const
+        {
+            return MemberSnapshotPtr(new MemberSnapshot(*m_memberSnapshot));
+        }
+
+        // Returns the (possibly new) mutable member record for name, interning it if needed
+        static MemberEntry& getMemberEntry( MemberSnapshot& snapshot, const std::string& name )
+        {
+            FB::MemberId id = snapshot.names.intern(name);
+            if (id >= snapshot.entries.size())
+                snapshot.entries.resize(id + 1);
+            return snapshot.entries[id];
+        }
+
+        // Atomically publishes a new snapshot, rebuilding its per-zone visibility tables
+        // first; call under m_zoneMutex
+        void publishMemberSnapshot( const MemberSnapshotPtr& snapshot )
+        {
+            buildZoneTables(*snapshot);
+#ifndef BOOST_SP_NO_ATOMIC_ACCESS
+            boost::atomic_store(&m_memberSnapshot, MemberSnapshotConstPtr(snapshot));
+#else
+            m_memberSnapshot = snapshot;
+#endif
+        }
+
+        // Returns the snapshot writers should mutate: the shared pending snapshot inside a
+        // member batch, a fresh deep copy otherwise.  Call under m_zoneMutex
+        MemberSnapshotPtr updateMemberSnapshot()
+        {
+            if (m_memberBatchDepth > 0) {
+                if (!m_pendingSnapshot)
+                    m_pendingSnapshot = copyMemberSnapshot();
+                return m_pendingSnapshot;
+            }
+            return copyMemberSnapshot();
+        }
+
+        // Publishes snap unless a member batch is active; the batch publishes once on exit
+        void commitMemberSnapshot( const MemberSnapshotPtr& snapshot )
+        {
+            if (m_memberBatchDepth == 0)
+                publishMemberSnapshot(snapshot);
+        }
+
+        void beginMemberUpdateBatch();
+        void endMemberUpdateBatch();
+
+        // Recomputes snapshot.zones from the member entries: one table per distinct
+        // registration zone, each listing everything visible at that zone or below
+        static void buildZoneTables( MemberSnapshot& snapshot );
+
     protected:
         // Stores Method Objects -- JSAPI proxy objects for calling a method on this object
         MethodObjectMap m_methodObjectMap;
@@ -366,7 +594,13 @@ namespace FB {
         PropertyFunctorsMap m_propertyFunctorsMap;
         // Keeps track of the security zone of each member
         ZoneMap m_zoneMap;
-        
+        // Copy-on-write member snapshot; readers load it without locking (see memberSnapshot())
+        MemberSnapshotConstPtr m_memberSnapshot;
+        // Pending snapshot accumulated while a scoped_member_batch is active; guarded by m_zoneMutex
+        MemberSnapshotPtr m_pendingSnapshot;
+        // Nesting depth of active scoped_member_batch guards; guarded by m_zoneMutex
+        int m_memberBatchDepth;
+
         const std::string m_description;
 
         AttributeMap m_attributes;
@@ -374,6 +608,19 @@ namespace FB {
         bool m_allowDynamicAttributes;
         bool m_allowRemoveProperties;
         bool m_allowMethodObjects;
+
+        // Per-method invocation statistics, collected only while m_collectMemberStats is set
+        struct MethodStats {
+            MethodStats() : calls(0), totalUs(0), maxUs(0) { }
+            boost::uint64_t calls;
+            boost::uint64_t totalUs;
+            boost::uint64_t maxUs;
+        };
+        bool m_collectMemberStats;
+        mutable boost::mutex m_statsMutex;
+        std::map<std::string, MethodStats> m_methodStats;
+
+        void recordMethodCall(const std::string& methodName, const boost::posix_time::ptime& start);
     public:
         static bool s_allowDynamicAttributes;
         static bool s_allowRemoveProperties;
@@ -12,7 +12,12 @@ License:    Dual license model; choose one of two:
 Copyright 2009 Richard Bateman, Firebreath development team
 \**********************************************************/
 
+#include <map>
 #include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/once.hpp>
 #include "BrowserHost.h"
 #include "JSObject.h"
 #include "utf8_tools.h"
@@ -23,6 +28,76 @@ Copyright 2009 Richard Bateman, Firebreath development team
 
 using namespace FB;
 
+namespace {
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  ConflationFlusher
+    ///
+    /// @brief  Trailing-edge delivery for conflated event channels
+    ///
+    /// One lazily started thread, shared by every JSAPIImpl in the process, sleeps until the
+    /// earliest scheduled flush comes due and then hands the channel back to its owner.  The
+    /// instance is deliberately never destroyed so a flush scheduled during shutdown can't race
+    /// a static destructor; the thread spends its life blocked when no channel is waiting.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class ConflationFlusher
+    {
+    public:
+        ConflationFlusher()
+        {
+            m_thread = boost::thread(boost::bind(&ConflationFlusher::run, this));
+        }
+
+        void schedule(const FB::JSAPIImplWeakPtr& api, const std::string& eventName,
+            const boost::system_time& due)
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            m_queue.insert(std::make_pair(due, QueueEntry(api, eventName)));
+            m_cond.notify_one();
+        }
+
+    private:
+        typedef std::pair<FB::JSAPIImplWeakPtr, std::string> QueueEntry;
+        typedef std::multimap<boost::system_time, QueueEntry> FlushQueue;
+
+        void run()
+        {
+            boost::mutex::scoped_lock lock(m_mutex);
+            for (;;) {
+                if (m_queue.empty()) {
+                    m_cond.wait(lock);
+                    continue;
+                }
+                FlushQueue::iterator next(m_queue.begin());
+                if (next->first > boost::get_system_time()) {
+                    m_cond.timed_wait(lock, next->first);
+                    continue;
+                }
+                QueueEntry entry(next->second);
+                m_queue.erase(next);
+                lock.unlock();
+                FB::JSAPIImplPtr api(entry.first.lock());
+                if (api)
+                    api->flushConflatedEvent(entry.second);
+                lock.lock();
+            }
+        }
+
+        boost::mutex m_mutex;
+        boost::condition_variable m_cond;
+        FlushQueue m_queue;
+        boost::thread m_thread;
+    };
+
+    ConflationFlusher* conflationFlusher(NULL);
+    boost::once_flag conflationFlusherOnce = BOOST_ONCE_INIT;
+    void initConflationFlusher() { conflationFlusher = new ConflationFlusher; }
+    ConflationFlusher& getConflationFlusher()
+    {
+        boost::call_once(conflationFlusherOnce, &initConflationFlusher);
+        return *conflationFlusher;
+    }
+}
+
 JSAPIImpl::JSAPIImpl(void) : m_valid(true)
 {
     m_zoneStack.push_back(SecurityScope_Public);
@@ -91,12 +166,17 @@ void JSAPIImpl::fireAsyncEvent( const std::string& eventName, const std::vector<
         evtIfaces = m_evtIfaces;
     }
 
+    // Hosts that can't take the callMultipleFunctions fast path get the handlers in one
+    // scheduled batch sharing a single copy of the arguments; created lazily on first use
+    boost::shared_ptr<const VariantList> payload;
+
     std::set<void*> contexts;
     {
         EventContextMap::iterator it(eventMap.begin());
         EventContextMap::iterator end(eventMap.end());
         for (; it != end; ++it) {
             bool first(true);
+            std::vector<FB::JSObjectPtr> batch;
             std::pair<EventMultiMap::iterator, EventMultiMap::iterator> range = it->second.equal_range(eventName);
             for (EventMultiMap::const_iterator eventIt = range.first; eventIt != range.second; ++eventIt) {
                 if (first && eventIt->second->isValid() && eventIt->second->supportsOptimizedCalls()) {
@@ -117,10 +197,15 @@ void JSAPIImpl::fireAsyncEvent( const std::string& eventName, const std::vector<
                 } else {
                     if (eventIt->second->isValid()) {
                         first = false;
-                        eventIt->second->InvokeAsync("", args);
+                        batch.push_back(eventIt->second);
                     }
                 }
             }
+            if (!batch.empty()) {
+                if (!payload)
+                    payload = boost::make_shared<VariantList>(args);
+                batchInvokeAsync("", batch, payload);
+            }
         }
     }
 
@@ -132,6 +217,7 @@ void JSAPIImpl::fireAsyncEvent( const std::string& eventName, const std::vector<
             if (contexts.find(it->first) != contexts.end())
                 continue; // We've already handled these
 
+            std::vector<FB::JSObjectPtr> batch;
             for (EventIFaceMap::const_iterator ifaceIt = it->second.begin(); ifaceIt != it->second.end(); ++ifaceIt) {
                 if (ifaceIt->second->isValid() && ifaceIt->second->supportsOptimizedCalls()) {
                     std::vector<FB::JSObjectPtr> handlers;
@@ -142,10 +228,133 @@ void JSAPIImpl::fireAsyncEvent( const std::string& eventName, const std::vector<
                     ifaceIt->second->callMultipleFunctions(eventName, args, handlers, ifaces);
                     break;
                 }
-                ifaceIt->second->InvokeAsync(eventName, args);
+                batch.push_back(ifaceIt->second);
             }
+            if (!batch.empty()) {
+                if (!payload)
+                    payload = boost::make_shared<VariantList>(args);
+                batchInvokeAsync(eventName, batch, payload);
+            }
+        }
+    }
+}
+
+void JSAPIImpl::batchInvokeAsync(const std::string& name, const std::vector<JSObjectPtr>& handlers,
+    const boost::shared_ptr<const VariantList>& args)
+{
+    if (handlers.empty())
+        return;
+    if (handlers.size() == 1) {
+        handlers.front()->InvokeAsync(name, *args);
+        return;
+    }
+
+    BrowserHostPtr host;
+    try {
+        host = handlers.front()->getHost();
+    } catch (const boost::bad_weak_ptr&) {
+    }
+    if (!host) {
+        // nothing to schedule the batch through; deliver individually as before
+        for (std::vector<JSObjectPtr>::const_iterator it = handlers.begin(); it != handlers.end(); ++it)
+            (*it)->InvokeAsync(name, *args);
+        return;
+    }
+    host->ScheduleOnMainThread(shared_from_this(),
+        boost::bind(&JSAPIImpl::deliverEventBatch, this, name, handlers, args));
+}
+
+void JSAPIImpl::deliverEventBatch(std::string name, std::vector<JSObjectPtr> handlers,
+    boost::shared_ptr<const VariantList> args)
+{
+    for (std::vector<JSObjectPtr>::const_iterator it = handlers.begin(); it != handlers.end(); ++it) {
+        if (!(*it)->isValid())
+            continue;
+        try {
+            // same delegate path InvokeAsync uses, minus the per-handler scheduling
+            BrowserHostPtr host((*it)->getHost());
+            host->delayedInvoke(0, *it, *args, name);
+        } catch (...) {
+            // this handler's host is gone or the call failed; keep delivering to the rest
+        }
+    }
+}
+
+void JSAPIImpl::setEventConflation(const std::string& eventName, long minIntervalMs)
+{
+    boost::mutex::scoped_lock lock(m_conflationMutex);
+    // leave any existing send/pending state alone so re-declaring can't burst past the rate
+    m_conflationMap[eventName].intervalMs = minIntervalMs > 0 ? minIntervalMs : 0;
+}
+
+void JSAPIImpl::clearEventConflation(const std::string& eventName)
+{
+    VariantList args;
+    bool deliver(false);
+    {
+        boost::mutex::scoped_lock lock(m_conflationMutex);
+        ConflationMap::iterator it = m_conflationMap.find(eventName);
+        if (it == m_conflationMap.end())
+            return;
+        if (it->second.hasPending) {
+            args.swap(it->second.pendingArgs);
+            deliver = true;
+        }
+        // a flush already scheduled for this channel will find it gone and do nothing
+        m_conflationMap.erase(it);
+    }
+    if (deliver)
+        fireEventNow(eventName, args);
+}
+
+bool JSAPIImpl::conflateEvent(const std::string& eventName, const std::vector<variant>& args)
+{
+    boost::mutex::scoped_lock lock(m_conflationMutex);
+    ConflationMap::iterator it = m_conflationMap.find(eventName);
+    if (it == m_conflationMap.end())
+        return false;
+
+    ConflatedChannel& ch = it->second;
+    boost::system_time now(boost::get_system_time());
+    if (!ch.flushScheduled
+        && (ch.lastSend.is_not_a_date_time()
+            || now - ch.lastSend >= boost::posix_time::milliseconds(ch.intervalMs))) {
+        // quiet channel: this payload goes out right away and starts a new interval
+        ch.lastSend = now;
+        return false;
+    }
+
+    // inside the interval: newest payload wins; at most one trailing flush is in flight
+    ch.pendingArgs = args;
+    ch.hasPending = true;
+    if (!ch.flushScheduled) {
+        ch.flushScheduled = true;
+        getConflationFlusher().schedule(shared_from_this(), eventName,
+            ch.lastSend + boost::posix_time::milliseconds(ch.intervalMs));
+    }
+    return true;
+}
+
+void JSAPIImpl::flushConflatedEvent(const std::string& eventName)
+{
+    VariantList args;
+    bool deliver(false);
+    {
+        boost::mutex::scoped_lock lock(m_conflationMutex);
+        ConflationMap::iterator it = m_conflationMap.find(eventName);
+        if (it == m_conflationMap.end())
+            return;
+        ConflatedChannel& ch = it->second;
+        ch.flushScheduled = false;
+        if (ch.hasPending) {
+            args.swap(ch.pendingArgs);
+            ch.hasPending = false;
+            ch.lastSend = boost::get_system_time();
+            deliver = true;
         }
     }
+    if (deliver && m_valid)
+        fireEventNow(eventName, args);
 }
 
 void JSAPIImpl::FireEvent(const std::string& eventName, const std::vector<variant>& args)
@@ -153,6 +362,14 @@ void JSAPIImpl::FireEvent(const std::string& eventName, const std::vector<varian
     if (!m_valid)   // When invalidated, do nothing more
         return;
 
+    if (conflateEvent(eventName, args))
+        return; // stored as the channel's newest payload; goes out when the interval allows
+
+    fireEventNow(eventName, args);
+}
+
+void JSAPIImpl::fireEventNow(const std::string& eventName, const std::vector<variant>& args)
+{
     {
         JSAPIImplPtr self(shared_from_this());
         boost::recursive_mutex::scoped_lock _l(m_proxyMutex);
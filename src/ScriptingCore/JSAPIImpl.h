@@ -23,8 +23,10 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include <boost/noncopyable.hpp>
 #include "JSExceptions.h"
 #include "JSAPI.h"
+#include "ObjectCensus.h"
 #include "boost/thread/recursive_mutex.hpp"
 #include "boost/thread/mutex.hpp"
+#include "boost/thread/thread_time.hpp"
 
 namespace FB
 {
@@ -46,9 +48,11 @@ namespace FB
     /// @see FB::JSAPIAuto
     /// @since 1.5
     ////////////////////////////////////////////////////////////////////////////////////////////////////
-    class JSAPIImpl : public JSAPI
+    class JSAPIImpl : public JSAPI, public census_counted<JSAPIImpl>
     {
     public:
+        /// Label this type reports live-instance counts under in FB::ObjectCensus::snapshot()
+        static const char* censusName() { return "JSAPIImpl"; }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn JSAPIImpl(void)
@@ -75,6 +79,41 @@ namespace FB
         /// @brief  Invalidates this object.
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         void invalidate();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void setEventConflation(const std::string& eventName, long minIntervalMs)
+        ///
+        /// @brief  Declares a conflating channel for an event: only the newest pending payload is
+        ///         kept and delivery happens at most once per minIntervalMs
+        ///
+        /// Meant for events fired at data-arrival rate (progress updates) where the page only needs
+        /// the latest value.  The first fire after a quiet period goes out immediately; fires inside
+        /// the interval replace the pending payload and one trailing delivery is scheduled for when
+        /// the interval expires, so the last value is never lost.  Handlers see fewer calls but
+        /// always the most recent arguments.
+        ///
+        /// @param  eventName       Name of the event (must start with "on", same as FireEvent)
+        /// @param  minIntervalMs   Minimum milliseconds between deliveries
+        ///
+        /// @see clearEventConflation
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void setEventConflation(const std::string& eventName, long minIntervalMs);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void clearEventConflation(const std::string& eventName)
+        ///
+        /// @brief  Removes the conflating channel for an event; any payload still pending is
+        ///         delivered immediately and later fires go back to one delivery per FireEvent
+        ///
+        /// @see setEventConflation
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void clearEventConflation(const std::string& eventName);
+
+        // Called by the conflation flusher when a channel's trailing delivery comes due; not
+        // intended for plugin code
+        void flushConflatedEvent(const std::string& eventName);
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn void shutdown()
         ///
@@ -85,7 +124,31 @@ namespace FB
     protected:
         virtual void fireAsyncEvent( const std::string& eventName, const std::vector<variant>& args );
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void batchInvokeAsync(const std::string& name, const std::vector<JSObjectPtr>& handlers,
+        ///         const boost::shared_ptr<const VariantList>& args)
+        ///
+        /// @brief  Delivers one event to several handlers as a single scheduled main-thread batch
+        ///
+        /// The argument list is shared between all handlers instead of being copied into a
+        /// separately scheduled call per handler, so firing an event with many listeners costs one
+        /// main-thread hop.  A handler that fails or goes away doesn't stop delivery to the rest.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void batchInvokeAsync(const std::string& name, const std::vector<JSObjectPtr>& handlers,
+            const boost::shared_ptr<const VariantList>& args);
+
+    private:
+        void deliverEventBatch(std::string name, std::vector<JSObjectPtr> handlers,
+            boost::shared_ptr<const VariantList> args);
+
+        // Returns true if the event was swallowed by a conflating channel (stored as the newest
+        // pending payload, or sent counting against the channel's interval)
+        bool conflateEvent(const std::string& eventName, const std::vector<variant>& args);
+        // The pre-conflation body of FireEvent: proxy fan-out plus fireAsyncEvent
+        void fireEventNow(const std::string& eventName, const std::vector<variant>& args);
+
     protected:
+#ifndef FB_NO_WSTRING_API // feature flag; see fb_features.h
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual void FireEvent(const std::wstring& eventName, const std::vector<variant> &args)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -93,6 +156,7 @@ namespace FB
         {
             FireEvent(wstring_to_utf8(eventName), args);
         }
+#endif
         
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void FireEvent(const std::string& eventName, const std::vector<variant> &args)
@@ -251,6 +315,7 @@ namespace FB
         /// @deprecated 1.5
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual void registerEvent(const std::string& name) {}
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual void registerEvent(const std::wstring& name)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -258,6 +323,7 @@ namespace FB
         {
             registerEvent(wstring_to_utf8(name));
         }
+#endif
 
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -269,6 +335,7 @@ namespace FB
         /// @param  event           The event handler method. 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual void registerEventMethod(const std::string& name, JSObjectPtr& event);
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual void registerEventMethod(const std::wstring& name, JSObjectPtr& event)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -276,6 +343,7 @@ namespace FB
         {
             registerEventMethod(wstring_to_utf8(name), event);
         }
+#endif
         
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void unregisterEventMethod(const std::string& name, JSObjectPtr& event)
@@ -286,6 +354,7 @@ namespace FB
         /// @param  event           The event handler method to unregister. 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         virtual void unregisterEventMethod(const std::string& name, JSObjectPtr& event);
+#ifndef FB_NO_WSTRING_API
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @overload virtual void unregisterEventMethod(const std::wstring& name, JSObjectPtr& event)
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -293,6 +362,7 @@ namespace FB
         {
             unregisterEventMethod(wstring_to_utf8(name), event);
         }
+#endif
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn virtual void registerEventInterface(const JSObjectPtr& event)
@@ -338,6 +408,19 @@ namespace FB
         typedef std::vector<JSAPIImplWeakPtr> ProxyList;
         mutable ProxyList m_proxies;
 
+        struct ConflatedChannel {
+            ConflatedChannel() : intervalMs(0), hasPending(false), flushScheduled(false) {}
+            long intervalMs;
+            boost::system_time lastSend;    // not_a_date_time until the first delivery
+            bool hasPending;
+            bool flushScheduled;
+            VariantList pendingArgs;
+        };
+        typedef std::map<std::string, ConflatedChannel> ConflationMap;
+        // Conflating channels declared with setEventConflation; guarded by m_conflationMutex
+        ConflationMap m_conflationMap;
+        mutable boost::mutex m_conflationMutex;
+
         mutable boost::recursive_mutex m_eventMutex;
         mutable boost::recursive_mutex m_proxyMutex;
         mutable boost::recursive_mutex m_zoneMutex;
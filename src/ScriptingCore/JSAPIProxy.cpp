@@ -32,7 +32,8 @@ FB::JSAPIProxyPtr FB::JSAPIProxy::create( const FB::JSAPIWeakPtr &inner )
 {
     // This is necessary because you can't use shared_from_this in the constructor
     FB::JSAPIProxyPtr ptr(new FB::JSAPIProxy(inner));
-    FB::JSAPIImplPtr impl(FB::ptr_cast<JSAPIImpl>(inner.lock()));
+    // register with the resolved (flattened) target so invalidation still propagates
+    FB::JSAPIImplPtr impl(FB::ptr_cast<JSAPIImpl>(ptr->m_apiWeak.lock()));
     if (impl)
         impl->registerProxy(ptr);
 
@@ -54,15 +55,28 @@ FB::JSAPIProxyPtr FB::JSAPIProxy::create( const SecurityZone& securityLevel, con
 {
     // This is necessary because you can't use shared_from_this in the constructor
     FB::JSAPIProxyPtr ptr(new FB::JSAPIProxy(securityLevel, inner));
-    FB::JSAPIImplPtr impl(FB::ptr_cast<JSAPIImpl>(inner.lock()));
+    // register with the resolved (flattened) target so invalidation still propagates
+    FB::JSAPIImplPtr impl(FB::ptr_cast<JSAPIImpl>(ptr->m_apiWeak.lock()));
     if (impl)
         impl->registerProxy(ptr);
     
     return ptr;
 }
 
+FB::JSAPIPtr FB::JSAPIProxy::flattenProxyChain( const FB::JSAPIPtr &inner )
+{
+    FB::JSAPIPtr cur(inner);
+    while (FB::JSAPIProxyPtr proxy = FB::ptr_cast<FB::JSAPIProxy>(cur)) {
+        FB::JSAPIPtr next(proxy->m_apiWeak.lock());
+        if (!next)
+            break;  // an expired proxy stays the target so expiry is still reported
+        cur = next;
+    }
+    return cur;
+}
+
 FB::JSAPIProxy::JSAPIProxy( const FB::JSAPIPtr &inner )
-    : m_api(inner), m_apiWeak(inner)
+    : m_api(flattenProxyChain(inner)), m_apiWeak(m_api)
 {
     if (!inner) {
         throw FB::script_error("Invalid inner JSAPI object passed to proxy");
@@ -72,11 +86,12 @@ FB::JSAPIProxy::JSAPIProxy( const FB::JSAPIPtr &inner )
 FB::JSAPIProxy::JSAPIProxy( const FB::JSAPIWeakPtr &inner )
     : m_apiWeak(inner)
 {
-
+    if (FB::JSAPIPtr locked = inner.lock())
+        m_apiWeak = flattenProxyChain(locked);
 }
 
 FB::JSAPIProxy::JSAPIProxy( const SecurityZone& securityLevel, const FB::JSAPIPtr &inner )
-    : FB::JSAPIImpl(securityLevel), m_api(inner), m_apiWeak(inner)
+    : FB::JSAPIImpl(securityLevel), m_api(flattenProxyChain(inner)), m_apiWeak(m_api)
 {
     if (!inner) {
         throw FB::script_error("Invalid inner JSAPI object passed to proxy");
@@ -86,7 +101,8 @@ FB::JSAPIProxy::JSAPIProxy( const SecurityZone& securityLevel, const FB::JSAPIPt
 FB::JSAPIProxy::JSAPIProxy( const SecurityZone& securityLevel, const FB::JSAPIWeakPtr &inner )
     : FB::JSAPIImpl(securityLevel), m_apiWeak(inner)
 {
-
+    if (FB::JSAPIPtr locked = inner.lock())
+        m_apiWeak = flattenProxyChain(locked);
 }
 
 FB::JSAPIProxy::~JSAPIProxy( void )
@@ -100,7 +116,9 @@ void FB::JSAPIProxy::changeObject( const FB::JSAPIWeakPtr &inner )
     }
     this->m_api.reset();
     this->m_apiWeak = inner;
-    FB::JSAPIImplPtr ptr = FB::ptr_cast<FB::JSAPIImpl>(inner.lock());
+    if (FB::JSAPIPtr locked = inner.lock())
+        this->m_apiWeak = flattenProxyChain(locked);
+    FB::JSAPIImplPtr ptr = FB::ptr_cast<FB::JSAPIImpl>(m_apiWeak.lock());
     if (ptr)
         ptr->registerProxy(shared_from_this());
 }
@@ -110,9 +128,9 @@ void FB::JSAPIProxy::changeObject( const FB::JSAPIPtr &inner )
     if (FB::JSAPIImplPtr ptr = FB::ptr_cast<FB::JSAPIImpl>(m_apiWeak.lock())) {
         ptr->unregisterProxy(shared_from_this());
     }
-    this->m_api = inner;
-    this->m_apiWeak = inner;
-    FB::JSAPIImplPtr ptr = FB::ptr_cast<FB::JSAPIImpl>(inner);
+    this->m_api = flattenProxyChain(inner);
+    this->m_apiWeak = this->m_api;
+    FB::JSAPIImplPtr ptr = FB::ptr_cast<FB::JSAPIImpl>(m_api);
     if (ptr)
         ptr->registerProxy(shared_from_this());
 }
@@ -136,123 +154,142 @@ void FB::JSAPIProxy::invalidate()
 
 void FB::JSAPIProxy::getMemberNames( std::vector<std::string> &nameVector ) const
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    getAPI()->getMemberNames(nameVector);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    api->getMemberNames(nameVector);
 }
 
 size_t FB::JSAPIProxy::getMemberCount() const
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->getMemberCount();
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->getMemberCount();
 }
 
 bool FB::JSAPIProxy::HasMethod( const std::wstring& methodName ) const
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->HasMethod(methodName);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->HasMethod(methodName);
 }
 
 bool FB::JSAPIProxy::HasMethod( const std::string& methodName ) const
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->HasMethod(methodName);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->HasMethod(methodName);
 }
 
 bool FB::JSAPIProxy::HasProperty( const std::wstring& propertyName ) const
 {
     if (propertyName == L"expired")
         return true;
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->HasProperty(propertyName);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->HasProperty(propertyName);
 }
 
 bool FB::JSAPIProxy::HasProperty( const std::string& propertyName ) const
 {
     if (propertyName == "expired")
         return true;
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->HasProperty(propertyName);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->HasProperty(propertyName);
 }
 
 bool FB::JSAPIProxy::HasProperty( int idx ) const
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->HasProperty(idx);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->HasProperty(idx);
 }
 
 FB::variant FB::JSAPIProxy::GetProperty( const std::wstring& propertyName )
 {
     if (propertyName == L"expired")
         return isExpired();
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->GetProperty(propertyName);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->GetProperty(propertyName);
 }
 
 FB::variant FB::JSAPIProxy::GetProperty( const std::string& propertyName )
 {
     if (propertyName == "expired")
         return isExpired();
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->GetProperty(propertyName);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->GetProperty(propertyName);
 }
 
 FB::variant FB::JSAPIProxy::GetProperty( int idx )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->GetProperty(idx);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->GetProperty(idx);
 }
 
 void FB::JSAPIProxy::SetProperty( const std::wstring& propertyName, const variant& value )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    getAPI()->SetProperty(propertyName, value);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    api->SetProperty(propertyName, value);
 }
 
 void FB::JSAPIProxy::SetProperty( const std::string& propertyName, const variant& value )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    getAPI()->SetProperty(propertyName, value);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    api->SetProperty(propertyName, value);
 }
 
 void FB::JSAPIProxy::SetProperty( int idx, const variant& value )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    getAPI()->SetProperty(idx, value);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    api->SetProperty(idx, value);
 }
 
 void FB::JSAPIProxy::RemoveProperty( const std::wstring& propertyName )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    getAPI()->RemoveProperty(propertyName);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    api->RemoveProperty(propertyName);
 }
 
 void FB::JSAPIProxy::RemoveProperty( const std::string& propertyName )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    getAPI()->RemoveProperty(propertyName);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    api->RemoveProperty(propertyName);
 }
 
 void FB::JSAPIProxy::RemoveProperty( int idx )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    getAPI()->RemoveProperty(idx);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    api->RemoveProperty(idx);
 }
 
 FB::variant FB::JSAPIProxy::Invoke( const std::wstring& methodName, const std::vector<variant>& args )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->Invoke(methodName, args);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->Invoke(methodName, args);
 }
 
 FB::variant FB::JSAPIProxy::Invoke( const std::string& methodName, const std::vector<variant>& args )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->Invoke(methodName, args);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->Invoke(methodName, args);
 }
 
 FB::variant FB::JSAPIProxy::Construct( const std::vector<variant>& args )
 {
-    FB::scoped_zonelock _l(getAPI(), getZone());
-    return getAPI()->Construct(args);
+    FB::JSAPIPtr api(getAPI());
+    FB::scoped_zonelock _l(api, getZone());
+    return api->Construct(args);
 }
 
@@ -38,7 +38,15 @@ namespace FB
     /// this proxy object to operate in a different security zone than the object it wraps, allowing
     /// the same object to be shared between two instances of a plugin that run in different
     /// security zones
-    /// 
+    ///
+    /// When the wrapped object is itself a JSAPIProxy the new proxy binds straight to the
+    /// innermost real API, so a call through any number of wrapper layers costs a single
+    /// indirection.  This is transparent — each forwarding call passes the caller's zone down
+    /// the chain unchanged, so the innermost object sees the same zone either way.  The chain
+    /// is resolved when the proxy is created (or retargeted with changeObject); calling
+    /// changeObject on an intermediate proxy afterwards does not retarget proxies that were
+    /// created around it
+    ///
     /// @see FB::JSAPI
     /// @see FB::JSAPIAuto
     ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -126,6 +134,10 @@ namespace FB
         }
 
     protected:
+        // Resolves inner through any proxies-of-proxies to the innermost real API;
+        // returns inner itself when it is not a proxy (or an expired one)
+        static FB::JSAPIPtr flattenProxyChain(const FB::JSAPIPtr& inner);
+
         mutable FB::JSAPIPtr m_api;
         mutable FB::JSAPIWeakPtr m_apiWeak;
 
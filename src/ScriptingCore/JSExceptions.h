@@ -74,6 +74,25 @@ namespace FB {
         ~object_invalidated() throw() { }
     };
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @exception sync_call_timeout
+    ///
+    /// @brief  Thrown by CrossThreadCall::syncCall (and BrowserHost::CallOnMainThread) when a
+    ///         timeout was requested and the main thread did not service the call in time.
+    ///
+    /// The abandoned call is skipped if the main thread ever gets to it, so catching this and
+    /// moving on is safe.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    struct sync_call_timeout : script_error
+    {
+        sync_call_timeout()
+            : script_error("Main thread call timed out")
+        { }
+        ~sync_call_timeout() throw() { }
+    };
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @exception invalid_member
     ///
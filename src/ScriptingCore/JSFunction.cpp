@@ -32,6 +32,7 @@ void FB::JSFunction::init()
     m_allowMethodObjects = false;
     // There are no reserved members on this object
     m_reservedMembers.clear();
+    m_cacheId = MemberTable::no_member;
 }
 
 FB::variant FB::JSFunction::exec( const std::vector<variant>& args )
@@ -41,6 +42,34 @@ FB::variant FB::JSFunction::exec( const std::vector<variant>& args )
         throw new FB::script_error("Invalid JSAPI object");
     // Force calls to use the zone this function was created with
     FB::scoped_zonelock _l(api, getZone());
+    // Fast path for a method bound on a JSAPIAuto: the name resolves to the same entry
+    // until the target publishes a new member snapshot (any re-registration does), so
+    // repeated callback invocations skip the name lookup and call the functor directly
+    if (JSAPIAuto* impl = dynamic_cast<JSAPIAuto*>(api.get())) {
+        MemberSnapshotConstPtr snap(impl->memberSnapshot());
+        FB::MemberId id;
+        {
+            boost::mutex::scoped_lock lock(m_cacheMutex);
+            if (m_cacheSnapshot != snap) {
+                m_cacheId = snap->names.find(m_methodName);
+                m_cacheSnapshot = snap;
+            }
+            id = m_cacheId;
+        }
+        if (id != MemberTable::no_member && snap->entries[id].hasMethod
+                && impl->memberAccessible(*snap, id)) {
+            try {
+                return snap->entries[id].method.call(args);
+            } catch (const FB::bad_variant_cast& ex) {
+                std::string errorMsg("Could not convert from ");
+                errorMsg += ex.from;
+                errorMsg += " to ";
+                errorMsg += ex.to;
+                throw FB::invalid_arguments(errorMsg);
+            }
+        }
+        // method objects and the dynamic paths still go through the generic Invoke
+    }
     return api->Invoke(m_methodName, args);
 }
 
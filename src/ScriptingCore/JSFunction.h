@@ -16,6 +16,7 @@
 #ifndef JSFunction_h__
 #define JSFunction_h__
 
+#include <boost/thread/mutex.hpp>
 #include "JSAPIAuto.h"
 
 namespace FB {
@@ -39,6 +40,14 @@ namespace FB {
     protected:
         const FB::JSAPIWeakPtr m_apiWeak;
         const std::string m_methodName;
+
+    private:
+        // Cached result of looking m_methodName up on the bound JSAPIAuto; keyed on the
+        // target's member snapshot, so a re-registration (which publishes a new snapshot)
+        // invalidates it by pointer comparison.  Guarded by m_cacheMutex
+        mutable boost::mutex m_cacheMutex;
+        mutable MemberSnapshotConstPtr m_cacheSnapshot;
+        mutable FB::MemberId m_cacheId;
     };
 };
     
@@ -20,6 +20,8 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include "BrowserHost.h"
 #include "variant_list.h"
 #include "variant_map.h"
+#include "ObjectCensus.h"
+#include "StringIntern.h"
 #include <iterator>
 
 namespace FB
@@ -43,9 +45,12 @@ namespace FB
     /// @see NPObjectAPI
     /// @see IDispatchAPI
     ////////////////////////////////////////////////////////////////////////////////////////////////////
-    class JSObject : public FB::JSAPI
+    class JSObject : public FB::JSAPI, public FB::census_counted<JSObject>
     {
     public:
+        /// Label this type reports live-instance counts under in FB::ObjectCensus::snapshot();
+        /// counts every browser object wrapper (NPObjectAPI, IDispatchAPI, ...)
+        static const char* censusName() { return "JSObject"; }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn JSObject(const BrowserHostPtr& h)
@@ -197,7 +202,9 @@ namespace FB
 
             for(StringVec::iterator it = fields.begin(); it != fields.end(); it++) {
                 FB::variant tmp = src->GetProperty(*it);
-                *inserter++ = PairType(*it, tmp.convert_cast<MappedType>());
+                // Property names crossing the bridge repeat endlessly (schema field
+                // names); intern them so every occurrence shares one immutable copy
+                *inserter++ = PairType(intern_string(*it), tmp.convert_cast<MappedType>());
             }
         } catch (const FB::script_error& e) {
             throw e;
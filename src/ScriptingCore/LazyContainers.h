@@ -0,0 +1,337 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_LAZYCONTAINERS
+#define H_FB_LAZYCONTAINERS
+
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include "JSObject.h"
+
+namespace FB
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  LazyVariantMap
+    ///
+    /// @brief  Map-style view of a Javascript object that fetches members on first access
+    ///
+    /// Declaring a method parameter as FB::VariantMap converts the whole Javascript object up
+    /// front: one getMemberNames round-trip plus one GetProperty round-trip per member, even if
+    /// the handler only ever reads a few keys.  Declare the parameter as FB::LazyVariantMap
+    /// instead and the conversion just wraps the JSObject; members are fetched (and cached) the
+    /// first time they are asked for, and prefetch() pulls a whole key set across the bridge in
+    /// a single main-thread trip:
+    ///
+    /// @code
+    /// void MyAPI::configure(const FB::LazyVariantMap& cfg) {
+    ///     std::vector<std::string> wanted;
+    ///     wanted.push_back("width"); wanted.push_back("height"); wanted.push_back("depth");
+    ///     cfg.prefetch(wanted);                                // one round-trip
+    ///     m_w = cfg.get("width").convert_cast<long>();
+    ///     m_h = cfg.get("height").convert_cast<long>();
+    /// }
+    /// @endcode
+    ///
+    /// Copies share the underlying cache.  materialize() produces the same FB::VariantMap the
+    /// eager conversion would have built; converting a LazyVariantMap back into a variant hands
+    /// the original Javascript object back to the page when there is one.
+    ///
+    /// @since 1.7
+    /// @see LazyVariantList
+    /// @see JSObject::GetObjectValues
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class LazyVariantMap
+    {
+    public:
+        LazyVariantMap() : m_state(boost::make_shared<State>()) {}
+        explicit LazyVariantMap(const FB::JSObjectPtr& obj)
+            : m_obj(obj), m_state(boost::make_shared<State>()) {}
+        /// @brief  Wraps an already-converted map; used when the source isn't a Javascript object
+        explicit LazyVariantMap(const FB::VariantMap& values)
+            : m_state(boost::make_shared<State>())
+        {
+            m_state->values = values;
+            for (FB::VariantMap::const_iterator it = values.begin(); it != values.end(); ++it)
+                m_state->keys.push_back(it->first);
+            m_state->haveKeys = true;
+        }
+
+        /// @brief  Returns the member, fetching it from the page on first access; an empty
+        ///         variant if the object has no such member
+        FB::variant get(const std::string& key) const
+        {
+            {
+                boost::mutex::scoped_lock lock(m_state->mutex);
+                FB::VariantMap::const_iterator fnd = m_state->values.find(key);
+                if (fnd != m_state->values.end())
+                    return fnd->second;
+            }
+            if (!m_obj)
+                return FB::variant();
+            FB::variant value(m_obj->GetProperty(key));
+            boost::mutex::scoped_lock lock(m_state->mutex);
+            m_state->values[key] = value;
+            return value;
+        }
+        FB::variant operator[](const std::string& key) const { return get(key); }
+
+        bool has(const std::string& key) const
+        {
+            const std::vector<std::string>& k = keys();
+            return std::find(k.begin(), k.end(), key) != k.end();
+        }
+
+        /// @brief  Member names of the underlying object; fetched once and cached
+        const std::vector<std::string>& keys() const
+        {
+            {
+                boost::mutex::scoped_lock lock(m_state->mutex);
+                if (m_state->haveKeys)
+                    return m_state->keys;
+            }
+            // fetched without holding the cache lock; getMemberNames may block on the
+            // main thread, which could be calling into this same map
+            std::vector<std::string> names;
+            if (m_obj)
+                m_obj->getMemberNames(names);
+            boost::mutex::scoped_lock lock(m_state->mutex);
+            if (!m_state->haveKeys) {
+                m_state->keys.swap(names);
+                m_state->haveKeys = true;
+            }
+            return m_state->keys;
+        }
+        size_t size() const { return keys().size(); }
+        bool empty() const { return keys().empty(); }
+
+        /// @brief  Fetches every listed member that isn't cached yet in one main-thread trip
+        void prefetch(const std::vector<std::string>& wanted) const
+        {
+            if (!m_obj)
+                return;
+            FB::BrowserHostPtr host(m_obj->m_host.lock());
+            if (host && !host->isMainThread())
+                host->CallOnMainThread(boost::bind(&LazyVariantMap::fetchMissing, this, &wanted));
+            else
+                fetchMissing(&wanted);
+        }
+
+        /// @brief  Fetches everything outstanding (one main-thread trip) and returns the map
+        ///         the eager conversion would have produced
+        FB::VariantMap materialize() const
+        {
+            const std::vector<std::string>& k = keys();
+            prefetch(k);
+            FB::VariantMap result;
+            boost::mutex::scoped_lock lock(m_state->mutex);
+            for (std::vector<std::string>::const_iterator it = k.begin(); it != k.end(); ++it)
+                result[*it] = m_state->values[*it];
+            return result;
+        }
+
+        /// @brief  The wrapped Javascript object; empty when constructed from a plain map
+        FB::JSObjectPtr object() const { return m_obj; }
+
+    private:
+        struct State {
+            State() : haveKeys(false) {}
+            boost::mutex mutex;
+            FB::VariantMap values;
+            std::vector<std::string> keys;
+            bool haveKeys;
+        };
+
+        void fetchMissing(const std::vector<std::string>* wanted) const
+        {
+            for (std::vector<std::string>::const_iterator it = wanted->begin(); it != wanted->end(); ++it) {
+                {
+                    boost::mutex::scoped_lock lock(m_state->mutex);
+                    if (m_state->values.find(*it) != m_state->values.end())
+                        continue;
+                }
+                FB::variant value(m_obj->GetProperty(*it));
+                boost::mutex::scoped_lock lock(m_state->mutex);
+                m_state->values[*it] = value;
+            }
+        }
+
+        FB::JSObjectPtr m_obj;
+        boost::shared_ptr<State> m_state;
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  LazyVariantList
+    ///
+    /// @brief  List-style view of a Javascript array that fetches elements on first access
+    ///
+    /// The array counterpart of LazyVariantMap: declaring a parameter as FB::VariantList pulls
+    /// every element through a GetProperty round-trip during conversion; this wrapper fetches
+    /// the length and individual elements only when asked, caches them, and can prefetch a
+    /// range in a single main-thread trip.
+    ///
+    /// @since 1.7
+    /// @see LazyVariantMap
+    /// @see JSObject::GetArrayValues
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class LazyVariantList
+    {
+    public:
+        LazyVariantList() : m_state(boost::make_shared<State>()) {}
+        explicit LazyVariantList(const FB::JSObjectPtr& obj)
+            : m_obj(obj), m_state(boost::make_shared<State>()) {}
+        /// @brief  Wraps an already-converted list; used when the source isn't a Javascript object
+        explicit LazyVariantList(const FB::VariantList& values)
+            : m_state(boost::make_shared<State>())
+        {
+            for (size_t i = 0; i < values.size(); ++i)
+                m_state->values[i] = values[i];
+            m_state->length = values.size();
+            m_state->haveLength = true;
+        }
+
+        /// @brief  Returns the element, fetching it from the page on first access; an empty
+        ///         variant when out of range
+        FB::variant get(size_t index) const
+        {
+            {
+                boost::mutex::scoped_lock lock(m_state->mutex);
+                std::map<size_t, FB::variant>::const_iterator fnd = m_state->values.find(index);
+                if (fnd != m_state->values.end())
+                    return fnd->second;
+            }
+            if (!m_obj)
+                return FB::variant();
+            FB::variant value(m_obj->GetProperty(static_cast<int>(index)));
+            boost::mutex::scoped_lock lock(m_state->mutex);
+            m_state->values[index] = value;
+            return value;
+        }
+        FB::variant operator[](size_t index) const { return get(index); }
+
+        /// @brief  Array length; fetched once and cached
+        size_t size() const
+        {
+            {
+                boost::mutex::scoped_lock lock(m_state->mutex);
+                if (m_state->haveLength)
+                    return m_state->length;
+            }
+            size_t len = m_obj ? static_cast<size_t>(m_obj->GetProperty("length").convert_cast<long>()) : 0;
+            boost::mutex::scoped_lock lock(m_state->mutex);
+            m_state->length = len;
+            m_state->haveLength = true;
+            return m_state->length;
+        }
+        bool empty() const { return size() == 0; }
+
+        /// @brief  Fetches every element in [first, first + count) that isn't cached yet in
+        ///         one main-thread trip
+        void prefetch(size_t first, size_t count) const
+        {
+            if (!m_obj)
+                return;
+            FB::BrowserHostPtr host(m_obj->m_host.lock());
+            if (host && !host->isMainThread())
+                host->CallOnMainThread(boost::bind(&LazyVariantList::fetchRange, this, first, count));
+            else
+                fetchRange(first, count);
+        }
+
+        /// @brief  Fetches everything outstanding (one main-thread trip) and returns the list
+        ///         the eager conversion would have produced
+        FB::VariantList materialize() const
+        {
+            size_t len = size();
+            prefetch(0, len);
+            FB::VariantList result;
+            result.reserve(len);
+            boost::mutex::scoped_lock lock(m_state->mutex);
+            for (size_t i = 0; i < len; ++i)
+                result.push_back(m_state->values[i]);
+            return result;
+        }
+
+        /// @brief  The wrapped Javascript object; empty when constructed from a plain list
+        FB::JSObjectPtr object() const { return m_obj; }
+
+    private:
+        struct State {
+            State() : length(0), haveLength(false) {}
+            boost::mutex mutex;
+            std::map<size_t, FB::variant> values;
+            size_t length;
+            bool haveLength;
+        };
+
+        void fetchRange(size_t first, size_t count) const
+        {
+            for (size_t i = first; i < first + count; ++i) {
+                {
+                    boost::mutex::scoped_lock lock(m_state->mutex);
+                    if (m_state->values.find(i) != m_state->values.end())
+                        continue;
+                }
+                FB::variant value(m_obj->GetProperty(static_cast<int>(i)));
+                boost::mutex::scoped_lock lock(m_state->mutex);
+                m_state->values[i] = value;
+            }
+        }
+
+        FB::JSObjectPtr m_obj;
+        boost::shared_ptr<State> m_state;
+    };
+
+    namespace variant_detail { namespace conversion {
+        // Convert out: hand the page back its own object when there is one, otherwise
+        // snapshot the values the way the eager containers would
+        inline variant make_variant(const FB::LazyVariantMap& map) {
+            if (map.object())
+                return variant(map.object(), true);
+            return make_variant_map(map.materialize());
+        }
+        inline variant make_variant(const FB::LazyVariantList& list) {
+            if (list.object())
+                return variant(list.object(), true);
+            return make_variant_list(list.materialize());
+        }
+
+        // Convert in
+        inline FB::LazyVariantMap convert_variant(const variant& var, type_spec<FB::LazyVariantMap>)
+        {
+            if (var.is_of_type<FB::LazyVariantMap>())
+                return var.cast<FB::LazyVariantMap>();
+            if (var.is_of_type<FB::VariantMap>())
+                return FB::LazyVariantMap(var.cast<FB::VariantMap>());
+            if (var.can_be_type<FB::JSObjectPtr>())
+                return FB::LazyVariantMap(var.convert_cast<FB::JSObjectPtr>());
+            throw bad_variant_cast(var.get_type(), typeid(FB::LazyVariantMap));
+        }
+        inline FB::LazyVariantList convert_variant(const variant& var, type_spec<FB::LazyVariantList>)
+        {
+            if (var.is_of_type<FB::LazyVariantList>())
+                return var.cast<FB::LazyVariantList>();
+            if (var.is_of_type<FB::VariantList>())
+                return FB::LazyVariantList(var.cast<FB::VariantList>());
+            if (var.can_be_type<FB::JSObjectPtr>())
+                return FB::LazyVariantList(var.convert_cast<FB::JSObjectPtr>());
+            throw bad_variant_cast(var.get_type(), typeid(FB::LazyVariantList));
+        }
+    } }
+}
+
+#endif // H_FB_LAZYCONTAINERS
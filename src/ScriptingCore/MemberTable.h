@@ -0,0 +1,142 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2012 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_MEMBERTABLE
+#define H_FB_MEMBERTABLE
+
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+namespace FB
+{
+    /// @brief Dense integer id assigned to an interned member name
+    typedef size_t MemberId;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  MemberTable
+    ///
+    /// @brief  Interns member names to dense integer ids
+    ///
+    /// JSAPIAuto keys several maps by member name, which means every Invoke/GetProperty does
+    /// multiple string map lookups.  This table assigns each name a small integer id the first
+    /// time it is registered; the id indexes a flat vector of member records, so the per-call
+    /// cost collapses to a single name lookup plus array accesses.  Ids are never reused for
+    /// the lifetime of the table, which keeps them safe to cache on the browser side.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class MemberTable
+    {
+    public:
+        MemberTable() { std::memset(m_bloom, 0, sizeof(m_bloom)); }
+
+        /// Returned by find() when the name has never been interned
+        static const MemberId no_member = static_cast<MemberId>(-1);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn MemberId MemberTable::intern(const std::string& name)
+        ///
+        /// @brief  Returns the id for name, assigning the next dense id if it is new
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        MemberId intern(const std::string& name)
+        {
+            std::map<std::string, MemberId>::const_iterator it = m_ids.find(name);
+            if (it != m_ids.end())
+                return it->second;
+            MemberId id = m_names.size();
+            m_ids[name] = id;
+            m_names.push_back(name);
+            bloom_add(name);
+            return id;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn MemberId MemberTable::find(const std::string& name) const
+        ///
+        /// @brief  Returns the id for name, or no_member if it has never been interned
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        MemberId find(const std::string& name) const
+        {
+            // Browsers probe objects for dozens of members they don't have (IE
+            // standard DISPIDs, JS feature detection); the filter turns those
+            // misses into two hashes instead of a string map walk
+            if (! mayContain(name))
+                return no_member;
+            std::map<std::string, MemberId>::const_iterator it = m_ids.find(name);
+            return (it != m_ids.end()) ? it->second : no_member;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool MemberTable::mayContain(const std::string& name) const
+        ///
+        /// @brief  True if name might be interned; false means definitely absent
+        ///
+        /// Two hash probes into a 256-bit bloom filter maintained by intern().  A false
+        /// positive just falls through to the ordinary map lookup; with the few dozen
+        /// members a typical API registers the false-positive rate stays in the
+        /// single-digit percent range.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool mayContain(const std::string& name) const
+        {
+            return bloom_test(hash_name(name, 0x811c9dc5u))
+                && bloom_test(hash_name(name, 0xc9dc5811u));
+        }
+
+        /// @brief  Returns the name that was interned for id
+        const std::string& nameOf(MemberId id) const
+        {
+            return m_names[id];
+        }
+
+        /// @brief  Number of interned names (also the smallest id never assigned)
+        size_t size() const
+        {
+            return m_names.size();
+        }
+
+    private:
+        // FNV-1a with a caller-chosen basis so one pass can stand in for two
+        // independent hash functions
+        static boost::uint32_t hash_name(const std::string& name, boost::uint32_t basis)
+        {
+            boost::uint32_t h = basis;
+            for (std::string::const_iterator it = name.begin(); it != name.end(); ++it) {
+                h ^= static_cast<unsigned char>(*it);
+                h *= 16777619u;
+            }
+            return h;
+        }
+
+        void bloom_add(const std::string& name)
+        {
+            boost::uint32_t h1 = hash_name(name, 0x811c9dc5u);
+            boost::uint32_t h2 = hash_name(name, 0xc9dc5811u);
+            m_bloom[(h1 >> 5) & 7] |= 1u << (h1 & 31);
+            m_bloom[(h2 >> 5) & 7] |= 1u << (h2 & 31);
+        }
+
+        bool bloom_test(boost::uint32_t h) const
+        {
+            return (m_bloom[(h >> 5) & 7] & (1u << (h & 31))) != 0;
+        }
+
+        std::map<std::string, MemberId> m_ids;
+        std::vector<std::string> m_names;
+        boost::uint32_t m_bloom[8];     // 256-bit presence filter over interned names
+    };
+}
+
+#endif // H_FB_MEMBERTABLE
@@ -20,15 +20,204 @@ Copyright 2009 Georg Fritzsche, Firebreath development team
 #  pragma once
 #endif
 
+#include <boost/config.hpp>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include "ConverterUtils.h"
+
+#if !defined(BOOST_NO_CXX11_VARIADIC_TEMPLATES) && !defined(BOOST_NO_CXX11_RVALUE_REFERENCES)
+// Set when the variadic method_wrapper below is available; StaticMemberTable.h
+// keys its unbound wrappers off of this
+#define FB_HAS_VARIADIC_METHOD_WRAPPERS 1
+
+namespace FB
+{
+    namespace detail { namespace methods
+    {
+        using FB::detail::plain_type;
+        using FB::convertArgumentSoft;
+
+        // Minimal compile-time index sequence; std::index_sequence is C++14
+        template<size_t...>
+        struct index_sequence {};
+
+        template<size_t N, size_t... Indices>
+        struct make_index_sequence : make_index_sequence<N - 1, N - 1, Indices...> {};
+
+        template<size_t... Indices>
+        struct make_index_sequence<0, Indices...> {
+            typedef index_sequence<Indices...> type;
+        };
+
+        // Converts one argument out of the VariantList; the last declared argument
+        // goes through convertLastArgument so the arity check and CatchAll handling
+        // stay exactly as they were with the generated per-arity wrappers
+        template<bool IsLast, typename T>
+        struct arg_converter {
+            static typename plain_type<T>::type convert(const FB::VariantList& in, size_t index) {
+                return convertArgumentSoft<typename plain_type<T>::type>(in, index);
+            }
+        };
+
+        template<typename T>
+        struct arg_converter<true, T> {
+            static typename plain_type<T>::type convert(const FB::VariantList& in, size_t index) {
+                return convertLastArgument<typename plain_type<T>::type>(in, index);
+            }
+        };
+
+        // "Soft" argument types may be absent from the call without that being an error
+        template<typename T>
+        struct is_soft_arg {
+            typedef typename plain_type<T>::type Ty;
+            static const bool value =
+                FB::meta::is_optional<Ty>::value
+                || boost::is_same<Ty, FB::variant>::value
+                || boost::is_same<Ty, boost::tribool>::value
+                || boost::is_same<Ty, FB::CatchAll>::value;
+        };
+
+        // Highest one-based position of an argument that must be supplied
+        template<size_t Index, typename... Args>
+        struct required_args;
+
+        template<size_t Index>
+        struct required_args<Index> { static const size_t value = 0; };
+
+        template<size_t Index, typename T, typename... Rest>
+        struct required_args<Index, T, Rest...> {
+            static const size_t later = required_args<Index + 1, Rest...>::value;
+            static const size_t value = later ? later : (is_soft_arg<T>::value ? 0 : Index + 1);
+        };
+
+        template<typename... Args>
+        struct last_is_catchall { static const bool value = false; };
+
+        template<typename T>
+        struct last_is_catchall<T> {
+            static const bool value = boost::is_same<typename plain_type<T>::type, FB::CatchAll>::value;
+        };
+
+        template<typename T, typename U, typename... Rest>
+        struct last_is_catchall<T, U, Rest...> : last_is_catchall<U, Rest...> {};
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct arg_plan
+        ///
+        /// @brief  Argument conversion plan for a method signature, fixed at registration time
+        ///
+        /// Since the parameter types of a registered method never change, the arity bounds are
+        /// compile-time constants of the signature: how many arguments must be present (trailing
+        /// optional<T>/variant/tribool/CatchAll may be absent) and whether a trailing CatchAll
+        /// lifts the upper bound.  check() boils down to two integer comparisons executed before
+        /// any conversion work, so a call with the wrong argument count fails without building
+        /// and then unwinding partially converted temporaries.  The conversions themselves are
+        /// instantiated statically per signature in method_wrapper, which is already the tightest
+        /// plan available — a runtime table of converter pointers would only add indirection.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        template<typename... Args>
+        struct arg_plan {
+            static const size_t arity = sizeof...(Args);
+            static const size_t required = required_args<0, Args...>::value;
+            static const bool catch_all = last_is_catchall<Args...>::value;
+
+            static void check(const FB::VariantList& in) {
+                if (in.size() < required) {
+                    std::stringstream ss;
+                    ss << "Invalid Argument Count, expected "
+                       << (catch_all || required != arity ? "at least " : "")
+                       << required << " arguments";
+                    throw FB::invalid_arguments(ss.str());
+                }
+                // a nullary method has always silently ignored extra arguments; keep that
+                if (arity > 0 && !catch_all && in.size() > arity) {
+                    std::stringstream ss;
+                    ss << "Too many arguments, expected " << arity << ".";
+                    throw FB::invalid_arguments(ss.str());
+                }
+            }
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct method_wrapper
+        ///
+        /// @brief  Adapts a member function pointer into the VariantList calling convention
+        ///
+        /// Replaces the fifty per-arity method_wrapperN structs; the VariantList is unpacked
+        /// into typed arguments through an index sequence, so each converted value is a
+        /// temporary passed straight into the target method with no intermediate containers.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        template<typename C, typename R, typename F, typename... Args>
+        struct method_wrapper
+        {
+            typedef FB::variant result_type;
+            F f;
+            method_wrapper(F f) : f(f) {}
+            FB::variant operator()(C* instance, const FB::VariantList& in)
+            {
+                arg_plan<Args...>::check(in);
+                return call(instance, in, typename make_index_sequence<sizeof...(Args)>::type());
+            }
+        private:
+            template<size_t... Indices>
+            FB::variant call(C* instance, const FB::VariantList& in, index_sequence<Indices...>)
+            {
+                return (instance->*f)(
+                    arg_converter<(Indices + 1 == sizeof...(Args)), Args>::convert(in, Indices + 1)...);
+            }
+        };
+
+        template<typename C, typename F, typename... Args>
+        struct method_wrapper<C, void, F, Args...>
+        {
+            typedef FB::variant result_type;
+            F f;
+            method_wrapper(F f) : f(f) {}
+            FB::variant operator()(C* instance, const FB::VariantList& in)
+            {
+                arg_plan<Args...>::check(in);
+                call(instance, in, typename make_index_sequence<sizeof...(Args)>::type());
+                return FB::variant();
+            }
+        private:
+            template<size_t... Indices>
+            void call(C* instance, const FB::VariantList& in, index_sequence<Indices...>)
+            {
+                (instance->*f)(
+                    arg_converter<(Indices + 1 == sizeof...(Args)), Args>::convert(in, Indices + 1)...);
+            }
+        };
+
+    } } // namespace detail::methods
+
+    template<class C, class R, class... Args>
+    inline FB::CallMethodFunctor
+    make_method(C* instance, R (C::*function)(Args...))
+    {
+        return boost::bind(
+            FB::detail::methods::method_wrapper<C, R, R (C::*)(Args...), Args...>(function),
+            instance, _1);
+    }
+
+    template<class C, class R, class... Args>
+    inline FB::CallMethodFunctor
+    make_method(C* instance, R (C::*function)(Args...) const)
+    {
+        return boost::bind(
+            FB::detail::methods::method_wrapper<C, R, R (C::*)(Args...) const, Args...>(function),
+            instance, _1);
+    }
+
+} // namespace FB
+
+#else // no variadic templates; fall back to the preprocessor-generated arity overloads
+
 #include <boost/preprocessor/repetition.hpp>
 #include <boost/preprocessor/cat.hpp>
 #include <boost/preprocessor/arithmetic/sub.hpp>
 #include <boost/preprocessor/arithmetic/add.hpp>
 #include <boost/preprocessor/comparison/equal.hpp>
 #include <boost/preprocessor/comparison/greater.hpp>
-#include <boost/function.hpp>
-#include <boost/bind.hpp>
-#include "ConverterUtils.h"
 
 #define _FB_MW_TPL(z, n, data) typename T##n
 #define _FB_MW_Tn(z, n, data) T##n
@@ -131,4 +320,6 @@ namespace FB
 #undef _FB_MW_CARGS
 #undef _FB_MW_TLASTDEF
 
+#endif // BOOST_NO_CXX11_VARIADIC_TEMPLATES
+
 #endif //METHOD_CONVERTER_H
@@ -0,0 +1,56 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <boost/thread/mutex.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "ObjectCensus.h"
+
+namespace {
+    typedef std::map<std::string, boost::detail::atomic_count*> CounterMap;
+
+    // The registry lock is only taken on first use of a type and on snapshot();
+    // the per-object increments and decrements go straight to the atomic counters
+    boost::mutex g_registryMutex;
+
+    // Leaked on purpose: counted objects can outlive static destruction order
+    CounterMap& registry() {
+        static CounterMap* map = new CounterMap;
+        return *map;
+    }
+}
+
+FB::ObjectCensus::Snapshot FB::ObjectCensus::snapshot()
+{
+    boost::mutex::scoped_lock _l(g_registryMutex);
+    Snapshot out;
+    CounterMap& map = registry();
+    for (CounterMap::const_iterator it = map.begin(); it != map.end(); ++it) {
+        out[it->first] = static_cast<boost::int64_t>(static_cast<long>(*it->second));
+    }
+    return out;
+}
+
+boost::detail::atomic_count* FB::ObjectCensus::obtainCounter(const char* name)
+{
+    boost::mutex::scoped_lock _l(g_registryMutex);
+    CounterMap& map = registry();
+    CounterMap::const_iterator found = map.find(name);
+    if (found != map.end())
+        return found->second;
+    boost::detail::atomic_count* counter = new boost::detail::atomic_count(0);
+    map[name] = counter;
+    return counter;
+}
+
@@ -0,0 +1,105 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_OBJECTCENSUS
+#define H_FB_OBJECTCENSUS
+
+#include <map>
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/detail/atomic_count.hpp>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Live-object census for the framework types that commonly leak.
+///
+/// HttpService's Countable already proved the idea of counting live instances; this generalizes
+/// it so the bridge objects that get pinned past page teardown (JSAPI implementations, browser
+/// object wrappers, streams, shareable references) each maintain a live count.  Deriving from
+/// census_counted<T> costs one atomic increment per construction and one decrement per
+/// destruction -- no per-object storage -- and snapshot() lists the live count per type, which
+/// is usually enough to spot "the page navigated away but 400 NPObjectAPI wrappers are still
+/// alive" without attaching a heap profiler.
+///
+/// @since 1.7
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace FB {
+
+    namespace ObjectCensus {
+
+        /// Live count per registered type name; types whose counter was never touched
+        /// do not appear
+        typedef std::map<std::string, boost::int64_t> Snapshot;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn Snapshot snapshot()
+        ///
+        /// @brief  Returns the current live-instance count for every counted type
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        Snapshot snapshot();
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn boost::detail::atomic_count* obtainCounter(const char* name)
+        ///
+        /// @brief  Returns the shared counter registered under name, creating it on first use
+        ///
+        /// Idempotent: every call with the same name returns the same counter, so a racy
+        /// first call from two threads is harmless.  Counters are never destroyed; objects
+        /// may still be dying during static teardown.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        boost::detail::atomic_count* obtainCounter(const char* name);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  census_counted
+    ///
+    /// @brief  Mixin that counts live instances of T in the object census
+    ///
+    /// Derive as census_counted<T> and provide a static censusName() returning the label the
+    /// type should appear under in ObjectCensus::snapshot().  Template bases of a class
+    /// template (e.g. ShareableReference) aggregate all instantiations under one label by
+    /// returning the same name.
+    ///
+    /// @code
+    ///      class BrowserStream : public PluginEventSource, public census_counted<BrowserStream>
+    ///      {
+    ///      public:
+    ///          static const char* censusName() { return "BrowserStream"; }
+    /// @endcode
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<class T>
+    class census_counted
+    {
+    protected:
+        census_counted() { ++counter(); }
+        census_counted(const census_counted&) { ++counter(); }
+        ~census_counted() { --counter(); }
+
+    private:
+        static boost::detail::atomic_count& counter() {
+            // obtainCounter is idempotent, so a first-use race at worst stores the
+            // same pointer twice
+            static boost::detail::atomic_count* c = ObjectCensus::obtainCounter(T::censusName());
+            return *c;
+        }
+    };
+}
+
+#endif // H_FB_OBJECTCENSUS
+
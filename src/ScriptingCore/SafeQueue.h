@@ -18,6 +18,8 @@
 
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/cstdint.hpp>
 #include <queue>
 
 namespace FB {
@@ -32,9 +34,52 @@ namespace FB {
     {
     private:
         std::queue<Data> the_queue;
+        // enqueue time of each entry, kept in lockstep with the_queue so the age of
+        // the oldest item can be reported
+        std::queue<boost::posix_time::ptime> the_times;
         mutable boost::mutex the_mutex;
         boost::condition_variable the_condition_variable;
+        boost::uint64_t m_pushed;
+        boost::uint64_t m_popped;
+        std::size_t m_highWater;
     public:
+        SafeQueue() : m_pushed(0), m_popped(0), m_highWater(0) { }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @struct Stats
+        ///
+        /// @brief  Snapshot of the queue's gauges; see SafeQueue::getStats()
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        struct Stats {
+            boost::uint64_t pushed;     // total items ever pushed
+            boost::uint64_t popped;     // total items ever popped
+            std::size_t depth;          // items currently queued
+            std::size_t highWater;      // deepest the queue has ever been
+            long oldestAgeMs;           // age of the front item in ms; 0 when empty
+        };
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn Stats SafeQueue::getStats() const
+        ///
+        /// @brief  Returns a consistent snapshot of the queue gauges.  Useful for telling whether
+        ///         a consumer is keeping up: a growing depth or a large oldestAgeMs means it is not.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        Stats getStats() const
+        {
+            boost::mutex::scoped_lock lock(the_mutex);
+            Stats s;
+            s.pushed = m_pushed;
+            s.popped = m_popped;
+            s.depth = the_queue.size();
+            s.highWater = m_highWater;
+            s.oldestAgeMs = the_times.empty() ? 0 : static_cast<long>(
+                (boost::posix_time::microsec_clock::universal_time() - the_times.front()).total_milliseconds());
+            return s;
+        }
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn void SafeQueue::push(Data const& data)
         ///
@@ -46,6 +91,10 @@ namespace FB {
         {
             boost::mutex::scoped_lock lock(the_mutex);
             the_queue.push(data);
+            the_times.push(boost::posix_time::microsec_clock::universal_time());
+            ++m_pushed;
+            if (the_queue.size() > m_highWater)
+                m_highWater = the_queue.size();
             lock.unlock();
             the_condition_variable.notify_one();
         }
@@ -82,6 +131,35 @@ namespace FB {
             
             popped_value=the_queue.front();
             the_queue.pop();
+            the_times.pop();
+            ++m_popped;
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn bool SafeQueue::try_pop_all(std::queue<Data>& popped_values)
+        ///
+        /// @brief  Pops everything currently in the queue in a single operation; the contents are
+        ///         swapped into popped_values, which should be empty.  Unlike calling try_pop in a
+        ///         loop this takes the lock only once, no matter how many items are queued, so
+        ///         producers are never blocked while the consumer works through the batch.
+        ///
+        /// @param [out] popped_values   Receives the queued values; its previous contents end up
+        ///                              in the queue, so pass an empty queue.
+        ///
+        /// @return true if any values were returned, false if the queue was empty
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        bool try_pop_all(std::queue<Data>& popped_values)
+        {
+            boost::mutex::scoped_lock lock(the_mutex);
+            if(the_queue.empty())
+            {
+                return false;
+            }
+
+            m_popped += the_queue.size();
+            std::swap(the_queue, popped_values);
+            the_times = std::queue<boost::posix_time::ptime>();
             return true;
         }
 
@@ -111,9 +189,11 @@ namespace FB {
             {
                 return false;
             }
-            
+
             popped_value=the_queue.front();
             the_queue.pop();
+            the_times.pop();
+            ++m_popped;
             return true;
         }
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -134,6 +214,8 @@ namespace FB {
             
             popped_value=the_queue.front();
             the_queue.pop();
+            the_times.pop();
+            ++m_popped;
         }
 
     };
@@ -16,18 +16,33 @@ Copyright 2009 Richard Bateman, Firebreath development team
 \**********************************************************/
 
 #include <boost/enable_shared_from_this.hpp>
+#include "ObjectCensus.h"
 
 namespace FB {
 
     template <class C>
-    class ShareableReference : boost::noncopyable, public boost::enable_shared_from_this<ShareableReference<C> >
+    class ShareableReference : boost::noncopyable, public boost::enable_shared_from_this<ShareableReference<C> >,
+        public census_counted<ShareableReference<C> >
     {
     public:
-        ShareableReference(C* ptr) : m_ptr(ptr) {}
+        /// All instantiations aggregate under one label in FB::ObjectCensus::snapshot()
+        static const char* censusName() { return "ShareableReference"; }
+
+        ShareableReference(C* ptr) : m_ptr(ptr), m_valid(true) {}
         C* getPtr() { return m_ptr; }
 
+        // Owner-side notification that the referent has been released.  Consumers that
+        // hold the reference strongly (avoiding a weak_ptr promotion -- two atomic RMW
+        // operations -- on every use) poll isValid() instead: a plain load of a flag
+        // that only ever goes from true to false.  Both sides of the handoff run on
+        // the main thread; the flag is volatile only so the check can't be hoisted
+        // out of a loop.
+        void invalidate() { m_valid = false; }
+        bool isValid() const { return m_valid; }
+
     private:
         C* m_ptr;
+        volatile bool m_valid;
     };
 
 };
@@ -0,0 +1,96 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <sstream>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/mutex.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "logging.h"
+#include "variant_list.h"
+#include "variant_map.h"
+#include "StartupTimer.h"
+
+namespace
+{
+    struct Mark {
+        std::string stage;
+        boost::uint64_t offsetUs;   // from the first mark
+    };
+
+    std::vector<Mark> marks;
+    boost::posix_time::ptime anchor;
+    boost::mutex marks_mutex;
+}
+
+void FB::StartupTimer::mark(const std::string& stage)
+{
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    boost::mutex::scoped_lock lock(marks_mutex);
+    for (std::vector<Mark>::const_iterator it = marks.begin(); it != marks.end(); ++it) {
+        if (it->stage == stage)
+            return;     // keep the timing of the first, slow occurrence
+    }
+    Mark m;
+    m.stage = stage;
+    if (marks.empty()) {
+        anchor = now;
+        m.offsetUs = 0;
+    } else {
+        m.offsetUs = (now - anchor).total_microseconds();
+    }
+    marks.push_back(m);
+}
+
+FB::VariantList FB::StartupTimer::getMarks()
+{
+    boost::mutex::scoped_lock lock(marks_mutex);
+    FB::VariantList out;
+    boost::uint64_t prev = 0;
+    for (std::vector<Mark>::const_iterator it = marks.begin(); it != marks.end(); ++it) {
+        FB::VariantMap entry;
+        entry["stage"] = it->stage;
+        entry["ms"] = it->offsetUs / 1000.0;
+        entry["delta"] = (it->offsetUs - prev) / 1000.0;
+        prev = it->offsetUs;
+        out.push_back(entry);
+    }
+    return out;
+}
+
+std::string FB::StartupTimer::report()
+{
+    boost::mutex::scoped_lock lock(marks_mutex);
+    std::ostringstream os;
+    os << "startup phases:";
+    boost::uint64_t prev = 0;
+    for (std::vector<Mark>::const_iterator it = marks.begin(); it != marks.end(); ++it) {
+        os << "\n  " << it->stage << ": +" << ((it->offsetUs - prev) / 1000.0)
+           << "ms (at " << (it->offsetUs / 1000.0) << "ms)";
+        prev = it->offsetUs;
+    }
+    return os.str();
+}
+
+void FB::StartupTimer::logReport()
+{
+    FBLOG_INFO("StartupTimer", report());
+}
+
+void FB::StartupTimer::reset()
+{
+    boost::mutex::scoped_lock lock(marks_mutex);
+    marks.clear();
+}
@@ -0,0 +1,60 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_STARTUPTIMER
+#define H_FB_STARTUPTIMER
+
+#include <string>
+#include "APITypes.h"
+
+namespace FB { namespace StartupTimer {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn void mark(const std::string& stage)
+    ///
+    /// @brief  Timestamps a framework startup stage
+    ///
+    /// The first mark() anchors the clock; every later one records its offset from that
+    /// anchor.  Only the first occurrence of each stage name is kept, so instance-scoped
+    /// callsites (constructor, first SetWindow) can mark unconditionally and the buffer
+    /// still describes the first, slow instance.  Cheap and thread-safe.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    void mark(const std::string& stage);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn FB::VariantList getMarks()
+    ///
+    /// @brief  Returns the recorded stages for scripting introspection
+    ///
+    /// Each entry is a map with "stage", "ms" (offset from the first mark) and "delta"
+    /// (time since the previous stage), both in milliseconds.  Exposed to pages through
+    /// the startupTimings property on every JSAPIAuto object.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    FB::VariantList getMarks();
+
+    /// @brief  One-line-per-stage text rendering of getMarks()
+    std::string report();
+
+    /// @brief  Writes report() to the log at info level (source "StartupTimer")
+    void logReport();
+
+    /// @brief  Clears the buffer; mainly for tests
+    void reset();
+
+} }
+
+#endif
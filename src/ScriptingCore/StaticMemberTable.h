@@ -0,0 +1,266 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2012 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_STATICMEMBERTABLE
+#define H_FB_STATICMEMBERTABLE
+
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/bind.hpp>
+#include <boost/preprocessor/repetition.hpp>
+#include <boost/preprocessor/cat.hpp>
+#include <boost/preprocessor/comparison/greater.hpp>
+#include "JSAPIAuto.h"
+
+namespace FB
+{
+    namespace detail
+    {
+        /// @brief Method functor with the instance left unbound; shared by every object of class C
+        template<class C>
+        struct unbound_method {
+            typedef boost::function<FB::variant (C*, const FB::VariantList&)> type;
+        };
+        /// @brief Property getter with the instance left unbound
+        template<class C>
+        struct unbound_getter {
+            typedef boost::function<FB::variant (C*)> type;
+        };
+        /// @brief Property setter with the instance left unbound
+        template<class C>
+        struct unbound_setter {
+            typedef boost::function<void (C*, const FB::variant&)> type;
+        };
+    }
+
+#if defined(FB_HAS_VARIADIC_METHOD_WRAPPERS)
+
+    // Like make_method(), but wraps the member function pointer without binding an
+    // instance; the conversion plumbing (method_wrapper) is built once and reused
+    // for every object.
+    template<class C, class R, class... Args>
+    inline typename FB::detail::unbound_method<C>::type
+    make_unbound_method(R (C::*function)(Args...))
+    {
+        return FB::detail::methods::method_wrapper<C, R, R (C::*)(Args...), Args...>(function);
+    }
+
+    template<class C, class R, class... Args>
+    inline typename FB::detail::unbound_method<C>::type
+    make_unbound_method(R (C::*function)(Args...) const)
+    {
+        return FB::detail::methods::method_wrapper<C, R, R (C::*)(Args...) const, Args...>(function);
+    }
+
+#else
+
+#define _FB_SMT_TPL(z, n, data) typename T##n
+#define _FB_SMT_Tn(z, n, data) T##n
+
+// Like make_method(), but wraps the member function pointer without binding an instance;
+// the conversion plumbing (method_wrapperN) is built once and reused for every object.
+#define _FB_MAKE_UNBOUND_METHOD(z, n, data)                                     \
+    template<class C, class R                                                   \
+            BOOST_PP_COMMA_IF(BOOST_PP_GREATER(n,0))                            \
+            BOOST_PP_ENUM(n, _FB_SMT_TPL, 0)>                                   \
+    inline typename FB::detail::unbound_method<C>::type                         \
+    make_unbound_method(R (C::*function)(                                       \
+        BOOST_PP_ENUM(n, _FB_SMT_Tn, 0)))                                       \
+    {                                                                           \
+        return FB::detail::methods::method_wrapper##n<C, R                      \
+            BOOST_PP_COMMA_IF(BOOST_PP_GREATER(n,0))                            \
+            BOOST_PP_ENUM(n, _FB_SMT_Tn, 0)                                     \
+            , R (C::*)(BOOST_PP_ENUM(n, _FB_SMT_Tn, 0))>(function);             \
+    }                                                                           \
+    template<class C, class R                                                   \
+            BOOST_PP_COMMA_IF(BOOST_PP_GREATER(n,0))                            \
+            BOOST_PP_ENUM(n, _FB_SMT_TPL, 0)>                                   \
+    inline typename FB::detail::unbound_method<C>::type                         \
+    make_unbound_method(R (C::*function)(                                       \
+        BOOST_PP_ENUM(n, _FB_SMT_Tn, 0)) const)                                 \
+    {                                                                           \
+        return FB::detail::methods::method_wrapper##n<C, R                      \
+            BOOST_PP_COMMA_IF(BOOST_PP_GREATER(n,0))                            \
+            BOOST_PP_ENUM(n, _FB_SMT_Tn, 0)                                     \
+            , R (C::*)(BOOST_PP_ENUM(n, _FB_SMT_Tn, 0)) const>(function);       \
+    }
+
+    BOOST_PP_REPEAT(50, _FB_MAKE_UNBOUND_METHOD, BOOST_PP_EMPTY())
+
+#undef _FB_MAKE_UNBOUND_METHOD
+#undef _FB_SMT_TPL
+#undef _FB_SMT_Tn
+
+#endif // FB_HAS_VARIADIC_METHOD_WRAPPERS
+
+    // Unbound counterparts of the make_property() helpers
+
+    template<class C, typename T>
+    inline typename FB::detail::unbound_getter<C>::type
+    make_unbound_getter(T (C::*getter)())
+    {
+        return boost::bind(boost::mem_fn(getter), _1);
+    }
+
+    template<class C, typename T>
+    inline typename FB::detail::unbound_getter<C>::type
+    make_unbound_getter(T (C::*getter)() const)
+    {
+        return boost::bind(boost::mem_fn(getter), _1);
+    }
+
+    template<class C, typename T>
+    inline typename FB::detail::unbound_setter<C>::type
+    make_unbound_setter(void (C::*setter)(T))
+    {
+        typedef typename FB::detail::plain_type<T>::type Ty;
+        typedef FB::detail::converter<Ty, FB::variant> converter;
+        return boost::bind(setter, _1, boost::bind(&converter::convert, _2));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  StaticMemberTable
+    ///
+    /// @brief  Per-class member table built once and applied to every instance
+    ///
+    /// Registering each member with registerMethod()/registerProperty() from the constructor
+    /// rebuilds the whole conversion plumbing for every object, which adds up when a plugin
+    /// creates thousands of short-lived JSAPIAuto objects.  This table holds the type-erased
+    /// method and property wrappers with the instance left unbound, so they are constructed
+    /// exactly once per class; apply() then binds them to an instance and registers the whole
+    /// set with a single member snapshot publish.
+    ///
+    /// Declare the table in a static accessor and apply it from the constructor:
+    /// @code
+    /// class MyPluginAPI : public FB::JSAPIAuto {
+    /// public:
+    ///     MyPluginAPI() { memberTable().apply(this); }
+    ///     long add(long a, long b);
+    ///     std::string get_version() const;
+    /// private:
+    ///     static const FB::StaticMemberTable<MyPluginAPI>& memberTable() {
+    ///         static const FB::StaticMemberTable<MyPluginAPI> table =
+    ///             FB::StaticMemberTable<MyPluginAPI>()
+    ///                 .method("add", &MyPluginAPI::add)
+    ///                 .property("version", &MyPluginAPI::get_version);
+    ///         return table;
+    ///     }
+    /// };
+    /// @endcode
+    ///
+    /// Members are registered in the security zone active on the instance when apply() runs;
+    /// wrap the apply() call in a scoped_zonelock to register a table under another zone.
+    ///
+    /// @see JSAPIAuto
+    /// @see make_method
+    /// @see make_property
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<class C>
+    class StaticMemberTable
+    {
+    public:
+        typedef typename FB::detail::unbound_method<C>::type UnboundMethod;
+        typedef typename FB::detail::unbound_getter<C>::type UnboundGetter;
+        typedef typename FB::detail::unbound_setter<C>::type UnboundSetter;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn StaticMemberTable& StaticMemberTable::method(const std::string& name, MethodPtr function)
+        ///
+        /// @brief  Adds a method to the table; the counterpart of registerMethod()/make_method()
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        template<typename MethodPtr>
+        StaticMemberTable& method(const std::string& name, MethodPtr function)
+        {
+            MethodDef def;
+            def.name = name;
+            def.call = make_unbound_method(function);
+            m_methods.push_back(def);
+            return *this;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn StaticMemberTable& StaticMemberTable::property(const std::string& name, GetterPtr getter, SetterPtr setter)
+        ///
+        /// @brief  Adds a read/write property to the table; the counterpart of make_property()
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        template<typename GetterPtr, typename SetterPtr>
+        StaticMemberTable& property(const std::string& name, GetterPtr getter, SetterPtr setter)
+        {
+            PropertyDef def;
+            def.name = name;
+            def.get = make_unbound_getter(getter);
+            def.set = make_unbound_setter(setter);
+            m_properties.push_back(def);
+            return *this;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn StaticMemberTable& StaticMemberTable::property(const std::string& name, GetterPtr getter)
+        ///
+        /// @brief  Adds a read-only property to the table
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        template<typename GetterPtr>
+        StaticMemberTable& property(const std::string& name, GetterPtr getter)
+        {
+            PropertyDef def;
+            def.name = name;
+            def.get = make_unbound_getter(getter);
+            def.set = boost::bind(FB::detail::properties::dummySetter, _2);
+            m_properties.push_back(def);
+            return *this;
+        }
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void StaticMemberTable::apply(C* instance) const
+        ///
+        /// @brief  Registers every member of the table on instance
+        ///
+        /// Binding a prebuilt wrapper to the instance is all that happens per object; the whole
+        /// set is registered inside one scoped_member_batch so the member snapshot is copied and
+        /// published once instead of once per member.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void apply(C* instance) const
+        {
+            JSAPIAuto::scoped_member_batch batch(instance);
+            for (typename std::vector<MethodDef>::const_iterator it = m_methods.begin();
+                    it != m_methods.end(); ++it) {
+                instance->registerMethod(it->name, boost::bind(it->call, instance, _1));
+            }
+            for (typename std::vector<PropertyDef>::const_iterator it = m_properties.begin();
+                    it != m_properties.end(); ++it) {
+                instance->registerProperty(it->name, PropertyFunctors(
+                    boost::bind(it->get, instance),
+                    boost::bind(it->set, instance, _1)));
+            }
+        }
+
+    private:
+        struct MethodDef {
+            std::string name;
+            UnboundMethod call;
+        };
+        struct PropertyDef {
+            std::string name;
+            UnboundGetter get;
+            UnboundSetter set;
+        };
+
+        std::vector<MethodDef> m_methods;
+        std::vector<PropertyDef> m_properties;
+    };
+}
+
+#endif // H_FB_STATICMEMBERTABLE
@@ -0,0 +1,42 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+#include "StringIntern.h"
+
+using FB::StringInternTable;
+
+StringInternTable& StringInternTable::get()
+{
+    static StringInternTable table;
+    return table;
+}
+
+const std::string& StringInternTable::intern(const std::string& s)
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    std::set<std::string>::const_iterator fnd = m_table.find(s);
+    if (fnd != m_table.end())
+        return *fnd;
+    if (m_table.size() >= kMaxEntries)
+        return s; // table full; hand the caller's own string back
+    // set iterators are stable and entries are never erased, so the reference
+    // stays good for the life of the process
+    return *m_table.insert(s).first;
+}
+
+size_t StringInternTable::size() const
+{
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_table.size();
+}
@@ -0,0 +1,75 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_STRINGINTERN
+#define H_FB_STRINGINTERN
+
+#include <set>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace FB {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  StringInternTable
+    ///
+    /// @brief  Process-wide intern table for the small, hot set of strings that cross the JS
+    ///         bridge over and over
+    ///
+    /// Payloads tend to repeat the same few dozen property names (schema field names) millions
+    /// of times per session; interning them makes every occurrence refer to one immutable copy
+    /// instead of a fresh allocation.  intern() hands back a reference that stays valid for the
+    /// life of the process (entries are never erased), so copies taken from it share storage
+    /// wherever the standard library's string is reference counted, and same() can answer most
+    /// equality checks on pointer identity alone.
+    ///
+    /// The table is capped so unbounded dynamically-generated keys cannot grow it forever;
+    /// past the cap intern() simply returns its argument.
+    ///
+    /// @since 1.7
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class StringInternTable : boost::noncopyable {
+    public:
+        static StringInternTable& get();
+
+        /// The canonical copy of s; inserts it on first sight (until the cap is hit,
+        /// after which uncached strings are returned unchanged)
+        const std::string& intern(const std::string& s);
+
+        /// Equality with a pointer-identity fast path for interned strings
+        static bool same(const std::string& a, const std::string& b) {
+            return a.data() == b.data() || a == b;
+        }
+
+        size_t size() const;
+
+    private:
+        StringInternTable() {}
+
+        static const size_t kMaxEntries = 4096;
+
+        mutable boost::mutex m_mutex;
+        std::set<std::string> m_table;
+    };
+
+    /// @brief  Shorthand for StringInternTable::get().intern(s)
+    /// @since 1.7
+    inline const std::string& intern_string(const std::string& s) {
+        return StringInternTable::get().intern(s);
+    }
+};
+
+#endif // H_FB_STRINGINTERN
@@ -0,0 +1,158 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <new>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "ThreadCachedPool.h"
+#include "AllocTracker.h"
+
+using namespace FB::detail;
+
+namespace {
+    // Sizes are rounded up to a multiple of BucketGranularity; anything over MaxBlockSize
+    // goes straight to the global allocator.  Call records (FunctorCallImpl plus its
+    // shared_ptr control block) land comfortably inside these buckets.
+    const std::size_t BucketGranularity = 32;
+    const std::size_t MaxBlockSize = 512;
+    const std::size_t BucketCount = MaxBlockSize / BucketGranularity;
+
+    // A thread cache holding more than MaxCached blocks in a bucket returns BatchSize of
+    // them to the shared bin in one locked splice; refills also move BatchSize at a time
+    const std::size_t BatchSize = 16;
+    const std::size_t MaxCached = 32;
+
+    // Freed blocks are reused to hold the free list links, so no headers are needed
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct CentralBin {
+        boost::mutex mutex;
+        FreeBlock* head;
+    };
+
+    CentralBin g_centralBins[BucketCount];
+
+    inline std::size_t bucketFor(std::size_t size) {
+        return (size - 1) / BucketGranularity;
+    }
+    inline std::size_t bucketSize(std::size_t bucket) {
+        return (bucket + 1) * BucketGranularity;
+    }
+
+    struct ThreadCache {
+        FreeBlock* head[BucketCount];
+        std::size_t count[BucketCount];
+
+        ThreadCache() {
+            for (std::size_t i = 0; i < BucketCount; ++i) {
+                head[i] = NULL;
+                count[i] = 0;
+            }
+        }
+        ~ThreadCache() {
+            // Thread is going away; hand everything back to the shared bins so other
+            // threads can reuse the blocks
+            for (std::size_t i = 0; i < BucketCount; ++i) {
+                if (!head[i])
+                    continue;
+                FreeBlock* last = head[i];
+                while (last->next)
+                    last = last->next;
+                boost::mutex::scoped_lock lock(g_centralBins[i].mutex);
+                last->next = g_centralBins[i].head;
+                g_centralBins[i].head = head[i];
+            }
+        }
+    };
+
+    boost::thread_specific_ptr<ThreadCache> g_threadCache;
+
+    ThreadCache& getThreadCache() {
+        ThreadCache* cache = g_threadCache.get();
+        if (!cache) {
+            cache = new ThreadCache;
+            g_threadCache.reset(cache);
+        }
+        return *cache;
+    }
+}
+
+void* ThreadCachedPool::allocate(std::size_t size)
+{
+    FB::AllocTracker::recordAlloc(FB::AllocTracker::Subsystem_CallRecord, size);
+    if (!size || size > MaxBlockSize)
+        return ::operator new(size);
+
+    const std::size_t bucket = bucketFor(size);
+    ThreadCache& cache = getThreadCache();
+    if (!cache.head[bucket]) {
+        // Local cache is dry; splice a batch off the shared bin under one lock
+        CentralBin& bin = g_centralBins[bucket];
+        boost::mutex::scoped_lock lock(bin.mutex);
+        std::size_t moved = 0;
+        while (bin.head && moved < BatchSize) {
+            FreeBlock* block = bin.head;
+            bin.head = block->next;
+            block->next = cache.head[bucket];
+            cache.head[bucket] = block;
+            ++moved;
+        }
+        cache.count[bucket] += moved;
+    }
+    if (!cache.head[bucket])
+        return ::operator new(bucketSize(bucket));
+
+    FreeBlock* block = cache.head[bucket];
+    cache.head[bucket] = block->next;
+    --cache.count[bucket];
+    return block;
+}
+
+void ThreadCachedPool::deallocate(void* ptr, std::size_t size)
+{
+    if (!ptr)
+        return;
+    FB::AllocTracker::recordFree(FB::AllocTracker::Subsystem_CallRecord, size);
+    if (!size || size > MaxBlockSize) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    const std::size_t bucket = bucketFor(size);
+    ThreadCache& cache = getThreadCache();
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = cache.head[bucket];
+    cache.head[bucket] = block;
+    ++cache.count[bucket];
+
+    if (cache.count[bucket] > MaxCached) {
+        // This thread is freeing more than it allocates (the main thread, typically);
+        // return a batch to the shared bin so the allocating threads can recycle it
+        FreeBlock* batchHead = cache.head[bucket];
+        FreeBlock* batchTail = batchHead;
+        for (std::size_t i = 1; i < BatchSize; ++i)
+            batchTail = batchTail->next;
+        cache.head[bucket] = batchTail->next;
+        cache.count[bucket] -= BatchSize;
+
+        CentralBin& bin = g_centralBins[bucket];
+        boost::mutex::scoped_lock lock(bin.mutex);
+        batchTail->next = bin.head;
+        bin.head = batchHead;
+    }
+}
+
@@ -0,0 +1,109 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_THREADCACHEDPOOL
+#define H_FB_THREADCACHEDPOOL
+
+#include <cstddef>
+
+namespace FB { namespace detail
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  ThreadCachedPool
+    ///
+    /// @brief  Recycling allocator for small, short-lived call records
+    ///
+    /// Cross-thread calls allocate a call record on one thread and free it on another; done
+    /// through the global allocator that ping-pongs every block between heaps.  This pool keeps
+    /// a small per-thread cache of freed blocks, bucketed by size, and moves blocks between the
+    /// caches and a shared free list in batches so the lock is taken once per batch rather than
+    /// once per call.  Blocks larger than the biggest bucket fall through to the global
+    /// allocator unchanged.
+    ///
+    /// This is not a general purpose allocator; use it through call_pool_allocator (e.g. with
+    /// boost::allocate_shared) or a class-level operator new/delete pair.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class ThreadCachedPool
+    {
+    public:
+        static void* allocate(std::size_t size);
+        static void deallocate(void* ptr, std::size_t size);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  call_pool_allocator
+    ///
+    /// @brief  Standard allocator facade over ThreadCachedPool, for boost::allocate_shared
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template <typename T>
+    class call_pool_allocator
+    {
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef const T* const_pointer;
+        typedef T& reference;
+        typedef const T& const_reference;
+        typedef std::size_t size_type;
+        typedef std::ptrdiff_t difference_type;
+
+        template <typename U>
+        struct rebind { typedef call_pool_allocator<U> other; };
+
+        call_pool_allocator() {}
+        template <typename U>
+        call_pool_allocator(const call_pool_allocator<U>&) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+
+        pointer allocate(size_type n, const void* /*hint*/ = 0) {
+            return static_cast<pointer>(ThreadCachedPool::allocate(n * sizeof(T)));
+        }
+        void deallocate(pointer p, size_type n) {
+            ThreadCachedPool::deallocate(p, n * sizeof(T));
+        }
+        size_type max_size() const {
+            return static_cast<size_type>(-1) / sizeof(T);
+        }
+        void construct(pointer p, const T& val) { new (static_cast<void*>(p)) T(val); }
+        void destroy(pointer p) { p->~T(); }
+    };
+
+    // void specialization so call_pool_allocator<void> can be handed to allocate_shared
+    template <>
+    class call_pool_allocator<void>
+    {
+    public:
+        typedef void value_type;
+        typedef void* pointer;
+        typedef const void* const_pointer;
+
+        template <typename U>
+        struct rebind { typedef call_pool_allocator<U> other; };
+
+        call_pool_allocator() {}
+        template <typename U>
+        call_pool_allocator(const call_pool_allocator<U>&) {}
+    };
+
+    template <typename T, typename U>
+    inline bool operator==(const call_pool_allocator<T>&, const call_pool_allocator<U>&) { return true; }
+    template <typename T, typename U>
+    inline bool operator!=(const call_pool_allocator<T>&, const call_pool_allocator<U>&) { return false; }
+} }
+
+#endif // H_FB_THREADCACHEDPOOL
+
@@ -0,0 +1,146 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <vector>
+#include <sstream>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "TraceEvents.h"
+
+volatile int FB::Trace::traceActive = 0;
+
+namespace {
+    using namespace FB;
+
+    // Each thread gets a fixed ring; once full the oldest events are overwritten,
+    // so a long session keeps the most recent window rather than growing unbounded
+    const size_t kBufferEvents = 16384;
+
+    struct TraceEvent {
+        char phase;
+        const char* category;   // string literal, never freed
+        const char* name;       // string literal, never freed
+        boost::uint64_t ts_us;  // microseconds since the trace epoch
+    };
+
+    struct ThreadBuffer {
+        ThreadBuffer(int tid) : tid(tid), next(0), total(0) { }
+        int tid;
+        size_t next;            // slot the next event goes into
+        boost::uint64_t total;  // events ever recorded; > kBufferEvents means wrapped
+        TraceEvent events[kBufferEvents];
+    };
+    typedef boost::shared_ptr<ThreadBuffer> ThreadBufferPtr;
+
+    // The registry owns the buffers so a thread exiting does not lose its events;
+    // the tss pointer is only a fast path to the calling thread's buffer
+    boost::mutex g_registryMutex;
+    std::vector<ThreadBufferPtr> g_buffers;
+    int g_nextTid = 1;
+    boost::posix_time::ptime g_epoch;
+    bool g_epochSet = false;
+
+    void nullCleanup(ThreadBuffer*) { /* owned by g_buffers */ }
+    boost::thread_specific_ptr<ThreadBuffer> g_threadBuffer(&nullCleanup);
+
+    ThreadBuffer* obtainBuffer()
+    {
+        ThreadBuffer* buf = g_threadBuffer.get();
+        if (!buf) {
+            boost::mutex::scoped_lock _l(g_registryMutex);
+            if (!g_epochSet) {
+                g_epoch = boost::posix_time::microsec_clock::universal_time();
+                g_epochSet = true;
+            }
+            ThreadBufferPtr newBuf(boost::make_shared<ThreadBuffer>(g_nextTid++));
+            g_buffers.push_back(newBuf);
+            buf = newBuf.get();
+            g_threadBuffer.reset(buf);
+        }
+        return buf;
+    }
+
+    boost::uint64_t nowMicros()
+    {
+        return static_cast<boost::uint64_t>(
+            (boost::posix_time::microsec_clock::universal_time() - g_epoch).total_microseconds());
+    }
+}
+
+void FB::Trace::setEnabled(bool enabled)
+{
+    {
+        boost::mutex::scoped_lock _l(g_registryMutex);
+        if (enabled && !g_epochSet) {
+            g_epoch = boost::posix_time::microsec_clock::universal_time();
+            g_epochSet = true;
+        }
+    }
+    traceActive = enabled ? 1 : 0;
+}
+
+void FB::Trace::record(char phase, const char* category, const char* name)
+{
+    ThreadBuffer* buf = obtainBuffer();
+    TraceEvent& e = buf->events[buf->next];
+    e.phase = phase;
+    e.category = category;
+    e.name = name;
+    e.ts_us = nowMicros();
+    buf->next = (buf->next + 1) % kBufferEvents;
+    ++buf->total;
+}
+
+void FB::Trace::clear()
+{
+    boost::mutex::scoped_lock _l(g_registryMutex);
+    for (size_t i = 0; i < g_buffers.size(); ++i) {
+        g_buffers[i]->next = 0;
+        g_buffers[i]->total = 0;
+    }
+}
+
+std::string FB::Trace::dumpJSON()
+{
+    // Meant to be called once collection is done; a thread recording while we read
+    // its ring can at worst produce one garbled event at the wrap point
+    std::ostringstream out;
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    boost::mutex::scoped_lock _l(g_registryMutex);
+    for (size_t i = 0; i < g_buffers.size(); ++i) {
+        const ThreadBuffer& buf = *g_buffers[i];
+        size_t count = buf.total < kBufferEvents ? static_cast<size_t>(buf.total) : kBufferEvents;
+        // oldest first: when wrapped, the slot about to be overwritten is the oldest
+        size_t start = buf.total < kBufferEvents ? 0 : buf.next;
+        for (size_t n = 0; n < count; ++n) {
+            const TraceEvent& e = buf.events[(start + n) % kBufferEvents];
+            if (!first)
+                out << ",";
+            first = false;
+            out << "{\"cat\":\"" << e.category << "\",\"name\":\"" << e.name
+                << "\",\"ph\":\"" << e.phase << "\",\"ts\":" << e.ts_us
+                << ",\"pid\":1,\"tid\":" << buf.tid << "}";
+        }
+    }
+    out << "]}";
+    return out.str();
+}
+
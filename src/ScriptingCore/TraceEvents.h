@@ -0,0 +1,139 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_TRACEEVENTS
+#define H_FB_TRACEEVENTS
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// Lightweight trace event layer producing chrome://tracing-compatible output.
+///
+/// Events are recorded into fixed-size per-thread ring buffers with no locking on the hot
+/// path; when tracing is disabled each macro costs a single load and branch.  Category and
+/// name arguments MUST be string literals (only the pointers are stored).  Collect a trace
+/// with FB::Trace::setEnabled(true), exercise the plugin, then load the string returned by
+/// FB::Trace::dumpJSON() in about:tracing (or chrome://tracing) to see the timeline of a
+/// bridge call from browser entry through dispatch to async completion.
+///
+/// @code
+/// void MyAPI::expensiveThing() {
+///     FBTRACE_SCOPE("MyPlugin", "expensiveThing");
+///     ...
+/// }
+/// @endcode
+///
+/// @since 1.7
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace FB { namespace Trace {
+
+    // Read directly by the macros so the disabled case is just a load and branch;
+    // treat as private, use setEnabled()/isEnabled()
+    extern volatile int traceActive;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn void setEnabled(bool enabled)
+    ///
+    /// @brief  Turns trace event collection on or off.  Off by default; existing events are kept
+    ///         when turning tracing off so they can still be dumped.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    void setEnabled(bool enabled);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn bool isEnabled()
+    ///
+    /// @brief  Returns true if trace events are currently being collected
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    inline bool isEnabled() { return traceActive != 0; }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn void record(char phase, const char* category, const char* name)
+    ///
+    /// @brief  Appends one event to the calling thread's ring buffer.  Use the FBTRACE_* macros
+    ///         rather than calling this directly; they skip the call entirely when tracing is off.
+    ///
+    /// @param  phase     trace event phase as used by chrome://tracing: 'B' (begin), 'E' (end),
+    ///                   'i' (instant)
+    /// @param  category  event category; must be a string literal
+    /// @param  name      event name; must be a string literal
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    void record(char phase, const char* category, const char* name);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn std::string dumpJSON()
+    ///
+    /// @brief  Serializes all buffered events from every thread into the chrome://tracing JSON
+    ///         trace format.  Each thread's buffer holds the most recent events; older ones are
+    ///         overwritten once the ring wraps.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::string dumpJSON();
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn void clear()
+    ///
+    /// @brief  Discards all buffered events on every thread
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    void clear();
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  ScopedEvent
+    ///
+    /// @brief  Emits a begin event on construction and the matching end event on destruction;
+    ///         used by FBTRACE_SCOPE.  If tracing is enabled mid-scope only the end is dropped,
+    ///         never an unmatched end emitted.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class ScopedEvent {
+    public:
+        ScopedEvent(const char* category, const char* name)
+            : m_category(category), m_name(name), m_armed(traceActive != 0)
+        {
+            if (m_armed)
+                record('B', m_category, m_name);
+        }
+        ~ScopedEvent()
+        {
+            if (m_armed)
+                record('E', m_category, m_name);
+        }
+    private:
+        const char* m_category;
+        const char* m_name;
+        bool m_armed;
+    };
+
+} }
+
+#define FBTRACE_TOKENPASTE2(x, y) x ## y
+#define FBTRACE_TOKENPASTE(x, y) FBTRACE_TOKENPASTE2(x, y)
+
+//! Records a complete duration event covering the rest of the enclosing scope
+#define FBTRACE_SCOPE(category, name) \
+    FB::Trace::ScopedEvent FBTRACE_TOKENPASTE(fbtrace_scope_, __LINE__)(category, name)
+
+//! Records the beginning of a duration event; pair with FBTRACE_END using the same name
+#define FBTRACE_BEGIN(category, name) \
+    do { if (FB::Trace::traceActive) FB::Trace::record('B', category, name); } while(0)
+
+//! Records the end of a duration event started with FBTRACE_BEGIN
+#define FBTRACE_END(category, name) \
+    do { if (FB::Trace::traceActive) FB::Trace::record('E', category, name); } while(0)
+
+//! Records an instantaneous event
+#define FBTRACE_INSTANT(category, name) \
+    do { if (FB::Trace::traceActive) FB::Trace::record('i', category, name); } while(0)
+
+#endif // H_FB_TRACEEVENTS
+
@@ -19,6 +19,9 @@ Copyright 2009 Richard Bateman, Firebreath development team
 #include <map>
 #include <vector>
 #include <string>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "APITypes.h"
 
@@ -28,6 +31,12 @@ namespace FB {
     /// @class  TypeIDMap
     ///
     /// @brief  Bidirectional map between an identifier and a variant
+    ///
+    /// Instances of this are shared process-wide (AxIdMap, the NPAPI host id mapper) and sit on
+    /// the object creation/release paths, so lookups vastly outnumber insertions.  The maps are
+    /// kept in an immutable snapshot published with an atomic shared_ptr store, the same
+    /// copy-on-write scheme JSAPIAuto uses for its member tables: readers resolve ids with no
+    /// locking at all, and only an insertion takes the writer mutex and republishes.
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     template <class IDTYPE>
     class TypeIDMap
@@ -65,36 +74,47 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         typedef std::map<FB::variant, IDTYPE, compare_variants> VariantIdMap;
 
+        // Immutable snapshot of both directions of the map
+        struct Data {
+            IdVariantMap idVariant;
+            VariantIdMap variantId;
+        };
+        typedef boost::shared_ptr<const Data> DataConstPtr;
+        typedef boost::shared_ptr<Data> DataPtr;
+
     public:
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn TypeIDMap::TypeIDMap(IDTYPE startValue)
         ///
-        /// @brief  Constructor. 
+        /// @brief  Constructor.
         ///
         /// @param  startValue  The value for the first ID to auto-assign
         ////////////////////////////////////////////////////////////////////////////////////////////////////
-        TypeIDMap(IDTYPE startValue) : nextId((unsigned long)startValue) { }
+        TypeIDMap(IDTYPE startValue) : m_data(boost::make_shared<Data>()), nextId((unsigned long)startValue) { }
         virtual ~TypeIDMap() { }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn void TypeIDMap::setIdForValue(IDTYPE idt, const variant& val)
         ///
-        /// @brief  Sets an identifier for value. 
+        /// @brief  Sets an identifier for value.
         ///
-        /// @exception  std::runtime_error  Thrown if the identifier is already mapped to something 
+        /// @exception  std::runtime_error  Thrown if the identifier is already mapped to something
         ///
-        /// @param  idt The identifier 
+        /// @param  idt The identifier
         /// @param  val The value
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         void setIdForValue(IDTYPE idt, const variant& val)
         {
-            if (m_idVariant.find(idt) != m_idVariant.end()
-                || m_variantId.find(val) != m_variantId.end()) {
+            boost::mutex::scoped_lock lock(m_writeMutex);
+            DataPtr data(copyData());
+            if (data->idVariant.find(idt) != data->idVariant.end()
+                || data->variantId.find(val) != data->variantId.end()) {
                 throw std::runtime_error("ID or value already defined");
             }
-            m_variantId[val] = idt;
-            m_idVariant[idt] = val;
+            data->variantId[val] = idt;
+            data->idVariant[idt] = val;
+            publishData(data);
         }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -103,22 +123,31 @@ namespace FB {
         /// @brief  Gets the identifier assigned to the given value; if none is yet assigned, assigns a
         ///         sequential identifier to the provided value
         ///
-        /// @param  val The value. 
+        /// @param  val The value.
         ///
-        /// @return The identifier assigned to value. 
+        /// @return The identifier assigned to value.
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         IDTYPE getIdForValue(const variant& val)
         {
-            typename VariantIdMap::iterator it = m_variantId.find(val);
-
-            if (it != m_variantId.end()) {
+            {
+                DataConstPtr data(loadData());
+                typename VariantIdMap::const_iterator it = data->variantId.find(val);
+                if (it != data->variantId.end()) {
+                    return it->second;
+                }
+            }
+            boost::mutex::scoped_lock lock(m_writeMutex);
+            // re-check: another thread may have assigned an id while we took the lock
+            DataPtr data(copyData());
+            typename VariantIdMap::const_iterator it = data->variantId.find(val);
+            if (it != data->variantId.end()) {
                 return it->second;
-            } else {
-                IDTYPE newId = (IDTYPE)nextId++;
-                m_variantId[val] = newId;
-                m_idVariant[newId] = val;
-                return newId;
             }
+            IDTYPE newId = (IDTYPE)nextId++;
+            data->variantId[val] = newId;
+            data->idVariant[newId] = val;
+            publishData(data);
+            return newId;
         }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -132,9 +161,10 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         const std::type_info& idGetType(IDTYPE idt)
         {
-            typename IdVariantMap::iterator it = m_idVariant.find(idt);
+            DataConstPtr data(loadData());
+            typename IdVariantMap::const_iterator it = data->idVariant.find(idt);
 
-            if (it != m_idVariant.end()) {
+            if (it != data->idVariant.end()) {
                 return it->second.get_type();
             } else {
                 return typeid(void);
@@ -144,37 +174,39 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn bool TypeIDMap::idExists(IDTYPE idt)
         ///
-        /// @brief  Queries if a given identifier has been assigned to anything. 
+        /// @brief  Queries if a given identifier has been assigned to anything.
         ///
-        /// @param  idt The identifier to check. 
+        /// @param  idt The identifier to check.
         ///
-        /// @return true if yes, false if no. 
+        /// @return true if yes, false if no.
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         bool idExists(IDTYPE idt)
         {
-            return m_idVariant.find(idt) != m_idVariant.end();
+            DataConstPtr data(loadData());
+            return data->idVariant.find(idt) != data->idVariant.end();
         }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn template <class T> bool TypeIDMap::idIsType(IDTYPE idt)
         ///
-        /// @brief  Queries if the provided identifier is assigned to a value of the given type 
+        /// @brief  Queries if the provided identifier is assigned to a value of the given type
         ///
         /// Example:
         /// @code
         ///      bool isStr = idMap.idIsType<std::string>(47);
         /// @endcode
-        /// 
-        /// @param  idt The identifier to check. 
         ///
-        /// @return true if it is the given type, false if it is not. 
+        /// @param  idt The identifier to check.
+        ///
+        /// @return true if it is the given type, false if it is not.
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         template <class T>
         bool idIsType(IDTYPE idt)
         {
-            typename IdVariantMap::iterator it = m_idVariant.find(idt);
+            DataConstPtr data(loadData());
+            typename IdVariantMap::const_iterator it = data->idVariant.find(idt);
 
-            if (it != m_idVariant.end()) {
+            if (it != data->idVariant.end()) {
                 return it->second.get_type() == typeid(T);
             } else {
                 return false;
@@ -184,21 +216,22 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn template <class T> T TypeIDMap::getValueForId(IDTYPE idt)
         ///
-        /// @brief  Gets the value assigned to the identifier. 
+        /// @brief  Gets the value assigned to the identifier.
         ///
         /// @exception  FB::bad_variant_cast    Thrown if the provided type is not valid for the value or if
         ///                                     the identifier is not assigned to anything.
         ///
-        /// @param  idt The identifier to check. 
+        /// @param  idt The identifier to check.
         ///
         /// @return The value of type T that the identifier is assigned to
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         template <class T>
         T getValueForId(IDTYPE idt)
         {
-            typename IdVariantMap::iterator it = m_idVariant.find(idt);
+            DataConstPtr data(loadData());
+            typename IdVariantMap::const_iterator it = data->idVariant.find(idt);
 
-            if (it != m_idVariant.end()) {
+            if (it != data->idVariant.end()) {
                 T retVal = (*it).second.template convert_cast<T>();
                 return retVal;
             } else {
@@ -207,13 +240,39 @@ namespace FB {
         }
 
     protected:
-        IdVariantMap m_idVariant;
-        VariantIdMap m_variantId;
-        unsigned long nextId;
+        // Returns the current snapshot without locking
+        DataConstPtr loadData() const
+        {
+#ifndef BOOST_SP_NO_ATOMIC_ACCESS
+            return boost::atomic_load(&m_data);
+#else
+            boost::mutex::scoped_lock lock(m_writeMutex);
+            return m_data;
+#endif
+        }
+
+        // Deep-copies the current snapshot for modification; call under m_writeMutex
+        DataPtr copyData() const
+        {
+            return DataPtr(new Data(*m_data));
+        }
+
+        // Atomically publishes a new snapshot; call under m_writeMutex
+        void publishData(const DataPtr& data)
+        {
+#ifndef BOOST_SP_NO_ATOMIC_ACCESS
+            boost::atomic_store(&m_data, DataConstPtr(data));
+#else
+            m_data = data;
+#endif
+        }
+
+        DataConstPtr m_data;
+        mutable boost::mutex m_writeMutex;
+        unsigned long nextId;               // guarded by m_writeMutex
 
     };
 
 };
 
 #endif // H_FB_STRINGIDMAP
-
@@ -20,8 +20,10 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/logic/tribool.hpp>
 #include <vector>
+#include <list>
 #include <sstream>
 #include <boost/asio.hpp>
+#include <boost/thread/mutex.hpp>
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
 #include "URI.h"
@@ -91,6 +93,35 @@ URI URI::fromString(const std::string& in_str) {
     return URI(in_str);
 }
 
+namespace {
+    // Small LRU of parsed URIs; the same page URL and stream URL get parsed
+    // over and over by SimpleStreamHelper and the proxy detector
+    const size_t k_URI_CACHE_MAX = 8;
+    typedef std::list<std::pair<std::string, FB::URI> > URICacheList;
+    boost::mutex uri_cache_mutex;
+    URICacheList uri_cache; // front is most recently used
+}
+
+URI URI::fromStringCached(const std::string& in_str) {
+    {
+        boost::mutex::scoped_lock _l(uri_cache_mutex);
+        for (URICacheList::iterator it = uri_cache.begin(); it != uri_cache.end(); ++it) {
+            if (it->first == in_str) {
+                uri_cache.splice(uri_cache.begin(), uri_cache, it);
+                return uri_cache.front().second;
+            }
+        }
+    }
+    URI parsed(in_str); // outside the lock; may throw, and failures aren't cached
+    {
+        boost::mutex::scoped_lock _l(uri_cache_mutex);
+        uri_cache.push_front(std::make_pair(in_str, parsed));
+        if (uri_cache.size() > k_URI_CACHE_MAX)
+            uri_cache.pop_back();
+    }
+    return parsed;
+}
+
 URI::URI(const std::string& in_str) : port(0) {
     string w = in_str;
 
@@ -228,6 +259,146 @@ void URI::parse_query_data(const std::string& in_str) {
     }
 }
 
+bool FB::URIView::parse(const std::string& str_uri) {
+    m_str = str_uri.c_str();
+    m_len = str_uri.size();
+    m_protocol = m_login = m_domain = m_path = m_query = m_fragment = Part();
+    m_port = 0;
+    m_implicitRootPath = false;
+    m_queryParsed = false;
+    m_queryData.clear();
+
+    size_t pos = 0;
+    size_t l = str_uri.find("://");
+    if (l != std::string::npos) {
+        m_protocol.off = 0;
+        m_protocol.len = l;
+        pos = l + 3;
+    }
+    // validate protocol -- should only contain [a-z0-9]
+    for (l = 0; l < m_protocol.len; ++l) {
+        if (!isalnum((unsigned char)m_str[l])) return false;
+    }
+
+    bool is_file = (m_protocol.len == 4
+                    && ::tolower(m_str[0]) == 'f' && ::tolower(m_str[1]) == 'i'
+                    && ::tolower(m_str[2]) == 'l' && ::tolower(m_str[3]) == 'e');
+    if (! is_file) { // file has neither a domain nor a port
+        size_t slash = str_uri.find_first_of("/\\", pos);
+        size_t dom_end = (slash == std::string::npos) ? m_len : slash;
+        size_t dom_start = pos;
+
+        // check for login info
+        size_t at = str_uri.find('@', dom_start);
+        if (at != std::string::npos && at < dom_end) {
+            m_login.off = dom_start;
+            m_login.len = at - dom_start;
+            dom_start = at + 1;
+        }
+
+        // split port, if it exists
+        size_t colon = str_uri.find(':', dom_start);
+        if (colon != std::string::npos && colon < dom_end) {
+            m_domain.off = dom_start;
+            m_domain.len = colon - dom_start;
+            unsigned long port_val = 0;
+            if (colon + 1 == dom_end) return false;
+            for (size_t i = colon + 1; i < dom_end; ++i) {
+                if (!isdigit((unsigned char)m_str[i])) return false;
+                port_val = port_val * 10 + (m_str[i] - '0');
+                if (port_val > 65535) return false;
+            }
+            m_port = (boost::uint16_t)port_val;
+        } else {
+            m_domain.off = dom_start;
+            m_domain.len = dom_end - dom_start;
+        }
+
+        if (slash == std::string::npos) {
+            m_implicitRootPath = true; // path() reports "/", as URI does
+            pos = m_len;
+        } else {
+            pos = slash;
+        }
+    }
+
+    size_t path_end = m_len;
+    l = str_uri.find('#', pos);
+    if (l != std::string::npos) {
+        m_fragment.off = l + 1;
+        m_fragment.len = m_len - (l + 1);
+        path_end = l;
+    }
+    l = str_uri.find('?', pos);
+    if (l != std::string::npos && l < path_end) {
+        m_query.off = l + 1;
+        m_query.len = path_end - (l + 1);
+        path_end = l;
+    }
+    m_path.off = pos;
+    m_path.len = path_end - pos;
+    return true;
+}
+
+std::string FB::URIView::protocol() const {
+    std::string res(str(m_protocol));
+    std::transform(res.begin(), res.end(), res.begin(), ::tolower);
+    return res;
+}
+
+std::string FB::URIView::domain() const {
+    std::string res(str(m_domain));
+    std::transform(res.begin(), res.end(), res.begin(), ::tolower);
+    return res;
+}
+
+std::string FB::URIView::path() const {
+    if (m_implicitRootPath && m_path.empty()) return "/";
+    return URI::url_decode(str(m_path));
+}
+
+const std::map<std::string, std::string>& FB::URIView::queryData() const {
+    if (! m_queryParsed) {
+        m_queryParsed = true;
+        // m_query.off is non-zero exactly when a '?' was seen; empty segments
+        // produce empty-key entries, just like the split() in parse_query_data
+        if (m_query.off) {
+            size_t pos = m_query.off;
+            const size_t end = m_query.off + m_query.len;
+            for (;;) {
+                size_t amp = pos;
+                while (amp < end && m_str[amp] != '&') ++amp;
+                size_t eq = pos;
+                while (eq < amp && m_str[eq] != '=') ++eq;
+                if (eq < amp) {
+                    // the value stops at a second '=', matching URI::parse_query_data
+                    size_t val_end = eq + 1;
+                    while (val_end < amp && m_str[val_end] != '=') ++val_end;
+                    m_queryData[URI::url_decode(std::string(m_str + pos, eq - pos))] =
+                        URI::url_decode(std::string(m_str + eq + 1, val_end - (eq + 1)));
+                } else {
+                    m_queryData[URI::url_decode(std::string(m_str + pos, amp - pos))] = std::string();
+                }
+                if (amp == end) break;
+                pos = amp + 1;
+            }
+        }
+    }
+    return m_queryData;
+}
+
+FB::URI FB::URIView::toURI() const {
+    URI res;
+    res.protocol = protocol();
+    res.login = login();
+    res.domain = domain();
+    res.port = port();
+    res.path = path();
+    res.fragment = fragment();
+    res.query_data = queryData();
+    return res;
+}
+
 std::string FB::URI::UrlDirectory() const
 {
 	std::stringstream res;
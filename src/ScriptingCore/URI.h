@@ -114,6 +114,20 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         static URI fromString(const std::string& in_str);
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn public static  FB::URI FB::URI::fromStringCached(const std::string& in_str)
+        ///
+        /// @brief  Returns a URI object from the given string, consulting a small LRU cache
+        ///
+        /// Components like SimpleStreamHelper and SystemProxyDetector parse the same URL
+        /// repeatedly; a cache hit copies the already-parsed object instead of re-running
+        /// the parser and url_decode.  Thread safe.
+        ///
+        /// @param  in_str  string to parse to create the new URI object
+        /// @returns FB::URI
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        static URI fromStringCached(const std::string& in_str);
+
         void addQueryData(const std::string& key, const std::string& val) {
             query_data[key] = val;
         }
@@ -206,6 +220,85 @@ namespace FB {
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         void parse_query_data(const std::string& in_str);
     };
+
+    //////////////////////////////////////////////////////////////////////////////
+    /// @class FB::URIView
+    ///
+    /// @brief  Non-owning parse of a URI string; components are offset/length
+    ///         views over the input
+    ///
+    /// Parsing allocates nothing: each component is recorded as an offset and
+    /// length into the original string, accessors materialize std::strings only
+    /// when asked, and the query-parameter map is built lazily on first use.
+    /// The string handed to parse() must outlive the view.
+    ///
+    /// @code
+    ///     FB::URIView v(url);
+    ///     if (v.domain() == "localhost" && v.port() == 8887) ...
+    /// @endcode
+    /// @see FB::URI
+    //////////////////////////////////////////////////////////////////////////////
+    class URIView {
+    public:
+        /// Offset/length of one component within the parsed string
+        struct Part {
+            Part() : off(0), len(0) {}
+            size_t off;
+            size_t len;
+            bool empty() const { return len == 0; }
+        };
+
+        URIView() : m_str(NULL), m_len(0), m_port(0), m_implicitRootPath(false), m_queryParsed(false) {}
+        /// Parses str_uri without copying it; the string must outlive the view
+        explicit URIView(const std::string& str_uri)
+            : m_str(NULL), m_len(0), m_port(0), m_implicitRootPath(false), m_queryParsed(false) {
+            parse(str_uri);
+        }
+
+        /// Re-points the view at str_uri; returns false if the URI is malformed
+        /// (invalid protocol characters or a non-numeric/out-of-range port)
+        bool parse(const std::string& str_uri);
+
+        // Raw component views over the original string; path and query are
+        // still urlencoded and the protocol/domain case is untouched
+        const Part& protocolPart() const { return m_protocol; }
+        const Part& loginPart() const    { return m_login; }
+        const Part& domainPart() const   { return m_domain; }
+        const Part& pathPart() const     { return m_path; }
+        const Part& queryPart() const    { return m_query; }
+        const Part& fragmentPart() const { return m_fragment; }
+
+        std::string protocol() const;   ///< lowercased, as URI stores it
+        std::string login() const       { return str(m_login); }
+        std::string domain() const;     ///< lowercased, as URI stores it
+        /// 0 indicates the default port for the protocol
+        boost::uint16_t port() const    { return m_port; }
+        std::string path() const;       ///< url_decoded; "/" when the URI has none
+        std::string fragment() const    { return str(m_fragment); }
+        /// Parses the query string into a map on first call and caches it
+        const std::map<std::string, std::string>& queryData() const;
+
+        /// Materializes a full, owning FB::URI from this view
+        URI toURI() const;
+
+    private:
+        std::string str(const Part& p) const {
+            return p.len ? std::string(m_str + p.off, p.len) : std::string();
+        }
+
+        const char* m_str;
+        size_t m_len;
+        Part m_protocol;
+        Part m_login;
+        Part m_domain;
+        Part m_path;
+        Part m_query;
+        Part m_fragment;
+        boost::uint16_t m_port;
+        bool m_implicitRootPath;
+        mutable bool m_queryParsed;
+        mutable std::map<std::string, std::string> m_queryData;
+    };
 };
 
 #endif // H_FB_URI
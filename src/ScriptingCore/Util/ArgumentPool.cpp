@@ -0,0 +1,70 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2012 Firebreath development team
+\**********************************************************/
+
+#include <vector>
+#include <boost/thread/tss.hpp>
+#include "ArgumentPool.h"
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+using namespace FB::detail;
+
+namespace
+{
+    // Each thread keeps a small stack of recycled argument vectors; nesting deeper than this
+    // (or leftover entries at thread exit) just falls back to plain new/delete
+    const size_t POOL_MAX_ENTRIES = 8;
+
+    typedef std::vector<FB::VariantList*> FreeList;
+
+    void cleanupFreeList(FreeList* lst)
+    {
+        for (FreeList::iterator it = lst->begin(); it != lst->end(); ++it)
+            delete *it;
+        delete lst;
+    }
+
+    boost::thread_specific_ptr<FreeList> s_freeList(&cleanupFreeList);
+
+    FreeList& getFreeList()
+    {
+        FreeList* lst = s_freeList.get();
+        if (!lst) {
+            lst = new FreeList();
+            s_freeList.reset(lst);
+        }
+        return *lst;
+    }
+}
+
+FB::VariantList* PooledArgumentList::acquire()
+{
+    FreeList& lst = getFreeList();
+    if (!lst.empty()) {
+        FB::VariantList* ret = lst.back();
+        lst.pop_back();
+        return ret;
+    }
+    return new FB::VariantList();
+}
+
+void PooledArgumentList::release(FB::VariantList* list)
+{
+    list->clear();
+    FreeList& lst = getFreeList();
+    if (lst.size() < POOL_MAX_ENTRIES) {
+        lst.push_back(list);
+    } else {
+        delete list;
+    }
+}
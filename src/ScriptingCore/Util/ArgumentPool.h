@@ -0,0 +1,60 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2012 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_ARGUMENTPOOL
+#define H_FB_ARGUMENTPOOL
+
+#include <boost/noncopyable.hpp>
+#include "APITypes.h"
+
+namespace FB
+{
+    namespace detail
+    {
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @class  PooledArgumentList
+        ///
+        /// @brief  RAII holder for a recycled FB::VariantList used on the scripting invoke hot path
+        ///
+        /// Every bridge call needs a scratch vector to marshal the script arguments into before
+        /// handing them to JSAPI::Invoke.  Instead of allocating a fresh std::vector<FB::variant>
+        /// each time, this draws one from a per-thread free list and returns it (cleared, capacity
+        /// intact) when it goes out of scope, so steady-state invocation does not allocate for
+        /// argument plumbing.  Usage:
+        /// @code
+        ///      FB::detail::PooledArgumentList vArgs;
+        ///      for (...) vArgs->push_back(...);
+        ///      api->Invoke(name, *vArgs);
+        /// @endcode
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        class PooledArgumentList : boost::noncopyable
+        {
+        public:
+            PooledArgumentList() : m_list(acquire()) {}
+            ~PooledArgumentList() { release(m_list); }
+
+            FB::VariantList& operator*() const { return *m_list; }
+            FB::VariantList* operator->() const { return m_list; }
+
+        private:
+            static FB::VariantList* acquire();
+            static void release(FB::VariantList* list);
+
+            FB::VariantList* m_list;
+        };
+    }
+}
+
+#endif // H_FB_ARGUMENTPOOL
@@ -0,0 +1,158 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#include <cctype>
+#include "precompiled_headers.h"
+
+#include "JSBinaryBuffer.h"
+
+namespace
+{
+    const char b64_charset[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    void b64_encode(const unsigned char* data, size_t len, std::string& out)
+    {
+        out.reserve(out.size() + ((len + 2) / 3) * 4);
+        size_t i = 0;
+        for (; i + 3 <= len; i += 3) {
+            unsigned int n = (data[i] << 16) | (data[i+1] << 8) | data[i+2];
+            out += b64_charset[(n >> 18) & 0x3f];
+            out += b64_charset[(n >> 12) & 0x3f];
+            out += b64_charset[(n >> 6) & 0x3f];
+            out += b64_charset[n & 0x3f];
+        }
+        if (i < len) {
+            unsigned int n = data[i] << 16;
+            if (i + 1 < len)
+                n |= data[i+1] << 8;
+            out += b64_charset[(n >> 18) & 0x3f];
+            out += b64_charset[(n >> 12) & 0x3f];
+            out += (i + 1 < len) ? b64_charset[(n >> 6) & 0x3f] : '=';
+            out += '=';
+        }
+    }
+
+    // Decodes onto the end of out; whitespace is skipped (some pages linewrap the
+    // string), anything else that isn't base64 throws
+    void b64_decode(const std::string& encoded, std::vector<unsigned char>& out)
+    {
+        static signed char dec_tbl[256];
+        static bool table_built = false;
+        if (!table_built) {
+            for (int c = 0; c < 256; ++c)
+                dec_tbl[c] = -1;
+            for (int s = 0; s < 64; ++s)
+                dec_tbl[static_cast<unsigned char>(b64_charset[s])] = static_cast<signed char>(s);
+            table_built = true;
+        }
+
+        out.reserve(out.size() + (encoded.size() / 4) * 3);
+        unsigned int quad = 0;
+        int have = 0;
+        for (size_t i = 0; i < encoded.size(); ++i) {
+            const unsigned char c = static_cast<unsigned char>(encoded[i]);
+            if (c == '=' || isspace(c))
+                continue;
+            const signed char s = dec_tbl[c];
+            if (s < 0)
+                throw FB::script_error("invalid base64 data");
+            quad = (quad << 6) | static_cast<unsigned int>(s);
+            if (++have == 4) {
+                out.push_back(static_cast<unsigned char>((quad >> 16) & 0xff));
+                out.push_back(static_cast<unsigned char>((quad >> 8) & 0xff));
+                out.push_back(static_cast<unsigned char>(quad & 0xff));
+                quad = 0;
+                have = 0;
+            }
+        }
+        // a trailing partial quad carries one (have == 2) or two (have == 3) bytes
+        if (have == 2)
+            out.push_back(static_cast<unsigned char>((quad >> 4) & 0xff));
+        else if (have == 3) {
+            out.push_back(static_cast<unsigned char>((quad >> 10) & 0xff));
+            out.push_back(static_cast<unsigned char>((quad >> 2) & 0xff));
+        } else if (have != 0)
+            throw FB::script_error("invalid base64 data");
+    }
+}
+
+FB::JSBinaryBuffer::JSBinaryBuffer()
+  : m_data()
+{
+    RegisterMethods();
+}
+
+FB::JSBinaryBuffer::JSBinaryBuffer(const std::vector<unsigned char>& data)
+  : m_data(data)
+{
+    RegisterMethods();
+}
+
+FB::JSBinaryBuffer::JSBinaryBuffer(const void* data, size_t len)
+  : m_data(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + len)
+{
+    RegisterMethods();
+}
+
+void FB::JSBinaryBuffer::RegisterMethods()
+{
+    registerProperty("length", make_property(this, &JSBinaryBuffer::GetLength));
+    registerMethod("toBase64", make_method(this, &JSBinaryBuffer::toBase64));
+    registerMethod("getBase64", make_method(this, &JSBinaryBuffer::getBase64));
+    registerMethod("fromBase64", make_method(this, &JSBinaryBuffer::fromBase64));
+    registerMethod("appendBase64", make_method(this, &JSBinaryBuffer::appendBase64));
+    registerMethod("clear", make_method(this, &JSBinaryBuffer::clear));
+}
+
+size_t FB::JSBinaryBuffer::GetLength() const
+{
+    return m_data.size();
+}
+
+std::string FB::JSBinaryBuffer::toBase64() const
+{
+    std::string out;
+    if (!m_data.empty())
+        b64_encode(&m_data[0], m_data.size(), out);
+    return out;
+}
+
+std::string FB::JSBinaryBuffer::getBase64(int offset, int length) const
+{
+    std::string out;
+    if (offset < 0 || length <= 0 || static_cast<size_t>(offset) >= m_data.size())
+        return out;
+    size_t count = static_cast<size_t>(length);
+    if (static_cast<size_t>(offset) + count > m_data.size())
+        count = m_data.size() - static_cast<size_t>(offset);
+    b64_encode(&m_data[offset], count, out);
+    return out;
+}
+
+void FB::JSBinaryBuffer::fromBase64(const std::string& encoded)
+{
+    std::vector<unsigned char> decoded;
+    b64_decode(encoded, decoded);
+    m_data.swap(decoded);
+}
+
+void FB::JSBinaryBuffer::appendBase64(const std::string& encoded)
+{
+    b64_decode(encoded, m_data);
+}
+
+void FB::JSBinaryBuffer::clear()
+{
+    std::vector<unsigned char>().swap(m_data);
+}
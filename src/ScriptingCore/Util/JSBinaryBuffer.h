@@ -0,0 +1,85 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_JSBINARYBUFFER
+#define H_JSBINARYBUFFER
+
+#include <string>
+#include <vector>
+#include "../JSAPIAuto.h"
+
+namespace FB
+{
+    FB_FORWARD_PTR(JSBinaryBuffer);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  JSBinaryBuffer
+    ///
+    /// @brief  Contiguous binary buffer shared between the page and native code
+    ///
+    /// Binary data has no direct representation in the variant bridge, so moving a file or a
+    /// block of media samples across it means one scripting round-trip per element.  A
+    /// JSBinaryBuffer keeps the bytes in a single std::vector on the plugin side and crosses
+    /// the bridge as one base64 string per transfer — O(1) bridge operations regardless of
+    /// payload size.  The page works with it like so:
+    ///
+    /// @code
+    /// var buf = plugin.readFile("/tmp/movie.bin");  // method returns JSBinaryBufferPtr
+    /// var data = buf.toBase64();                    // or buf.getBase64(ofs, len) in chunks
+    /// buf.fromBase64(encoded);                      // upload direction; appendBase64 to stream
+    /// @endcode
+    ///
+    /// Native code reads and writes the bytes directly through Data(); swap a vector into it
+    /// to adopt an existing buffer without copying.  Where the page has typed arrays, decoding
+    /// the base64 string into one is a single pass on the JS side; the bridge itself never
+    /// sees individual bytes either way.
+    ///
+    /// @since 1.7
+    /// @see BrowserStream
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class JSBinaryBuffer : public JSAPIAuto
+    {
+    public:
+        JSBinaryBuffer();
+        /// @brief  Copies the bytes into the buffer
+        explicit JSBinaryBuffer(const std::vector<unsigned char>& data);
+        /// @brief  Copies len bytes starting at data into the buffer
+        JSBinaryBuffer(const void* data, size_t len);
+
+        size_t GetLength() const;
+
+        /// @brief  The whole buffer as a base64 string; one bridge crossing
+        std::string toBase64() const;
+        /// @brief  A byte range [offset, offset + length) as base64; the range is clamped
+        ///         to the buffer, so chunked readers can just advance until empty
+        std::string getBase64(int offset, int length) const;
+        /// @brief  Replaces the buffer contents with the decoded bytes
+        void fromBase64(const std::string& encoded);
+        /// @brief  Appends the decoded bytes; lets the page stream uploads in chunks
+        void appendBase64(const std::string& encoded);
+        void clear();
+
+        /// @brief  The contiguous backing buffer; swap into it to adopt data without copying
+        std::vector<unsigned char>& Data() { return m_data; }
+        const std::vector<unsigned char>& Data() const { return m_data; }
+
+    private:
+        void RegisterMethods();
+
+        std::vector<unsigned char> m_data;
+    };
+}
+
+#endif // H_JSBINARYBUFFER
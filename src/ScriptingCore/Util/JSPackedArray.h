@@ -0,0 +1,117 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_JSPACKEDARRAY
+#define H_JSPACKEDARRAY
+
+#include <vector>
+#include "../JSObject.h"
+#include "../JSAPIAuto.h"
+
+namespace FB
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  JSPackedArray
+    ///
+    /// @brief  JSFakeArray for homogeneous numeric data, backed by a contiguous buffer
+    ///
+    /// JSFakeArray stores every element as an FB::variant, which for a 100k-sample waveform
+    /// means 100k boxed values before the page has read a single one.  JSPackedArray keeps the
+    /// elements in a plain std::vector<T> and boxes an element into a variant only when the
+    /// page actually indexes it, so construction is a bulk copy (or swap) of the raw buffer
+    /// and native code works on the contiguous data directly through Values().
+    ///
+    /// Use the JSDoubleArray / JSIntArray typedefs for the common cases:
+    /// @code
+    /// std::vector<double> samples = renderWaveform();
+    /// boost::shared_ptr<FB::JSDoubleArray> arr(boost::make_shared<FB::JSDoubleArray>());
+    /// arr->Values().swap(samples);     // no per-element work at all
+    /// return arr;
+    /// @endcode
+    ///
+    /// @since 1.7
+    /// @see JSFakeArray
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename T>
+    class JSPackedArray : public JSAPIAuto
+    {
+    public:
+        JSPackedArray()
+          : m_values()
+        {
+            RegisterMethods();
+        }
+
+        /// @brief  Copies the values into the packed buffer
+        explicit JSPackedArray(const std::vector<T>& values)
+          : m_values(values)
+        {
+            RegisterMethods();
+        }
+
+        /// @brief  Converts a Javascript array, storing each element unboxed as it arrives
+        explicit JSPackedArray(const FB::JSObjectPtr& obj)
+          : m_values()
+        {
+            if(!obj->HasProperty("length"))
+                throw FB::script_error("object does not have property length");
+
+            ExtractList(obj);
+            RegisterMethods();
+        }
+
+        FB::variant GetProperty(int index)
+        {
+            if (index < 0 || static_cast<size_t>(index) >= m_values.size())
+                return FB::variant();
+            return FB::variant(m_values[index]);
+        }
+        using FB::JSAPIAuto::GetProperty; // unhide GetProperty(std::string)
+        size_t GetLength() const
+        {
+            return m_values.size();
+        }
+
+        T& operator[](size_t index) { return m_values[index]; }
+        const T& operator[](size_t index) const { return m_values[index]; }
+
+        /// @brief  The contiguous backing buffer; swap into it to adopt data without copying
+        std::vector<T>& Values() { return m_values; }
+        const std::vector<T>& Values() const { return m_values; }
+
+    private:
+        void RegisterMethods()
+        {
+            registerProperty("length", make_property(this, &JSPackedArray::GetLength));
+        }
+        void ExtractList(const FB::JSObjectPtr& obj)
+        {
+            int length = obj->GetProperty("length").convert_cast<int>();
+            m_values.reserve(length > 0 ? length : 0);
+            for(int i = 0; i < length; ++i) {
+                m_values.push_back(obj->GetProperty(i).convert_cast<T>());
+            }
+        }
+
+        std::vector<T> m_values;
+    };
+
+    /// @brief  Packed array of doubles (any JS number fits)
+    typedef JSPackedArray<double> JSDoubleArray;
+    /// @brief  Packed array of ints
+    typedef JSPackedArray<int> JSIntArray;
+}
+
+#endif // H_JSPACKEDARRAY
@@ -0,0 +1,121 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <ctime>
+#include <string>
+#include <boost/thread/mutex.hpp>
+#include "precompiled_headers.h" // On windows, everything above this line in PCH
+
+#include "logging.h"
+
+// Per-source log level registry, shared by every logging backend.  Callsites cache the
+// threshold resolved for their source tagged with the registry generation; bumping the
+// generation on any change makes every cache refresh itself on its next hit, so the map
+// and its mutex are only touched when a cache is stale.
+
+namespace
+{
+    std::map<std::string, int> source_levels;
+    boost::mutex source_mutex;
+    // Starts at 1 so a zero-initialized callsite cache is always stale
+    volatile int source_generation = 1;
+
+    // Cache layout: generation in the high bits, threshold (0 = no override) in the low byte
+    const int kThresholdMask = 0xff;
+    const int kGenerationShift = 8;
+
+    // Rate limit shared by every callsite bucket; 0 = unlimited
+    volatile int rate_per_second = 0;
+    volatile int rate_burst = 0;
+
+    // Bucket layout: last-refill second (15 bits) in the high half, tokens in the
+    // low half.  Zero means "never used", which refills to a full burst.
+    const int kBucketTimeMask = 0x7fff;
+    const int kBucketTokenMask = 0xffff;
+    const int kBucketTimeShift = 16;
+}
+
+bool FB::Log::enabled(FB::Log::LogLevel level, const std::string& src, volatile int* srcCache)
+{
+    int generation = source_generation;
+    int cached = *srcCache;
+    if ((cached >> kGenerationShift) != generation) {
+        int threshold = 0;
+        {
+            boost::mutex::scoped_lock lock(source_mutex);
+            std::map<std::string, int>::const_iterator it = source_levels.find(src);
+            if (it != source_levels.end())
+                threshold = it->second;
+        }
+        cached = (generation << kGenerationShift) | threshold;
+        *srcCache = cached;  // races just re-resolve to the same value
+    }
+    int threshold = cached & kThresholdMask;
+    if (threshold)
+        return static_cast<int>(level) >= threshold;
+    return enabled(level);
+}
+
+void FB::Log::setLogRateLimit(unsigned int messagesPerSecond, unsigned int burst)
+{
+    rate_per_second = static_cast<int>(messagesPerSecond);
+    rate_burst = static_cast<int>(burst ? burst : messagesPerSecond);
+}
+
+bool FB::Log::rateAllow(volatile int* bucketState)
+{
+    int rate = rate_per_second;
+    if (rate <= 0)
+        return true;
+    int burst = rate_burst;
+    if (burst > kBucketTokenMask) burst = kBucketTokenMask;
+
+    int now = static_cast<int>(std::time(NULL)) & kBucketTimeMask;
+    int cached = *bucketState;
+    int last = (cached >> kBucketTimeShift) & kBucketTimeMask;
+    int tokens = cached & kBucketTokenMask;
+
+    if (cached == 0) {
+        // first hit on this callsite: start with a full bucket
+        tokens = burst;
+        last = now;
+    } else if (now != last) {
+        long refill = static_cast<long>(tokens)
+            + static_cast<long>((now - last) & kBucketTimeMask) * rate;
+        tokens = (refill > burst) ? burst : static_cast<int>(refill);
+        last = now;
+    }
+
+    if (tokens <= 0) {
+        *bucketState = (last << kBucketTimeShift);
+        return false;
+    }
+    --tokens;
+    *bucketState = (last << kBucketTimeShift) | tokens;  // races miscount by a message at most
+    return true;
+}
+
+void FB::Log::setLogSourceLevel(const std::string& src, FB::Log::LogLevel level)
+{
+    boost::mutex::scoped_lock lock(source_mutex);
+    source_levels[src] = level;
+    ++source_generation;
+}
+
+void FB::Log::clearLogSourceLevels()
+{
+    boost::mutex::scoped_lock lock(source_mutex);
+    source_levels.clear();
+    ++source_generation;
+}
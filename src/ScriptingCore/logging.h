@@ -18,6 +18,22 @@ Copyright 2010 Facebook, Inc
 
 #include <sstream>
 #include <list>
+#include <map>
+#include <cstddef>
+
+// Numeric levels for preprocessor comparison.  Define FB_LOG_MIN_LEVEL to one of these
+// in the project's config header (or compile flags) and every FBLOG_* macro below that
+// level compiles to nothing -- no branch, no formatting, no string literals in the binary.
+#define FBLOG_LEVEL_TRACE 1
+#define FBLOG_LEVEL_DEBUG 2
+#define FBLOG_LEVEL_INFO  3
+#define FBLOG_LEVEL_WARN  4
+#define FBLOG_LEVEL_ERROR 5
+#define FBLOG_LEVEL_FATAL 6
+
+#ifndef FB_LOG_MIN_LEVEL
+#  define FB_LOG_MIN_LEVEL FBLOG_LEVEL_TRACE
+#endif
 
 #if !FB_NO_LOGGING_MACROS
 #  if defined(__GNUC__)
@@ -27,27 +43,52 @@ Copyright 2010 Facebook, Inc
 #  else
 #    define FBLOG_FUNCTION() __func__
 #  endif
-#  define FBLOG_LOG_BODY(type, src, msg) \
+// The level check comes first so a disabled level costs one predictable branch; the
+// callsite-local cache holds this source's resolved threshold so the per-source lookup
+// happens once per callsite (and again only if the source levels change).  The
+// ostringstream and message formatting only happen when the message will be consumed.
+// The rate check runs before formatting, so a callsite firing thousands of times a
+// second costs a bucket decrement per suppressed call -- never the ostringstream.
+#  define FBLOG_LOG_BODY(type, level, src, msg) \
     do { \
+        static volatile int fblog_src_cache = 0; \
+        static volatile int fblog_rate_bucket = 0; \
+        if (!FB::Log::enabled(FB::Log:: level, src, &fblog_src_cache)) break; \
+        if (!FB::Log::rateAllow(&fblog_rate_bucket)) break; \
         std::ostringstream os; \
         os << msg; \
         FB::Log:: type (src, os.str(), __FILE__, __LINE__, FBLOG_FUNCTION()); \
     } while(0)
 #endif
 
-#if !FB_NO_LOGGING_MACROS
-#  define FBLOG_TRACE(src, msg) FBLOG_LOG_BODY(trace, src, msg)
-#  define FBLOG_DEBUG(src, msg) FBLOG_LOG_BODY(debug, src, msg)
-#  define FBLOG_INFO(src, msg) FBLOG_LOG_BODY(info, src, msg)
-#  define FBLOG_WARN(src, msg) FBLOG_LOG_BODY(warn, src, msg)
-#  define FBLOG_ERROR(src, msg) FBLOG_LOG_BODY(error, src, msg)
-#  define FBLOG_FATAL(src, msg) FBLOG_LOG_BODY(fatal, src, msg)
-#else 
-#  define FBLOG_TRACE(src, msg) 
+#if !FB_NO_LOGGING_MACROS && (FB_LOG_MIN_LEVEL <= FBLOG_LEVEL_TRACE)
+#  define FBLOG_TRACE(src, msg) FBLOG_LOG_BODY(trace, LogLevel_Trace, src, msg)
+#else
+#  define FBLOG_TRACE(src, msg)
+#endif
+#if !FB_NO_LOGGING_MACROS && (FB_LOG_MIN_LEVEL <= FBLOG_LEVEL_DEBUG)
+#  define FBLOG_DEBUG(src, msg) FBLOG_LOG_BODY(debug, LogLevel_Debug, src, msg)
+#else
 #  define FBLOG_DEBUG(src, msg)
+#endif
+#if !FB_NO_LOGGING_MACROS && (FB_LOG_MIN_LEVEL <= FBLOG_LEVEL_INFO)
+#  define FBLOG_INFO(src, msg) FBLOG_LOG_BODY(info, LogLevel_Info, src, msg)
+#else
 #  define FBLOG_INFO(src, msg)
+#endif
+#if !FB_NO_LOGGING_MACROS && (FB_LOG_MIN_LEVEL <= FBLOG_LEVEL_WARN)
+#  define FBLOG_WARN(src, msg) FBLOG_LOG_BODY(warn, LogLevel_Warn, src, msg)
+#else
 #  define FBLOG_WARN(src, msg)
+#endif
+#if !FB_NO_LOGGING_MACROS && (FB_LOG_MIN_LEVEL <= FBLOG_LEVEL_ERROR)
+#  define FBLOG_ERROR(src, msg) FBLOG_LOG_BODY(error, LogLevel_Error, src, msg)
+#else
 #  define FBLOG_ERROR(src, msg)
+#endif
+#if !FB_NO_LOGGING_MACROS && (FB_LOG_MIN_LEVEL <= FBLOG_LEVEL_FATAL)
+#  define FBLOG_FATAL(src, msg) FBLOG_LOG_BODY(fatal, LogLevel_Error, src, msg)
+#else
 #  define FBLOG_FATAL(src, msg)
 #endif
 
@@ -56,6 +97,27 @@ namespace FB { namespace Log {
     void initLogging();
     void stopLogging();
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Switches the logging backend to asynchronous delivery
+    ///
+    /// Producers append records to a fixed-capacity ring and return
+    /// immediately; a dedicated drain thread formats and writes them, so a
+    /// burst of logging never stalls the calling thread on disk or console
+    /// I/O.  When the ring is full the oldest record is dropped and counted,
+    /// and a "dropped N log records" line is emitted once the drain catches
+    /// up -- logging can lose messages under pressure but can never block
+    /// the plugin.  The null logging backend ignores this.
+    ///
+    /// @param capacity  how many records the ring holds; 0 picks the default
+    //////////////////////////////////////////////////////////////////////////
+    void enableAsyncLogging(std::size_t capacity = 0);
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Drains outstanding async records, stops the drain thread, and
+    ///        returns to synchronous logging
+    //////////////////////////////////////////////////////////////////////////
+    void disableAsyncLogging();
+
     void trace(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
     void debug(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
     void  info(const std::string& src, const std::string& msg, const char *file, int line, const char *fn);
@@ -79,6 +141,67 @@ namespace FB { namespace Log {
         LogLevel_Error  = 0x10
     };
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Returns true if messages of the given level are currently consumed
+    ///
+    /// Used by the FBLOG_* macros to skip message formatting entirely when the
+    /// level is disabled.  The null logger always answers false; the log4cplus
+    /// backend compares against the level chosen when logging was initialized.
+    //////////////////////////////////////////////////////////////////////////
+    bool enabled(LogLevel level);
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Per-source variant of enabled(), used by the FBLOG_* macros
+    ///
+    /// srcCache points at a callsite-local static holding the threshold
+    /// resolved for this source; the registry is only consulted when the
+    /// cache is stale (first call, or after the source levels change), so a
+    /// disabled callsite costs a load and a compare.  Sources without an
+    /// override fall back to the backend's global level.
+    //////////////////////////////////////////////////////////////////////////
+    bool enabled(LogLevel level, const std::string& src, volatile int* srcCache);
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Caps how often any one callsite may emit, process-wide
+    ///
+    /// messagesPerSecond is the sustained rate each FBLOG_* callsite may
+    /// log at; burst is how many messages a quiet callsite may emit at once
+    /// before the rate applies (0 picks messagesPerSecond).  0 messages per
+    /// second disables limiting, which is the default.  Suppressed calls are
+    /// dropped before the message is even formatted, so a misbehaving page
+    /// hammering one warning costs a bucket check per call and nothing more.
+    /// FactoryBase::getLogRateLimit seeds this when logging is initialized.
+    /// @since 1.7
+    //////////////////////////////////////////////////////////////////////////
+    void setLogRateLimit(unsigned int messagesPerSecond, unsigned int burst = 0);
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Token bucket check used by the FBLOG_* macros
+    ///
+    /// bucketState points at a callsite-local static packing the bucket's
+    /// token count and last-refill second; returns true when this call may
+    /// log.  Races on the state just over- or under-count by a message.
+    /// @since 1.7
+    //////////////////////////////////////////////////////////////////////////
+    bool rateAllow(volatile int* bucketState);
+
+    /// @brief Maps log source names (the first FBLOG_* argument) to levels
+    typedef std::map<std::string, LogLevel> LogSourceLevelMap;
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Overrides the log level for one source at runtime
+    ///
+    /// Lets one subsystem (say "NpapiStream") run at trace while the rest of
+    /// the plugin stays at warn.  Callsite caches are refreshed lazily on
+    /// their next hit.  FactoryBase::getLogSourceLevels seeds these overrides
+    /// when logging is initialized.
+    //////////////////////////////////////////////////////////////////////////
+    void setLogSourceLevel(const std::string& src, LogLevel level);
+
+    /// @brief Removes all per-source overrides; every source follows the
+    ///        global level again
+    void clearLogSourceLevels();
+
     //////////////////////////////////////////////////////////////////////////
     /// @enum FB::Log::LogMethod
     /// 
@@ -92,7 +215,10 @@ namespace FB { namespace Log {
         // Enable Console-mode logging (Debug console on windows, system console on other)
         LogMethod_Console  = 0x01,
         // Enable logging to a file - filename must be specified
-        LogMethod_File  = 0x02
+        LogMethod_File  = 0x02,
+        // Enable the binary structured log stream - filename must be specified.
+        // See BinaryLog.h; records are written raw and formatted offline
+        LogMethod_Binary  = 0x04
     };
 
     //////////////////////////////////////////////////////////////////////////    
@@ -28,34 +28,104 @@ Copyright 2009 Dan Weatherford, Facebook inc
 #include "precompiled_headers.h" // On windows, everything above this line in PCH
 
 #include <limits.h>
+#include <string.h>
 #include <boost/algorithm/string/case_conv.hpp>
 
 #include "utf8_tools.h"
 
+namespace {
+
+    // Length of the leading all-ASCII run, scanned a machine word at a time.
+    // No multi-byte UTF-8 sequence (or surrogate) can begin inside an ASCII
+    // run, so the prefix converts by plain widening/narrowing and only the
+    // remainder needs the full validate-and-convert machinery.
+    size_t ascii_span(const char* data, size_t len) {
+        size_t pos = 0;
+        size_t word;
+        const size_t high_bits = static_cast<size_t>(0x8080808080808080LL);
+        while (pos + sizeof(word) <= len) {
+            memcpy(&word, data + pos, sizeof(word));
+            if (word & high_bits)
+                break;
+            pos += sizeof(word);
+        }
+        while (pos < len && !(static_cast<unsigned char>(data[pos]) & 0x80))
+            ++pos;
+        return pos;
+    }
+
+    size_t ascii_span(const wchar_t* data, size_t len) {
+        size_t pos = 0;
+        while (pos + 4 <= len) {
+            if ((data[pos] | data[pos+1] | data[pos+2] | data[pos+3]) & ~0x7F)
+                break;
+            pos += 4;
+        }
+        while (pos < len && !(data[pos] & ~0x7F))
+            ++pos;
+        return pos;
+    }
+
+};
+
 namespace FB {
 
-    std::string wstring_to_utf8(const std::wstring& src) {
-        std::string out_str;
-        std::wstring in_str;
-        utf8::replace_invalid(src.begin(), src.end(), std::back_inserter(in_str));
+    std::string& wstring_to_utf8(const std::wstring& src, std::string& dest) {
+        dest.clear();
+        const size_t len = src.size();
+        dest.reserve(len);
+        const size_t ascii = len ? ascii_span(src.data(), len) : 0;
+        if (ascii) {
+            dest.resize(ascii);
+            for (size_t i = 0; i < ascii; ++i)
+                dest[i] = static_cast<char>(src[i]);
+        }
+        if (ascii < len) {
+            std::wstring in_str;
+            utf8::replace_invalid(src.begin() + ascii, src.end(), std::back_inserter(in_str));
 #ifdef _WIN32
-        utf8::utf16to8(in_str.begin(), in_str.end(), std::back_inserter(out_str));
+            utf8::utf16to8(in_str.begin(), in_str.end(), std::back_inserter(dest));
 #else
-        utf8::utf32to8(in_str.begin(), in_str.end(), std::back_inserter(out_str));
+            utf8::utf32to8(in_str.begin(), in_str.end(), std::back_inserter(dest));
 #endif
+        }
+        return dest;
+    }
+
+
+    std::string wstring_to_utf8(const std::wstring& src) {
+        std::string out_str;
+        wstring_to_utf8(src, out_str);
         return out_str;
     }
 
 
-    std::wstring utf8_to_wstring(const std::string& src) {
-        std::wstring out_str;
-        std::string in_str;
-        utf8::replace_invalid(src.begin(), src.end(), std::back_inserter(in_str));
+    std::wstring& utf8_to_wstring(const std::string& src, std::wstring& dest) {
+        dest.clear();
+        const size_t len = src.size();
+        dest.reserve(len);
+        const size_t ascii = len ? ascii_span(src.data(), len) : 0;
+        if (ascii) {
+            dest.resize(ascii);
+            for (size_t i = 0; i < ascii; ++i)
+                dest[i] = static_cast<wchar_t>(static_cast<unsigned char>(src[i]));
+        }
+        if (ascii < len) {
+            std::string in_str;
+            utf8::replace_invalid(src.begin() + ascii, src.end(), std::back_inserter(in_str));
 #ifdef _WIN32
-        utf8::utf8to16(in_str.begin(), in_str.end(), std::back_inserter(out_str));
+            utf8::utf8to16(in_str.begin(), in_str.end(), std::back_inserter(dest));
 #else
-        utf8::utf8to32(in_str.begin(), in_str.end(), std::back_inserter(out_str));
+            utf8::utf8to32(in_str.begin(), in_str.end(), std::back_inserter(dest));
 #endif
+        }
+        return dest;
+    }
+
+
+    std::wstring utf8_to_wstring(const std::string& src) {
+        std::wstring out_str;
+        utf8_to_wstring(src, out_str);
         return out_str;
     }
 
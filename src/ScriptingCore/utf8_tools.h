@@ -33,6 +33,19 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     std::string wstring_to_utf8(const std::wstring& src);
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn std::string& wstring_to_utf8(const std::wstring& src, std::string& dest)
+    ///
+    /// @brief  Converts a std::wstring to UTF8 into a caller-supplied string, avoiding the
+    ///         return-value allocation when the destination's capacity can be reused
+    ///
+    /// @param  src  Source string
+    /// @param  dest Receives the UTF8-encoded result; previous contents are replaced
+    ///
+    /// @return Reference to dest
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::string& wstring_to_utf8(const std::wstring& src, std::string& dest);
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @fn std::wstring utf8_to_wstring(const std::string& src)
     ///
@@ -44,6 +57,20 @@ namespace FB {
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     std::wstring utf8_to_wstring(const std::string& src);
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @fn std::wstring& utf8_to_wstring(const std::string& src, std::wstring& dest)
+    ///
+    /// @brief  Converts a UTF8-encoded std::string to a std::wstring in a caller-supplied
+    ///         string, avoiding the return-value allocation when the destination's capacity
+    ///         can be reused
+    ///
+    /// @param  src  Source string
+    /// @param  dest Receives the wide result; previous contents are replaced
+    ///
+    /// @return Reference to dest
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::wstring& utf8_to_wstring(const std::string& src, std::wstring& dest);
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     /// @fn std::wstring wstring_tolower(const std::wstring& src)
     ///
@@ -17,7 +17,6 @@ Copyright 2008-2012 Richard Bateman, Firebreath development team
 //#define ANY_IMPLICIT_CASTING    // added to enable implicit casting
 
 #include <boost/cstdint.hpp>
-#include <boost/any.hpp>
 #include <stdexcept>
 #include <typeinfo>
 #include <algorithm>
@@ -44,6 +43,7 @@ Copyright 2008-2012 Richard Bateman, Firebreath development team
 
 #include "APITypes.h"
 #include "Util/meta_util.h"
+#include "variant_storage.h"
 #include "utf8_tools.h"
 #include "variant_conversions.h"
 
@@ -52,74 +52,6 @@ Copyright 2008-2012 Richard Bateman, Firebreath development team
 #pragma warning( disable : 4800 )
 #endif
 
-#define FB_BEGIN_CONVERT_MAP(_type_) \
-    const std::type_info *type(&var.get_type()); \
-    if (*type == typeid(_type_)) { \
-    return var.cast< _type_ >(); \
-    } else
-
-#define FB_END_CONVERT_MAP(_type_) { throw bad_variant_cast(var.get_type(), typeid(_type_)); }
-#define FB_END_CONVERT_MAP_NO_THROW(_type_) {}
-
-#define FB_CONVERT_ENTRY_SIMPLE(_type_, _srctype_)             \
-    if ( *type == typeid( _srctype_ ) ) {              \
-    return static_cast< _type_ >( var.cast< _srctype_ >() );\
-    } else
-
-#define FB_CONVERT_ENTRY_COMPLEX_BEGIN(_srctype_, _var_) \
-    if (*type == typeid(_srctype_)) { \
-    _srctype_ _var_ = var.cast<_srctype_>();
-
-#define FB_CONVERT_ENTRY_COMPLEX_END() \
-    } else
-
-#define FB_CONVERT_ENTRY_NUMERIC(_type_, _srctype_) \
-    if (*type == typeid(_srctype_)) { \
-        try { \
-            return boost::numeric_cast<_type_>(var.cast<_srctype_>());\
-        } catch (const boost::numeric::bad_numeric_cast& ) { \
-            throw bad_variant_cast(var.get_type(), typeid(_type_)); \
-        } \
-    } else
-
-#define FB_CONVERT_ENTRY_FROM_WSTRING(_type_, _srctype_) \
-    if (*type == typeid(_srctype_)) { \
-        std::string __tmp = FB::wstring_to_utf8(var.cast<_srctype_>()); \
-        std::istringstream iss(__tmp); \
-        _type_ to; \
-        if (iss >> to) { \
-            return to; \
-        } else { \
-            throw bad_variant_cast(var.get_type(), typeid(_type_)); \
-        } \
-    } else
-
-#define FB_CONVERT_ENTRY_FROM_STRING(_type_, _srctype_) \
-    if (*type == typeid(_srctype_)) { \
-        typedef _srctype_::value_type char_type; \
-        std::basic_istringstream<char_type> iss(var.cast<_srctype_>()); \
-        _type_ to; \
-        if (iss >> to) { \
-            return to; \
-        } else { \
-            throw bad_variant_cast(var.get_type(), typeid(_type_)); \
-        } \
-    } else
-
-#define FB_CONVERT_ENTRY_FROM_STRING_TYPE(_type_, _srctype_) \
-    if (*type == typeid(_srctype_)) { \
-        typedef _type_::value_type char_type; \
-        std::basic_ostringstream<char_type> oss; \
-        if (oss << var.cast<_srctype_>()) { \
-            return oss.str(); \
-        } else { \
-            throw bad_variant_cast(var.get_type(), typeid(_type_)); \
-        } \
-    } else
-
-#define FB_CONVERT_ENTRY_TO_STRING(_srctype_)  FB_CONVERT_ENTRY_FROM_STRING_TYPE(std::string , _srctype_)
-#define FB_CONVERT_ENTRY_TO_WSTRING(_srctype_) FB_CONVERT_ENTRY_FROM_STRING_TYPE(std::wstring, _srctype_)
-
 namespace FB
 {
     class JSObject;
@@ -156,8 +88,9 @@ namespace FB
 
         template<typename T>
         struct lessthan {
-            static bool impl(const boost::any& l, const boost::any& r) {
-                return boost::any_cast<T>(l) < boost::any_cast<T>(r);
+            static bool impl(const storage& l, const storage& r) {
+                // impl is only installed for the exact stored type, so the pointers are valid
+                return *l.cast_ptr<T>() < *r.cast_ptr<T>();
             }
         };
     } // namespace variant_detail
@@ -224,6 +157,49 @@ namespace FB
             : lessthan(&FB::variant::lessthan_default) {
         }
 
+        variant(const variant& rhs)
+            : object(rhs.object), lessthan(rhs.lessthan) {
+        }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn variant::variant(variant&& rhs)
+        ///
+        /// @brief  Move constructor; steals the stored value from rhs and leaves it empty.  Only
+        ///         available when the compiler supports rvalue references
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        variant(variant&& rhs)
+            : lessthan(rhs.lessthan) {
+            object.take(rhs.object);
+            rhs.lessthan = &FB::variant::lessthan_default;
+        }
+
+        variant& operator=(variant&& rhs) {
+            object.take(rhs.object);
+            lessthan = rhs.lessthan;
+            rhs.lessthan = &FB::variant::lessthan_default;
+            return *this;
+        }
+
+        // rvalue construction for the string and container types that dominate bridge traffic;
+        // the value is moved into the variant storage instead of copied
+        variant(std::string&& x) { assign_moved(std::move(x)); }
+        variant(std::wstring&& x) { assign_moved(std::move(x)); }
+        variant(std::vector<variant>&& x) { assign_moved(std::move(x)); }
+        variant(std::map<std::string, variant>&& x) { assign_moved(std::move(x)); }
+
+        template <typename T>
+        variant& assign_moved(T&& x) {
+            object.assign_moved(std::move(x));
+            lessthan = &FB::variant_detail::lessthan<T>::impl;
+            return *this;
+        }
+#endif
+
+        variant& operator=(const variant& rhs) {
+            return assign(rhs);
+        }
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn variant& variant::assign(const variant& x)
         ///
@@ -308,6 +284,16 @@ namespace FB
             return object.type();
         }
 
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn variant_detail::builtin_tag variant::get_type_tag() const
+        ///
+        /// @brief  Gets the dense type index of the stored value; used by the conversion engine to
+        ///         dispatch with a single switch instead of a typeid comparison chain
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        variant_detail::builtin_tag get_type_tag() const {
+            return object.type_tag();
+        }
+
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         /// @fn template<typename T> bool variant::is_of_type() const
         ///
@@ -368,10 +354,11 @@ namespace FB
         ////////////////////////////////////////////////////////////////////////////////////////////////////
         template<typename T>
         T cast() const {
-            if (get_type() != typeid(T)) {
+            const T* ptr = object.cast_ptr<T>();
+            if (!ptr) {
                 throw bad_variant_cast(get_type(), typeid(T));
             }
-            return boost::any_cast<T>(object);
+            return *ptr;
         }
 
         ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -423,78 +410,120 @@ namespace FB
             return cast<T>();
         }
 
-        static bool lessthan_default(const boost::any& l, const boost::any& r) {
+        static bool lessthan_default(const variant_detail::storage& l, const variant_detail::storage& r) {
             return false;
         }
 
         // fields
-        boost::any object;
-        bool (*lessthan)(const boost::any&, const boost::any&);
+        variant_detail::storage object;
+        bool (*lessthan)(const variant_detail::storage&, const variant_detail::storage&);
     };
 
+    namespace variant_detail {
+        ///////////////////////////////////////////////////
+        // conversion kernels used by the tag-dispatched
+        // convert_cast engine below; each one reports
+        // failure as bad_variant_cast like the old
+        // FB_CONVERT_ENTRY_* macros did
+        ///////////////////////////////////////////////////
+
+        // numeric -> numeric with range checking
+        template <typename To, typename From>
+        inline To checked_numeric_convert(const variant& var) {
+            try {
+                return boost::numeric_cast<To>(var.cast<From>());
+            } catch (const boost::numeric::bad_numeric_cast&) {
+                throw bad_variant_cast(var.get_type(), typeid(To));
+            }
+        }
+
+        // string -> numeric; parses in place with no stream or heap allocation
+        template <typename To>
+        inline To parse_numeric(const std::string& str, const variant& var) {
+            To to;
+            if (number_codec<To>::parse(str.c_str(), to)) {
+                return to;
+            }
+            throw bad_variant_cast(var.get_type(), typeid(To));
+        }
+
+        // numeric -> string/wstring; formats into a stack buffer, the only
+        // allocation left is the returned string itself
+        template <typename CharT, typename From>
+        inline std::basic_string<CharT> format_numeric(const variant& var) {
+            char buf[64];
+            const int len = number_codec<From>::format(buf, sizeof(buf), var.cast<From>());
+            if (len > 0 && len < static_cast<int>(sizeof(buf))) {
+                return std::basic_string<CharT>(buf, buf + len);
+            }
+            throw bad_variant_cast(var.get_type(), typeid(std::basic_string<CharT>));
+        }
+    } // namespace variant_detail
+
     template <>
     inline const std::string variant::convert_cast<std::string>() const {
-        variant var = *this;
-        FB_BEGIN_CONVERT_MAP(std::string);
-        FB_CONVERT_ENTRY_TO_STRING(double);
-        FB_CONVERT_ENTRY_TO_STRING(float);
-        FB_CONVERT_ENTRY_TO_STRING(int);
-        FB_CONVERT_ENTRY_TO_STRING(unsigned int);
-        FB_CONVERT_ENTRY_COMPLEX_BEGIN(bool, bval);
-        return bval ? "true" : "false";
-        FB_CONVERT_ENTRY_COMPLEX_END();
-        FB_CONVERT_ENTRY_COMPLEX_BEGIN(std::wstring, str);
-        return wstring_to_utf8(str);
-        FB_CONVERT_ENTRY_COMPLEX_END();
-        FB_CONVERT_ENTRY_TO_STRING(long);
-        FB_CONVERT_ENTRY_TO_STRING(unsigned long);
-        FB_CONVERT_ENTRY_TO_STRING(short);
-        FB_CONVERT_ENTRY_TO_STRING(unsigned short);
-        FB_CONVERT_ENTRY_TO_STRING(char);
-        FB_CONVERT_ENTRY_TO_STRING(unsigned char);
-        FB_CONVERT_ENTRY_TO_STRING(boost::int64_t);
-        FB_CONVERT_ENTRY_TO_STRING(boost::uint64_t);
-        FB_END_CONVERT_MAP(std::string);
+        using namespace variant_detail;
+        switch (get_type_tag()) {
+            case tag_string:    return cast<std::string>();
+            case tag_wstring:   return wstring_to_utf8(cast<std::wstring>());
+            case tag_bool:      return cast<bool>() ? "true" : "false";
+            case tag_char:      return format_numeric<char, char>(*this);
+            case tag_uchar:     return format_numeric<char, unsigned char>(*this);
+            case tag_short:     return format_numeric<char, short>(*this);
+            case tag_ushort:    return format_numeric<char, unsigned short>(*this);
+            case tag_int:       return format_numeric<char, int>(*this);
+            case tag_uint:      return format_numeric<char, unsigned int>(*this);
+            case tag_long:      return format_numeric<char, long>(*this);
+            case tag_ulong:     return format_numeric<char, unsigned long>(*this);
+            case tag_longlong:  return format_numeric<char, long long>(*this);
+            case tag_ulonglong: return format_numeric<char, unsigned long long>(*this);
+            case tag_float:     return format_numeric<char, float>(*this);
+            case tag_double:    return format_numeric<char, double>(*this);
+            default:            throw bad_variant_cast(get_type(), typeid(std::string));
+        }
     }
 
     template<>
     inline const std::wstring variant::convert_cast<std::wstring>() const {
-        variant var = *this;
-        FB_BEGIN_CONVERT_MAP(std::wstring);
-        FB_CONVERT_ENTRY_TO_WSTRING(double);
-        FB_CONVERT_ENTRY_TO_WSTRING(float);
-        FB_CONVERT_ENTRY_TO_WSTRING(int);
-        FB_CONVERT_ENTRY_TO_WSTRING(unsigned int);
-        FB_CONVERT_ENTRY_COMPLEX_BEGIN(bool, bval);
-        return bval ? L"true" : L"false";
-        FB_CONVERT_ENTRY_COMPLEX_END();
-        FB_CONVERT_ENTRY_COMPLEX_BEGIN(std::string, str);
-        return utf8_to_wstring(str);
-        FB_CONVERT_ENTRY_COMPLEX_END();
-        FB_CONVERT_ENTRY_TO_WSTRING(long);
-        FB_CONVERT_ENTRY_TO_WSTRING(unsigned long);
-        FB_CONVERT_ENTRY_TO_WSTRING(short);
-        FB_CONVERT_ENTRY_TO_WSTRING(unsigned short);
-        FB_CONVERT_ENTRY_TO_WSTRING(char);
-        FB_CONVERT_ENTRY_TO_WSTRING(unsigned char);
-        FB_END_CONVERT_MAP(std::wstring);
+        using namespace variant_detail;
+        switch (get_type_tag()) {
+            case tag_wstring:   return cast<std::wstring>();
+            case tag_string:    return utf8_to_wstring(cast<std::string>());
+            case tag_bool:      return cast<bool>() ? L"true" : L"false";
+            case tag_char:      return format_numeric<wchar_t, char>(*this);
+            case tag_uchar:     return format_numeric<wchar_t, unsigned char>(*this);
+            case tag_short:     return format_numeric<wchar_t, short>(*this);
+            case tag_ushort:    return format_numeric<wchar_t, unsigned short>(*this);
+            case tag_int:       return format_numeric<wchar_t, int>(*this);
+            case tag_uint:      return format_numeric<wchar_t, unsigned int>(*this);
+            case tag_long:      return format_numeric<wchar_t, long>(*this);
+            case tag_ulong:     return format_numeric<wchar_t, unsigned long>(*this);
+            case tag_longlong:  return format_numeric<wchar_t, long long>(*this);
+            case tag_ulonglong: return format_numeric<wchar_t, unsigned long long>(*this);
+            case tag_float:     return format_numeric<wchar_t, float>(*this);
+            case tag_double:    return format_numeric<wchar_t, double>(*this);
+            default:            throw bad_variant_cast(get_type(), typeid(std::wstring));
+        }
     }
-    
+
     template<>
     inline const bool variant::convert_cast<bool>() const {
-        variant var = *this;
-        FB_BEGIN_CONVERT_MAP(bool);
-        FB_CONVERT_ENTRY_COMPLEX_BEGIN(std::string, str);
-        std::transform(str.begin(), str.end(), str.begin(), ::tolower); 
-        return (str == "y" || str == "1" || str == "yes" || str == "true" || str == "t");
-        FB_CONVERT_ENTRY_COMPLEX_END();
-        FB_CONVERT_ENTRY_COMPLEX_BEGIN(std::wstring, str);
-        std::transform(str.begin(), str.end(), str.begin(), ::tolower); 
-        return (str == L"y" || str == L"1" || str == L"yes" || str == L"true" || str == L"t");
-        FB_CONVERT_ENTRY_COMPLEX_END();
-        FB_END_CONVERT_MAP_NO_THROW(short);
-        
-        return convert_cast<long>();
+        using namespace variant_detail;
+        switch (get_type_tag()) {
+            case tag_bool: return cast<bool>();
+            case tag_string: {
+                std::string str(cast<std::string>());
+                std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+                return (str == "y" || str == "1" || str == "yes" || str == "true" || str == "t");
+            }
+            case tag_wstring: {
+                std::wstring str(cast<std::wstring>());
+                std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+                return (str == L"y" || str == L"1" || str == L"yes" || str == L"true" || str == L"t");
+            }
+            default:
+                return convert_cast<long>() ? true : false;
+        }
     }
 
     namespace variant_detail {
@@ -640,26 +669,30 @@ namespace FB
             template<typename T>
             typename FB::meta::enable_for_numbers<T, T>::type
             convert_variant(const variant& var, const type_spec<T>&) {
-                FB_BEGIN_CONVERT_MAP(T)
-                FB_CONVERT_ENTRY_NUMERIC(T, char)
-                FB_CONVERT_ENTRY_NUMERIC(T, unsigned char)
-                FB_CONVERT_ENTRY_NUMERIC(T, short)
-                FB_CONVERT_ENTRY_NUMERIC(T, unsigned short)
-                FB_CONVERT_ENTRY_NUMERIC(T, int)
-                FB_CONVERT_ENTRY_NUMERIC(T, unsigned int)
-                FB_CONVERT_ENTRY_NUMERIC(T, long)
-                FB_CONVERT_ENTRY_NUMERIC(T, unsigned long)
-                FB_CONVERT_ENTRY_NUMERIC(T, long long)
-                FB_CONVERT_ENTRY_NUMERIC(T, unsigned long long)
-                FB_CONVERT_ENTRY_NUMERIC(T, float)
-                FB_CONVERT_ENTRY_NUMERIC(T, double)
-                FB_CONVERT_ENTRY_COMPLEX_BEGIN(bool, bval);
-                    // we handle bool here specifically because the numeric_cast produces warnings
-                    return static_cast<T>(bval ? 1 : 0);
-                FB_CONVERT_ENTRY_COMPLEX_END();
-                FB_CONVERT_ENTRY_FROM_STRING(T, std::string)
-                FB_CONVERT_ENTRY_FROM_WSTRING(T, std::wstring)
-                FB_END_CONVERT_MAP(T)
+                using namespace FB::variant_detail;
+                switch (var.get_type_tag()) {
+                    // bool is handled specifically because the numeric_cast produces warnings
+                    case tag_bool:      return static_cast<T>(var.cast<bool>() ? 1 : 0);
+                    case tag_char:      return checked_numeric_convert<T, char>(var);
+                    case tag_uchar:     return checked_numeric_convert<T, unsigned char>(var);
+                    case tag_short:     return checked_numeric_convert<T, short>(var);
+                    case tag_ushort:    return checked_numeric_convert<T, unsigned short>(var);
+                    case tag_int:       return checked_numeric_convert<T, int>(var);
+                    case tag_uint:      return checked_numeric_convert<T, unsigned int>(var);
+                    case tag_long:      return checked_numeric_convert<T, long>(var);
+                    case tag_ulong:     return checked_numeric_convert<T, unsigned long>(var);
+                    case tag_longlong:  return checked_numeric_convert<T, long long>(var);
+                    case tag_ulonglong: return checked_numeric_convert<T, unsigned long long>(var);
+                    case tag_float:     return checked_numeric_convert<T, float>(var);
+                    case tag_double:    return checked_numeric_convert<T, double>(var);
+                    case tag_string:    return parse_numeric<T>(var.cast<std::string>(), var);
+                    case tag_wstring:   return parse_numeric<T>(FB::wstring_to_utf8(var.cast<std::wstring>()), var);
+                    default:
+                        // numeric types not covered by a tag (e.g. long double) still match exactly
+                        if (var.get_type() == typeid(T))
+                            return var.cast<T>();
+                        throw bad_variant_cast(var.get_type(), typeid(T));
+                }
             }
         }
     }
@@ -682,17 +715,5 @@ namespace FB
 #pragma warning(pop)
 #endif
 
-#undef FB_BEGIN_CONVERT_MAP
-#undef FB_END_CONVERT_MAP
-#undef FB_END_CONVERT_MAP_NO_THROW
-#undef FB_CONVERT_ENTRY_SIMPLE
-#undef FB_CONVERT_ENTRY_NUMERIC
-#undef FB_CONVERT_ENTRY_TO_STRING
-#undef FB_CONVERT_ENTRY_TO_WSTRING
-#undef FB_CONVERT_ENTRY_FROM_STRING
-#undef FB_CONVERT_ENTRY_FROM_STRING_TYPE
-#undef FB_CONVERT_ENTRY_COMPLEX_BEGIN
-#undef FB_CONVERT_ENTRY_COMPLEX_END
-
 #endif // FB_VARIANT_H
 
@@ -12,13 +12,142 @@
  Copyright 2009 Richard Bateman, Firebreath development team
 \**********************************************************/
 
+#pragma once
+#ifndef H_FB_VARIANT_CONVERSIONS
+#define H_FB_VARIANT_CONVERSIONS
+
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <limits>
 #include <boost/shared_ptr.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_signed.hpp>
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#  define FB_NUM_SNPRINTF _snprintf
+#else
+#  define FB_NUM_SNPRINTF snprintf
+#endif
 
 namespace FB {
     class variant;
     class JSAPI;
     class JSObject;
+    class LazyVariantMap;
+    class LazyVariantList;
     namespace variant_detail {
+        ///////////////////////////////////////////////////
+        // number_codec: non-allocating number <-> string
+        // routines in the spirit of to_chars/from_chars.
+        // The stringstream based kernels used before
+        // constructed a stream per conversion, which
+        // dominated the cost of number-heavy JS arrays
+        // crossing the bridge; these parse from and
+        // format into caller-provided stack buffers with
+        // no heap traffic.  parse() tolerates leading
+        // whitespace and trailing garbage and format()
+        // uses %g precision for floating point, matching
+        // the stream semantics they replace.
+        ///////////////////////////////////////////////////
+
+        template <typename To,
+                  bool IsInt = boost::is_integral<To>::value,
+                  bool IsSigned = boost::is_signed<To>::value>
+        struct number_codec;
+
+        // signed integers
+        template <typename To>
+        struct number_codec<To, true, true>
+        {
+            static bool parse(const char* str, To& out)
+            {
+                char* end;
+                errno = 0;
+                const long long value = strtoll(str, &end, 10);
+                if (end == str || errno == ERANGE)
+                    return false;
+                if (value < static_cast<long long>(std::numeric_limits<To>::min())
+                        || value > static_cast<long long>(std::numeric_limits<To>::max()))
+                    return false;
+                out = static_cast<To>(value);
+                return true;
+            }
+            static int format(char* buf, size_t cap, To value)
+            {
+                return FB_NUM_SNPRINTF(buf, cap, "%lld", static_cast<long long>(value));
+            }
+        };
+
+        // unsigned integers
+        template <typename To>
+        struct number_codec<To, true, false>
+        {
+            static bool parse(const char* str, To& out)
+            {
+                char* end;
+                errno = 0;
+                const unsigned long long value = strtoull(str, &end, 10);
+                if (end == str || errno == ERANGE)
+                    return false;
+                if (value > static_cast<unsigned long long>(std::numeric_limits<To>::max()))
+                    return false;
+                out = static_cast<To>(value);
+                return true;
+            }
+            static int format(char* buf, size_t cap, To value)
+            {
+                return FB_NUM_SNPRINTF(buf, cap, "%llu", static_cast<unsigned long long>(value));
+            }
+        };
+
+        // floating point
+        template <typename To, bool IsSigned>
+        struct number_codec<To, false, IsSigned>
+        {
+            static bool parse(const char* str, To& out)
+            {
+                char* end;
+                const double value = strtod(str, &end);
+                if (end == str)
+                    return false;
+                out = static_cast<To>(value);
+                return true;
+            }
+            static int format(char* buf, size_t cap, To value)
+            {
+                return FB_NUM_SNPRINTF(buf, cap, "%g", static_cast<double>(value));
+            }
+        };
+
+        // character types stream as characters, not numbers; keep that behavior
+        template <typename To>
+        struct char_codec
+        {
+            static bool parse(const char* str, To& out)
+            {
+                while (*str && isspace(static_cast<unsigned char>(*str)))
+                    ++str;
+                if (!*str)
+                    return false;
+                out = static_cast<To>(*str);
+                return true;
+            }
+            static int format(char* buf, size_t cap, To value)
+            {
+                if (cap < 2)
+                    return -1;
+                buf[0] = static_cast<char>(value);
+                buf[1] = '\0';
+                return 1;
+            }
+        };
+
+        template <> struct number_codec<char, true, true> : char_codec<char> {};
+        template <> struct number_codec<char, true, false> : char_codec<char> {};
+        template <> struct number_codec<signed char, true, true> : char_codec<signed char> {};
+        template <> struct number_codec<unsigned char, true, false> : char_codec<unsigned char> {};
         namespace conversion {
             template <class T>
             struct type_spec
@@ -74,11 +203,21 @@ namespace FB {
             template<class Cont>
             typename FB::meta::enable_for_non_assoc_containers<Cont, const Cont>::type
             convert_variant(const variant& var, type_spec<Cont>);
-            
+
             template<class Dict>
             typename FB::meta::enable_for_pair_assoc_containers<Dict, const Dict>::type
             convert_variant(const variant& var, type_spec<Dict>);
+
+            // lazy JSObject-backed containers; defined in LazyContainers.h
+            variant make_variant(const FB::LazyVariantMap& map);
+            variant make_variant(const FB::LazyVariantList& list);
+            FB::LazyVariantMap convert_variant(const variant& var, type_spec<FB::LazyVariantMap>);
+            FB::LazyVariantList convert_variant(const variant& var, type_spec<FB::LazyVariantList>);
         }
     }
 }
 
+#undef FB_NUM_SNPRINTF
+
+#endif // H_FB_VARIANT_CONVERSIONS
+
@@ -74,6 +74,22 @@ namespace FB
                               FB::VariantMap::const_iterator end,
                               OutputIterator result);
 
+    /// @brief Bulk-convert a FB::VariantMap into an STL-style dictionary in one pass.
+    ///
+    /// Like convert_variant_map, but inserts with an end() hint -- the source
+    /// map is already key-ordered, so each insertion is amortized constant
+    /// instead of a fresh O(log n) search -- and copies values that already
+    /// hold exactly Dict::mapped_type straight out, bypassing the convert_cast
+    /// dispatch.  A homogeneous map (e.g. a 10k-entry string->string config
+    /// object) hits the fast path on every entry.
+    /// @since 1.7
+    template<class Dict>
+    inline Dict convert_variant_map_bulk(const FB::VariantMap& from);
+    /// @brief Bulk-convert from into to; see the returning overload.
+    /// @since 1.7
+    template<class Dict>
+    inline void convert_variant_map_bulk(const FB::VariantMap& from, Dict& to);
+
     /// @brief Allows convenient creation of an FB::VariantMap.
     /// @return A helper type that overloads operator() for insertion and is convertible to FB::VariantMap.
     ///
@@ -119,7 +135,11 @@ namespace FB
             }
             operator FB::variant()
             {
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+                return FB::variant(std::move(m_m));
+#else
                 return FB::variant(m_m);
+#endif
             }
         private:
             std::map<T,FB::variant> m_m;
@@ -202,6 +222,26 @@ namespace FB
     {
         convert_variant_map<typename Dict::value_type>(from.begin(), from.end(), std::inserter(to, to.begin()));
     }
+
+    template<class Dict>
+    inline void convert_variant_map_bulk(const FB::VariantMap& from, Dict& to)
+    {
+        typedef typename Dict::mapped_type To;
+        for (FB::VariantMap::const_iterator it = from.begin(); it != from.end(); ++it) {
+            if (it->second.is_of_type<To>())
+                to.insert(to.end(), typename Dict::value_type(it->first, it->second.cast<To>()));
+            else
+                to.insert(to.end(), typename Dict::value_type(it->first, it->second.convert_cast<To>()));
+        }
+    }
+
+    template<class Dict>
+    inline Dict convert_variant_map_bulk(const FB::VariantMap& from)
+    {
+        Dict to;
+        convert_variant_map_bulk(from, to);
+        return to;
+    }
 }
 
 #endif
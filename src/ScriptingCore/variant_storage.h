@@ -0,0 +1,317 @@
+/**********************************************************\
+Created:    2008-2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2008-2012 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef FB_VARIANT_STORAGE_H
+#define FB_VARIANT_STORAGE_H
+
+#include <new>
+#include <string>
+#include <typeinfo>
+#include <boost/config.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/mpl/if.hpp>
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+#include <utility>
+#endif
+#include "AllocTracker.h"
+
+namespace FB
+{
+    namespace variant_detail
+    {
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @enum   builtin_tag
+        ///
+        /// @brief  Dense type index for the types that commonly cross the scripting bridge
+        ///
+        /// Every stored type gets a tag assigned at compile time through builtin_type_of; types the
+        /// conversion engine doesn't know about share tag_other and fall back to the generic path.
+        /// convert_cast switches on this tag instead of walking a typeid comparison chain, so the
+        /// common conversions are a single jump-table dispatch.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        enum builtin_tag {
+            tag_other = 0,
+            tag_empty,
+            tag_bool,
+            tag_char,
+            tag_uchar,
+            tag_short,
+            tag_ushort,
+            tag_int,
+            tag_uint,
+            tag_long,
+            tag_ulong,
+            tag_longlong,
+            tag_ulonglong,
+            tag_float,
+            tag_double,
+            tag_string,
+            tag_wstring
+        };
+
+        template <typename T>
+        struct builtin_type_of { static const builtin_tag value = tag_other; };
+
+        template <> struct builtin_type_of<bool>               { static const builtin_tag value = tag_bool; };
+        template <> struct builtin_type_of<char>               { static const builtin_tag value = tag_char; };
+        template <> struct builtin_type_of<unsigned char>      { static const builtin_tag value = tag_uchar; };
+        template <> struct builtin_type_of<short>              { static const builtin_tag value = tag_short; };
+        template <> struct builtin_type_of<unsigned short>     { static const builtin_tag value = tag_ushort; };
+        template <> struct builtin_type_of<int>                { static const builtin_tag value = tag_int; };
+        template <> struct builtin_type_of<unsigned int>       { static const builtin_tag value = tag_uint; };
+        template <> struct builtin_type_of<long>               { static const builtin_tag value = tag_long; };
+        template <> struct builtin_type_of<unsigned long>      { static const builtin_tag value = tag_ulong; };
+        template <> struct builtin_type_of<long long>          { static const builtin_tag value = tag_longlong; };
+        template <> struct builtin_type_of<unsigned long long> { static const builtin_tag value = tag_ulonglong; };
+        template <> struct builtin_type_of<float>              { static const builtin_tag value = tag_float; };
+        template <> struct builtin_type_of<double>             { static const builtin_tag value = tag_double; };
+        template <> struct builtin_type_of<std::string>        { static const builtin_tag value = tag_string; };
+        template <> struct builtin_type_of<std::wstring>       { static const builtin_tag value = tag_wstring; };
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @class  storage
+        ///
+        /// @brief  Type-erased value holder used by FB::variant in place of boost::any
+        ///
+        /// Unlike boost::any this class keeps small values (arithmetic types, empty/null markers,
+        /// smart pointers and small strings) in an inline buffer instead of allocating them on the
+        /// heap; values that do not fit the buffer fall back to heap storage.  Since variants cross
+        /// the scripting bridge on every call this removes an allocator round-trip from nearly all
+        /// value traffic.  The interface mirrors the subset of boost::any that variant relies on.
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        class storage
+        {
+        private:
+            // Inline payload; 32 bytes is enough for all arithmetic types, shared_ptr/weak_ptr,
+            // and the small-string buffer of common std::string implementations
+            union data_t {
+                double align_double;    // force useful alignment for the inline buffer
+                void* heap;             // heap policy keeps its pointer here
+                char buf[32];
+            };
+
+            struct vtable {
+                const std::type_info& (*type)();
+                void (*destroy)(data_t&);
+                void (*clone)(const data_t&, data_t&);      // dest must be unconstructed
+                void (*transfer)(data_t&, data_t&);         // dest must be unconstructed; src is consumed
+                const void* (*get)(const data_t&);
+                builtin_tag tag;
+            };
+
+            // Policy for values that fit (size and alignment) in the inline buffer
+            template <typename T>
+            struct small_policy {
+                static const std::type_info& type() { return typeid(T); }
+                static void destroy(data_t& d) { reinterpret_cast<T*>(d.buf)->~T(); }
+                static void clone(const data_t& src, data_t& dest) {
+                    new (dest.buf) T(*reinterpret_cast<const T*>(src.buf));
+                }
+                static void transfer(data_t& src, data_t& dest) {
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+                    new (dest.buf) T(std::move(*reinterpret_cast<T*>(src.buf)));
+#else
+                    new (dest.buf) T(*reinterpret_cast<const T*>(src.buf));
+#endif
+                    destroy(src);
+                }
+                static const void* get(const data_t& d) { return d.buf; }
+                static void construct(data_t& d, const T& val) { new (d.buf) T(val); }
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+                static void construct_moved(data_t& d, T&& val) { new (d.buf) T(std::move(val)); }
+#endif
+                static const vtable* get_table() {
+                    static const vtable table = { &type, &destroy, &clone, &transfer, &get, builtin_type_of<T>::value };
+                    return &table;
+                }
+            };
+
+            // Policy for values too large (or too strictly aligned) for the inline buffer
+            template <typename T>
+            struct heap_policy {
+                static const std::type_info& type() { return typeid(T); }
+                static void destroy(data_t& d) {
+                    FB::AllocTracker::recordFree(FB::AllocTracker::Subsystem_Variant, sizeof(T));
+                    delete static_cast<T*>(d.heap);
+                }
+                static void clone(const data_t& src, data_t& dest) {
+                    FB::AllocTracker::recordAlloc(FB::AllocTracker::Subsystem_Variant, sizeof(T));
+                    dest.heap = new T(*static_cast<const T*>(src.heap));
+                }
+                static void transfer(data_t& src, data_t& dest) {
+                    dest.heap = src.heap;   // steal the allocation; no copy in any language mode
+                }
+                static const void* get(const data_t& d) { return d.heap; }
+                static void construct(data_t& d, const T& val) {
+                    FB::AllocTracker::recordAlloc(FB::AllocTracker::Subsystem_Variant, sizeof(T));
+                    d.heap = new T(val);
+                }
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+                static void construct_moved(data_t& d, T&& val) {
+                    FB::AllocTracker::recordAlloc(FB::AllocTracker::Subsystem_Variant, sizeof(T));
+                    d.heap = new T(std::move(val));
+                }
+#endif
+                static const vtable* get_table() {
+                    static const vtable table = { &type, &destroy, &clone, &transfer, &get, builtin_type_of<T>::value };
+                    return &table;
+                }
+            };
+
+            template <typename T>
+            struct select_policy {
+                static const bool use_small =
+                    sizeof(T) <= sizeof(data_t)
+                    && boost::alignment_of<T>::value <= boost::alignment_of<data_t>::value;
+                typedef typename boost::mpl::if_c<use_small,
+                    small_policy<T>, heap_policy<T> >::type type;
+            };
+
+            struct empty_policy {
+                static const std::type_info& type() { return typeid(void); }
+                static void destroy(data_t&) {}
+                static void clone(const data_t&, data_t&) {}
+                static void transfer(data_t&, data_t&) {}
+                static const void* get(const data_t&) { return NULL; }
+                static const vtable* get_table() {
+                    static const vtable table = { &type, &destroy, &clone, &transfer, &get, tag_empty };
+                    return &table;
+                }
+            };
+
+        public:
+            storage() : table(empty_policy::get_table()) {}
+
+            storage(const storage& rhs) : table(empty_policy::get_table()) {
+                assign(rhs);
+            }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+            storage(storage&& rhs) : table(empty_policy::get_table()) {
+                take(rhs);
+            }
+#endif
+
+            template <typename T>
+            explicit storage(const T& val) : table(empty_policy::get_table()) {
+                assign(val);
+            }
+
+            ~storage() {
+                table->destroy(data);
+            }
+
+            storage& assign(const storage& rhs) {
+                if (this == &rhs)
+                    return *this;
+                clear();
+                // if clone throws (copy ctor of the held type) we stay empty
+                rhs.table->clone(rhs.data, data);
+                table = rhs.table;
+                return *this;
+            }
+
+            template <typename T>
+            storage& assign(const T& val) {
+                typedef typename select_policy<T>::type policy;
+                clear();
+                policy::construct(data, val);
+                table = policy::get_table();
+                return *this;
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            /// @fn storage& storage::take(storage& rhs)
+            ///
+            /// @brief  Moves the value out of rhs into this storage, leaving rhs empty
+            ///
+            /// Heap-held values transfer their pointer without copying in any language mode; inline
+            /// values are moved when rvalue references are available and copied otherwise.
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            storage& take(storage& rhs) {
+                if (this == &rhs)
+                    return *this;
+                clear();
+                rhs.table->transfer(rhs.data, data);
+                table = rhs.table;
+                rhs.table = empty_policy::get_table();
+                return *this;
+            }
+
+#ifndef BOOST_NO_CXX11_RVALUE_REFERENCES
+            template <typename T>
+            storage& assign_moved(T&& val) {
+                typedef typename select_policy<T>::type policy;
+                clear();
+                policy::construct_moved(data, std::move(val));
+                table = policy::get_table();
+                return *this;
+            }
+
+            storage& operator=(storage&& rhs) { return take(rhs); }
+#endif
+
+            storage& operator=(const storage& rhs) { return assign(rhs); }
+
+            template <typename T>
+            storage& operator=(const T& val) { return assign(val); }
+
+            void clear() {
+                table->destroy(data);
+                table = empty_policy::get_table();
+            }
+
+            // Inline buffers can hold types with internal pointers, so a raw byte swap is not
+            // safe; swap through a temporary instead.  This is only used by variant::swap
+            void swap(storage& rhs) {
+                storage tmp(*this);
+                assign(rhs);
+                rhs.assign(tmp);
+            }
+
+            const std::type_info& type() const {
+                return table->type();
+            }
+
+            builtin_tag type_tag() const {
+                return table->tag;
+            }
+
+            bool empty() const {
+                return table == empty_policy::get_table();
+            }
+
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            /// @fn template<typename T> const T* storage::cast_ptr() const
+            ///
+            /// @brief  Returns a pointer to the held value if it is exactly of type T, NULL otherwise
+            ////////////////////////////////////////////////////////////////////////////////////////////////////
+            template <typename T>
+            const T* cast_ptr() const {
+                if (table->type() != typeid(T))
+                    return NULL;
+                return static_cast<const T*>(table->get(data));
+            }
+
+        private:
+            data_t data;
+            const vtable* table;
+        };
+
+        inline void swap(storage& lhs, storage& rhs) {
+            lhs.swap(rhs);
+        }
+    } // namespace variant_detail
+} // namespace FB
+
+#endif // FB_VARIANT_STORAGE_H
@@ -87,14 +87,13 @@ bool JSObjectRefAPI::HasMethod(const std::string& methodName) const
     if (methodName.empty()) {
         return JSObjectIsFunction(m_jsContext, *o->getPtr());
     } else {
-        JSStringRef str = JSStringCreateWithUTF8CString(methodName.c_str());
+        // borrowed from the host's intern cache; must not be released
+        JSStringRef str = getHost()->getInternedJSString(methodName);
         if (!JSObjectHasProperty(m_jsContext, *o->getPtr(), str)) {
-            JSStringRelease(str);
             return false;
         }
         JSValueRef except(NULL);
         JSValueRef inner = JSObjectGetProperty(m_jsContext, *o->getPtr(), str, &except);
-        JSStringRelease(str);
         if (except != NULL) {
             // Hmm.  Do something here. Not sure what, actually.
         } else if (JSValueIsObject(m_jsContext, inner)) {
@@ -109,10 +108,8 @@ bool JSObjectRefAPI::HasProperty(const std::string& propertyName) const
     if (!o || m_browser.expired())
         return false;
     
-    JSStringRef str = JSStringCreateWithUTF8CString(propertyName.c_str());
-    bool exists = JSObjectHasProperty(m_jsContext, *o->getPtr(), str);
-    JSStringRelease(str);
-    return exists;
+    JSStringRef str = getHost()->getInternedJSString(propertyName);
+    return JSObjectHasProperty(m_jsContext, *o->getPtr(), str);
 }
 bool JSObjectRefAPI::HasProperty(int idx) const
 {
@@ -127,10 +124,9 @@ variant JSObjectRefAPI::GetProperty(const std::string& propertyName)
         return FBVoid();
     
     JSValueRef except(NULL);
-    JSStringRef str = JSStringCreateWithUTF8CString(propertyName.c_str());
+    JSStringRef str = getHost()->getInternedJSString(propertyName);
     JSValueRef res = JSObjectGetProperty(m_jsContext, *o->getPtr(), str, &except);
-    JSStringRelease(str);
-    
+
     if (except != NULL) {
         throw FB::script_error("Could not get property " + propertyName);
         // TODO: Handle the exception; how?
@@ -147,12 +143,11 @@ void JSObjectRefAPI::SetProperty(const std::string& propertyName, const variant&
     JSValueProtect(m_jsContext, obref);
     
     JSValueRef except(NULL);
-    JSStringRef str = JSStringCreateWithUTF8CString(propertyName.c_str());
-    
+    JSStringRef str = getHost()->getInternedJSString(propertyName);
+
     JSValueRef newVal = getHost()->JSValueRefFromVariant(value);
     JSObjectSetProperty(m_jsContext, obref, str, newVal, kJSPropertyAttributeNone, &except);
 
-    JSStringRelease(str);
     JSValueUnprotect(m_jsContext, obref);
     
     if (except != NULL) {
@@ -167,10 +162,9 @@ void JSObjectRefAPI::RemoveProperty(const std::string& propertyName)
         return;
     
     JSValueRef except(NULL);
-    JSStringRef str = JSStringCreateWithUTF8CString(propertyName.c_str());
+    JSStringRef str = getHost()->getInternedJSString(propertyName);
     bool res = JSObjectDeleteProperty(m_jsContext, *o->getPtr(), str, &except);
-    JSStringRelease(str);
-    
+
     if (!res || except != NULL) {
         throw FB::script_error("Could not remove property " + propertyName);
     }
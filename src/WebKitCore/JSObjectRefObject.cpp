@@ -175,17 +175,14 @@ void JSObjectRefObject::GetPropertyNames(JSPropertyNameAccumulatorRef propertyNa
         StringArray memberList;
         getAPI()->getMemberNames(memberList);
         
+        // the names are borrowed from the host's intern cache, so repeated
+        // enumeration stops converting every member name from UTF-8 again
         for (uint32_t i = 0; i < memberList.size(); i++) {
-            JSStringRef curName = JSStringCreateWithUTF8CString(memberList.at(i).c_str());
-            JSPropertyNameAccumulatorAddName(propertyNames, curName);
-            JSStringRelease(curName);
+            JSPropertyNameAccumulatorAddName(propertyNames,
+                browser->getInternedJSString(memberList.at(i)));
         }
-        JSStringRef addEvt = JSStringCreateWithUTF8CString("addEventListener");
-        JSStringRef removeEvt = JSStringCreateWithUTF8CString("removeEventListener");
-        JSPropertyNameAccumulatorAddName(propertyNames, addEvt);
-        JSPropertyNameAccumulatorAddName(propertyNames, removeEvt);
-        JSStringRelease(addEvt);
-        JSStringRelease(removeEvt);
+        JSPropertyNameAccumulatorAddName(propertyNames, browser->getInternedJSString("addEventListener"));
+        JSPropertyNameAccumulatorAddName(propertyNames, browser->getInternedJSString("removeEventListener"));
     } catch (const std::bad_cast&) {
         // Nothing really to do here
     } catch (const script_error& e) {
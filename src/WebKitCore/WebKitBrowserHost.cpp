@@ -86,6 +86,21 @@ WebKitBrowserHost::WebKitBrowserHost(JSContextRef jsContext, JSObjectRef window,
 
 WebKitBrowserHost::~WebKitBrowserHost()
 {
+    for (std::map<std::string, JSStringRef>::iterator it = m_internedStrings.begin();
+            it != m_internedStrings.end(); ++it) {
+        JSStringRelease(it->second);
+    }
+    m_internedStrings.clear();
+}
+
+JSStringRef WebKitBrowserHost::getInternedJSString(const std::string& utf8)
+{
+    std::map<std::string, JSStringRef>::const_iterator fnd = m_internedStrings.find(utf8);
+    if (fnd != m_internedStrings.end())
+        return fnd->second;
+    JSStringRef str = JSStringCreateWithUTF8CString(utf8.c_str());
+    m_internedStrings[utf8] = str;
+    return str;
 }
 
 void *WebKitBrowserHost::getContextID() const {
@@ -95,34 +110,40 @@ JSContextRef WebKitBrowserHost::getJSContext() const {
     return m_jsContext;
 }
 FB::DOM::DocumentPtr WebKitBrowserHost::getDOMDocument() {
+    if (m_domDocument)
+        return m_domDocument;
     try {
         FB::JSObjectPtr doc(jsEval("document").convert_cast<FB::JSObjectPtr>());
         if (doc)
-            return FB::DOM::Document::create(doc);
+            m_domDocument = FB::DOM::Document::create(doc);
     }
     catch (...) {
     }
-    return FB::DOM::DocumentPtr();
+    return m_domDocument;
 }
 FB::DOM::WindowPtr WebKitBrowserHost::getDOMWindow() {
+    if (m_domWindow)
+        return m_domWindow;
     try {
         FB::JSObjectPtr win(getVariant(m_jsWindow).convert_cast<FB::JSObjectPtr>());
         if (win)
-            return FB::DOM::Window::create(win);
+            m_domWindow = FB::DOM::Window::create(win);
     }
     catch (...) {
     }
-    return FB::DOM::WindowPtr();
+    return m_domWindow;
 }
 FB::DOM::ElementPtr WebKitBrowserHost::getDOMElement() {
+    if (m_domElement)
+        return m_domElement;
     try {
         FB::JSObjectPtr body(jsEval("document.body").convert_cast<FB::JSObjectPtr>());
         if (body)
-            return FB::DOM::Element::create(body);
+            m_domElement = FB::DOM::Element::create(body);
     }
     catch (...) {
     }
-    return FB::DOM::ElementPtr();
+    return m_domElement;
 }
 FB::variant WebKitBrowserHost::jsEval(const std::string &script) {
     JSStringRef scriptJS = JSStringCreateWithUTF8CString(script.c_str());
@@ -240,6 +261,10 @@ void WebKitBrowserHost::shutdown()
 {
     boost::recursive_mutex::scoped_lock _l(m_jsObjectMutex);
 
+    m_domWindow.reset();
+    m_domDocument.reset();
+    m_domElement.reset();
+
     while (!m_jsObjectList.empty()) {
         JSObjectRefPtr ptr(m_jsObjectList.back());
         m_jsObjectList.pop_back();
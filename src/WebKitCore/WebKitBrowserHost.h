@@ -16,6 +16,7 @@
 #ifndef H_WEBKITBROWSERHOST
 #define H_WEBKITBROWSERHOST
 
+#include <map>
 #include <boost/thread/recursive_mutex.hpp>
 #include <objc/objc.h>
 #include <objc/runtime.h>
@@ -57,7 +58,23 @@ namespace FB { namespace WebKit {
         // Implementation specific methods
         FB::variant getVariant(JSValueRef input);
         JSValueRef JSValueRefFromVariant(const FB::variant& var);
-        
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn JSStringRef getInternedJSString(const std::string& utf8)
+        ///
+        /// @brief  Returns a retained JSStringRef for the given member name, reused across calls
+        ///
+        /// Property and method names cross the bridge constantly and used to be converted from
+        /// UTF-8 into a fresh JSStringRef every single time.  The host keeps one retained ref
+        /// per name for the life of the context; the returned ref is borrowed, do NOT
+        /// JSStringRelease it.  Main thread only.  Intended for member names (a small, bounded
+        /// set), not for arbitrary string values.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        JSStringRef getInternedJSString(const std::string& utf8);
+
+
         JSObjectRefPtr ProtectJSObjectRef(JSObjectRef o);
         void ReleaseJSObjectRef(const JSObjectRefWeakPtr& oref);
         void deferred_release(JSObjectRef o) const;
@@ -69,6 +86,12 @@ namespace FB { namespace WebKit {
         mutable boost::recursive_mutex m_deferMutex;
         mutable boost::recursive_mutex m_jsObjectMutex;
         mutable FB::BrowserHostPtr m_parentHost;
+        // Interned member-name strings; only touched on the main thread
+        std::map<std::string, JSStringRef> m_internedStrings;
+        // Cached DOM wrapper handles; built lazily, dropped in shutdown
+        FB::DOM::WindowPtr m_domWindow;
+        FB::DOM::DocumentPtr m_domDocument;
+        FB::DOM::ElementPtr m_domElement;
     };
     
 }}
@@ -0,0 +1,62 @@
+/**********************************************************\
+Original Author: Richard Bateman (taxilian)
+
+Created:    Aug 30, 2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Richard Bateman, Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_FEATURES
+#define H_FB_FEATURES
+
+// Compile-time feature flags for stripping unused subsystems out of the
+// plugin binary.  Since the whole framework is compiled into each plugin,
+// every subsystem a plugin never calls still costs binary size and therefore
+// cold-load time.  Set these through the matching cmake options (see
+// cmake/options.cmake); because FireBreath is built from source into the
+// plugin, all translation units automatically agree on the flags.
+//
+// FB_NO_DOM
+//     Compiles out the DOM Element/Document convenience layer (element
+//     lookup, attribute access, mutation batching) and the
+//     getDOMDocument()/getDOMElement() accessors on BrowserHost.  The
+//     minimal window bridge (DOM::Window/DOM::Node) is kept: container
+//     marshaling and <param> event-handler lookup depend on it.
+//
+// FB_NO_WSTRING_API
+//     Compiles out the std::wstring convenience overloads on the JSAPI
+//     scripting interfaces (Invoke/GetProperty/registerMethod/... by wide
+//     name) and their conversion template instantiations.  The variant
+//     itself can still hold a wstring.
+//
+// FB_NO_HTTPSERVICE
+//     Prevents the embedded HTTP service library from being built or
+//     linked even when a shared project configuration requests it with
+//     add_firebreath_library(HttpService).
+//
+// FB_NO_STREAM_INFLATE
+//     Compiles out the streaming response decompression stage
+//     (FB::StreamInflater); compressed HTTP responses are then delivered
+//     as received.  Unlike the flags above this is not a user option: cmake
+//     sets it automatically when zlib cannot be found (see cmake/options.cmake).
+//
+// The ActiveX runtime implements its DOM and string handling on top of the
+// pieces these flags remove, so they are only supported in NPAPI-only builds.
+
+#if defined(FB_WIN) && defined(FB_NO_DOM)
+#error FB_NO_DOM is not supported on Windows: the ActiveX runtime (AXDOM) requires the DOM Element/Document layer
+#endif
+
+#if defined(FB_WIN) && defined(FB_NO_WSTRING_API)
+#error FB_NO_WSTRING_API is not supported on Windows: the ActiveX runtime works in wide strings
+#endif
+
+#endif // H_FB_FEATURES
+
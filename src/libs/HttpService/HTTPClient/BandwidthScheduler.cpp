@@ -0,0 +1,126 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include "BandwidthScheduler.h"
+#include <algorithm>
+
+using namespace HTTP;
+using boost::posix_time::ptime;
+using boost::posix_time::microsec_clock;
+
+namespace {
+    // Bucket depth in seconds of traffic: how much may go out in one burst
+    // before the rate cap bites.  Deep enough to keep the link busy between
+    // refills, shallow enough that a burst doesn't swamp interactive traffic.
+    const double kBurstSeconds = 0.25;
+    // Don't wake a throttled transfer for less than this; tiny grants just
+    // multiply syscalls without moving the transfer along
+    const size_t kMinGrant = 4096;
+    // How often a blocked transfer rechecks its abort flag
+    const long kWaitSliceMs = 100;
+
+    double seconds_since(const ptime& then, const ptime& now) {
+        return static_cast<double>((now - then).total_microseconds()) / 1e6;
+    }
+
+    // Refills a bucket in place and returns the new fill level
+    double refill_bucket(double tokens, size_t rate, ptime& last, const ptime& now) {
+        if (last.is_not_a_date_time()) {
+            last = now;
+            return static_cast<double>(rate) * kBurstSeconds; // start full
+        }
+        tokens += seconds_since(last, now) * static_cast<double>(rate);
+        last = now;
+        return (std::min)(tokens, static_cast<double>(rate) * kBurstSeconds);
+    }
+}
+
+BandwidthScheduler& BandwidthScheduler::get() {
+    static BandwidthScheduler scheduler;
+    return scheduler;
+}
+
+BandwidthScheduler::BandwidthScheduler()
+    : m_rate(0), m_tokens(0), m_totalWeight(0) { }
+
+void BandwidthScheduler::setRateLimit(size_t bytes_per_second) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_rate = bytes_per_second;
+    m_tokens = 0;
+    m_lastRefill = microsec_clock::universal_time();
+    m_cond.notify_all();
+}
+
+size_t BandwidthScheduler::getRateLimit() const {
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_rate;
+}
+
+void BandwidthScheduler::addTicket(const Ticket& t) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_totalWeight += t.m_priority;
+}
+
+void BandwidthScheduler::removeTicket(const Ticket& t) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_totalWeight -= t.m_priority;
+    // The departing transfer's share is now up for grabs
+    m_cond.notify_all();
+}
+
+size_t BandwidthScheduler::acquireTokens(Ticket& t, size_t want, const bool* abort_flag) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    for (;;) {
+        if (abort_flag && *abort_flag) return 0;
+
+        size_t allowed = want;
+        ptime now = microsec_clock::universal_time();
+        if (m_rate) {
+            m_tokens = refill_bucket(m_tokens, m_rate, m_lastRefill, now);
+            // Weighted fair share of the shared bucket; a lone transfer gets
+            // all of it, and shares rebalance as tickets come and go
+            double share = m_totalWeight ? static_cast<double>(t.m_priority) / m_totalWeight : 1.0;
+            double slice = (std::max)(static_cast<double>(kMinGrant),
+                                      static_cast<double>(m_rate) * kBurstSeconds * share);
+            allowed = (std::min)(allowed, static_cast<size_t>((std::min)(m_tokens, slice)));
+        }
+        if (t.m_cap) {
+            t.m_capTokens = refill_bucket(t.m_capTokens, t.m_cap, t.m_capLastRefill, now);
+            allowed = (std::min)(allowed, static_cast<size_t>(t.m_capTokens));
+        }
+
+        if (allowed >= (std::min)(want, kMinGrant)) {
+            if (m_rate) m_tokens -= static_cast<double>(allowed);
+            if (t.m_cap) t.m_capTokens -= static_cast<double>(allowed);
+            return allowed;
+        }
+        // Not enough tokens yet; sleep a slice (or until a transfer finishes
+        // or the limit changes) and re-derive the grant from the clock
+        m_cond.timed_wait(lock, boost::posix_time::milliseconds(kWaitSliceMs));
+    }
+}
+
+BandwidthScheduler::Ticket::Ticket(unsigned int priority, size_t rate_cap)
+    : m_priority(priority ? priority : 1), m_cap(rate_cap), m_capTokens(0) {
+    BandwidthScheduler::get().addTicket(*this);
+}
+
+BandwidthScheduler::Ticket::~Ticket() {
+    BandwidthScheduler::get().removeTicket(*this);
+}
+
+size_t BandwidthScheduler::Ticket::acquire(size_t want, const bool* abort_flag) {
+    if (!want) return 0;
+    return BandwidthScheduler::get().acquireTokens(*this, want, abort_flag);
+}
@@ -0,0 +1,83 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_HTTP_BANDWIDTHSCHEDULER
+#define H_HTTP_BANDWIDTHSCHEDULER
+
+#include <boost/noncopyable.hpp>
+#include <boost/thread.hpp>
+
+namespace HTTP {
+
+    /// Process-wide token-bucket scheduler for upload bandwidth.  Every active
+    /// upload holds a Ticket and asks it for tokens before handing bytes to the
+    /// transport; the shared cap (setRateLimit) is split between tickets in
+    /// proportion to their priority, and a finished transfer releasing its
+    /// ticket immediately frees its share for the others.  A ticket can carry
+    /// its own additional cap so one queue can be pinned below the global rate.
+    /// With no caps configured (the default) acquire() grants everything
+    /// immediately and costs one uncontended lock.
+    class BandwidthScheduler {
+    public:
+        static BandwidthScheduler& get();
+
+        static const unsigned int kDefaultPriority = 10;
+
+        /// Shared upload cap in bytes/second across all transfers; 0 (the
+        /// default) disables global throttling.
+        void setRateLimit(size_t bytes_per_second);
+        size_t getRateLimit() const;
+
+        /// One per active transfer.  Construction registers the transfer's
+        /// weight with the scheduler; destruction releases it, growing the
+        /// remaining transfers' shares.
+        class Ticket : boost::noncopyable {
+        public:
+            /// rate_cap additionally limits this transfer alone (bytes/second,
+            /// 0 = only the shared cap applies)
+            Ticket(unsigned int priority = kDefaultPriority, size_t rate_cap = 0);
+            ~Ticket();
+
+            /// Blocks until at least part of 'want' bytes may be sent and
+            /// returns the granted count (never 0).  If abort_flag is given and
+            /// becomes true while waiting, returns 0 instead so the caller can
+            /// abort the transfer.
+            size_t acquire(size_t want, const bool* abort_flag = NULL);
+
+        private:
+            friend class BandwidthScheduler;
+            unsigned int m_priority;
+            size_t m_cap;
+            double m_capTokens;
+            boost::posix_time::ptime m_capLastRefill;
+        };
+
+    private:
+        BandwidthScheduler();
+
+        size_t acquireTokens(Ticket& t, size_t want, const bool* abort_flag);
+        void addTicket(const Ticket& t);
+        void removeTicket(const Ticket& t);
+
+        mutable boost::mutex m_mutex;
+        boost::condition_variable m_cond;
+        size_t m_rate;                      // shared cap, bytes/second; 0 = off
+        double m_tokens;                    // shared bucket fill, bytes
+        boost::posix_time::ptime m_lastRefill;
+        unsigned int m_totalWeight;         // sum of active ticket priorities
+    };
+};
+
+#endif // H_HTTP_BANDWIDTHSCHEDULER
@@ -22,12 +22,19 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 #include <boost/format.hpp>
 #include <boost/lexical_cast.hpp>
 #include <cassert>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <boost/noncopyable.hpp>
 #include <openssl/ssl.h>
 #include <openssl/x509v3.h>
 #include <curl/curl.h>
+#include <boost/scoped_ptr.hpp>
 #include "../HTTPService/BasicService.h"
 #include "../HTTPCommon/Utils.h"
 
+#include "BandwidthScheduler.h"
+#include "../HTTPCommon/TigerTree.h"
 #include "HTTPRequest.h"
 using namespace boost::algorithm;
 using namespace boost::asio;
@@ -58,7 +65,11 @@ void onStatusChanged_do_nothing(HTTP::Status state) {
 }
 
 /*static*/ HTTPRequest* HTTPRequest::create() {
-  return new HTTPRequest();
+  return new HTTPRequest(kThreadPerRequest);
+}
+
+/*static*/ HTTPRequest* HTTPRequest::create(TransferEngine _engine) {
+  return new HTTPRequest(_engine);
 }
 
 static void asyncrequest_status_handler(HTTPRequest* req, HTTP::Status status) {
@@ -189,6 +200,191 @@ static CURLcode sslctx_function(CURL* curl, SSL_CTX* sslctx, void* param) {
     return CURLE_OK;
 }
 
+// Per-origin pool of curl easy handles, shared by every HTTPRequest made through
+// ::create().  A curl easy handle keeps its connections alive internally, so checking
+// a handle back in and handing it to the next request for the same origin gets
+// keep-alive reuse without paying TCP+TLS setup again.  Handles idle longer than the
+// timeout are discarded lazily; checkout blocks while an origin is at its
+// concurrent-connection cap, which is how bursts of small API calls are throttled.
+namespace {
+    class CurlConnectionPool {
+    public:
+        CurlConnectionPool() : max_per_host(6), idle_timeout_sec(60) {}
+        ~CurlConnectionPool() {
+            for (map<string, HostPool>::iterator it = hosts.begin(); it != hosts.end(); ++it) {
+                for (list<PooledHandle>::iterator h = it->second.idle.begin(); h != it->second.idle.end(); ++h) {
+                    curl_easy_cleanup(h->handle);
+                }
+            }
+        }
+
+        static CurlConnectionPool& instance() {
+            // function-local so it's destroyed before _curl_static_init runs curl_global_cleanup
+            static CurlConnectionPool pool;
+            return pool;
+        }
+
+        void setLimits(unsigned int _max_per_host, unsigned int _idle_timeout_sec) {
+            boost::mutex::scoped_lock _l(pool_mutex);
+            if (_max_per_host) max_per_host = _max_per_host;
+            idle_timeout_sec = _idle_timeout_sec;
+        }
+
+        CURL* checkout(const string& key) {
+            boost::mutex::scoped_lock _l(pool_mutex);
+            HostPool& hp = hosts[key];
+            while (hp.outstanding >= max_per_host) handle_returned.wait(_l);
+            ++hp.outstanding;
+
+            time_t now = time(NULL);
+            while (! hp.idle.empty()) {
+                PooledHandle ph = hp.idle.back();
+                hp.idle.pop_back();
+                if (now - ph.idle_since <= (time_t)idle_timeout_sec) return ph.handle;
+                curl_easy_cleanup(ph.handle); // sat too long; the server has likely closed it
+            }
+            return curl_easy_init();
+        }
+
+        void checkin(const string& key, CURL* handle, bool reusable) {
+            boost::mutex::scoped_lock _l(pool_mutex);
+            HostPool& hp = hosts[key];
+            --hp.outstanding;
+            if (reusable && handle) {
+                // reset clears the per-request options but keeps the connection cache
+                curl_easy_reset(handle);
+                PooledHandle ph = { handle, time(NULL) };
+                hp.idle.push_back(ph);
+            } else if (handle) {
+                curl_easy_cleanup(handle);
+            }
+            handle_returned.notify_one();
+        }
+
+    protected:
+        struct PooledHandle {
+            CURL* handle;
+            time_t idle_since;
+        };
+        struct HostPool {
+            HostPool() : outstanding(0) {}
+            list<PooledHandle> idle;
+            unsigned int outstanding;
+        };
+
+        map<string, HostPool> hosts;
+        unsigned int max_per_host;
+        unsigned int idle_timeout_sec;
+        boost::mutex pool_mutex;
+        boost::condition_variable handle_returned;
+    };
+
+    // curl share object holding the TLS session cache (and resolver cache) used by
+    // every easy handle.  Pooled handles already resume sessions they negotiated
+    // themselves; the share extends that to new handles and across origins' parallel
+    // connections, so a reconnect skips the full handshake (~2 RTTs plus the
+    // asymmetric crypto) whenever the server still has the session.
+    class CurlShareHolder {
+    public:
+        CurlShareHolder() {
+            share = curl_share_init();
+            curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lock_cb);
+            curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlock_cb);
+            curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        }
+        ~CurlShareHolder() {
+            curl_share_cleanup(share);
+        }
+
+        static CurlShareHolder& instance() {
+            static CurlShareHolder holder;
+            return holder;
+        }
+
+        CURLSH* share;
+
+    protected:
+        // curl requires caller-supplied locking when a share is used from several threads
+        static void lock_cb(CURL*, curl_lock_data data, curl_lock_access, void* userp) {
+            static_cast<CurlShareHolder*>(userp)->locks[data].lock();
+        }
+        static void unlock_cb(CURL*, curl_lock_data data, void* userp) {
+            static_cast<CurlShareHolder*>(userp)->locks[data].unlock();
+        }
+
+        boost::mutex locks[CURL_LOCK_DATA_LAST];
+    };
+
+    // Process-wide resolver cache layered over curl's shared DNS cache.  The curl
+    // share only remembers lookups a handle performed itself and expires them on
+    // curl's own schedule; this cache keeps the answer long enough to pin it into
+    // the next transfer with CURLOPT_RESOLVE -- skipping the blocking getaddrinfo
+    // completely -- and briefly remembers failed lookups so a dead hostname fails
+    // fast instead of stalling every request behind a slow corporate resolver.
+    // UploadQueue drives its transfers through HTTPRequest, so both share this.
+    class DnsCache {
+    public:
+        static const long kPositiveTtlSec = 300;
+        static const long kNegativeTtlSec = 15;
+
+        static DnsCache& instance() {
+            static DnsCache cache;
+            return cache;
+        }
+
+        // True when a fresh entry exists; negative reports a recently failed lookup
+        bool lookup(const string& host, string& ip, bool& negative) {
+            boost::mutex::scoped_lock _l(cache_mutex);
+            map<string, Entry>::iterator it = entries.find(host);
+            if (it == entries.end()) return false;
+            if (it->second.expires <= time(NULL)) {
+                entries.erase(it);
+                return false;
+            }
+            ip = it->second.ip;
+            negative = it->second.negative;
+            return true;
+        }
+
+        void storePositive(const string& host, const string& ip) {
+            if (ip.empty()) return;
+            boost::mutex::scoped_lock _l(cache_mutex);
+            Entry e = { time(NULL) + kPositiveTtlSec, ip, false };
+            entries[host] = e;
+        }
+
+        void storeNegative(const string& host) {
+            boost::mutex::scoped_lock _l(cache_mutex);
+            Entry e = { time(NULL) + kNegativeTtlSec, string(), true };
+            entries[host] = e;
+        }
+
+    protected:
+        struct Entry {
+            time_t expires;
+            string ip;
+            bool negative;
+        };
+        map<string, Entry> entries;
+        boost::mutex cache_mutex;
+    };
+
+    string pool_key_for(const FB::URI& uri) {
+        return uri.protocol + "://" + uri.domain + ":" + lexical_cast<string>(uri.port);
+    }
+
+    int effective_port(const FB::URI& uri) {
+        if (uri.port) return uri.port;
+        return uri.protocol == "https" ? 443 : 80;
+    }
+}
+
+/*static*/ void HTTPRequest::setConnectionPoolLimits(unsigned int max_connections_per_host, unsigned int idle_timeout_seconds) {
+    CurlConnectionPool::instance().setLimits(max_connections_per_host, idle_timeout_seconds);
+}
+
 void HTTPRequest::_internal_threadSafeDestroy() {
   delete this;
 }
@@ -197,7 +393,8 @@ void HTTPRequest::threadSafeDestroy() {
   boost::thread t(boost::bind(&HTTPRequest::_internal_threadSafeDestroy, this));
 }
 
-HTTPRequest::HTTPRequest() : req(NULL), cancellation_requested(false), status_callback(onStatusChanged_do_nothing) {
+HTTPRequest::HTTPRequest(TransferEngine _engine) : req(NULL), engine(_engine), cancellation_requested(false),
+    transfer_finished(true), status_callback(onStatusChanged_do_nothing) {
 
 }
 
@@ -221,6 +418,11 @@ void HTTPRequest::cancel() {
 
 void HTTPRequest::awaitCompletion() {
   worker_thread->join();
+  // With the multi engine the worker thread only builds the request; wait for
+  // the engine thread to finish tearing the transfer down too
+  boost::mutex::scoped_lock lock(completion_mutex);
+  while (! transfer_finished)
+    completion_cond.wait(lock);
 }
 
 HTTP::Status HTTPRequest::getStatus() const {
@@ -244,9 +446,184 @@ void HTTPRequest::startRequest(boost::shared_ptr<HTTPRequestData> _request_data)
   proxy_config = static_proxy_config;
   
   // We build the HTTP request in another thread to avoid blocking the caller if the request is large or resolving the size of the attached content takes a while.
+  {
+    boost::mutex::scoped_lock lock(completion_mutex);
+    transfer_finished = false;
+  }
     worker_thread = boost::shared_ptr<thread>(new thread(boost::bind(&HTTPRequest::startRequest_thread, this)));
 }
 
+// Double-buffered prefetcher over a datablock: while curl transmits block N, a
+// background thread reads block N+1, so disk and network overlap instead of
+// alternating.  On spinning disks and network shares the alternation is what
+// caps upload throughput.  Reads are expected to be sequential (curl's pull
+// model is); a rewind -- curl restarting a form part after an auth challenge --
+// discards the prefetched blocks and restarts production at the new offset.
+class ReadAheadBuffer : boost::noncopyable {
+public:
+  ReadAheadBuffer(const HTTPDatablock* _db, size_t _block_size)
+    : db(_db), block_size(_block_size), next_produce_offset(0),
+      eof_produced(false), stop(false), generation(0), started(false) {}
+  ~ReadAheadBuffer() {
+    {
+      boost::mutex::scoped_lock lock(mutex);
+      stop = true;
+      cond_producer.notify_all();
+    }
+    if (started) worker.join();
+  }
+
+  size_t read(size_t offset, char* dst, size_t len) {
+    boost::mutex::scoped_lock lock(mutex);
+    if (! started) {
+      // Thread starts on first use, so parts queued behind others in a batch
+      // don't all spin up prefetchers at once
+      started = true;
+      worker = boost::thread(boost::bind(&ReadAheadBuffer::run, this));
+    }
+    for (;;) {
+      if (! slots.empty()) {
+        Slot& s = slots.front();
+        if (offset >= s.offset && offset < s.offset + s.data.size()) {
+          size_t at = offset - s.offset;
+          size_t n = s.data.size() - at;
+          if (n > len) n = len;
+          memcpy(dst, s.data.data() + at, n);
+          if (at + n == s.data.size()) {
+            slots.pop_front();
+            cond_producer.notify_all();
+          }
+          return n;
+        }
+      }
+      if (slots.empty() && eof_produced && offset == next_produce_offset)
+        return 0; // clean EOF
+      if (slots.empty() && ! eof_produced) {
+        cond_consumer.wait(lock);
+        continue;
+      }
+      // Rewind or random access: restart production at the requested offset
+      ++generation;
+      slots.clear();
+      eof_produced = false;
+      next_produce_offset = offset;
+      cond_producer.notify_all();
+      cond_consumer.wait(lock);
+    }
+  }
+
+private:
+  void run() {
+    boost::mutex::scoped_lock lock(mutex);
+    std::vector<char> buf(block_size);
+    while (! stop) {
+      if (slots.size() >= 2 || eof_produced) {
+        cond_producer.wait(lock);
+        continue;
+      }
+      size_t off = next_produce_offset;
+      unsigned int gen = generation;
+      lock.unlock();
+      size_t n = db->read(off, &buf[0], block_size); // disk I/O outside the lock
+      lock.lock();
+      if (stop) break;
+      if (gen != generation) continue; // consumer rewound while we were reading
+      slots.push_back(Slot());
+      slots.back().offset = off;
+      slots.back().data.assign(&buf[0], n);
+      next_produce_offset = off + n;
+      if (n < block_size) eof_produced = true;
+      cond_consumer.notify_all();
+    }
+  }
+
+  struct Slot {
+    size_t offset;
+    std::string data;
+  };
+
+  const HTTPDatablock* db;
+  const size_t block_size;
+  boost::mutex mutex;
+  boost::condition_variable cond_producer;
+  boost::condition_variable cond_consumer;
+  std::deque<Slot> slots;       // at most 2: the block draining and the block ahead
+  size_t next_produce_offset;
+  bool eof_produced;
+  bool stop;
+  unsigned int generation;      // bumped on rewind to invalidate an in-flight read
+  bool started;
+  boost::thread worker;
+};
+
+// Sequential cursor over a datablock for curl's pull-model form streaming; lets a
+// chained or file-backed block upload without ever being materialized contiguously
+struct DatablockReadCursor {
+  DatablockReadCursor(const HTTPDatablock* _db, BandwidthScheduler::Ticket* _ticket = NULL,
+                      const bool* _abort_flag = NULL)
+    : db(_db), offset(0), ticket(_ticket), abort_flag(_abort_flag), hasher(NULL) {}
+  const HTTPDatablock* db;
+  size_t offset;
+  BandwidthScheduler::Ticket* ticket; // throttles this transfer; may be NULL
+  const bool* abort_flag;             // cancellation flag checked while throttled
+  TigerTreeStreamHasher* hasher;      // hash-as-you-stream sink; may be NULL
+  boost::shared_ptr<ReadAheadBuffer> readahead; // double-buffered prefetch; may be NULL
+};
+
+// Pairs a form field with the tree hasher its upload bytes flow through
+struct UploadHashSlot {
+  UploadHashSlot(const std::string& _field) : field(_field) {}
+  std::string field;
+  TigerTreeStreamHasher hasher;
+};
+
+// State that must outlive curl's use of the handle: the form post chain, header
+// and resolve lists, read cursors and strings curl holds pointers into.  Bundled
+// on the heap so a multi-engine transfer stays valid after the thread that built
+// it has exited.
+struct HTTP::TransferState {
+  TransferState() : formpost(NULL), headerlist(NULL), resolve_list(NULL) {
+    errorbuffer[0] = '\0';
+  }
+  ~TransferState() {
+    curl_slist_free_all(headerlist);
+    curl_slist_free_all(resolve_list);
+    curl_formfree(formpost);
+  }
+  struct curl_httppost* formpost;
+  struct curl_slist* headerlist;
+  struct curl_slist* resolve_list;
+  std::list<DatablockReadCursor> file_cursors;
+  std::list<UploadHashSlot> upload_hashers;
+  boost::scoped_ptr<BandwidthScheduler::Ticket> bw_ticket; // registered only while this transfer uploads
+  std::string uri_string;    // curl doesn't copy these, so we have to hold onto them
+  std::string cookie_string;
+  char errorbuffer[CURL_ERROR_SIZE];
+};
+
+static size_t httprequest_readfn(void* ptr, size_t size, size_t nmemb, void* userp) {
+  DatablockReadCursor* cursor = reinterpret_cast<DatablockReadCursor*>(userp);
+  size_t want = size * nmemb;
+  if (cursor->ticket && want) {
+    // Blocks this transfer's worker thread until the scheduler grants tokens;
+    // a zero grant means the request was cancelled while throttled
+    want = cursor->ticket->acquire(want, cursor->abort_flag);
+    if (!want) return CURL_READFUNC_ABORT;
+  }
+  // With a ReadAheadBuffer attached the copy comes from a block prefetched in
+  // memory while the previous one transmitted; otherwise read straight from
+  // the datablock on this thread
+  size_t copied = cursor->readahead
+    ? cursor->readahead->read(cursor->offset, reinterpret_cast<char*>(ptr), want)
+    : cursor->db->read(cursor->offset, reinterpret_cast<char*>(ptr), want);
+  // The cursor is strictly sequential, so feeding the hasher here hashes the
+  // part's bytes in order while they stream out -- no second read pass
+  if (cursor->hasher && copied)
+    cursor->hasher->append(ptr, copied);
+  cursor->offset += copied;
+  return copied;
+}
+
 static size_t httprequest_writefn(void* ptr, size_t size, size_t nmemb, HTTPResponseData* resp) {
   size_t total = size * nmemb;
   if (total) {
@@ -264,20 +641,247 @@ static size_t httprequest_header(void *ptr, size_t size, size_t nmemb, void *cli
   return size * nmemb;
 }
 
+namespace {
+    // Shared event loop for kCurlMulti transfers: one service thread drives every
+    // attached easy handle through a CURLM, so hundreds of concurrent requests
+    // cost one thread instead of a thread apiece.  Connection reuse across
+    // requests comes from the multi handle's own connection cache rather than
+    // CurlConnectionPool.
+    class CurlMultiEngine {
+    public:
+        static CurlMultiEngine& instance() {
+            static CurlMultiEngine engine;
+            return engine;
+        }
+
+        // Takes over a fully prepared easy handle; completion is dispatched back
+        // through request->multiTransferDone() on the engine thread
+        void submit(HTTPRequest* request, CURL* handle) {
+            boost::mutex::scoped_lock lock(engine_mutex);
+            pending.push_back(std::make_pair(handle, request));
+            if (! worker)
+                worker = boost::shared_ptr<thread>(new thread(boost::bind(&CurlMultiEngine::run, this)));
+        }
+
+        // Stored here and applied on the engine thread before the next batch of
+        // handles is added; a multi handle must only be touched from the thread
+        // driving it
+        void setPipelining(bool enabled, unsigned int max_pipeline_length, unsigned int max_host_connections) {
+            boost::mutex::scoped_lock lock(engine_mutex);
+            pipelining_enabled = enabled;
+            pipeline_length = max_pipeline_length;
+            host_connections = max_host_connections;
+            settings_dirty = true;
+        }
+
+    private:
+        CurlMultiEngine() : multi(curl_multi_init()), pipelining_enabled(false),
+            pipeline_length(0), host_connections(0), settings_dirty(false) { }
+
+        // Engine thread only, engine_mutex held
+        void apply_settings() {
+#ifdef CURLPIPE_MULTIPLEX
+            // Newer curl: pipeline on HTTP/1.1 connections and multiplex streams
+            // over one connection where HTTP/2 gets negotiated
+            curl_multi_setopt(multi, CURLMOPT_PIPELINING,
+                pipelining_enabled ? (CURLPIPE_HTTP1 | CURLPIPE_MULTIPLEX) : CURLPIPE_NOTHING);
+#else
+            curl_multi_setopt(multi, CURLMOPT_PIPELINING, pipelining_enabled ? 1L : 0L);
+#endif
+#if LIBCURL_VERSION_NUM >= 0x071e00 // 7.30.0, per-host/pipeline limits
+            if (pipeline_length)
+                curl_multi_setopt(multi, CURLMOPT_MAX_PIPELINE_LENGTH, (long)pipeline_length);
+            if (host_connections)
+                curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)host_connections);
+#endif
+            settings_dirty = false;
+        }
+
+        void run() {
+            std::map<CURL*, HTTPRequest*> active;
+            for (;;) {
+                {
+                    boost::mutex::scoped_lock lock(engine_mutex);
+                    if (settings_dirty)
+                        apply_settings();
+                    for (size_t i = 0; i < pending.size(); ++i) {
+                        curl_multi_add_handle(multi, pending[i].first);
+                        active[pending[i].first] = pending[i].second;
+                    }
+                    pending.clear();
+                }
+
+                int running = 0;
+                curl_multi_perform(multi, &running);
+
+                int queued = 0;
+                CURLMsg* msg;
+                while ((msg = curl_multi_info_read(multi, &queued)) != NULL) {
+                    if (msg->msg != CURLMSG_DONE) continue;
+                    CURL* handle = msg->easy_handle;
+                    int result = static_cast<int>(msg->data.result);
+                    curl_multi_remove_handle(multi, handle);
+                    HTTPRequest* request = active[handle];
+                    active.erase(handle);
+                    // Runs the status callbacks on the engine thread; they may start
+                    // new requests or threadSafeDestroy this one, both of which hand
+                    // the actual work to other threads
+                    request->multiTransferDone(result);
+                }
+
+#if LIBCURL_VERSION_NUM >= 0x071c00 // 7.28.0, first version with curl_multi_wait
+                int numfds = 0;
+                curl_multi_wait(multi, NULL, 0, kPollIntervalMs, &numfds);
+                // With no sockets to watch multi_wait returns immediately, so pace
+                // ourselves instead of spinning while idle
+                if (! numfds)
+                    boost::this_thread::sleep(boost::posix_time::milliseconds(kPollIntervalMs));
+#else
+                boost::this_thread::sleep(boost::posix_time::milliseconds(kPollIntervalMs));
+#endif
+            }
+        }
+
+        static const int kPollIntervalMs = 50;
+
+        CURLM* multi;
+        boost::mutex engine_mutex;
+        std::vector<std::pair<CURL*, HTTPRequest*> > pending;
+        boost::shared_ptr<thread> worker;
+        bool pipelining_enabled;
+        unsigned int pipeline_length;
+        unsigned int host_connections;
+        bool settings_dirty;
+    };
+}
+
+/*static*/ void HTTPRequest::setSameOriginPipelining(bool enabled, unsigned int max_pipeline_length,
+                                                     unsigned int max_host_connections) {
+  CurlMultiEngine::instance().setPipelining(enabled, max_pipeline_length, max_host_connections);
+}
+
+namespace {
+  // Opens a connection to each origin (DNS + TCP + TLS, no request bytes) and
+  // parks the handle in the pool warm.  CURLOPT_CONNECT_ONLY stops curl after
+  // the handshake; checkin's curl_easy_reset clears that option but keeps the
+  // live connection in the handle's cache, so the next checkout for the origin
+  // reuses it directly.  Resolved addresses feed the DnsCache the same way a
+  // completed transfer would.
+  void preconnect_thread(std::vector<string> origins, HTTPProxyConfig proxy) {
+    for (size_t i = 0; i < origins.size(); ++i) {
+      FB::URI uri = FB::URI::fromString(origins[i]);
+      if (uri.domain.empty()) continue;
+
+      string key = pool_key_for(uri);
+      CURL* handle = CurlConnectionPool::instance().checkout(key);
+      char errorbuffer[CURL_ERROR_SIZE] = {0};
+
+      curl_easy_setopt(handle, CURLOPT_SHARE, CurlShareHolder::instance().share);
+      curl_easy_setopt(handle, CURLOPT_SSL_SESSIONID_CACHE, 1);
+      curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1);
+      curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, errorbuffer);
+      curl_easy_setopt(handle, CURLOPT_SSL_CTX_FUNCTION, sslctx_function);
+      curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1);
+      curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2);
+      curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, 20L);
+
+      string url = uri.protocol + "://" + uri.domain + ":" + lexical_cast<string>(effective_port(uri));
+      curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+
+      switch (proxy.type) {
+        default:
+        case HTTPProxyConfig::kNoProxy:
+          break;
+        case HTTPProxyConfig::kSOCKS4Proxy:
+          curl_easy_setopt(handle, CURLOPT_PROXYTYPE, CURLPROXY_SOCKS4);
+          break;
+        case HTTPProxyConfig::kHTTPProxy:
+          curl_easy_setopt(handle, CURLOPT_PROXYTYPE, CURLPROXY_HTTP);
+          break;
+      };
+      if (proxy.type != HTTPProxyConfig::kNoProxy) {
+        curl_easy_setopt(handle, CURLOPT_PROXY, proxy.hostname.c_str());
+        curl_easy_setopt(handle, CURLOPT_PROXYPORT, proxy.port);
+      }
+
+      curl_easy_setopt(handle, CURLOPT_CONNECT_ONLY, 1L);
+      CURLcode res = curl_easy_perform(handle);
+
+      if (res == CURLE_OK && proxy.type == HTTPProxyConfig::kNoProxy) {
+        char* primary_ip = NULL;
+        if (curl_easy_getinfo(handle, CURLINFO_PRIMARY_IP, &primary_ip) == CURLE_OK && primary_ip)
+          DnsCache::instance().storePositive(uri.domain, primary_ip);
+      } else if (res == CURLE_COULDNT_RESOLVE_HOST) {
+        DnsCache::instance().storeNegative(uri.domain);
+      }
+
+      CurlConnectionPool::instance().checkin(key, handle, res == CURLE_OK);
+    }
+  }
+}
+
+/*static*/ void HTTPRequest::preconnect(const std::vector<std::string>& origins) {
+  if (origins.empty()) return;
+  // fire-and-forget: the thread only touches process-lifetime singletons
+  boost::thread(boost::bind(&preconnect_thread, origins, static_proxy_config)).detach();
+}
+
 void HTTPRequest::startRequest_thread() {
-  struct curl_httppost* formpost = NULL;
+  transfer_state = boost::shared_ptr<TransferState>(new TransferState);
+  try {
+    setup_transfer();
+  } catch (const std::exception& e) {
+    last_status.state = Status::HTTP_ERROR;
+    last_status.last_error = e.what();
+    status_callback(last_status);
+    teardown_transfer();
+    return;
+  }
+
+  if (engine == kCurlMulti) {
+    // Hand the prepared handle to the shared event loop and let this thread
+    // exit; completion comes back through multiTransferDone on the engine thread
+    CurlMultiEngine::instance().submit(this, req);
+    return;
+  }
+
+  finish_transfer(static_cast<int>(curl_easy_perform(req)));
+}
+
+void HTTPRequest::multiTransferDone(int curl_result) {
+  finish_transfer(curl_result);
+}
+
+void HTTPRequest::setup_transfer() {
+  TransferState& ts = *transfer_state;
   struct curl_httppost* lastptr = NULL;
-  struct curl_slist* headerlist = NULL;
-  
-  char errorbuffer[CURL_ERROR_SIZE];
 
-  try {
     response_data = boost::shared_ptr<HTTPResponseData>(new HTTPResponseData);
 
-    req = curl_easy_init();
-    
+    // Touch the share first so it is constructed before (and destroyed after) the pool
+    CURLSH* tls_share = CurlShareHolder::instance().share;
+
+    if (engine == kCurlMulti) {
+      // Multi-engine handles are never pooled; the multi's connection cache is
+      // what keeps connections warm across requests
+      req = curl_easy_init();
+#if LIBCURL_VERSION_NUM >= 0x072b00 // 7.43.0
+      // In a burst, wait for an in-progress same-origin connection to become
+      // pipelinable/multiplexable rather than racing to open a new one; a no-op
+      // unless pipelining is enabled on the multi handle
+      curl_easy_setopt(req, CURLOPT_PIPEWAIT, 1L);
+#endif
+    } else {
+      pool_key = pool_key_for(request_data->uri);
+      req = CurlConnectionPool::instance().checkout(pool_key);
+    }
+
+    // curl_easy_reset on checkin detaches the share, so attach it per request
+    curl_easy_setopt(req, CURLOPT_SHARE, tls_share);
+    curl_easy_setopt(req, CURLOPT_SSL_SESSIONID_CACHE, 1);
+
     curl_easy_setopt(req, CURLOPT_NOSIGNAL, 1); // disable signals for multithreaded use
-    curl_easy_setopt(req, CURLOPT_ERRORBUFFER, errorbuffer);
+    curl_easy_setopt(req, CURLOPT_ERRORBUFFER, ts.errorbuffer);
     curl_easy_setopt(req, CURLOPT_FAILONERROR, 1);
 
     curl_easy_setopt(req, CURLOPT_SSL_CTX_FUNCTION, sslctx_function);
@@ -292,56 +896,108 @@ void HTTPRequest::startRequest_thread() {
     std::map<std::string, std::string> post_data = request_data->uri.query_data;    
 
     
-    std::string uri_string; // curl doesn't copy this, so we have to hold onto it
-    
     { // We need a copy of the URI without the query data for curl
       FB::URI bare_uri = request_data->uri;
       bare_uri.query_data.clear();
-      uri_string = bare_uri.toString();
+      ts.uri_string = bare_uri.toString();
     }
     
-    curl_easy_setopt(req, CURLOPT_URL, uri_string.c_str());
+    curl_easy_setopt(req, CURLOPT_URL, ts.uri_string.c_str());
+
+    // Resolver cache: pin a fresh cached address into this transfer so curl never
+    // calls getaddrinfo, or fail fast on a hostname that just failed to resolve.
+    // Skipped behind a proxy, where the proxy does the resolving.
+    curl_easy_setopt(req, CURLOPT_DNS_CACHE_TIMEOUT, DnsCache::kPositiveTtlSec);
+    if (proxy_config.type == HTTPProxyConfig::kNoProxy) {
+      std::string cached_ip;
+      bool negative_hit = false;
+      if (DnsCache::instance().lookup(request_data->uri.domain, cached_ip, negative_hit)) {
+        if (negative_hit) {
+          throw std::runtime_error(("Could not resolve host (cached): " + request_data->uri.domain).c_str());
+        }
+        std::string entry = request_data->uri.domain + ":"
+            + lexical_cast<string>(effective_port(request_data->uri)) + ":" + cached_ip;
+        ts.resolve_list = curl_slist_append(ts.resolve_list, entry.c_str());
+        curl_easy_setopt(req, CURLOPT_RESOLVE, ts.resolve_list);
+      }
+    }
+
     curl_easy_setopt(req, CURLOPT_WRITEFUNCTION, httprequest_writefn);
     curl_easy_setopt(req, CURLOPT_WRITEDATA, response_data.get());
     curl_easy_setopt(req, CURLOPT_USERAGENT, user_agent);
+
+    if (request_data->accept_compressed) {
+      // curl advertises Accept-Encoding and inflates the response as it streams;
+      // httprequest_writefn only ever sees the decoded bytes
+      curl_easy_setopt(req, CURLOPT_ENCODING, "gzip, deflate");
+    }
     
     bool have_post_data = (post_data.size() || request_data->files.size());
     if (have_post_data) {
      
       for (std::map<std::string, std::string>::const_iterator it = post_data.begin(); it != post_data.end(); ++it) {
-        curl_formadd(&formpost, &lastptr,
+        curl_formadd(&ts.formpost, &lastptr,
           CURLFORM_PTRNAME, it->first.c_str(),
           CURLFORM_PTRCONTENTS, it->second.c_str(),
           CURLFORM_CONTENTSLENGTH, it->second.size(),
           CURLFORM_END);
       }
+      if (! request_data->files.empty())
+        ts.bw_ticket.reset(new BandwidthScheduler::Ticket(request_data->upload_priority, request_data->upload_rate_cap));
       for (std::map<std::string, HTTPFileEntry>::iterator it = request_data->files.begin(); it != request_data->files.end(); ++it) {
-        curl_formadd(&formpost, &lastptr,
+        // CURLFORM_STREAM makes curl pull the part through httprequest_readfn, so the
+        // datablock's segments stream straight from their backing store
+        ts.file_cursors.push_back(DatablockReadCursor(it->second.contents, ts.bw_ticket.get(), &cancellation_requested));
+        if (request_data->readahead_block_size &&
+            it->second.contents->size() > request_data->readahead_block_size) {
+          // Overlap disk and network: a prefetch thread keeps the next block in
+          // memory while curl drains the current one.  Parts smaller than one
+          // block gain nothing, so they keep the direct path.
+          ts.file_cursors.back().readahead.reset(
+            new ReadAheadBuffer(it->second.contents, request_data->readahead_block_size));
+        }
+        if (request_data->hash_uploads) {
+          ts.upload_hashers.push_back(UploadHashSlot(it->first));
+          ts.file_cursors.back().hasher = &ts.upload_hashers.back().hasher;
+        }
+        curl_formadd(&ts.formpost, &lastptr,
           CURLFORM_PTRNAME, it->first.c_str(),
-          CURLFORM_BUFFER, it->second.filename.c_str(),
-          CURLFORM_BUFFERPTR, it->second.contents->data(),
-          CURLFORM_BUFFERLENGTH, it->second.contents->size(),
+          CURLFORM_FILENAME, it->second.filename.c_str(),
+          CURLFORM_STREAM, &ts.file_cursors.back(),
+          CURLFORM_CONTENTSLENGTH, it->second.contents->size(),
           CURLFORM_CONTENTTYPE, it->second.content_type.c_str(),
           CURLFORM_END);
       }
-      
+
       curl_easy_setopt(req, CURLOPT_POST, 1);
-      curl_easy_setopt(req, CURLOPT_HTTPPOST, formpost);
+      curl_easy_setopt(req, CURLOPT_HTTPPOST, ts.formpost);
+      curl_easy_setopt(req, CURLOPT_READFUNCTION, httprequest_readfn);
     }
     
-    std::string cookie_string = build_cookie_header(request_data->cookies);
-    curl_easy_setopt(req, CURLOPT_COOKIE, cookie_string.c_str());
+    ts.cookie_string = build_cookie_header(request_data->cookies);
+    curl_easy_setopt(req, CURLOPT_COOKIE, ts.cookie_string.c_str());
     
     for (std::multimap<std::string, std::string>::iterator it = request_data->headers.begin(); it != request_data->headers.end(); ++it) {
-      headerlist = curl_slist_append(headerlist, (it->first + string(": ") + it->second).c_str());
+      ts.headerlist = curl_slist_append(ts.headerlist, (it->first + string(": ") + it->second).c_str());
+    }
+    if (request_data->expect_continue && have_post_data) {
+      // Keep curl's Expect: 100-continue so the server can veto a doomed upload
+      // (auth expiry, quota) before the body goes out on the wire.  Non-compliant
+      // servers just never answer; the fallback timer sends the body anyway after
+      // a short wait, so the worst case costs one RTT-ish pause, not a stall.
+#if LIBCURL_VERSION_NUM >= 0x072400 // 7.36.0; older curl uses its built-in 1s fallback
+      curl_easy_setopt(req, CURLOPT_EXPECT_100_TIMEOUT_MS, 2000L);
+#endif
+    } else {
+      // remove the Expect header that cURL insists on adding. this is dangerous
+      // and results in 417 errors from old/misconfigured proxies as well as lighttpd
+      // versions prior to 0.5. yes, this is how you disable headers in cURL; you pass
+      // the header name with no data on the right side. classy.
+      ts.headerlist = curl_slist_append(ts.headerlist, "Expect:");
     }
-    // remove the Expect header that cURL insists on adding. this is dangerous
-    // and results in 417 errors from old/misconfigured proxies as well as lighttpd
-    // versions prior to 0.5. yes, this is how you disable headers in cURL; you pass
-    // the header name with no data on the right side. classy.
-    headerlist = curl_slist_append(headerlist, "Expect:");
-      
-    curl_easy_setopt(req, CURLOPT_HTTPHEADER, headerlist);
+
+
+    curl_easy_setopt(req, CURLOPT_HTTPHEADER, ts.headerlist);
     curl_easy_setopt(req, CURLOPT_FOLLOWLOCATION, 0); // no redirects for security reasons
 
     // proxy setup
@@ -369,15 +1025,32 @@ void HTTPRequest::startRequest_thread() {
 
     last_status.state = Status::CONNECTING;
     status_callback(last_status);
+}
 
-    if (curl_easy_perform(req) != 0) {
+void HTTPRequest::finish_transfer(int curl_result) {
+  try {
+    CURLcode perform_result = static_cast<CURLcode>(curl_result);
+    if (perform_result != 0) {
       if (cancellation_requested) {
         last_status.state = Status::CANCELLED;
         status_callback(last_status);
       } else {
-        throw std::runtime_error(errorbuffer);
+        if (perform_result == CURLE_COULDNT_RESOLVE_HOST)
+          DnsCache::instance().storeNegative(request_data->uri.domain);
+        throw std::runtime_error(transfer_state->errorbuffer);
       }
     } else {
+      if (proxy_config.type == HTTPProxyConfig::kNoProxy) {
+        // Remember where this origin resolved to so the next request skips the lookup
+        char* primary_ip = NULL;
+        if (curl_easy_getinfo(req, CURLINFO_PRIMARY_IP, &primary_ip) == CURLE_OK && primary_ip)
+          DnsCache::instance().storePositive(request_data->uri.domain, primary_ip);
+      }
+      // Every uploaded byte already flowed through its tree hasher in the read
+      // callback; on success the roots are ready without re-reading the files
+      for (std::list<UploadHashSlot>::iterator it = transfer_state->upload_hashers.begin(); it != transfer_state->upload_hashers.end(); ++it) {
+        request_data->files[it->field].tiger_tree_hash = it->hasher.finalize().toString();
+      }
       last_status.state = Status::COMPLETE;
       status_callback(last_status);
     }
@@ -386,15 +1059,30 @@ void HTTPRequest::startRequest_thread() {
     last_status.last_error = e.what();
     status_callback(last_status);
   }
-  
+  teardown_transfer();
+}
+
+void HTTPRequest::teardown_transfer() {
   long code;
   curl_easy_getinfo(req, CURLINFO_RESPONSE_CODE, &code);
   response_data->code = code;
-  
-  curl_slist_free_all(headerlist);
-  curl_formfree(formpost);
-  curl_easy_cleanup(req);
+
+  transfer_state.reset(); // frees the form post chain and the header/resolve lists
+
+  // A cleanly completed handle goes back to the pool with its connection still
+  // warm; cancelled or errored handles may have a half-read connection, so drop
+  // them (multi-engine handles are never pooled and are always cleaned up here)
+  if (! pool_key.empty()) {
+    CurlConnectionPool::instance().checkin(pool_key, req, last_status.state == Status::COMPLETE);
+    pool_key.clear();
+  } else if (req) {
+    curl_easy_cleanup(req);
+  }
   req = NULL;
+
+  boost::mutex::scoped_lock lock(completion_mutex);
+  transfer_finished = true;
+  completion_cond.notify_all();
 }
 
 void HTTPRequest::curl_header(const char* data, size_t size) {
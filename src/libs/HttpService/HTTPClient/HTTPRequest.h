@@ -21,6 +21,7 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 #include "../HTTPCommon/HTTPProxyConfig.h"
 #include "../HTTPCommon/Status.h"
 #include <boost/thread.hpp>
+#include <vector>
 
 #undef ERROR // windows...
 #undef Status // unix!
@@ -28,12 +29,50 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 typedef void CURL;
 
 namespace HTTP {
+    struct TransferState;
+
     class HTTPRequest : public boost::noncopyable {
         public:
+            // Chooses how a transfer is driven: a dedicated worker thread running a
+            // blocking curl_easy_perform (the default, one thread per request), or a
+            // shared curl multi event loop where all such requests ride one service
+            // thread and HTTP/1.1 connection reuse is handled by curl's own
+            // connection cache.  The multi engine is the one that scales past a few
+            // dozen concurrent transfers.
+            enum TransferEngine {
+                kThreadPerRequest = 0,
+                kCurlMulti
+            };
+
             static HTTPRequest* create();
+            static HTTPRequest* create(TransferEngine engine);
             static void setProxyConfig(const HTTPProxyConfig& cfg);
             static void registerCACert(const std::string& cert);
 
+            // Tunes the shared per-origin connection pool used by all requests:
+            // max concurrent connections per origin (0 = leave unchanged) and how
+            // long an idle kept-alive connection may be reused for.
+            static void setConnectionPoolLimits(unsigned int max_connections_per_host, unsigned int idle_timeout_seconds);
+
+            // Lets bursts of small same-origin requests on the kCurlMulti engine
+            // share connections instead of paying one round trip each: HTTP/1.1
+            // pipelining where the server allows it, upgraded to HTTP/2
+            // multiplexing when curl negotiates it.  max_pipeline_length caps the
+            // requests queued on one connection and max_host_connections caps
+            // parallel connections per origin (0 = curl's default for either).
+            // Has no effect on kThreadPerRequest transfers.
+            static void setSameOriginPipelining(bool enabled, unsigned int max_pipeline_length = 0,
+                                                unsigned int max_host_connections = 0);
+
+            // Warms connections to origins we expect to hit soon; call at plugin
+            // init with the origin list from config (e.g. "https://api.example.com").
+            // A background thread resolves DNS, opens TCP and completes the TLS
+            // handshake for each origin, then parks the handle in the shared
+            // connection pool, so the first real request rides a live connection
+            // instead of paying the setup round trips.  Purely an optimization:
+            // origins that fail to connect are silently skipped.
+            static void preconnect(const std::vector<std::string>& origins);
+
             // Fire off a request in a new thread and ignore the results with this.
             static void asyncStartRequest(boost::shared_ptr<HTTPRequestData> data);
 
@@ -57,17 +96,34 @@ namespace HTTP {
             // internal only below here
             int curl_progress(double dltotal, double dlnow, double ultotal, double ulnow);
             void curl_header(const char* data, size_t size);
+            void multiTransferDone(int curl_result); // completion dispatch from the multi engine thread
 
         protected:
 
-            HTTPRequest();
+            HTTPRequest(TransferEngine engine = kThreadPerRequest);
             void startRequest_thread();
+            void setup_transfer();
+            void finish_transfer(int curl_result);
+            void teardown_transfer();
             void killThread();
             void _internal_threadSafeDestroy();
 
             CURL* req;
+            std::string pool_key; // origin key the current handle was checked out under
+            TransferEngine engine;
             bool cancellation_requested;
 
+            // Set when the transfer has fully torn down.  With the multi engine the
+            // worker thread exits right after handing the handle off, so
+            // awaitCompletion() waits on this rather than on the thread.
+            boost::mutex completion_mutex;
+            boost::condition_variable completion_cond;
+            bool transfer_finished;
+
+            // Everything whose lifetime must span the transfer (form posts, header
+            // lists, read cursors); heap-held so it survives the builder thread
+            boost::shared_ptr<TransferState> transfer_state;
+
             Status last_status;
             callback_fn_t status_callback;
 
@@ -13,20 +13,137 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 \**********************************************************/
 
 #include "UploadQueue.h"
+#include "BandwidthScheduler.h"
 #include "HTTPRequest.h"
 #include "JSAPI.h"
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 #include "../HTTPCommon/Status.h"
+#include "../HTTPCommon/Tiger.h"
+#include "../HTTPCommon/TigerHashCache.h"
 #include "../HTTPCommon/Utils.h"
 #include "logging.h"
 
 using namespace HTTP;
 using namespace boost::algorithm;
 
+namespace {
+    bool entry_priority_greater(const UploadQueueEntry& a, const UploadQueueEntry& b) {
+        return a.priority > b.priority;
+    }
+
+    // Bodies at least this large negotiate Expect: 100-continue before sending;
+    // below it the extra round trip costs more than a doomed body would
+    const size_t kExpectContinueMinBytes = 64 * 1024;
+
+    // Process-wide per-chunk completion records, keyed by the file's Tiger hash.
+    // A re-dispatched upload of the same bytes finds its record here and resumes
+    // from the chunks already acknowledged instead of restarting from zero.
+    class ChunkCheckpointRegistry {
+    public:
+        static ChunkCheckpointRegistry& instance() {
+            static ChunkCheckpointRegistry registry;
+            return registry;
+        }
+        std::set<uint32_t> acked(const std::string& hash) {
+            boost::mutex::scoped_lock lock(mutex);
+            std::map<std::string, std::set<uint32_t> >::const_iterator it = records.find(hash);
+            return (it != records.end()) ? it->second : std::set<uint32_t>();
+        }
+        void markAcked(const std::string& hash, uint32_t chunk) {
+            boost::mutex::scoped_lock lock(mutex);
+            records[hash].insert(chunk);
+        }
+        void forget(const std::string& hash) {
+            boost::mutex::scoped_lock lock(mutex);
+            records.erase(hash);
+        }
+    private:
+        std::map<std::string, std::set<uint32_t> > records;
+        boost::mutex mutex;
+    };
+
+    // Read-only window over a slice of another datablock, so one chunk streams
+    // through the transport without the file ever being copied or re-read whole.
+    // Does not own the underlying block.
+    class DatablockSliceView : public HTTPDatablock {
+    public:
+        DatablockSliceView(const HTTPDatablock* _src, size_t _offset, size_t _len)
+            : src(_src), slice_offset(_offset), slice_len(_len) {}
+        virtual size_t size() const { return slice_len; }
+        virtual size_t read(size_t offset, char* dst, size_t len) const {
+            if (offset >= slice_len) return 0;
+            if (len > slice_len - offset) len = slice_len - offset;
+            return src->read(slice_offset + offset, dst, len);
+        }
+        virtual const char* data() const {
+            if (coalesced.empty() && slice_len) {
+                coalesced.resize(slice_len);
+                coalesced.resize(read(0, &coalesced[0], slice_len));
+            }
+            return coalesced.data();
+        }
+    private:
+        const HTTPDatablock* src;
+        size_t slice_offset;
+        size_t slice_len;
+        mutable std::string coalesced;
+    };
+
+    // Tiger-hash a datablock by streaming it through a fixed buffer
+    std::string tiger_hash_datablock(const HTTPDatablock* db) {
+        Tiger t;
+        std::vector<char> buf(64 * 1024);
+        size_t offset = 0, n;
+        while ((n = db->read(offset, &buf[0], buf.size())) > 0) {
+            t.process_bytes(&buf[0], n);
+            offset += n;
+        }
+        t.finalize();
+        return t.toString();
+    }
+
+    // Hash an entry's datablock, going through the persistent TigerHashCache when
+    // the datablock is plainly the file's raw bytes.  The size comparison is what
+    // establishes that: a lazy-transformed block (resized image, ...) won't match
+    // the on-disk size, and those always hash directly.
+    std::string tiger_hash_entry(const UploadQueueEntry* qe) {
+        boost::uint64_t size, inode;
+        std::time_t mtime;
+        std::string path = FB::wstring_to_utf8(qe->source_path);
+        if (! TigerHashCache::statFile(path, size, mtime, inode)
+            || size != qe->datablock->size()) {
+            return tiger_hash_datablock(qe->datablock);
+        }
+
+        std::string cached;
+        if (TigerHashCache::instance().lookup(path, size, mtime, inode, cached)) {
+            if (! TigerHashCache::instance().shouldVerify())
+                return cached;
+            // Sampled verification: re-hash anyway and catch an mtime that lied
+            std::string fresh = tiger_hash_datablock(qe->datablock);
+            if (fresh != cached) {
+#ifndef NDEBUG
+                FBLOG_WARN("UploadQueue", "Hash cache verification mismatch for "
+                    << path.c_str() << "; entry refreshed");
+#endif
+                TigerHashCache::instance().store(path, size, mtime, inode, fresh);
+            }
+            return fresh;
+        }
+
+        std::string fresh = tiger_hash_datablock(qe->datablock);
+        TigerHashCache::instance().store(path, size, mtime, inode, fresh);
+        return fresh;
+    }
+}
+
 UploadQueue::UploadQueue( const std::string& _name )
     : name(_name), status(UPLOAD_IDLE), current_queue_bytes(0), current_batch_bytes(0), total_queue_bytes(0),
     total_queue_files(0), files_waiting(0), current_upload_request(NULL), current_batch_retry(0),
-    batch_size(8), max_retries(3)
+    batch_size(8), max_retries(3), upload_priority(BandwidthScheduler::kDefaultPriority), rate_limit(0),
+    readahead_block_size(256 * 1024), chunk_size(0), pipeline_depth(4), dedup_enabled(false), chunk_entry(NULL), chunk_count(0),
+    dedup_request(NULL), chunks_deduped(0), chunk_retries(0), chunk_failed(false)
 {
 
 }
@@ -82,6 +199,16 @@ FB::VariantMap UploadQueue::getStatusDict(bool include_filenames) {
             current_batch_pct_complete = static_cast<double>(st.bytes_sent)
                 / static_cast<double>(st.send_total);
         }
+    } else if (chunk_size) {
+        boost::mutex::scoped_lock lock(chunk_mutex);
+        if (chunk_count) {
+            d["chunks_total"] = chunk_count;
+            d["chunks_acked"] = static_cast<uint32_t>(chunks_acked.size());
+            if (dedup_enabled)
+                d["chunks_deduped"] = chunks_deduped;
+            current_batch_pct_complete = static_cast<double>(chunks_acked.size())
+                / static_cast<double>(chunk_count);
+        }
     }
 
     d["current_batch_pct_complete"] = current_batch_pct_complete;
@@ -110,16 +237,28 @@ void UploadQueue::dispatch() {
 }
 
 void UploadQueue::start_next_upload() {
+    if (chunk_size) {
+        start_next_chunked_upload();
+        return;
+    }
+
     unsigned int files_started = 0;
 
     boost::shared_ptr<HTTPRequestData> data(new HTTPRequestData);
     data->method = "POST";
     data->cookies = cookies;
+    data->upload_priority = upload_priority;
+    data->upload_rate_cap = rate_limit;
+    data->readahead_block_size = readahead_block_size;
 
     current_upload_files.clear();
     current_batch_bytes = 0;
     current_batch_retry = 0;
 
+    // Batch high-priority entries first; the sort is stable, so equal-priority
+    // entries keep their submission order and still batch up by target
+    queue.sort(entry_priority_greater);
+
     for (std::list<UploadQueueEntry>::iterator it = queue.begin(); it != queue.end(); ++it) {
         if (it->status != UploadQueueEntry::ENTRY_WAITING) continue;
         try {
@@ -166,6 +305,10 @@ void UploadQueue::start_next_upload() {
     }
 
     if (files_started) {
+        // Large batches wait for the server's go-ahead before the body is sent,
+        // so an expired session or a full quota rejects cheaply
+        data->expect_continue = (current_batch_bytes >= kExpectContinueMinBytes);
+
         // We had enough images left in the queue for another request, so kick that off now.
         current_upload_request = HTTPRequest::create();
         current_upload_request->onStatusChanged(
@@ -186,39 +329,43 @@ void UploadQueue::start_next_upload() {
         FBLOG_DEBUG("UploadQueue",
             "start_next_upload() found no waiting files, running completion handlers\n");
 #endif
-        // All done, post upload finished callback to all instances
-        FB::VariantMap d = getEmptyProgressDict();
-        FB::VariantMap failures;
+        queue_complete();
+    }
+}
 
-        for (std::list<UploadQueueEntry>::iterator it = queue.begin(); it != queue.end(); ++it) {
-            if (it->status == UploadQueueEntry::ENTRY_ERROR) {
-                failures[FB::wstring_to_utf8(it->source_path)] = it->result;
+void UploadQueue::queue_complete() {
+    // All done, post upload finished callback to all instances
+    FB::VariantMap d = getEmptyProgressDict();
+    FB::VariantMap failures;
+
+    for (std::list<UploadQueueEntry>::iterator it = queue.begin(); it != queue.end(); ++it) {
+        if (it->status == UploadQueueEntry::ENTRY_ERROR) {
+            failures[FB::wstring_to_utf8(it->source_path)] = it->result;
 #ifndef NDEBUG
-                FBLOG_WARN("UploadQueue", "Reporting file \"" << it->source_path.c_str()
-                    << "\" as failed: " << it->result.c_str() << std::endl);
+            FBLOG_WARN("UploadQueue", "Reporting file \"" << it->source_path.c_str()
+                << "\" as failed: " << it->result.c_str() << std::endl);
 #endif        
-            }
-        }
-        queue.clear();
-
-        if (! failures.empty()) d["failed_files"] = failures;
-
-        d["status"] = "Complete";
-        status = UploadQueue::UPLOAD_COMPLETE;
-        // fire completion handlers, if available
-        for (std::list<FB::URI>::iterator it = completion_handlers.begin();
-            it != completion_handlers.end(); ++it) {
-            boost::shared_ptr<HTTPRequestData> reqdata(new HTTPRequestData(*it));
-            reqdata->cookies = cookies;
-            HTTPRequest::asyncStartRequest(reqdata);
         }
+    }
+    queue.clear();
+
+    if (! failures.empty()) d["failed_files"] = failures;
 
-        if (queue_finished_callback)
-            queue_finished_callback(shared_from_this());
-        
-        StatusUpdateEvent evt(d);
-        SendEvent(&evt);
+    d["status"] = "Complete";
+    status = UploadQueue::UPLOAD_COMPLETE;
+    // fire completion handlers, if available
+    for (std::list<FB::URI>::iterator it = completion_handlers.begin();
+        it != completion_handlers.end(); ++it) {
+        boost::shared_ptr<HTTPRequestData> reqdata(new HTTPRequestData(*it));
+        reqdata->cookies = cookies;
+        HTTPRequest::asyncStartRequest(reqdata);
     }
+
+    if (queue_finished_callback)
+        queue_finished_callback(shared_from_this());
+    
+    StatusUpdateEvent evt(d);
+    SendEvent(&evt);
 }
 
 void UploadQueue::upload_request_status_changed(const HTTP::Status &status) {
@@ -344,7 +491,277 @@ void UploadQueue::upload_request_status_changed(const HTTP::Status &status) {
     start_next_upload();
 }
 
+void UploadQueue::start_next_chunked_upload() {
+    boost::mutex::scoped_lock lock(chunk_mutex);
+
+    // Highest-priority entry first, as in the batch path
+    queue.sort(entry_priority_greater);
+
+    chunk_entry = NULL;
+    for (std::list<UploadQueueEntry>::iterator it = queue.begin(); it != queue.end(); ++it) {
+        if (it->status != UploadQueueEntry::ENTRY_WAITING) continue;
+        try {
+            it->datablock->resolve();
+            for (std::map<std::string, std::string>::iterator pvit = post_vars.begin();
+                pvit != post_vars.end(); ++pvit) {
+                it->target.query_data[pvit->first] = pvit->second;
+            }
+            it->setStatus(UploadQueueEntry::ENTRY_IN_PROGRESS);
+            --files_waiting;
+            current_queue_bytes -= it->filesize;
+            current_upload_files.clear();
+            current_upload_files.insert(it->source_path);
+            current_batch_bytes = it->filesize;
+            chunk_entry = &*it;
+            break;
+        } catch (const std::exception& e) {
+            it->result = e.what();
+            it->setStatus(UploadQueueEntry::ENTRY_ERROR);
+        }
+    }
+
+    if (! chunk_entry) {
+        lock.unlock();
+        queue_complete();
+        return;
+    }
+
+    // The Tiger hash keys this file's checkpoint record; identical bytes
+    // re-dispatched after a drop resume from the chunks already acknowledged.
+    // tiger_hash_entry consults the persistent hash cache first, so an
+    // unchanged file costs a stat instead of a full read.
+    chunk_file_hash = tiger_hash_entry(chunk_entry);
+    size_t total = chunk_entry->datablock->size();
+    chunk_count = total ? static_cast<uint32_t>((total + chunk_size - 1) / chunk_size) : 1;
+    chunks_acked = ChunkCheckpointRegistry::instance().acked(chunk_file_hash);
+    chunks_in_flight.clear();
+    chunk_requests.clear();
+    chunk_hashes.clear();
+    chunks_deduped = 0;
+    chunk_retries = 0;
+    chunk_failed = false;
+
+#ifndef NDEBUG
+    if (! chunks_acked.empty())
+        FBLOG_INFO("UploadQueue", "Resuming chunked upload: " << chunks_acked.size()
+            << " of " << chunk_count << " chunks already acknowledged");
+#endif
+
+    if (dedup_enabled) {
+        // Tiger leaf hash of every chunk, in index order; this doubles as the
+        // payload for the known-chunk query.  The chunks stream through the
+        // same slice views the uploads use, so the file is still never read
+        // into memory whole.
+        for (uint32_t i = 0; i < chunk_count; ++i) {
+            size_t offset = static_cast<size_t>(i) * chunk_size;
+            size_t len = (total - offset < chunk_size) ? (total - offset) : chunk_size;
+            DatablockSliceView slice(chunk_entry->datablock, offset, len);
+            chunk_hashes.push_back(tiger_hash_datablock(&slice));
+        }
+        start_dedup_check();
+        return;
+    }
+
+    launch_chunk_requests();
+}
+
+// requires chunk_mutex held
+void UploadQueue::start_dedup_check() {
+    std::string body;
+    for (size_t i = 0; i < chunk_hashes.size(); ++i) {
+        body += chunk_hashes[i];
+        body += "\n";
+    }
+
+    boost::shared_ptr<HTTPRequestData> data(new HTTPRequestData);
+    data->method = "POST";
+    data->cookies = cookies;
+    data->uri = dedup_check_uri;
+    data->headers.insert(std::make_pair("X-Upload-Hash", chunk_file_hash));
+    data->headers.insert(std::make_pair("X-Chunk-Count", boost::lexical_cast<std::string>(chunk_count)));
+    data->addFile("chunks", "chunks.txt", "text/plain", new HTTPStringDatablock(body));
+
+    dedup_request = HTTPRequest::create();
+    dedup_request->onStatusChanged(
+        bind(&UploadQueue::dedup_check_status_changed, this, dedup_request, _1)
+        );
+    dedup_request->startRequest(data);
+}
+
+void UploadQueue::dedup_check_status_changed(HTTPRequest* request, const HTTP::Status& status) {
+    if (status.state != HTTP::Status::COMPLETE && status.state != HTTP::Status::HTTP_ERROR)
+        return;
+
+    bool file_finished = false;
+    {
+        boost::mutex::scoped_lock lock(chunk_mutex);
+        // cancel() may have disowned the query already
+        if (dedup_request != request) return;
+        dedup_request = NULL;
+        if (! chunk_entry) return;
+
+        if (status.state == HTTP::Status::COMPLETE) {
+            // One known-chunk index per line; anything unparseable is skipped,
+            // which at worst re-uploads a chunk the server already had
+            HTTPDatablock* db = request->getResponse()->coalesceBlocks();
+            std::istringstream resp(std::string(db->data(), db->size()));
+            std::string line;
+            while (std::getline(resp, line)) {
+                trim(line);
+                if (line.empty()) continue;
+                try {
+                    uint32_t idx = boost::lexical_cast<uint32_t>(line);
+                    if (idx < chunk_count && ! chunks_acked.count(idx)) {
+                        chunks_acked.insert(idx);
+                        ++chunks_deduped;
+                    }
+                } catch (const boost::bad_lexical_cast&) { }
+            }
+#ifndef NDEBUG
+            if (chunks_deduped)
+                FBLOG_INFO("UploadQueue", "Dedup check: server already has "
+                    << chunks_deduped << " of " << chunk_count << " chunks");
+#endif
+        }
+        // On HTTP_ERROR nothing is marked and every chunk uploads; the dedup
+        // pass only ever costs its own round trip
+
+        // using threadSafeDestroy since we are likely on this request's own worker thread
+        request->threadSafeDestroy();
+        launch_chunk_requests();
+
+        if (chunk_requests.empty()) {
+            // Every chunk was already on the server
+            if (chunks_acked.size() >= chunk_count) {
+                chunk_entry->setStatus(UploadQueueEntry::ENTRY_COMPLETE);
+                ChunkCheckpointRegistry::instance().forget(chunk_file_hash);
+            }
+            chunk_entry = NULL;
+            file_finished = true;
+        }
+    }
+
+    sendUpdateEvent();
+    if (file_finished) start_next_upload();
+}
+
+// requires chunk_mutex held
+void UploadQueue::launch_chunk_requests() {
+    size_t total = chunk_entry->datablock->size();
+    uint32_t next = 0;
+    while (chunk_requests.size() < pipeline_depth && ! chunk_failed) {
+        // Lowest chunk not yet acknowledged or in flight
+        while (next < chunk_count
+            && (chunks_acked.count(next) || chunks_in_flight.count(next))) ++next;
+        if (next >= chunk_count) break;
+
+        size_t offset = static_cast<size_t>(next) * chunk_size;
+        size_t len = (total - offset < chunk_size) ? (total - offset) : chunk_size;
+
+        boost::shared_ptr<HTTPRequestData> data(new HTTPRequestData);
+        data->method = "POST";
+        data->cookies = cookies;
+        data->uri = chunk_entry->target;
+        data->upload_priority = upload_priority;
+        data->upload_rate_cap = rate_limit;
+        data->readahead_block_size = readahead_block_size;
+        data->headers.insert(std::make_pair("X-Upload-Hash", chunk_file_hash));
+        data->headers.insert(std::make_pair("X-Upload-Total-Size", boost::lexical_cast<std::string>(total)));
+        data->headers.insert(std::make_pair("X-Chunk-Index", boost::lexical_cast<std::string>(next)));
+        data->headers.insert(std::make_pair("X-Chunk-Count", boost::lexical_cast<std::string>(chunk_count)));
+        data->headers.insert(std::make_pair("X-Chunk-Offset", boost::lexical_cast<std::string>(offset)));
+        if (next < chunk_hashes.size())
+            data->headers.insert(std::make_pair("X-Chunk-Tiger", chunk_hashes[next]));
+        data->addFile("chunk", FB::wstring_to_utf8(chunk_entry->filename),
+            "application/octet-stream", new DatablockSliceView(chunk_entry->datablock, offset, len));
+        data->expect_continue = (len >= kExpectContinueMinBytes);
+
+        HTTPRequest* request = HTTPRequest::create();
+        chunk_requests[request] = next;
+        chunks_in_flight.insert(next);
+        request->onStatusChanged(
+            bind(&UploadQueue::chunk_request_status_changed, this, next, request, _1)
+            );
+        request->startRequest(data);
+    }
+}
+
+void UploadQueue::chunk_request_status_changed(uint32_t chunk_index, HTTPRequest* request,
+                                               const HTTP::Status& status) {
+    if (status.state != HTTP::Status::COMPLETE && status.state != HTTP::Status::HTTP_ERROR) {
+        sendUpdateEvent();
+        return;
+    }
+
+    bool file_finished = false;
+    {
+        boost::mutex::scoped_lock lock(chunk_mutex);
+        // cancel() may have taken ownership of the outstanding requests already
+        if (! chunk_requests.count(request)) return;
+        chunk_requests.erase(request);
+        chunks_in_flight.erase(chunk_index);
+
+        if (status.state == HTTP::Status::COMPLETE) {
+            chunk_retries = 0;
+            chunks_acked.insert(chunk_index);
+            ChunkCheckpointRegistry::instance().markAcked(chunk_file_hash, chunk_index);
+        } else if ((++chunk_retries) >= max_retries) {
+            // Give up on the file but keep its checkpoint record: the acked
+            // chunks survive for the next dispatch of the same bytes
+            chunk_failed = true;
+            chunk_entry->onFailure(status.last_error);
+            FB::VariantMap err;
+            err["status"] = "Failed";
+            err["retries_remaining"] = 0;
+            err["message"] = status.last_error;
+            UploadErrorEvent evt(err);
+            SendEvent(&evt);
+        }
+        // On a retryable failure the chunk is simply no longer acked or in
+        // flight, so the relaunch below picks it up again
+
+        // using threadSafeDestroy since we are likely on this request's own worker thread
+        request->threadSafeDestroy();
+        launch_chunk_requests();
+
+        if (chunk_requests.empty()) {
+            if (! chunk_failed && chunks_acked.size() >= chunk_count) {
+                chunk_entry->setStatus(UploadQueueEntry::ENTRY_COMPLETE);
+                ChunkCheckpointRegistry::instance().forget(chunk_file_hash);
+            }
+            chunk_entry = NULL;
+            file_finished = true;
+        }
+    }
+
+    sendUpdateEvent();
+    if (file_finished) start_next_upload();
+}
+
 void UploadQueue::cancel() {
+    {
+        std::map<HTTPRequest*, uint32_t> outstanding;
+        HTTPRequest* dedup_outstanding = NULL;
+        {
+            boost::mutex::scoped_lock lock(chunk_mutex);
+            outstanding.swap(chunk_requests);
+            chunks_in_flight.clear();
+            dedup_outstanding = dedup_request;
+            dedup_request = NULL;
+            chunk_failed = true;
+            chunk_entry = NULL;
+        }
+        for (std::map<HTTPRequest*, uint32_t>::iterator it = outstanding.begin();
+            it != outstanding.end(); ++it) {
+            it->first->cancel();
+            it->first->threadSafeDestroy();
+        }
+        if (dedup_outstanding) {
+            dedup_outstanding->cancel();
+            dedup_outstanding->threadSafeDestroy();
+        }
+    }
+
     if (current_upload_request) {
         HTTPRequest* r = current_upload_request;
         current_upload_request = NULL;
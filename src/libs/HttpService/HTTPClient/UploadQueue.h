@@ -17,6 +17,9 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 #define UploadQueue_h__
 
 #include <list>
+#include <set>
+#include <vector>
+#include <boost/thread/mutex.hpp>
 #include "URI.h"
 #include "UploadQueueEntry.h"
 #include "PluginEventSource.h"
@@ -94,10 +97,58 @@ namespace HTTP {
         std::list<FB::URI> completion_handlers;
         unsigned int batch_size;
         unsigned int max_retries;
+        // Bandwidth scheduling (see BandwidthScheduler): this queue's weight when
+        // the shared upload cap is split between concurrent queues, and an optional
+        // cap in bytes/second on this queue alone (0 = only the shared cap applies)
+        unsigned int upload_priority;
+        size_t rate_limit;
+        // Block size for double-buffered file reads during upload: the request
+        // layer prefetches the next block of this many bytes while the current
+        // one transmits, so disk and network overlap (0 = read synchronously).
+        // Matters most for spinning-disk and network-share sources.
+        size_t readahead_block_size;
+        // Resumable chunked mode: when chunk_size is nonzero, files upload one at a
+        // time as a series of chunk POSTs instead of whole-file batches.  Completion
+        // of each chunk is checkpointed against the file's Tiger hash, so a
+        // re-dispatched upload of the same bytes resumes from the last acknowledged
+        // chunk.  pipeline_depth chunk requests are kept in flight to cover the
+        // per-request round trip.
+        size_t chunk_size;
+        unsigned int pipeline_depth;
+        // Chunk deduplication (chunked mode only): before uploading a file, the
+        // queue POSTs the Tiger leaf hash of every chunk to dedup_check_uri; the
+        // server answers with the indices of chunks it already stores (one per
+        // line) and those are marked acknowledged without being sent.  Each chunk
+        // POST then carries its leaf hash in X-Chunk-Tiger so the server can
+        // index what it stores.  A failed or malformed check just means
+        // everything uploads -- dedup is never allowed to fail a file.
+        bool dedup_enabled;
+        FB::URI dedup_check_uri;
     protected:
         void sendUpdateEvent();
         void start_next_upload();
+        void queue_complete();
         void upload_request_status_changed(const HTTP::Status& status);
+
+        // chunked mode (all state below is guarded by chunk_mutex)
+        void start_next_chunked_upload();
+        void launch_chunk_requests();
+        void chunk_request_status_changed(uint32_t chunk_index, HTTPRequest* request, const HTTP::Status& status);
+        void start_dedup_check();
+        void dedup_check_status_changed(HTTPRequest* request, const HTTP::Status& status);
+
+        boost::mutex chunk_mutex;
+        UploadQueueEntry* chunk_entry;  // entry currently uploading in chunks
+        std::string chunk_file_hash;
+        uint32_t chunk_count;
+        std::vector<std::string> chunk_hashes;  // Tiger leaf hash per chunk, in index order
+        HTTPRequest* dedup_request;             // outstanding known-chunk query, if any
+        uint32_t chunks_deduped;                // chunks the server already had this file
+        std::set<uint32_t> chunks_acked;
+        std::set<uint32_t> chunks_in_flight;
+        std::map<HTTPRequest*, uint32_t> chunk_requests;
+        unsigned int chunk_retries;     // consecutive failures; reset on each ack
+        bool chunk_failed;
     };
 };
 #endif // UploadQueue_h__
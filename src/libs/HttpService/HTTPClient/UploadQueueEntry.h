@@ -29,6 +29,10 @@ namespace HTTP {
     
         uint32_t filesize; // given that the datablock can be an ImageDatablock which is lazy-evaluated, this might
         // not be an accurate size. It's just for guessing when the queue will be finished, anyway...
+
+        // Higher-priority entries are picked for upload batches first; entries with
+        // equal priority keep the order they were added in
+        unsigned int priority;
     
         // non-indexed variables, mutable for convenience
         mutable std::string result;
@@ -44,7 +48,7 @@ namespace HTTP {
         void setStatus(Status _st) { status = _st; }
         void onFailure(const std::string& errmsg) { status = ENTRY_ERROR; result = errmsg; }
     
-        UploadQueueEntry() : status(ENTRY_WAITING) {}
+        UploadQueueEntry() : priority(10), status(ENTRY_WAITING) {}
     };
 };
 
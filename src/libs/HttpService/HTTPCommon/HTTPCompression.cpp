@@ -0,0 +1,168 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <list>
+#include <map>
+#include <vector>
+#include <zlib.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include "Tiger.h"
+
+#include "HTTPCompression.h"
+
+using namespace HTTP;
+
+namespace {
+    const size_t k_COMPRESS_CHUNK = 64 * 1024;
+    // Only responses this small are cache candidates; status JSON is a few KB,
+    // while anything big enough to matter is unlikely to repeat byte-for-byte
+    const size_t k_CACHE_MAX_BODY = 256 * 1024;
+    const size_t k_CACHE_MAX_ENTRIES = 16;
+
+    typedef boost::shared_ptr<std::vector<std::string> > CompressedChunksPtr;
+
+    boost::mutex cache_mutex;
+    std::map<std::string, CompressedChunksPtr> chunk_cache;
+    std::list<std::string> cache_order; // FIFO eviction
+
+    CompressedChunksPtr cache_lookup(const std::string& key) {
+        boost::mutex::scoped_lock _l(cache_mutex);
+        std::map<std::string, CompressedChunksPtr>::iterator it = chunk_cache.find(key);
+        return it == chunk_cache.end() ? CompressedChunksPtr() : it->second;
+    }
+
+    void cache_store(const std::string& key, const CompressedChunksPtr& chunks) {
+        boost::mutex::scoped_lock _l(cache_mutex);
+        if (chunk_cache.count(key)) return;
+        if (chunk_cache.size() >= k_CACHE_MAX_ENTRIES) {
+            chunk_cache.erase(cache_order.front());
+            cache_order.pop_front();
+        }
+        chunk_cache[key] = chunks;
+        cache_order.push_back(key);
+    }
+
+    // Streams every segment of every block through deflate; the uncompressed body is
+    // never concatenated and compressed output accumulates a chunk at a time
+    bool deflate_blocks(const std::list<HTTPDatablock*>& blocks, const std::string& encoding,
+                        std::vector<std::string>& chunks) {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        int window_bits = (encoding == "gzip") ? 15 + 16 : 15; // +16 selects the gzip wrapper
+        if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            return false;
+
+        std::vector<char> out(k_COMPRESS_CHUNK);
+        bool ok = true;
+        for (std::list<HTTPDatablock*>::const_iterator it = blocks.begin(); ok && it != blocks.end(); ++it) {
+            size_t segs = (*it)->segmentCount();
+            for (size_t i = 0; ok && i < segs; ++i) {
+                const char* seg_data;
+                size_t seg_len;
+                (*it)->getSegment(i, seg_data, seg_len);
+                zs.next_in = (Bytef*)const_cast<char*>(seg_data);
+                zs.avail_in = seg_len;
+                while (ok && zs.avail_in) {
+                    zs.next_out = (Bytef*)&out[0];
+                    zs.avail_out = out.size();
+                    if (deflate(&zs, Z_NO_FLUSH) != Z_OK) ok = false;
+                    else if (out.size() != zs.avail_out) chunks.push_back(std::string(&out[0], out.size() - zs.avail_out));
+                }
+            }
+        }
+        while (ok) {
+            zs.next_out = (Bytef*)&out[0];
+            zs.avail_out = out.size();
+            int rc = deflate(&zs, Z_FINISH);
+            if (rc != Z_OK && rc != Z_STREAM_END) ok = false;
+            else {
+                if (out.size() != zs.avail_out) chunks.push_back(std::string(&out[0], out.size() - zs.avail_out));
+                if (rc == Z_STREAM_END) break;
+            }
+        }
+        deflateEnd(&zs);
+        return ok;
+    }
+
+    std::string content_hash_key(const std::list<HTTPDatablock*>& blocks, const std::string& encoding) {
+        Tiger hash;
+        for (std::list<HTTPDatablock*>::const_iterator it = blocks.begin(); it != blocks.end(); ++it) {
+            size_t segs = (*it)->segmentCount();
+            for (size_t i = 0; i < segs; ++i) {
+                const char* seg_data;
+                size_t seg_len;
+                (*it)->getSegment(i, seg_data, seg_len);
+                hash.process_bytes(seg_data, seg_len);
+            }
+        }
+        hash.finalize();
+        return std::string(hash.hash_data(), hash.hash_size()) + ":" + encoding;
+    }
+}
+
+std::string HTTP::choose_content_encoding(const std::string& accept_encoding) {
+    std::vector<std::string> tokens;
+    boost::algorithm::split(tokens, accept_encoding, boost::algorithm::is_any_of(","));
+    bool deflate_ok = false;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        std::string t = tokens[i].substr(0, tokens[i].find(';')); // drop any q-value
+        boost::algorithm::trim(t);
+        if (boost::algorithm::iequals(t, "gzip")) return "gzip";
+        if (boost::algorithm::iequals(t, "deflate")) deflate_ok = true;
+    }
+    return deflate_ok ? "deflate" : std::string();
+}
+
+bool HTTP::compress_response_blocks(HTTPResponseData* resp, const std::string& encoding) {
+    size_t total = 0;
+    for (std::list<HTTPDatablock*>::const_iterator it = resp->data.begin(); it != resp->data.end(); ++it) {
+        total += (*it)->size();
+    }
+    if (! total) return false;
+
+    bool cacheable = total <= k_CACHE_MAX_BODY;
+    std::string key;
+    CompressedChunksPtr chunks;
+    if (cacheable) {
+        key = content_hash_key(resp->data, encoding);
+        chunks = cache_lookup(key);
+    }
+
+    if (! chunks) {
+        chunks = CompressedChunksPtr(new std::vector<std::string>);
+        if (! deflate_blocks(resp->data, encoding, *chunks)) return false;
+
+        size_t compressed_total = 0;
+        for (size_t i = 0; i < chunks->size(); ++i) compressed_total += (*chunks)[i].size();
+        if (compressed_total >= total) return false; // incompressible; send as-is
+
+        if (cacheable) cache_store(key, chunks);
+    }
+
+    for (std::list<HTTPDatablock*>::iterator it = resp->data.begin(); it != resp->data.end(); ++it) {
+        delete *it;
+    }
+    resp->data.clear();
+    for (size_t i = 0; i < chunks->size(); ++i) {
+        resp->data.push_back(new HTTPStringDatablock((*chunks)[i]));
+    }
+
+    resp->headers.erase("Content-Encoding");
+    resp->headers.insert(std::make_pair("Content-Encoding", encoding));
+    resp->headers.erase("Vary");
+    resp->headers.insert(std::make_pair("Vary", "Accept-Encoding"));
+    return true;
+}
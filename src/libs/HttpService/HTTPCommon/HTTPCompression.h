@@ -0,0 +1,39 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_HTTP_HTTPCOMPRESSION
+#define H_HTTP_HTTPCOMPRESSION
+
+#include <string>
+#include "HTTPResponseData.h"
+
+namespace HTTP {
+
+    /// Picks the content encoding to use from an Accept-Encoding header value;
+    /// returns "gzip", "deflate", or an empty string when neither is acceptable.
+    std::string choose_content_encoding(const std::string& accept_encoding);
+
+    /// Replaces resp's body blocks with a compressed chain and adds the
+    /// Content-Encoding header.  The body is streamed through zlib a segment at a
+    /// time -- it is never concatenated -- and the compressed output lands in a
+    /// series of chunk-sized blocks.  Small responses are cached keyed by content
+    /// hash, so a page polling the same JSON status repeatedly only pays for
+    /// deflate once.  Returns false (resp untouched) if compression fails or
+    /// wouldn't shrink the body.
+    bool compress_response_blocks(HTTPResponseData* resp, const std::string& encoding);
+
+};
+
+#endif // H_HTTP_HTTPCOMPRESSION
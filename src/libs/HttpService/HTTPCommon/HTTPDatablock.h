@@ -16,14 +16,48 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 #ifndef H_HTTP_HTTPDATABLOCK
 #define H_HTTP_HTTPDATABLOCK
 #include <string>
+#include <string.h>
+#include <vector>
 
 namespace HTTP {
+#ifdef _WIN32
+    typedef void* filehandle_t; // HANDLE
+    const filehandle_t kInvalidFileHandle = 0;
+#else
+    typedef int filehandle_t;
+    const filehandle_t kInvalidFileHandle = -1;
+#endif
+
     class HTTPDatablock {
     public:
         virtual ~HTTPDatablock() {}
         virtual size_t size() const = 0;
         virtual const char* data() const = 0;
         virtual void resolve() const {}
+
+        // Returns the platform file handle when this block's bytes are exactly the
+        // contents of an open disk file, so senders can use kernel zero-copy paths
+        // (sendfile/TransmitFile); kInvalidFileHandle otherwise.
+        virtual filehandle_t backingFile() const { return kInvalidFileHandle; }
+
+        // Scatter view: a block is one or more contiguous segments.  Senders that can
+        // do vectored or incremental I/O should iterate segments (or use read()) instead
+        // of data(), which may have to materialize a chained block contiguously.
+        virtual size_t segmentCount() const { return 1; }
+        virtual void getSegment(size_t idx, const char*& seg_data, size_t& seg_len) const {
+            seg_data = data();
+            seg_len = size();
+        }
+
+        // Copies up to 'len' bytes starting at 'offset' into dst; returns bytes copied.
+        // The default serves from data(); chained blocks override to walk segments.
+        virtual size_t read(size_t offset, char* dst, size_t len) const {
+            size_t total = size();
+            if (offset >= total) return 0;
+            if (len > total - offset) len = total - offset;
+            memcpy(dst, data() + offset, len);
+            return len;
+        }
     };
 
     class HTTPStringDatablock : public HTTPDatablock {
@@ -37,6 +71,84 @@ namespace HTTP {
     protected:
         std::string str;
     };
+
+    // A chain of datablocks sent as one logical block (multipart header -> file-backed
+    // content -> boundary, etc).  Senders walking segments or read() never see the body
+    // contiguously, so a large upload is never materialized in memory; data() exists
+    // only as a compatibility fallback and coalesces the chain on first use.
+    class HTTPChainDatablock : public HTTPDatablock {
+    public:
+        HTTPChainDatablock() {}
+        virtual ~HTTPChainDatablock() {
+            for (size_t i = 0; i < blocks.size(); ++i) delete blocks[i];
+        }
+
+        // Takes ownership of the appended block
+        void append(HTTPDatablock* block) {
+            blocks.push_back(block);
+            coalesced.clear();
+        }
+        void appendString(const std::string& str) {
+            append(new HTTPStringDatablock(str));
+        }
+
+        virtual size_t size() const {
+            size_t total = 0;
+            for (size_t i = 0; i < blocks.size(); ++i) total += blocks[i]->size();
+            return total;
+        }
+
+        virtual void resolve() const {
+            for (size_t i = 0; i < blocks.size(); ++i) blocks[i]->resolve();
+        }
+
+        virtual size_t segmentCount() const {
+            size_t count = 0;
+            for (size_t i = 0; i < blocks.size(); ++i) count += blocks[i]->segmentCount();
+            return count;
+        }
+
+        virtual void getSegment(size_t idx, const char*& seg_data, size_t& seg_len) const {
+            for (size_t i = 0; i < blocks.size(); ++i) {
+                size_t n = blocks[i]->segmentCount();
+                if (idx < n) {
+                    blocks[i]->getSegment(idx, seg_data, seg_len);
+                    return;
+                }
+                idx -= n;
+            }
+            seg_data = NULL;
+            seg_len = 0;
+        }
+
+        virtual size_t read(size_t offset, char* dst, size_t len) const {
+            size_t copied = 0;
+            for (size_t i = 0; i < blocks.size() && copied < len; ++i) {
+                size_t bsize = blocks[i]->size();
+                if (offset < bsize) {
+                    copied += blocks[i]->read(offset, dst + copied, len - copied);
+                    offset = 0;
+                } else {
+                    offset -= bsize;
+                }
+            }
+            return copied;
+        }
+
+        virtual const char* data() const {
+            if (coalesced.empty() && size()) {
+                coalesced.reserve(size());
+                for (size_t i = 0; i < blocks.size(); ++i) {
+                    coalesced.append(blocks[i]->data(), blocks[i]->size());
+                }
+            }
+            return coalesced.data();
+        }
+
+    protected:
+        std::vector<HTTPDatablock*> blocks;
+        mutable std::string coalesced;
+    };
 };
 
 #endif
@@ -26,6 +26,9 @@ namespace HTTP {
       std::string filename;
       std::string content_type;
       HTTPDatablock* contents;
+      // Tiger tree root of the uploaded bytes, filled in as the upload streams
+      // when HTTPRequestData::hash_uploads is set; empty otherwise
+      std::string tiger_tree_hash;
     };
 };
 
@@ -16,7 +16,9 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 
 using namespace HTTP;
 
-HTTPRequestData::HTTPRequestData(const FB::URI& in_uri, const std::string& in_method) : uri(in_uri), method(in_method) {
+HTTPRequestData::HTTPRequestData(const FB::URI& in_uri, const std::string& in_method)
+  : uri(in_uri), method(in_method), upload_priority(10), upload_rate_cap(0), hash_uploads(false),
+    expect_continue(false), accept_compressed(false), readahead_block_size(0) {
   if (method.empty()) method = uri.query_data.size() ? "POST" : "GET";
 }
 
@@ -28,7 +28,8 @@ namespace HTTP {
     class HTTPRequestData {
     public:
         friend class HTTPRequest;
-        HTTPRequestData() {}
+        HTTPRequestData() : upload_priority(10), upload_rate_cap(0), hash_uploads(false), expect_continue(false),
+            accept_compressed(false), readahead_block_size(0) {}
         HTTPRequestData(const FB::URI& in_uri, const std::string& in_method = std::string());
         ~HTTPRequestData();
 
@@ -38,6 +39,37 @@ namespace HTTP {
         std::map<std::string, std::string> cookies;
         std::map<std::string, HTTPFileEntry> files;
 
+        // Bandwidth scheduling for uploads (see BandwidthScheduler): weight of
+        // this transfer when the shared cap is split, and an optional cap in
+        // bytes/second on this transfer alone (0 = only the shared cap applies)
+        unsigned int upload_priority;
+        size_t upload_rate_cap;
+
+        // When set, each uploaded file is tiger-tree-hashed as its bytes stream
+        // out; the roots land in files[...].tiger_tree_hash on completion, so no
+        // separate hashing pass re-reads the data
+        bool hash_uploads;
+
+        // When set, large POST bodies are sent with Expect: 100-continue so the
+        // server can reject the request (auth expiry, quota) before the body is
+        // transmitted.  Off by default: FireBreath normally strips the Expect
+        // header because old proxies answer it with 417.  A short fallback timer
+        // sends the body anyway when the server never answers the expectation.
+        bool expect_continue;
+
+        // When set, the transfer advertises Accept-Encoding: gzip, deflate and a
+        // compressed response body is inflated as it streams in, so the response
+        // datablocks always hold the decoded bytes.  Off by default so existing
+        // callers that inspect Content-Length keep seeing what came off the wire.
+        bool accept_compressed;
+
+        // When nonzero, each uploaded file part larger than one block streams
+        // through a double-buffered prefetcher: a background thread reads block
+        // N+1 (of this many bytes) while curl transmits block N, overlapping
+        // disk and network instead of alternating between them.  0 (the
+        // default) reads synchronously from the datablock as before.
+        size_t readahead_block_size;
+
         void addFile(const std::string& fieldname, const std::string& filename, const std::string& content_type, HTTPDatablock* contents);
     };
 
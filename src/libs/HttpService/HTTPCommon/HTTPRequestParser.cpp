@@ -0,0 +1,122 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <string.h>
+#include <ctype.h>
+
+#include "HTTPRequestParser.h"
+
+using namespace HTTP;
+
+void HTTPRequestParser::reset() {
+    base = NULL;
+    scan_pos = 0;
+    line_start = 0;
+    block_size = 0;
+    saw_request_line = false;
+    request_line_valid = false;
+    complete = false;
+    method_tok.off = method_tok.len = 0;
+    target_tok.off = target_tok.len = 0;
+    version_tok.off = version_tok.len = 0;
+    fields.clear();
+}
+
+bool HTTPRequestParser::parse(const char* data, size_t len) {
+    base = data;
+    while (! complete) {
+        const char* eol = static_cast<const char*>(memchr(data + scan_pos, '\n', len - scan_pos));
+        if (! eol) {
+            scan_pos = len;
+            return false; // need more bytes; resume here next call
+        }
+        size_t eol_off = eol - data;
+        size_t line_len = eol_off - line_start;
+        if (line_len && data[line_start + line_len - 1] == '\r') --line_len;
+
+        if (! line_len) {
+            complete = true;
+            block_size = eol_off + 1;
+        } else if (! saw_request_line) {
+            parseRequestLine(line_start, line_len);
+            saw_request_line = true;
+        } else {
+            parseFieldLine(line_start, line_len);
+        }
+        line_start = scan_pos = eol_off + 1;
+    }
+    return true;
+}
+
+void HTTPRequestParser::parseRequestLine(size_t off, size_t len) {
+    // Expect exactly "METHOD SP target SP version", same strictness as the old
+    // three-way split
+    const char* sp1 = static_cast<const char*>(memchr(base + off, ' ', len));
+    if (! sp1) return;
+    size_t sp1_off = sp1 - base;
+    const char* sp2 = static_cast<const char*>(memchr(sp1 + 1, ' ', off + len - sp1_off - 1));
+    if (! sp2) return;
+    size_t sp2_off = sp2 - base;
+    if (memchr(sp2 + 1, ' ', off + len - sp2_off - 1)) return; // a fourth part
+    if (sp1_off == off || sp2_off == sp1_off + 1 || sp2_off + 1 == off + len) return; // empty part
+
+    method_tok.off = off;
+    method_tok.len = sp1_off - off;
+    target_tok.off = sp1_off + 1;
+    target_tok.len = sp2_off - target_tok.off;
+    version_tok.off = sp2_off + 1;
+    version_tok.len = off + len - version_tok.off;
+    request_line_valid = true;
+}
+
+void HTTPRequestParser::parseFieldLine(size_t off, size_t len) {
+    const char* colon = static_cast<const char*>(memchr(base + off, ':', len));
+    if (! colon) return; // tolerated and skipped, like the old line parser
+    size_t colon_off = colon - base;
+
+    FieldView f;
+    f.key.off = off;
+    f.key.len = colon_off - off;
+    while (f.key.len && isspace((unsigned char)base[f.key.off + f.key.len - 1])) --f.key.len;
+
+    f.value.off = colon_off + 1;
+    f.value.len = off + len - f.value.off;
+    while (f.value.len && isspace((unsigned char)base[f.value.off])) {
+        ++f.value.off;
+        --f.value.len;
+    }
+    while (f.value.len && isspace((unsigned char)base[f.value.off + f.value.len - 1])) --f.value.len;
+
+    fields.push_back(f);
+}
+
+std::string HTTPRequestParser::findHeader(const char* name) const {
+    size_t name_len = strlen(name);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (fields[i].key.len != name_len) continue;
+        const char* key = base + fields[i].key.off;
+        size_t j = 0;
+        for (; j < name_len; ++j) {
+            if (tolower((unsigned char)key[j]) != tolower((unsigned char)name[j])) break;
+        }
+        if (j == name_len) return str(fields[i].value);
+    }
+    return std::string();
+}
+
+void HTTPRequestParser::populateHeaders(std::multimap<std::string, std::string>& headers) const {
+    for (size_t i = 0; i < fields.size(); ++i) {
+        headers.insert(std::make_pair(str(fields[i].key), str(fields[i].value)));
+    }
+}
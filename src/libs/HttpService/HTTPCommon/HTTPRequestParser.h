@@ -0,0 +1,94 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_HTTP_HTTPREQUESTPARSER
+#define H_HTTP_HTTPREQUESTPARSER
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace HTTP {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  HTTPRequestParser
+    ///
+    /// @brief  Incremental in-place HTTP request-header parser
+    ///
+    /// Scans the receive buffer where it sits and records every token as an offset/length
+    /// view, so parsing a request allocates nothing beyond the (reused) view vector;
+    /// strings are only materialized by the accessors.  parse() may be called repeatedly
+    /// with the same logical buffer as more bytes arrive -- it resumes at the first
+    /// unscanned line, and offsets stay valid even if the buffer reallocates.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class HTTPRequestParser {
+    public:
+        HTTPRequestParser() { reset(); }
+
+        void reset();
+
+        /// Scans [data, data+len).  Returns true once the blank line ending the header
+        /// block has been seen; false means more bytes are needed.
+        bool parse(const char* data, size_t len);
+
+        /// True when the header block is complete and the request line was well-formed
+        bool valid() const { return complete && request_line_valid; }
+        /// Bytes of the buffer covered by the header block, including the blank line
+        size_t headerBlockSize() const { return block_size; }
+
+        std::string method() const { return str(method_tok); }
+        std::string target() const { return str(target_tok); }
+        std::string version() const { return str(version_tok); }
+
+        size_t headerCount() const { return fields.size(); }
+        std::string headerName(size_t idx) const { return str(fields[idx].key); }
+        std::string headerValue(size_t idx) const { return str(fields[idx].value); }
+
+        /// Case-insensitive lookup without materializing any non-matching header
+        std::string findHeader(const char* name) const;
+
+        /// Materializes all headers into the multimap used by HTTPRequestData
+        void populateHeaders(std::multimap<std::string, std::string>& headers) const;
+
+    protected:
+        struct TokenView {
+            size_t off;
+            size_t len;
+        };
+        struct FieldView {
+            TokenView key;
+            TokenView value;
+        };
+
+        std::string str(const TokenView& t) const { return std::string(base + t.off, t.len); }
+        void parseRequestLine(size_t off, size_t len);
+        void parseFieldLine(size_t off, size_t len);
+
+        const char* base;       // buffer of the most recent parse() call
+        size_t scan_pos;        // first byte not yet scanned
+        size_t line_start;
+        size_t block_size;
+        bool saw_request_line;
+        bool request_line_valid;
+        bool complete;
+        TokenView method_tok;
+        TokenView target_tok;
+        TokenView version_tok;
+        std::vector<FieldView> fields;
+    };
+
+};
+
+#endif // H_HTTP_HTTPREQUESTPARSER
@@ -518,3 +518,137 @@ const uint64_t Tiger::table[1024] = {
     0xCD56D9430EA8280ELL   /* 1020 */,    0xC12591D7535F5065LL   /* 1021 */,
     0xC83223F1720AEF96LL   /* 1022 */,    0xC3A0396F7363A51FLL   /* 1023 */};
 
+
+/*
+ * Dual-lane compression for tree hashing.
+ *
+ * Each Tiger round is a chain of data-dependent S-box lookups, so a single block
+ * can't be spread across SSE2/AVX2 lanes; the indices aren't known until the
+ * previous round retires.  Independent leaves have independent chains though, so
+ * interleaving the rounds of two blocks lets the out-of-order core run both
+ * chains at once, which is where the "parallel lanes" throughput actually comes
+ * from on this function.
+ */
+void Tiger::tiger_compress_pair(const uint64_t* str1, uint64_t* state1,
+                                const uint64_t* str2, uint64_t* state2)
+{
+    register uint64_t a1, b1, c1, tmpa1;
+    register uint64_t a2, b2, c2, tmpa2;
+    uint64_t aa1, bb1, cc1;
+    uint64_t aa2, bb2, cc2;
+    uint64_t x01, x11, x21, x31, x41, x51, x61, x71;
+    uint64_t x02, x12, x22, x32, x42, x52, x62, x72;
+    int pass_no;
+
+    a1 = state1[0]; b1 = state1[1]; c1 = state1[2];
+    a2 = state2[0]; b2 = state2[1]; c2 = state2[2];
+
+    x01=str1[0]; x11=str1[1]; x21=str1[2]; x31=str1[3];
+    x41=str1[4]; x51=str1[5]; x61=str1[6]; x71=str1[7];
+    x02=str2[0]; x12=str2[1]; x22=str2[2]; x32=str2[3];
+    x42=str2[4]; x52=str2[5]; x62=str2[6]; x72=str2[7];
+
+    aa1 = a1; bb1 = b1; cc1 = c1;
+    aa2 = a2; bb2 = b2; cc2 = c2;
+
+    for(pass_no=0; pass_no<3; pass_no++) {
+      if(pass_no != 0) {
+        x01 -= x71 ^ 0xA5A5A5A5A5A5A5A5LL;
+        x02 -= x72 ^ 0xA5A5A5A5A5A5A5A5LL;
+        x11 ^= x01;
+        x12 ^= x02;
+        x21 += x11;
+        x22 += x12;
+        x31 -= x21 ^ ((~x11)<<19);
+        x32 -= x22 ^ ((~x12)<<19);
+        x41 ^= x31;
+        x42 ^= x32;
+        x51 += x41;
+        x52 += x42;
+        x61 -= x51 ^ ((~x41)>>23);
+        x62 -= x52 ^ ((~x42)>>23);
+        x71 ^= x61;
+        x72 ^= x62;
+        x01 += x71;
+        x02 += x72;
+        x11 -= x01 ^ ((~x71)<<19);
+        x12 -= x02 ^ ((~x72)<<19);
+        x21 ^= x11;
+        x22 ^= x12;
+        x31 += x21;
+        x32 += x22;
+        x41 -= x31 ^ ((~x21)>>23);
+        x42 -= x32 ^ ((~x22)>>23);
+        x51 ^= x41;
+        x52 ^= x42;
+        x61 += x51;
+        x62 += x52;
+        x71 -= x61 ^ 0x0123456789ABCDEFLL;
+        x72 -= x62 ^ 0x0123456789ABCDEFLL;
+      }
+
+      uint64_t mul = (pass_no==0?5:pass_no==1?7:9);
+
+      __tiger_round(a1,b1,c1,x01,mul)
+      __tiger_round(a2,b2,c2,x02,mul)
+      __tiger_round(b1,c1,a1,x11,mul)
+      __tiger_round(b2,c2,a2,x12,mul)
+      __tiger_round(c1,a1,b1,x21,mul)
+      __tiger_round(c2,a2,b2,x22,mul)
+      __tiger_round(a1,b1,c1,x31,mul)
+      __tiger_round(a2,b2,c2,x32,mul)
+      __tiger_round(b1,c1,a1,x41,mul)
+      __tiger_round(b2,c2,a2,x42,mul)
+      __tiger_round(c1,a1,b1,x51,mul)
+      __tiger_round(c2,a2,b2,x52,mul)
+      __tiger_round(a1,b1,c1,x61,mul)
+      __tiger_round(a2,b2,c2,x62,mul)
+      __tiger_round(b1,c1,a1,x71,mul)
+      __tiger_round(b2,c2,a2,x72,mul)
+
+      tmpa1=a1; a1=c1; c1=b1; b1=tmpa1;
+      tmpa2=a2; a2=c2; c2=b2; b2=tmpa2;
+    }
+
+    a1 ^= aa1; b1 -= bb1; c1 += cc1;
+    a2 ^= aa2; b2 -= bb2; c2 += cc2;
+
+    state1[0] = a1; state1[1] = b1; state1[2] = c1;
+    state2[0] = a2; state2[1] = b2; state2[2] = c2;
+}
+
+void Tiger::hash_leaves(const void* const* leaves, const size_t* lengths, Tiger* results, size_t count)
+{
+    size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+      const uint8_t* p1 = static_cast<const uint8_t*>(leaves[i]);
+      const uint8_t* p2 = static_cast<const uint8_t*>(leaves[i+1]);
+      size_t len1 = lengths[i];
+      size_t len2 = lengths[i+1];
+
+      results[i].reset();
+      results[i+1].reset();
+
+      /* Run full blocks of both leaves through the interleaved compressor for as long
+         as both have one; the shorter leaf's tail goes through the normal path below */
+      size_t both = (len1 < len2 ? len1 : len2) / 64;
+      for (size_t k = 0; k < both; ++k) {
+        tiger_compress_pair(reinterpret_cast<const uint64_t*>(p1), results[i].hash,
+                            reinterpret_cast<const uint64_t*>(p2), results[i+1].hash);
+        p1 += 64;
+        p2 += 64;
+      }
+      results[i].total_length = both * 64;
+      results[i+1].total_length = both * 64;
+
+      results[i].process_bytes(p1, len1 - both * 64);
+      results[i].finalize();
+      results[i+1].process_bytes(p2, len2 - both * 64);
+      results[i+1].finalize();
+    }
+    if (i < count) {
+      results[i].reset();
+      results[i].process_bytes(leaves[i], lengths[i]);
+      results[i].finalize();
+    }
+}
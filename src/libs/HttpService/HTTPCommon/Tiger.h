@@ -99,6 +99,15 @@ public:
     process_bytes(data, len);
     finalize();
   }
+
+  /*
+   * Hashes 'count' independent leaf blocks in one call.  Pairs of leaves are compressed
+   * with their rounds interleaved, so the two dependency chains execute in parallel on a
+   * superscalar core; tree-hashing workloads see most of the dual-lane speedup this way
+   * without any instruction-set requirement.  results[i] receives the finalized hash of
+   * leaves[i] (lengths[i] bytes).
+   */
+  static void hash_leaves(const void* const* leaves, const size_t* lengths, Tiger* results, size_t count);
   
   Tiger(const Tiger& right) {
     memcpy(this, &right, sizeof(Tiger));
@@ -239,6 +248,10 @@ protected:
     hash[1] = b;
     hash[2] = c;
   }
+  /* Compresses one block into each of two independent states with the rounds interleaved */
+  static void tiger_compress_pair(const uint64_t* str1, uint64_t* state1,
+                                  const uint64_t* str2, uint64_t* state2);
+
 protected:
   uint8_t temp[64];
   static const uint64_t table[1024];
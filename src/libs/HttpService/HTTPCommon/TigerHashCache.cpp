@@ -0,0 +1,135 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <boost/lexical_cast.hpp>
+
+#include "TigerHashCache.h"
+
+using namespace HTTP;
+
+namespace {
+    // Caps the map (and the persisted file); entries past the cap evict
+    // arbitrarily on load, which is fine for a cache
+    const size_t k_MAX_ENTRIES = 4096;
+    // By default one in 20 cache hits is re-hashed anyway to catch files whose
+    // mtime lied (clock skew, archivers that restore timestamps, ...)
+    const unsigned int k_DEFAULT_VERIFY_SAMPLING = 20;
+}
+
+TigerHashCache& TigerHashCache::instance() {
+    static TigerHashCache cache;
+    return cache;
+}
+
+TigerHashCache::TigerHashCache()
+    : verify_sampling(k_DEFAULT_VERIFY_SAMPLING), hit_counter(0) { }
+
+bool TigerHashCache::statFile(const std::string& path, boost::uint64_t& size,
+                              std::time_t& mtime, boost::uint64_t& inode) {
+#ifdef _WIN32
+    struct _stati64 st;
+    if (_stati64(path.c_str(), &st) != 0) return false;
+    inode = 0; // st_ino is meaningless on win32
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    inode = static_cast<boost::uint64_t>(st.st_ino);
+#endif
+    size = static_cast<boost::uint64_t>(st.st_size);
+    mtime = st.st_mtime;
+    return true;
+}
+
+void TigerHashCache::setCacheFile(const std::string& path) {
+    boost::mutex::scoped_lock lock(mutex);
+    cache_file = path;
+
+    // One entry per line: size|mtime|inode|hash|path (path last since it may
+    // contain anything except a newline)
+    std::ifstream in(path.c_str());
+    std::string line;
+    while (entries.size() < k_MAX_ENTRIES && std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string size_s, mtime_s, inode_s, hash, entry_path;
+        if (! std::getline(fields, size_s, '|')) continue;
+        if (! std::getline(fields, mtime_s, '|')) continue;
+        if (! std::getline(fields, inode_s, '|')) continue;
+        if (! std::getline(fields, hash, '|')) continue;
+        if (! std::getline(fields, entry_path)) continue;
+        try {
+            Entry e;
+            e.size = boost::lexical_cast<boost::uint64_t>(size_s);
+            e.mtime = static_cast<std::time_t>(boost::lexical_cast<boost::int64_t>(mtime_s));
+            e.inode = boost::lexical_cast<boost::uint64_t>(inode_s);
+            e.hash = hash;
+            entries[entry_path] = e;
+        } catch (const boost::bad_lexical_cast&) {
+            // Corrupt line; skip it
+        }
+    }
+}
+
+bool TigerHashCache::lookup(const std::string& path, boost::uint64_t size, std::time_t mtime,
+                            boost::uint64_t inode, std::string& hash_out) {
+    boost::mutex::scoped_lock lock(mutex);
+    std::map<std::string, Entry>::const_iterator it = entries.find(path);
+    if (it == entries.end()) return false;
+    if (it->second.size != size || it->second.mtime != mtime || it->second.inode != inode)
+        return false;
+    hash_out = it->second.hash;
+    return true;
+}
+
+void TigerHashCache::store(const std::string& path, boost::uint64_t size, std::time_t mtime,
+                           boost::uint64_t inode, const std::string& hash) {
+    boost::mutex::scoped_lock lock(mutex);
+    if (entries.size() >= k_MAX_ENTRIES && ! entries.count(path)) {
+        entries.erase(entries.begin());
+    }
+    Entry& e = entries[path];
+    e.size = size;
+    e.mtime = mtime;
+    e.inode = inode;
+    e.hash = hash;
+    save_locked();
+}
+
+// requires mutex held
+void TigerHashCache::save_locked() {
+    if (cache_file.empty()) return;
+    std::ofstream out(cache_file.c_str(), std::ios::trunc);
+    if (! out) return;
+    for (std::map<std::string, Entry>::const_iterator it = entries.begin();
+        it != entries.end(); ++it) {
+        out << it->second.size << '|'
+            << static_cast<boost::int64_t>(it->second.mtime) << '|'
+            << it->second.inode << '|'
+            << it->second.hash << '|'
+            << it->first << '\n';
+    }
+}
+
+void TigerHashCache::setVerifySampling(unsigned int one_in_n) {
+    boost::mutex::scoped_lock lock(mutex);
+    verify_sampling = one_in_n;
+}
+
+bool TigerHashCache::shouldVerify() {
+    boost::mutex::scoped_lock lock(mutex);
+    if (! verify_sampling) return false;
+    return (++hit_counter % verify_sampling) == 0;
+}
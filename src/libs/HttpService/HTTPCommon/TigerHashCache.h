@@ -0,0 +1,84 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_HTTP_TIGERHASHCACHE
+#define H_HTTP_TIGERHASHCACHE
+
+#include <ctime>
+#include <map>
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace HTTP {
+
+    // Remembers the Tiger hash of files by identity (path + size + mtime + inode)
+    // so a file that hasn't changed since it was last hashed is never read again
+    // just to re-derive the same digest.  A sync client that re-enqueues large
+    // unchanged files constantly spends minutes of CPU and disk reads per session
+    // on exactly that.
+    //
+    // The cache is process-wide and optionally persistent: point setCacheFile at
+    // a writable path and entries survive restarts.  Trusting mtime is a
+    // heuristic, so shouldVerify() samples cached answers for re-hashing --
+    // callers re-hash one in N cache hits anyway and call store() when the
+    // digest disagrees, which also refreshes the entry.
+    //
+    // All methods are thread safe.
+    class TigerHashCache {
+    public:
+        static TigerHashCache& instance();
+
+        // File identity as the cache keys it; returns false when the path can't
+        // be stat'd.  inode is 0 on platforms without one.
+        static bool statFile(const std::string& path, boost::uint64_t& size,
+                             std::time_t& mtime, boost::uint64_t& inode);
+
+        // Enables persistence: existing entries load from the file now and every
+        // store rewrites it.  Call once at startup, before the first lookup.
+        void setCacheFile(const std::string& path);
+
+        bool lookup(const std::string& path, boost::uint64_t size, std::time_t mtime,
+                    boost::uint64_t inode, std::string& hash_out);
+        void store(const std::string& path, boost::uint64_t size, std::time_t mtime,
+                   boost::uint64_t inode, const std::string& hash);
+
+        // One in every verify_sampling cache hits should be re-hashed and compared
+        // against the cached digest (0 disables verification entirely)
+        void setVerifySampling(unsigned int one_in_n);
+        bool shouldVerify();
+
+    private:
+        TigerHashCache();
+
+        struct Entry {
+            boost::uint64_t size;
+            std::time_t mtime;
+            boost::uint64_t inode;
+            std::string hash;
+        };
+
+        void save_locked();
+
+        boost::mutex mutex;
+        std::map<std::string, Entry> entries;   // keyed by path
+        std::string cache_file;
+        unsigned int verify_sampling;
+        unsigned int hit_counter;
+    };
+
+};
+
+#endif // H_HTTP_TIGERHASHCACHE
@@ -0,0 +1,38 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include "TigerStreamHasher.h"
+
+using namespace HTTP;
+
+bool TigerStreamHasher::onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *) {
+    if (!m_inOrder) return false;
+    if (evt->getDataPosition() != m_expected) {
+        // Out-of-order delivery (ranged/seekable stream); a tree hash needs the
+        // bytes in sequence, so give up quietly rather than produce a wrong root
+        m_inOrder = false;
+        return false;
+    }
+    m_hasher.append(evt->getData(), evt->getLength());
+    m_expected += evt->getLength();
+    return false;
+}
+
+bool TigerStreamHasher::onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *) {
+    if (m_inOrder) {
+        m_root = m_hasher.finalize();
+        m_ready = true;
+    }
+    return false;
+}
@@ -0,0 +1,58 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_HTTP_TIGERSTREAMHASHER
+#define H_HTTP_TIGERSTREAMHASHER
+
+#include "DefaultBrowserStreamHandler.h"
+#include "TigerTree.h"
+
+namespace HTTP {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  TigerStreamHasher
+    ///
+    /// @brief  Stream handler that tiger-tree-hashes a download as the bytes arrive
+    ///
+    /// Attach one of these to a BrowserStream alongside the real consumer: every
+    /// StreamDataArrivedEvent chunk is folded into the tree state as it flows past, so the
+    /// content hash is ready the moment the stream completes -- the verification pass stops
+    /// re-reading the file.  Ranged or seekable streams can deliver chunks out of order;
+    /// the hasher detects that and reports no hash rather than a wrong one.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class TigerStreamHasher : public FB::DefaultBrowserStreamHandler {
+    public:
+        TigerStreamHasher() : m_ready(false), m_inOrder(true), m_expected(0) { }
+        virtual ~TigerStreamHasher() { }
+
+        virtual bool onStreamDataArrived(FB::StreamDataArrivedEvent *evt, FB::BrowserStream *);
+        virtual bool onStreamCompleted(FB::StreamCompletedEvent *evt, FB::BrowserStream *);
+
+        /// True once the stream completed and the bytes arrived in order
+        bool hashReady() const { return m_ready; }
+        /// Root of the tiger tree over the stream's bytes; valid once hashReady()
+        const Tiger& hash() const { return m_root; }
+        std::string hashString() const { return m_root.toString(); }
+
+    private:
+        TigerTreeStreamHasher m_hasher;
+        Tiger m_root;
+        bool m_ready;
+        bool m_inOrder;
+        size_t m_expected;  // next in-order byte position
+    };
+};
+
+#endif // H_HTTP_TIGERSTREAMHASHER
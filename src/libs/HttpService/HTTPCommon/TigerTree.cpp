@@ -0,0 +1,230 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include <stdexcept>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/scoped_array.hpp>
+#include "utf8_tools.h"
+
+#include "TigerTree.h"
+
+using namespace HTTP;
+
+namespace {
+    // Leaves claimed per trip to the shared counter; large enough that the lock is
+    // uncontended, small enough that the tail of the file still balances across workers
+    const size_t k_CLAIM_BATCH = 16;
+
+    struct LeafWork {
+        boost::mutex mutex;
+        size_t nextLeaf;
+        size_t leafCount;
+        bool failed;
+
+        LeafWork(size_t count) : nextLeaf(0), leafCount(count), failed(false) {}
+
+        // Returns the number of leaves claimed starting at 'first'; 0 when drained
+        size_t claim(size_t& first) {
+            boost::mutex::scoped_lock _l(mutex);
+            if (failed || nextLeaf >= leafCount) return 0;
+            first = nextLeaf;
+            size_t n = leafCount - nextLeaf;
+            if (n > k_CLAIM_BATCH) n = k_CLAIM_BATCH;
+            nextLeaf += n;
+            return n;
+        }
+
+        void fail() {
+            boost::mutex::scoped_lock _l(mutex);
+            failed = true;
+        }
+    };
+
+    void hash_memory_worker(const char* data, size_t len, LeafWork* work, Tiger* digests) {
+        const void* leaves[k_CLAIM_BATCH];
+        size_t lengths[k_CLAIM_BATCH];
+        size_t first;
+        while (size_t n = work->claim(first)) {
+            for (size_t i = 0; i < n; ++i) {
+                size_t off = (first + i) * TigerTreeHasher::k_LEAF_SIZE;
+                leaves[i] = data + off;
+                lengths[i] = (len - off < TigerTreeHasher::k_LEAF_SIZE)
+                    ? len - off : TigerTreeHasher::k_LEAF_SIZE;
+            }
+            Tiger::hash_leaves(leaves, lengths, digests + first, n);
+        }
+    }
+
+    void hash_file_worker(const std::wstring* path, size_t len, LeafWork* work, Tiger* digests) {
+        // Each worker reads with its own handle, so its I/O overlaps hashing in the others
+#ifdef _WIN32
+        FILE* fh = _wfopen(path->c_str(), L"rb");
+#else
+        FILE* fh = fopen(FB::wstring_to_utf8(*path).c_str(), "rb");
+#endif
+        if (!fh) {
+            work->fail();
+            return;
+        }
+        boost::scoped_array<char> buf(new char[k_CLAIM_BATCH * TigerTreeHasher::k_LEAF_SIZE]);
+        const void* leaves[k_CLAIM_BATCH];
+        size_t lengths[k_CLAIM_BATCH];
+        size_t first;
+        while (size_t n = work->claim(first)) {
+            size_t off = first * TigerTreeHasher::k_LEAF_SIZE;
+            size_t want = (len - off < n * TigerTreeHasher::k_LEAF_SIZE)
+                ? len - off : n * TigerTreeHasher::k_LEAF_SIZE;
+#ifdef _WIN32
+            if (_fseeki64(fh, static_cast<__int64>(off), SEEK_SET) != 0
+#else
+            if (fseeko(fh, static_cast<off_t>(off), SEEK_SET) != 0
+#endif
+                || fread(buf.get(), 1, want, fh) != want) {
+                work->fail();
+                break;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                size_t rel = i * TigerTreeHasher::k_LEAF_SIZE;
+                leaves[i] = buf.get() + rel;
+                lengths[i] = (want - rel < TigerTreeHasher::k_LEAF_SIZE)
+                    ? want - rel : TigerTreeHasher::k_LEAF_SIZE;
+            }
+            Tiger::hash_leaves(leaves, lengths, digests + first, n);
+        }
+        fclose(fh);
+    }
+
+    unsigned int worker_count(unsigned int threads, size_t leafCount) {
+        if (!threads) threads = boost::thread::hardware_concurrency();
+        if (!threads) threads = 1;
+        // No point spinning up workers that would never claim a batch
+        size_t batches = (leafCount + k_CLAIM_BATCH - 1) / k_CLAIM_BATCH;
+        if (threads > batches) threads = static_cast<unsigned int>(batches);
+        return threads;
+    }
+
+    Tiger merge_tree(std::vector<Tiger>& digests) {
+        size_t count = digests.size();
+        while (count > 1) {
+            size_t out = 0;
+            for (size_t i = 0; i + 1 < count; i += 2, ++out) {
+                char pair[48];
+                memcpy(pair, digests[i].hash_data(), 24);
+                memcpy(pair + 24, digests[i + 1].hash_data(), 24);
+                digests[out] = Tiger(pair, sizeof(pair));
+            }
+            if (count & 1) digests[out++] = digests[count - 1];
+            count = out;
+        }
+        return digests[0];
+    }
+}
+
+Tiger TigerTreeHasher::hash(const void* data, size_t len, unsigned int threads)
+{
+    if (!len) return Tiger(data, 0);
+
+    size_t leafCount = (len + k_LEAF_SIZE - 1) / k_LEAF_SIZE;
+    std::vector<Tiger> digests(leafCount);
+    LeafWork work(leafCount);
+    threads = worker_count(threads, leafCount);
+
+    boost::thread_group pool;
+    for (unsigned int i = 1; i < threads; ++i) {
+        pool.create_thread(boost::bind(&hash_memory_worker,
+            static_cast<const char*>(data), len, &work, &digests[0]));
+    }
+    hash_memory_worker(static_cast<const char*>(data), len, &work, &digests[0]);
+    pool.join_all();
+
+    return merge_tree(digests);
+}
+
+Tiger TigerTreeHasher::hashFile(const std::wstring& path, unsigned int threads)
+{
+#ifdef _WIN32
+    FILE* fh = _wfopen(path.c_str(), L"rb");
+#else
+    FILE* fh = fopen(FB::wstring_to_utf8(path).c_str(), "rb");
+#endif
+    if (!fh) throw std::runtime_error("TigerTreeHasher: could not open file");
+#ifdef _WIN32
+    _fseeki64(fh, 0, SEEK_END);
+    size_t len = static_cast<size_t>(_ftelli64(fh));
+#else
+    fseeko(fh, 0, SEEK_END);
+    size_t len = static_cast<size_t>(ftello(fh));
+#endif
+    fclose(fh);
+
+    if (!len) return Tiger("", 0);
+
+    size_t leafCount = (len + k_LEAF_SIZE - 1) / k_LEAF_SIZE;
+    std::vector<Tiger> digests(leafCount);
+    LeafWork work(leafCount);
+    threads = worker_count(threads, leafCount);
+
+    boost::thread_group pool;
+    for (unsigned int i = 1; i < threads; ++i) {
+        pool.create_thread(boost::bind(&hash_file_worker, &path, len, &work, &digests[0]));
+    }
+    hash_file_worker(&path, len, &work, &digests[0]);
+    pool.join_all();
+
+    if (work.failed) throw std::runtime_error("TigerTreeHasher: read error while hashing file");
+
+    return merge_tree(digests);
+}
+
+TigerTreeStreamHasher::TigerTreeStreamHasher() : m_leafFill(0), m_total(0) { }
+
+void TigerTreeStreamHasher::reset() {
+    m_leaf.reset();
+    m_leafFill = 0;
+    m_digests.clear();
+    m_total = 0;
+}
+
+void TigerTreeStreamHasher::append(const void* data, size_t len) {
+    const char* p = static_cast<const char*>(data);
+    while (len) {
+        size_t room = TigerTreeHasher::k_LEAF_SIZE - m_leafFill;
+        size_t take = (len < room) ? len : room;
+        m_leaf.process_bytes(p, take);
+        m_leafFill += take;
+        m_total += take;
+        p += take;
+        len -= take;
+        if (m_leafFill == TigerTreeHasher::k_LEAF_SIZE) {
+            m_leaf.finalize();
+            m_digests.push_back(m_leaf);
+            m_leaf.reset();
+            m_leafFill = 0;
+        }
+    }
+}
+
+Tiger TigerTreeStreamHasher::finalize() {
+    if (!m_total) return Tiger("", 0);
+    // A trailing partial leaf still counts; a stream that ended exactly on a
+    // leaf boundary must not grow an empty one
+    if (m_leafFill || m_digests.empty()) {
+        m_leaf.finalize();
+        m_digests.push_back(m_leaf);
+        m_leaf.reset();
+        m_leafFill = 0;
+    }
+    return merge_tree(m_digests);
+}
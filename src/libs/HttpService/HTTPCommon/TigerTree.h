@@ -0,0 +1,86 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_HTTP_TIGERTREE
+#define H_HTTP_TIGERTREE
+
+#include <string>
+#include <vector>
+#include "Tiger.h"
+
+namespace HTTP {
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  TigerTreeHasher
+    ///
+    /// @brief  Multi-core Tiger tree hashing for upload preprocessing
+    ///
+    /// The input is split into fixed 64KB leaves; leaf hashes are computed by a pool of worker
+    /// threads that claim batches of leaves from a shared counter, so a long file keeps every
+    /// core busy and a thread that draws a slow (cold-cache) region simply claims fewer batches.
+    /// Each worker in hashFile() reads its own region of the file, so disk I/O overlaps hashing
+    /// in the other workers.  The leaf digests are then merged pairwise (an internal node is the
+    /// Tiger hash of its children's concatenated 24-byte digests, an odd node is promoted
+    /// unchanged) until a single root remains; the merge is a negligible fraction of the work
+    /// and runs on the calling thread.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class TigerTreeHasher {
+    public:
+        static const size_t k_LEAF_SIZE = 64 * 1024;
+
+        /// Tree-hashes a block already in memory; threads == 0 uses one worker per core
+        static Tiger hash(const void* data, size_t len, unsigned int threads = 0);
+
+        /// Tree-hashes a file on disk.  Throws std::runtime_error if the file can't be
+        /// opened or read.  threads == 0 uses one worker per core.
+        static Tiger hashFile(const std::wstring& path, unsigned int threads = 0);
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  TigerTreeStreamHasher
+    ///
+    /// @brief  Incremental companion to TigerTreeHasher for hash-as-you-stream pipelines
+    ///
+    /// Bytes are fed in arrival order with append() as they come off the network or out of a
+    /// read buffer; each completed 64KB leaf is folded into the tree state on the spot, so the
+    /// hash runs interleaved with the transfer instead of as a second pass over the data.
+    /// finalize() merges the leaf digests and returns the root, which equals
+    /// TigerTreeHasher::hash() over the same bytes.  Memory held is one leaf buffer's worth of
+    /// Tiger state plus 24 bytes per completed leaf.
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class TigerTreeStreamHasher {
+    public:
+        TigerTreeStreamHasher();
+
+        /// Folds the next 'len' bytes of the stream into the tree state
+        void append(const void* data, size_t len);
+        /// Completes the trailing partial leaf and merges the tree; call once,
+        /// when the stream is done
+        Tiger finalize();
+        /// Discards all state so the hasher can take another stream
+        void reset();
+
+        uint64_t bytesProcessed() const { return m_total; }
+
+    private:
+        Tiger m_leaf;                   // running state of the current leaf
+        size_t m_leafFill;
+        std::vector<Tiger> m_digests;   // completed leaf digests
+        uint64_t m_total;
+    };
+
+};
+
+#endif // H_HTTP_TIGERTREE
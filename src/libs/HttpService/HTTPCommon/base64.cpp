@@ -9,68 +9,186 @@
 
 static const char* base64_charset = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/=";
 
-std::string base64_encode(const std::string& indata) {
-  std::string outdata;
-  outdata.reserve(((indata.size() * 8) / 6) + 2);
-  std::string::size_type remaining = indata.size();
-  const char* dp = indata.data();
+// 12 bits of input -> two output characters in one lookup; together with the
+// decode table this is built once on first use, same as the old lazy xtbl
+static char enc_pairs[4096][2];
+static unsigned char dec_tbl[256];
+static bool tables_built = false;
+
+static void build_tables() {
+  for (int i = 0; i < 4096; ++i) {
+    enc_pairs[i][0] = base64_charset[(i >> 6) & 0x3f];
+    enc_pairs[i][1] = base64_charset[i & 0x3f];
+  }
+  memset(dec_tbl, 0, 256);
+  for (int s = 0; s < 64; ++s) {
+    dec_tbl[(unsigned char)base64_charset[s]] = (unsigned char)s;
+  }
+  dec_tbl[(unsigned char)base64_charset[64]] = 0; // padding character
+  tables_built = true;
+}
+
+size_t base64_encode_block(const void* data, size_t len, char* out) {
+  if (! tables_built) build_tables();
+  const unsigned char* dp = static_cast<const unsigned char*>(data);
+  char* op = out;
+  size_t remaining = len;
 
+  while (remaining >= 12) {
+    // Four triples per iteration; each triple is two table hits and two 2-byte stores
+    for (int k = 0; k < 4; ++k) {
+      unsigned int n = (dp[0] << 16) | (dp[1] << 8) | dp[2];
+      memcpy(op, enc_pairs[n >> 12], 2);
+      memcpy(op + 2, enc_pairs[n & 0xfff], 2);
+      dp += 3; op += 4;
+    }
+    remaining -= 12;
+  }
   while (remaining >= 3) {
-    outdata.push_back(base64_charset[(dp[0] & 0xfc) >> 2]);
-    outdata.push_back(base64_charset[((dp[0] & 0x03) << 4) | ((dp[1] & 0xf0) >> 4)]); 
-    outdata.push_back(base64_charset[((dp[1] & 0x0f) << 2) | ((dp[2] & 0xc0) >> 6)]);
-    outdata.push_back(base64_charset[(dp[2] & 0x3f)]);
-    remaining -= 3; dp += 3;
+    unsigned int n = (dp[0] << 16) | (dp[1] << 8) | dp[2];
+    memcpy(op, enc_pairs[n >> 12], 2);
+    memcpy(op + 2, enc_pairs[n & 0xfff], 2);
+    dp += 3; op += 4;
+    remaining -= 3;
   }
-  
+
   if (remaining == 2) {
-    outdata.push_back(base64_charset[(dp[0] & 0xfc) >> 2]);
-    outdata.push_back(base64_charset[((dp[0] & 0x03) << 4) | ((dp[1] & 0xf0) >> 4)]); 
-    outdata.push_back(base64_charset[((dp[1] & 0x0f) << 2)]);
-    outdata.push_back(base64_charset[64]);
+    op[0] = base64_charset[(dp[0] & 0xfc) >> 2];
+    op[1] = base64_charset[((dp[0] & 0x03) << 4) | ((dp[1] & 0xf0) >> 4)];
+    op[2] = base64_charset[((dp[1] & 0x0f) << 2)];
+    op[3] = base64_charset[64];
+    op += 4;
   } else if (remaining == 1) {
-    outdata.push_back(base64_charset[(dp[0] & 0xfc) >> 2]);
-    outdata.push_back(base64_charset[((dp[0] & 0x03) << 4)]); 
-    outdata.push_back(base64_charset[64]);
-    outdata.push_back(base64_charset[64]);
+    op[0] = base64_charset[(dp[0] & 0xfc) >> 2];
+    op[1] = base64_charset[((dp[0] & 0x03) << 4)];
+    op[2] = base64_charset[64];
+    op[3] = base64_charset[64];
+    op += 4;
   }
 
+  return op - out;
+}
+
+size_t base64_decode_block(const char* data, size_t len, char* out) {
+  if (! tables_built) build_tables();
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+  char* op = out;
+  size_t quads = len / 4;
+
+  while (quads >= 4) {
+    // Four quads per iteration
+    for (int k = 0; k < 4; ++k) {
+      unsigned int n = (dec_tbl[p[0]] << 18) | (dec_tbl[p[1]] << 12)
+                     | (dec_tbl[p[2]] << 6) | dec_tbl[p[3]];
+      op[0] = (char)(n >> 16);
+      op[1] = (char)(n >> 8);
+      op[2] = (char)n;
+      p += 4; op += 3;
+    }
+    quads -= 4;
+  }
+  while (quads--) {
+    unsigned int n = (dec_tbl[p[0]] << 18) | (dec_tbl[p[1]] << 12)
+                   | (dec_tbl[p[2]] << 6) | dec_tbl[p[3]];
+    op[0] = (char)(n >> 16);
+    op[1] = (char)(n >> 8);
+    op[2] = (char)n;
+    p += 4; op += 3;
+  }
+
+  // Padding can only appear in the final quad
+  if (len >= 4) {
+    if (data[len - 1] == base64_charset[64]) --op;
+    if (data[len - 2] == base64_charset[64]) --op;
+  }
+
+  return op - out;
+}
+
+std::string base64_encode(const std::string& indata) {
+  std::string outdata;
+  if (indata.empty()) return outdata;
+  outdata.resize(base64_encoded_size(indata.size()));
+  base64_encode_block(indata.data(), indata.size(), &outdata[0]);
   return outdata;
 }
 
 std::string base64_decode(const std::string& indata) {
   std::string outdata;
-  outdata.reserve((indata.size() * 6) / 8);
-  static char* xtbl = NULL;
-  if (! xtbl) { 
-    // Build translation table from base64_charset string (once)
-    xtbl = new char[256];
-    memset(xtbl, 0, 256);
-    for (char s = 0; s < 64; ++s) {
-      xtbl[base64_charset[s]] = s; 
+  size_t quad_len = (indata.size() / 4) * 4;
+  if (quad_len) {
+    outdata.resize(base64_decoded_size(quad_len));
+    outdata.resize(base64_decode_block(indata.data(), quad_len, &outdata[0]));
+  }
+  if (indata.size() != quad_len) { // compatibility for old, broken padding
+    const char* p = indata.data() + quad_len;
+    const char* end = indata.data() + indata.size();
+    while (p < end && *(p++) == base64_charset[64]) outdata.resize(outdata.size() - 1); // pop_back
+  }
+  return outdata;
+}
+
+void base64_encoder::encode(const void* data, size_t len, std::string& out) {
+  const unsigned char* dp = static_cast<const unsigned char*>(data);
+
+  if (carry_len) {
+    while (len && carry_len < 3) {
+      carry[carry_len++] = *(dp++);
+      --len;
     }
-    xtbl[base64_charset[64]] = 0; // padding character
+    if (carry_len < 3) return;
+    size_t pos = out.size();
+    out.resize(pos + 4);
+    base64_encode_block(carry, 3, &out[pos]);
+    carry_len = 0;
+  }
+
+  size_t whole = len - (len % 3);
+  if (whole) {
+    size_t pos = out.size();
+    out.resize(pos + base64_encoded_size(whole));
+    base64_encode_block(dp, whole, &out[pos]);
+    dp += whole;
+    len -= whole;
+  }
+
+  while (len--) carry[carry_len++] = *(dp++);
+}
+
+void base64_encoder::finish(std::string& out) {
+  if (carry_len) {
+    size_t pos = out.size();
+    out.resize(pos + 4);
+    base64_encode_block(carry, carry_len, &out[pos]);
+    carry_len = 0;
   }
+}
 
-  std::string::size_type remaining = indata.size();
-  const char* p = indata.data();
-  while (remaining >= 4) {
-    char xp[4];
-    for (size_t s = 0; s < 4; ++s) xp[s] = xtbl[p[s]]; 
-    outdata.push_back((xp[0] << 2) | ((xp[1] & 0x30) >> 4));
-    outdata.push_back(((xp[1] & 0x0f) << 4) | ((xp[2] & 0x3c) >> 2));
-    outdata.push_back(((xp[2] & 0x03) << 6) | xp[3]);
-    remaining -= 4;
-    if (remaining == 0) {
-      if (p[3] == base64_charset[64]) outdata.resize(outdata.size() - 1);
-      if (p[2] == base64_charset[64]) outdata.resize(outdata.size() - 1);
-      break;
+void base64_decoder::decode(const char* data, size_t len, std::string& out) {
+  if (carry_len) {
+    while (len && carry_len < 4) {
+      carry[carry_len++] = *(data++);
+      --len;
     }
-    p += 4;
+    if (carry_len < 4) return;
+    size_t pos = out.size();
+    out.resize(pos + 3);
+    out.resize(pos + base64_decode_block(carry, 4, &out[pos]));
+    carry_len = 0;
   }
-  if (remaining) { // compatibility for old, broken padding
-    while (*(p++) == base64_charset[64]) outdata.resize(outdata.size() - 1); // pop_back
+
+  size_t whole = len - (len % 4);
+  if (whole) {
+    size_t pos = out.size();
+    out.resize(pos + base64_decoded_size(whole));
+    out.resize(pos + base64_decode_block(data, whole, &out[pos]));
+    data += whole;
+    len -= whole;
   }
-  return outdata;
+
+  while (len--) carry[carry_len++] = *(data++);
 }
 
+void base64_decoder::finish() {
+  carry_len = 0; // a trailing partial quad carries no decodable data
+}
@@ -1,4 +1,4 @@
-/**********************************************************\ 
+/**********************************************************\
 Original Author: Dan Weatherford
 
 Imported into FireBreath:    Oct 4, 2010
@@ -18,4 +18,38 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 std::string base64_encode(const std::string& indata);
 std::string base64_decode(const std::string& indata);
 
+// Exact output size of encoding 'len' input bytes (including padding)
+inline size_t base64_encoded_size(size_t len) { return ((len + 2) / 3) * 4; }
+// Upper bound on the output size of decoding 'len' base64 characters
+inline size_t base64_decoded_size(size_t len) { return (len / 4) * 3; }
 
+// Low-level block forms: encode/decode straight into a caller-provided buffer
+// sized with the helpers above; both return the number of bytes written.
+// base64_decode_block expects whole quads; padding in the final quad is honored.
+size_t base64_encode_block(const void* data, size_t len, char* out);
+size_t base64_decode_block(const char* data, size_t len, char* out);
+
+// Streaming encoder: feed input in arbitrarily sized chunks and emit output
+// incrementally, so multi-megabyte payloads never need input and output fully
+// in memory at once.  Call finish() exactly once to flush the padded tail.
+class base64_encoder {
+public:
+    base64_encoder() : carry_len(0) {}
+    void encode(const void* data, size_t len, std::string& out);
+    void finish(std::string& out);
+protected:
+    unsigned char carry[3];
+    size_t carry_len;
+};
+
+// Streaming decoder; input may be split anywhere, including mid-quad.
+// finish() discards any trailing partial quad.
+class base64_decoder {
+public:
+    base64_decoder() : carry_len(0) {}
+    void decode(const char* data, size_t len, std::string& out);
+    void finish();
+protected:
+    char carry[4];
+    size_t carry_len;
+};
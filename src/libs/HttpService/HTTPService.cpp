@@ -23,7 +23,11 @@ boost::recursive_mutex HTTPService::instance_set_lock;
 std::list<boost::weak_ptr<HTTPService> > HTTPService::instances;
 
 boost::shared_ptr<HTTPService> HTTPService::create(const std::string ipaddr, const int port, const std::string hostname) {
-    boost::shared_ptr<BasicService> svc(new BasicService(ipaddr, port, hostname));
+    return create(ipaddr, port, hostname, SocketTuning());
+}
+
+boost::shared_ptr<HTTPService> HTTPService::create(const std::string ipaddr, const int port, const std::string hostname, const SocketTuning& tuning) {
+    boost::shared_ptr<BasicService> svc(new BasicService(ipaddr, port, hostname, tuning));
     svc->init();
     {
         boost::recursive_mutex::scoped_lock _l(instance_set_lock);
@@ -27,10 +27,28 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 #include "HTTPService/HTTPHandler.h"
 
 namespace HTTP {
+    // Per-service socket tuning applied to the listening socket and every accepted
+    // connection.  The defaults disable Nagle (responses to the local page are
+    // typically one small write, which Nagle would otherwise hold back) and keep
+    // the kernel defaults for everything else.
+    struct SocketTuning {
+        SocketTuning()
+            : no_delay(true), send_buffer_size(0), receive_buffer_size(0),
+              listen_backlog(0), accept_batch(1) {}
+        bool no_delay;              // set TCP_NODELAY on accepted sockets
+        int send_buffer_size;       // SO_SNDBUF in bytes; 0 keeps the kernel default
+        int receive_buffer_size;    // SO_RCVBUF in bytes; 0 keeps the kernel default
+        int listen_backlog;         // listen() backlog; 0 uses the asio default (SOMAXCONN)
+        unsigned int accept_batch;  // async accepts kept outstanding; >1 drains connection bursts
+                                    // with fewer event-loop wakeups
+    };
+
     class HTTPService : public boost::enable_shared_from_this<HTTPService>
     {
     public:
         static boost::shared_ptr<HTTPService> create(const std::string ipaddr = "127.0.0.1", const int port = 0, const std::string hostname = "localhost");
+        // As above, with explicit socket tuning for the service
+        static boost::shared_ptr<HTTPService> create(const std::string ipaddr, const int port, const std::string hostname, const SocketTuning& tuning);
         HTTPService() { };
         virtual ~HTTPService() { };
 
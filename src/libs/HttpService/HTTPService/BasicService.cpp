@@ -57,12 +57,14 @@ void BasicService::deregisterHandler(boost::shared_ptr<HTTPHandler> hnd) {
     handlers.remove(hnd);
 }
 
-BasicService::BasicService(const std::string &ipaddr, const int port, const std::string &hostname)
+BasicService::BasicService(const std::string &ipaddr, const int port, const std::string &hostname,
+                           const SocketTuning &tuning)
     : signing_key(NULL),
       signing_key_length(0),
       srv_acceptor(service),
       srv_endpoint(ip::tcp::endpoint(ip::address_v4::from_string(ipaddr.c_str()), port)),
-      m_hostname(hostname) { }
+      m_hostname(hostname),
+      m_tuning(tuning) { }
 
 // Init() needs to be separate so that shared_from_this can give the shared_ptr to the workers in do_async_accept() without exploding everything
 // It's weird, but it works. Read the docs on boost::weak_ptr and enable_shared_from_this for more information.
@@ -75,10 +77,15 @@ void BasicService::init() {
     srv_acceptor.open(srv_endpoint.protocol());
     srv_acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
     srv_acceptor.bind(srv_endpoint);
-    srv_acceptor.listen();
+    srv_acceptor.listen(m_tuning.listen_backlog > 0 ? m_tuning.listen_backlog
+                                                    : boost::asio::socket_base::max_connections);
     srv_endpoint = srv_acceptor.local_endpoint();
     FBLOG_INFO("HTTP:Service", "Started server on " << srv_endpoint.port());
-    do_async_accept();
+    // Keep accept_batch accepts outstanding so a burst of connections is drained
+    // without a wakeup per connection; each completion reposts itself
+    unsigned int accepts = m_tuning.accept_batch ? m_tuning.accept_batch : 1;
+    for (unsigned int i = 0; i < accepts; ++i)
+        do_async_accept();
 
     // Start worker threadpool.
     for (std::size_t i = 0; i < threadpool_size; ++i) {
@@ -162,12 +169,33 @@ bool BasicService::check_uri_signature(const FB::URI& in_uri) {
 }
 
 void BasicService::do_async_accept() {
-    Session::ptr sp = new Session(service);
+    Session::ptr sp = checkout_session();
     srv_acceptor.async_accept(sp->socket(), boost::bind(&BasicService::handle_accept, this, _1, sp));
 }
 
+BasicService::Session::ptr BasicService::checkout_session() {
+    {
+        boost::mutex::scoped_lock lock(session_pool_mutex);
+        if (! session_pool.empty()) {
+            Session::ptr sp = session_pool.back();
+            session_pool.pop_back();
+            return sp;
+        }
+    }
+    return Session::ptr(new Session(service));
+}
+
+void BasicService::recycle_session(Session* sess) {
+    boost::mutex::scoped_lock lock(session_pool_mutex);
+    // Beyond the cap the last intrusive_ptr in the completing handler just
+    // deletes the session, exactly as before pooling
+    if (session_pool.size() < max_pooled_sessions)
+        session_pool.push_back(Session::ptr(sess));
+}
+
 void BasicService::handle_accept(const boost::system::error_code& ec, BasicService::Session::ptr acc_sess) {
     if (!ec) {
+        apply_socket_tuning(acc_sess->socket());
         boost::shared_ptr<BasicService> service(boost::dynamic_pointer_cast<BasicService>(shared_from_this()));
         acc_sess->start(service);
         // TODO should we log accept errors?
@@ -176,3 +204,14 @@ void BasicService::handle_accept(const boost::system::error_code& ec, BasicServi
     do_async_accept();
 }
 
+void BasicService::apply_socket_tuning(boost::asio::ip::tcp::socket& sock) const {
+    // Tuning is best effort; a socket the kernel won't tune is still serviceable
+    boost::system::error_code ignored;
+    if (m_tuning.no_delay)
+        sock.set_option(ip::tcp::no_delay(true), ignored);
+    if (m_tuning.send_buffer_size > 0)
+        sock.set_option(socket_base::send_buffer_size(m_tuning.send_buffer_size), ignored);
+    if (m_tuning.receive_buffer_size > 0)
+        sock.set_option(socket_base::receive_buffer_size(m_tuning.receive_buffer_size), ignored);
+}
+
@@ -31,16 +31,20 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 #include "../HTTPCommon/HTTPDatablock.h"
 #include "../HTTPService.h"
 #include "HTTPHandler.h"
+#include "ResponseCache.h"
 #include "../HTTPCommon/HTTPRequestData.h"
 #include "../HTTPCommon/HTTPResponseData.h"
 
 namespace HTTP {
+    class HTTPRequestParser;
+
     class BasicService : public HTTPService {
     public:
         friend class HTTPService;
 
     protected:
-        BasicService(const std::string &ipaddr, const int port, const std::string &hostname);
+        BasicService(const std::string &ipaddr, const int port, const std::string &hostname,
+                     const SocketTuning &tuning = SocketTuning());
     public:
         virtual ~BasicService();
 
@@ -68,7 +72,7 @@ namespace HTTP {
         void do_async_accept();
         bool check_uri_signature(const FB::URI& in_url);
 
-        class Session : public Countable {
+        class Session : public WebSocketConnection {
         public:
             typedef boost::intrusive_ptr<Session> ptr;
 
@@ -78,33 +82,87 @@ namespace HTTP {
             void start(const boost::shared_ptr<BasicService>& _parent_svc);
 
             boost::asio::ip::tcp::socket& socket() { return sock; }
+
+            // WebSocketConnection; only meaningful after an upgrade.  sendMessage
+            // and close may be called from any thread
+            virtual void sendMessage(const std::string& payload, bool binary = false);
+            virtual void close();
+            virtual bool isOpen() const { return ws_active; }
         protected:
+            // Terminal state for every connection: closes the socket, resets state
+            // and hands the session (and its buffers) back to the parent's pool
+            void finish();
             void wait_for_header();
             void handle_request(boost::system::error_code ec);
-            void handle_response_datablock_complete(boost::system::error_code ec, HTTPResponseData* resp);
-
+            void handle_idle_timeout(const boost::system::error_code& ec, unsigned int generation);
+            void write_next_response_blocks(HTTPResponseData* resp);
+            void handle_response_datablock_complete(boost::system::error_code ec, HTTPResponseData* resp, size_t blocks_written);
+            void response_finished(HTTPResponseData* resp);
+
+            // WebSocket upgrade and framing; see BasicServiceSession.cpp
+            bool try_websocket_upgrade(const HTTPRequestParser& parser, const HTTPRequestData& req_data);
+            void handle_ws_handshake_sent(boost::system::error_code ec);
+            void ws_process_buffer();
+            void handle_ws_data(boost::system::error_code ec);
+            bool handle_ws_frame(bool fin, unsigned char opcode, std::string& payload);
+            void ws_queue_frame(unsigned char opcode, const std::string& payload);
+            void ws_start_write();
+            void handle_ws_write(boost::system::error_code ec);
+
+            boost::asio::io_service& io_svc;
             boost::asio::ip::tcp::socket sock;
             boost::asio::streambuf data;
+            boost::asio::deadline_timer idle_timer;
+            bool keep_alive;    // this request allows the connection to be reused
+            // Bumped when the session finishes so a timeout queued for the old
+            // connection can't close the one a reused session is now serving
+            unsigned int timer_generation;
             boost::shared_ptr<BasicService> parent_svc;
+
+            // -- WebSocket state; untouched until a handshake succeeds
+            volatile bool ws_active;            // connection is upgraded and usable
+            boost::shared_ptr<HTTPHandler> ws_handler;
+            std::string ws_handshake;           // 101 response, kept alive across the async write
+            std::string ws_fragmented;          // reassembly buffer for fragmented messages
+            unsigned char ws_fragment_opcode;
+            boost::mutex ws_write_mutex;        // guards the queue and flags below
+            std::list<std::string> ws_write_queue;
+            std::string ws_out;                 // frame currently being written
+            bool ws_writing;
+            bool ws_closing;                    // close initiated; finish when the queue drains
         };
         friend class HTTP::BasicService::Session;
 
         void handle_accept(const boost::system::error_code& ec, Session::ptr socket);
+
+        // Session pooling: polling clients reconnect often enough that allocating a
+        // fresh session (and growing a fresh streambuf) per connection shows up as
+        // accept-latency noise, so finished sessions are reset and reused instead
+        Session::ptr checkout_session();
+        void recycle_session(Session* sess);
+        static const size_t max_pooled_sessions = 8;
         std::string tiger_hmac(const std::string& sign_str) const;
         // -- data
         char* signing_key;
         size_t signing_key_length;
         boost::weak_ptr<BasicService> _weak_ref;
         std::list<boost::shared_ptr<HTTPHandler> > handlers;
+        ResponseCache response_cache;
 
         boost::shared_ptr<BasicService> deferred_shutdown_ref;
 
         std::vector<boost::shared_ptr<boost::thread> > threadpool;
         boost::asio::io_service service;
 
+        void apply_socket_tuning(boost::asio::ip::tcp::socket& sock) const;
+
+        boost::mutex session_pool_mutex;
+        std::vector<Session::ptr> session_pool;
+
         boost::asio::ip::tcp::acceptor srv_acceptor;
         boost::asio::ip::tcp::endpoint srv_endpoint;
         std::string m_hostname;
+        SocketTuning m_tuning;
     };
 };
 
@@ -12,9 +12,31 @@ License:    Dual license model; choose one of two:
 Copyright 2010 Dan Weatherford and Facebook, Inc
 \**********************************************************/
 
+// Platform sendfile headers must precede BasicService.h: Tiger.h (pulled in through
+// it) redefines ssize_t, which mangles the syscall prototypes
+#ifdef _WIN32
+#include <mswsock.h>
+#elif defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <cerrno>
+#else
+#include <sys/sendfile.h>
+#include <poll.h>
+#include <cerrno>
+#endif
+
 #include "BasicService.h"
+#include <cstring>
 #include <boost/algorithm/string.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/uuid/sha1.hpp>
+#include "../HTTPCommon/base64.h"
+#include "../HTTPCommon/HTTPCompression.h"
 #include "../HTTPCommon/HTTPException.h"
+#include "../HTTPCommon/HTTPRequestParser.h"
 #include "../HTTPCommon/Utils.h"
 #include "logging.h"
 
@@ -32,7 +54,132 @@ using std::vector;
 
 using namespace HTTP;
 
-BasicService::Session::Session(boost::asio::io_service& svc) : sock(svc) {
+namespace {
+    // File-backed blocks at least this large go out through the kernel zero-copy
+    // path; below it the syscall round trips cost more than the copy saves
+    const size_t k_SENDFILE_THRESHOLD = 64 * 1024;
+
+    // Sends an entire file-backed block with sendfile (TransmitFile on Windows),
+    // so the bytes move page cache -> socket without touching userspace.  Returns
+    // false on any platform failure; the caller then falls back to the buffered
+    // write for that block.  This blocks the service thread, which is fine for
+    // this single-purpose local server where sessions close after one response.
+    bool send_backing_file(tcp::socket& sock, filehandle_t fh, size_t len) {
+#ifdef _WIN32
+        if (len > 0x7fffffff) return false; // TransmitFile caps at a DWORD
+        if (SetFilePointer(fh, 0, NULL, FILE_BEGIN) == INVALID_SET_FILE_POINTER) return false;
+        return TransmitFile((SOCKET)sock.native_handle(), fh, (DWORD)len, 0, NULL, NULL, 0) != FALSE;
+#elif defined(__APPLE__)
+        off_t offset = 0;
+        while ((size_t)offset < len) {
+            off_t sent = len - offset;
+            if (sendfile(fh, sock.native_handle(), offset, &sent, NULL, 0) == 0) {
+                offset += sent;
+            } else if (errno == EAGAIN || errno == EINTR) {
+                offset += sent; // partial progress is reported even on EAGAIN
+                struct pollfd pfd = { sock.native_handle(), POLLOUT, 0 };
+                poll(&pfd, 1, -1);
+            } else {
+                return false;
+            }
+        }
+        return true;
+#else
+        off_t offset = 0;
+        while ((size_t)offset < len) {
+            long sent = sendfile(sock.native_handle(), fh, &offset, len - offset);
+            if (sent < 0) {
+                if (errno == EAGAIN || errno == EINTR) {
+                    struct pollfd pfd = { sock.native_handle(), POLLOUT, 0 };
+                    poll(&pfd, 1, -1);
+                    continue;
+                }
+                return false;
+            }
+        }
+        return true;
+#endif
+    }
+}
+
+namespace {
+    // A kept-alive connection that goes quiet this long is closed so idle pages
+    // can't pin file descriptors forever
+    const long k_KEEPALIVE_IDLE_SECONDS = 30;
+
+    // Bodies above this aren't kept in the validator cache; tokened endpoints are
+    // small status/JSON responses, not media
+    const size_t k_RESPONSE_CACHE_MAX_BODY = 256 * 1024;
+
+    // A single pushed message larger than this is a protocol error; the local
+    // status payloads this channel exists for are tiny
+    const size_t k_WS_MAX_MESSAGE = 1024 * 1024;
+
+    // WebSocket opcodes (RFC 6455)
+    const unsigned char k_WS_OP_CONTINUATION = 0x0;
+    const unsigned char k_WS_OP_TEXT         = 0x1;
+    const unsigned char k_WS_OP_BINARY       = 0x2;
+    const unsigned char k_WS_OP_CLOSE        = 0x8;
+    const unsigned char k_WS_OP_PING         = 0x9;
+    const unsigned char k_WS_OP_PONG         = 0xa;
+
+    // Sec-WebSocket-Accept: base64(SHA1(client key + fixed GUID))
+    std::string websocket_accept_key(const std::string& key) {
+        static const char k_guid[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        boost::uuids::detail::sha1 sha;
+        sha.process_bytes(key.data(), key.size());
+        sha.process_bytes(k_guid, sizeof(k_guid) - 1);
+        unsigned int digest[5];
+        sha.get_digest(digest);
+        std::string bytes(20, '\0');
+        for (int i = 0; i < 5; ++i) {
+            bytes[i * 4]     = static_cast<char>((digest[i] >> 24) & 0xff);
+            bytes[i * 4 + 1] = static_cast<char>((digest[i] >> 16) & 0xff);
+            bytes[i * 4 + 2] = static_cast<char>((digest[i] >> 8) & 0xff);
+            bytes[i * 4 + 3] = static_cast<char>(digest[i] & 0xff);
+        }
+        return base64_encode(bytes);
+    }
+
+    // Server frames are never masked: two-to-ten byte header plus the payload
+    std::string websocket_build_frame(unsigned char opcode, const std::string& payload) {
+        std::string frame;
+        frame.reserve(payload.size() + 10);
+        frame.push_back(static_cast<char>(0x80 | opcode));  // FIN always set; we don't fragment
+        size_t len = payload.size();
+        if (len < 126) {
+            frame.push_back(static_cast<char>(len));
+        } else if (len <= 0xffff) {
+            frame.push_back(static_cast<char>(126));
+            frame.push_back(static_cast<char>((len >> 8) & 0xff));
+            frame.push_back(static_cast<char>(len & 0xff));
+        } else {
+            frame.push_back(static_cast<char>(127));
+            for (int shift = 56; shift >= 0; shift -= 8)
+                frame.push_back(static_cast<char>((static_cast<boost::uint64_t>(len) >> shift) & 0xff));
+        }
+        frame.append(payload);
+        return frame;
+    }
+
+    // True if the If-None-Match header value names etag ("a, b", weak tags, or "*")
+    bool etag_matches(const std::string& if_none_match, const std::string& etag) {
+        if (if_none_match.empty()) return false;
+        if (trim_copy(if_none_match) == "*") return true;
+        std::vector<std::string> candidates;
+        split(candidates, if_none_match, is_any_of(","));
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            std::string c = trim_copy(candidates[i]);
+            if (starts_with(c, "W/")) c = c.substr(2);
+            if (c == etag) return true;
+        }
+        return false;
+    }
+}
+
+BasicService::Session::Session(boost::asio::io_service& svc) : io_svc(svc), sock(svc), idle_timer(svc),
+    keep_alive(false), timer_generation(0), ws_active(false), ws_fragment_opcode(0),
+    ws_writing(false), ws_closing(false) {
 
 }
 
@@ -42,30 +189,73 @@ BasicService::Session::~Session() {
 
 void BasicService::Session::start(const boost::shared_ptr<BasicService>& _parent_svc) {
     parent_svc = _parent_svc;
+    boost::system::error_code ignored;
+    sock.set_option(tcp::no_delay(true), ignored); // small keep-alive responses shouldn't wait on Nagle
     wait_for_header();
 }
 
+void BasicService::Session::finish() {
+    // An upgraded connection tells its handler it is gone before the session is
+    // reset; the handler drops its WebSocketConnection::ptr in response
+    if (ws_handler) {
+        {
+            boost::mutex::scoped_lock lock(ws_write_mutex);
+            ws_active = false;
+            ws_write_queue.clear();
+            ws_writing = false;
+            ws_closing = false;
+        }
+        boost::shared_ptr<HTTPHandler> handler;
+        handler.swap(ws_handler);
+        handler->onWebSocketClose(WebSocketConnection::ptr(this));
+        ws_handshake.clear();
+        ws_fragmented.clear();
+        ws_fragment_opcode = 0;
+        ws_out.clear();
+    }
+    boost::system::error_code ignored;
+    sock.close(ignored);
+    idle_timer.cancel(ignored);
+    if (data.size())
+        data.consume(data.size()); // keeps the grown buffer, drops leftover bytes
+    keep_alive = false;
+    ++timer_generation;
+    // Pooled sessions must not pin the service; swap our ref out before handing
+    // ourselves back.  This must be the last thing a completion handler does.
+    boost::shared_ptr<BasicService> svc;
+    svc.swap(parent_svc);
+    if (svc) svc->recycle_session(this);
+}
+
 void BasicService::Session::wait_for_header() {
-    async_read_until(sock, data, "\r\n\r\n", boost::bind(&Session::handle_request, BasicService::Session::ptr(this), _1));  
+    idle_timer.expires_from_now(boost::posix_time::seconds(k_KEEPALIVE_IDLE_SECONDS));
+    idle_timer.async_wait(boost::bind(&Session::handle_idle_timeout, BasicService::Session::ptr(this), _1, timer_generation));
+    async_read_until(sock, data, "\r\n\r\n", boost::bind(&Session::handle_request, BasicService::Session::ptr(this), _1));
+}
+
+void BasicService::Session::handle_idle_timeout(const boost::system::error_code& ec, unsigned int generation) {
+    if (ec) return; // cancelled because a request arrived
+    if (generation != timer_generation) return; // fired for a connection this session already finished
+    boost::system::error_code ignored;
+    sock.close(ignored);
 }
 
 
 void BasicService::Session::handle_request(boost::system::error_code ec) {
+    idle_timer.cancel();
     if (ec) {
-        FBLOG_WARN("Http:BasicService", "handle_request error message: " << ec.message());
+        // eof here is just the client closing a kept-alive connection; anything else is worth a log line
+        if (ec != boost::asio::error::eof && ec != boost::asio::error::operation_aborted)
+            FBLOG_WARN("Http:BasicService", "handle_request error message: " << ec.message());
+        finish();
         return;
     }
+    keep_alive = false;
 
-    std::vector<string> header_lines;
-    std::istream data_stream(&data);
-    while (!data_stream.eof()) {
-        string tmp;
-        std::getline(data_stream, tmp);
-        trim(tmp);
-        if (tmp.size() && tmp.at(tmp.size() - 1) == '\r') tmp.resize(tmp.size() - 1);
-        if (tmp.empty()) break;
-        header_lines.push_back(tmp);
-    }
+    // Scan the header block where it sits in the streambuf; everything is recorded as
+    // offset/length views and only materialized below, once, for the handler API
+    HTTPRequestParser parser;
+    parser.parse(buffer_cast<const char*>(data.data()), data.size());
 
     HTTPRequestData req_data;
     HTTPResponseData* resp = NULL;
@@ -75,14 +265,23 @@ void BasicService::Session::handle_request(boost::system::error_code ec) {
     // (your basic http stuff)
     // The path is entity-encoded; "%20" = character 0x20 (which is a space), for example
     try {
-        std::vector<string> req_parts;
-        split(req_parts, header_lines[0], is_any_of(" "));
-        if (req_parts.size() != 3) throw HTTPException(400, "Malformed Request-Line");
-        req_data.method = req_parts[0];
-        req_data.uri = FB::URI::fromString(req_parts[1]);
+        if (! parser.valid()) throw HTTPException(400, "Malformed Request-Line");
+        req_data.method = parser.method();
+        req_data.uri = FB::URI::fromString(parser.target());
+        parser.populateHeaders(req_data.headers);
 
-        // Split the rest of the header lines into the request data
-        req_data.headers = parse_http_headers(++header_lines.begin(), header_lines.end());
+        // HTTP/1.1 connections are kept alive unless the client opts out; requests
+        // with a body are forced closed since we never consume one here
+        keep_alive = (parser.version() == "HTTP/1.1");
+        string conn = parser.findHeader("Connection");
+        if (! conn.empty()) keep_alive = ! iequals(conn, "close");
+        string content_length = parser.findHeader("Content-Length");
+        if (! content_length.empty() && content_length != "0") keep_alive = false;
+
+        // A WebSocket upgrade hijacks the connection before normal dispatch; from
+        // here on the page gets pushed frames instead of polling the endpoint
+        if (try_websocket_upgrade(parser, req_data))
+            return;
 
         if (req_data.uri.path == "/shutdown") {
             FBLOG_INFO("Http:BasicServiceSession", "Received shutdown request");
@@ -108,11 +307,86 @@ void BasicService::Session::handle_request(boost::system::error_code ec) {
             resp->addDatablock(new HTTPStringDatablock(response_str));
         } else {
             bool verified = parent_svc->check_uri_signature(req_data.uri);
+            boost::shared_ptr<HTTPHandler> responding_handler;
+            bool resp_from_cache = false;
+            string cache_key, cache_token;
             for (std::list<boost::shared_ptr<HTTPHandler> >::const_iterator it = parent_svc->handlers.begin(); it != parent_svc->handlers.end(); ++it) {
                 if ((!verified) && ((*it)->requiresVerifiedURI())) continue;
-                if ((resp = (*it)->handleRequest(req_data))) break;
+                cache_key.clear();
+                cache_token = (*it)->responseVersionToken(req_data);
+                if (! cache_token.empty()) {
+                    std::ostringstream key_os;
+                    key_os << (const void*)it->get() << '|' << req_data.uri.path;
+                    cache_key = key_os.str();
+                    string etag = "\"" + cache_token + "\"";
+                    // Client already holds the current version: validate it without
+                    // touching the handler or the body
+                    if (etag_matches(parser.findHeader("If-None-Match"), etag)) {
+                        resp = new HTTPResponseData;
+                        resp->code = 304;
+                        resp->headers.insert(std::make_pair("ETag", etag));
+                        responding_handler = *it;
+                        resp_from_cache = true;
+                        break;
+                    }
+                    // Unchanged since we last rendered it: replay the stored bytes
+                    ResponseCache::ConstEntryPtr cached = parent_svc->response_cache.lookup(cache_key, cache_token);
+                    if (cached) {
+                        resp = new HTTPResponseData;
+                        resp->code = cached->code;
+                        resp->headers = cached->headers;
+                        std::map<string, string>::const_iterator body = cached->bodies.end();
+                        if ((*it)->allowCompression()) {
+                            string encoding = choose_content_encoding(parser.findHeader("Accept-Encoding"));
+                            if (! encoding.empty()) body = cached->bodies.find(encoding);
+                        }
+                        if (body == cached->bodies.end()) body = cached->bodies.find(string());
+                        if (! body->first.empty())
+                            resp->headers.insert(std::make_pair("Content-Encoding", body->first));
+                        resp->addDatablock(new HTTPStringDatablock(body->second));
+                        responding_handler = *it;
+                        resp_from_cache = true;
+                        break;
+                    }
+                }
+                if ((resp = (*it)->handleRequest(req_data))) {
+                    responding_handler = *it;
+                    break;
+                }
             }
             if ((!resp) && (!verified)) throw HTTPException(500, "No registered handlers responded to this request, possibly because of a missing or invalid signature.");
+
+            // Capture fresh tokened responses before compression so the cache holds
+            // the identity body alongside any compressed variant
+            ResponseCache::EntryPtr cache_entry;
+            if (resp && !resp_from_cache && !cache_key.empty() && resp->code == 200) {
+                HTTPDatablock* body = resp->coalesceBlocks();
+                if (body->size() <= k_RESPONSE_CACHE_MAX_BODY) {
+                    cache_entry = boost::make_shared<ResponseCache::Entry>();
+                    cache_entry->token = cache_token;
+                    cache_entry->code = resp->code;
+                    cache_entry->headers = resp->headers;
+                    cache_entry->headers.erase("Content-Length");
+                    cache_entry->headers.erase("Connection");
+                    cache_entry->headers.erase("ETag");
+                    cache_entry->bodies[string()] = string(body->data(), body->size());
+                }
+            }
+
+            // Compress opted-in handler responses when the client can take it
+            if (resp && responding_handler && responding_handler->allowCompression()
+                && resp->headers.find("Content-Encoding") == resp->headers.end()) {
+                string encoding = choose_content_encoding(parser.findHeader("Accept-Encoding"));
+                if (! encoding.empty() && compress_response_blocks(resp, encoding) && cache_entry) {
+                    HTTPDatablock* body = resp->coalesceBlocks();
+                    cache_entry->bodies[encoding] = string(body->data(), body->size());
+                }
+            }
+            if (cache_entry) parent_svc->response_cache.store(cache_key, cache_entry);
+            // Every tokened response carries the validator so the next poll can hit
+            // the 304 path
+            if (resp && !cache_key.empty() && resp->headers.find("ETag") == resp->headers.end())
+                resp->headers.insert(std::make_pair("ETag", "\"" + cache_token + "\""));
         }
 
         if (!resp) throw HTTPException(500, "No registered handlers responded to this request.");
@@ -129,10 +403,10 @@ void BasicService::Session::handle_request(boost::system::error_code ec) {
             resp->headers.insert(std::make_pair("Content-Length", lexical_cast<string>(content_length)));
 
             resp->headers.erase("Connection");
-            resp->headers.insert(std::make_pair("Connection", "close"));
+            resp->headers.insert(std::make_pair("Connection", keep_alive ? "keep-alive" : "close"));
 
             std::ostringstream header_os;
-            header_os << "HTTP/1.1 " << resp->code << " OK\r\n";
+            header_os << "HTTP/1.1 " << resp->code << (resp->code == 304 ? " Not Modified" : " OK") << "\r\n";
             for (std::multimap<std::string, std::string>::const_iterator it = resp->headers.begin(); it != resp->headers.end(); ++it) {
                 header_os << it->first << ": " << it->second << "\r\n";
             }
@@ -145,29 +419,317 @@ void BasicService::Session::handle_request(boost::system::error_code ec) {
     } catch (const HTTPException& e) {
         if (resp) delete resp;
         FBLOG_INFO("Http:BasicServiceSession", "HTTP exception: " << e.what());
+        keep_alive = false; // error responses have no Content-Length, so the connection must close
         resp = new HTTPResponseData(new HTTPStringDatablock(e.getResponseHeader() + string("\r\nContent-Type: text/plain\r\n\r\n") + e.what()));
     } catch (const std::exception& e) {
         if (resp) delete resp;
         FBLOG_INFO("Http:BasicServiceSession", "std::exception: " << e.what());
+        keep_alive = false;
         resp = new HTTPResponseData(new HTTPStringDatablock(string("HTTP/1.1 500 Internal Server Error\r\nContent-Type: text/plain\r\n\r\n") + e.what()));
     }
+    // Release the parsed header block from the buffer; on a kept-alive connection any
+    // pipelined bytes after it stay queued for the next wait_for_header()
+    data.consume(parser.headerBlockSize() ? parser.headerBlockSize() : data.size());
+
     // And write the response datablock list.
-    async_write(sock, buffer((*resp->data.begin())->data(), (*resp->data.begin())->size()), boost::bind(&Session::handle_response_datablock_complete, BasicService::Session::ptr(this), _1, resp));
+    write_next_response_blocks(resp);
 }
 
-void BasicService::Session::handle_response_datablock_complete(boost::system::error_code ec, HTTPResponseData* resp) {
+void BasicService::Session::write_next_response_blocks(HTTPResponseData* resp) {
+    // Anything already sent has been popped, so large file-backed blocks at the front
+    // can go straight from the page cache to the socket without a userspace copy
+    while (! resp->data.empty()) {
+        HTTPDatablock* front = resp->data.front();
+        if (front->backingFile() == kInvalidFileHandle || front->size() < k_SENDFILE_THRESHOLD
+            || ! send_backing_file(sock, front->backingFile(), front->size()))
+            break;
+        delete front;
+        resp->data.pop_front();
+    }
+
+    if (resp->data.empty()) {
+        response_finished(resp);
+        return;
+    }
+
+    // Gather everything up to the next zero-copy candidate into one vectored write.
+    // The first block is always included: if its sendfile attempt failed above it
+    // still has to go out, and its mapped segments work fine in the iov.
+    std::vector<const_buffer> iov;
+    size_t count = 0;
+    for (std::list<HTTPDatablock*>::const_iterator it = resp->data.begin(); it != resp->data.end(); ++it) {
+        if (count && (*it)->backingFile() != kInvalidFileHandle && (*it)->size() >= k_SENDFILE_THRESHOLD)
+            break;
+        size_t segs = (*it)->segmentCount();
+        for (size_t i = 0; i < segs; ++i) {
+            const char* seg_data;
+            size_t seg_len;
+            (*it)->getSegment(i, seg_data, seg_len);
+            if (seg_len) iov.push_back(buffer(seg_data, seg_len));
+        }
+        ++count;
+    }
+    async_write(sock, iov, boost::bind(&Session::handle_response_datablock_complete, BasicService::Session::ptr(this), _1, resp, count));
+}
+
+void BasicService::Session::handle_response_datablock_complete(boost::system::error_code ec, HTTPResponseData* resp, size_t blocks_written) {
     if (ec) {
         delete resp;
-        sock.close();
+        finish();
         return;
     }
-    delete resp->data.front();
-    resp->data.pop_front();
+    while (blocks_written--) {
+        delete resp->data.front();
+        resp->data.pop_front();
+    }
     if (resp->data.empty()) {
-        delete resp;
-        sock.close();
+        response_finished(resp);
         return;
     }
-    async_write(sock, buffer((*resp->data.begin())->data(), (*resp->data.begin())->size()), boost::bind(&Session::handle_response_datablock_complete, BasicService::Session::ptr(this), _1, resp));
+    write_next_response_blocks(resp);
+}
+
+void BasicService::Session::response_finished(HTTPResponseData* resp) {
+    delete resp;
+    if (keep_alive) {
+        // Park the connection in the reactor for the page's next request; one event
+        // per request instead of a whole connection setup/teardown
+        wait_for_header();
+    } else {
+        finish();
+    }
+}
+
+// Recognizes an RFC 6455 upgrade request and, if a handler claims it, answers the
+// handshake and flips the session into frame mode.  Returns false when the request
+// is not an upgrade at all; malformed or unclaimed upgrades throw and get a normal
+// HTTP error response.
+bool BasicService::Session::try_websocket_upgrade(const HTTPRequestParser& parser, const HTTPRequestData& req_data) {
+    string upgrade = trim_copy(parser.findHeader("Upgrade"));
+    if (upgrade.empty() || ! iequals(upgrade, "websocket"))
+        return false;
+    if (! icontains(parser.findHeader("Connection"), "upgrade"))
+        return false;
+
+    string key = trim_copy(parser.findHeader("Sec-WebSocket-Key"));
+    if (key.empty() || trim_copy(parser.findHeader("Sec-WebSocket-Version")) != "13")
+        throw HTTPException(400, "Malformed WebSocket upgrade request");
+
+    bool verified = parent_svc->check_uri_signature(req_data.uri);
+    for (std::list<boost::shared_ptr<HTTPHandler> >::const_iterator it = parent_svc->handlers.begin(); it != parent_svc->handlers.end(); ++it) {
+        if ((!verified) && ((*it)->requiresVerifiedURI())) continue;
+        if ((*it)->wantsWebSocket(req_data)) {
+            ws_handler = *it;
+            break;
+        }
+    }
+    if (! ws_handler)
+        throw HTTPException(404, "No handler accepts WebSocket connections on this path");
+
+    data.consume(parser.headerBlockSize() ? parser.headerBlockSize() : data.size());
+    keep_alive = false;
+
+    std::ostringstream os;
+    os << "HTTP/1.1 101 Switching Protocols\r\n"
+       << "Upgrade: websocket\r\n"
+       << "Connection: Upgrade\r\n"
+       << "Sec-WebSocket-Accept: " << websocket_accept_key(key) << "\r\n\r\n";
+    ws_handshake = os.str();
+    ws_active = true;
+    async_write(sock, buffer(ws_handshake), boost::bind(&Session::handle_ws_handshake_sent, BasicService::Session::ptr(this), _1));
+    return true;
+}
+
+void BasicService::Session::handle_ws_handshake_sent(boost::system::error_code ec) {
+    if (ec) {
+        finish();
+        return;
+    }
+    // Push connections are long-lived and often quiet; the keep-alive idle
+    // timeout does not apply to them
+    boost::system::error_code ignored;
+    idle_timer.cancel(ignored);
+    ws_handler->onWebSocketOpen(WebSocketConnection::ptr(this));
+    ws_process_buffer();
+}
+
+// Drains every complete frame already buffered, then parks one read in the
+// reactor for more.  Client frames are small (mostly pings and the occasional
+// command), so a byte-at-least read plus this loop is plenty.
+void BasicService::Session::ws_process_buffer() {
+    while (ws_active) {
+        const unsigned char* p = buffer_cast<const unsigned char*>(data.data());
+        size_t avail = data.size();
+        if (avail < 2) break;
+
+        bool fin = (p[0] & 0x80) != 0;
+        unsigned char opcode = p[0] & 0x0f;
+        bool masked = (p[1] & 0x80) != 0;
+        boost::uint64_t len = p[1] & 0x7f;
+        size_t pos = 2;
+        if (len == 126) {
+            if (avail < 4) break;
+            len = (static_cast<boost::uint64_t>(p[2]) << 8) | p[3];
+            pos = 4;
+        } else if (len == 127) {
+            if (avail < 10) break;
+            len = 0;
+            for (size_t i = 2; i < 10; ++i) len = (len << 8) | p[i];
+            pos = 10;
+        }
+        if (len > k_WS_MAX_MESSAGE) {
+            FBLOG_WARN("Http:BasicServiceSession", "Oversized WebSocket frame (" << len << " bytes); closing");
+            finish();
+            return;
+        }
+        unsigned char mask[4] = { 0, 0, 0, 0 };
+        if (masked) {
+            if (avail < pos + 4) break;
+            memcpy(mask, p + pos, 4);
+            pos += 4;
+        }
+        if (avail < pos + static_cast<size_t>(len)) break;
+
+        std::string payload(reinterpret_cast<const char*>(p) + pos, static_cast<size_t>(len));
+        if (masked) {
+            for (size_t i = 0; i < payload.size(); ++i)
+                payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+        }
+        data.consume(pos + static_cast<size_t>(len));
+        if (! handle_ws_frame(fin, opcode, payload))
+            return;     // the frame closed the connection
+    }
+    if (ws_active)
+        async_read(sock, data, transfer_at_least(1), boost::bind(&Session::handle_ws_data, BasicService::Session::ptr(this), _1));
+}
+
+void BasicService::Session::handle_ws_data(boost::system::error_code ec) {
+    if (ec) {
+        // eof is the page going away (navigation, tab close); no handshake then
+        finish();
+        return;
+    }
+    ws_process_buffer();
+}
+
+// Returns false when the connection was torn down by the frame
+bool BasicService::Session::handle_ws_frame(bool fin, unsigned char opcode, std::string& payload) {
+    switch (opcode) {
+    case k_WS_OP_CONTINUATION:
+        ws_fragmented.append(payload);
+        if (ws_fragmented.size() > k_WS_MAX_MESSAGE) {
+            finish();
+            return false;
+        }
+        if (fin && ws_fragment_opcode) {
+            ws_fragmented.swap(payload);
+            ws_fragmented.clear();
+            unsigned char op = ws_fragment_opcode;
+            ws_fragment_opcode = 0;
+            ws_handler->onWebSocketMessage(WebSocketConnection::ptr(this), payload, op == k_WS_OP_BINARY);
+        }
+        return true;
+    case k_WS_OP_TEXT:
+    case k_WS_OP_BINARY:
+        if (! fin) {
+            ws_fragment_opcode = opcode;
+            ws_fragmented = payload;
+            return true;
+        }
+        ws_handler->onWebSocketMessage(WebSocketConnection::ptr(this), payload, opcode == k_WS_OP_BINARY);
+        return true;
+    case k_WS_OP_CLOSE:
+        {
+            bool echo;
+            {
+                boost::mutex::scoped_lock lock(ws_write_mutex);
+                echo = ! ws_closing;    // if we initiated, this is the peer's reply
+                ws_closing = true;
+            }
+            if (echo) {
+                ws_queue_frame(k_WS_OP_CLOSE, payload.substr(0, 2)); // echo the status code
+                return true;    // finish() runs when the echo has been flushed
+            }
+            finish();
+            return false;
+        }
+    case k_WS_OP_PING:
+        ws_queue_frame(k_WS_OP_PONG, payload);
+        return true;
+    case k_WS_OP_PONG:
+        return true;
+    default:
+        FBLOG_WARN("Http:BasicServiceSession", "Unknown WebSocket opcode " << (int)opcode << "; closing");
+        finish();
+        return false;
+    }
+}
+
+void BasicService::Session::sendMessage(const std::string& payload, bool binary) {
+    ws_queue_frame(binary ? k_WS_OP_BINARY : k_WS_OP_TEXT, payload);
+}
+
+void BasicService::Session::close() {
+    {
+        boost::mutex::scoped_lock lock(ws_write_mutex);
+        if (ws_closing)
+            return;
+        ws_closing = true;
+    }
+    ws_queue_frame(k_WS_OP_CLOSE, std::string("\x03\xe8", 2)); // 1000, normal closure
+}
+
+// Queues a frame and kicks the write chain if idle.  Safe from any thread: the
+// actual socket writes always happen on the service's io threads, in order.
+void BasicService::Session::ws_queue_frame(unsigned char opcode, const std::string& payload) {
+    {
+        boost::mutex::scoped_lock lock(ws_write_mutex);
+        if (! ws_active)
+            return;
+        ws_write_queue.push_back(websocket_build_frame(opcode, payload));
+        if (ws_writing)
+            return;
+        ws_writing = true;
+    }
+    io_svc.post(boost::bind(&Session::ws_start_write, BasicService::Session::ptr(this)));
+}
+
+void BasicService::Session::ws_start_write() {
+    {
+        boost::mutex::scoped_lock lock(ws_write_mutex);
+        if (! ws_active || ws_write_queue.empty()) {
+            ws_writing = false;
+            return;
+        }
+        ws_out.swap(ws_write_queue.front());
+        ws_write_queue.pop_front();
+    }
+    async_write(sock, buffer(ws_out), boost::bind(&Session::handle_ws_write, BasicService::Session::ptr(this), _1));
+}
+
+void BasicService::Session::handle_ws_write(boost::system::error_code ec) {
+    // Teardown from the write side only closes the socket: a read is parked in
+    // the reactor for this connection, and its completion runs finish() exactly
+    // once (same discipline as the keep-alive idle timeout)
+    if (ec) {
+        boost::system::error_code ignored;
+        sock.close(ignored);
+        return;
+    }
+    bool more, closing;
+    {
+        boost::mutex::scoped_lock lock(ws_write_mutex);
+        more = ! ws_write_queue.empty();
+        closing = ws_closing;
+        if (! more)
+            ws_writing = false;
+    }
+    if (more) {
+        ws_start_write();
+    } else if (closing) {
+        // the close frame is on the wire; drop the connection
+        boost::system::error_code ignored;
+        sock.close(ignored);
+    }
 }
 
@@ -27,6 +27,9 @@ namespace HTTP {
         virtual const char* data() const {
             return reinterpret_cast<const char*>(region.get_address());
         }
+        virtual filehandle_t backingFile() const {
+            return mmfile.get_mapping_handle().handle;
+        }
     protected:
         boost::interprocess::file_mapping mmfile;
         boost::interprocess::mapped_region region;
@@ -19,6 +19,7 @@ Copyright 2010 Dan Weatherford and Facebook, Inc
 #include "../HTTPCommon/HTTPDatablock.h"
 #include "../HTTPCommon/HTTPResponseData.h"
 #include "../HTTPCommon/HTTPRequestData.h"
+#include "WebSocketConnection.h"
 
 namespace HTTP {
     class HTTPHandler {
@@ -32,6 +33,31 @@ namespace HTTP {
         // If the handler can't respond to this request, it returns NULL; otherwise, a new HTTPResponseData.
         // Actual errors throw HTTPException.
         virtual HTTPResponseData* handleRequest(const HTTPRequestData& req) = 0;
+
+        // Handlers whose response only changes when some underlying state changes can
+        // return a cheap version token here (a change counter, a state hash, ...).
+        // The service then remembers the rendered response keyed by the token and,
+        // while the token stays the same, answers repeat polls with 304 Not Modified
+        // (when the client sent the matching ETag) or with the stored bytes --
+        // handleRequest is not called again.  An empty token (the default) disables
+        // this for the request.
+        virtual std::string responseVersionToken(const HTTPRequestData& req) { return std::string(); }
+
+        // Handlers returning highly compressible responses (JSON status, etc) can opt in;
+        // the service then gzip/deflates the body when the client advertises support.
+        // Off by default so file-backed media responses keep their zero-copy send path.
+        virtual bool allowCompression() const { return false; }
+
+        // WebSocket push: a handler that returns true here for an upgrade request's
+        // data gets the connection after the handshake instead of the page polling an
+        // endpoint.  Open/message/close are delivered on the service's io threads;
+        // the handler pushes through the connection whenever its state changes (see
+        // WebSocketConnection).  requiresVerifiedURI applies to upgrades too.
+        virtual bool wantsWebSocket(const HTTPRequestData& req) { return false; }
+        virtual void onWebSocketOpen(const WebSocketConnection::ptr& conn) {}
+        virtual void onWebSocketMessage(const WebSocketConnection::ptr& conn,
+                                        const std::string& message, bool binary) {}
+        virtual void onWebSocketClose(const WebSocketConnection::ptr& conn) {}
     };
 };
 
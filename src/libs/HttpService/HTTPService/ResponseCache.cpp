@@ -0,0 +1,40 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#include "ResponseCache.h"
+
+using namespace HTTP;
+
+ResponseCache::ConstEntryPtr ResponseCache::lookup(const std::string& key, const std::string& token) const {
+    boost::mutex::scoped_lock lock(m_mutex);
+    EntryMap::const_iterator it = m_entries.find(key);
+    if (it == m_entries.end() || it->second->token != token)
+        return ConstEntryPtr();
+    return it->second;
+}
+
+void ResponseCache::store(const std::string& key, const ResponseCache::EntryPtr& entry) {
+    boost::mutex::scoped_lock lock(m_mutex);
+    EntryMap::iterator it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->second = entry; // replacement keeps the key's slot in the eviction order
+        return;
+    }
+    if (m_entries.size() >= kMaxEntries) {
+        m_entries.erase(m_order.front());
+        m_order.pop_front();
+    }
+    m_entries[key] = entry;
+    m_order.push_back(key);
+}
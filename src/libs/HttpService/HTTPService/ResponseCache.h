@@ -0,0 +1,62 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_HTTP_RESPONSECACHE
+#define H_HTTP_RESPONSECACHE
+
+#include <string>
+#include <map>
+#include <list>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace HTTP {
+
+    /// Validator cache for handler responses.  Handlers tag a response with a
+    /// version token (HTTPHandler::responseVersionToken); the service stores the
+    /// rendered body -- plus any compressed variant -- keyed by handler and path,
+    /// and while the token is unchanged it replays the stored bytes or answers
+    /// 304 Not Modified without re-invoking the handler.
+    class ResponseCache {
+    public:
+        struct Entry {
+            std::string token;
+            unsigned int code;
+            std::multimap<std::string, std::string> headers;
+            // Rendered bodies keyed by Content-Encoding; "" is the identity body
+            std::map<std::string, std::string> bodies;
+        };
+        typedef boost::shared_ptr<Entry> EntryPtr;
+        typedef boost::shared_ptr<const Entry> ConstEntryPtr;
+
+        // Returns the entry for key if one is stored and its token matches;
+        // NULL otherwise.  A stale entry is left in place for store() to replace.
+        ConstEntryPtr lookup(const std::string& key, const std::string& token) const;
+        // Stores (or replaces) the entry for key.  Entries are treated as
+        // immutable once stored, so readers never need the lock while serving.
+        void store(const std::string& key, const EntryPtr& entry);
+
+    private:
+        // One slot per endpoint is plenty; the cap bounds memory if a handler
+        // ends up minting per-request keys
+        static const size_t kMaxEntries = 16;
+        typedef std::map<std::string, ConstEntryPtr> EntryMap;
+        EntryMap m_entries;
+        std::list<std::string> m_order; // insertion order, for eviction
+        mutable boost::mutex m_mutex;
+    };
+};
+
+#endif // H_HTTP_RESPONSECACHE
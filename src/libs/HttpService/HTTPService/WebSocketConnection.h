@@ -0,0 +1,45 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_HTTP_WEBSOCKETCONNECTION
+#define H_HTTP_WEBSOCKETCONNECTION
+
+#include <string>
+#include "../Countable.h"
+
+namespace HTTP {
+
+    // Push side of an upgraded connection, handed to the HTTPHandler that accepted
+    // the WebSocket handshake.  Instead of the page polling an endpoint several
+    // times a second, the handler keeps the connection pointer and pushes a frame
+    // when state actually changes.
+    //
+    // sendMessage and close may be called from any thread; frames are queued and
+    // written on the service's io threads in order.  Once onWebSocketClose has been
+    // delivered the connection is dead and sends are silently dropped, but holding
+    // the pointer past that is safe.
+    class WebSocketConnection : public Countable {
+    public:
+        typedef boost::intrusive_ptr<WebSocketConnection> ptr;
+
+        // Queues one message frame (text by default, binary on request)
+        virtual void sendMessage(const std::string& payload, bool binary = false) = 0;
+        // Starts the closing handshake; onWebSocketClose fires when it completes
+        virtual void close() = 0;
+        virtual bool isOpen() const = 0;
+    };
+};
+
+#endif // H_HTTP_WEBSOCKETCONNECTION
@@ -135,7 +135,20 @@ namespace FB { namespace View {
         virtual void loadUri(const FB::URI& uri);
         virtual void closePage();
 
-        void DrawToCGContext(CGContext* ctx, const FB::Rect& size);
+        void DrawToCGContext(CGContext* ctx, const FB::Rect& size, const FB::Rect& clip);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        /// @fn void onWebViewDirtyRect(const FB::Rect& rect)
+        ///
+        /// @brief  Called by the embedded WebView whenever WebKit marks part of itself dirty
+        ///
+        /// In the CoreGraphics drawing model this feeds the changed region into the plugin
+        /// window's invalidateRect() coalescing, so the page only repaints the tiles WebKit
+        /// actually touched instead of blitting the full frame on a fixed timer.
+        ///
+        /// @since 1.7
+        ////////////////////////////////////////////////////////////////////////////////////////////////////
+        void onWebViewDirtyRect(const FB::Rect& rect);
 
         virtual bool onKeyDown(FB::KeyDownEvent *evt, FB::PluginWindowMac *);
         virtual bool onKeyUp(FB::KeyUpEvent *evt, FB::PluginWindowMac *);
@@ -171,6 +184,7 @@ namespace FB { namespace View {
         FB::BrowserHostPtr m_parentHost;
         void* m_layer;
         bool m_isInvalidating;
+        bool m_useDirtyRects;
         FB::PluginWindowMac* m_wnd;
     };
 }};
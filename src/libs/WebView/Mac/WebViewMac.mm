@@ -22,6 +22,36 @@ Copyright 2011 Facebook, Inc
 #define OFFSCREEN_ORIGIN_X -4000
 #define OFFSCREEN_ORIGIN_Y -4000
 
+// WebView subclass that reports WebKit's own dirty regions back to the controller.
+// WebKit calls setNeedsDisplayInRect: for every visual change it makes, so forwarding
+// those rects gives us exact damage information without polling the page.
+@interface FBViewTrackingWebView : WebView {
+    FB::View::WebViewMac* trackingController;
+}
+- (void)setTrackingController:(FB::View::WebViewMac*)c;
+@end
+@implementation FBViewTrackingWebView
+
+- (void)setTrackingController:(FB::View::WebViewMac*)c
+{
+    trackingController = c;
+}
+
+- (void)setNeedsDisplayInRect:(NSRect)rect
+{
+    [super setNeedsDisplayInRect:rect];
+    if (trackingController) {
+        FB::Rect dirty;
+        dirty.left = rect.origin.x;
+        dirty.top = rect.origin.y;
+        dirty.right = rect.origin.x + rect.size.width;
+        dirty.bottom = rect.origin.y + rect.size.height;
+        trackingController->onWebViewDirtyRect(dirty);
+    }
+}
+
+@end
+
 @implementation WebViewHelper
 
 - (void)webView:(WebView *)sender decidePolicyForNavigationAction:(NSDictionary *)actionInformation request:(NSURLRequest *)request frame:(WebFrame *)frame decisionListener:(id < WebPolicyDecisionListener >)listener
@@ -40,6 +70,7 @@ Copyright 2011 Facebook, Inc
 - (void)setController:(FB::View::WebViewMac*)c
 {
     controller = c;
+    [(FBViewTrackingWebView*)webView setTrackingController:c];
 }
 
 - (WebView*)webView {
@@ -67,7 +98,7 @@ Copyright 2011 Facebook, Inc
     [hiddenWindow setAcceptsMouseMovedEvents:YES];
     [hiddenWindow setIgnoresMouseEvents:NO];
 
-    webView = [[WebView alloc] initWithFrame:frameRect frameName:nil groupName: nil];
+    webView = [[FBViewTrackingWebView alloc] initWithFrame:frameRect frameName:nil groupName: nil];
     [webView setFrameLoadDelegate:self];
     [webView setWantsLayer:YES];
     [webView setPolicyDelegate:self];
@@ -95,7 +126,7 @@ Copyright 2011 Facebook, Inc
     [req release];
 }
 
-- (void)drawToCGContext:(CGContextRef)ctx asRect:(NSRect)newSize
+- (void)drawToCGContext:(CGContextRef)ctx asRect:(NSRect)newSize clipRect:(NSRect)clipRect
 {
     NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
 
@@ -110,8 +141,11 @@ Copyright 2011 Facebook, Inc
 
     CGContextTranslateCTM(ctx, 0.0, newSize.size.height);
     CGContextScaleCTM(ctx, 1.0, -1.0);
-    
-    [webView displayRectIgnoringOpacity:newSize inContext:gc];
+
+    // Only touch the damaged region; everything outside it is still valid in the
+    // browser's backing store.
+    CGContextClipToRect(ctx, NSRectToCGRect(clipRect));
+    [webView displayRectIgnoringOpacity:clipRect inContext:gc];
 
     [NSGraphicsContext restoreGraphicsState];
     [pool release];
@@ -181,7 +215,7 @@ FB::View::WebViewPtr FB::View::WebView::create( const FB::PluginCorePtr& plugin,
 
 FB::View::WebViewMac::WebViewMac(const FB::PluginCorePtr& plugin, const FB::BrowserHostPtr& parentHost)
     : FB::View::WebView(plugin, parentHost), o(new WebView_ObjCObjects()), mouseButtonState(FB::MouseButtonEvent::MouseButton_None),
-      m_parentHost(parentHost), m_layer(NULL), m_isInvalidating(false), m_wnd(NULL)
+      m_parentHost(parentHost), m_layer(NULL), m_isInvalidating(false), m_useDirtyRects(false), m_wnd(NULL)
 {
 }
 
@@ -224,16 +258,29 @@ void FB::View::WebViewMac::closePage()
     [nsUrl release];
 }
 
-void FB::View::WebViewMac::DrawToCGContext(CGContext* ctx, const FB::Rect& size)
+void FB::View::WebViewMac::DrawToCGContext(CGContext* ctx, const FB::Rect& size, const FB::Rect& clip)
 {
     NSAutoreleasePool * pool = [NSAutoreleasePool new];
     NSRect newSize = NSMakeRect(0, 0, size.right-size.left, size.bottom-size.top);
-    
-    [o->helper drawToCGContext:ctx asRect:newSize];
-    
+    NSRect clipRect = NSMakeRect(clip.left, clip.top, clip.right-clip.left, clip.bottom-clip.top);
+    if (NSIsEmptyRect(clipRect))
+        clipRect = newSize;
+
+    [o->helper drawToCGContext:ctx asRect:newSize clipRect:clipRect];
+
     [pool release];
 }
 
+void FB::View::WebViewMac::onWebViewDirtyRect(const FB::Rect& rect)
+{
+    // Called on the main thread from WebKit's setNeedsDisplayInRect:.  The plugin
+    // window merges and rate-limits these, so a burst of small DOM changes still
+    // ends up as one OS invalidation covering just the changed area.
+    if (m_useDirtyRects && m_wnd) {
+        m_wnd->invalidateRect(rect);
+    }
+}
+
 bool FB::View::WebViewMac::onWindowAttached(FB::AttachedEvent *evt, FB::PluginWindowMac *wnd)
 {
     m_wnd = wnd;
@@ -243,8 +290,10 @@ bool FB::View::WebViewMac::onWindowAttached(FB::AttachedEvent *evt, FB::PluginWi
     [o->helper setController:this];
 
     if (FB::PluginWindowMac::DrawingModelCoreGraphics == wnd->getDrawingModel()) {
-        // Core Graphics rendering set up.
-        m_isInvalidating = true;
+        // Core Graphics rendering set up.  Instead of redrawing the whole view on a
+        // fixed timer, let WebKit's damage reports drive invalidation; see
+        // onWebViewDirtyRect.
+        m_useDirtyRects = true;
     }
     else if (FB::PluginWindowMac::DrawingModelCoreAnimation == wnd->getDrawingModel() || FB::PluginWindowMac::DrawingModelInvalidatingCoreAnimation == wnd->getDrawingModel()) {
         // Core Animation rendering set up.
@@ -271,6 +320,7 @@ bool FB::View::WebViewMac::onWindowDetached(FB::DetachedEvent *evt, FB::PluginWi
     if (m_isInvalidating) {
         wnd->StopAutoInvalidate();
     }
+    m_useDirtyRects = false;
     [o->helper release];
     o->helper = nil;
     return false;
@@ -537,7 +587,7 @@ bool FB::View::WebViewMac::onFocusChanged(FB::FocusChangedEvent *evt, FB::Plugin
 bool FB::View::WebViewMac::onCoreGraphicsDraw(FB::CoreGraphicsDraw *evt, FB::PluginWindowMac *wnd)
 {
     CGContextSaveGState(evt->context);
-    DrawToCGContext(evt->context, evt->bounds);
+    DrawToCGContext(evt->context, evt->bounds, evt->clip);
     CGContextRestoreGState(evt->context);
     
     return true;
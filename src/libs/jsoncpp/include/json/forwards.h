@@ -25,6 +25,7 @@ namespace Json {
    class ValueIteratorBase;
    class ValueIterator;
    class ValueConstIterator;
+   class ValueArena;
 #ifdef JSON_VALUE_USE_INTERNAL_MAP
    class ValueAllocator;
    class ValueMapAllocator;
@@ -10,6 +10,35 @@
 
 namespace Json {
 
+   /** \brief Receives events from Reader::parse() during a streaming parse.
+    *
+    * Implement this interface to process a document without building a Value
+    * tree: the parser walks the document in order and invokes one callback per
+    * structural token or scalar, keeping only O(nesting depth) state.  Every
+    * callback returns \c true to continue parsing; returning \c false aborts
+    * the parse and Reader::parse() returns \c false.
+    */
+   class JSON_API StreamHandler
+   {
+   public:
+      virtual ~StreamHandler() {}
+
+      /// Called for '{'; a matching endObject() follows the object's members.
+      virtual bool beginObject() = 0;
+      virtual bool endObject() = 0;
+      /// Called for '['; a matching endArray() follows the array's elements.
+      virtual bool beginArray() = 0;
+      virtual bool endArray() = 0;
+      /// Called with a decoded member name; the member's value event follows.
+      virtual bool key( const std::string &name ) = 0;
+      virtual bool stringValue( const std::string &value ) = 0;
+      virtual bool intValue( Value::Int value ) = 0;
+      virtual bool uintValue( Value::UInt value ) = 0;
+      virtual bool doubleValue( double value ) = 0;
+      virtual bool boolValue( bool value ) = 0;
+      virtual bool nullValue() = 0;
+   };
+
    /** \brief Unserialize a <a HREF="http://www.json.org">JSON</a> document into a Value.
     *
     */
@@ -63,6 +92,44 @@ namespace Json {
                   Value &root,
                   bool collectComments = true );
 
+      /** \brief Stream a <a HREF="http://www.json.org">JSON</a> document through a StreamHandler.
+       * \param document UTF-8 encoded string containing the document to read.
+       * \param handler Receives one callback per structural token or scalar.
+       * \return \c true if the document was successfully parsed, \c false if an
+       *         error occurred or a handler callback requested an abort.
+       *
+       * No Value tree is built and comments are always discarded, so memory use
+       * is bounded by the document's nesting depth rather than its size.
+       */
+      bool parse( const std::string &document,
+                  StreamHandler &handler );
+
+      /** \brief Stream a <a HREF="http://www.json.org">JSON</a> document through a StreamHandler.
+       * \param handler Receives one callback per structural token or scalar.
+       * \return \c true if the document was successfully parsed, \c false if an
+       *         error occurred or a handler callback requested an abort.
+       *
+       * No Value tree is built and comments are always discarded, so memory use
+       * is bounded by the document's nesting depth rather than its size.
+       */
+      bool parse( const char *beginDoc, const char *endDoc,
+                  StreamHandler &handler );
+
+      /** \brief Selects arena-backed allocation for subsequently parsed trees.
+       *
+       * When an arena is set, every string value and object member name of a
+       * parsed tree is carved out of \c arena and referenced by the tree
+       * without ownership, so destroying the tree performs no per-string
+       * deallocation and the memory is reclaimed wholesale when the arena is
+       * reset or destroyed.  This speeds up both building and tearing down
+       * large documents considerably.
+       *
+       * The parsed tree, and any copy of it (copies share member names with
+       * the arena, as StaticString keys do), must not outlive the arena.
+       * Pass 0 to return to individually allocated strings.
+       */
+      void setArena( ValueArena *arena );
+
       /** \brief Returns a user friendly string that list errors in the parsed document.
        * \return Formatted error message with the list of errors with their location in 
        *         the parsed document. An empty string is returned if no error occurred
@@ -120,10 +187,18 @@ namespace Json {
       bool readValue();
       bool readObject( Token &token );
       bool readArray( Token &token );
+      bool readStreamValue( StreamHandler &handler );
+      bool readStreamValue( Token &token, StreamHandler &handler );
+      bool readStreamObject( StreamHandler &handler );
+      bool readStreamArray( StreamHandler &handler );
+      bool decodeStreamNumber( Token &token, StreamHandler &handler );
+      bool handlerAborted( Token &token );
       bool decodeNumber( Token &token );
       bool decodeString( Token &token );
       bool decodeString( Token &token, std::string &decoded );
+      bool decodeStringInArena( Token &token );
       bool decodeDouble( Token &token );
+      bool decodeDouble( Token &token, double &value );
       bool decodeUnicodeCodePoint( Token &token, 
                                    Location &current, 
                                    Location end, 
@@ -163,6 +238,7 @@ namespace Json {
       std::string commentsBefore_;
       Features features_;
       bool collectComments_;
+      ValueArena *arena_;
    };
 
    /** \brief Read from 'sin' into 'root'.
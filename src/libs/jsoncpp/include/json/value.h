@@ -81,6 +81,146 @@ namespace Json {
       const char *str_;
    };
 
+#ifdef JSON_VALUE_USE_FLAT_MAP
+   /** \brief Sorted-vector replacement for the std::map storing object members.
+    *
+    * Defining JSON_VALUE_USE_FLAT_MAP makes Value keep its members in a single
+    * contiguous sorted vector instead of a node-based std::map, which removes
+    * the per-member allocation and makes iteration cache friendly.  Lookup
+    * stays O(log n); inserting or erasing in the middle shifts the tail, but
+    * members arriving in sorted order (and array indexes always do) append
+    * without shifting.  Elements are moved with their swap() members, so no
+    * deep Value copies occur on shift or growth.
+    *
+    * Unlike std::map, iterators and references into an object are invalidated
+    * when a member is added or removed.  The parser and the other jsoncpp
+    * entry points never rely on that stability, but code holding references
+    * across insertions must be audited before enabling the flag.
+    */
+   template<typename Key, typename Val>
+   class ValueFlatMap
+   {
+   public:
+      typedef Key key_type;
+      typedef std::pair<Key, Val> value_type;
+      typedef std::vector<value_type> Storage;
+      typedef typename Storage::iterator iterator;
+      typedef typename Storage::const_iterator const_iterator;
+      typedef unsigned int size_type;
+
+      iterator begin() { return data_.begin(); }
+      iterator end() { return data_.end(); }
+      const_iterator begin() const { return data_.begin(); }
+      const_iterator end() const { return data_.end(); }
+      size_type size() const { return size_type( data_.size() ); }
+      bool empty() const { return data_.empty(); }
+      void clear() { data_.clear(); }
+
+      iterator lower_bound( const Key &key )
+      {
+         size_type lo = 0;
+         size_type hi = size();
+         while ( lo < hi )
+         {
+            size_type mid = (lo + hi) / 2;
+            if ( data_[mid].first < key )
+               lo = mid + 1;
+            else
+               hi = mid;
+         }
+         return data_.begin() + lo;
+      }
+
+      iterator find( const Key &key )
+      {
+         iterator it = lower_bound( key );
+         if ( it != data_.end()  &&  (*it).first == key )
+            return it;
+         return data_.end();
+      }
+
+      iterator insert( iterator position, const value_type &value )
+      {
+         size_type index = size_type( position - data_.begin() );
+         grow();
+         data_.push_back( value );
+         for ( size_type toMove = size() - 1; toMove > index; --toMove )
+            swapElements( data_[toMove], data_[toMove-1] );
+         return data_.begin() + index;
+      }
+
+      void erase( iterator position )
+      {
+         for ( size_type index = size_type( position - data_.begin() );
+               index + 1 < size();
+               ++index )
+            swapElements( data_[index], data_[index+1] );
+         data_.pop_back();
+      }
+
+      size_type erase( const Key &key )
+      {
+         iterator it = find( key );
+         if ( it == end() )
+            return 0;
+         erase( it );
+         return 1;
+      }
+
+      bool operator ==( const ValueFlatMap &other ) const
+      {
+         if ( size() != other.size() )
+            return false;
+         for ( size_type index = 0; index < size(); ++index )
+            if ( !( data_[index].first == other.data_[index].first )
+                 ||  !( data_[index].second == other.data_[index].second ) )
+               return false;
+         return true;
+      }
+
+      bool operator <( const ValueFlatMap &other ) const
+      {
+         // lexicographic over (key, value) pairs, as std::map compares
+         size_type commonSize = size() < other.size() ? size() : other.size();
+         for ( size_type index = 0; index < commonSize; ++index )
+         {
+            if ( data_[index].first < other.data_[index].first )
+               return true;
+            if ( other.data_[index].first < data_[index].first )
+               return false;
+            if ( data_[index].second < other.data_[index].second )
+               return true;
+            if ( other.data_[index].second < data_[index].second )
+               return false;
+         }
+         return size() < other.size();
+      }
+
+   private:
+      static void swapElements( value_type &left, value_type &right )
+      {
+         left.first.swap( right.first );
+         left.second.swap( right.second );
+      }
+
+      // vector reallocation would deep-copy every member, so growth moves the
+      // elements into the larger buffer with swaps instead
+      void grow()
+      {
+         if ( data_.size() < data_.capacity() )
+            return;
+         Storage grown;
+         grown.reserve( data_.empty() ? 8 : size_type( data_.capacity() * 2 ) );
+         grown.resize( data_.size(), value_type( Key( 0 ), Val() ) );
+         for ( size_type index = 0; index < data_.size(); ++index )
+            swapElements( grown[index], data_[index] );
+         data_.swap( grown );
+      }
+
+      Storage data_;
+   };
+#endif // ifdef JSON_VALUE_USE_FLAT_MAP
+
    /** \brief Represents a <a HREF="http://www.json.org">JSON</a> value.
     *
     * This class is a discriminated union wrapper that can represents a:
@@ -150,15 +290,19 @@ namespace Json {
          int index() const;
          const char *c_str() const;
          bool isStaticString() const;
-      private:
          void swap( CZString &other );
+      private:
          const char *cstr_;
          int index_;
       };
 
    public:
 #  ifndef JSON_USE_CPPTL_SMALLMAP
+#   ifdef JSON_VALUE_USE_FLAT_MAP
+      typedef ValueFlatMap<CZString, Value> ObjectValues;
+#   else
       typedef std::map<CZString, Value> ObjectValues;
+#   endif // ifdef JSON_VALUE_USE_FLAT_MAP
 #  else
       typedef CppTL::SmallMap<CZString, Value> ObjectValues;
 #  endif // ifndef JSON_USE_CPPTL_SMALLMAP
@@ -534,6 +678,48 @@ namespace Json {
       virtual void releaseStringValue( char *value ) = 0;
    };
 
+   /** \brief Region allocator backing the strings of a Value tree.
+    *
+    * Memory is carved from large blocks with a bump pointer and only ever
+    * released wholesale, by reset() or destruction.  Used together with
+    * Reader::setArena(): every string and member name of the parsed tree then
+    * lives in the arena and is stored by the tree without ownership, so
+    * destroying the tree performs no per-string deallocation.
+    *
+    * A tree holding arena strings must be destroyed before the arena is reset
+    * or destroyed.  The same goes for copies of such a tree: string values are
+    * duplicated on copy, but member names keep StaticString semantics and stay
+    * shared with the arena.
+    */
+   class JSON_API ValueArena
+   {
+   public:
+      enum { defaultBlockSize = 65536 };
+
+      explicit ValueArena( unsigned int blockSize = defaultBlockSize );
+      ~ValueArena();
+
+      /// Returns \c size writable bytes owned by the arena.
+      char *allocate( unsigned int size );
+
+      /// Copies \c length bytes of \c value into the arena and appends a
+      /// terminating null; returns the copy.
+      char *duplicate( const char *value, unsigned int length );
+
+      /// Releases every block at once, making the arena reusable.
+      void reset();
+
+   private:
+      // not copyable
+      ValueArena( const ValueArena &other );
+      ValueArena &operator=( const ValueArena &other );
+
+      std::vector<char *> blocks_;
+      char *current_;
+      unsigned int remaining_;
+      unsigned int blockSize_;
+   };
+
 #ifdef JSON_VALUE_USE_INTERNAL_MAP
    /** \brief Allocator to customize Value internal map.
     * Below is an example of a simple implementation (default implementation actually
@@ -44,6 +44,63 @@ namespace Json {
       bool yamlCompatiblityEnabled_;
    };
 
+   /** \brief Abstract destination receiving serialized output in chunks.
+    * \sa BufferedWriter::write( const Value &, WriteSink & )
+    */
+   class JSON_API WriteSink
+   {
+   public:
+      virtual ~WriteSink() {}
+
+      virtual void write( const char *data, unsigned int length ) = 0;
+   };
+
+   /** \brief Outputs a Value in the compact FastWriter format, directly into a
+    * caller-provided buffer or sink.
+    *
+    * Unlike FastWriter, which concatenates many small std::string temporaries,
+    * serialization accumulates bytes in an internal fixed-size block: numbers
+    * are formatted on the stack, strings are escaped in place, and object
+    * members are visited through iterators rather than a name-list copy plus
+    * one map lookup per member.  When writing to a std::string the destination
+    * is reserved up front using estimate(), so the document is typically
+    * produced with a single allocation.
+    * \sa FastWriter, Value
+    */
+   class JSON_API BufferedWriter
+   {
+   public:
+      BufferedWriter();
+
+      /// Appends the document (and a trailing newline, as FastWriter does)
+      /// to \c document, reserving estimate() bytes before writing.
+      void write( const Value &root, std::string &document );
+
+      /// Streams the document into \c sink in internal-block-sized chunks.
+      void write( const Value &root, WriteSink &sink );
+
+      /** \brief Estimates the serialized size of \c root in bytes.
+       *
+       * The estimate errs on the generous side for scalars and assumes few
+       * escape sequences in strings; it is meant for sizing buffers, not as
+       * an exact prediction.
+       */
+      static unsigned int estimate( const Value &root );
+
+   private:
+      enum { blockSize = 4096 };
+
+      void writeValue( const Value &value );
+      void appendQuoted( const char *value );
+      void append( const char *data, unsigned int length );
+      void appendChar( char c );
+      void flush();
+
+      WriteSink *sink_;
+      unsigned int used_;
+      char block_[blockSize];
+   };
+
    /** \brief Writes a Value in <a HREF="http://www.json.org">JSON</a> format in a human friendly way.
     *
     * The rules for line break and indent are as follow:
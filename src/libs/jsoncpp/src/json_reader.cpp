@@ -56,8 +56,105 @@ in( Reader::Char c, Reader::Char c1, Reader::Char c2, Reader::Char c3, Reader::C
 }
 
 
-static bool 
-containsNewLine( Reader::Location begin, 
+namespace {
+
+// Byte classification for readNumber(): one table lookup per character
+// instead of six compares.  Accepts digits plus '.', 'e', 'E', '+', '-';
+// validation still happens in decodeNumber()/decodeDouble().
+struct NumberCharTable
+{
+   bool is[256];
+   NumberCharTable()
+   {
+      for ( int i = 0; i < 256; ++i )
+         is[i] = ( i >= '0'  &&  i <= '9' );
+      is[int('.')] = is[int('e')] = is[int('E')] = is[int('+')] = is[int('-')] = true;
+   }
+};
+const NumberCharTable numberChars;
+
+// Powers of ten that are exactly representable in a double.
+const double exactPow10[] =
+{
+   1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+   1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+const int maxExactPow10 = 22;
+
+// Fast decimal-to-double conversion for the common case: up to 15
+// significant digits and a decimal exponent within +/-22.  In that range
+// both the mantissa and the power of ten are exact doubles, so a single
+// multiply or divide rounds identically to strtod (Clinger's fast path).
+// Returns false for anything outside that range or malformed input; the
+// caller falls back to the slow, fully general conversion.
+bool
+parseDoubleFast( Reader::Location begin, Reader::Location end, double &value )
+{
+   Reader::Location p = begin;
+   if ( p == end )
+      return false;
+   bool negative = ( *p == '-' );
+   if ( negative  ||  *p == '+' )
+      ++p;
+   unsigned long long mantissa = 0;
+   int significantDigits = 0;
+   int exponent = 0;
+   bool sawDigit = false;
+   for ( ; p != end  &&  *p >= '0'  &&  *p <= '9'; ++p )
+   {
+      sawDigit = true;
+      if ( ++significantDigits > 15 )
+         return false;
+      mantissa = mantissa * 10 + (unsigned long long)( *p - '0' );
+   }
+   if ( p != end  &&  *p == '.' )
+   {
+      for ( ++p; p != end  &&  *p >= '0'  &&  *p <= '9'; ++p )
+      {
+         sawDigit = true;
+         if ( ++significantDigits > 15 )
+            return false;
+         mantissa = mantissa * 10 + (unsigned long long)( *p - '0' );
+         --exponent;
+      }
+   }
+   if ( !sawDigit )
+      return false;
+   if ( p != end  &&  ( *p == 'e'  ||  *p == 'E' ) )
+   {
+      ++p;
+      bool expNegative = ( p != end  &&  *p == '-' );
+      if ( p != end  &&  ( *p == '-'  ||  *p == '+' ) )
+         ++p;
+      if ( p == end )
+         return false;
+      int exp = 0;
+      for ( ; p != end  &&  *p >= '0'  &&  *p <= '9'; ++p )
+      {
+         exp = exp * 10 + ( *p - '0' );
+         if ( exp > 1000 )   // way outside the fast-path range already
+            return false;
+      }
+      exponent += expNegative ? -exp : exp;
+   }
+   if ( p != end )
+      return false;
+   if ( exponent < -maxExactPow10  ||  exponent > maxExactPow10 )
+      return false;
+   double result = (double)mantissa;
+   if ( exponent > 0 )
+      result *= exactPow10[exponent];
+   else if ( exponent < 0 )
+      result /= exactPow10[-exponent];
+   value = negative ? -result : result;
+   return true;
+}
+
+} // namespace
+
+
+static bool
+containsNewLine( Reader::Location begin,
                  Reader::Location end )
 {
    for ( ;begin < end; ++begin )
@@ -108,16 +205,25 @@ static std::string codePointToUTF8(unsigned int cp)
 
 Reader::Reader()
    : features_( Features::all() )
+   , arena_( 0 )
 {
 }
 
 
 Reader::Reader( const Features &features )
    : features_( features )
+   , arena_( 0 )
 {
 }
 
 
+void
+Reader::setArena( ValueArena *arena )
+{
+   arena_ = arena;
+}
+
+
 bool
 Reader::parse( const std::string &document, 
                Value &root,
@@ -191,6 +297,47 @@ Reader::parse( const char *beginDoc, const char *endDoc,
 }
 
 
+bool
+Reader::parse( const std::string &document,
+               StreamHandler &handler )
+{
+   document_ = document;
+   const char *begin = document_.c_str();
+   const char *end = begin + document_.length();
+   return parse( begin, end, handler );
+}
+
+
+bool
+Reader::parse( const char *beginDoc, const char *endDoc,
+               StreamHandler &handler )
+{
+   begin_ = beginDoc;
+   end_ = endDoc;
+   // Comments cannot be attached to a Value during a streaming parse,
+   // so they are always skipped.
+   collectComments_ = false;
+   current_ = begin_;
+   lastValueEnd_ = 0;
+   lastValue_ = 0;
+   commentsBefore_ = "";
+   errors_.clear();
+   while ( !nodes_.empty() )
+      nodes_.pop();
+
+   Token token;
+   skipCommentTokens( token );
+   if ( features_.strictRoot_  &&
+        token.type_ != tokenObjectBegin  &&
+        token.type_ != tokenArrayBegin )
+   {
+      return addError( "A valid JSON document must be either an array or an object value.",
+                       token );
+   }
+   return readStreamValue( token, handler );
+}
+
+
 bool
 Reader::readValue()
 {
@@ -448,16 +595,11 @@ Reader::readCppStyleComment()
 }
 
 
-void 
+void
 Reader::readNumber()
 {
-   while ( current_ != end_ )
-   {
-      if ( !(*current_ >= '0'  &&  *current_ <= '9')  &&
-           !in( *current_, '.', 'e', 'E', '+', '-' ) )
-         break;
+   while ( current_ != end_  &&  numberChars.is[ (unsigned char)*current_ ] )
       ++current_;
-   }
 }
 
 bool
@@ -505,7 +647,11 @@ Reader::readObject( Token &tokenStart )
                                     colon, 
                                     tokenObjectEnd );
       }
-      Value &value = currentValue()[ name ];
+      // With an arena the member name is carved from it and stored without
+      // duplication, like a StaticString key.
+      Value &value = arena_ ? currentValue()[ StaticString( arena_->duplicate( name.c_str(),
+                                                                               (unsigned int)name.length() ) ) ]
+                            : currentValue()[ name ];
       nodes_.push( &value );
       bool ok = readValue();
       nodes_.pop();
@@ -578,18 +724,175 @@ Reader::readArray( Token &tokenStart )
 }
 
 
-bool 
-Reader::decodeNumber( Token &token )
+bool
+Reader::readStreamValue( StreamHandler &handler )
 {
-   bool isDouble = false;
-   for ( Location inspect = token.start_; inspect != token.end_; ++inspect )
+   Token token;
+   skipCommentTokens( token );
+   return readStreamValue( token, handler );
+}
+
+
+bool
+Reader::readStreamValue( Token &token, StreamHandler &handler )
+{
+   switch ( token.type_ )
    {
-      isDouble = isDouble  
-                 ||  in( *inspect, '.', 'e', 'E', '+' )  
-                 ||  ( *inspect == '-'  &&  inspect != token.start_ );
+   case tokenObjectBegin:
+      if ( !handler.beginObject() )
+         return handlerAborted( token );
+      return readStreamObject( handler );
+   case tokenArrayBegin:
+      if ( !handler.beginArray() )
+         return handlerAborted( token );
+      return readStreamArray( handler );
+   case tokenNumber:
+      return decodeStreamNumber( token, handler );
+   case tokenString:
+      {
+         std::string decoded;
+         if ( !decodeString( token, decoded ) )
+            return false;
+         if ( !handler.stringValue( decoded ) )
+            return handlerAborted( token );
+      }
+      break;
+   case tokenTrue:
+      if ( !handler.boolValue( true ) )
+         return handlerAborted( token );
+      break;
+   case tokenFalse:
+      if ( !handler.boolValue( false ) )
+         return handlerAborted( token );
+      break;
+   case tokenNull:
+      if ( !handler.nullValue() )
+         return handlerAborted( token );
+      break;
+   default:
+      return addError( "Syntax error: value, object or array expected.", token );
    }
-   if ( isDouble )
-      return decodeDouble( token );
+   return true;
+}
+
+
+bool
+Reader::readStreamObject( StreamHandler &handler )
+{
+   Token tokenName;
+   std::string name;
+   while ( readToken( tokenName ) )
+   {
+      bool initialTokenOk = true;
+      while ( tokenName.type_ == tokenComment  &&  initialTokenOk )
+         initialTokenOk = readToken( tokenName );
+      if  ( !initialTokenOk )
+         break;
+      if ( tokenName.type_ == tokenObjectEnd  &&  name.empty() )  // empty object
+      {
+         if ( !handler.endObject() )
+            return handlerAborted( tokenName );
+         return true;
+      }
+      if ( tokenName.type_ != tokenString )
+         break;
+
+      name = "";
+      if ( !decodeString( tokenName, name ) )
+         return recoverFromError( tokenObjectEnd );
+      if ( !handler.key( name ) )
+         return handlerAborted( tokenName );
+
+      Token colon;
+      if ( !readToken( colon ) ||  colon.type_ != tokenMemberSeparator )
+      {
+         return addErrorAndRecover( "Missing ':' after object member name",
+                                    colon,
+                                    tokenObjectEnd );
+      }
+      if ( !readStreamValue( handler ) )
+         return false; // error already set; recovery has no tree to resume into
+
+      Token comma;
+      if ( !readToken( comma )
+            ||  ( comma.type_ != tokenObjectEnd  &&
+                  comma.type_ != tokenArraySeparator &&
+          comma.type_ != tokenComment ) )
+      {
+         return addErrorAndRecover( "Missing ',' or '}' in object declaration",
+                                    comma,
+                                    tokenObjectEnd );
+      }
+      bool finalizeTokenOk = true;
+      while ( comma.type_ == tokenComment &&
+              finalizeTokenOk )
+         finalizeTokenOk = readToken( comma );
+      if ( comma.type_ == tokenObjectEnd )
+      {
+         if ( !handler.endObject() )
+            return handlerAborted( comma );
+         return true;
+      }
+   }
+   return addErrorAndRecover( "Missing '}' or object member name",
+                              tokenName,
+                              tokenObjectEnd );
+}
+
+
+bool
+Reader::readStreamArray( StreamHandler &handler )
+{
+   skipSpaces();
+   if ( *current_ == ']' ) // empty array
+   {
+      Token endArray;
+      readToken( endArray );
+      if ( !handler.endArray() )
+         return handlerAborted( endArray );
+      return true;
+   }
+   while ( true )
+   {
+      if ( !readStreamValue( handler ) )
+         return false; // error already set
+
+      Token token;
+      // Accept Comment after last item in the array.
+      bool ok = readToken( token );
+      while ( token.type_ == tokenComment  &&  ok )
+      {
+         ok = readToken( token );
+      }
+      if ( !ok )
+      {
+         return addErrorAndRecover( "Missing ',' or ']' in array declaration",
+                                    token,
+                                    tokenArrayEnd );
+      }
+      if ( token.type_ == tokenArrayEnd )
+      {
+         if ( !handler.endArray() )
+            return handlerAborted( token );
+         break;
+      }
+      if ( token.type_ != tokenArraySeparator )
+      {
+         return addErrorAndRecover( "Missing ',' or ']' in array declaration",
+                                    token,
+                                    tokenArrayEnd );
+      }
+   }
+   return true;
+}
+
+
+bool
+Reader::decodeNumber( Token &token )
+{
+   // Single pass: accumulate digits until the first '.', exponent marker or
+   // embedded sign reclassifies the token as a double.  Matches the old
+   // two-pass (classify, then accumulate) behavior without re-reading.
    Location current = token.start_;
    bool isNegative = *current == '-';
    if ( isNegative )
@@ -601,7 +904,11 @@ Reader::decodeNumber( Token &token )
    {
       Char c = *current++;
       if ( c < '0'  ||  c > '9' )
+      {
+         if ( in( c, '.', 'e', 'E', '+', '-' ) )
+            return decodeDouble( token );
          return addError( "'" + std::string( token.start_, token.end_ ) + "' is not a number.", token );
+      }
       if ( value >= threshold )
          return decodeDouble( token );
       value = value * 10 + Value::UInt(c - '0');
@@ -616,10 +923,25 @@ Reader::decodeNumber( Token &token )
 }
 
 
-bool 
+bool
 Reader::decodeDouble( Token &token )
 {
    double value = 0;
+   if ( !decodeDouble( token, value ) )
+      return false;
+   currentValue() = value;
+   return true;
+}
+
+
+bool
+Reader::decodeDouble( Token &token, double &value )
+{
+   value = 0;
+   // Most real-world doubles (telemetry readings, coordinates, timestamps)
+   // fit the exact fast path; only long or extreme literals pay for sscanf.
+   if ( parseDoubleFast( token.start_, token.end_, value ) )
+      return true;
    const int bufferSize = 32;
    int count;
    int length = int(token.end_ - token.start_);
@@ -638,14 +960,72 @@ Reader::decodeDouble( Token &token )
 
    if ( count != 1 )
       return addError( "'" + std::string( token.start_, token.end_ ) + "' is not a number.", token );
-   currentValue() = value;
    return true;
 }
 
 
-bool 
+bool
+Reader::decodeStreamNumber( Token &token, StreamHandler &handler )
+{
+   // Same int/uint/double classification as decodeNumber() -- single pass,
+   // dispatched to the handler instead of assigned into the tree.
+   Location current = token.start_;
+   bool isNegative = *current == '-';
+   if ( isNegative )
+      ++current;
+   Value::UInt threshold = (isNegative ? Value::UInt(-Value::minInt)
+                                       : Value::maxUInt) / 10;
+   Value::UInt value = 0;
+   bool isDouble = false;
+   while ( current < token.end_ )
+   {
+      Char c = *current++;
+      if ( c < '0'  ||  c > '9' )
+      {
+         if ( !in( c, '.', 'e', 'E', '+', '-' ) )
+            return addError( "'" + std::string( token.start_, token.end_ ) + "' is not a number.", token );
+         isDouble = true;
+         break;
+      }
+      if ( value >= threshold )
+      {
+         isDouble = true;
+         break;
+      }
+      value = value * 10 + Value::UInt(c - '0');
+   }
+   if ( isDouble )
+   {
+      double asDouble = 0;
+      if ( !decodeDouble( token, asDouble ) )
+         return false;
+      if ( !handler.doubleValue( asDouble ) )
+         return handlerAborted( token );
+   }
+   else if ( isNegative )
+   {
+      if ( !handler.intValue( -Value::Int( value ) ) )
+         return handlerAborted( token );
+   }
+   else if ( value <= Value::UInt(Value::maxInt) )
+   {
+      if ( !handler.intValue( Value::Int( value ) ) )
+         return handlerAborted( token );
+   }
+   else
+   {
+      if ( !handler.uintValue( value ) )
+         return handlerAborted( token );
+   }
+   return true;
+}
+
+
+bool
 Reader::decodeString( Token &token )
 {
+   if ( arena_ )
+      return decodeStringInArena( token );
    std::string decoded;
    if ( !decodeString( token, decoded ) )
       return false;
@@ -654,6 +1034,26 @@ Reader::decodeString( Token &token )
 }
 
 
+bool
+Reader::decodeStringInArena( Token &token )
+{
+   unsigned int length = (unsigned int)( token.end_ - token.start_ - 2 );
+   if ( !memchr( token.start_ + 1, '\\', length ) )
+   {
+      // No escapes: the raw bytes are the value, copied straight into the
+      // arena without an intermediate std::string.
+      currentValue() = Value( StaticString( arena_->duplicate( token.start_ + 1, length ) ) );
+      return true;
+   }
+   std::string decoded;
+   if ( !decodeString( token, decoded ) )
+      return false;
+   currentValue() = Value( StaticString( arena_->duplicate( decoded.c_str(),
+                                                            (unsigned int)decoded.length() ) ) );
+   return true;
+}
+
+
 bool 
 Reader::decodeString( Token &token, std::string &decoded )
 {
@@ -770,7 +1170,14 @@ Reader::addError( const std::string &message,
 }
 
 
-bool 
+bool
+Reader::handlerAborted( Token &token )
+{
+   return addError( "Parsing aborted by stream handler.", token );
+}
+
+
+bool
 Reader::recoverFromError( TokenType skipUntilToken )
 {
    int errorCount = int(errors_.size());
@@ -103,13 +103,75 @@ static ValueAllocator *&valueAllocator()
 }
 
 static struct DummyValueAllocatorInitializer {
-   DummyValueAllocatorInitializer() 
+   DummyValueAllocatorInitializer()
    {
       valueAllocator();      // ensure valueAllocator() statics are initialized before main().
    }
 } dummyValueAllocatorInitializer;
 
 
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// class ValueArena
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+// //////////////////////////////////////////////////////////////////
+
+ValueArena::ValueArena( unsigned int blockSize )
+   : current_( 0 )
+   , remaining_( 0 )
+   , blockSize_( blockSize )
+{
+}
+
+
+ValueArena::~ValueArena()
+{
+   reset();
+}
+
+
+char *
+ValueArena::allocate( unsigned int size )
+{
+   if ( size > remaining_ )
+   {
+      // oversized requests get a block of their own
+      unsigned int allocSize = size > blockSize_ ? size : blockSize_;
+      char *block = static_cast<char *>( malloc( allocSize ) );
+      blocks_.push_back( block );
+      current_ = block;
+      remaining_ = allocSize;
+   }
+   char *result = current_;
+   current_ += size;
+   remaining_ -= size;
+   return result;
+}
+
+
+char *
+ValueArena::duplicate( const char *value, unsigned int length )
+{
+   char *newString = allocate( length + 1 );
+   memcpy( newString, value, length );
+   newString[length] = 0;
+   return newString;
+}
+
+
+void
+ValueArena::reset()
+{
+   for ( unsigned int index = 0; index < blocks_.size(); ++index )
+      free( blocks_[index] );
+   blocks_.clear();
+   current_ = 0;
+   remaining_ = 0;
+}
+
+
 
 // //////////////////////////////////////////////////////////////////
 // //////////////////////////////////////////////////////////////////
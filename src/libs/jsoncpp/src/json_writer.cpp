@@ -63,13 +63,14 @@ std::string valueToString( UInt value )
    return current;
 }
 
-std::string valueToString( double value )
+// Formats value into buffer (at least 32 bytes) and returns it; shared by
+// valueToString( double ) and BufferedWriter so neither path allocates.
+static char *doubleToBuffer( double value, char *buffer )
 {
-   char buffer[32];
-#if defined(_MSC_VER) && defined(__STDC_SECURE_LIB__) // Use secure version with visual studio 2005 to avoid warning. 
-   sprintf_s(buffer, sizeof(buffer), "%#.16g", value); 
-#else   
-   sprintf(buffer, "%#.16g", value); 
+#if defined(_MSC_VER) && defined(__STDC_SECURE_LIB__) // Use secure version with visual studio 2005 to avoid warning.
+   sprintf_s(buffer, 32, "%#.16g", value);
+#else
+   sprintf(buffer, "%#.16g", value);
 #endif
    char* ch = buffer + strlen(buffer) - 1;
    if (*ch != '0') return buffer; // nothing to truncate, so save time
@@ -102,6 +103,12 @@ std::string valueToString( double value )
    return buffer;
 }
 
+std::string valueToString( double value )
+{
+   char buffer[32];
+   return doubleToBuffer( value, buffer );
+}
+
 
 std::string valueToString( bool value )
 {
@@ -263,6 +270,269 @@ FastWriter::writeValue( const Value &value )
 }
 
 
+// Class BufferedWriter
+// //////////////////////////////////////////////////////////////////
+
+namespace {
+   class StringWriteSink : public WriteSink
+   {
+   public:
+      StringWriteSink( std::string &document )
+         : document_( document )
+      {
+      }
+
+      virtual void write( const char *data, unsigned int length )
+      {
+         document_.append( data, length );
+      }
+
+   private:
+      std::string &document_;
+   };
+}
+
+
+BufferedWriter::BufferedWriter()
+   : sink_( 0 )
+   , used_( 0 )
+{
+}
+
+
+void
+BufferedWriter::write( const Value &root, std::string &document )
+{
+   document.reserve( document.size() + estimate( root ) + 1 );
+   StringWriteSink sink( document );
+   write( root, sink );
+}
+
+
+void
+BufferedWriter::write( const Value &root, WriteSink &sink )
+{
+   sink_ = &sink;
+   used_ = 0;
+   writeValue( root );
+   appendChar( '\n' );
+   flush();
+   sink_ = 0;
+}
+
+
+unsigned int
+BufferedWriter::estimate( const Value &root )
+{
+   switch ( root.type() )
+   {
+   case nullValue:
+      return 4;
+   case intValue:
+   case uintValue:
+      return 12;   // sign plus ten digits, rounded up
+   case realValue:
+      return 26;
+   case booleanValue:
+      return 5;
+   case stringValue:
+      {
+         const char *value = root.asCString();
+         // quotes plus slack for the occasional escape sequence
+         return ( value ? (unsigned int)strlen( value ) : 0 ) + 8;
+      }
+   case arrayValue:
+   case objectValue:
+      {
+         bool isObject = root.type() == objectValue;
+         unsigned int total = 2;
+         for ( Value::const_iterator it = root.begin(); it != root.end(); ++it )
+         {
+            if ( isObject )
+               total += (unsigned int)strlen( it.memberName() ) + 4; // quotes, colon, comma
+            else
+               total += 1; // comma
+            total += estimate( *it );
+         }
+         return total;
+      }
+   }
+   return 0;
+}
+
+
+void
+BufferedWriter::writeValue( const Value &value )
+{
+   char buffer[32];
+   switch ( value.type() )
+   {
+   case nullValue:
+      append( "null", 4 );
+      break;
+   case intValue:
+      {
+         Int asInt = value.asInt();
+         char *current = buffer + sizeof(buffer);
+         bool isNegative = asInt < 0;
+         if ( isNegative )
+            asInt = -asInt;
+         uintToString( UInt(asInt), current );
+         if ( isNegative )
+            *--current = '-';
+         append( current, (unsigned int)( buffer + sizeof(buffer) - 1 - current ) );
+      }
+      break;
+   case uintValue:
+      {
+         char *current = buffer + sizeof(buffer);
+         uintToString( value.asUInt(), current );
+         append( current, (unsigned int)( buffer + sizeof(buffer) - 1 - current ) );
+      }
+      break;
+   case realValue:
+      {
+         const char *formatted = doubleToBuffer( value.asDouble(), buffer );
+         append( formatted, (unsigned int)strlen( formatted ) );
+      }
+      break;
+   case stringValue:
+      appendQuoted( value.asCString() );
+      break;
+   case booleanValue:
+      if ( value.asBool() )
+         append( "true", 4 );
+      else
+         append( "false", 5 );
+      break;
+   case arrayValue:
+      {
+         appendChar( '[' );
+         bool first = true;
+         for ( Value::const_iterator it = value.begin(); it != value.end(); ++it )
+         {
+            if ( !first )
+               appendChar( ',' );
+            first = false;
+            writeValue( *it );
+         }
+         appendChar( ']' );
+      }
+      break;
+   case objectValue:
+      {
+         // iterates members in place; FastWriter copies every name into a
+         // vector and then looks each one up again
+         appendChar( '{' );
+         bool first = true;
+         for ( Value::const_iterator it = value.begin(); it != value.end(); ++it )
+         {
+            if ( !first )
+               appendChar( ',' );
+            first = false;
+            appendQuoted( it.memberName() );
+            appendChar( ':' );
+            writeValue( *it );
+         }
+         appendChar( '}' );
+      }
+      break;
+   }
+}
+
+
+void
+BufferedWriter::appendQuoted( const char *value )
+{
+   if ( !value )
+      value = "";
+   appendChar( '"' );
+   if ( strpbrk( value, "\"\\\b\f\n\r\t" ) == NULL  &&  !containsControlCharacter( value ) )
+   {
+      append( value, (unsigned int)strlen( value ) );
+   }
+   else
+   {
+      for ( const char *c = value; *c != 0; ++c )
+      {
+         switch ( *c )
+         {
+         case '\"':
+            append( "\\\"", 2 );
+            break;
+         case '\\':
+            append( "\\\\", 2 );
+            break;
+         case '\b':
+            append( "\\b", 2 );
+            break;
+         case '\f':
+            append( "\\f", 2 );
+            break;
+         case '\n':
+            append( "\\n", 2 );
+            break;
+         case '\r':
+            append( "\\r", 2 );
+            break;
+         case '\t':
+            append( "\\t", 2 );
+            break;
+         default:
+            if ( isControlCharacter( *c ) )
+            {
+               char escaped[8];
+               sprintf( escaped, "\\u%04X", static_cast<int>( *c ) );
+               append( escaped, 6 );
+            }
+            else
+               appendChar( *c );
+            break;
+         }
+      }
+   }
+   appendChar( '"' );
+}
+
+
+void
+BufferedWriter::append( const char *data, unsigned int length )
+{
+   while ( length )
+   {
+      if ( used_ == blockSize )
+         flush();
+      unsigned int chunk = blockSize - used_;
+      if ( chunk > length )
+         chunk = length;
+      memcpy( block_ + used_, data, chunk );
+      used_ += chunk;
+      data += chunk;
+      length -= chunk;
+   }
+}
+
+
+void
+BufferedWriter::appendChar( char c )
+{
+   if ( used_ == blockSize )
+      flush();
+   block_[used_++] = c;
+}
+
+
+void
+BufferedWriter::flush()
+{
+   if ( used_ )
+   {
+      sink_->write( block_, used_ );
+      used_ = 0;
+   }
+}
+
+
 // Class StyledWriter
 // //////////////////////////////////////////////////////////////////
 
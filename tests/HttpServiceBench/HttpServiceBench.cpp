@@ -0,0 +1,264 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+// Load benchmark for the embedded HTTP service (BasicService).  Starts the
+// service in-process on a loopback port, then hammers it with raw sockets from
+// client threads and reports requests/sec plus tail latency.  Run it by hand;
+// like the scripting bench it is not wired into the post-build test run.
+//
+//   Bench_HttpService [--connections N] [--requests-per-conn N]
+//                     [--payload BYTES] [--duration MS]
+//
+// --connections       concurrent client connections (threads), default 8
+// --requests-per-conn requests sent per connection before reconnecting;
+//                     0 = keep-alive for the whole run (default), 1 = a fresh
+//                     connection per request (worst case)
+// --payload           response body size in bytes, default 16384
+// --duration          run length in milliseconds, default 5000
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "HTTPService.h"
+#include "HTTPService/HTTPHandler.h"
+#include "HTTPCommon/HTTPRequestData.h"
+#include "HTTPCommon/HTTPResponseData.h"
+#include "HTTPCommon/HTTPDatablock.h"
+
+using boost::asio::ip::tcp;
+using boost::posix_time::ptime;
+using boost::posix_time::microsec_clock;
+
+namespace
+{
+    struct Options {
+        int connections;
+        int requestsPerConn;    // 0 = unlimited keep-alive
+        size_t payloadBytes;
+        int durationMs;
+
+        Options() : connections(8), requestsPerConn(0),
+                    payloadBytes(16 * 1024), durationMs(5000) {}
+    };
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  BenchHandler
+    ///
+    /// @brief  Serves a fixed payload at /bench; no URI signing so clients can be plain sockets
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class BenchHandler : public HTTP::HTTPHandler
+    {
+    public:
+        explicit BenchHandler(size_t payloadBytes) : m_body(payloadBytes, 'x') {}
+        bool requiresVerifiedURI() const { return false; }
+        HTTP::HTTPResponseData* handleRequest(const HTTP::HTTPRequestData& req)
+        {
+            HTTP::HTTPResponseData* resp =
+                new HTTP::HTTPResponseData(new HTTP::HTTPStringDatablock(m_body));
+            resp->headers.insert(std::make_pair("Content-Type", "application/octet-stream"));
+            return resp;
+        }
+    private:
+        std::string m_body;
+    };
+
+    struct WorkerResult {
+        boost::uint64_t requests;
+        boost::uint64_t failures;
+        boost::uint64_t bytes;
+        std::vector<boost::uint32_t> samples;   // per-request latency, microseconds
+
+        WorkerResult() : requests(0), failures(0), bytes(0) {}
+    };
+
+    // Reads one response off the socket; buf may hold (and keep) pipelined leftovers.
+    // Returns body size on success, -1 on a malformed or errored response.
+    long readResponse(tcp::socket& sock, boost::asio::streambuf& buf, bool& serverCloses)
+    {
+        boost::system::error_code ec;
+        boost::asio::read_until(sock, buf, "\r\n\r\n", ec);
+        if (ec)
+            return -1;
+
+        std::istream is(&buf);
+        std::string line;
+        long contentLength = -1;
+        serverCloses = false;
+        while (std::getline(is, line) && line != "\r" && !line.empty()) {
+            if (!line.empty() && line[line.size() - 1] == '\r')
+                line.erase(line.size() - 1);
+            const std::string::size_type colon = line.find(':');
+            if (colon == std::string::npos)
+                continue;
+            std::string name = line.substr(0, colon);
+            std::string value = line.substr(colon + 1);
+            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+            boost::trim(value);
+            if (name == "content-length")
+                contentLength = boost::lexical_cast<long>(value);
+            else if (name == "connection" && boost::iequals(value, "close"))
+                serverCloses = true;
+        }
+        if (contentLength < 0)
+            return -1;
+
+        if (static_cast<size_t>(contentLength) > buf.size()) {
+            boost::asio::read(sock, buf,
+                boost::asio::transfer_exactly(contentLength - buf.size()), ec);
+            if (ec)
+                return -1;
+        }
+        buf.consume(contentLength);
+        return contentLength;
+    }
+
+    void clientWorker(const Options* opts, unsigned short port, ptime deadline,
+                      WorkerResult* out)
+    {
+        boost::asio::io_service io;
+        tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), port);
+
+        const std::string keepAliveReq(
+            "GET /bench HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        const std::string closingReq(
+            "GET /bench HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+
+        while (microsec_clock::universal_time() < deadline) {
+            tcp::socket sock(io);
+            boost::system::error_code ec;
+            sock.connect(endpoint, ec);
+            if (ec) {
+                ++out->failures;
+                continue;
+            }
+            sock.set_option(tcp::no_delay(true), ec);
+
+            boost::asio::streambuf buf;
+            int onThisConn = 0;
+            for (;;) {
+                if (microsec_clock::universal_time() >= deadline)
+                    break;
+                const bool last = opts->requestsPerConn
+                    && onThisConn + 1 >= opts->requestsPerConn;
+                const std::string& req = last ? closingReq : keepAliveReq;
+
+                const ptime before(microsec_clock::universal_time());
+                boost::asio::write(sock, boost::asio::buffer(req), ec);
+                bool serverCloses = true;
+                long body = ec ? -1 : readResponse(sock, buf, serverCloses);
+                const ptime after(microsec_clock::universal_time());
+
+                ++out->requests;
+                if (body < 0) {
+                    ++out->failures;
+                    break;      // connection state is unknown; reconnect
+                }
+                out->bytes += body;
+                out->samples.push_back(static_cast<boost::uint32_t>(
+                    (after - before).total_microseconds()));
+                ++onThisConn;
+                if (last || serverCloses)
+                    break;
+            }
+            sock.close(ec);
+        }
+    }
+
+    boost::uint32_t percentile(const std::vector<boost::uint32_t>& sorted, int pct)
+    {
+        if (sorted.empty())
+            return 0;
+        return sorted[(sorted.size() - 1) * pct / 100];
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options opts;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--connections"))
+            opts.connections = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--requests-per-conn"))
+            opts.requestsPerConn = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--payload"))
+            opts.payloadBytes = static_cast<size_t>(atol(argv[i + 1]));
+        else if (!strcmp(argv[i], "--duration"))
+            opts.durationMs = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    boost::shared_ptr<HTTP::HTTPService> service =
+        HTTP::HTTPService::create("127.0.0.1", 0, "localhost");
+    boost::shared_ptr<BenchHandler> handler =
+        boost::make_shared<BenchHandler>(opts.payloadBytes);
+    service->registerHandler(handler);
+    const unsigned short port = static_cast<unsigned short>(service->getBaseUri().port);
+
+    printf("service on 127.0.0.1:%u; %d connections, %s, %lu byte payload, %d ms\n",
+           (unsigned)port, opts.connections,
+           opts.requestsPerConn
+               ? (boost::lexical_cast<std::string>(opts.requestsPerConn)
+                  + " requests/conn").c_str()
+               : "unlimited keep-alive",
+           (unsigned long)opts.payloadBytes, opts.durationMs);
+
+    std::vector<WorkerResult> results(opts.connections > 0 ? opts.connections : 1);
+    const ptime start(microsec_clock::universal_time());
+    const ptime deadline = start + boost::posix_time::milliseconds(opts.durationMs);
+
+    boost::thread_group workers;
+    for (size_t i = 0; i < results.size(); ++i)
+        workers.create_thread(boost::bind(&clientWorker, &opts, port, deadline,
+                                          &results[i]));
+    workers.join_all();
+    const double seconds =
+        (microsec_clock::universal_time() - start).total_microseconds() / 1000000.0;
+
+    boost::uint64_t requests = 0, failures = 0, bytes = 0;
+    std::vector<boost::uint32_t> samples;
+    for (size_t i = 0; i < results.size(); ++i) {
+        requests += results[i].requests;
+        failures += results[i].failures;
+        bytes += results[i].bytes;
+        samples.insert(samples.end(), results[i].samples.begin(),
+                       results[i].samples.end());
+    }
+    std::sort(samples.begin(), samples.end());
+
+    printf("%llu requests in %.2fs (%llu failed): %.0f req/sec, %.2f MB/sec\n",
+           (unsigned long long)requests, seconds, (unsigned long long)failures,
+           requests / seconds, bytes / seconds / (1024.0 * 1024.0));
+    printf("latency us: p50=%u p90=%u p99=%u max=%u\n",
+           percentile(samples, 50), percentile(samples, 90), percentile(samples, 99),
+           samples.empty() ? 0u : samples.back());
+
+    service->terminate();
+    return failures && !requests ? 1 : 0;
+}
+
@@ -0,0 +1,322 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+// jsoncpp parse/serialize micro-benchmarks.  Four representative corpora
+// (deep nesting, large array, number-heavy, string-heavy) are run through
+// both the DOM and streaming APIs:
+//
+//   parse DOM           Reader::parse into a Value tree
+//   parse DOM+arena     same, with Reader::setArena string allocation
+//   parse SAX           Reader::parse through a StreamHandler (no tree)
+//   write FastWriter    Value tree back to a string, legacy writer
+//   write Buffered      Value tree back to a string, BufferedWriter
+//
+// Each line reports throughput in MB/s over the document text plus the heap
+// allocations a single document costs (counted via replaced operator new).
+// Like the other benches it is not wired into the post-build test run; run
+// it by hand on a quiet machine and compare release to release.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "json/json.h"
+
+// Allocation counter; the bench is single threaded so a plain counter is fine
+static unsigned long g_allocCount = 0;
+
+void* operator new(std::size_t size)
+{
+    ++g_allocCount;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size)
+{
+    ++g_allocCount;
+    void* p = std::malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) throw() { std::free(p); }
+void operator delete[](void* p) throw() { std::free(p); }
+
+namespace
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  CountingHandler
+    ///
+    /// @brief  StreamHandler that just counts events; the cheapest possible consumer,
+    ///         so the SAX numbers measure the parser and not the handler
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class CountingHandler : public Json::StreamHandler
+    {
+    public:
+        CountingHandler() : events(0) {}
+        size_t events;
+
+        bool beginObject() { ++events; return true; }
+        bool endObject() { ++events; return true; }
+        bool beginArray() { ++events; return true; }
+        bool endArray() { ++events; return true; }
+        bool key( const std::string& ) { ++events; return true; }
+        bool stringValue( const std::string& ) { ++events; return true; }
+        bool intValue( Json::Value::Int ) { ++events; return true; }
+        bool uintValue( Json::Value::UInt ) { ++events; return true; }
+        bool doubleValue( double ) { ++events; return true; }
+        bool boolValue( bool ) { ++events; return true; }
+        bool nullValue() { ++events; return true; }
+    };
+
+    double elapsedSeconds(const boost::posix_time::ptime& start)
+    {
+        boost::posix_time::time_duration d =
+            boost::posix_time::microsec_clock::universal_time() - start;
+        return d.total_microseconds() / 1e6;
+    }
+
+    void report(const char* corpus, const char* mode, size_t bytesPerDoc,
+                size_t iterations, double seconds, unsigned long allocsPerDoc)
+    {
+        double mbPerSec = (double)bytesPerDoc * iterations / (1024.0 * 1024.0) / seconds;
+        printf("%-14s %-18s %9.1f MB/s  %9lu allocs/doc\n",
+               corpus, mode, mbPerSec, allocsPerDoc);
+        fflush(stdout);
+    }
+
+    // ---------------------------------------------------------------------
+    // Corpora.  Sizes are chosen so a single document is big enough to
+    // dominate per-call overhead but small enough to stay cache-unfriendly
+    // in the way real payloads are.
+    // ---------------------------------------------------------------------
+
+    // 200 levels of {"a":[ ... ]} nesting; exercises the recursion and
+    // structural-token paths
+    std::string makeDeepCorpus()
+    {
+        const int depth = 200;
+        std::string doc;
+        for (int i = 0; i < depth; ++i)
+            doc += "{\"a\":[";
+        doc += "null";
+        for (int i = 0; i < depth; ++i)
+            doc += "]}";
+        return doc;
+    }
+
+    // one flat array of 100k small objects; exercises array growth and
+    // member insertion
+    std::string makeLargeArrayCorpus()
+    {
+        std::string doc("[");
+        char buf[64];
+        for (int i = 0; i < 100000; ++i) {
+            sprintf(buf, "%s{\"i\":%d,\"f\":true}", i ? "," : "", i);
+            doc += buf;
+        }
+        doc += "]";
+        return doc;
+    }
+
+    // 150k mixed integers and reals; exercises number scanning/conversion
+    std::string makeNumberHeavyCorpus()
+    {
+        std::string doc("[");
+        char buf[64];
+        for (int i = 0; i < 150000; ++i) {
+            if (i % 3 == 0)
+                sprintf(buf, "%s%d", i ? "," : "", i * 7 - 500000);
+            else
+                sprintf(buf, "%s%d.%04d", i ? "," : "", i, i % 10000);
+            doc += buf;
+        }
+        doc += "]";
+        return doc;
+    }
+
+    // 20k objects with short string members, some needing escape decoding
+    std::string makeStringHeavyCorpus()
+    {
+        std::string doc("[");
+        char buf[160];
+        for (int i = 0; i < 20000; ++i) {
+            sprintf(buf, "%s{\"name\":\"item number %06d\","
+                         "\"path\":\"C:\\\\temp\\\\file_%d.dat\","
+                         "\"desc\":\"some \\\"quoted\\\" text\\n\"}",
+                    i ? "," : "", i, i);
+            doc += buf;
+        }
+        doc += "]";
+        return doc;
+    }
+
+    // ---------------------------------------------------------------------
+    // Benchmark runners.  Each does one untimed warm-up pass that also
+    // measures allocations, then a timed loop.
+    // ---------------------------------------------------------------------
+
+    // Aim for roughly this much parsed/written text per measurement
+    const double kTargetBytes = 256.0 * 1024 * 1024;
+
+    size_t iterationsFor(size_t docBytes)
+    {
+        size_t iters = (size_t)(kTargetBytes / docBytes);
+        return iters ? iters : 1;
+    }
+
+    void benchParseDom(const char* corpus, const std::string& doc)
+    {
+        Json::Reader reader;
+        unsigned long allocs;
+        {
+            Json::Value root;
+            unsigned long before = g_allocCount;
+            if (!reader.parse(doc, root, false)) {
+                printf("%-14s parse DOM         PARSE FAILED\n", corpus);
+                return;
+            }
+            allocs = g_allocCount - before;
+        }
+        size_t iters = iterationsFor(doc.size());
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i) {
+            Json::Value root;
+            reader.parse(doc, root, false);
+        }
+        report(corpus, "parse DOM", doc.size(), iters, elapsedSeconds(start), allocs);
+    }
+
+    void benchParseDomArena(const char* corpus, const std::string& doc)
+    {
+        Json::Reader reader;
+        Json::ValueArena arena;
+        reader.setArena(&arena);
+        unsigned long allocs;
+        {
+            Json::Value root;
+            unsigned long before = g_allocCount;
+            if (!reader.parse(doc, root, false)) {
+                printf("%-14s parse DOM+arena   PARSE FAILED\n", corpus);
+                return;
+            }
+            allocs = g_allocCount - before;
+        }
+        arena.reset();
+        size_t iters = iterationsFor(doc.size());
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i) {
+            {
+                Json::Value root;
+                reader.parse(doc, root, false);
+            }
+            // the tree must be gone before the strings under it are reclaimed
+            arena.reset();
+        }
+        report(corpus, "parse DOM+arena", doc.size(), iters, elapsedSeconds(start), allocs);
+    }
+
+    void benchParseSax(const char* corpus, const std::string& doc)
+    {
+        Json::Reader reader;
+        unsigned long allocs;
+        {
+            CountingHandler handler;
+            unsigned long before = g_allocCount;
+            if (!reader.parse(doc, handler)) {
+                printf("%-14s parse SAX         PARSE FAILED\n", corpus);
+                return;
+            }
+            allocs = g_allocCount - before;
+        }
+        size_t iters = iterationsFor(doc.size());
+        CountingHandler handler;
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i)
+            reader.parse(doc, handler);
+        report(corpus, "parse SAX", doc.size(), iters, elapsedSeconds(start), allocs);
+    }
+
+    void benchWriteFast(const char* corpus, const std::string& doc)
+    {
+        Json::Reader reader;
+        Json::Value root;
+        if (!reader.parse(doc, root, false))
+            return;
+        Json::FastWriter writer;
+        unsigned long allocs;
+        size_t outBytes;
+        {
+            unsigned long before = g_allocCount;
+            std::string out = writer.write(root);
+            allocs = g_allocCount - before;
+            outBytes = out.size();
+        }
+        size_t iters = iterationsFor(outBytes);
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i)
+            writer.write(root);
+        report(corpus, "write FastWriter", outBytes, iters, elapsedSeconds(start), allocs);
+    }
+
+    void benchWriteBuffered(const char* corpus, const std::string& doc)
+    {
+        Json::Reader reader;
+        Json::Value root;
+        if (!reader.parse(doc, root, false))
+            return;
+        Json::BufferedWriter writer;
+        unsigned long allocs;
+        size_t outBytes;
+        std::string out;
+        {
+            unsigned long before = g_allocCount;
+            writer.write(root, out);
+            allocs = g_allocCount - before;
+            outBytes = out.size();
+        }
+        size_t iters = iterationsFor(outBytes);
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i) {
+            out.clear();
+            writer.write(root, out);
+        }
+        report(corpus, "write Buffered", outBytes, iters, elapsedSeconds(start), allocs);
+    }
+
+    void benchCorpus(const char* name, const std::string& doc)
+    {
+        printf("-- %s: %lu bytes/doc --\n", name, (unsigned long)doc.size());
+        benchParseDom(name, doc);
+        benchParseDomArena(name, doc);
+        benchParseSax(name, doc);
+        benchWriteFast(name, doc);
+        benchWriteBuffered(name, doc);
+    }
+}
+
+int main()
+{
+    benchCorpus("deep", makeDeepCorpus());
+    benchCorpus("large-array", makeLargeArrayCorpus());
+    benchCorpus("number-heavy", makeNumberHeavyCorpus());
+    benchCorpus("string-heavy", makeStringHeavyCorpus());
+    return 0;
+}
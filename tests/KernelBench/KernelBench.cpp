@@ -0,0 +1,265 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+// Throughput benchmarks for the pure-CPU kernels in the upload data path:
+// Tiger hashing, the base64 codec and the utf8 conversions.  Each kernel is
+// run across several buffer sizes and input alignments and, where two
+// implementations of the same operation exist, both are measured so the
+// faster path can be proven and kept honest:
+//
+//   tiger stream            Tiger::process_bytes over one buffer
+//   tiger leaves scalar     one Tiger per 1KiB leaf, sequentially
+//   tiger leaves batch      Tiger::hash_leaves (dual-lane pair compress)
+//   base64 enc string       base64_encode (std::string API)
+//   base64 enc block        base64_encode_block into a raw buffer
+//   base64 dec block        base64_decode_block
+//   utf8 narrow ascii       wstring_to_utf8, pure-ASCII input (fast path)
+//   utf8 narrow mixed       wstring_to_utf8, input with non-ASCII every ~16 chars
+//   utf8 widen ascii/mixed  utf8_to_wstring over the same corpora
+//
+// Results are GB/s over the input bytes.  Run by hand on a quiet machine;
+// like the other benches this is not wired into the post-build test run.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "HTTPCommon/Tiger.h"
+#include "HTTPCommon/base64.h"
+#include "utf8_tools.h"
+
+namespace
+{
+    double elapsedSeconds(const boost::posix_time::ptime& start)
+    {
+        boost::posix_time::time_duration d =
+            boost::posix_time::microsec_clock::universal_time() - start;
+        return d.total_microseconds() / 1e6;
+    }
+
+    void report(const char* kernel, size_t bufBytes, size_t align,
+                size_t totalBytes, double seconds)
+    {
+        double gbPerSec = (double)totalBytes / (1024.0 * 1024.0 * 1024.0) / seconds;
+        printf("%-22s %8lu B  +%lu  %8.3f GB/s\n",
+               kernel, (unsigned long)bufBytes, (unsigned long)align, gbPerSec);
+        fflush(stdout);
+    }
+
+    // Aim for roughly this many bytes per measurement
+    const double kTargetBytes = 1024.0 * 1024 * 1024;
+
+    size_t iterationsFor(size_t bufBytes)
+    {
+        size_t iters = (size_t)(kTargetBytes / bufBytes);
+        return iters ? iters : 1;
+    }
+
+    // Keeps results observable so the kernel calls can't be dropped
+    volatile unsigned long g_sink = 0;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  AlignedBuffer
+    ///
+    /// @brief  Backing store with room to offset the start pointer, so the same kernel can be
+    ///         timed on aligned and deliberately misaligned input
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class AlignedBuffer
+    {
+    public:
+        AlignedBuffer(size_t size, size_t offset)
+            : m_storage(size + 64 + offset)
+        {
+            // round the base up to 64 bytes, then nudge it by the offset
+            size_t base = reinterpret_cast<size_t>(&m_storage[0]);
+            size_t aligned = (base + 63) & ~(size_t)63;
+            m_data = reinterpret_cast<char*>(aligned) + offset;
+            // deterministic non-trivial content
+            for (size_t i = 0; i < size; ++i)
+                m_data[i] = (char)(i * 131 + 17);
+        }
+        char* data() { return m_data; }
+    private:
+        std::vector<char> m_storage;
+        char* m_data;
+    };
+
+    // ---------------------------------------------------------------------
+    // Tiger
+    // ---------------------------------------------------------------------
+
+    void benchTigerStream(size_t bufBytes, size_t align)
+    {
+        AlignedBuffer buf(bufBytes, align);
+        size_t iters = iterationsFor(bufBytes);
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i) {
+            Tiger t;
+            t.process_bytes(buf.data(), bufBytes);
+            t.finalize();
+            g_sink += (unsigned long)t.hash[0];
+        }
+        report("tiger stream", bufBytes, align, bufBytes * iters, elapsedSeconds(start));
+    }
+
+    void benchTigerLeaves(size_t bufBytes, size_t align, bool batch)
+    {
+        const size_t leafSize = 1024;
+        size_t leafCount = bufBytes / leafSize;
+        if (!leafCount)
+            return;
+        AlignedBuffer buf(leafCount * leafSize, align);
+
+        std::vector<const void*> leaves(leafCount);
+        std::vector<size_t> lengths(leafCount, leafSize);
+        for (size_t i = 0; i < leafCount; ++i)
+            leaves[i] = buf.data() + i * leafSize;
+        std::vector<Tiger> results(leafCount);
+
+        size_t iters = iterationsFor(leafCount * leafSize);
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i) {
+            if (batch) {
+                Tiger::hash_leaves(&leaves[0], &lengths[0], &results[0], leafCount);
+            } else {
+                for (size_t n = 0; n < leafCount; ++n) {
+                    results[n].reset();
+                    results[n].process_bytes(leaves[n], lengths[n]);
+                    results[n].finalize();
+                }
+            }
+            g_sink += (unsigned long)results[0].hash[0];
+        }
+        report(batch ? "tiger leaves batch" : "tiger leaves scalar",
+               bufBytes, align, leafCount * leafSize * iters, elapsedSeconds(start));
+    }
+
+    // ---------------------------------------------------------------------
+    // base64
+    // ---------------------------------------------------------------------
+
+    void benchBase64EncodeString(size_t bufBytes, size_t align)
+    {
+        AlignedBuffer buf(bufBytes, align);
+        std::string input(buf.data(), bufBytes);
+        size_t iters = iterationsFor(bufBytes);
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i) {
+            std::string out = base64_encode(input);
+            g_sink += out.size();
+        }
+        report("base64 enc string", bufBytes, align, bufBytes * iters, elapsedSeconds(start));
+    }
+
+    void benchBase64EncodeBlock(size_t bufBytes, size_t align)
+    {
+        AlignedBuffer buf(bufBytes, align);
+        std::vector<char> out(base64_encoded_size(bufBytes));
+        size_t iters = iterationsFor(bufBytes);
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i)
+            g_sink += base64_encode_block(buf.data(), bufBytes, &out[0]);
+        report("base64 enc block", bufBytes, align, bufBytes * iters, elapsedSeconds(start));
+    }
+
+    void benchBase64DecodeBlock(size_t bufBytes, size_t align)
+    {
+        AlignedBuffer buf(bufBytes, align);
+        std::vector<char> encoded(base64_encoded_size(bufBytes));
+        size_t encLen = base64_encode_block(buf.data(), bufBytes, &encoded[0]);
+        std::vector<char> out(base64_decoded_size(encLen));
+        size_t iters = iterationsFor(encLen);
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i)
+            g_sink += base64_decode_block(&encoded[0], encLen, &out[0]);
+        report("base64 dec block", encLen, align, encLen * iters, elapsedSeconds(start));
+    }
+
+    // ---------------------------------------------------------------------
+    // utf8
+    // ---------------------------------------------------------------------
+
+    std::wstring makeWide(size_t chars, bool ascii)
+    {
+        std::wstring ws;
+        ws.reserve(chars);
+        for (size_t i = 0; i < chars; ++i) {
+            // never in the final position: the validation pass predates the fast
+            // path and rejects a sequence it can't finish at end-of-input
+            if (!ascii && i % 16 == 7)
+                ws += (wchar_t)0x00e9; // e-acute; forces the general path
+            else
+                ws += (wchar_t)('a' + i % 26);
+        }
+        return ws;
+    }
+
+    void benchUtf8Narrow(size_t chars, bool ascii)
+    {
+        std::wstring ws(makeWide(chars, ascii));
+        std::string out;
+        size_t inputBytes = ws.size() * sizeof(wchar_t);
+        size_t iters = iterationsFor(inputBytes);
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i) {
+            FB::wstring_to_utf8(ws, out);
+            g_sink += out.size();
+        }
+        report(ascii ? "utf8 narrow ascii" : "utf8 narrow mixed",
+               inputBytes, 0, inputBytes * iters, elapsedSeconds(start));
+    }
+
+    void benchUtf8Widen(size_t chars, bool ascii)
+    {
+        std::string utf8(FB::wstring_to_utf8(makeWide(chars, ascii)));
+        std::wstring out;
+        size_t iters = iterationsFor(utf8.size());
+        boost::posix_time::ptime start(boost::posix_time::microsec_clock::universal_time());
+        for (size_t i = 0; i < iters; ++i) {
+            FB::utf8_to_wstring(utf8, out);
+            g_sink += out.size();
+        }
+        report(ascii ? "utf8 widen ascii" : "utf8 widen mixed",
+               utf8.size(), 0, utf8.size() * iters, elapsedSeconds(start));
+    }
+}
+
+int main()
+{
+    const size_t sizes[] = { 4 * 1024, 64 * 1024, 1024 * 1024 };
+    const size_t aligns[] = { 0, 1 };
+
+    printf("%-22s %10s %4s %12s\n", "kernel", "buffer", "ofs", "throughput");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        for (size_t a = 0; a < sizeof(aligns) / sizeof(aligns[0]); ++a) {
+            benchTigerStream(sizes[s], aligns[a]);
+            benchTigerLeaves(sizes[s], aligns[a], false);
+            benchTigerLeaves(sizes[s], aligns[a], true);
+            benchBase64EncodeString(sizes[s], aligns[a]);
+            benchBase64EncodeBlock(sizes[s], aligns[a]);
+            benchBase64DecodeBlock(sizes[s], aligns[a]);
+        }
+    }
+    // alignment is controlled by the string implementations here, so the
+    // utf8 kernels only vary by content and size
+    benchUtf8Narrow(64 * 1024, true);
+    benchUtf8Narrow(64 * 1024, false);
+    benchUtf8Widen(64 * 1024, true);
+    benchUtf8Widen(64 * 1024, false);
+
+    return (int)(g_sink & 1) * 0; // keep g_sink live without affecting exit status
+}
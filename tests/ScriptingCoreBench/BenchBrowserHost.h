@@ -0,0 +1,76 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2012 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_FB_BENCHBROWSERHOST
+#define H_FB_BENCHBROWSERHOST
+
+#include <utility>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include "BrowserHost.h"
+#include "SafeQueue.h"
+#include "DOM.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// @class  BenchBrowserHost
+///
+/// @brief  Minimal BrowserHost for benchmarking; no real browser behind it
+///
+/// The thread that constructs it plays the browser main thread: worker threads schedule
+/// async calls into a queue and the main thread services them with drainOne() in a loop,
+/// which is enough to drive CrossThreadCall round-trips.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+class BenchBrowserHost : public FB::BrowserHost
+{
+public:
+    BenchBrowserHost() {}
+
+    // Runs one pending async call; returns false if none arrived within the timeout
+    bool drainOne(const boost::posix_time::time_duration& timeout)
+    {
+        AsyncCall call;
+        if (!m_queue.timed_wait_and_pop(call, timeout))
+            return false;
+        call.first(call.second);
+        return true;
+    }
+
+    void* getContextID() const { return (void*)this; }
+    FB::DOM::DocumentPtr getDOMDocument() { return FB::DOM::DocumentPtr(); }
+    FB::DOM::WindowPtr getDOMWindow() { return FB::DOM::WindowPtr(); }
+    FB::DOM::ElementPtr getDOMElement() { return FB::DOM::ElementPtr(); }
+    void evaluateJavaScript(const std::string& script) {}
+    void DoDeferredRelease() const {}
+
+protected:
+    bool _scheduleAsyncCall(void (*func)(void *), void *userData) const
+    {
+        m_queue.push(AsyncCall(func, userData));
+        return true;
+    }
+    FB::BrowserStreamPtr _createStream(const FB::BrowserStreamRequest& req) const
+    {
+        return FB::BrowserStreamPtr();
+    }
+    FB::BrowserStreamPtr _createUnsolicitedStream(const FB::BrowserStreamRequest& req) const
+    {
+        return FB::BrowserStreamPtr();
+    }
+
+private:
+    typedef std::pair<void (*)(void *), void*> AsyncCall;
+    mutable FB::SafeQueue<AsyncCall> m_queue;
+};
+
+#endif // H_FB_BENCHBROWSERHOST
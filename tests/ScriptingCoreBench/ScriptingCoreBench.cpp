@@ -0,0 +1,192 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2012 Firebreath development team
+\**********************************************************/
+
+// Scripting bridge micro-benchmarks.  Each benchmark reports ns/op so the
+// numbers can be tracked release to release; run the binary manually (it is
+// not wired into the post-build test run, timings in CI are too noisy).
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "variant.h"
+#include "variant_list.h"
+#include "JSAPIAuto.h"
+#include "CrossThreadCall.h"
+#include "BenchBrowserHost.h"
+
+namespace
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    /// @class  BenchTimer
+    ///
+    /// @brief  Scoped timer; prints name and ns/op when it goes out of scope
+    ////////////////////////////////////////////////////////////////////////////////////////////////////
+    class BenchTimer
+    {
+    public:
+        BenchTimer(const char* name, size_t iterations)
+            : m_name(name), m_iterations(iterations),
+              m_start(boost::posix_time::microsec_clock::universal_time()) {}
+        ~BenchTimer()
+        {
+            boost::posix_time::time_duration elapsed =
+                boost::posix_time::microsec_clock::universal_time() - m_start;
+            double nsPerOp = elapsed.total_microseconds() * 1000.0 / m_iterations;
+            printf("%-40s %12.1f ns/op  (%lu ops)\n", m_name, nsPerOp,
+                   (unsigned long)m_iterations);
+            fflush(stdout);
+        }
+    private:
+        const char* m_name;
+        size_t m_iterations;
+        boost::posix_time::ptime m_start;
+    };
+
+    // Keeps the optimizer from dropping benchmark bodies
+    size_t g_sink = 0;
+
+    class BenchAPI : public FB::JSAPIAuto
+    {
+    public:
+        BenchAPI() : m_value(42)
+        {
+            registerMethod("add", FB::make_method(this, &BenchAPI::add));
+            registerProperty("value42", FB::make_property(this, &BenchAPI::get_value, &BenchAPI::set_value));
+        }
+        long add(long a, long b) { return a + b; }
+        long get_value() const { return m_value; }
+        void set_value(long v) { m_value = v; }
+    private:
+        long m_value;
+    };
+
+    struct SyncCallOp
+    {
+        typedef long result_type;
+        long operator()() const { return ++g_sink; }
+    };
+
+    void syncCallWorker(const FB::BrowserHostPtr& host, size_t iterations, volatile bool* done)
+    {
+        for (size_t i = 0; i < iterations; ++i) {
+            g_sink += FB::CrossThreadCall::syncCall(host, SyncCallOp());
+        }
+        *done = true;
+    }
+}
+
+static void benchVariant()
+{
+    const size_t N = 2000000;
+    {
+        BenchTimer t("variant: assign int", N);
+        FB::variant v;
+        for (size_t i = 0; i < N; ++i)
+            v = (int)i;
+    }
+    {
+        BenchTimer t("variant: assign double", N);
+        FB::variant v;
+        for (size_t i = 0; i < N; ++i)
+            v = (double)i;
+    }
+    {
+        BenchTimer t("variant: assign short string", N);
+        FB::variant v;
+        const std::string s("hello world");
+        for (size_t i = 0; i < N; ++i)
+            v = s;
+    }
+    {
+        BenchTimer t("variant: int -> double convert_cast", N);
+        FB::variant v(12345);
+        for (size_t i = 0; i < N; ++i)
+            g_sink += (size_t)v.convert_cast<double>();
+    }
+    const size_t M = 500000;
+    {
+        BenchTimer t("variant: double -> string convert_cast", M);
+        FB::variant v(3.14159);
+        for (size_t i = 0; i < M; ++i)
+            g_sink += v.convert_cast<std::string>().size();
+    }
+    {
+        BenchTimer t("variant: string -> double convert_cast", M);
+        FB::variant v(std::string("3.14159"));
+        for (size_t i = 0; i < M; ++i)
+            g_sink += (size_t)v.convert_cast<double>();
+    }
+}
+
+static void benchJSAPIAuto()
+{
+    const size_t N = 500000;
+    boost::shared_ptr<BenchAPI> api(new BenchAPI());
+    {
+        BenchTimer t("JSAPIAuto: construct + destroy", 50000);
+        for (size_t i = 0; i < 50000; ++i) {
+            boost::shared_ptr<BenchAPI> tmp(new BenchAPI());
+            g_sink += (size_t)tmp->getMemberCount();
+        }
+    }
+    {
+        FB::VariantList args(FB::variant_list_of(2)(40));
+        BenchTimer t("JSAPIAuto: Invoke(add)", N);
+        for (size_t i = 0; i < N; ++i)
+            g_sink += (size_t)api->Invoke("add", args).cast<long>();
+    }
+    {
+        BenchTimer t("JSAPIAuto: GetProperty", N);
+        for (size_t i = 0; i < N; ++i)
+            g_sink += (size_t)api->GetProperty("value42").cast<long>();
+    }
+    {
+        BenchTimer t("JSAPIAuto: getMemberNames", N);
+        std::vector<std::string> names;
+        for (size_t i = 0; i < N; ++i) {
+            api->getMemberNames(names);
+            g_sink += names.size();
+        }
+    }
+}
+
+static void benchCrossThreadCall()
+{
+    const size_t N = 20000;
+    FB::BrowserHostPtr host(new BenchBrowserHost());
+    BenchBrowserHost* bench = static_cast<BenchBrowserHost*>(host.get());
+    volatile bool done = false;
+    {
+        BenchTimer t("CrossThreadCall: syncCall round-trip", N);
+        boost::thread worker(boost::bind(&syncCallWorker, host, N, &done));
+        while (!done)
+            bench->drainOne(boost::posix_time::milliseconds(10));
+        worker.join();
+    }
+    host->shutdown();
+}
+
+int main()
+{
+    printf("ScriptingCore benchmarks\n");
+    benchVariant();
+    benchJSAPIAuto();
+    benchCrossThreadCall();
+    printf("(sink=%lu)\n", (unsigned long)g_sink);
+    return 0;
+}
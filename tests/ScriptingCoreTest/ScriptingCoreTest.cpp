@@ -25,9 +25,36 @@ Copyright 2009 Richard Bateman, Firebreath development team
 // fixing as JSAPISimple is deprecated anyway
 //#include "jsapi_test.h" 
 #include "jsapiauto_test.h"
+#include "staticmembertable_test.h"
+#include "membertable_test.h"
 #include "jsarray_test.h"
 #include "TypeIDMap_test.h"
+#include "threadcachedpool_test.h"
+#include "boundedsafequeue_test.h"
+#include "dommutationbatch_test.h"
+#include "domnodecache_test.h"
+#include "domdocumentquery_test.h"
+#include "domwaiter_test.h"
 #include "jscallback_test.h"
+#include "jsapiconflation_test.h"
+#include "binarylog_test.h"
+#include "logsourcelevels_test.h"
+#include "lograte_test.h"
+#include "asyncdrawpool_test.h"
+#include "pluginwindowdirty_test.h"
+#include "threadedrender_test.h"
+#include "startuptimer_test.h"
+#include "timerpause_test.h"
+#include "timernamespace_test.h"
+#include "streamreader_test.h"
+#include "streamhandler_test.h"
+#include "streamstats_test.h"
+#include "streaminflater_test.h"
+#include "streamwritev_test.h"
+#include "callreplay_test.h"
+#include "httpcache_test.h"
+#include "headerview_test.h"
+#include "stringintern_test.h"
 
 int main()
 {
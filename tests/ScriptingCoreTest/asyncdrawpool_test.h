@@ -0,0 +1,138 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_ASYNCDRAWPOOL_TEST
+#define H_ASYNCDRAWPOOL_TEST
+
+#include <boost/thread.hpp>
+#include "AsyncDrawBufferPool.h"
+
+TEST(AsyncDrawBufferPoolTriple)
+{
+    PRINT_TESTNAME;
+
+    FB::AsyncDrawBufferPool<int> pool; // default: triple buffered
+    CHECK_EQUAL(3u, (unsigned)pool.size());
+
+    // nothing published yet
+    CHECK(pool.beginPresent() == NULL);
+
+    pool.renderBuffer() = 1;
+    pool.publish();
+
+    int* frame = pool.beginPresent();
+    CHECK(frame != NULL);
+    CHECK_EQUAL(1, *frame);
+
+    // render the next frame while the presenter still holds this one
+    pool.renderBuffer() = 2;
+    pool.publish();
+    CHECK(&pool.renderBuffer() != frame);
+    pool.endPresent();
+
+    frame = pool.beginPresent();
+    CHECK(frame != NULL);
+    CHECK_EQUAL(2, *frame);
+    pool.endPresent();
+
+    // two publishes with no present in between: latest wins, one frame dropped
+    pool.renderBuffer() = 3;
+    pool.publish();
+    pool.renderBuffer() = 4;
+    pool.publish();
+    frame = pool.beginPresent();
+    CHECK(frame != NULL);
+    CHECK_EQUAL(4, *frame);
+    pool.endPresent();
+    CHECK_EQUAL(1u, (unsigned)pool.droppedFrames());
+
+    pool.reset();
+    CHECK(pool.beginPresent() == NULL);
+}
+
+TEST(AsyncDrawBufferPoolDouble)
+{
+    PRINT_TESTNAME;
+
+    FB::AsyncDrawBufferPool<int> pool(2);
+    CHECK_EQUAL(2u, (unsigned)pool.size());
+
+    pool.renderBuffer() = 10;
+    pool.publish();
+
+    int* frame = pool.beginPresent();
+    CHECK(frame != NULL);
+    CHECK_EQUAL(10, *frame);
+
+    // with only two buffers a publish mid-present is dropped rather than blocking
+    pool.renderBuffer() = 11;
+    pool.publish();
+    CHECK_EQUAL(1u, (unsigned)pool.droppedFrames());
+    pool.endPresent();
+
+    // and the render slot is simply drawn over by the next frame
+    pool.renderBuffer() = 12;
+    pool.publish();
+    frame = pool.beginPresent();
+    CHECK(frame != NULL);
+    CHECK_EQUAL(12, *frame);
+    pool.endPresent();
+}
+
+namespace AsyncDrawPoolTest {
+    struct Presenter {
+        FB::AsyncDrawBufferPool<int>* pool;
+        int last;
+        int presented;
+        void run() {
+            while (last < 500) {
+                if (int* frame = pool->beginPresent()) {
+                    CHECK(*frame > last);   // frames arrive in order, never torn
+                    last = *frame;
+                    ++presented;
+                    pool->endPresent();
+                } else {
+                    boost::this_thread::yield();
+                }
+            }
+        }
+    };
+}
+
+TEST(AsyncDrawBufferPoolThreaded)
+{
+    PRINT_TESTNAME;
+
+    FB::AsyncDrawBufferPool<int> pool;
+    AsyncDrawPoolTest::Presenter p;
+    p.pool = &pool;
+    p.last = 0;
+    p.presented = 0;
+
+    boost::thread presenter(boost::bind(&AsyncDrawPoolTest::Presenter::run, &p));
+    for (int frame = 1; frame <= 500; ++frame) {
+        pool.renderBuffer() = frame;
+        pool.publish();
+        if ((frame % 50) == 0)
+            boost::this_thread::yield();
+    }
+    presenter.join();
+
+    CHECK_EQUAL(500, p.last);
+    // every frame was either presented or dropped; none vanished
+    CHECK_EQUAL(500u, (unsigned)(p.presented + pool.droppedFrames()));
+}
+
+#endif
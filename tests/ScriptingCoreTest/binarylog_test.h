@@ -0,0 +1,71 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_BINARYLOG_TEST
+#define H_BINARYLOG_TEST
+
+#include <cstdio>
+#include <fstream>
+#include "BinaryLog.h"
+
+TEST(BinaryLogRoundTrip)
+{
+    PRINT_TESTNAME;
+
+    const std::string binPath("binarylog_test.fbbl");
+    const std::string txtPath("binarylog_test.txt");
+
+    CHECK(!FB::Log::binaryLogEnabled());
+    FB::Log::logBinary(1); // no stream open: must be a harmless no-op
+
+    FB::Log::initBinaryLog(binPath);
+    CHECK(FB::Log::binaryLogEnabled());
+
+    FB::Log::logBinary(1);
+    FB::Log::logBinary(2, 42);
+    FB::Log::logBinary(3, -7, 1000);
+    FB::Log::logBinary(4, 1, 2, 3, 4);
+
+    FB::Log::stopBinaryLog();
+    CHECK(!FB::Log::binaryLogEnabled());
+
+    FB::Log::BinaryEventNameMap names;
+    names[1] = "npp_new";
+    names[2] = "npp_write";
+    names[3] = "npp_destroy";
+    CHECK(FB::Log::formatBinaryLog(binPath, txtPath, names));
+
+    std::ifstream txt(txtPath.c_str());
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(txt, line))
+        lines.push_back(line);
+    txt.close();
+
+    CHECK_EQUAL(4u, (unsigned)lines.size());
+    // each line is "<timestamp> <name>(<id>): args..."; check everything after the timestamp
+    CHECK(lines[0].find(" npp_new(1):") != std::string::npos);
+    CHECK(lines[1].find(" npp_write(2): 42") != std::string::npos);
+    CHECK(lines[2].find(" npp_destroy(3): -7 1000") != std::string::npos);
+    CHECK(lines[3].find(" event#4(4): 1 2 3 4") != std::string::npos);
+
+    // a file that isn't a binary log is rejected
+    CHECK(!FB::Log::formatBinaryLog(txtPath, binPath + ".out", names));
+
+    std::remove(binPath.c_str());
+    std::remove(txtPath.c_str());
+}
+
+#endif
@@ -0,0 +1,97 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_BOUNDEDSAFEQUEUE_TEST
+#define H_BOUNDEDSAFEQUEUE_TEST
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include "BoundedSafeQueue.h"
+
+namespace BoundedQueueTestHelpers {
+    static void producer(FB::BoundedSafeQueue<int>* queue, int start, int count)
+    {
+        for (int i = 0; i < count; ++i)
+            queue->push(start + i);
+    }
+    static void consumer(FB::BoundedSafeQueue<int>* queue, int count, long* sum)
+    {
+        for (int i = 0; i < count; ++i) {
+            int val(0);
+            queue->wait_and_pop(val);
+            *sum += val;
+        }
+    }
+}
+
+TEST(BoundedSafeQueueBasics)
+{
+    PRINT_TESTNAME;
+
+    FB::BoundedSafeQueue<int> queue(4);
+    CHECK(queue.empty());
+
+    // FIFO order is kept and try_push refuses once the ring is full
+    CHECK(queue.try_push(1));
+    CHECK(queue.try_push(2));
+    CHECK(queue.try_push(3));
+    CHECK(queue.try_push(4));
+    CHECK(!queue.try_push(5));
+
+    int val(0);
+    CHECK(queue.try_pop(val));
+    CHECK_EQUAL(1, val);
+    CHECK(queue.try_pop(val));
+    CHECK_EQUAL(2, val);
+
+    // Freed slots become usable again
+    CHECK(queue.try_push(5));
+    CHECK(queue.try_pop(val));
+    CHECK_EQUAL(3, val);
+    CHECK(queue.try_pop(val));
+    CHECK_EQUAL(4, val);
+    CHECK(queue.try_pop(val));
+    CHECK_EQUAL(5, val);
+    CHECK(!queue.try_pop(val));
+    CHECK(queue.empty());
+
+    // Timed pop on an empty queue times out
+    CHECK(!queue.timed_wait_and_pop(val, boost::posix_time::milliseconds(5)));
+}
+
+TEST(BoundedSafeQueueMPMC)
+{
+    PRINT_TESTNAME;
+
+    using namespace BoundedQueueTestHelpers;
+    const int perProducer = 5000;
+
+    FB::BoundedSafeQueue<int> queue(64);
+    long sum1(0), sum2(0);
+    boost::thread c1(boost::bind(&consumer, &queue, perProducer, &sum1));
+    boost::thread c2(boost::bind(&consumer, &queue, perProducer, &sum2));
+    boost::thread p1(boost::bind(&producer, &queue, 1, perProducer));
+    boost::thread p2(boost::bind(&producer, &queue, perProducer + 1, perProducer));
+    p1.join(); p2.join();
+    c1.join(); c2.join();
+
+    // Every pushed value was popped exactly once, whichever consumer got it
+    const long expected = static_cast<long>(2 * perProducer) * (2 * perProducer + 1) / 2;
+    CHECK_EQUAL(expected, sum1 + sum2);
+    CHECK(queue.empty());
+}
+
+#endif
+
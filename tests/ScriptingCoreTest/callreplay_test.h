@@ -0,0 +1,112 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+#pragma once
+
+#include <cstdio>
+#include <boost/make_shared.hpp>
+#include "JSAPIAuto.h"
+#include "CallRecorder.h"
+#include "CallReplayer.h"
+#include "variant_list.h"
+
+namespace callreplay_test_detail
+{
+    class ReplayTestAPI : public FB::JSAPIAuto
+    {
+    public:
+        ReplayTestAPI() : m_sum(0), m_value(0)
+        {
+            registerMethod("add", FB::make_method(this, &ReplayTestAPI::add));
+            registerProperty("value",
+                FB::make_property(this, &ReplayTestAPI::getValue,
+                                        &ReplayTestAPI::setValue));
+        }
+        long add(long amount) { m_sum += amount; return m_sum; }
+        long getValue() const { return m_value; }
+        void setValue(long v) { m_value = v; }
+
+        long m_sum;
+        long m_value;
+    };
+}
+
+TEST(CallRecorderCodecRoundTrip)
+{
+    PRINT_TESTNAME;
+    using namespace FB::CallRecorder;
+
+    CHECK_EQUAL(42L, decodeArg(encodeArg(FB::variant(42))).convert_cast<long>());
+    CHECK_EQUAL(true, decodeArg(encodeArg(FB::variant(true))).convert_cast<bool>());
+    CHECK_CLOSE(2.5, decodeArg(encodeArg(FB::variant(2.5))).convert_cast<double>(), 1e-9);
+    CHECK(decodeArg(encodeArg(FB::variant())).empty());
+    CHECK(decodeArg(encodeArg(FB::variant(FB::FBNull()))).is_null());
+
+    // short strings round-trip exactly, even with spaces and '%' in them
+    const std::string tricky("hello world 100%");
+    CHECK_EQUAL(tricky,
+        decodeArg(encodeArg(FB::variant(tricky))).convert_cast<std::string>());
+
+    // long strings and containers keep their size
+    const std::string big(100000, 'q');
+    CHECK_EQUAL(big.size(),
+        decodeArg(encodeArg(FB::variant(big))).convert_cast<std::string>().size());
+    FB::VariantList list(17, FB::variant(1));
+    CHECK_EQUAL(list.size(),
+        decodeArg(encodeArg(FB::variant(list))).cast<FB::VariantList>().size());
+}
+
+TEST(CallRecorderReplayRoundTrip)
+{
+    PRINT_TESTNAME;
+    using namespace callreplay_test_detail;
+
+    const std::string path("callreplay_test.trace");
+    boost::shared_ptr<ReplayTestAPI> source(boost::make_shared<ReplayTestAPI>());
+
+    CHECK(FB::CallRecorder::start(path));
+    CHECK(FB::CallRecorder::isRecording());
+    source->Invoke("add", FB::variant_list_of(2));
+    source->Invoke("add", FB::variant_list_of(3));
+    source->SetProperty("value", 7);
+    source->GetProperty("value");
+    FB::CallRecorder::stop();
+    CHECK(!FB::CallRecorder::isRecording());
+    CHECK_EQUAL(5L, source->m_sum);
+
+    CallReplayer replayer;
+    CHECK(replayer.load(path));
+    CHECK_EQUAL((size_t)4, replayer.size());
+    CHECK_EQUAL('I', replayer.entries()[0].kind);
+    CHECK_EQUAL("add", replayer.entries()[0].member);
+    CHECK_EQUAL('G', replayer.entries()[3].kind);
+
+    // replaying the trace against a fresh object reproduces its effects
+    boost::shared_ptr<ReplayTestAPI> target(boost::make_shared<ReplayTestAPI>());
+    CallReplayer::Stats stats = replayer.replay(target);
+    CHECK_EQUAL((size_t)4, stats.calls);
+    CHECK_EQUAL((size_t)0, stats.failures);
+    CHECK_EQUAL(5L, target->m_sum);
+    CHECK_EQUAL(7L, target->m_value);
+
+    // paced replay (10x speed) produces the same result
+    boost::shared_ptr<ReplayTestAPI> paced(boost::make_shared<ReplayTestAPI>());
+    CallReplayer::Stats pacedStats = replayer.replay(paced, 10.0);
+    CHECK_EQUAL((size_t)4, pacedStats.calls);
+    CHECK_EQUAL((size_t)0, pacedStats.failures);
+    CHECK_EQUAL(5L, paced->m_sum);
+
+    std::remove(path.c_str());
+}
+
@@ -0,0 +1,190 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_DOMDOCUMENTQUERY_TEST
+#define H_DOMDOCUMENTQUERY_TEST
+
+#include "JSObject.h"
+#include "DOM/Document.h"
+
+namespace DocumentQueryTestHelpers {
+
+    // Minimal JSObject base so each fake only overrides what the query path touches
+    class StubJsObject : public FB::JSObject
+    {
+    public:
+        StubJsObject() : FB::JSObject(FB::BrowserHostPtr()) {}
+
+        FB::JSAPIPtr getJSAPI() const { return FB::JSAPIPtr(); }
+        void invalidate() {}
+        bool isValid() { return true; }
+
+        bool HasMethod(const std::string&) const { return false; }
+        bool HasProperty(const std::string&) const { return false; }
+        bool HasProperty(int) const { return false; }
+        FB::variant GetProperty(const std::string&) { return FB::variant(); }
+        FB::variant GetProperty(int) { return FB::variant(); }
+        void SetProperty(const std::string&, const FB::variant&) {}
+        void SetProperty(int, const FB::variant&) {}
+        void RemoveProperty(const std::string&) {}
+        void RemoveProperty(int) {}
+        void getMemberNames(std::vector<std::string>&) const {}
+        size_t getMemberCount() const { return 0; }
+        FB::variant Invoke(const std::string&, const FB::VariantList&) { return FB::variant(); }
+        FB::variant Construct(const FB::VariantList&) { return FB::variant(); }
+    };
+
+    // One per-match record; plays a plain JS object full of captured values
+    class FakeRecord : public StubJsObject
+    {
+    public:
+        FB::variant GetProperty(const std::string& name) { return values[name]; }
+        void getMemberNames(std::vector<std::string>& names) const {
+            for (std::map<std::string, FB::variant>::const_iterator it = values.begin();
+                    it != values.end(); ++it)
+                names.push_back(it->first);
+        }
+        size_t getMemberCount() const { return values.size(); }
+
+        std::map<std::string, FB::variant> values;
+    };
+
+    // The array the collector function hands back
+    class FakeResultArray : public StubJsObject
+    {
+    public:
+        FB::variant GetProperty(const std::string& name) {
+            if (name == "length")
+                return (int)items.size();
+            return FB::variant();
+        }
+        FB::variant GetProperty(int idx) { return items[idx]; }
+
+        std::vector<FB::JSObjectPtr> items;
+    };
+
+    // The compiled collector; records the call it receives and returns the canned array
+    class FakeQueryFn : public StubJsObject
+    {
+    public:
+        FakeQueryFn() : callCount(0) {}
+        FB::variant Invoke(const std::string& name, const FB::VariantList& args) {
+            ++callCount;
+            lastMethod = name;
+            lastArgs = args;
+            return FB::variant(result);
+        }
+
+        int callCount;
+        std::string lastMethod;
+        FB::VariantList lastArgs;
+        FB::JSObjectPtr result;
+    };
+
+    // The page's Function constructor
+    class FakeFunctionCtor : public StubJsObject
+    {
+    public:
+        FB::variant Construct(const FB::VariantList& args) {
+            ctorArgs = args;
+            return FB::variant(fn);
+        }
+
+        FB::VariantList ctorArgs;
+        FB::JSObjectPtr fn;
+    };
+
+    // The document object: exposes defaultView, which exposes Function
+    class FakeWindow : public StubJsObject
+    {
+    public:
+        FB::variant GetProperty(const std::string& name) {
+            if (name == "Function")
+                return FB::variant(functionCtor);
+            return FB::variant();
+        }
+        FB::JSObjectPtr functionCtor;
+    };
+
+    class FakeDocument : public StubJsObject
+    {
+    public:
+        FB::variant GetProperty(const std::string& name) {
+            if (name == "defaultView")
+                return FB::variant(window);
+            return FB::variant();
+        }
+        FB::JSObjectPtr window;
+    };
+}
+
+TEST(DOMDocumentQuerySelectorData)
+{
+    PRINT_TESTNAME;
+    using namespace DocumentQueryTestHelpers;
+
+    boost::shared_ptr<FakeRecord> recA(new FakeRecord);
+    recA->values["id"] = std::string("first");
+    recA->values["offsetWidth"] = 100;
+    boost::shared_ptr<FakeRecord> recB(new FakeRecord);
+    recB->values["id"] = std::string("second");
+    recB->values["offsetWidth"] = 250;
+
+    boost::shared_ptr<FakeResultArray> arr(new FakeResultArray);
+    arr->items.push_back(FB::JSObjectPtr(recA));
+    arr->items.push_back(FB::JSObjectPtr(recB));
+
+    boost::shared_ptr<FakeQueryFn> fn(new FakeQueryFn);
+    fn->result = FB::JSObjectPtr(arr);
+    boost::shared_ptr<FakeFunctionCtor> ctor(new FakeFunctionCtor);
+    ctor->fn = FB::JSObjectPtr(fn);
+    boost::shared_ptr<FakeWindow> win(new FakeWindow);
+    win->functionCtor = FB::JSObjectPtr(ctor);
+    boost::shared_ptr<FakeDocument> docObj(new FakeDocument);
+    docObj->window = FB::JSObjectPtr(win);
+
+    FB::DOM::DocumentPtr doc(new FB::DOM::Document(FB::JSObjectPtr(docObj)));
+
+    std::vector<std::string> attrs;
+    attrs.push_back("id");
+    attrs.push_back("offsetWidth");
+    FB::VariantList out = doc->querySelectorData("div.item", attrs);
+
+    // one call into the page, made on the function itself
+    CHECK_EQUAL(1, fn->callCount);
+    CHECK_EQUAL("", fn->lastMethod);
+    // invoked with (document, selector, attrs)
+    CHECK_EQUAL(3u, (unsigned)fn->lastArgs.size());
+    CHECK(fn->lastArgs[0].convert_cast<FB::JSObjectPtr>() == FB::JSObjectPtr(docObj));
+    CHECK_EQUAL("div.item", fn->lastArgs[1].convert_cast<std::string>());
+    FB::VariantList sentAttrs = fn->lastArgs[2].cast<FB::VariantList>();
+    CHECK_EQUAL(2u, (unsigned)sentAttrs.size());
+    CHECK_EQUAL("id", sentAttrs[0].convert_cast<std::string>());
+
+    // the constructor got the parameter names plus a body
+    CHECK_EQUAL(4u, (unsigned)ctor->ctorArgs.size());
+    CHECK_EQUAL("doc", ctor->ctorArgs[0].convert_cast<std::string>());
+
+    // the payload is fully materialized: plain maps, document order preserved
+    CHECK_EQUAL(2u, (unsigned)out.size());
+    FB::VariantMap first = out[0].cast<FB::VariantMap>();
+    FB::VariantMap second = out[1].cast<FB::VariantMap>();
+    CHECK_EQUAL("first", first["id"].convert_cast<std::string>());
+    CHECK_EQUAL(100, first["offsetWidth"].convert_cast<int>());
+    CHECK_EQUAL("second", second["id"].convert_cast<std::string>());
+    CHECK_EQUAL(250, second["offsetWidth"].convert_cast<int>());
+}
+
+#endif
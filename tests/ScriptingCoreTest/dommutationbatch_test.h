@@ -0,0 +1,112 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_DOMMUTATIONBATCH_TEST
+#define H_DOMMUTATIONBATCH_TEST
+
+#include "JSObject.h"
+#include "DOM/MutationBatch.h"
+
+namespace MutationBatchTestHelpers {
+
+    // JSObject stand-in that just records the mutations applied to it, in order,
+    // shared across all elements so cross-element ordering is visible
+    class RecordingJsObject : public FB::JSObject
+    {
+    public:
+        RecordingJsObject(const std::string& tag, std::vector<std::string>* log)
+          : FB::JSObject(FB::BrowserHostPtr()), m_tag(tag), m_log(log) {}
+
+        FB::JSAPIPtr getJSAPI() const { return FB::JSAPIPtr(); }
+        void invalidate() {}
+        bool isValid() { return true; }
+
+        bool HasMethod(const std::string&) const { return true; }
+        bool HasProperty(const std::string&) const { return true; }
+        bool HasProperty(int) const { return false; }
+        FB::variant GetProperty(const std::string&) { return FB::variant(); }
+        FB::variant GetProperty(int) { return FB::variant(); }
+        void SetProperty(int, const FB::variant&) {}
+        void RemoveProperty(const std::string&) {}
+        void RemoveProperty(int) {}
+        void getMemberNames(std::vector<std::string>&) const {}
+        size_t getMemberCount() const { return 0; }
+
+        void SetProperty(const std::string& name, const FB::variant& value)
+        {
+            m_log->push_back(m_tag + ".set:" + name + "=" + value.convert_cast<std::string>());
+        }
+        FB::variant Invoke(const std::string& name, const FB::VariantList& args)
+        {
+            std::string entry(m_tag + ".call:" + name);
+            for (FB::VariantList::const_iterator it = args.begin(); it != args.end(); ++it)
+                entry += ":" + it->convert_cast<std::string>();
+            m_log->push_back(entry);
+            return FB::variant();
+        }
+        FB::variant Construct(const FB::VariantList&) { return FB::variant(); }
+
+    private:
+        std::string m_tag;
+        std::vector<std::string>* m_log;
+    };
+}
+
+TEST(DOMMutationBatchBasics)
+{
+    PRINT_TESTNAME;
+    using namespace MutationBatchTestHelpers;
+
+    std::vector<std::string> log;
+    FB::JSObjectPtr objA(new RecordingJsObject("a", &log));
+    FB::JSObjectPtr objB(new RecordingJsObject("b", &log));
+    FB::DOM::ElementPtr elA(new FB::DOM::Element(objA));
+    FB::DOM::ElementPtr elB(new FB::DOM::Element(objB));
+
+    FB::DOM::MutationBatch batch;
+    CHECK_EQUAL(0u, (unsigned)batch.size());
+
+    // nothing reaches the objects until flush
+    batch.setInnerHTML(elA, "<b>hi</b>");
+    batch.setWidth(elB, 320);
+    batch.setAttribute(elA, "class", "done");
+    batch.setHeight(elB, 240);
+    CHECK_EQUAL(4u, (unsigned)batch.size());
+    CHECK(log.empty());
+
+    batch.flush();
+    CHECK_EQUAL(0u, (unsigned)batch.size());
+    CHECK_EQUAL(4u, (unsigned)log.size());
+    // recorded order is preserved, across elements
+    CHECK_EQUAL("a.set:innerHTML=<b>hi</b>", log[0]);
+    CHECK_EQUAL("b.set:width=320", log[1]);
+    CHECK_EQUAL("a.call:setAttribute:class:done", log[2]);
+    CHECK_EQUAL("b.set:height=240", log[3]);
+
+    // a flushed batch can be reused
+    batch.setProperty(elA, "title", "again");
+    batch.flush();
+    CHECK_EQUAL(5u, (unsigned)log.size());
+    CHECK_EQUAL("a.set:title=again", log[4]);
+
+    // flushing an empty batch and clearing a populated one are both no-ops
+    batch.flush();
+    batch.setWidth(elA, 1);
+    batch.clear();
+    batch.flush();
+    CHECK_EQUAL(5u, (unsigned)log.size());
+}
+
+#endif
@@ -0,0 +1,105 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_DOMNODECACHE_TEST
+#define H_DOMNODECACHE_TEST
+
+#include "JSObject.h"
+#include "DOM/Element.h"
+
+namespace NodeCacheTestHelpers {
+
+    // JSObject stand-in that counts property reads and serves values from a local map,
+    // so the tests can see exactly which reads reached the "browser"
+    class CountingJsObject : public FB::JSObject
+    {
+    public:
+        CountingJsObject() : FB::JSObject(FB::BrowserHostPtr()), fetchCount(0) {}
+
+        FB::JSAPIPtr getJSAPI() const { return FB::JSAPIPtr(); }
+        void invalidate() {}
+        bool isValid() { return true; }
+
+        bool HasMethod(const std::string&) const { return false; }
+        bool HasProperty(const std::string& name) const { return values.count(name) != 0; }
+        bool HasProperty(int) const { return false; }
+        FB::variant GetProperty(const std::string& name)
+        {
+            ++fetchCount;
+            return values[name];
+        }
+        FB::variant GetProperty(int) { return FB::variant(); }
+        void SetProperty(const std::string& name, const FB::variant& value) { values[name] = value; }
+        void SetProperty(int, const FB::variant&) {}
+        void RemoveProperty(const std::string&) {}
+        void RemoveProperty(int) {}
+        void getMemberNames(std::vector<std::string>&) const {}
+        size_t getMemberCount() const { return 0; }
+        FB::variant Invoke(const std::string&, const FB::VariantList&) { return FB::variant(); }
+        FB::variant Construct(const FB::VariantList&) { return FB::variant(); }
+
+        int fetchCount;
+        std::map<std::string, FB::variant> values;
+    };
+}
+
+TEST(DOMNodePropertyCache)
+{
+    PRINT_TESTNAME;
+    using namespace NodeCacheTestHelpers;
+
+    boost::shared_ptr<CountingJsObject> obj(new CountingJsObject);
+    obj->values["width"] = 640;
+    obj->values["height"] = 480;
+    FB::DOM::ElementPtr el(new FB::DOM::Element(FB::JSObjectPtr(obj)));
+
+    // caching is off by default: every read goes to the object
+    CHECK(!el->getPropertyCaching());
+    CHECK_EQUAL(640, el->getProperty<int>("width"));
+    CHECK_EQUAL(640, el->getProperty<int>("width"));
+    CHECK_EQUAL(2, obj->fetchCount);
+
+    // with caching on, repeated reads are served locally
+    el->setPropertyCaching(true);
+    CHECK_EQUAL(640, el->getWidth());
+    obj->values["width"] = 800;
+    CHECK_EQUAL(640, el->getWidth());
+    CHECK_EQUAL(3, obj->fetchCount);
+
+    // invalidate() forces the next read back to the object
+    el->invalidate();
+    CHECK_EQUAL(800, el->getWidth());
+    CHECK_EQUAL(800, el->getWidth());
+    CHECK_EQUAL(4, obj->fetchCount);
+
+    // invalidating one property doesn't require refetching others prematurely;
+    // a property never read since the last invalidate is fetched once
+    CHECK_EQUAL(480, el->getHeight());
+    CHECK_EQUAL(480, el->getHeight());
+    CHECK_EQUAL(5, obj->fetchCount);
+
+    // a write through the node drops that entry so the next read sees the new value
+    el->setProperty("width", 1024);
+    CHECK_EQUAL(1024, el->getWidth());
+    CHECK_EQUAL(6, obj->fetchCount);
+
+    // turning caching back off restores pass-through reads
+    el->setPropertyCaching(false);
+    CHECK_EQUAL(1024, el->getWidth());
+    CHECK_EQUAL(1024, el->getWidth());
+    CHECK_EQUAL(8, obj->fetchCount);
+}
+
+#endif
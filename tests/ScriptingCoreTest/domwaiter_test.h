@@ -0,0 +1,87 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_DOMWAITER_TEST
+#define H_DOMWAITER_TEST
+
+#include "JSObject.h"
+#include "DOM/Document.h"
+
+// reuses the stub page objects from domdocumentquery_test.h
+namespace DocumentWaiterTestHelpers {
+
+    using DocumentQueryTestHelpers::StubJsObject;
+    using DocumentQueryTestHelpers::FakeFunctionCtor;
+    using DocumentQueryTestHelpers::FakeQueryFn;
+    using DocumentQueryTestHelpers::FakeWindow;
+    using DocumentQueryTestHelpers::FakeDocument;
+
+    struct WaitResult {
+        WaitResult() : fired(0) {}
+        int fired;
+        FB::DOM::ElementPtr element;
+
+        void onElement(const FB::DOM::ElementPtr& el) {
+            ++fired;
+            element = el;
+        }
+    };
+}
+
+TEST(DOMDocumentWaitForElement)
+{
+    PRINT_TESTNAME;
+    using namespace DocumentWaiterTestHelpers;
+
+    boost::shared_ptr<FakeQueryFn> fn(new FakeQueryFn);
+    boost::shared_ptr<FakeFunctionCtor> ctor(new FakeFunctionCtor);
+    ctor->fn = FB::JSObjectPtr(fn);
+    boost::shared_ptr<FakeWindow> win(new FakeWindow);
+    win->functionCtor = FB::JSObjectPtr(ctor);
+    boost::shared_ptr<FakeDocument> docObj(new FakeDocument);
+    docObj->window = FB::JSObjectPtr(win);
+
+    FB::DOM::DocumentPtr doc(new FB::DOM::Document(FB::JSObjectPtr(docObj)));
+
+    WaitResult result;
+    doc->waitForElement("late-node", boost::bind(&WaitResult::onElement, &result, _1));
+
+    // one watcher function compiled with (doc, id, cb) parameters and installed once
+    CHECK_EQUAL(4u, (unsigned)ctor->ctorArgs.size());
+    CHECK_EQUAL("doc", ctor->ctorArgs[0].convert_cast<std::string>());
+    CHECK_EQUAL("id", ctor->ctorArgs[1].convert_cast<std::string>());
+    CHECK_EQUAL("cb", ctor->ctorArgs[2].convert_cast<std::string>());
+    CHECK_EQUAL(1, fn->callCount);
+    CHECK_EQUAL(3u, (unsigned)fn->lastArgs.size());
+    CHECK(fn->lastArgs[0].convert_cast<FB::JSObjectPtr>() == FB::JSObjectPtr(docObj));
+    CHECK_EQUAL("late-node", fn->lastArgs[1].convert_cast<std::string>());
+
+    // nothing fired yet: the element "doesn't exist"
+    CHECK_EQUAL(0, result.fired);
+
+    // the page finds the node and calls the hook exactly once
+    FB::JSAPIPtr cb(fn->lastArgs[2].convert_cast<FB::JSAPIPtr>());
+    boost::shared_ptr<StubJsObject> elObj(new StubJsObject);
+    cb->Invoke("", FB::variant_list_of(FB::JSObjectPtr(elObj)));
+    CHECK_EQUAL(1, result.fired);
+    CHECK(result.element);
+    CHECK(result.element->getJSObject() == FB::JSObjectPtr(elObj));
+
+    // a duplicate notification is ignored
+    cb->Invoke("", FB::variant_list_of(FB::JSObjectPtr(elObj)));
+    CHECK_EQUAL(1, result.fired);
+}
+
+#endif // H_DOMWAITER_TEST
@@ -0,0 +1,56 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+#include <string>
+#include "HeaderView.h"
+
+TEST(HeaderViewParseAndLookup)
+{
+    PRINT_TESTNAME;
+
+    const std::string raw(
+        "Content-Type: text/html; charset=utf-8\r\n"
+        "  Content-Length:\t1234 \r\n"
+        "Set-Cookie: a=1\r\n"
+        "Set-Cookie: b=2\r\n"
+        "garbage line without colon\r\n"
+        "\r\n");
+    FB::HeaderView view(raw);
+
+    CHECK_EQUAL(4u, view.size());
+    CHECK_EQUAL("text/html; charset=utf-8", view.get("content-type"));
+    CHECK_EQUAL("1234", view.get("CONTENT-LENGTH"));
+    CHECK(view.contains("set-cookie"));
+    CHECK(! view.contains("X-Missing"));
+    CHECK_EQUAL(std::string(), view.get("X-Missing"));
+
+    std::vector<std::string> cookies = view.getAll("Set-Cookie");
+    CHECK_EQUAL(2u, cookies.size());
+    CHECK_EQUAL("a=1", cookies[0]);
+    CHECK_EQUAL("b=2", cookies[1]);
+
+    // Zero-copy lookup points into the raw block
+    const char* value;
+    size_t len;
+    CHECK(view.findRef("Content-Type", value, len));
+    CHECK_EQUAL("text/html; charset=utf-8", std::string(value, len));
+
+    // toMap materializes the same headers the old splitter produced
+    FB::HeaderMap map = view.toMap();
+    CHECK_EQUAL(4u, map.size());
+    CHECK_EQUAL("1234", map.find("Content-Length")->second);
+    CHECK_EQUAL(2u, map.count("Set-Cookie"));
+
+    CHECK(FB::HeaderView(std::string()).empty());
+}
@@ -0,0 +1,87 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <boost/thread/thread.hpp>
+#include "HttpCache.h"
+
+namespace httpcache_test_detail {
+    inline boost::shared_array<uint8_t> makeBody(const std::string& content)
+    {
+        boost::shared_array<uint8_t> data(new uint8_t[content.size()]);
+        std::memcpy(data.get(), content.data(), content.size());
+        return data;
+    }
+}
+
+TEST(HttpCacheRoundTrip)
+{
+    PRINT_TESTNAME;
+    using namespace httpcache_test_detail;
+
+    FB::HttpCache& cache = FB::HttpCache::get();
+    CHECK(cache.enable(".", 600));
+    cache.purge();
+
+    const std::string body("{\"answer\": 42}");
+    FB::HeaderMap storedHeaders;
+    storedHeaders.insert(std::make_pair("Content-Type", "application/json"));
+    storedHeaders.insert(std::make_pair("ETag", "\"v1\""));
+    cache.store("http://example.com/config.json", storedHeaders, makeBody(body), body.size());
+    CHECK(cache.entryCount() == 1);
+
+    FB::HeaderMap headers;
+    boost::shared_array<uint8_t> data;
+    size_t size(0);
+    CHECK(cache.fetch("http://example.com/config.json", headers, data, size));
+    CHECK(size == body.size());
+    CHECK(std::string(reinterpret_cast<const char*>(data.get()), size) == body);
+    CHECK(headers.find("Content-Type")->second == "application/json");
+    CHECK(headers.find("ETag")->second == "\"v1\"");
+    CHECK(headers.find("X-FB-Cache") != headers.end());
+
+    // misses: unknown URL
+    CHECK(!cache.fetch("http://example.com/other.json", headers, data, size));
+
+    // no-store responses are never cached
+    FB::HeaderMap noStore;
+    noStore.insert(std::make_pair("Cache-Control", "no-store"));
+    cache.store("http://example.com/private", noStore, makeBody("secret"), 6);
+    CHECK(!cache.fetch("http://example.com/private", headers, data, size));
+
+    // sweepExpired drops stale entries without waiting for a lookup to find them
+    FB::HeaderMap shortLived;
+    shortLived.insert(std::make_pair("Cache-Control", "max-age=1"));
+    cache.store("http://example.com/stale", shortLived, makeBody("stale!"), 6);
+    CHECK(cache.entryCount() == 2);
+    cache.sweepExpired();
+    CHECK(cache.entryCount() == 2);     // still fresh; nothing to sweep yet
+    boost::this_thread::sleep(boost::posix_time::milliseconds(1100));
+    cache.sweepExpired();
+    CHECK(cache.entryCount() == 1);
+    CHECK(cache.fetch("http://example.com/config.json", headers, data, size));
+
+    // the index survives a disable/enable cycle (fresh load from disk)
+    cache.disable();
+    CHECK(cache.enable(".", 600));
+    CHECK(cache.fetch("http://example.com/config.json", headers, data, size));
+    CHECK(size == body.size());
+
+    cache.purge();
+    CHECK(!cache.fetch("http://example.com/config.json", headers, data, size));
+    cache.disable();
+    std::remove("./index.fbcache");
+}
@@ -0,0 +1,118 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_JSAPICONFLATION_TEST
+#define H_JSAPICONFLATION_TEST
+
+#include <boost/thread/thread.hpp>
+#include "JSAPIAuto.h"
+#include "JSObject.h"
+
+namespace ConflationTestHelpers {
+
+    // Handler that records every delivery synchronously on whatever thread it arrives on
+    class RecordingHandler : public FB::JSObject
+    {
+    public:
+        RecordingHandler() : FB::JSObject(FB::BrowserHostPtr()) {}
+
+        FB::JSAPIPtr getJSAPI() const { return FB::JSAPIPtr(); }
+        void invalidate() {}
+        bool isValid() { return true; }
+        void *getEventId() const { return (void*)this; }
+
+        bool HasMethod(const std::string&) const { return false; }
+        bool HasProperty(const std::string&) const { return false; }
+        bool HasProperty(int) const { return false; }
+        FB::variant GetProperty(const std::string&) { return FB::variant(); }
+        FB::variant GetProperty(int) { return FB::variant(); }
+        void SetProperty(const std::string&, const FB::variant&) {}
+        void SetProperty(int, const FB::variant&) {}
+        void RemoveProperty(const std::string&) {}
+        void RemoveProperty(int) {}
+        void getMemberNames(std::vector<std::string>&) const {}
+        size_t getMemberCount() const { return 0; }
+        FB::variant Invoke(const std::string&, const FB::VariantList&) { return FB::variant(); }
+        FB::variant Construct(const FB::VariantList&) { return FB::variant(); }
+
+        void InvokeAsync(const std::string&, const std::vector<FB::variant>& args)
+        {
+            boost::mutex::scoped_lock lock(m_lock);
+            m_calls.push_back(args);
+        }
+
+        size_t callCount() {
+            boost::mutex::scoped_lock lock(m_lock);
+            return m_calls.size();
+        }
+        int lastArg() {
+            boost::mutex::scoped_lock lock(m_lock);
+            return m_calls.back().front().convert_cast<int>();
+        }
+
+    private:
+        boost::mutex m_lock;
+        std::vector<FB::VariantList> m_calls;
+    };
+
+    class ConflationTestAPI : public FB::JSAPIAuto
+    {
+    public:
+        ConflationTestAPI() { registerEvent("onprogress"); }
+        void fire(const std::string& name, const FB::VariantList& args) { FireEvent(name, args); }
+    };
+}
+
+TEST(JSAPIEventConflation)
+{
+    PRINT_TESTNAME;
+    using namespace ConflationTestHelpers;
+
+    boost::shared_ptr<ConflationTestAPI> api(new ConflationTestAPI);
+    boost::shared_ptr<RecordingHandler> handler(new RecordingHandler);
+    FB::JSObjectPtr handlerObj(handler);
+    api->registerEventMethod("onprogress", handlerObj);
+
+    api->setEventConflation("onprogress", 150);
+
+    // burst of fires: the first goes out immediately, the rest conflate to the newest
+    for (int i = 0; i < 5; ++i)
+        api->fire("onprogress", FB::variant_list_of(i));
+    CHECK_EQUAL(1u, (unsigned)handler->callCount());
+    CHECK_EQUAL(0, handler->lastArg());
+
+    // the trailing flush delivers exactly one more call carrying the last payload
+    boost::this_thread::sleep(boost::posix_time::milliseconds(500));
+    CHECK_EQUAL(2u, (unsigned)handler->callCount());
+    CHECK_EQUAL(4, handler->lastArg());
+
+    // after a quiet period a single fire is delivered immediately again
+    api->fire("onprogress", FB::variant_list_of(99));
+    CHECK_EQUAL(3u, (unsigned)handler->callCount());
+    CHECK_EQUAL(99, handler->lastArg());
+
+    // clearing the channel delivers any pending payload instead of dropping it
+    api->fire("onprogress", FB::variant_list_of(100)); // inside the interval: conflated
+    CHECK_EQUAL(3u, (unsigned)handler->callCount());
+    api->clearEventConflation("onprogress");
+    CHECK_EQUAL(4u, (unsigned)handler->callCount());
+    CHECK_EQUAL(100, handler->lastArg());
+
+    // with the channel gone every fire is delivered
+    api->fire("onprogress", FB::variant_list_of(101));
+    CHECK_EQUAL(5u, (unsigned)handler->callCount());
+}
+
+#endif
@@ -0,0 +1,51 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_LOGRATE_TEST
+#define H_LOGRATE_TEST
+
+#include "logging.h"
+
+TEST(LogRateLimiting)
+{
+    PRINT_TESTNAME;
+
+    volatile int bucket = 0;
+
+    // Unlimited (the default): everything passes and the bucket stays untouched
+    FB::Log::setLogRateLimit(0);
+    for (int i = 0; i < 100; ++i)
+        CHECK(FB::Log::rateAllow(&bucket));
+    CHECK_EQUAL(0, bucket);
+
+    // Rate 1/s with a burst of 3: three messages pass, then the bucket is dry
+    // (refill won't happen within this test's single second)
+    FB::Log::setLogRateLimit(1, 3);
+    CHECK(FB::Log::rateAllow(&bucket));
+    CHECK(FB::Log::rateAllow(&bucket));
+    CHECK(FB::Log::rateAllow(&bucket));
+    CHECK(! FB::Log::rateAllow(&bucket));
+    CHECK(! FB::Log::rateAllow(&bucket));
+
+    // Buckets are per callsite: a fresh one still has its full burst
+    volatile int bucket2 = 0;
+    CHECK(FB::Log::rateAllow(&bucket2));
+
+    // Turning the limit back off unblocks even a dry bucket
+    FB::Log::setLogRateLimit(0);
+    CHECK(FB::Log::rateAllow(&bucket));
+}
+
+#endif // H_LOGRATE_TEST
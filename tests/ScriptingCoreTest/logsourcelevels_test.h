@@ -0,0 +1,54 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_LOGSOURCELEVELS_TEST
+#define H_LOGSOURCELEVELS_TEST
+
+#include "logging.h"
+
+TEST(LogSourceLevels)
+{
+    PRINT_TESTNAME;
+
+    FB::Log::clearLogSourceLevels();
+
+    // No override: falls back to the backend's global enabled(), which the
+    // harness's NullLogger answers with false
+    volatile int cache = 0;
+    CHECK(!FB::Log::enabled(FB::Log::LogLevel_Trace, "BrowserHost", &cache));
+
+    // An override silences levels below it for that source only
+    FB::Log::setLogSourceLevel("BrowserHost", FB::Log::LogLevel_Warn);
+    CHECK(!FB::Log::enabled(FB::Log::LogLevel_Debug, "BrowserHost", &cache));
+    CHECK(FB::Log::enabled(FB::Log::LogLevel_Warn, "BrowserHost", &cache));
+    CHECK(FB::Log::enabled(FB::Log::LogLevel_Error, "BrowserHost", &cache));
+
+    // Other sources (each callsite has its own cache) are untouched and
+    // still use the global fallback
+    volatile int otherCache = 0;
+    CHECK(!FB::Log::enabled(FB::Log::LogLevel_Trace, "NpapiStream", &otherCache));
+
+    // A stale cache refreshes itself when the registry changes
+    FB::Log::setLogSourceLevel("BrowserHost", FB::Log::LogLevel_Trace);
+    CHECK(FB::Log::enabled(FB::Log::LogLevel_Debug, "BrowserHost", &cache));
+
+    // Clearing the overrides restores the global fallback
+    FB::Log::setLogSourceLevel("BrowserHost", FB::Log::LogLevel_Error);
+    CHECK(FB::Log::enabled(FB::Log::LogLevel_Error, "BrowserHost", &cache));
+    FB::Log::clearLogSourceLevels();
+    CHECK(!FB::Log::enabled(FB::Log::LogLevel_Error, "BrowserHost", &cache));
+}
+
+#endif
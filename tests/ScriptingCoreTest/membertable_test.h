@@ -0,0 +1,51 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+#include <cstdio>
+#include <string>
+#include "MemberTable.h"
+
+TEST(MemberTableNegativeLookup)
+{
+    PRINT_TESTNAME;
+
+    FB::MemberTable table;
+
+    // An empty table rejects everything without consulting the map
+    CHECK(! table.mayContain("onload"));
+    CHECK_EQUAL(FB::MemberTable::no_member, table.find("onload"));
+
+    FB::MemberId echo = table.intern("echo");
+    FB::MemberId valid = table.intern("valid");
+    CHECK_EQUAL(echo, table.intern("echo"));
+    CHECK_EQUAL(echo, table.find("echo"));
+    CHECK_EQUAL(valid, table.find("valid"));
+
+    // Interned names always pass the filter; no false negatives
+    CHECK(table.mayContain("echo"));
+    CHECK(table.mayContain("valid"));
+
+    // Names never interned still come back as no_member whether or not the
+    // filter happens to pass them
+    char name[32];
+    for (int i = 0; i < 200; ++i) {
+        sprintf(name, "absentMember%d", i);
+        CHECK_EQUAL(FB::MemberTable::no_member, table.find(name));
+    }
+
+    // Snapshot publication copies tables wholesale; the filter travels with it
+    FB::MemberTable copy(table);
+    CHECK_EQUAL(echo, copy.find("echo"));
+    CHECK(! copy.mayContain("neverRegistered"));
+}
@@ -0,0 +1,83 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_PLUGINWINDOWDIRTY_TEST
+#define H_PLUGINWINDOWDIRTY_TEST
+
+#include <boost/thread.hpp>
+#include "PluginWindow.h"
+
+namespace PluginWindowDirtyTest {
+
+    class FakeWindow : public FB::PluginWindow
+    {
+    public:
+        FakeWindow() : invalidations(0) {}
+
+        void InvalidateWindow() const { ++invalidations; }
+        FB::Rect getWindowPosition() const { FB::Rect r = { 0, 0, 600, 800 }; return r; }
+        uint32_t getWindowWidth() const { return 800; }
+        uint32_t getWindowHeight() const { return 600; }
+        FB::Rect getWindowClipping() const { return getWindowPosition(); }
+
+        mutable int invalidations;
+    };
+
+    inline FB::Rect mkRect(int32_t top, int32_t left, int32_t bottom, int32_t right)
+    {
+        FB::Rect r = { top, left, bottom, right };
+        return r;
+    }
+}
+
+TEST(PluginWindowDirtyRectCoalescing)
+{
+    PRINT_TESTNAME;
+    using namespace PluginWindowDirtyTest;
+
+    FakeWindow win;
+    win.setInvalidationInterval(60);
+
+    // the first dirty rect of a frame flushes right away (leading edge)
+    win.invalidateRect(mkRect(10, 10, 20, 20));
+    CHECK_EQUAL(1, win.invalidations);
+
+    // rects arriving inside the interval just widen the dirty region
+    win.invalidateRect(mkRect(5, 15, 25, 40));
+    win.invalidateRect(mkRect(12, 2, 18, 18));
+    CHECK_EQUAL(1, win.invalidations);
+
+    // the deferred flush fires once the interval is up
+    for (int i = 0; i < 50 && win.invalidations < 2; ++i)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    CHECK_EQUAL(2, win.invalidations);
+
+    // the paint handler fetches the merged bounding region exactly once
+    FB::Rect dirty;
+    CHECK(win.fetchDirtyRect(dirty));
+    CHECK_EQUAL(5, dirty.top);
+    CHECK_EQUAL(2, dirty.left);
+    CHECK_EQUAL(25, dirty.bottom);
+    CHECK_EQUAL(40, dirty.right);
+    CHECK(!win.fetchDirtyRect(dirty));
+
+    // a zero interval turns the throttle off entirely
+    win.setInvalidationInterval(0);
+    win.invalidateRect(mkRect(0, 0, 1, 1));
+    win.invalidateRect(mkRect(1, 1, 2, 2));
+    CHECK_EQUAL(4, win.invalidations);
+}
+
+#endif
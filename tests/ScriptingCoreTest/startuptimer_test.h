@@ -0,0 +1,55 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_STARTUPTIMER_TEST
+#define H_STARTUPTIMER_TEST
+
+#include <boost/thread.hpp>
+#include "StartupTimer.h"
+#include "variant_map.h"
+
+TEST(StartupTimerMarks)
+{
+    PRINT_TESTNAME;
+
+    FB::StartupTimer::reset();
+    CHECK_EQUAL(0u, (unsigned)FB::StartupTimer::getMarks().size());
+
+    FB::StartupTimer::mark("module load");
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    FB::StartupTimer::mark("first instance");
+    // duplicate stages keep the first, slow occurrence
+    FB::StartupTimer::mark("first instance");
+
+    FB::VariantList marks = FB::StartupTimer::getMarks();
+    CHECK_EQUAL(2u, (unsigned)marks.size());
+
+    FB::VariantMap first = marks[0].convert_cast<FB::VariantMap>();
+    CHECK_EQUAL(std::string("module load"), first["stage"].convert_cast<std::string>());
+    CHECK_EQUAL(0.0, first["ms"].convert_cast<double>());
+
+    FB::VariantMap second = marks[1].convert_cast<FB::VariantMap>();
+    CHECK_EQUAL(std::string("first instance"), second["stage"].convert_cast<std::string>());
+    CHECK(second["ms"].convert_cast<double>() >= 15.0);
+    CHECK_EQUAL(second["ms"].convert_cast<double>(), second["delta"].convert_cast<double>());
+
+    std::string rpt = FB::StartupTimer::report();
+    CHECK(rpt.find("module load") != std::string::npos);
+    CHECK(rpt.find("first instance") != std::string::npos);
+
+    FB::StartupTimer::reset();
+}
+
+#endif
@@ -0,0 +1,82 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2012
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2012 Firebreath development team
+\**********************************************************/
+
+#include <string>
+#include <boost/assign.hpp>
+#include "JSAPIAuto.h"
+#include "StaticMemberTable.h"
+#include "variant_list.h"
+
+namespace
+{
+    class StaticTableTestAPI : public FB::JSAPIAuto
+    {
+    public:
+        StaticTableTestAPI() : m_answer(42)
+        {
+            memberTable().apply(this);
+        }
+
+        long add(long a, long b) { return a + b; }
+        std::string greet(const std::string& name) const { return "hello " + name; }
+        long get_answer() const { return m_answer; }
+        void set_answer(long answer) { m_answer = answer; }
+        std::string get_label() const { return "static"; }
+
+    private:
+        static const FB::StaticMemberTable<StaticTableTestAPI>& memberTable()
+        {
+            static const FB::StaticMemberTable<StaticTableTestAPI> table =
+                FB::StaticMemberTable<StaticTableTestAPI>()
+                    .method("add", &StaticTableTestAPI::add)
+                    .method("greet", &StaticTableTestAPI::greet)
+                    .property("answer", &StaticTableTestAPI::get_answer, &StaticTableTestAPI::set_answer)
+                    .property("label", &StaticTableTestAPI::get_label);
+            return table;
+        }
+
+        long m_answer;
+    };
+}
+
+TEST(StaticMemberTable)
+{
+    PRINT_TESTNAME;
+
+    using boost::assign::list_of;
+
+    // Every instance shares the per-class table but gets its own bound members
+    FB::JSAPIPtr one(new StaticTableTestAPI());
+    FB::JSAPIPtr two(new StaticTableTestAPI());
+
+    CHECK(one->HasMethod("add"));
+    CHECK(one->HasMethod("greet"));
+    CHECK(one->HasProperty("answer"));
+    CHECK(one->HasProperty("label"));
+
+    FB::variant ret = one->Invoke("add", FB::variant_list_of(2)(40));
+    CHECK(ret.cast<long>() == 42);
+
+    ret = one->Invoke("greet", list_of(std::string("world")));
+    CHECK(ret.cast<std::string>() == "hello world");
+
+    CHECK(one->GetProperty("answer").cast<long>() == 42);
+    one->SetProperty("answer", 7);
+    CHECK(one->GetProperty("answer").cast<long>() == 7);
+    // instances must not share state through the table
+    CHECK(two->GetProperty("answer").cast<long>() == 42);
+
+    // read-only property: the dummy setter ignores writes
+    CHECK(one->GetProperty("label").cast<std::string>() == "static");
+}
@@ -0,0 +1,88 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_STREAMHANDLER_TEST
+#define H_STREAMHANDLER_TEST
+
+#include <string>
+#include <boost/make_shared.hpp>
+#include "BrowserStream.h"
+#include "DefaultBrowserStreamHandler.h"
+#include "PluginEvents/StreamEvents.h"
+
+namespace {
+    struct FakeHandlerStream : FB::BrowserStream {
+        FakeHandlerStream() : FB::BrowserStream("http://localhost/test", false, false, 4096) {}
+        bool readRanges(const std::vector<Range>&) { return false; }
+        bool write(const char*, size_t, size_t& written) { written = 0; return false; }
+        bool close() { return true; }
+    };
+
+    // Fast path: chunk bytes arrive through the non-virtual onStreamData
+    struct CrtpCollector : FB::BrowserStreamHandlerT<CrtpCollector> {
+        std::string received;
+        bool completed;
+        CrtpCollector() : completed(false) {}
+        bool onStreamData(FB::StreamDataArrivedEvent* evt, FB::BrowserStream*) {
+            received.append(reinterpret_cast<const char*>(evt->getData()), evt->getLength());
+            return true;
+        }
+        virtual bool onStreamCompleted(FB::StreamCompletedEvent*, FB::BrowserStream*) {
+            completed = true;
+            return true;
+        }
+    };
+
+    // No onStreamData: chunks must fall back to the virtual onStreamDataArrived
+    struct FallbackCollector : FB::BrowserStreamHandlerT<FallbackCollector> {
+        std::string received;
+        virtual bool onStreamDataArrived(FB::StreamDataArrivedEvent* evt, FB::BrowserStream*) {
+            received.append(reinterpret_cast<const char*>(evt->getData()), evt->getLength());
+            return true;
+        }
+    };
+}
+
+TEST(BrowserStreamHandlerCrtpDispatch)
+{
+    PRINT_TESTNAME;
+
+    // One stream per handler: SendEvent stops at the first sink that handles it
+    boost::shared_ptr<FakeHandlerStream> stream(boost::make_shared<FakeHandlerStream>());
+    boost::shared_ptr<CrtpCollector> direct(boost::make_shared<CrtpCollector>());
+    stream->AttachObserver(direct);
+
+    std::string payload("0123456789abcdef");
+    FB::StreamDataArrivedEvent evt(stream.get(), payload.data(), payload.size(), 0, 0);
+    stream->SendEvent(&evt);
+    FB::StreamDataArrivedEvent evt2(stream.get(), payload.data(), 4, payload.size(), 0);
+    stream->SendEvent(&evt2);
+    CHECK_EQUAL(payload + payload.substr(0, 4), direct->received);
+
+    // Non-data events still route through the ordinary event map
+    FB::StreamCompletedEvent done(stream.get(), true);
+    stream->SendEvent(&done);
+    CHECK(direct->completed);
+
+    // Without onStreamData the chunk falls back to the virtual onStreamDataArrived
+    boost::shared_ptr<FakeHandlerStream> stream2(boost::make_shared<FakeHandlerStream>());
+    boost::shared_ptr<FallbackCollector> fallback(boost::make_shared<FallbackCollector>());
+    stream2->AttachObserver(fallback);
+    FB::StreamDataArrivedEvent evt3(stream2.get(), payload.data(), payload.size(), 0, 0);
+    stream2->SendEvent(&evt3);
+    CHECK_EQUAL(payload, fallback->received);
+}
+
+#endif // H_STREAMHANDLER_TEST
@@ -0,0 +1,115 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_STREAMINFLATER_TEST
+#define H_STREAMINFLATER_TEST
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "fb_features.h"
+#ifndef FB_NO_STREAM_INFLATE
+#include <zlib.h>
+#endif
+#include "StreamInflater.h"
+
+#ifndef FB_NO_STREAM_INFLATE
+
+namespace {
+    // Compresses src the way a server would; windowBits picks the wrapper
+    // (15+16 gzip, 15 zlib, -15 raw deflate)
+    std::string deflate_corpus(const std::string& src, int windowBits)
+    {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+        std::string out;
+        char buf[4096];
+        zs.next_in = (Bytef*)const_cast<char*>(src.data());
+        zs.avail_in = src.size();
+        int rc;
+        do {
+            zs.next_out = (Bytef*)buf;
+            zs.avail_out = sizeof(buf);
+            rc = deflate(&zs, Z_FINISH);
+            out.append(buf, sizeof(buf) - zs.avail_out);
+        } while (rc != Z_STREAM_END);
+        deflateEnd(&zs);
+        return out;
+    }
+
+    bool inflater_roundtrip(const std::string& src, int windowBits, size_t chunkSize)
+    {
+        std::string comp = deflate_corpus(src, windowBits);
+        FB::StreamInflater inf;
+        std::vector<uint8_t> out;
+        // Feed in deliberately awkward chunk sizes, like network arrival would
+        for (size_t i = 0; i < comp.size(); i += chunkSize) {
+            size_t n = (std::min)(chunkSize, comp.size() - i);
+            if (! inf.feed(reinterpret_cast<const uint8_t*>(comp.data()) + i, n, out))
+                return false;
+        }
+        return inf.done() && out.size() == src.size()
+            && 0 == memcmp(&out[0], src.data(), src.size());
+    }
+}
+
+TEST(StreamInflaterRoundTrip)
+{
+    PRINT_TESTNAME;
+
+    std::string src;
+    for (int i = 0; i < 20000; ++i) {
+        src += "{\"status\":\"ok\",\"seq\":";
+        src += static_cast<char>('a' + (i % 26));
+        src += "}";
+    }
+
+    CHECK(FB::StreamInflater::canDecode("gzip"));
+    CHECK(FB::StreamInflater::canDecode(" Deflate "));
+    CHECK(FB::StreamInflater::canDecode("x-gzip"));
+    CHECK(! FB::StreamInflater::canDecode("br"));
+    CHECK(! FB::StreamInflater::canDecode("identity"));
+
+    // All three wrappers servers actually send, including the raw deflate
+    // stream some send under Content-Encoding: deflate
+    CHECK(inflater_roundtrip(src, 15 + 16, 7));
+    CHECK(inflater_roundtrip(src, 15, 1024));
+    CHECK(inflater_roundtrip(src, -15, 3));
+
+    // Corrupt input fails cleanly instead of looping or delivering garbage
+    {
+        FB::StreamInflater inf;
+        std::vector<uint8_t> out;
+        std::string junk(1000, 'Q');
+        CHECK(! inf.feed(reinterpret_cast<const uint8_t*>(junk.data()), junk.size(), out));
+        CHECK(inf.failed());
+    }
+
+    // A truncated stream feeds fine but never reports done(), which is how
+    // SimpleStreamHelper detects a cut-short body
+    {
+        std::string comp = deflate_corpus(src, 15 + 16);
+        comp.resize(comp.size() / 2);
+        FB::StreamInflater inf;
+        std::vector<uint8_t> out;
+        CHECK(inf.feed(reinterpret_cast<const uint8_t*>(comp.data()), comp.size(), out));
+        CHECK(! inf.done());
+    }
+}
+
+#endif // FB_NO_STREAM_INFLATE
+
+#endif // H_STREAMINFLATER_TEST
@@ -0,0 +1,83 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_STREAMREADER_TEST
+#define H_STREAMREADER_TEST
+
+#include <sstream>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread.hpp>
+#include "BrowserStream.h"
+#include "BrowserStreamReader.h"
+#include "PluginEvents/StreamEvents.h"
+
+namespace {
+    // Minimal sequential stream; the reader only needs the event plumbing
+    struct FakeSequentialStream : FB::BrowserStream {
+        FakeSequentialStream() : FB::BrowserStream("http://localhost/test", false, false, 4096) {}
+        bool readRanges(const std::vector<Range>&) { return false; }
+        bool write(const char*, size_t, size_t& written) { written = 0; return false; }
+        bool close() { return true; }
+    };
+
+    void drainIStream(std::istream* in, std::string* out) {
+        char buf[7]; // deliberately smaller than the delivered chunks
+        while (in->read(buf, sizeof(buf)), in->gcount() > 0) {
+            out->append(buf, static_cast<size_t>(in->gcount()));
+        }
+    }
+}
+
+TEST(BrowserStreamReaderSequential)
+{
+    PRINT_TESTNAME;
+
+    boost::shared_ptr<FakeSequentialStream> stream(boost::make_shared<FakeSequentialStream>());
+    FB::BrowserStreamReaderPtr reader(boost::make_shared<FB::BrowserStreamReader>(FB::BrowserHostPtr(), 64));
+    stream->AttachObserver(reader);
+    CHECK_EQUAL(64u, (unsigned)reader->getWindowBytes());
+    CHECK_EQUAL(64u, (unsigned)stream->getConsumeWatermark());
+
+    std::string expected;
+    std::string result;
+    boost::thread consumer(boost::bind(&drainIStream, &reader->getIStream(), &result));
+
+    size_t pos(0);
+    for (int i = 0; i < 25; ++i) {
+        std::ostringstream chunkStream;
+        chunkStream << "chunk " << i << " payload;";
+        std::string chunk(chunkStream.str());
+        expected += chunk;
+
+        FB::StreamDataArrivedEvent evt(stream.get(), chunk.data(), chunk.size(), pos, 0);
+        stream->SendEvent(&evt);
+        pos += chunk.size();
+
+        if (i == 12) {
+            // let the consumer catch up mid-stream so both the blocking and the
+            // buffered-ahead paths get exercised
+            boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+        }
+    }
+
+    FB::StreamCompletedEvent done(stream.get(), true);
+    stream->SendEvent(&done);
+    consumer.join();
+
+    CHECK_EQUAL(expected, result);
+}
+
+#endif
@@ -0,0 +1,73 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_STREAMSTATS_TEST
+#define H_STREAMSTATS_TEST
+
+#include <boost/make_shared.hpp>
+#include "BrowserStream.h"
+
+namespace {
+    struct FakeStatsStream : FB::BrowserStream {
+        FakeStatsStream() : FB::BrowserStream("http://localhost/test", false, false, 4096) {}
+        bool readRanges(const std::vector<Range>&) { return false; }
+        bool write(const char*, size_t, size_t& written) { written = 0; return false; }
+        bool close() { return true; }
+        // the host layers call this after delivering bytes; stand in for them
+        void deliver(size_t bytes) { accountDelivered(bytes); }
+    };
+}
+
+TEST(BrowserStreamStatistics)
+{
+    PRINT_TESTNAME;
+
+    boost::shared_ptr<FakeStatsStream> stream(boost::make_shared<FakeStatsStream>());
+
+    // Nothing delivered yet: zeroed counters and no time-to-first-byte
+    FB::BrowserStream::Statistics stats = stream->getStatistics();
+    CHECK_EQUAL((size_t)0, stats.bytesReceived);
+    CHECK_EQUAL((size_t)0, stats.chunkCount);
+    CHECK_EQUAL((size_t)0, stats.stallCount);
+    CHECK(stats.timeToFirstByte < 0);
+
+    stream->deliver(1000);
+    stream->deliver(1000);
+    stream->deliver(500);
+    stats = stream->getStatistics();
+    CHECK_EQUAL((size_t)2500, stats.bytesReceived);
+    CHECK_EQUAL((size_t)3, stats.chunkCount);
+    CHECK(stats.timeToFirstByte >= 0);
+    CHECK(stats.bytesPerSecond > 0);
+    CHECK(stats.chunkJitter >= 0);
+    CHECK_EQUAL((size_t)0, stats.stallCount);
+
+    // Backpressure shows up as a stall, not as arrival-side numbers
+    stream->setConsumeWatermark(1000);
+    stream->deliver(2000);
+    CHECK(stream->isSuspended());
+    stats = stream->getStatistics();
+    CHECK_EQUAL((size_t)1, stats.stallCount);
+    CHECK(stats.stalledSeconds >= 0);
+
+    // Consuming the backlog ends the stall; the count stays put
+    stream->reportConsumed(10000);
+    CHECK(!stream->isSuspended());
+    stats = stream->getStatistics();
+    CHECK_EQUAL((size_t)1, stats.stallCount);
+    CHECK(stats.stalledSeconds >= 0);
+}
+
+#endif // H_STREAMSTATS_TEST
@@ -0,0 +1,81 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_STREAMWRITEV_TEST
+#define H_STREAMWRITEV_TEST
+
+#include <boost/make_shared.hpp>
+#include "BrowserStream.h"
+
+namespace {
+    // Captures everything written so the vectored path can be checked against
+    // the equivalent contiguous write
+    struct FakeGatherStream : FB::BrowserStream {
+        FakeGatherStream() : FB::BrowserStream("http://localhost/test", false, false, 4096),
+            writeCalls(0), shortWriteAfter(0) {}
+        bool readRanges(const std::vector<Range>&) { return false; }
+        bool write(const char* data, size_t dataLength, size_t& written) {
+            ++writeCalls;
+            if (shortWriteAfter && sink.size() + dataLength > shortWriteAfter) {
+                written = shortWriteAfter - sink.size();
+                sink.append(data, written);
+                return false;
+            }
+            sink.append(data, dataLength);
+            written = dataLength;
+            return true;
+        }
+        bool close() { return true; }
+
+        std::string sink;
+        size_t writeCalls;
+        size_t shortWriteAfter;  // when nonzero, accept only this many bytes total
+    };
+}
+
+TEST(BrowserStreamWritev)
+{
+    PRINT_TESTNAME;
+
+    boost::shared_ptr<FakeGatherStream> stream(boost::make_shared<FakeGatherStream>());
+
+    // header + payload + trailer from separate buffers land back to back
+    std::string header("HDR|"), payload("payload-bytes"), trailer("|TRL");
+    std::vector<FB::BrowserStream::WriteSegment> segs;
+    segs.push_back(FB::BrowserStream::WriteSegment(header.data(), header.size()));
+    segs.push_back(FB::BrowserStream::WriteSegment(payload.data(), payload.size()));
+    segs.push_back(FB::BrowserStream::WriteSegment(trailer.data(), trailer.size()));
+
+    size_t written(0);
+    CHECK(stream->writev(segs, written));
+    CHECK_EQUAL(header.size() + payload.size() + trailer.size(), written);
+    CHECK_EQUAL(header + payload + trailer, stream->sink);
+
+    // empty segments are skipped, not written
+    stream->sink.clear();
+    stream->writeCalls = 0;
+    segs.insert(segs.begin() + 1, FB::BrowserStream::WriteSegment());
+    CHECK(stream->writev(segs, written));
+    CHECK_EQUAL(header + payload + trailer, stream->sink);
+    CHECK_EQUAL((size_t)3, stream->writeCalls);
+
+    // a short write stops the sequence and reports what actually went out
+    stream->sink.clear();
+    stream->shortWriteAfter = header.size() + 5;
+    CHECK(!stream->writev(segs, written));
+    CHECK_EQUAL(header.size() + 5, written);
+}
+
+#endif
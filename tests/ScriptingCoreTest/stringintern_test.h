@@ -0,0 +1,45 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+#include <string>
+#include "StringIntern.h"
+
+TEST(StringInternSharing)
+{
+    PRINT_TESTNAME;
+
+    const std::string& a = FB::intern_string("fieldName");
+    const std::string& b = FB::intern_string(std::string("fieldName"));
+
+    // Repeated keys resolve to the one canonical copy
+    CHECK(&a == &b);
+    CHECK_EQUAL("fieldName", a);
+    CHECK(a.data() == b.data());
+
+    // Distinct keys stay distinct
+    const std::string& c = FB::intern_string("otherField");
+    CHECK(&a != &c);
+    CHECK_EQUAL("otherField", c);
+
+    // same() is true for interned aliases and plain equal strings alike
+    CHECK(FB::StringInternTable::same(a, b));
+    CHECK(FB::StringInternTable::same(a, std::string("fieldName")));
+    CHECK(! FB::StringInternTable::same(a, c));
+
+    // Interning is idempotent: the table doesn't grow on repeats
+    size_t before = FB::StringInternTable::get().size();
+    FB::intern_string("fieldName");
+    FB::intern_string("otherField");
+    CHECK_EQUAL(before, FB::StringInternTable::get().size());
+}
@@ -0,0 +1,65 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_THREADCACHEDPOOL_TEST
+#define H_THREADCACHEDPOOL_TEST
+
+#include <string>
+#include <boost/make_shared.hpp>
+#include <boost/weak_ptr.hpp>
+#include "ThreadCachedPool.h"
+
+TEST(ThreadCachedPoolRecycles)
+{
+    PRINT_TESTNAME;
+
+    using FB::detail::ThreadCachedPool;
+
+    // A freed block should be handed back for the next same-sized allocation on this
+    // thread rather than going through the global allocator
+    void* first = ThreadCachedPool::allocate(64);
+    CHECK(first != NULL);
+    ThreadCachedPool::deallocate(first, 64);
+    void* second = ThreadCachedPool::allocate(64);
+    CHECK(second == first);
+    ThreadCachedPool::deallocate(second, 64);
+
+    // Different buckets don't share blocks
+    void* big = ThreadCachedPool::allocate(200);
+    CHECK(big != NULL);
+    ThreadCachedPool::deallocate(big, 200);
+
+    // Oversized requests fall through to the global allocator and must still round-trip
+    void* huge = ThreadCachedPool::allocate(4096);
+    CHECK(huge != NULL);
+    ThreadCachedPool::deallocate(huge, 4096);
+}
+
+TEST(ThreadCachedPoolAllocator)
+{
+    PRINT_TESTNAME;
+
+    // allocate_shared with the pool allocator puts the object and its control block in
+    // one pooled allocation; make sure construction and destruction behave
+    boost::shared_ptr<std::string> str =
+        boost::allocate_shared<std::string>(FB::detail::call_pool_allocator<void>(), "pooled");
+    CHECK(*str == "pooled");
+    boost::weak_ptr<std::string> weak(str);
+    str.reset();
+    CHECK(weak.expired());
+}
+
+#endif
+
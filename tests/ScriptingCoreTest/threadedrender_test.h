@@ -0,0 +1,80 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_THREADEDRENDER_TEST
+#define H_THREADEDRENDER_TEST
+
+#include <boost/bind.hpp>
+#include "ThreadedRenderService.h"
+#include "pluginwindowdirty_test.h"     // for the FakeWindow
+
+namespace ThreadedRenderTest {
+
+    struct Renderer {
+        Renderer() : frames(0) {}
+
+        bool render(FB::ThreadedRenderService::Frame& frame) {
+            ++frames;
+            // fill with the frame number so the presenter can tell frames apart
+            for (std::size_t i = 0; i < frame.pixels.size(); ++i)
+                frame.pixels[i] = static_cast<unsigned char>(frames & 0xff);
+            return true;
+        }
+
+        int frames;
+    };
+}
+
+TEST(ThreadedRenderServiceHandoff)
+{
+    PRINT_TESTNAME;
+    using namespace ThreadedRenderTest;
+
+    PluginWindowDirtyTest::FakeWindow win;
+    Renderer renderer;
+    FB::ThreadedRenderService svc(&win,
+        boost::bind(&Renderer::render, &renderer, _1), 100);
+
+    // not started and no size yet: nothing to present
+    CHECK(svc.beginPresent() == NULL);
+
+    svc.resized(8, 4);
+    svc.start();
+
+    // the render thread produces frames and asks the window to invalidate
+    int waited = 0;
+    while ((renderer.frames < 3 || win.invalidations < 1) && waited++ < 200)
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    CHECK(renderer.frames >= 3);
+    CHECK(win.invalidations >= 1);
+
+    // the paint side sees a completed, correctly sized frame
+    const FB::ThreadedRenderService::Frame* frame = svc.beginPresent();
+    CHECK(frame != NULL);
+    CHECK_EQUAL(8u, frame->width);
+    CHECK_EQUAL(4u, frame->height);
+    CHECK_EQUAL(32u, frame->stride);
+    CHECK_EQUAL(frame->stride * frame->height, (uint32_t)frame->pixels.size());
+    CHECK(frame->pixels[0] != 0);
+    svc.endPresent();
+
+    // after stop() the callback no longer runs
+    svc.stop();
+    int framesAtStop = renderer.frames;
+    boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+    CHECK_EQUAL(framesAtStop, renderer.frames);
+}
+
+#endif
@@ -0,0 +1,72 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_TIMERNAMESPACE_TEST
+#define H_TIMERNAMESPACE_TEST
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include "TimerService.h"
+
+namespace {
+    struct NsCounter {
+        NsCounter() : count(0) {}
+        volatile int count;
+        void fire() { ++count; }
+    };
+}
+
+TEST(TimerServiceNamespaces)
+{
+    PRINT_TESTNAME;
+
+    FB::TimerServicePtr svc(FB::TimerService::instance());
+
+    FB::TimerService::TimerNamespace ns(svc->createNamespace());
+    CHECK(ns != 0);
+    CHECK(svc->createNamespace() != ns);
+
+    // two timeouts filed under the namespace, one in the shared default
+    NsCounter grouped, shared;
+    svc->scheduleTimeout(60, boost::bind(&NsCounter::fire, &grouped), 0, ns);
+    svc->scheduleTimeout(60, boost::bind(&NsCounter::fire, &grouped), 0, ns);
+    svc->scheduleTimeout(60, boost::bind(&NsCounter::fire, &shared));
+
+    // tearing down the namespace sweeps out exactly its own pending timeouts
+    CHECK_EQUAL((size_t)2, svc->destroyNamespace(ns));
+
+    int waited(0);
+    while (shared.count < 1 && waited++ < 100) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    CHECK_EQUAL(1, shared.count);
+    CHECK_EQUAL(0, grouped.count);
+
+    // a destroyed (or unknown) namespace is an empty sweep
+    CHECK_EQUAL((size_t)0, svc->destroyNamespace(ns));
+
+    // a timeout that already fired is no longer part of its namespace
+    FB::TimerService::TimerNamespace ns2(svc->createNamespace());
+    NsCounter fired;
+    svc->scheduleTimeout(5, boost::bind(&NsCounter::fire, &fired), 0, ns2);
+    waited = 0;
+    while (fired.count < 1 && waited++ < 100) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    CHECK_EQUAL(1, fired.count);
+    CHECK_EQUAL((size_t)0, svc->destroyNamespace(ns2));
+}
+
+#endif
@@ -0,0 +1,70 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    Aug 29, 2026
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2026 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_TIMERPAUSE_TEST
+#define H_TIMERPAUSE_TEST
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include "Timer.h"
+
+namespace {
+    struct TickCounter {
+        TickCounter() : count(0) {}
+        volatile int count;
+        void tick() { ++count; }
+    };
+}
+
+TEST(TimerPauseResume)
+{
+    PRINT_TESTNAME;
+
+    TickCounter counter;
+    FB::TimerPtr timer(FB::Timer::getTimer(5, true, boost::bind(&TickCounter::tick, &counter)));
+    timer->start();
+
+    // give the recursive timer time to tick a few times
+    int waited(0);
+    while (counter.count < 3 && waited++ < 100) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    CHECK(counter.count >= 3);
+
+    timer->pause();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+    const int pausedAt(counter.count);
+    boost::this_thread::sleep(boost::posix_time::milliseconds(60));
+    CHECK_EQUAL(pausedAt, counter.count);
+
+    // resume picks the timer back up because it was running when paused
+    timer->resume();
+    waited = 0;
+    while (counter.count <= pausedAt && waited++ < 100) {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+    }
+    CHECK(counter.count > pausedAt);
+    timer->stop();
+
+    // a timer paused while stopped stays stopped across resume
+    TickCounter counter2;
+    FB::TimerPtr idle(FB::Timer::getTimer(5, true, boost::bind(&TickCounter::tick, &counter2)));
+    idle->pause();
+    idle->resume();
+    boost::this_thread::sleep(boost::posix_time::milliseconds(40));
+    CHECK_EQUAL(0, counter2.count);
+}
+
+#endif
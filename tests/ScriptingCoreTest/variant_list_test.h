@@ -66,6 +66,50 @@ TEST(VariantListTest)
     }
 }
 
+TEST(VariantListBuilderTest)
+{
+    PRINT_TESTNAME;
+
+    using FB::variant_list_builder;
+
+    FB::VariantList vl = variant_list_builder(4)(1)("foo")(25.74)(-1).release();
+    CHECK(vl.size() == 4);
+    CHECK(vl.capacity() == 4);
+    CHECK(vl[0].convert_cast<int>() == 1);
+    CHECK(vl[1].convert_cast<std::string>() == "foo");
+    CHECK(vl[2].convert_cast<double>() == 25.74);
+    CHECK(vl[3].convert_cast<int>() == -1);
+
+    // release() empties the builder rather than copying out of it
+    FB::VariantListBuilder builder(2);
+    builder("a")("b");
+    FB::VariantList first = builder.release();
+    CHECK(first.size() == 2);
+    CHECK(builder.release().empty());
+}
+
+TEST(VariantListBulkConvertTest)
+{
+    PRINT_TESTNAME;
+
+    using FB::variant_list_of;
+    using FB::convert_variant_list_bulk;
+
+    // homogeneous: every element takes the exact-type fast path
+    FB::VariantList doubles = variant_list_of(1.5)(2.5)(3.5);
+    std::vector<double> dv = convert_variant_list_bulk< std::vector<double> >(doubles);
+    CHECK(dv.size() == 3);
+    CHECK(dv.capacity() == 3);
+    CHECK(dv[0] == 1.5 && dv[1] == 2.5 && dv[2] == 3.5);
+
+    // mixed: off-type elements still go through convert_cast
+    FB::VariantList mixed = variant_list_of("1")(2)(3.0);
+    std::vector<int> iv;
+    convert_variant_list_bulk(mixed, iv);
+    CHECK(iv.size() == 3);
+    CHECK(iv[0] == 1 && iv[1] == 2 && iv[2] == 3);
+}
+
 TEST(VariantListWithMapTest)
 {
     PRINT_TESTNAME;
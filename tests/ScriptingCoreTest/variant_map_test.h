@@ -66,6 +66,29 @@ TEST(VariantMapTest)
     }
 }
 
+TEST(VariantMapBulkConvertTest)
+{
+    PRINT_TESTNAME;
+
+    using boost::assign::map_list_of;
+    using FB::convert_variant_map_bulk;
+    using FB::make_variant_map;
+
+    typedef std::map<std::string, std::string> StringMap;
+
+    // homogeneous string->string map: exact-type fast path, end()-hinted inserts
+    StringMap sm = map_list_of("a","1")("b","2")("c","3")("d","4");
+    FB::VariantMap vm = make_variant_map(sm);
+    CHECK((sm == convert_variant_map_bulk<StringMap>(vm)));
+
+    // mixed value types still convert
+    FB::VariantMap mixed = FB::variant_map_of<std::string>("x", 12)("y", "34")("z", 5.0);
+    std::map<std::string, int> im;
+    convert_variant_map_bulk(mixed, im);
+    CHECK(im.size() == 3);
+    CHECK(im["x"] == 12 && im["y"] == 34 && im["z"] == 5);
+}
+
 TEST(VariantMapWithListTest)
 {
     PRINT_TESTNAME;
@@ -0,0 +1,152 @@
+/**********************************************************\
+Original Author: Firebreath development team
+
+Created:    2013
+License:    Dual license model; choose one of two:
+            New BSD License
+            http://www.opensource.org/licenses/bsd-license.php
+            - or -
+            GNU Lesser General Public License, version 2.1
+            http://www.gnu.org/licenses/lgpl-2.1.html
+
+Copyright 2013 Firebreath development team
+\**********************************************************/
+
+#pragma once
+#ifndef H_CALLREPLAYER
+#define H_CALLREPLAYER
+
+// Replays a CallRecorder trace against a JSAPI in the mock host.  Load a file
+// captured from a live browser session, then replay() it against any JSAPI
+// implementation -- as fast as possible for throughput benchmarks, or at the
+// original (or accelerated) pacing to reproduce the timing of the recorded
+// session.  Calls that throw are counted as failures and replay continues,
+// since the recorded session may include calls the target object rejects.
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "JSAPI.h"
+#include "CallRecorder.h"
+
+class CallReplayer
+{
+public:
+    struct Entry {
+        long tUs;               // offset from start of recording, microseconds
+        long durUs;             // duration of the original call, microseconds
+        char kind;              // 'I'nvoke, 'G'et, 'S'et
+        std::string member;
+        FB::VariantList args;   // one value for 'S', the argument list for 'I'
+    };
+
+    struct Stats {
+        size_t calls;
+        size_t failures;
+        double seconds;
+
+        Stats() : calls(0), failures(0), seconds(0) {}
+    };
+
+    // Loads a trace file; returns false if it can't be opened or isn't a
+    // fbcallrec file.  Unparseable lines are skipped.
+    bool load(const std::string& path)
+    {
+        m_entries.clear();
+        std::ifstream in(path.c_str());
+        if (!in.is_open())
+            return false;
+        std::string line;
+        if (!std::getline(in, line) || line.compare(0, 11, "# fbcallrec") != 0)
+            return false;
+        while (std::getline(in, line)) {
+            std::istringstream is(line);
+            Entry e;
+            std::string member;
+            if (!(is >> e.tUs >> e.durUs >> e.kind >> member))
+                continue;
+            e.member = unescape(member);
+            if (e.kind == 'I') {
+                size_t argc = 0;
+                is >> argc;
+                std::string token;
+                for (size_t i = 0; i < argc && (is >> token); ++i)
+                    e.args.push_back(FB::CallRecorder::decodeArg(token));
+            } else if (e.kind == 'S') {
+                std::string token;
+                if (is >> token)
+                    e.args.push_back(FB::CallRecorder::decodeArg(token));
+                else
+                    continue;
+            } else if (e.kind != 'G') {
+                continue;
+            }
+            m_entries.push_back(e);
+        }
+        return true;
+    }
+
+    // Re-executes the trace against api.  speed 0 runs flat out; speed 1.0
+    // reproduces the recorded pacing; 2.0 runs twice as fast, and so on.
+    Stats replay(const FB::JSAPIPtr& api, double speed = 0.0) const
+    {
+        using namespace boost::posix_time;
+        Stats stats;
+        const ptime start(microsec_clock::universal_time());
+        for (std::vector<Entry>::const_iterator it = m_entries.begin();
+             it != m_entries.end(); ++it) {
+            if (speed > 0) {
+                const ptime due = start + microseconds(
+                    static_cast<long>(it->tUs / speed));
+                const ptime now(microsec_clock::universal_time());
+                if (due > now)
+                    boost::this_thread::sleep(due - now);
+            }
+            ++stats.calls;
+            try {
+                if (it->kind == 'I')
+                    api->Invoke(it->member, it->args);
+                else if (it->kind == 'S')
+                    api->SetProperty(it->member, it->args[0]);
+                else
+                    api->GetProperty(it->member);
+            } catch (const std::exception&) {
+                ++stats.failures;
+            }
+        }
+        stats.seconds =
+            (microsec_clock::universal_time() - start).total_microseconds()
+            / 1000000.0;
+        return stats;
+    }
+
+    size_t size() const { return m_entries.size(); }
+    const std::vector<Entry>& entries() const { return m_entries; }
+
+private:
+    static std::string unescape(const std::string& in)
+    {
+        std::string out;
+        out.reserve(in.size());
+        for (std::string::size_type i = 0; i < in.size(); ++i) {
+            if (in[i] == '%' && i + 2 < in.size()) {
+                out += static_cast<char>(
+                    std::strtol(in.substr(i + 1, 2).c_str(), NULL, 16));
+                i += 2;
+            } else {
+                out += in[i];
+            }
+        }
+        return out;
+    }
+
+    std::vector<Entry> m_entries;
+};
+
+#endif // H_CALLREPLAYER
+